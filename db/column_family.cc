@@ -30,6 +30,7 @@
 #include "db/write_controller.h"
 #include "file/sst_file_manager_impl.h"
 #include "memtable/hash_skiplist_rep.h"
+#include "monitoring/flow_trace.h"
 #include "monitoring/thread_status_util.h"
 #include "options/options_helper.h"
 #include "port/port.h"
@@ -40,9 +41,6 @@
 #include "util/cast_util.h"
 #include "util/compression.h"
 
-//Control Comp Flow Print - Signal.Jin
-int comp_col_flag = 1;
-
 namespace ROCKSDB_NAMESPACE {
 
 ColumnFamilyHandleImpl::ColumnFamilyHandleImpl(
@@ -182,6 +180,23 @@ Status CheckConcurrentWritesSupported(const ColumnFamilyOptions& cf_options) {
   return Status::OK();
 }
 
+Status CheckMemtableComparatorSupported(const ColumnFamilyOptions& cf_options) {
+  if (cf_options.memtable_factory &&
+      cf_options.memtable_factory->RequiresBytewiseComparator()) {
+    if (cf_options.comparator->timestamp_size() > 0) {
+      return Status::InvalidArgument(
+          std::string("Memtable ") + cf_options.memtable_factory->Name() +
+          " does not support user-defined timestamps");
+    }
+    if (cf_options.comparator != BytewiseComparator()) {
+      return Status::InvalidArgument(
+          std::string("Memtable ") + cf_options.memtable_factory->Name() +
+          " only supports BytewiseComparator");
+    }
+  }
+  return Status::OK();
+}
+
 Status CheckCFPathsSupported(const DBOptions& db_options,
                              const ColumnFamilyOptions& cf_options) {
   // More than one cf_paths are supported only in universal
@@ -541,7 +556,8 @@ ColumnFamilyData::ColumnFamilyData(
       prev_compaction_needed_bytes_(0),
       allow_2pc_(db_options.allow_2pc),
       last_memtable_id_(0),
-      db_paths_registered_(false) {
+      db_paths_registered_(false),
+      write_buffer_flush_candidate_(nullptr) {
   if (id_ != kDummyColumnFamilyDataId) {
     // TODO(cc): RegisterDbPaths can be expensive, considering moving it
     // outside of this constructor which might be called with db mutex held.
@@ -573,6 +589,13 @@ ColumnFamilyData::ColumnFamilyData(
         new BlobFileCache(_table_cache, ioptions(), soptions(), id_,
                           internal_stats_->GetBlobFileReadHist(), io_tracer));
 
+    if (write_buffer_manager_ != nullptr &&
+        write_buffer_manager_->flush_policy() != nullptr) {
+      write_buffer_flush_candidate_ =
+          write_buffer_manager_->flush_policy()->Register(column_family_set_,
+                                                          id_, name_);
+    }
+
     if (ioptions_.compaction_style == kCompactionStyleLevel) {
       compaction_picker_.reset(
           new LevelCompactionPicker(ioptions_, &internal_comparator_));
@@ -633,6 +656,11 @@ ColumnFamilyData::~ColumnFamilyData() {
     current_->Unref();
   }
 
+  if (write_buffer_flush_candidate_ != nullptr) {
+    write_buffer_manager_->flush_policy()->Unregister(
+        write_buffer_flush_candidate_);
+  }
+
   // It would be wrong if this ColumnFamilyData is in flush_queue_ or
   // compaction_queue_ and we destroyed it
   assert(!queued_for_flush_);
@@ -708,11 +736,43 @@ void ColumnFamilyData::SetDropped() {
   assert(id_ != 0);
   dropped_ = true;
   write_controller_token_.reset();
+  if (write_buffer_flush_candidate_ != nullptr) {
+    write_buffer_flush_candidate_->Clear();
+  }
 
   // remove from column_family_set
   column_family_set_->RemoveColumnFamily(this);
 }
 
+void ColumnFamilyData::RefreshWriteBufferFlushCandidate(uint64_t now_micros) {
+  if (write_buffer_flush_candidate_ == nullptr) {
+    return;
+  }
+  // How close one more immutable memtable, L0 file or their compaction debt
+  // brings the column family to a write slowdown.
+  const VersionStorageInfo* vstorage = current_->storage_info();
+  double stall_risk = 0;
+  if (mutable_cf_options_.max_write_buffer_number > 1) {
+    stall_risk =
+        std::max(stall_risk, (imm_.NumNotFlushed() + 1.0) /
+                                 mutable_cf_options_.max_write_buffer_number);
+  }
+  if (mutable_cf_options_.level0_slowdown_writes_trigger > 0) {
+    stall_risk = std::max(
+        stall_risk, (vstorage->l0_delay_trigger_count() + 1.0) /
+                        mutable_cf_options_.level0_slowdown_writes_trigger);
+  }
+  if (mutable_cf_options_.soft_pending_compaction_bytes_limit > 0) {
+    stall_risk = std::max(
+        stall_risk,
+        static_cast<double>(vstorage->estimated_compaction_needed_bytes()) /
+            mutable_cf_options_.soft_pending_compaction_bytes_limit);
+  }
+  write_buffer_flush_candidate_->Refresh(
+      mem_->GetID(), mem_->ApproximateMemoryUsageFast(), mem_->get_data_size(),
+      mutable_cf_options_.write_buffer_size, stall_risk, now_micros);
+}
+
 ColumnFamilyOptions ColumnFamilyData::GetLatestCFOptions() const {
   return BuildColumnFamilyOptions(initial_cf_options_, mutable_cf_options_);
 }
@@ -893,6 +953,36 @@ WriteStallCondition ColumnFamilyData::RecalculateWriteStallConditions(
     write_stall_condition = write_stall_condition_and_cause.first;
     auto write_stall_cause = write_stall_condition_and_cause.second;
 
+    // With predictive write stall control, the L0 file count and the
+    // compaction debt no longer delay or stop writes in steps. Writes are
+    // paced whenever either is predicted to go above its slowdown threshold.
+    double pacing_pressure = 0;
+    if (ioptions_.predictive_write_stall_control &&
+        !mutable_cf_options.disable_auto_compactions) {
+      write_stall_predictor_.Update(
+          ioptions_.clock->NowMicros(), vstorage->l0_delay_trigger_count(),
+          compaction_needed_bytes, internal_stats_->GetBytesFlushed(),
+          internal_stats_->GetBytesCompacted());
+      if (write_stall_cause != WriteStallCause::kMemtableLimit) {
+        double l0_pressure = write_stall_predictor_.L0Pressure(
+            mutable_cf_options.level0_slowdown_writes_trigger,
+            mutable_cf_options.level0_stop_writes_trigger);
+        double debt_pressure = write_stall_predictor_.CompactionDebtPressure(
+            mutable_cf_options.soft_pending_compaction_bytes_limit,
+            mutable_cf_options.hard_pending_compaction_bytes_limit);
+        pacing_pressure = std::max(l0_pressure, debt_pressure);
+        if (pacing_pressure > 0) {
+          write_stall_condition = WriteStallCondition::kDelayed;
+          write_stall_cause = l0_pressure >= debt_pressure
+                                  ? WriteStallCause::kL0FileCountLimit
+                                  : WriteStallCause::kPendingCompactionBytes;
+        } else {
+          write_stall_condition = WriteStallCondition::kNormal;
+          write_stall_cause = WriteStallCause::kNone;
+        }
+      }
+    }
+
     bool was_stopped = write_controller->IsStopped();
     bool needed_delay = write_controller->NeedsDelay();
 
@@ -927,6 +1017,23 @@ WriteStallCondition ColumnFamilyData::RecalculateWriteStallConditions(
           "[%s] Stopping writes because of estimated pending compaction "
           "bytes %" PRIu64,
           name_.c_str(), compaction_needed_bytes);
+    } else if (pacing_pressure > 0) {
+      write_controller_token_ = write_controller->GetDelayToken(
+          write_stall_predictor_.GetWriteRate(
+              pacing_pressure, write_controller->max_delayed_write_rate()));
+      internal_stats_->AddCFStats(
+          write_stall_cause == WriteStallCause::kL0FileCountLimit
+              ? InternalStats::L0_FILE_COUNT_LIMIT_SLOWDOWNS
+              : InternalStats::PENDING_COMPACTION_BYTES_LIMIT_SLOWDOWNS,
+          1);
+      ROCKS_LOG_WARN(
+          ioptions_.logger,
+          "[%s] Pacing writes because we have %d level-0 files and "
+          "estimated pending compaction bytes %" PRIu64
+          ", predicted pressure %.2f rate %" PRIu64,
+          name_.c_str(), vstorage->l0_delay_trigger_count(),
+          compaction_needed_bytes, pacing_pressure,
+          write_controller->delayed_write_rate());
     } else if (write_stall_condition == WriteStallCondition::kDelayed &&
                write_stall_cause == WriteStallCause::kMemtableLimit) {
       write_controller_token_ =
@@ -1083,10 +1190,7 @@ Compaction* ColumnFamilyData::PickCompaction(
     const MutableCFOptions& mutable_options,
     const MutableDBOptions& mutable_db_options, LogBuffer* log_buffer) {
 
-  if (((DB_LVL_COMPACTION_FLOW == 1) || (DB_UNI_COMPACTION_FLOW == 1)) && (comp_col_flag == 1)) {
-    fprintf(stdout, "  [5]        \t|    PickCompaction() {    \t\t| column_family.cc (line 1086)\n"); // Signal.Jin
-    comp_col_flag = 0;
-  }
+  FLOW_TRACE_SCOPE(kFlowTraceCompaction, "ColumnFamilyData::PickCompaction");
 
   SequenceNumber earliest_mem_seqno =
       std::min(mem_->GetEarliestSequenceNumber(),
@@ -1336,6 +1440,9 @@ Status ColumnFamilyData::ValidateOptions(
     s = Status::InvalidArgument(
         "max_successive_merges > 0 is incompatible with unordered_write");
   }
+  if (s.ok()) {
+    s = CheckMemtableComparatorSupported(cf_options);
+  }
   if (s.ok()) {
     s = CheckCFPathsSupported(db_options, cf_options);
   }
@@ -19,6 +19,7 @@
 #include "db/table_properties_collector.h"
 #include "db/write_batch_internal.h"
 #include "db/write_controller.h"
+#include "memtable/write_buffer_flush_policy.h"
 #include "options/cf_options.h"
 #include "rocksdb/compaction_job_stats.h"
 #include "rocksdb/db.h"
@@ -248,6 +249,9 @@ extern Status CheckCompressionSupported(const ColumnFamilyOptions& cf_options);
 extern Status CheckConcurrentWritesSupported(
     const ColumnFamilyOptions& cf_options);
 
+extern Status CheckMemtableComparatorSupported(
+    const ColumnFamilyOptions& cf_options);
+
 extern Status CheckCFPathsSupported(const DBOptions& db_options,
                                     const ColumnFamilyOptions& cf_options);
 
@@ -313,6 +317,16 @@ class ColumnFamilyData {
     flush_reason_ = flush_reason;
   }
   FlushReason GetFlushReason() const { return flush_reason_; }
+
+  // The state of this column family in cost-aware flush selection, or nullptr
+  // if the write buffer manager does not use it.
+  WriteBufferFlushPolicy::Candidate* write_buffer_flush_candidate() const {
+    return write_buffer_flush_candidate_;
+  }
+  // Updates write_buffer_flush_candidate() with the active memtable and the
+  // write stall risk of one more flush.
+  // REQUIRES: DB mutex held
+  void RefreshWriteBufferFlushCandidate(uint64_t now_micros);
   // thread-safe
   const FileOptions* soptions() const;
   const ImmutableOptions* ioptions() const { return &ioptions_; }
@@ -605,6 +619,9 @@ class ColumnFamilyData {
 
   uint64_t prev_compaction_needed_bytes_;
 
+  // Used with DBOptions::predictive_write_stall_control.
+  WriteStallPredictor write_stall_predictor_;
+
   // if the database was opened with 2pc enabled
   bool allow_2pc_;
 
@@ -616,6 +633,8 @@ class ColumnFamilyData {
 
   bool db_paths_registered_;
 
+  WriteBufferFlushPolicy::Candidate* write_buffer_flush_candidate_;
+
   std::string full_history_ts_low_;
 };
 
@@ -18,14 +18,12 @@
 #include "db/column_family.h"
 #include "file/filename.h"
 #include "logging/log_buffer.h"
+#include "monitoring/flow_trace.h"
 #include "monitoring/statistics.h"
 #include "test_util/sync_point.h"
 #include "util/random.h"
 #include "util/string_util.h"
 
-//Control Comp Flow Print - Signal.Jin
-int comp_regist_flag = 1;
-
 namespace ROCKSDB_NAMESPACE {
 
 namespace {
@@ -60,7 +58,9 @@ bool FindIntraL0Compaction(const std::vector<FileMetaData*>& level_files,
       break;
     }
   }
-  if (start >= level_files.size()) {
+  if (start >= level_files.size() ||
+      (start > 0 && InSameL0SortedRun(level_files[start - 1],
+                                       level_files[start]))) {
     return false;
   }
   size_t compact_bytes = static_cast<size_t>(level_files[start]->fd.file_size);
@@ -83,8 +83,14 @@ bool FindIntraL0Compaction(const std::vector<FileMetaData*>& level_files,
     }
     compact_bytes_per_del_file = new_compact_bytes_per_del_file;
   }
+  // Do not split the files of a partitioned flush, whose sequence numbers
+  // interleave, between the output and the remaining files.
+  while (limit > start && limit < level_files.size() &&
+         InSameL0SortedRun(level_files[limit - 1], level_files[limit])) {
+    limit--;
+  }
 
-  if ((limit - start) >= min_files_to_compact &&
+  if (limit > start && (limit - start) >= min_files_to_compact &&
       compact_bytes_per_del_file < max_compact_bytes_per_del_file) {
     assert(comp_inputs != nullptr);
     comp_inputs->level = 0;
@@ -925,6 +931,23 @@ Status CompactionPicker::SanitizeCompactionInputFilesForAllLevels(
       }
     } else if (output_level > 0) {
       last_included = static_cast<int>(current_files.size() - 1);
+    } else {
+      // An L0 output must not split the files of a partitioned flush, whose
+      // sequence numbers interleave, from the remaining ones.
+      auto in_same_run = [&](int newer, int older) {
+        return InSameL0SortedRun(current_files[newer].smallest_seqno,
+                                 current_files[newer].largest_seqno,
+                                 current_files[older].smallest_seqno,
+                                 current_files[older].largest_seqno);
+      };
+      while (first_included > 0 &&
+             in_same_run(first_included - 1, first_included)) {
+        first_included--;
+      }
+      while (last_included < static_cast<int>(current_files.size()) - 1 &&
+             in_same_run(last_included, last_included + 1)) {
+        last_included++;
+      }
     }
 
     // include all files between the first and the last compaction input files.
@@ -1069,13 +1092,8 @@ Status CompactionPicker::SanitizeCompactionInputFiles(
 
 void CompactionPicker::RegisterCompaction(Compaction* c) {
 
-  if ((DB_LVL_COMPACTION_FLOW == 1 || DB_UNI_COMPACTION_FLOW == 1) && comp_regist_flag == 1) {
-    fprintf(stdout, "  [11]        \t|       RegisterCompaction()   \t\t| compaction_picker.cc (line 1070)\n"); // Signal.Jin
-    fprintf(stdout, "  [12]        \t|      }\n");
-    fprintf(stdout, "  [13]        \t|     }\n");
-    fprintf(stdout, "  [14]        \t|    }\n");
-    comp_regist_flag = 0;
-  }
+  FLOW_TRACE_SCOPE(kFlowTraceCompaction,
+                   "CompactionPicker::RegisterCompaction");
 
   if (c == nullptr) {
     return;
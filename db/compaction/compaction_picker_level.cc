@@ -13,11 +13,9 @@
 
 #include "db/compaction/compaction_picker_level.h"
 #include "logging/log_buffer.h"
+#include "monitoring/flow_trace.h"
 #include "test_util/sync_point.h"
 
-//Control Comp LVL Flow Print - Signal.Jin
-int comp_picker_flag = 1;
-
 namespace ROCKSDB_NAMESPACE {
 
 bool LevelCompactionPicker::NeedsCompaction(
@@ -168,9 +166,8 @@ void LevelCompactionBuilder::PickFileToCompact(
 void LevelCompactionBuilder::SetupInitialFiles() {
   // Find the compactions by size on all levels.
 
-  if (DB_LVL_COMPACTION_FLOW == 1 && comp_picker_flag == 1) {
-    fprintf(stdout, "  [7]        \t|      SetupInitialFiles() {    \t| compaction_picker_level.cc (line 172)\n"); // Signal.Jin
-  }
+  FLOW_TRACE_SCOPE(kFlowTraceCompaction,
+                   "LevelCompactionBuilder::SetupInitialFiles");
 
   bool skipped_l0_to_base = false;
   for (int i = 0; i < compaction_picker_->NumberLevels() - 1; i++) {
@@ -304,9 +301,8 @@ bool LevelCompactionBuilder::SetupOtherInputsIfNeeded() {
 }
 
 Compaction* LevelCompactionBuilder::PickCompaction() {
-  if (DB_LVL_COMPACTION_FLOW == 1 && comp_picker_flag == 1) {
-    fprintf(stdout, "  [6]        \t|     PickCompaction() {    \t\t| compaction_picker_level.cc (line 307)\n"); // Signal.Jin
-  }
+  FLOW_TRACE_SCOPE(kFlowTraceCompaction,
+                   "LevelCompactionBuilder::PickCompaction");
 
   // Pick up the first file to start compaction. It may have been extended
   // to a clean cut.
@@ -338,10 +334,8 @@ Compaction* LevelCompactionBuilder::PickCompaction() {
 
 Compaction* LevelCompactionBuilder::GetCompaction() {
 
-  if (DB_LVL_COMPACTION_FLOW == 1 && comp_picker_flag == 1) {
-    fprintf(stdout, "  [10]        \t|      GetCompaction() {   \t\t| compaction_picker_level.cc (line 342)\n"); // Signal.Jin
-    comp_picker_flag = 0;
-  }
+  FLOW_TRACE_SCOPE(kFlowTraceCompaction,
+                   "LevelCompactionBuilder::GetCompaction");
   auto c = new Compaction(
       vstorage_, ioptions_, mutable_cf_options_, mutable_db_options_,
       std::move(compaction_inputs_), output_level_,
@@ -428,10 +422,8 @@ bool LevelCompactionBuilder::PickFileToCompact() {
   // could be made better by looking at key-ranges that are
   // being compacted at level 0.
 
-  if (DB_LVL_COMPACTION_FLOW == 1 && comp_picker_flag == 1) {
-    fprintf(stdout, "  [8]        \t|       PickFileToCompact()    \t\t| compaction_picker_level.cc (line 431)\n"); // Signal.Jin
-    fprintf(stdout, "  [9]        \t|      }\n"); // Signal.Jin
-  }
+  FLOW_TRACE_SCOPE(kFlowTraceCompaction,
+                   "LevelCompactionBuilder::PickFileToCompact");
 
   if (start_level_ == 0 &&
       !compaction_picker_->level0_compactions_in_progress()->empty()) {
@@ -561,6 +561,40 @@ TEST_F(CompactionPickerTest, AllowsTrivialMoveUniversal) {
   ASSERT_TRUE(compaction->is_trivial_move());
 }
 
+TEST_F(CompactionPickerTest, UniversalKeepsPartitionedFlushTogether) {
+  const uint64_t kFileSize = 100000;
+
+  mutable_cf_options_.level0_file_num_compaction_trigger = 2;
+  mutable_cf_options_.compaction_options_universal.min_merge_width = 2;
+  mutable_cf_options_.compaction_options_universal.max_merge_width = 2;
+  mutable_cf_options_.compaction_options_universal
+      .max_size_amplification_percent = 1000;
+  UniversalCompactionPicker universal_compaction_picker(ioptions_, &icmp_);
+
+  NewVersionStorage(1, kCompactionStyleUniversal);
+
+  // Files 1-3 are written by one partitioned flush.
+  Add(0, 1U, "150", "200", kFileSize, 0, 301, 390);
+  Add(0, 2U, "201", "250", kFileSize, 0, 302, 389);
+  Add(0, 3U, "251", "300", kFileSize, 0, 303, 388);
+  Add(0, 4U, "150", "300", kFileSize, 0, 201, 250);
+  Add(0, 5U, "150", "300", kFileSize, 0, 101, 150);
+
+  UpdateVersionStorageInfo();
+
+  std::unique_ptr<Compaction> compaction(
+      universal_compaction_picker.PickCompaction(
+          cf_name_, mutable_cf_options_, mutable_db_options_, vstorage_.get(),
+          &log_buffer_));
+
+  ASSERT_TRUE(compaction);
+  ASSERT_EQ(0, compaction->output_level());
+  ASSERT_EQ(4U, compaction->num_input_files(0));
+  for (size_t i = 0; i < 4; i++) {
+    ASSERT_EQ(i + 1, compaction->input(0, i)->fd.GetNumber());
+  }
+}
+
 TEST_F(CompactionPickerTest, UniversalPeriodicCompaction1) {
   // The case where universal periodic compaction can be picked
   // with some newer files being compacted.
@@ -1819,6 +1853,37 @@ TEST_F(CompactionPickerTest, IntraL0MaxCompactionBytesHit) {
   ASSERT_EQ(0, compaction->output_level());
 }
 
+TEST_F(CompactionPickerTest, IntraL0KeepsPartitionedFlushTogether) {
+  mutable_cf_options_.level0_file_num_compaction_trigger = 3;
+  mutable_cf_options_.max_compaction_bytes = 1099999u;
+  NewVersionStorage(6, kCompactionStyleLevel);
+
+  // Files 1 and 2 were written by one partitioned flush, so their sequence
+  // numbers interleave. max_compaction_bytes would allow the five newest
+  // files, but that would leave file 1 behind.
+  Add(0, 6U, "351", "400", 200000U, 0, 110, 111);
+  Add(0, 5U, "301", "350", 200000U, 0, 108, 109);
+  Add(0, 4U, "251", "300", 200000U, 0, 106, 107);
+  Add(0, 3U, "201", "250", 200000U, 0, 104, 105);
+  Add(0, 2U, "151", "200", 200000U, 0, 101, 103);
+  Add(0, 1U, "100", "150", 200000U, 0, 100, 102);
+  Add(1, 7U, "100", "400", 200000U, 0, 112, 113);
+  vstorage_->LevelFiles(1)[0]->being_compacted = true;
+  UpdateVersionStorageInfo();
+  // The two files of the partitioned flush are one sorted run.
+  ASSERT_EQ(5, vstorage_->l0_delay_trigger_count());
+
+  std::unique_ptr<Compaction> compaction(level_compaction_picker.PickCompaction(
+      cf_name_, mutable_cf_options_, mutable_db_options_, vstorage_.get(),
+      &log_buffer_));
+  ASSERT_TRUE(compaction.get() != nullptr);
+  ASSERT_EQ(1U, compaction->num_input_levels());
+  ASSERT_EQ(4U, compaction->num_input_files(0));
+  ASSERT_EQ(6U, compaction->input(0, 0)->fd.GetNumber());
+  ASSERT_EQ(3U, compaction->input(0, 3)->fd.GetNumber());
+  ASSERT_EQ(0, compaction->output_level());
+}
+
 TEST_F(CompactionPickerTest, IntraL0ForEarliestSeqno) {
   // Intra L0 compaction triggers only if there are at least
   // level0_file_num_compaction_trigger + 2 L0 files.
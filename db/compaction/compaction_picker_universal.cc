@@ -12,20 +12,19 @@
 
 #include <cinttypes>
 #include <limits>
+#include <algorithm>
 #include <queue>
 #include <string>
 #include <utility>
 #include "db/column_family.h"
 #include "file/filename.h"
 #include "logging/log_buffer.h"
+#include "monitoring/flow_trace.h"
 #include "monitoring/statistics.h"
 #include "test_util/sync_point.h"
 #include "util/random.h"
 #include "util/string_util.h"
 
-// Control Universal Comp Flow Print - Signal.Jin
-int comp_uni_flag = 1;
-
 namespace ROCKSDB_NAMESPACE {
 namespace {
 // A helper class that form universal compactions. The class is used by
@@ -75,6 +74,10 @@ class UniversalCompactionBuilder {
     // `file` Will be null for level > 0. For level = 0, the sorted run is
     // for this file.
     FileMetaData* file;
+    // For level = 0, `file` followed by the other files written by the same
+    // partitioned flush. They are always picked together, since their
+    // sequence numbers interleave (see InSameL0SortedRun()).
+    std::vector<FileMetaData*> l0_files;
     // For level > 0, `size` and `compensated_file_size` are sum of sizes all
     // files in the level. `being_compacted` should be the same for all files
     // in a non-zero level. Use the value here.
@@ -330,9 +333,20 @@ std::vector<UniversalCompactionBuilder::SortedRun>
 UniversalCompactionBuilder::CalculateSortedRuns(
     const VersionStorageInfo& vstorage) {
   std::vector<UniversalCompactionBuilder::SortedRun> ret;
-  for (FileMetaData* f : vstorage.LevelFiles(0)) {
+  const std::vector<FileMetaData*>& l0_files = vstorage.LevelFiles(0);
+  for (size_t i = 0; i < l0_files.size(); i++) {
+    FileMetaData* f = l0_files[i];
+    if (i > 0 && InSameL0SortedRun(l0_files[i - 1], f)) {
+      SortedRun& sr = ret.back();
+      sr.l0_files.push_back(f);
+      sr.size += f->fd.GetFileSize();
+      sr.compensated_file_size += f->compensated_file_size;
+      sr.being_compacted = sr.being_compacted || f->being_compacted;
+      continue;
+    }
     ret.emplace_back(0, f, f->fd.GetFileSize(), f->compensated_file_size,
                      f->being_compacted);
+    ret.back().l0_files.push_back(f);
   }
   for (int level = 1; level < vstorage.num_levels(); level++) {
     uint64_t total_compensated_size = 0U;
@@ -362,9 +376,8 @@ UniversalCompactionBuilder::CalculateSortedRuns(
 // time-range to compact.
 Compaction* UniversalCompactionBuilder::PickCompaction() {
 
-  if (DB_UNI_COMPACTION_FLOW == 1 && comp_uni_flag == 1) {
-    fprintf(stdout, "  [6]        \t|     PickCompaction() {    \t\t| compaction_picker_universal.cc (line 366)\n"); // Signal.Jin
-  }
+  FLOW_TRACE_SCOPE(kFlowTraceCompaction,
+                   "UniversalCompactionBuilder::PickCompaction");
 
   const int kLevel0 = 0;
   score_ = vstorage_->CompactionScore(kLevel0); // Calculate Compaction Score, How? Why? - Signal.Jin
@@ -457,11 +470,6 @@ Compaction* UniversalCompactionBuilder::PickCompaction() {
     }
   }
 
-  if (DB_UNI_COMPACTION_FLOW == 1 && comp_uni_flag == 1) {
-        fprintf(stdout, "  [10]        \t|      PickCompactionToReduceSortedRuns() /*Once compaction occurs, this function is called*/\n"); // Signal.Jin
-        comp_uni_flag = 0;
-      }
-
   if (c == nullptr) {
     if ((c = PickDeleteTriggeredCompaction()) != nullptr) {
       ROCKS_LOG_BUFFER(log_buffer_,
@@ -565,8 +573,8 @@ Compaction* UniversalCompactionBuilder::PickCompactionToReduceSortedRuns(
   unsigned int max_merge_width =
       mutable_cf_options_.compaction_options_universal.max_merge_width;
 
-  if (DB_UNI_COMPACTION_FLOW == 1)
-    fprintf(stdout, "db_bench Compaction Flow - PickCompactionToReduceSortedRuns() in compaction_picker_universal.cc\n"); // Signal.Jin
+  FLOW_TRACE_SCOPE(kFlowTraceCompaction,
+                   "UniversalCompactionBuilder::PickCompactionToReduceSortedRuns");
 
   //fprintf(stdout, "PickCompactionToReduceSortedRuns - compaction_picker_universal.cc 563\n"); // Signal.Jin 
 
@@ -743,8 +751,9 @@ Compaction* UniversalCompactionBuilder::PickCompactionToReduceSortedRuns(
   for (size_t i = start_index; i < first_index_after; i++) {
     auto& picking_sr = sorted_runs_[i];
     if (picking_sr.level == 0) {
-      FileMetaData* picking_file = picking_sr.file;
-      inputs[0].files.push_back(picking_file);
+      inputs[0].files.insert(inputs[0].files.end(),
+                             picking_sr.l0_files.begin(),
+                             picking_sr.l0_files.end());
     } else {
       auto& files = inputs[picking_sr.level - start_level].files;
       for (auto* f : vstorage_->LevelFiles(picking_sr.level)) {
@@ -788,9 +797,8 @@ Compaction* UniversalCompactionBuilder::PickCompactionToReduceSizeAmp() {
   uint64_t ratio = mutable_cf_options_.compaction_options_universal
                        .max_size_amplification_percent;
 
-  if (DB_UNI_COMPACTION_FLOW == 1 && comp_uni_flag == 1) {
-    fprintf(stdout, "  [7]        \t|      PickCompactionToReduceSizeAmp() {| compaction_picker_universal.cc (line 785)\n"); // Signal.Jin
-  }
+  FLOW_TRACE_SCOPE(kFlowTraceCompaction,
+                   "UniversalCompactionBuilder::PickCompactionToReduceSizeAmp");
 
   //fprintf(stdout, "PickCompactionToReduceSizeAmp - compaction_picker_universal.cc 769\n"); // Just one time with db_bench - Signal.Jin 
 
@@ -901,9 +909,12 @@ Compaction* UniversalCompactionBuilder::PickDeleteTriggeredCompaction() {
       if (sr->being_compacted) {
         continue;
       }
-      FileMetaData* f = vstorage_->LevelFiles(0)[loop];
-      if (f->marked_for_compaction) {
-        start_level_inputs.files.push_back(f);
+      bool marked = false;
+      for (FileMetaData* f : sr->l0_files) {
+        marked = marked || f->marked_for_compaction;
+      }
+      if (marked) {
+        start_level_inputs.files = sr->l0_files;
         start_index =
             static_cast<int>(loop);  // Consider this as the first candidate.
         break;
@@ -920,11 +931,12 @@ Compaction* UniversalCompactionBuilder::PickDeleteTriggeredCompaction() {
         break;
       }
 
-      FileMetaData* f = vstorage_->LevelFiles(0)[loop];
-      start_level_inputs.files.push_back(f);
+      start_level_inputs.files.insert(start_level_inputs.files.end(),
+                                      sr->l0_files.begin(), sr->l0_files.end());
     }
-    if (start_level_inputs.size() <= 1) {
-      // If only the last file in L0 is marked for compaction, ignore it
+    if (start_level_inputs.files.size() ==
+        sorted_runs_[start_index].l0_files.size()) {
+      // If only the last sorted run in L0 is marked for compaction, ignore it
       return nullptr;
     }
     inputs.push_back(start_level_inputs);
@@ -1021,10 +1033,8 @@ Compaction* UniversalCompactionBuilder::PickCompactionToOldest(
 
   assert(start_index < sorted_runs_.size());
 
-  if (DB_UNI_COMPACTION_FLOW == 1 && comp_uni_flag == 1) {
-    fprintf(stdout, "  [8]        \t|       PickCompactionToOldest()   \t| compaction_picker_universal.cc (line 1018)\n"); // Signal.Jin
-    fprintf(stdout, "  [9]        \t|      } /*This function is called once at startup*/\n");
-  }
+  FLOW_TRACE_SCOPE(kFlowTraceCompaction,
+                   "UniversalCompactionBuilder::PickCompactionToOldest");
 
   // Estimate total file size
   uint64_t estimated_total_size = 0;
@@ -1042,8 +1052,9 @@ Compaction* UniversalCompactionBuilder::PickCompactionToOldest(
   for (size_t loop = start_index; loop < sorted_runs_.size(); loop++) {
     auto& picking_sr = sorted_runs_[loop];
     if (picking_sr.level == 0) {
-      FileMetaData* f = picking_sr.file;
-      inputs[0].files.push_back(f);
+      inputs[0].files.insert(inputs[0].files.end(),
+                             picking_sr.l0_files.begin(),
+                             picking_sr.l0_files.end());
     } else {
       auto& files = inputs[picking_sr.level - start_level].files;
       for (auto* f : vstorage_->LevelFiles(picking_sr.level)) {
@@ -1128,7 +1139,8 @@ Compaction* UniversalCompactionBuilder::PickPeriodicCompaction() {
   if (start_index == sorted_runs_.size() - 1) {
     bool included_file_marked = false;
     int start_level = sorted_runs_[start_index].level;
-    FileMetaData* start_file = sorted_runs_[start_index].file;
+    const std::vector<FileMetaData*>& start_files =
+        sorted_runs_[start_index].l0_files;
     for (const std::pair<int, FileMetaData*>& level_file_pair :
          vstorage_->FilesMarkedForPeriodicCompaction()) {
       if (start_level != 0) {
@@ -1139,7 +1151,8 @@ Compaction* UniversalCompactionBuilder::PickPeriodicCompaction() {
         }
       } else {
         // Last sorted run is a L0 file.
-        if (start_file == level_file_pair.second) {
+        if (std::find(start_files.begin(), start_files.end(),
+                      level_file_pair.second) != start_files.end()) {
           included_file_marked = true;
           break;
         }
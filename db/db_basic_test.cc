@@ -1577,6 +1577,106 @@ TEST_F(DBBasicTest, MultiGetBatchedMultiLevel) {
   }
 }
 
+TEST_F(DBBasicTest, MultiGetOptimizeForIO) {
+  Options options = CurrentOptions();
+  options.disable_auto_compactions = true;
+  BlockBasedTableOptions bbto;
+  bbto.filter_policy.reset(NewBloomFilterPolicy(10, false));
+  bbto.block_size = 64;
+  bbto.cache_index_and_filter_blocks = true;
+  options.table_factory.reset(NewBlockBasedTableFactory(bbto));
+  options.statistics = ROCKSDB_NAMESPACE::CreateDBStatistics();
+  Reopen(options);
+
+  // Every fifth key is in L0, the other multiples of three in L1 and the rest
+  // in L2, so each key is in one level only.
+  auto key_level = [](int i) { return i % 5 == 0 ? 0 : (i % 3 == 0 ? 1 : 2); };
+  for (int level = 2; level >= 0; --level) {
+    for (int i = 0; i < 128; ++i) {
+      if (key_level(i) != level) {
+        continue;
+      }
+      ASSERT_OK(Put("key_" + std::to_string(i),
+                    "val_l" + std::to_string(level) + "_" +
+                        std::to_string(i)));
+      if (i % 32 == 31) {
+        ASSERT_OK(Flush());
+      }
+    }
+    ASSERT_OK(Flush());
+    if (level > 0) {
+      MoveFilesToLevel(level);
+    }
+  }
+
+  std::atomic<int> num_prefetches{0};
+  SyncPoint::GetInstance()->SetCallBack(
+      "BlockBasedTable::MultiGetPrefetch:Prefetch",
+      [&](void* /*arg*/) { num_prefetches++; });
+  SyncPoint::GetInstance()->EnableProcessing();
+
+  std::vector<std::string> key_strs;
+  for (int i = 40; i < 100; i += 2) {
+    key_strs.push_back("key_" + std::to_string(i));
+  }
+  std::vector<Slice> keys(key_strs.begin(), key_strs.end());
+  auto check = [&](const ReadOptions& ro) {
+    std::vector<PinnableSlice> values(keys.size());
+    std::vector<Status> statuses(keys.size());
+    db_->MultiGet(ro, db_->DefaultColumnFamily(), keys.size(), keys.data(),
+                  values.data(), statuses.data());
+    for (size_t j = 0; j < keys.size(); ++j) {
+      int key = 40 + 2 * static_cast<int>(j);
+      ASSERT_OK(statuses[j]);
+      ASSERT_EQ("val_l" + std::to_string(key_level(key)) + "_" +
+                    std::to_string(key),
+                values[j]);
+    }
+  };
+
+  ReadOptions ro;
+  ro.optimize_multiget_for_io = true;
+  ro.read_tier = kBlockCacheTier;
+  std::vector<PinnableSlice> values(keys.size());
+  std::vector<Status> statuses(keys.size());
+  db_->MultiGet(ro, db_->DefaultColumnFamily(), keys.size(), keys.data(),
+                values.data(), statuses.data());
+  ASSERT_EQ(0, num_prefetches);
+
+  ro.read_tier = kReadAllTier;
+  check(ro);
+  // The blocks of all three levels are prefetched.
+  ASSERT_GE(num_prefetches, 3);
+
+  // The blocks are in the block cache now.
+  num_prefetches = 0;
+  check(ro);
+  ASSERT_EQ(0, num_prefetches);
+
+  // The index and filter lookups of the prefetch pass are not counted in the
+  // statistics on top of those of the lookup itself.
+  ASSERT_OK(options.statistics->Reset());
+  check(ro);
+  const uint64_t index_hits =
+      TestGetTickerCount(options, BLOCK_CACHE_INDEX_HIT);
+  const uint64_t filter_hits =
+      TestGetTickerCount(options, BLOCK_CACHE_FILTER_HIT);
+  ASSERT_GT(index_hits, 0);
+  ASSERT_GT(filter_hits, 0);
+  ro.optimize_multiget_for_io = false;
+  ASSERT_OK(options.statistics->Reset());
+  check(ro);
+  ASSERT_EQ(index_hits, TestGetTickerCount(options, BLOCK_CACHE_INDEX_HIT));
+  ASSERT_EQ(filter_hits, TestGetTickerCount(options, BLOCK_CACHE_FILTER_HIT));
+
+  Reopen(options);
+  check(ro);
+  ASSERT_EQ(0, num_prefetches);
+
+  SyncPoint::GetInstance()->DisableProcessing();
+  SyncPoint::GetInstance()->ClearAllCallBacks();
+}
+
 TEST_F(DBBasicTest, MultiGetBatchedMultiLevelMerge) {
   Options options = CurrentOptions();
   options.disable_auto_compactions = true;
@@ -7,7 +7,10 @@
 // Use of this source code is governed by a BSD-style license that can be
 // found in the LICENSE file. See the AUTHORS file for names of contributors.
 
+#include <algorithm>
 #include <atomic>
+#include <mutex>
+#include <set>
 
 #include "db/db_impl/db_impl.h"
 #include "db/db_test_util.h"
@@ -21,6 +24,7 @@
 #include "util/mutexlock.h"
 #include "utilities/fault_injection_env.h"
 #include "utilities/fault_injection_fs.h"
+#include "utilities/merge_operators.h"
 
 namespace ROCKSDB_NAMESPACE {
 
@@ -572,6 +576,346 @@ TEST_F(DBFlushTest, FlushWithBlob) {
 #endif  // ROCKSDB_LITE
 }
 
+TEST_F(DBFlushTest, PartitionedFlush) {
+  constexpr int kNumKeys = 2000;
+  constexpr size_t kNumPartitions = 4;
+
+  Options options;
+  options.disable_auto_compactions = true;
+  options.flush_partitions = kNumPartitions;
+  options.env = env_;
+#ifndef ROCKSDB_LITE
+  class FlushedFilesListener : public EventListener {
+   public:
+    void OnFlushCompleted(DB* /*db*/, const FlushJobInfo& info) override {
+      std::lock_guard<std::mutex> lock(mutex_);
+      file_numbers_.insert(info.file_number);
+    }
+
+    std::set<uint64_t> file_numbers() {
+      std::lock_guard<std::mutex> lock(mutex_);
+      return file_numbers_;
+    }
+
+   private:
+    std::mutex mutex_;
+    std::set<uint64_t> file_numbers_;
+  };
+  auto listener = std::make_shared<FlushedFilesListener>();
+  options.listeners.push_back(listener);
+#endif  // !ROCKSDB_LITE
+
+  Reopen(options);
+
+  VersionSet* const versions = dbfull()->TEST_GetVersionSet();
+  ColumnFamilyData* const cfd = versions->GetColumnFamilySet()->GetDefault();
+
+  // Each round overwrites every `round`th key.
+  for (int round = 1; round <= 3; round++) {
+    // The keys are written out of order, so that the sequence numbers of the
+    // files of a flush interleave.
+    for (int j = 0; j < kNumKeys; j++) {
+      const int i = (j * 997) % kNumKeys;
+      if (i % round == 0) {
+        ASSERT_OK(Put(Key(i), "v" + ToString(round)));
+      }
+    }
+    ASSERT_OK(Flush());
+
+    const VersionStorageInfo* const storage_info =
+        cfd->current()->storage_info();
+    const auto& l0_files = storage_info->LevelFiles(0);
+    ASSERT_EQ(kNumPartitions * round, l0_files.size());
+    // The files of a flush are disjoint and count as one sorted run.
+    for (size_t i = 1; i < kNumPartitions; i++) {
+      ASSERT_TRUE(InSameL0SortedRun(l0_files[i - 1], l0_files[i]));
+    }
+    std::vector<const FileMetaData*> flushed(
+        l0_files.begin(), l0_files.begin() + kNumPartitions);
+    std::sort(flushed.begin(), flushed.end(),
+              [](const FileMetaData* a, const FileMetaData* b) {
+                return a->smallest.user_key().compare(b->smallest.user_key()) <
+                       0;
+              });
+    for (size_t i = 1; i < kNumPartitions; i++) {
+      ASSERT_LT(flushed[i - 1]->largest.user_key().compare(
+                    flushed[i]->smallest.user_key()),
+                0);
+    }
+    ASSERT_EQ(round, storage_info->l0_delay_trigger_count());
+#ifndef ROCKSDB_LITE
+    // Every file of a flush is reported to listeners.
+    std::set<uint64_t> l0_file_numbers;
+    for (const FileMetaData* f : l0_files) {
+      l0_file_numbers.insert(f->fd.GetNumber());
+    }
+    ASSERT_EQ(l0_file_numbers, listener->file_numbers());
+#endif  // !ROCKSDB_LITE
+  }
+
+  auto verify = [&]() {
+    for (int i = 0; i < kNumKeys; i++) {
+      const int round = (i % 3 == 0) ? 3 : (i % 2 == 0) ? 2 : 1;
+      ASSERT_EQ("v" + ToString(round), Get(Key(i)));
+    }
+  };
+  verify();
+  Reopen(options);
+  verify();
+  ASSERT_OK(db_->CompactRange(CompactRangeOptions(), nullptr, nullptr));
+  ASSERT_EQ(0, NumTableFilesAtLevel(0));
+  verify();
+
+  // Memtables with range deletions are flushed to a single file.
+  ASSERT_OK(Put(Key(0), "v4"));
+  ASSERT_OK(Put(Key(kNumKeys - 1), "v4"));
+  ASSERT_OK(db_->DeleteRange(WriteOptions(), db_->DefaultColumnFamily(),
+                             Key(1), Key(kNumKeys - 1)));
+  ASSERT_OK(Flush());
+  ASSERT_EQ(1, NumTableFilesAtLevel(0));
+  ASSERT_EQ("v4", Get(Key(0)));
+  ASSERT_EQ("NOT_FOUND", Get(Key(1)));
+  ASSERT_EQ("v4", Get(Key(kNumKeys - 1)));
+}
+
+#ifndef ROCKSDB_LITE
+TEST_F(DBFlushTest, PartitionedFlushCompactFilesKeepsRunWhole) {
+  constexpr int kNumKeys = 1000;
+  constexpr size_t kNumPartitions = 4;
+
+  Options options = CurrentOptions();
+  options.disable_auto_compactions = true;
+  options.flush_partitions = kNumPartitions;
+  DestroyAndReopen(options);
+
+  for (int round = 1; round <= 2; round++) {
+    // The keys are written out of order, so that the sequence numbers of the
+    // files of a flush interleave.
+    for (int j = 0; j < kNumKeys; j++) {
+      const int i = (j * 997) % kNumKeys;
+      ASSERT_OK(Put(Key(i), "v" + ToString(round)));
+    }
+    ASSERT_OK(Flush());
+  }
+  ColumnFamilyMetaData cf_meta;
+  db_->GetColumnFamilyMetaData(&cf_meta);
+  ASSERT_EQ(2 * kNumPartitions, cf_meta.levels[0].files.size());
+
+  // Compacting a file of the newer flush into L0 pulls in the other files of
+  // that flush, but none of the older one.
+  ASSERT_OK(db_->CompactFiles(CompactionOptions(),
+                              {cf_meta.levels[0].files[1].name}, 0));
+  ASSERT_EQ(kNumPartitions + 1, NumTableFilesAtLevel(0));
+  for (int i = 0; i < kNumKeys; i++) {
+    ASSERT_EQ("v2", Get(Key(i)));
+  }
+  Reopen(options);
+  for (int i = 0; i < kNumKeys; i++) {
+    ASSERT_EQ("v2", Get(Key(i)));
+  }
+}
+
+TEST_F(DBFlushTest, PartitionedFlushRetryReportsEachFileOnce) {
+  if (mem_env_ || encrypted_env_) {
+    ROCKSDB_GTEST_SKIP("Test requires non-mem or non-encrypted environment");
+    return;
+  }
+  constexpr int kNumKeys = 1000;
+  constexpr size_t kNumPartitions = 4;
+
+  std::shared_ptr<FaultInjectionTestFS> fault_fs(
+      new FaultInjectionTestFS(FileSystem::Default()));
+  std::unique_ptr<Env> fault_fs_env(NewCompositeEnv(fault_fs));
+  Options options = CurrentOptions();
+  options.disable_auto_compactions = true;
+  options.flush_partitions = kNumPartitions;
+  options.env = fault_fs_env.get();
+  class FlushedFilesListener : public EventListener {
+   public:
+    void OnFlushCompleted(DB* /*db*/, const FlushJobInfo& info) override {
+      std::lock_guard<std::mutex> lock(mutex_);
+      file_numbers_.insert(info.file_number);
+    }
+
+    // Resume() manually instead of waiting for the free space to be polled.
+    void OnErrorRecoveryBegin(BackgroundErrorReason /*reason*/,
+                              Status bg_error, bool* auto_recovery) override {
+      bg_error.PermitUncheckedError();
+      *auto_recovery = false;
+    }
+
+    std::multiset<uint64_t> file_numbers() {
+      std::lock_guard<std::mutex> lock(mutex_);
+      return file_numbers_;
+    }
+
+   private:
+    std::mutex mutex_;
+    std::multiset<uint64_t> file_numbers_;
+  };
+  auto listener = std::make_shared<FlushedFilesListener>();
+  options.listeners.push_back(listener);
+  Reopen(options);
+
+  for (int j = 0; j < kNumKeys; j++) {
+    const int i = (j * 997) % kNumKeys;
+    ASSERT_OK(Put(Key(i), "value"));
+  }
+
+  // The first attempt fails to write the files of the flush.
+  SyncPoint::GetInstance()->SetCallBack(
+      "FlushJob::PickPartitionBounds", [&](void* /*arg*/) {
+        fault_fs->SetFilesystemActive(false, IOStatus::NoSpace("Out of space"));
+      });
+  SyncPoint::GetInstance()->EnableProcessing();
+  ASSERT_NOK(Flush());
+  SyncPoint::GetInstance()->DisableProcessing();
+  SyncPoint::GetInstance()->ClearAllCallBacks();
+  fault_fs->SetFilesystemActive(true);
+  ASSERT_TRUE(listener->file_numbers().empty());
+
+  // The retry reports each of the files it installed exactly once.
+  ASSERT_OK(dbfull()->Resume());
+  ColumnFamilyMetaData cf_meta;
+  db_->GetColumnFamilyMetaData(&cf_meta);
+  ASSERT_EQ(kNumPartitions, cf_meta.levels[0].files.size());
+  std::multiset<uint64_t> l0_file_numbers;
+  for (const SstFileMetaData& f : cf_meta.levels[0].files) {
+    l0_file_numbers.insert(f.file_number);
+  }
+  ASSERT_EQ(l0_file_numbers, listener->file_numbers());
+  for (int i = 0; i < kNumKeys; i++) {
+    ASSERT_EQ("value", Get(Key(i)));
+  }
+
+  // Close before fault_fs_env destruct.
+  Close();
+}
+#endif  // !ROCKSDB_LITE
+
+TEST_F(DBFlushTest, InMemoryCompaction) {
+  constexpr int kNumKeys = 10;
+  constexpr int kEntriesPerMemtable = 100;
+
+  Options options = CurrentOptions();
+  options.env = env_;
+  options.disable_auto_compactions = true;
+  options.in_memory_compaction = true;
+  options.min_write_buffer_number_to_merge = 2;
+  options.max_write_buffer_number = 8;
+  options.memtable_factory.reset(
+      new SpecialSkipListFactory(kEntriesPerMemtable));
+  options.merge_operator = MergeOperators::CreateStringAppendOperator();
+#ifndef ROCKSDB_LITE
+  class FlushCountingListener : public EventListener {
+   public:
+    void OnFlushBegin(DB* /*db*/, const FlushJobInfo& /*info*/) override {
+      num_begun++;
+    }
+    void OnFlushCompleted(DB* /*db*/, const FlushJobInfo& info) override {
+      num_completed++;
+      if (info.file_path.empty()) {
+        EXPECT_EQ(0, info.file_number);
+        num_kept++;
+      }
+    }
+
+    std::atomic<int> num_begun{0};
+    std::atomic<int> num_completed{0};
+    std::atomic<int> num_kept{0};
+  };
+  auto listener = std::make_shared<FlushCountingListener>();
+  options.listeners.push_back(listener);
+  // Only files actually written are reported to the SstFileManager.
+  options.sst_file_manager.reset(NewSstFileManager(env_));
+  SyncPoint::GetInstance()->SetCallBack(
+      "SstFileManagerImpl::OnAddFile", [&](void* arg) {
+        EXPECT_OK(env_->FileExists(*static_cast<std::string*>(arg)));
+      });
+  SyncPoint::GetInstance()->EnableProcessing();
+#endif  // !ROCKSDB_LITE
+  Reopen(options);
+
+  auto num_imm_entries = [&]() {
+    uint64_t num_entries = 0;
+    EXPECT_TRUE(db_->GetIntProperty(DB::Properties::kNumEntriesImmMemTables,
+                                    &num_entries));
+    return num_entries;
+  };
+
+  // Overwrite the same keys in two memtables. The write after them switches
+  // the second one, which schedules the flush of both.
+  const Snapshot* snapshot = nullptr;
+  for (int i = 0; i <= 2 * kEntriesPerMemtable; i++) {
+    if (i == kEntriesPerMemtable / 2) {
+      snapshot = db_->GetSnapshot();
+    }
+    ASSERT_OK(Put(Key(i % kNumKeys), "v" + ToString(i)));
+  }
+  ASSERT_OK(dbfull()->TEST_WaitForCompact());
+
+  // They were compacted into one memtable holding the latest version of each
+  // key and the one visible to the snapshot, and were not flushed.
+  ASSERT_EQ(0, NumTableFilesAtLevel(0));
+  std::string num_imm;
+  ASSERT_TRUE(
+      db_->GetProperty(DB::Properties::kNumImmutableMemTable, &num_imm));
+  ASSERT_EQ("1", num_imm);
+  ASSERT_EQ(2 * kNumKeys, num_imm_entries());
+#ifndef ROCKSDB_LITE
+  // The flush is still reported as completed, without a file.
+  ASSERT_GT(listener->num_kept, 0);
+  ASSERT_EQ(listener->num_begun, listener->num_completed);
+  ASSERT_EQ(listener->num_kept, listener->num_completed);
+#endif  // !ROCKSDB_LITE
+  auto latest = [&](int k) {
+    return "v" + ToString((2 * kEntriesPerMemtable - k) / kNumKeys * kNumKeys +
+                          k);
+  };
+  for (int k = 0; k < kNumKeys; k++) {
+    ASSERT_EQ(latest(k), Get(Key(k)));
+    ASSERT_EQ("v" + ToString(kEntriesPerMemtable / 2 - kNumKeys + k),
+              Get(Key(k), snapshot));
+  }
+  db_->ReleaseSnapshot(snapshot);
+
+  // Merge operands are combined with the base value.
+  ASSERT_OK(Put("merge", "m"));
+  for (int i = 0; i < kEntriesPerMemtable - 1; i++) {
+    ASSERT_OK(Merge("merge", "x"));
+  }
+  ASSERT_OK(dbfull()->TEST_WaitForCompact());
+  ASSERT_EQ(0, NumTableFilesAtLevel(0));
+  ASSERT_EQ(kNumKeys + 1, num_imm_entries());
+  std::string expected_merge = "m";
+  for (int i = 0; i < kEntriesPerMemtable - 1; i++) {
+    expected_merge += ",x";
+  }
+  ASSERT_EQ(expected_merge, Get("merge"));
+
+  // A manual flush compacts the memtables and writes the result to L0.
+  ASSERT_OK(Flush());
+  ASSERT_EQ(1, NumTableFilesAtLevel(0));
+  ASSERT_EQ(0, num_imm_entries());
+  TablePropertiesCollection tables;
+  ASSERT_OK(db_->GetPropertiesOfAllTables(&tables));
+  ASSERT_EQ(1, tables.size());
+  ASSERT_EQ(kNumKeys + 1, tables.begin()->second->num_entries);
+#ifndef ROCKSDB_LITE
+  ASSERT_OK(dbfull()->TEST_WaitForCompact());
+  ASSERT_EQ(listener->num_begun, listener->num_completed);
+  ASSERT_EQ(listener->num_kept + 1, listener->num_completed);
+  SyncPoint::GetInstance()->DisableProcessing();
+  SyncPoint::GetInstance()->ClearAllCallBacks();
+#endif  // !ROCKSDB_LITE
+
+  Reopen(options);
+  for (int k = 0; k < kNumKeys; k++) {
+    ASSERT_EQ(latest(k), Get(Key(k)));
+  }
+  ASSERT_EQ(expected_merge, Get("merge"));
+}
+
 TEST_F(DBFlushTest, FlushWithChecksumHandoff1) {
   if (mem_env_ || encrypted_env_) {
     ROCKSDB_GTEST_SKIP("Test requires non-mem or non-encrypted environment");
@@ -62,6 +62,7 @@
 #include "logging/logging.h"
 #include "memtable/hash_linklist_rep.h"
 #include "memtable/hash_skiplist_rep.h"
+#include "monitoring/flow_trace.h"
 #include "monitoring/in_memory_stats_history.h"
 #include "monitoring/iostats_context_imp.h"
 #include "monitoring/perf_context_imp.h"
@@ -106,9 +107,6 @@
 #include <chrono>
 typedef std::chrono::high_resolution_clock Clock;
 
-// Control Print Flow - Signal.Jin
-int read_get_flag = 1;
-
 namespace ROCKSDB_NAMESPACE {
 
 const std::string kDefaultColumnFamilyName("default");
@@ -185,6 +183,7 @@ DBImpl::DBImpl(const DBOptions& options, const std::string& dbname,
       log_empty_(true),
       persist_stats_cf_handle_(nullptr),
       log_sync_cv_(&mutex_),
+      wal_sync_cv_(&wal_sync_mutex_),
       total_log_size_(0),
       is_snapshot_supported_(true),
       write_buffer_manager_(immutable_db_options_.write_buffer_manager.get()),
@@ -282,6 +281,8 @@ DBImpl::DBImpl(const DBOptions& options, const std::string& dbname,
   if (write_buffer_manager_) {
     wbm_stall_.reset(new WBMStallInterface());
   }
+
+  FlowTracer::EnableCategories(mutable_db_options_.flow_trace_categories);
 }
 
 Status DBImpl::Resume() {
@@ -403,6 +404,11 @@ Status DBImpl::ResumeImpl(DBRecoverContext context) {
       ROCKS_LOG_INFO(immutable_db_options_.info_log,
                      "DB resume requested but failed due to Flush failure [%s]",
                      s.ToString().c_str());
+    } else {
+      // The data of the WALs that failed to sync is in SST files now, and
+      // later writes go to new WALs.
+      InstrumentedMutexLock l(&wal_sync_mutex_);
+      wal_sync_status_ = Status::OK();
     }
   }
 
@@ -516,6 +522,10 @@ void DBImpl::CancelAllBackgroundWork(bool wait) {
 }
 
 Status DBImpl::CloseHelper() {
+  // No writes are in progress, so all WAL sync requests have been waited
+  // for.
+  StopWalSyncThread();
+
   // Guarantee that there is no background error recovery in progress before
   // continuing with the shutdown
   mutex_.Lock();
@@ -622,6 +632,23 @@ Status DBImpl::CloseHelper() {
     }
   }
   logs_.clear();
+  for (auto& wal_stream : wal_streams_) {
+    uint64_t log_number = wal_stream->writer->get_log_number();
+    Status s = wal_stream->writer->WriteBuffer();
+    delete wal_stream->writer;
+    wal_stream->writer = nullptr;
+    if (!s.ok()) {
+      ROCKS_LOG_WARN(
+          immutable_db_options_.info_log,
+          "Unable to Sync WAL file %s with error -- %s",
+          LogFileName(immutable_db_options_.wal_dir, log_number).c_str(),
+          s.ToString().c_str());
+      if (ret.ok()) {
+        ret = s;
+      }
+    }
+  }
+  wal_streams_.clear();
 
   // Table cache may have table handles holding blocks from the block cache.
   // We need to release them before the block cache is destroyed. The block
@@ -692,6 +719,7 @@ DBImpl::~DBImpl() {
     closed_ = true;
     CloseHelper().PermitUncheckedError();
   }
+  FlowTracer::DisableCategories(mutable_db_options_.flow_trace_categories);
 }
 
 void DBImpl::MaybeIgnoreError(Status* s) const {
@@ -1163,6 +1191,12 @@ Status DBImpl::SetDBOptions(
                                           : new_options.max_open_files - 10);
       wal_changed = mutable_db_options_.wal_bytes_per_sync !=
                     new_options.wal_bytes_per_sync;
+      if (new_options.flow_trace_categories !=
+          mutable_db_options_.flow_trace_categories) {
+        FlowTracer::EnableCategories(new_options.flow_trace_categories);
+        FlowTracer::DisableCategories(
+            mutable_db_options_.flow_trace_categories);
+      }
       mutable_db_options_ = new_options;
       file_options_for_compaction_ = FileOptions(new_db_options);
       file_options_for_compaction_ = fs_->OptimizeForCompactionTableWrite(
@@ -1303,6 +1337,16 @@ Status DBImpl::SyncWAL() {
       log.getting_synced = true;
       logs_to_sync.push_back(log.writer);
     }
+    // The WAL files the streams switched from were synced when switching
+    if (!wal_streams_.empty()) {
+      while (wal_streams_getting_synced_) {
+        log_sync_cv_.Wait();
+      }
+      wal_streams_getting_synced_ = true;
+      for (auto& wal_stream : wal_streams_) {
+        logs_to_sync.push_back(wal_stream->writer);
+      }
+    }
 
     need_log_dir_sync = !log_dir_synced_;
   }
@@ -1333,6 +1377,9 @@ Status DBImpl::SyncWAL() {
   TEST_SYNC_POINT("DBImpl::SyncWAL:BeforeMarkLogsSynced:1");
   {
     InstrumentedMutexLock l(&mutex_);
+    if (!wal_streams_.empty()) {
+      wal_streams_getting_synced_ = false;
+    }
     if (status.ok()) {
       status = MarkLogsSynced(current_log_number, need_log_dir_sync);
     } else {
@@ -1644,9 +1691,7 @@ Status DBImpl::Get(const ReadOptions& read_options,
   get_impl_options.value = value;
   get_impl_options.timestamp = timestamp;
 
-  if (DB_READ_FLOW == 1 && read_get_flag == 1) {
-    fprintf(stdout, "  [2]        \t|  Get() {     \t\t\t\t| db_impl.cc (line 1644)\n"); // Signal.Jin
-  }
+  FLOW_TRACE_SCOPE(kFlowTraceRead, "DBImpl::Get");
 
   Status s = GetImpl(read_options, key, get_impl_options);
   return s;
@@ -1683,10 +1728,7 @@ Status DBImpl::GetImpl(const ReadOptions& read_options, const Slice& key,
   }
 #endif  // NDEBUG
 
-  if (DB_READ_FLOW == 1 && read_get_flag == 1) {
-    fprintf(stdout, "  [3]        \t|   GetImpl() {     \t\t\t| db_impl.cc (line 1683)\n"); // Signal.Jin
-    read_get_flag = 0;
-  }
+  FLOW_TRACE_SCOPE(kFlowTraceRead, "DBImpl::GetImpl");
 
   PERF_CPU_TIMER_GUARD(get_cpu_nanos, immutable_db_options_.clock);
   StopWatch sw(immutable_db_options_.clock, stats_, DB_GET);
@@ -3561,6 +3603,10 @@ Status DBImpl::GetUpdatesSince(
     SequenceNumber seq, std::unique_ptr<TransactionLogIterator>* iter,
     const TransactionLogIterator::ReadOptions& read_options) {
   RecordTick(stats_, GET_UPDATES_SINCE_CALLS);
+  if (!wal_streams_.empty()) {
+    return Status::NotSupported(
+        "GetUpdatesSince() is not supported with wal_streams > 1");
+  }
   if (seq > versions_->LastSequence()) {
     return Status::NotFound("Requested sequence not yet written in the db");
   }
@@ -4551,6 +4597,7 @@ Status DBImpl::IngestExternalFiles( // Before BG Compaction, do ingest sstables
     if (two_write_queues_) {
       nonmem_write_thread_.EnterUnbatched(&nonmem_w, &mutex_);
     }
+    EnterWalStreamsUnbatched();
 
     // When unordered_write is enabled, the keys are writing to memtable in an
     // unordered way. If the ingestion job checks memtable key range before the
@@ -4700,6 +4747,7 @@ Status DBImpl::IngestExternalFiles( // Before BG Compaction, do ingest sstables
     }
 
     // Resume writes to the DB
+    ExitWalStreamsUnbatched();
     if (two_write_queues_) {
       nonmem_write_thread_.ExitUnbatched(&nonmem_w);
     }
@@ -4813,6 +4861,7 @@ Status DBImpl::CreateColumnFamilyWithImport(
       if (two_write_queues_) {
         nonmem_write_thread_.EnterUnbatched(&nonmem_w, &mutex_);
       }
+      EnterWalStreamsUnbatched();
 
       num_running_ingest_file_++;
       assert(!cfd->IsDropped());
@@ -4829,6 +4878,7 @@ Status DBImpl::CreateColumnFamilyWithImport(
       }
 
       // Resume writes to the DB
+      ExitWalStreamsUnbatched();
       if (two_write_queues_) {
         nonmem_write_thread_.ExitUnbatched(&nonmem_w);
       }
@@ -9,11 +9,13 @@
 #pragma once
 
 #include <atomic>
+#include <condition_variable>
 #include <deque>
 #include <functional>
 #include <limits>
 #include <list>
 #include <map>
+#include <mutex>
 #include <set>
 #include <string>
 #include <utility>
@@ -1253,12 +1255,61 @@ class DBImpl : public DB {
                             bool disable_memtable = false,
                             uint64_t* seq_used = nullptr);
 
+  // With pipelined_wal_sync, the WAL write group leader of
+  // PipelinedWriteImpl appends the group to the WAL and requests a sync from
+  // the WAL sync thread instead of syncing inline, so that the next group
+  // can be appended while the sync runs. RequestWalSync() returns the ticket
+  // of the request; WaitForWalSync() blocks until it is synced.
+  bool UsePipelinedWalSync(log::Writer* log_writer) const;
+  uint64_t RequestWalSync();
+  Status WaitForWalSync(uint64_t ticket);
+  void StartWalSyncThread();
+  void StopWalSyncThread();
+  void BGWorkWalSync();
+
   // Write only to memtables without joining any write queue
   Status UnorderedWriteMemtable(const WriteOptions& write_options,
                                 WriteBatch* my_batch, WriteCallback* callback,
                                 uint64_t log_ref, SequenceNumber seq,
                                 const size_t sub_batch_cnt);
 
+  // With max_write_batch_insert_threads > 1, returns into how many ranges of
+  // records the batch of `w` is split for its concurrent memtable insert, or
+  // 1 if it is inserted as a whole.
+  size_t MemTableInsertRanges(const WriteThread::Writer& w) const;
+
+  // Inserts the batch of `w`, starting at w->sequence, into the memtables as
+  // `num_ranges` ranges of records on as many threads, the calling thread
+  // included.
+  Status InsertRangesIntoMemTable(WriteThread::Writer* w, size_t num_ranges,
+                                  bool ignore_missing_column_families);
+
+  // With wal_streams > 1, a WAL file with its own writer queue, besides the
+  // one of logs_ and write_thread_. Defined after DBImpl.
+  struct WalStream;
+
+  // Returns the WAL stream the calling thread writes to, or nullptr if it
+  // has to join write_thread_.
+  WalStream* SelectWalStream(const WriteOptions& write_options);
+
+  // Quiesces or resumes the writes to wal_streams_. Calls nest.
+  // REQUIRES: mutex locked and in write thread.
+  void EnterWalStreamsUnbatched();
+  void ExitWalStreamsUnbatched();
+
+  // With wal_streams > 1, sequence numbers are allocated for a write group
+  // by AllocateWalStreamSequence(), which returns the last sequence number
+  // allocated before it, and published by PublishWalStreamSequence(), given
+  // the first sequence number of the group, once the group is in the WAL.
+  // LastSequence() only advances past the groups of every stream that are
+  // all in the WAL.
+  SequenceNumber AllocateWalStreamSequence(size_t seq_inc);
+  void PublishWalStreamSequence(SequenceNumber first_sequence);
+  // Waits until the write groups allocated before the one starting at
+  // first_sequence are published, so that a sync of the WALs of every
+  // stream also makes them durable.
+  void WaitForEarlierWalStreamGroups(SequenceNumber first_sequence);
+
   // Whether the batch requires to be assigned with an order
   enum AssignOrder : bool { kDontAssignOrder, kDoAssignOrder };
   // Whether it requires publishing last sequence or not
@@ -1278,7 +1329,8 @@ class DBImpl : public DB {
       WriteBatch* updates, WriteCallback* callback, uint64_t* log_used,
       const uint64_t log_ref, uint64_t* seq_used, const size_t sub_batch_cnt,
       PreReleaseCallback* pre_release_callback, const AssignOrder assign_order,
-      const PublishLastSeq publish_last_seq, const bool disable_memtable);
+      const PublishLastSeq publish_last_seq, const bool disable_memtable,
+      WalStream* wal_stream = nullptr);
 
   // write cached_recoverable_state_ to memtable if it is not empty
   // The writer must be the leader in write_thread_ and holding mutex_
@@ -1567,6 +1619,17 @@ class DBImpl : public DB {
                          SequenceNumber* next_sequence, bool read_only,
                          bool* corrupted_log_found);
 
+  // Replays the records of all the log files merged by sequence number, on
+  // behalf of RecoverLogFiles(). Sets *corrupted_wal_number to the last log
+  // with a corruption tolerated by point-in-time recovery, and
+  // *stop_replay_for_corruption if no other log continued after it.
+  Status RecoverWalStreams(const std::vector<uint64_t>& log_numbers,
+                           int job_id,
+                           std::unordered_map<int, VersionEdit>* version_edits,
+                           SequenceNumber* next_sequence, bool read_only,
+                           bool* flushed, bool* stop_replay_for_corruption,
+                           uint64_t* corrupted_wal_number);
+
   // The following two methods are used to flush a memtable to
   // storage. The first one is used at database RecoveryTime (when the
   // database is opened) and is heavyweight because it holds the mutex
@@ -1609,6 +1672,13 @@ class DBImpl : public DB {
 
   void SelectColumnFamiliesForAtomicFlush(autovector<ColumnFamilyData*>* cfds);
 
+  // Picks the column family to flush when the write buffer manager is full
+  // with its cost-aware flush policy. Adds nothing if no column family has
+  // data or the column family picked belongs to another DB.
+  // REQUIRES: mutex locked and in write thread.
+  void SelectColumnFamilyForCostAwareFlush(
+      autovector<ColumnFamilyData*>* cfds);
+
   // Force current memtable contents to be flushed.
   Status FlushMemTable(ColumnFamilyData* cfd, const FlushOptions& options,
                        FlushReason flush_reason, bool writes_stopped = false);
@@ -1696,6 +1766,12 @@ class DBImpl : public DB {
                                 uint64_t* log_used,
                                 SequenceNumber* last_sequence, size_t seq_inc);
 
+  // Writes the group to the WAL file of wal_stream. The caller must be the
+  // leader of its write thread.
+  IOStatus WalStreamWriteToWAL(const WriteThread::WriteGroup& write_group,
+                               WalStream* wal_stream, uint64_t* log_used,
+                               SequenceNumber* last_sequence, size_t seq_inc);
+
   // Used by WriteImpl to update bg_error_ if paranoid check is enabled.
   // Caller must hold mutex_.
   void WriteStatusCheckOnLocked(const Status& status);
@@ -2032,6 +2108,19 @@ class DBImpl : public DB {
   std::deque<LogWriterNumber> logs_;
   // Signaled when getting_synced becomes false for some of the logs_.
   InstrumentedCondVar log_sync_cv_;
+  // With pipelined_wal_sync, WAL write group leaders hand out tickets and
+  // the WAL sync thread syncs the logs up to the newest ticket. Tickets up to
+  // wal_sync_done_ are synced; wal_sync_status_ keeps the first sync error,
+  // which fails all later tickets too until ResumeImpl() flushed the
+  // memtables written to the unsynced WALs. Protected by wal_sync_mutex_.
+  InstrumentedMutex wal_sync_mutex_;
+  // Signaled when wal_sync_requested_ or wal_sync_done_ changes.
+  InstrumentedCondVar wal_sync_cv_;
+  uint64_t wal_sync_requested_ = 0;
+  uint64_t wal_sync_done_ = 0;
+  Status wal_sync_status_;
+  bool wal_sync_shutdown_ = false;
+  port::Thread wal_sync_thread_;
   // This is the app-level state that is written to the WAL but will be used
   // only during recovery. Using this feature enables not writing the state to
   // memtable on normal writes and hence improving the throughput. Each new
@@ -2065,6 +2154,25 @@ class DBImpl : public DB {
   // in 2PC to batch the prepares separately from the serial commit.
   WriteThread nonmem_write_thread_;
 
+  // The WAL streams besides the one of write_thread_ and logs_ when
+  // wal_streams > 1, empty otherwise.
+  std::vector<std::unique_ptr<WalStream>> wal_streams_;
+  // How many times the WAL streams are entered unbatched. Only accessed by the
+  // thread in write_thread_.
+  int wal_streams_unbatched_ = 0;
+  // The WAL files of wal_streams_ not known to be obsolete yet, ordered by
+  // number. Protected by mutex_.
+  std::deque<LogFileNumberSize> wal_stream_files_;
+  // Set while SyncWAL() syncs the current WAL files of wal_streams_, which are
+  // then not switched. Protected by mutex_, signaled with log_sync_cv_.
+  bool wal_streams_getting_synced_ = false;
+  // First sequence numbers of the write groups that allocated sequence
+  // numbers but are not in the WAL yet. Protected by wal_streams_mutex_.
+  std::mutex wal_streams_mutex_;
+  std::multiset<SequenceNumber> wal_streams_unpublished_;
+  // Signaled when a group is removed from wal_streams_unpublished_.
+  std::condition_variable wal_streams_published_cv_;
+
   WriteController write_controller_;
 
   // Size of the last batch group. In slowdown mode, next write needs to
@@ -2290,6 +2398,24 @@ class DBImpl : public DB {
   std::unique_ptr<StallInterface> wbm_stall_;
 };
 
+struct DBImpl::WalStream {
+  explicit WalStream(const ImmutableDBOptions& db_options)
+      : write_thread(db_options) {}
+
+  WriteThread write_thread;
+  // The fields below are accessed by the leader of write_thread, or by the
+  // thread that entered write_thread unbatched, which also holds mutex_ to
+  // switch them.
+  log::Writer* writer = nullptr;  // own
+  // Entry of wal_stream_files_ for the WAL file of writer
+  LogFileNumberSize* file = nullptr;
+  bool empty = true;
+  WriteBatch tmp_batch;
+  // Used by EnterWalStreamsUnbatched(). A Writer cannot be reused, so a new
+  // one is created for each call.
+  std::unique_ptr<WriteThread::Writer> unbatched_writer;
+};
+
 extern Options SanitizeOptions(const std::string& db, const Options& src,
                                bool read_only = false);
 
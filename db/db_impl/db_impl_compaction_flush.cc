@@ -13,6 +13,7 @@
 #include "db/error_handler.h"
 #include "db/event_helpers.h"
 #include "file/sst_file_manager_impl.h"
+#include "monitoring/flow_trace.h"
 #include "monitoring/iostats_context_imp.h"
 #include "monitoring/perf_context_imp.h"
 #include "monitoring/thread_status_updater.h"
@@ -21,13 +22,6 @@
 #include "util/cast_util.h"
 #include "util/concurrent_task_limiter_impl.h"
 
-// Contorl Write Flow Print - Signal.Jin
-int write_check_flag = 1;
-int write_flush_flag = 1;
-
-//Control Compaction Flow Print
-int comp_flag = 1;
-
 namespace ROCKSDB_NAMESPACE {
 
 bool DBImpl::EnoughRoomForCompaction(
@@ -159,10 +153,7 @@ Status DBImpl::FlushMemTableToOutputFile(
   assert(cfd->imm()->NumNotFlushed() != 0);
   assert(cfd->imm()->IsFlushPending());
 
-  if (DB_WRITE_FLOW == 1 && write_flush_flag == 1) {
-    fprintf(stdout, "  [18]        \t|       FlushMemTablesToOutputFile() {  | db_impl_compaction_and_flush.cc (line 160)\n"); // Signal.Jin
-    write_flush_flag = 0;
-  }
+  FLOW_TRACE_SCOPE(kFlowTraceFlush, "DBImpl::FlushMemTableToOutputFile");
 
   FlushJob flush_job(
       dbname_, cfd, immutable_db_options_, mutable_cf_options,
@@ -302,7 +293,7 @@ Status DBImpl::FlushMemTableToOutputFile(
                            flush_job.GetCommittedFlushJobsInfo());
     auto sfm = static_cast<SstFileManagerImpl*>(
         immutable_db_options_.sst_file_manager.get());
-    if (sfm) {
+    if (sfm && !flush_job.KeptMemTablesInMemory()) {
       // Notify sst_file_manager that a new file was added
       std::string file_path = MakeTableFileName(
           cfd->ioptions()->cf_paths[0].path, file_meta.fd.GetNumber());
@@ -310,6 +301,13 @@ Status DBImpl::FlushMemTableToOutputFile(
       // exists. Otherwise, some tests may fail.  Ignore the error in the
       // interim.
       sfm->OnAddFile(file_path).PermitUncheckedError();
+      for (const auto& partition_meta : flush_job.GetPartitionOutputs()) {
+        if (partition_meta.fd.GetFileSize() > 0) {
+          sfm->OnAddFile(MakeTableFileName(cfd->ioptions()->cf_paths[0].path,
+                                           partition_meta.fd.GetNumber()))
+              .PermitUncheckedError();
+        }
+      }
       if (sfm->IsMaxAllowedSpaceReached()) {
         Status new_bg_error =
             Status::SpaceLimit("Max allowed space was reached");
@@ -329,9 +327,7 @@ Status DBImpl::FlushMemTablesToOutputFiles(
     const autovector<BGFlushArg>& bg_flush_args, bool* made_progress,
     JobContext* job_context, LogBuffer* log_buffer, Env::Priority thread_pri) {
 
-  if (DB_WRITE_FLOW == 1 && write_flush_flag == 1) {
-    fprintf(stdout, "  [17]        \t|      FlushMemTablesToOutputFiles() {  | db_impl_compaction_and_flush.cc (line 332)\n"); // Signal.Jin
-  }
+  FLOW_TRACE_SCOPE(kFlowTraceFlush, "DBImpl::FlushMemTablesToOutputFiles");
 
   if (immutable_db_options_.atomic_flush) {
     return AtomicFlushMemTablesToOutputFiles(
@@ -672,7 +668,7 @@ Status DBImpl::AtomicFlushMemTablesToOutputFiles(
       }
       NotifyOnFlushCompleted(cfds[i], all_mutable_cf_options[i],
                              jobs[i]->GetCommittedFlushJobsInfo());
-      if (sfm) {
+      if (sfm && !jobs[i]->KeptMemTablesInMemory()) {
         std::string file_path = MakeTableFileName(
             cfds[i]->ioptions()->cf_paths[0].path, file_meta[i].fd.GetNumber());
         // TODO (PR7798).  We should only add the file to the FileManager if it
@@ -1847,6 +1843,7 @@ Status DBImpl::FlushMemTable(ColumnFamilyData* cfd,
         nonmem_write_thread_.EnterUnbatched(&nonmem_w, &mutex_);
       }
     }
+    EnterWalStreamsUnbatched();
     WaitForPendingWrites();
 
     if (flush_reason != FlushReason::kErrorRecoveryRetryFlush &&
@@ -1924,6 +1921,7 @@ Status DBImpl::FlushMemTable(ColumnFamilyData* cfd,
       MaybeScheduleFlushOrCompaction();
     }
 
+    ExitWalStreamsUnbatched();
     if (!writes_stopped) {
       write_thread_.ExitUnbatched(&w);
       if (two_write_queues_) {
@@ -1991,6 +1989,7 @@ Status DBImpl::AtomicFlushMemTables(
         nonmem_write_thread_.EnterUnbatched(&nonmem_w, &mutex_);
       }
     }
+    EnterWalStreamsUnbatched();
     WaitForPendingWrites();
 
     for (auto cfd : column_family_datas) {
@@ -2033,6 +2032,7 @@ Status DBImpl::AtomicFlushMemTables(
       MaybeScheduleFlushOrCompaction();
     }
 
+    ExitWalStreamsUnbatched();
     if (!writes_stopped) {
       write_thread_.ExitUnbatched(&w);
       if (two_write_queues_) {
@@ -2235,11 +2235,7 @@ void DBImpl::EnableManualCompaction() {
 void DBImpl::MaybeScheduleFlushOrCompaction() {
   mutex_.AssertHeld();
 
-  if (DB_WRITE_FLOW == 1 && write_check_flag == 1) {
-    //fprintf(stdout, "| db_bench Write Flow - MaybeScheduleFlushOrCompaction() in db_impl_compaction_flush.cc (line 2230) |\n"); // Signal.Jin
-    //fprintf(stdout, "| MaybeScheduleFlushOrCompaction() : Always Check whether flush or compaction is required |\n");
-    write_check_flag = 0;
-  }
+  FLOW_TRACE_SCOPE(kFlowTraceFlush, "DBImpl::MaybeScheduleFlushOrCompaction");
 
   if (!opened_successfully_) {
     // Compaction may introduce data race to DB open
@@ -2393,10 +2389,7 @@ ColumnFamilyData* DBImpl::PickCompactionFromQueue(
   assert(!compaction_queue_.empty());
   assert(*token == nullptr);
 
-  if (((DB_LVL_COMPACTION_FLOW == 1) || (DB_UNI_COMPACTION_FLOW == 1)) && (comp_flag == 1)) {
-    fprintf(stdout, "  [4]        \t|    PickCompactionFromQueue()    \t| db_impl_compaction_flush.cc (line 2393)\n"); // Signal.Jin
-    comp_flag = 0;
-  }
+  FLOW_TRACE_SCOPE(kFlowTraceCompaction, "DBImpl::PickCompactionFromQueue");
 
   autovector<ColumnFamilyData*> throttled_candidates;
   ColumnFamilyData* cfd = nullptr;
@@ -2471,9 +2464,7 @@ void DBImpl::BGWorkFlush(void* arg) {
 
   //printf("Trigger Flush\n"); //Signal.Jin
 
-  if (DB_WRITE_FLOW == 1 && write_flush_flag == 1) {
-    fprintf(stdout, "  [14]        \t|   BGWorkFlush() {      \t\t| db_impl_compaction_and_flush.cc (line 2407)\n"); // Signal.Jin
-  }
+  FLOW_TRACE_SCOPE(kFlowTraceFlush, "DBImpl::BGWorkFlush");
 
   IOSTATS_SET_THREAD_POOL_ID(fta.thread_pri_);
   TEST_SYNC_POINT("DBImpl::BGWorkFlush");
@@ -2489,12 +2480,7 @@ void DBImpl::BGWorkCompaction(void* arg) {
 
   //printf("Trigger Compaction\n"); // Signal.Jin
 
-  if (((DB_LVL_COMPACTION_FLOW == 1) || (DB_UNI_COMPACTION_FLOW == 1)) && (comp_flag == 1)) {
-    printf("--------------------------------------------------------------------------------------\n");
-    printf("# RocksDB Tracer: Function Graph (Compaction Flow)\n#\n");
-    printf("# Seq. Number\t Function Calls\t\t\t\t File Location\n");
-    fprintf(stdout, "  [1]        \t| BGWorkCompaction() {    \t\t| db_impl_compaction_flush.cc (line 2486)\n"); // Signal.Jin
-  }
+  FLOW_TRACE_SCOPE(kFlowTraceCompaction, "DBImpl::BGWorkCompaction");
 
   auto prepicked_compaction =
       static_cast<PrepickedCompaction*>(ca.prepicked_compaction);
@@ -2561,10 +2547,7 @@ Status DBImpl::BackgroundFlush(bool* made_progress, JobContext* job_context,
                                Env::Priority thread_pri) {
   mutex_.AssertHeld();
 
-  if (DB_WRITE_FLOW == 1 && write_flush_flag == 1) {
-    fprintf(stdout, "  [16]        \t|     BackgroundFlush() {      \t\t| db_impl_compaction_and_flush.cc (line 2554)\n"); // Signal.Jin
-    //fprintf(stdout, "| BackgroundFlush() : It actually flushes the immutable memtable to storage via a background thread |\n");
-  }
+  FLOW_TRACE_SCOPE(kFlowTraceFlush, "DBImpl::BackgroundFlush");
 
   Status status;
   *reason = FlushReason::kOthers;
@@ -2645,9 +2628,7 @@ void DBImpl::BackgroundCallFlush(Env::Priority thread_pri) {
   bool made_progress = false;
   JobContext job_context(next_job_id_.fetch_add(1), true);
 
-  if (DB_WRITE_FLOW == 1 && write_flush_flag == 1) {
-    fprintf(stdout, "  [15]        \t|    BackgroundCallFlush() {      \t| db_impl_compaction_and_flush.cc (line 2640)\n"); // Signal.Jin
-  }
+  FLOW_TRACE_SCOPE(kFlowTraceFlush, "DBImpl::BackgroundCallFlush");
 
   TEST_SYNC_POINT("DBImpl::BackgroundCallFlush:start");
 
@@ -2740,9 +2721,7 @@ void DBImpl::BackgroundCallCompaction(PrepickedCompaction* prepicked_compaction,
   JobContext job_context(next_job_id_.fetch_add(1), true);
   TEST_SYNC_POINT("BackgroundCallCompaction:0");
 
-  if (((DB_LVL_COMPACTION_FLOW == 1) || (DB_UNI_COMPACTION_FLOW == 1)) && (comp_flag == 1)) {
-    fprintf(stdout, "  [2]        \t|  BackgroudCallCompaction() {    \t| db_impl_compaction_flush.cc (line 2727)\n"); // Signal.Jin
-  }
+  FLOW_TRACE_SCOPE(kFlowTraceCompaction, "DBImpl::BackgroundCallCompaction");
 
   LogBuffer log_buffer(InfoLogLevel::INFO_LEVEL,
                        immutable_db_options_.info_log.get());
@@ -2871,9 +2850,7 @@ Status DBImpl::BackgroundCompaction(bool* made_progress,
                                     PrepickedCompaction* prepicked_compaction,
                                     Env::Priority thread_pri) {
   
-  if (((DB_LVL_COMPACTION_FLOW == 1) || (DB_UNI_COMPACTION_FLOW == 1)) && (comp_flag == 1)) {
-    fprintf(stdout, "  [3]        \t|   BackgroudCompaction() {    \t\t| db_impl_compaction_flush.cc (line 2858)\n"); // Signal.Jin
-  }
+  FLOW_TRACE_SCOPE(kFlowTraceCompaction, "DBImpl::BackgroundCompaction");
   
   /* Signal.Jin Time */
   //clock_t start, end;
@@ -112,6 +112,8 @@ Status DBImpl::TEST_SwitchMemtable(ColumnFamilyData* cfd) {
 
   Status s;
   void* writer = TEST_BeginWrite();
+  EnterWalStreamsUnbatched();
+  WaitForPendingWrites();
   if (two_write_queues_) {
     WriteThread::Writer nonmem_w;
     nonmem_write_thread_.EnterUnbatched(&nonmem_w, &mutex_);
@@ -120,6 +122,7 @@ Status DBImpl::TEST_SwitchMemtable(ColumnFamilyData* cfd) {
   } else {
     s = SwitchMemtable(cfd, &write_context);
   }
+  ExitWalStreamsUnbatched();
   TEST_EndWrite(writer);
   return s;
 }
@@ -287,6 +287,20 @@ void DBImpl::FindObsoleteFiles(JobContext* job_context, bool force,
     }
     // Current log cannot be obsolete.
     assert(!logs_.empty());
+    // The current files of the WAL streams are numbered after the current log,
+    // so they cannot be obsolete either.
+    while (!wal_stream_files_.empty() &&
+           wal_stream_files_.front().number < min_log_number) {
+      auto& earliest = wal_stream_files_.front();
+      job_context->log_delete_files.push_back(earliest.number);
+      if (job_context->size_log_to_delete == 0) {
+        job_context->prev_total_log_size = total_log_size_;
+        job_context->num_alive_log_files = num_alive_log_files;
+      }
+      job_context->size_log_to_delete += earliest.size;
+      total_log_size_ -= earliest.size;
+      wal_stream_files_.pop_front();
+    }
   }
 
   // We're just cleaning up for DB::Write().
@@ -6,7 +6,12 @@
 // Copyright (c) 2011 The LevelDB Authors. All rights reserved.
 // Use of this source code is governed by a BSD-style license that can be
 // found in the LICENSE file. See the AUTHORS file for names of contributors.
+#include <algorithm>
 #include <cinttypes>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <queue>
 
 #include "db/builder.h"
 #include "db/db_impl/db_impl.h"
@@ -21,6 +26,8 @@
 #include "rocksdb/table.h"
 #include "rocksdb/wal_filter.h"
 #include "test_util/sync_point.h"
+#include "util/coding.h"
+#include "util/compression.h"
 #include "util/rate_limiter.h"
 
 namespace ROCKSDB_NAMESPACE {
@@ -258,6 +265,51 @@ Status DBImpl::ValidateOptions(const DBOptions& db_options) {
         "atomic_flush is incompatible with enable_pipelined_write");
   }
 
+  if (db_options.wal_streams < 1) {
+    return Status::InvalidArgument("wal_streams must be at least 1");
+  }
+
+  if (db_options.wal_streams > 1) {
+    if (!db_options.unordered_write) {
+      return Status::InvalidArgument("wal_streams requires unordered_write");
+    }
+    if (db_options.two_write_queues) {
+      return Status::InvalidArgument(
+          "wal_streams is incompatible with two_write_queues");
+    }
+    if (db_options.manual_wal_flush) {
+      return Status::InvalidArgument(
+          "wal_streams is incompatible with manual_wal_flush");
+    }
+    if (db_options.recycle_log_file_num > 0) {
+      return Status::InvalidArgument(
+          "wal_streams is incompatible with recycle_log_file_num");
+    }
+    if (db_options.track_and_verify_wals_in_manifest) {
+      return Status::InvalidArgument(
+          "wal_streams is incompatible with "
+          "track_and_verify_wals_in_manifest");
+    }
+#ifndef ROCKSDB_LITE
+    if (db_options.wal_filter != nullptr) {
+      return Status::InvalidArgument(
+          "wal_streams is incompatible with wal_filter");
+    }
+#endif  // ROCKSDB_LITE
+  }
+
+  if (db_options.wal_compression != kNoCompression) {
+    if (!StreamingCompressionTypeSupported(db_options.wal_compression)) {
+      return Status::InvalidArgument(
+          "wal_compression is not supported for this compression type",
+          CompressionTypeToString(db_options.wal_compression));
+    }
+    if (db_options.recycle_log_file_num > 0) {
+      return Status::InvalidArgument(
+          "wal_compression is incompatible with recycle_log_file_num");
+    }
+  }
+
   // TODO remove this restriction
   if (db_options.atomic_flush && db_options.best_efforts_recovery) {
     return Status::InvalidArgument(
@@ -775,25 +827,155 @@ Status DBImpl::InitPersistStatsColumnFamily() {
   return s;
 }
 
+namespace {
+struct LogReporter : public log::Reader::Reporter {
+  Env* env;
+  Logger* info_log;
+  const char* fname;
+  Status* status;  // nullptr if immutable_db_options_.paranoid_checks==false
+  void Corruption(size_t bytes, const Status& s) override {
+    ROCKS_LOG_WARN(info_log, "%s%s: dropping %d bytes; %s",
+                   (status == nullptr ? "(ignoring error) " : ""), fname,
+                   static_cast<int>(bytes), s.ToString().c_str());
+    if (status != nullptr && status->ok()) {
+      *status = s;
+    }
+  }
+};
+
+// With wal_recovery_threads > 1, write batches read from the WAL are inserted
+// concurrently in groups of about this many bytes.
+const size_t kRecoveryInsertGroupBytes = 4 << 20;
+
+// Accepts every entry, so that iterating a write batch with it only checks
+// that the batch parses.
+class WriteBatchChecker : public WriteBatch::Handler {
+ public:
+  Status PutCF(uint32_t, const Slice&, const Slice&) override {
+    return Status::OK();
+  }
+  Status DeleteCF(uint32_t, const Slice&) override { return Status::OK(); }
+  Status SingleDeleteCF(uint32_t, const Slice&) override {
+    return Status::OK();
+  }
+  Status DeleteRangeCF(uint32_t, const Slice&, const Slice&) override {
+    return Status::OK();
+  }
+  Status MergeCF(uint32_t, const Slice&, const Slice&) override {
+    return Status::OK();
+  }
+  Status PutBlobIndexCF(uint32_t, const Slice&, const Slice&) override {
+    return Status::OK();
+  }
+  Status MarkBeginPrepare(bool) override { return Status::OK(); }
+  Status MarkEndPrepare(const Slice&) override { return Status::OK(); }
+  Status MarkNoop(bool) override { return Status::OK(); }
+  Status MarkRollback(const Slice&) override { return Status::OK(); }
+  Status MarkCommit(const Slice&) override { return Status::OK(); }
+};
+
+// Reads the records of a WAL on a separate thread, ahead of the recovery
+// that consumes them with Next(), and checks that the write batches in them
+// parse. Reading stops at the end of the WAL, when `read_status` (the status
+// the log reader reports corruptions to) is not OK, or on destruction. At most
+// about `max_buffered_bytes` of records are read ahead.
+class WalRecordPrefetcher {
+ public:
+  // Bounds the memory used by the records read ahead from all WALs.
+  static const size_t kMaxBufferedBytes = 16 << 20;
+  static const size_t kMinBufferedBytes = 1 << 20;
+
+  WalRecordPrefetcher(log::Reader* reader, WALRecoveryMode recovery_mode,
+                      const Status* read_status, size_t max_buffered_bytes)
+      : reader_(reader),
+        recovery_mode_(recovery_mode),
+        read_status_(read_status),
+        max_buffered_bytes_(max_buffered_bytes) {
+    thread_ = port::Thread([this]() { Run(); });
+  }
+
+  ~WalRecordPrefetcher() {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      stopped_ = true;
+    }
+    cv_.notify_all();
+    thread_.join();
+  }
+
+  // Returns the next record and the result of parsing it as a write batch,
+  // or false once reading stopped. `*record` is valid until the next call.
+  bool Next(Slice* record, Status* batch_status) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    cv_.wait(lock, [this]() { return !records_.empty() || done_; });
+    if (records_.empty()) {
+      return false;
+    }
+    current_ = std::move(records_.front());
+    records_.pop_front();
+    buffered_bytes_ -= current_.contents.size();
+    cv_.notify_all();
+    *record = current_.contents;
+    *batch_status = current_.batch_status;
+    return true;
+  }
+
+ private:
+  struct Record {
+    std::string contents;
+    Status batch_status;
+  };
+
+  void Run() {
+    std::string scratch;
+    Slice slice;
+    while (reader_->ReadRecord(&slice, &scratch, recovery_mode_) &&
+           read_status_->ok()) {
+      Record record;
+      record.contents.assign(slice.data(), slice.size());
+      // Records too small for a write batch are reported by the recovery.
+      if (record.contents.size() >= WriteBatchInternal::kHeader) {
+        WriteBatch batch(record.contents);
+        WriteBatchChecker checker;
+        record.batch_status = batch.Iterate(&checker);
+      }
+      std::unique_lock<std::mutex> lock(mutex_);
+      cv_.wait(lock, [this]() {
+        return stopped_ || buffered_bytes_ < max_buffered_bytes_;
+      });
+      if (stopped_) {
+        return;
+      }
+      buffered_bytes_ += record.contents.size();
+      records_.push_back(std::move(record));
+      cv_.notify_all();
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    done_ = true;
+    cv_.notify_all();
+  }
+
+  log::Reader* const reader_;
+  const WALRecoveryMode recovery_mode_;
+  const Status* const read_status_;
+  const size_t max_buffered_bytes_;
+
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  std::deque<Record> records_;
+  size_t buffered_bytes_ = 0;
+  bool done_ = false;
+  bool stopped_ = false;
+  // Returned by the last call to Next().
+  Record current_;
+  port::Thread thread_;
+};
+}  // namespace
+
 // REQUIRES: wal_numbers are sorted in ascending order
 Status DBImpl::RecoverLogFiles(const std::vector<uint64_t>& wal_numbers,
                                SequenceNumber* next_sequence, bool read_only,
                                bool* corrupted_wal_found) {
-  struct LogReporter : public log::Reader::Reporter {
-    Env* env;
-    Logger* info_log;
-    const char* fname;
-    Status* status;  // nullptr if immutable_db_options_.paranoid_checks==false
-    void Corruption(size_t bytes, const Status& s) override {
-      ROCKS_LOG_WARN(info_log, "%s%s: dropping %d bytes; %s",
-                     (status == nullptr ? "(ignoring error) " : ""), fname,
-                     static_cast<int>(bytes), s.ToString().c_str());
-      if (status != nullptr && status->ok()) {
-        *status = s;
-      }
-    }
-  };
-
   mutex_.AssertHeld();
   Status status;
   std::unordered_map<int, VersionEdit> version_edits;
@@ -831,297 +1013,24 @@ Status DBImpl::RecoverLogFiles(const std::vector<uint64_t>& wal_numbers,
   }
 #endif
 
-  bool stop_replay_by_wal_filter = false;
+  // The records of all the WALs are replayed merged in sequence number
+  // order. WALs written with wal_streams > 1 interleave, and those of an
+  // earlier incarnation may have been written with other options than the
+  // current ones, so this is done whatever wal_streams is. Otherwise the
+  // merge replays one WAL after the other.
   bool stop_replay_for_corruption = false;
   bool flushed = false;
   uint64_t corrupted_wal_number = kMaxSequenceNumber;
-  uint64_t min_wal_number = MinLogNumberToKeep();
-  for (auto wal_number : wal_numbers) {
-    if (wal_number < min_wal_number) {
-      ROCKS_LOG_INFO(immutable_db_options_.info_log,
-                     "Skipping log #%" PRIu64
-                     " since it is older than min log to keep #%" PRIu64,
-                     wal_number, min_wal_number);
-      continue;
-    }
-    // The previous incarnation may not have written any MANIFEST
-    // records after allocating this log number.  So we manually
-    // update the file number allocation counter in VersionSet.
-    versions_->MarkFileNumberUsed(wal_number);
-    // Open the log file
-    std::string fname = LogFileName(immutable_db_options_.wal_dir, wal_number);
-
-    ROCKS_LOG_INFO(immutable_db_options_.info_log,
-                   "Recovering log #%" PRIu64 " mode %d", wal_number,
-                   static_cast<int>(immutable_db_options_.wal_recovery_mode));
-    auto logFileDropped = [this, &fname]() {
-      uint64_t bytes;
-      if (env_->GetFileSize(fname, &bytes).ok()) {
-        auto info_log = immutable_db_options_.info_log.get();
-        ROCKS_LOG_WARN(info_log, "%s: dropping %d bytes", fname.c_str(),
-                       static_cast<int>(bytes));
-      }
-    };
-    if (stop_replay_by_wal_filter) {
-      logFileDropped();
-      continue;
-    }
-
-    std::unique_ptr<SequentialFileReader> file_reader;
-    {
-      std::unique_ptr<FSSequentialFile> file;
-      status = fs_->NewSequentialFile(fname,
-                                      fs_->OptimizeForLogRead(file_options_),
-                                      &file, nullptr);
-      if (!status.ok()) {
-        MaybeIgnoreError(&status);
-        if (!status.ok()) {
-          return status;
-        } else {
-          // Fail with one log file, but that's ok.
-          // Try next one.
-          continue;
-        }
-      }
-      file_reader.reset(new SequentialFileReader(
-          std::move(file), fname, immutable_db_options_.log_readahead_size,
-          io_tracer_));
-    }
-
-    // Create the log reader.
-    LogReporter reporter;
-    reporter.env = env_;
-    reporter.info_log = immutable_db_options_.info_log.get();
-    reporter.fname = fname.c_str();
-    if (!immutable_db_options_.paranoid_checks ||
-        immutable_db_options_.wal_recovery_mode ==
-            WALRecoveryMode::kSkipAnyCorruptedRecords) {
-      reporter.status = nullptr;
-    } else {
-      reporter.status = &status;
-    }
-    // We intentially make log::Reader do checksumming even if
-    // paranoid_checks==false so that corruptions cause entire commits
-    // to be skipped instead of propagating bad information (like overly
-    // large sequence numbers).
-    log::Reader reader(immutable_db_options_.info_log, std::move(file_reader),
-                       &reporter, true /*checksum*/, wal_number);
-
-    // Determine if we should tolerate incomplete records at the tail end of the
-    // Read all the records and add to a memtable
-    std::string scratch;
-    Slice record;
-    WriteBatch batch;
-
-    TEST_SYNC_POINT_CALLBACK("DBImpl::RecoverLogFiles:BeforeReadWal",
-                             /*arg=*/nullptr);
-    while (!stop_replay_by_wal_filter &&
-           reader.ReadRecord(&record, &scratch,
-                             immutable_db_options_.wal_recovery_mode) &&
-           status.ok()) {
-      if (record.size() < WriteBatchInternal::kHeader) {
-        reporter.Corruption(record.size(),
-                            Status::Corruption("log record too small"));
-        continue;
-      }
-
-      status = WriteBatchInternal::SetContents(&batch, record);
-      if (!status.ok()) {
-        return status;
-      }
-      SequenceNumber sequence = WriteBatchInternal::Sequence(&batch);
-
-      if (immutable_db_options_.wal_recovery_mode ==
-          WALRecoveryMode::kPointInTimeRecovery) {
-        // In point-in-time recovery mode, if sequence id of log files are
-        // consecutive, we continue recovery despite corruption. This could
-        // happen when we open and write to a corrupted DB, where sequence id
-        // will start from the last sequence id we recovered.
-        if (sequence == *next_sequence) {
-          stop_replay_for_corruption = false;
-        }
-        if (stop_replay_for_corruption) {
-          logFileDropped();
-          break;
-        }
-      }
-
-#ifndef ROCKSDB_LITE
-      if (immutable_db_options_.wal_filter != nullptr) {
-        WriteBatch new_batch;
-        bool batch_changed = false;
-
-        WalFilter::WalProcessingOption wal_processing_option =
-            immutable_db_options_.wal_filter->LogRecordFound(
-                wal_number, fname, batch, &new_batch, &batch_changed);
-
-        switch (wal_processing_option) {
-          case WalFilter::WalProcessingOption::kContinueProcessing:
-            // do nothing, proceeed normally
-            break;
-          case WalFilter::WalProcessingOption::kIgnoreCurrentRecord:
-            // skip current record
-            continue;
-          case WalFilter::WalProcessingOption::kStopReplay:
-            // skip current record and stop replay
-            stop_replay_by_wal_filter = true;
-            continue;
-          case WalFilter::WalProcessingOption::kCorruptedRecord: {
-            status =
-                Status::Corruption("Corruption reported by Wal Filter ",
-                                   immutable_db_options_.wal_filter->Name());
-            MaybeIgnoreError(&status);
-            if (!status.ok()) {
-              reporter.Corruption(record.size(), status);
-              continue;
-            }
-            break;
-          }
-          default: {
-            assert(false);  // unhandled case
-            status = Status::NotSupported(
-                "Unknown WalProcessingOption returned"
-                " by Wal Filter ",
-                immutable_db_options_.wal_filter->Name());
-            MaybeIgnoreError(&status);
-            if (!status.ok()) {
-              return status;
-            } else {
-              // Ignore the error with current record processing.
-              continue;
-            }
-          }
-        }
-
-        if (batch_changed) {
-          // Make sure that the count in the new batch is
-          // within the orignal count.
-          int new_count = WriteBatchInternal::Count(&new_batch);
-          int original_count = WriteBatchInternal::Count(&batch);
-          if (new_count > original_count) {
-            ROCKS_LOG_FATAL(
-                immutable_db_options_.info_log,
-                "Recovering log #%" PRIu64
-                " mode %d log filter %s returned "
-                "more records (%d) than original (%d) which is not allowed. "
-                "Aborting recovery.",
-                wal_number,
-                static_cast<int>(immutable_db_options_.wal_recovery_mode),
-                immutable_db_options_.wal_filter->Name(), new_count,
-                original_count);
-            status = Status::NotSupported(
-                "More than original # of records "
-                "returned by Wal Filter ",
-                immutable_db_options_.wal_filter->Name());
-            return status;
-          }
-          // Set the same sequence number in the new_batch
-          // as the original batch.
-          WriteBatchInternal::SetSequence(&new_batch,
-                                          WriteBatchInternal::Sequence(&batch));
-          batch = new_batch;
-        }
-      }
-#endif  // ROCKSDB_LITE
-
-      // If column family was not found, it might mean that the WAL write
-      // batch references to the column family that was dropped after the
-      // insert. We don't want to fail the whole write batch in that case --
-      // we just ignore the update.
-      // That's why we set ignore missing column families to true
-      bool has_valid_writes = false;
-      status = WriteBatchInternal::InsertInto(
-          &batch, column_family_memtables_.get(), &flush_scheduler_,
-          &trim_history_scheduler_, true, wal_number, this,
-          false /* concurrent_memtable_writes */, next_sequence,
-          &has_valid_writes, seq_per_batch_, batch_per_txn_);
-      MaybeIgnoreError(&status);
-      if (!status.ok()) {
-        // We are treating this as a failure while reading since we read valid
-        // blocks that do not form coherent data
-        reporter.Corruption(record.size(), status);
-        continue;
-      }
-
-      if (has_valid_writes && !read_only) {
-        // we can do this because this is called before client has access to the
-        // DB and there is only a single thread operating on DB
-        ColumnFamilyData* cfd;
-
-        while ((cfd = flush_scheduler_.TakeNextColumnFamily()) != nullptr) {
-          cfd->UnrefAndTryDelete();
-          // If this asserts, it means that InsertInto failed in
-          // filtering updates to already-flushed column families
-          assert(cfd->GetLogNumber() <= wal_number);
-          auto iter = version_edits.find(cfd->GetID());
-          assert(iter != version_edits.end());
-          VersionEdit* edit = &iter->second;
-          status = WriteLevel0TableForRecovery(job_id, cfd, cfd->mem(), edit);
-          if (!status.ok()) {
-            // Reflect errors immediately so that conditions like full
-            // file-systems cause the DB::Open() to fail.
-            return status;
-          }
-          flushed = true;
-
-          cfd->CreateNewMemtable(*cfd->GetLatestMutableCFOptions(),
-                                 *next_sequence);
-        }
-      }
-    }
-
-    if (!status.ok()) {
-      if (status.IsNotSupported()) {
-        // We should not treat NotSupported as corruption. It is rather a clear
-        // sign that we are processing a WAL that is produced by an incompatible
-        // version of the code.
-        return status;
-      }
-      if (immutable_db_options_.wal_recovery_mode ==
-          WALRecoveryMode::kSkipAnyCorruptedRecords) {
-        // We should ignore all errors unconditionally
-        status = Status::OK();
-      } else if (immutable_db_options_.wal_recovery_mode ==
-                 WALRecoveryMode::kPointInTimeRecovery) {
-        if (status.IsIOError()) {
-          ROCKS_LOG_ERROR(immutable_db_options_.info_log,
-                          "IOError during point-in-time reading log #%" PRIu64
-                          " seq #%" PRIu64
-                          ". %s. This likely mean loss of synced WAL, "
-                          "thus recovery fails.",
-                          wal_number, *next_sequence,
-                          status.ToString().c_str());
-          return status;
-        }
-        // We should ignore the error but not continue replaying
-        status = Status::OK();
-        stop_replay_for_corruption = true;
-        corrupted_wal_number = wal_number;
-        if (corrupted_wal_found != nullptr) {
-          *corrupted_wal_found = true;
-        }
-        ROCKS_LOG_INFO(immutable_db_options_.info_log,
-                       "Point in time recovered to log #%" PRIu64
-                       " seq #%" PRIu64,
-                       wal_number, *next_sequence);
-      } else {
-        assert(immutable_db_options_.wal_recovery_mode ==
-                   WALRecoveryMode::kTolerateCorruptedTailRecords ||
-               immutable_db_options_.wal_recovery_mode ==
-                   WALRecoveryMode::kAbsoluteConsistency);
-        return status;
-      }
-    }
-
-    flush_scheduler_.Clear();
-    trim_history_scheduler_.Clear();
-    auto last_sequence = *next_sequence - 1;
-    if ((*next_sequence != kMaxSequenceNumber) &&
-        (versions_->LastSequence() <= last_sequence)) {
-      versions_->SetLastAllocatedSequence(last_sequence);
-      versions_->SetLastPublishedSequence(last_sequence);
-      versions_->SetLastSequence(last_sequence);
-    }
+  status = RecoverWalStreams(wal_numbers, job_id, &version_edits,
+                             next_sequence, read_only, &flushed,
+                             &stop_replay_for_corruption,
+                             &corrupted_wal_number);
+  if (!status.ok()) {
+    return status;
+  }
+  if (corrupted_wal_number != kMaxSequenceNumber &&
+      corrupted_wal_found != nullptr) {
+    *corrupted_wal_found = true;
   }
   // Compare the corrupted log number to all columnfamily's current log number.
   // Abort Open() if any column family's log number is greater than
@@ -1271,6 +1180,545 @@ Status DBImpl::RecoverLogFiles(const std::vector<uint64_t>& wal_numbers,
   return status;
 }
 
+Status DBImpl::RecoverWalStreams(
+    const std::vector<uint64_t>& wal_numbers, int job_id,
+    std::unordered_map<int, VersionEdit>* version_edits,
+    SequenceNumber* next_sequence, bool read_only, bool* flushed,
+    bool* stop_replay_for_corruption, uint64_t* corrupted_wal_number) {
+  mutex_.AssertHeld();
+  const WALRecoveryMode recovery_mode =
+      immutable_db_options_.wal_recovery_mode;
+  // With wal_recovery_threads > 1, the records of each WAL are read ahead
+  // by a WalRecordPrefetcher and groups of their write batches are inserted
+  // into the memtables concurrently. This relies on every write batch
+  // carrying the sequence number of its first entry.
+  bool parallel_insert = immutable_db_options_.wal_recovery_threads > 1 &&
+                         !immutable_db_options_.allow_2pc && !seq_per_batch_ &&
+                         batch_per_txn_;
+  for (auto cfd : *versions_->GetColumnFamilySet()) {
+    if (!cfd->ioptions()->memtable_factory->IsInsertConcurrentlySupported() ||
+        cfd->ioptions()->inplace_update_support ||
+        cfd->GetLatestMutableCFOptions()->max_successive_merges > 0) {
+      parallel_insert = false;
+    }
+  }
+
+  // A WAL and its next record
+  struct WalCursor {
+    uint64_t wal_number;
+    std::string fname;
+    LogReporter reporter;
+    Status status;
+    // The prefetcher thread reports corruptions to read_status, which is
+    // only looked at once the records read before are consumed.
+    LogReporter read_reporter;
+    Status read_status;
+    std::unique_ptr<log::Reader> reader;
+    std::unique_ptr<WalRecordPrefetcher> prefetcher;
+    std::string scratch;
+    Slice record;
+    Status batch_status;
+    // Of the current record, or the last one if failed
+    SequenceNumber sequence = 0;
+    bool has_record = false;
+    // Set once a corruption was reported to status
+    bool failed = false;
+  };
+  // Moves the cursor to the next record, returning false at the end of the
+  // WAL or if a corruption was reported to cursor->status.
+  auto advance = [&](WalCursor* cursor) {
+    while ((cursor->prefetcher != nullptr
+                ? cursor->prefetcher->Next(&cursor->record,
+                                           &cursor->batch_status)
+                : cursor->reader->ReadRecord(&cursor->record, &cursor->scratch,
+                                             recovery_mode)) &&
+           cursor->status.ok()) {
+      if (cursor->record.size() < WriteBatchInternal::kHeader) {
+        cursor->reporter.Corruption(
+            cursor->record.size(), Status::Corruption("log record too small"));
+        continue;
+      }
+      // The sequence number of the write batch
+      cursor->sequence = DecodeFixed64(cursor->record.data());
+      cursor->has_record = true;
+      return true;
+    }
+    if (cursor->prefetcher != nullptr) {
+      cursor->prefetcher.reset();
+      if (cursor->status.ok()) {
+        cursor->status = cursor->read_status;
+      }
+    }
+    return false;
+  };
+  auto logFileDropped = [this](const WalCursor* cursor) {
+    uint64_t bytes;
+    if (env_->GetFileSize(cursor->fname, &bytes).ok()) {
+      auto info_log = immutable_db_options_.info_log.get();
+      ROCKS_LOG_WARN(info_log, "%s: dropping %d bytes", cursor->fname.c_str(),
+                     static_cast<int>(bytes));
+    }
+  };
+
+  // With parallel_insert, all WALs may be read at the same time, so they
+  // share the read ahead budget of one.
+  const size_t max_buffered_bytes =
+      std::max(WalRecordPrefetcher::kMaxBufferedBytes /
+                   std::max(wal_numbers.size(), size_t{1}),
+               size_t{WalRecordPrefetcher::kMinBufferedBytes});
+  // Opens the WAL of the cursor, reading it ahead if `prefetch`.
+  auto open_reader = [&](WalCursor* cursor, bool prefetch) {
+    std::unique_ptr<FSSequentialFile> file;
+    Status s = fs_->NewSequentialFile(cursor->fname,
+                                      fs_->OptimizeForLogRead(file_options_),
+                                      &file, nullptr);
+    if (!s.ok()) {
+      return s;
+    }
+    std::unique_ptr<SequentialFileReader> file_reader(new SequentialFileReader(
+        std::move(file), cursor->fname,
+        immutable_db_options_.log_readahead_size, io_tracer_));
+    // We intentially make log::Reader do checksumming even if
+    // paranoid_checks==false so that corruptions cause entire commits
+    // to be skipped instead of propagating bad information (like overly
+    // large sequence numbers).
+    cursor->reader.reset(new log::Reader(
+        immutable_db_options_.info_log, std::move(file_reader),
+        prefetch ? &cursor->read_reporter : &cursor->reporter,
+        true /*checksum*/, cursor->wal_number));
+    if (prefetch) {
+      cursor->prefetcher.reset(new WalRecordPrefetcher(
+          cursor->reader.get(), recovery_mode, &cursor->read_status,
+          max_buffered_bytes));
+    }
+    return s;
+  };
+
+  Status status;
+  std::vector<std::unique_ptr<WalCursor>> cursors;
+  uint64_t min_wal_number = MinLogNumberToKeep();
+  for (auto wal_number : wal_numbers) {
+    if (wal_number < min_wal_number) {
+      ROCKS_LOG_INFO(immutable_db_options_.info_log,
+                     "Skipping log #%" PRIu64
+                     " since it is older than min log to keep #%" PRIu64,
+                     wal_number, min_wal_number);
+      continue;
+    }
+    // The previous incarnation may not have written any MANIFEST
+    // records after allocating this log number.  So we manually
+    // update the file number allocation counter in VersionSet.
+    versions_->MarkFileNumberUsed(wal_number);
+    std::unique_ptr<WalCursor> cursor(new WalCursor());
+    cursor->wal_number = wal_number;
+    cursor->fname = LogFileName(immutable_db_options_.wal_dir, wal_number);
+    ROCKS_LOG_INFO(immutable_db_options_.info_log,
+                   "Recovering log #%" PRIu64 " mode %d", wal_number,
+                   static_cast<int>(recovery_mode));
+    cursor->reporter.env = env_;
+    cursor->reporter.info_log = immutable_db_options_.info_log.get();
+    cursor->reporter.fname = cursor->fname.c_str();
+    if (!immutable_db_options_.paranoid_checks ||
+        recovery_mode == WALRecoveryMode::kSkipAnyCorruptedRecords) {
+      cursor->reporter.status = nullptr;
+    } else {
+      cursor->reporter.status = &cursor->status;
+    }
+    cursor->read_reporter = cursor->reporter;
+    if (cursor->reporter.status != nullptr) {
+      cursor->read_reporter.status = &cursor->read_status;
+    }
+    cursors.push_back(std::move(cursor));
+  }
+
+  TEST_SYNC_POINT_CALLBACK("DBImpl::RecoverLogFiles:BeforeReadWal",
+                           /*arg=*/nullptr);
+
+  // The cursors ordered by the sequence number of their next record, and by
+  // WAL number for equal ones. Each WAL is in sequence number order, so the
+  // records are replayed in sequence number order too. A WAL is only kept
+  // open from its first record on, so that WALs that do not interleave, as
+  // with wal_streams = 1, are opened and replayed one after the other.
+  auto later = [](const WalCursor* a, const WalCursor* b) {
+    return a->sequence != b->sequence ? a->sequence > b->sequence
+                                      : a->wal_number > b->wal_number;
+  };
+  std::priority_queue<WalCursor*, std::vector<WalCursor*>, decltype(later)>
+      heap(later);
+
+  // Flushes the memtables that InsertInto() scheduled for flush. We can do
+  // this because this is called before client has access to the DB and
+  // there is only a single thread operating on DB
+  auto flush_scheduled_memtables = [&](uint64_t wal_number) {
+    ColumnFamilyData* cfd;
+    while ((cfd = flush_scheduler_.TakeNextColumnFamily()) != nullptr) {
+      cfd->UnrefAndTryDelete();
+      // If this asserts, it means that InsertInto failed in
+      // filtering updates to already-flushed column families
+      assert(cfd->GetLogNumber() <= wal_number);
+      (void)wal_number;
+      auto iter = version_edits->find(cfd->GetID());
+      assert(iter != version_edits->end());
+      Status s =
+          WriteLevel0TableForRecovery(job_id, cfd, cfd->mem(), &iter->second);
+      if (!s.ok()) {
+        return s;
+      }
+      *flushed = true;
+
+      cfd->CreateNewMemtable(*cfd->GetLatestMutableCFOptions(),
+                             *next_sequence);
+    }
+    return Status::OK();
+  };
+
+  // Write batches waiting to be inserted concurrently, with the cursors
+  // they were read from.
+  std::vector<WriteBatch> pending_batches;
+  std::vector<WalCursor*> pending_cursors;
+  std::vector<size_t> pending_record_sizes;
+  size_t pending_bytes = 0;
+  // Inserts pending_batches on up to wal_recovery_threads threads, thread t
+  // taking every wal_recovery_threads-th batch from the t-th. Returns a
+  // non-OK status if the recovery must stop.
+  auto insert_pending_batches = [&]() {
+    const size_t num_batches = pending_batches.size();
+    if (num_batches == 0) {
+      return Status::OK();
+    }
+    const size_t num_threads = std::min(
+        num_batches,
+        static_cast<size_t>(immutable_db_options_.wal_recovery_threads));
+    std::vector<Status> statuses(num_batches);
+    std::vector<SequenceNumber> next_sequences(num_batches);
+    std::unique_ptr<bool[]> valid_writes(new bool[num_batches]());
+    auto insert = [&](size_t first) {
+      ColumnFamilyMemTablesImpl column_family_memtables(
+          versions_->GetColumnFamilySet());
+      for (size_t i = first; i < num_batches; i += num_threads) {
+        statuses[i] = WriteBatchInternal::InsertInto(
+            &pending_batches[i], &column_family_memtables, &flush_scheduler_,
+            &trim_history_scheduler_, true, pending_cursors[i]->wal_number,
+            this, true /* concurrent_memtable_writes */, &next_sequences[i],
+            &valid_writes[i], seq_per_batch_, batch_per_txn_);
+      }
+    };
+    std::vector<port::Thread> threads;
+    for (size_t t = 1; t < num_threads; t++) {
+      threads.emplace_back(insert, t);
+    }
+    insert(0);
+    for (auto& thread : threads) {
+      thread.join();
+    }
+
+    bool has_valid_writes = false;
+    for (size_t i = 0; i < num_batches; i++) {
+      MaybeIgnoreError(&statuses[i]);
+      if (!statuses[i].ok()) {
+        WalCursor* cursor = pending_cursors[i];
+        cursor->reporter.Corruption(pending_record_sizes[i], statuses[i]);
+        if (!cursor->status.ok()) {
+          // Unlike a serial replay, which would stop before the next
+          // batches, they may already be inserted.
+          return cursor->status;
+        }
+        continue;
+      }
+      has_valid_writes = has_valid_writes || valid_writes[i];
+    }
+    *next_sequence = next_sequences[num_batches - 1];
+    const uint64_t last_wal_number = pending_cursors.back()->wal_number;
+    pending_batches.clear();
+    pending_cursors.clear();
+    pending_record_sizes.clear();
+    pending_bytes = 0;
+    if (has_valid_writes && !read_only) {
+      return flush_scheduled_memtables(last_wal_number);
+    }
+    return Status::OK();
+  };
+
+  // A cursor that reported an error stays in the heap, after the last record
+  // it returned, until the records before the error are replayed.
+  auto read_next = [&](WalCursor* cursor) {
+    if (advance(cursor)) {
+      heap.push(cursor);
+    } else if (!cursor->status.ok()) {
+      cursor->failed = true;
+      heap.push(cursor);
+    }
+  };
+  // Looks up the sequence number of the first record of every WAL, and closes
+  // it until the replay gets there.
+  std::vector<WalCursor*> failed_at_start;
+  for (auto& cursor : cursors) {
+    status = open_reader(cursor.get(), false /* prefetch */);
+    if (!status.ok()) {
+      MaybeIgnoreError(&status);
+      if (!status.ok()) {
+        return status;
+      }
+      // Fail with one log file, but that's ok.
+      continue;
+    }
+    if (advance(cursor.get())) {
+      heap.push(cursor.get());
+    } else if (!cursor->status.ok()) {
+      cursor->failed = true;
+      cursor->sequence = kMaxSequenceNumber;
+      failed_at_start.push_back(cursor.get());
+    }
+    cursor->reader.reset();
+  }
+  // A WAL that fails before its first record goes right before the first
+  // records of the later WALs, which is where its records are when the WALs
+  // are written one after the other.
+  for (WalCursor* cursor : failed_at_start) {
+    for (auto& other : cursors) {
+      if (other->wal_number > cursor->wal_number && other->has_record) {
+        cursor->sequence = std::min(cursor->sequence, other->sequence);
+      }
+    }
+    heap.push(cursor);
+  }
+
+  bool stop_replay_by_wal_filter = false;
+  WriteBatch batch;
+  while (!heap.empty()) {
+    WalCursor* cursor = heap.top();
+    heap.pop();
+    if (stop_replay_by_wal_filter) {
+      logFileDropped(cursor);
+      continue;
+    }
+    if (cursor->failed) {
+      // The pending batches precede the error.
+      status = insert_pending_batches();
+      if (!status.ok()) {
+        return status;
+      }
+      status = cursor->status;
+      if (status.IsNotSupported()) {
+        // We should not treat NotSupported as corruption. It is rather a
+        // clear sign that we are processing a WAL that is produced by an
+        // incompatible version of the code.
+        return status;
+      }
+      if (recovery_mode != WALRecoveryMode::kPointInTimeRecovery) {
+        assert(recovery_mode ==
+                   WALRecoveryMode::kTolerateCorruptedTailRecords ||
+               recovery_mode == WALRecoveryMode::kAbsoluteConsistency);
+        return status;
+      }
+      if (status.IsIOError()) {
+        ROCKS_LOG_ERROR(immutable_db_options_.info_log,
+                        "IOError during point-in-time reading log #%" PRIu64
+                        " seq #%" PRIu64
+                        ". %s. This likely mean loss of synced WAL, "
+                        "thus recovery fails.",
+                        cursor->wal_number, *next_sequence,
+                        status.ToString().c_str());
+        return status;
+      }
+      // We should ignore the error but not continue replaying, unless the
+      // records of other WALs follow on without a gap in sequence numbers.
+      // This happens when we open and write to a corrupted DB, where
+      // sequence id will start from the last sequence id we recovered.
+      status = Status::OK();
+      *stop_replay_for_corruption = true;
+      *corrupted_wal_number = cursor->wal_number;
+      ROCKS_LOG_INFO(immutable_db_options_.info_log,
+                     "Point in time recovered to log #%" PRIu64
+                     " seq #%" PRIu64,
+                     cursor->wal_number, *next_sequence);
+      continue;
+    }
+    if (*stop_replay_for_corruption) {
+      if (cursor->sequence == *next_sequence) {
+        *stop_replay_for_corruption = false;
+      } else {
+        logFileDropped(cursor);
+        continue;
+      }
+    }
+    if (cursor->reader == nullptr) {
+      // Reopens the WAL at its first record.
+      status = open_reader(cursor, parallel_insert);
+      if (!status.ok()) {
+        MaybeIgnoreError(&status);
+        if (!status.ok()) {
+          return status;
+        }
+        continue;
+      }
+      if (!advance(cursor)) {
+        if (!cursor->status.ok()) {
+          cursor->failed = true;
+          heap.push(cursor);
+        }
+        continue;
+      }
+    }
+
+    status = WriteBatchInternal::SetContents(&batch, cursor->record);
+    if (!status.ok()) {
+      return status;
+    }
+
+#ifndef ROCKSDB_LITE
+    if (immutable_db_options_.wal_filter != nullptr) {
+      WriteBatch new_batch;
+      bool batch_changed = false;
+
+      WalFilter::WalProcessingOption wal_processing_option =
+          immutable_db_options_.wal_filter->LogRecordFound(
+              cursor->wal_number, cursor->fname, batch, &new_batch,
+              &batch_changed);
+
+      bool skip_record = false;
+      switch (wal_processing_option) {
+        case WalFilter::WalProcessingOption::kContinueProcessing:
+          // do nothing, proceeed normally
+          break;
+        case WalFilter::WalProcessingOption::kIgnoreCurrentRecord:
+          // skip current record
+          skip_record = true;
+          break;
+        case WalFilter::WalProcessingOption::kStopReplay:
+          // skip current record and stop replay
+          stop_replay_by_wal_filter = true;
+          skip_record = true;
+          break;
+        case WalFilter::WalProcessingOption::kCorruptedRecord: {
+          Status s =
+              Status::Corruption("Corruption reported by Wal Filter ",
+                                 immutable_db_options_.wal_filter->Name());
+          MaybeIgnoreError(&s);
+          if (!s.ok()) {
+            cursor->reporter.Corruption(cursor->record.size(), s);
+            skip_record = true;
+          }
+          break;
+        }
+        default: {
+          assert(false);  // unhandled case
+          status = Status::NotSupported(
+              "Unknown WalProcessingOption returned"
+              " by Wal Filter ",
+              immutable_db_options_.wal_filter->Name());
+          MaybeIgnoreError(&status);
+          if (!status.ok()) {
+            return status;
+          }
+          // Ignore the error with current record processing.
+          skip_record = true;
+        }
+      }
+      if (skip_record) {
+        if (stop_replay_by_wal_filter) {
+          logFileDropped(cursor);
+        } else {
+          read_next(cursor);
+        }
+        continue;
+      }
+
+      if (batch_changed) {
+        // Make sure that the count in the new batch is
+        // within the orignal count.
+        int new_count = WriteBatchInternal::Count(&new_batch);
+        int original_count = WriteBatchInternal::Count(&batch);
+        if (new_count > original_count) {
+          ROCKS_LOG_FATAL(
+              immutable_db_options_.info_log,
+              "Recovering log #%" PRIu64
+              " mode %d log filter %s returned "
+              "more records (%d) than original (%d) which is not allowed. "
+              "Aborting recovery.",
+              cursor->wal_number, static_cast<int>(recovery_mode),
+              immutable_db_options_.wal_filter->Name(), new_count,
+              original_count);
+          status = Status::NotSupported(
+              "More than original # of records "
+              "returned by Wal Filter ",
+              immutable_db_options_.wal_filter->Name());
+          return status;
+        }
+        // Set the same sequence number in the new_batch
+        // as the original batch.
+        WriteBatchInternal::SetSequence(&new_batch,
+                                        WriteBatchInternal::Sequence(&batch));
+        batch = new_batch;
+      }
+    }
+#endif  // ROCKSDB_LITE
+
+    if (parallel_insert) {
+      Status batch_status = cursor->batch_status;
+      MaybeIgnoreError(&batch_status);
+      if (!batch_status.ok()) {
+        cursor->reporter.Corruption(cursor->record.size(), batch_status);
+      } else {
+        pending_bytes += batch.GetDataSize();
+        pending_record_sizes.push_back(cursor->record.size());
+        pending_cursors.push_back(cursor);
+        pending_batches.emplace_back(std::move(batch));
+        if (pending_bytes >= kRecoveryInsertGroupBytes) {
+          status = insert_pending_batches();
+          if (!status.ok()) {
+            return status;
+          }
+        }
+      }
+      read_next(cursor);
+      continue;
+    }
+
+    // If column family was not found, it might mean that the WAL write
+    // batch references to the column family that was dropped after the
+    // insert. We don't want to fail the whole write batch in that case --
+    // we just ignore the update.
+    // That's why we set ignore missing column families to true
+    bool has_valid_writes = false;
+    status = WriteBatchInternal::InsertInto(
+        &batch, column_family_memtables_.get(), &flush_scheduler_,
+        &trim_history_scheduler_, true, cursor->wal_number, this,
+        false /* concurrent_memtable_writes */, next_sequence,
+        &has_valid_writes, seq_per_batch_, batch_per_txn_);
+    MaybeIgnoreError(&status);
+    if (!status.ok()) {
+      // We are treating this as a failure while reading since we read valid
+      // blocks that do not form coherent data
+      cursor->reporter.Corruption(cursor->record.size(), status);
+      status = Status::OK();
+    } else if (has_valid_writes && !read_only) {
+      status = flush_scheduled_memtables(cursor->wal_number);
+      if (!status.ok()) {
+        // Reflect errors immediately so that conditions like full
+        // file-systems cause the DB::Open() to fail.
+        return status;
+      }
+    }
+    read_next(cursor);
+  }
+  status = insert_pending_batches();
+  if (!status.ok()) {
+    return status;
+  }
+
+  flush_scheduler_.Clear();
+  trim_history_scheduler_.Clear();
+  auto last_sequence = *next_sequence - 1;
+  if ((*next_sequence != kMaxSequenceNumber) &&
+      (versions_->LastSequence() <= last_sequence)) {
+    versions_->SetLastAllocatedSequence(last_sequence);
+    versions_->SetLastPublishedSequence(last_sequence);
+    versions_->SetLastSequence(last_sequence);
+  }
+  return status;
+}
+
 Status DBImpl::GetLogSizeAndMaybeTruncate(uint64_t wal_number, bool truncate,
                                           LogFileNumberSize* log_ptr) {
   LogFileNumberSize log(wal_number);
@@ -1543,7 +1991,13 @@ IOStatus DBImpl::CreateWAL(uint64_t log_file_num, uint64_t recycle_log_number,
         nullptr, tmp_set.Contains(FileType::kWalFile)));
     *new_log = new log::Writer(std::move(file_writer), log_file_num,
                                immutable_db_options_.recycle_log_file_num > 0,
-                               immutable_db_options_.manual_wal_flush);
+                               immutable_db_options_.manual_wal_flush,
+                               immutable_db_options_.wal_compression);
+    io_s = (*new_log)->AddCompressionTypeRecord();
+    if (!io_s.ok()) {
+      delete *new_log;
+      *new_log = nullptr;
+    }
   }
   return io_s;
 }
@@ -1572,6 +2026,7 @@ Status DBImpl::Open(const DBOptions& db_options, const std::string& dbname,
   }
 
   DBImpl* impl = new DBImpl(db_options, dbname, seq_per_batch, batch_per_txn);
+  impl->StartWalSyncThread();
   s = impl->env_->CreateDirIfMissing(impl->immutable_db_options_.wal_dir);
   if (s.ok()) {
     std::vector<std::string> paths;
@@ -1624,6 +2079,27 @@ Status DBImpl::Open(const DBOptions& db_options, const std::string& dbname,
       assert(impl->logs_.empty());
       impl->logs_.emplace_back(new_log_number, new_log);
     }
+    // The files of the other WAL streams are numbered after the one of
+    // logs_, which recovery relies on.
+    for (int i = 1; s.ok() && i < impl->immutable_db_options_.wal_streams;
+         i++) {
+      uint64_t stream_log_number = impl->versions_->NewFileNumber();
+      log::Writer* stream_log = nullptr;
+      s = impl->CreateWAL(stream_log_number, 0 /*recycle_log_number*/,
+                          preallocate_block_size, &stream_log);
+      if (s.ok()) {
+        impl->wal_streams_.emplace_back(
+            new DBImpl::WalStream(impl->immutable_db_options_));
+        DBImpl::WalStream* wal_stream = impl->wal_streams_.back().get();
+        wal_stream->writer = stream_log;
+        impl->wal_stream_files_.emplace_back(stream_log_number);
+        wal_stream->file = &impl->wal_stream_files_.back();
+      }
+    }
+    if (s.ok() && !impl->wal_streams_.empty()) {
+      // Sync writes to the streams do not sync the WAL directory
+      s = impl->directories_.GetWalDir()->Fsync(IOOptions(), nullptr);
+    }
 
     if (s.ok()) { // Setting handles will be important for anlysis RocksDB - Signal.Jin
       // set column family handles
@@ -6,26 +6,39 @@
 // Copyright (c) 2011 The LevelDB Authors. All rights reserved.
 // Use of this source code is governed by a BSD-style license that can be
 // found in the LICENSE file. See the AUTHORS file for names of contributors.
+#include <algorithm>
 #include <cinttypes>
+#include <thread>
 
 #include "db/db_impl/db_impl.h"
 #include "db/error_handler.h"
 #include "db/event_helpers.h"
+#include "monitoring/flow_trace.h"
 #include "monitoring/perf_context_imp.h"
 #include "options/options_helper.h"
 #include "test_util/sync_point.h"
 #include "util/cast_util.h"
 
-// Control Write Flow Print
-int write_flag = 1; // Signal.Jin
-int schedule_flag = 1;
-int switch_flag = 1;
-
 namespace ROCKSDB_NAMESPACE {
 // Convenience methods
 Status DBImpl::Put(const WriteOptions& o, ColumnFamilyHandle* column_family,
                    const Slice& key, const Slice& val) {
-  return DB::Put(o, column_family, key, val);
+  const size_t min_value_size =
+      immutable_db_options_.zero_copy_put_min_value_size;
+  if (min_value_size == 0 || val.size() < min_value_size ||
+      o.timestamp != nullptr || seq_per_batch_) {
+    return DB::Put(o, column_family, key, val);
+  }
+  // The batch references val, which outlives the write, so the value is
+  // written to the WAL and the memtable without being copied into the batch.
+  WriteBatch batch(key.size() + 24);
+  Status s = WriteBatchInternal::PutValueRef(
+      &batch, GetColumnFamilyID(column_family), key, &val);
+  if (!s.ok()) {
+    return s;
+  }
+  TEST_SYNC_POINT("DBImpl::Put:ZeroCopy");
+  return Write(o, &batch);
 }
 
 Status DBImpl::Merge(const WriteOptions& o, ColumnFamilyHandle* column_family,
@@ -55,11 +68,7 @@ void DBImpl::SetRecoverableStatePreReleaseCallback(
 }
 
 Status DBImpl::Write(const WriteOptions& write_options, WriteBatch* my_batch) {
-  if (DB_WRITE_FLOW == 1 && write_flag == 1) {
-    printf("  [2]        \t| While Start { /*Write Each Key-Value Pair*/\n");
-    fprintf(stdout, "  [3]        \t|  Write() {      \t\t\t| db_impl_write.cc (line 59)\n"); // Signal.Jin
-    //fprintf(stdout, "| Write() : Call WriteImpl() function |\n");
-  }
+  FLOW_TRACE_SCOPE(kFlowTraceWrite, "DBImpl::Write");
 
   //printf("Write() in db_impl_write.cc\n");
 
@@ -85,9 +94,7 @@ Status DBImpl::WriteImpl(const WriteOptions& write_options,
                          PreReleaseCallback* pre_release_callback) {
   assert(!seq_per_batch_ || batch_cnt != 0);
 
-  if (DB_WRITE_FLOW == 1 && write_flag == 1) {
-    fprintf(stdout, "  [4]        \t|   WriteImpl() {      \t\t\t| db_impl_write.cc (line 86)\n"); // Signal.Jin
-  }
+  FLOW_TRACE_SCOPE(kFlowTraceWrite, "DBImpl::WriteImpl");
 
   if (my_batch == nullptr) {
     return Status::Corruption("Batch is nullptr!");
@@ -95,8 +102,15 @@ Status DBImpl::WriteImpl(const WriteOptions& write_options,
   if (tracer_) {
     InstrumentedMutexLock lock(&trace_mutex_);
     if (tracer_) {
-      // TODO: maybe handle the tracing status?
-      tracer_->Write(my_batch).PermitUncheckedError();
+      if (UNLIKELY(WriteBatchInternal::HasValueRef(my_batch))) {
+        // The trace needs the value in the batch.
+        WriteBatch copy;
+        WriteBatchInternal::Append(&copy, my_batch).PermitUncheckedError();
+        tracer_->Write(&copy).PermitUncheckedError();
+      } else {
+        // TODO: maybe handle the tracing status?
+        tracer_->Write(my_batch).PermitUncheckedError();
+      }
     }
   }
   if (write_options.sync && write_options.disableWAL) {
@@ -144,12 +158,14 @@ Status DBImpl::WriteImpl(const WriteOptions& write_options,
                                      // every key is a sub-batch consuming a seq
                                      : WriteBatchInternal::Count(my_batch);
     uint64_t seq = 0;
+    WalStream* wal_stream = SelectWalStream(write_options);
     // Use a write thread to i) optimize for WAL write, ii) publish last
     // sequence in in increasing order, iii) call pre_release_callback serially
     Status status = WriteImplWALOnly(
-        &write_thread_, write_options, my_batch, callback, log_used, log_ref,
-        &seq, sub_batch_cnt, pre_release_callback, kDoAssignOrder,
-        kDoPublishLastSeq, disable_memtable);
+        wal_stream != nullptr ? &wal_stream->write_thread : &write_thread_,
+        write_options, my_batch, callback, log_used, log_ref, &seq,
+        sub_batch_cnt, pre_release_callback, kDoAssignOrder, kDoPublishLastSeq,
+        disable_memtable, wal_stream);
     TEST_SYNC_POINT("DBImpl::WriteImpl:UnorderedWriteAfterWriteWAL");
     if (!status.ok()) {
       return status;
@@ -190,14 +206,21 @@ Status DBImpl::WriteImpl(const WriteOptions& write_options,
       PERF_TIMER_STOP(write_pre_and_post_process_time);
       PERF_TIMER_GUARD(write_memtable_time);
 
-      ColumnFamilyMemTablesImpl column_family_memtables(
-          versions_->GetColumnFamilySet());
-      w.status = WriteBatchInternal::InsertInto(
-          &w, w.sequence, &column_family_memtables, &flush_scheduler_,
-          &trim_history_scheduler_,
-          write_options.ignore_missing_column_families, 0 /*log_number*/, this,
-          true /*concurrent_memtable_writes*/, seq_per_batch_, w.batch_cnt,
-          batch_per_txn_, write_options.memtable_insert_hint_per_batch);
+      const size_t num_ranges = MemTableInsertRanges(w);
+      if (num_ranges > 1) {
+        w.status = InsertRangesIntoMemTable(
+            &w, num_ranges, write_options.ignore_missing_column_families);
+      } else {
+        ColumnFamilyMemTablesImpl column_family_memtables(
+            versions_->GetColumnFamilySet());
+        w.status = WriteBatchInternal::InsertInto(
+            &w, w.sequence, &column_family_memtables, &flush_scheduler_,
+            &trim_history_scheduler_,
+            write_options.ignore_missing_column_families, 0 /*log_number*/,
+            this, true /*concurrent_memtable_writes*/, seq_per_batch_,
+            w.batch_cnt, batch_per_txn_,
+            write_options.memtable_insert_hint_per_batch);
+      }
 
       PERF_TIMER_START(write_pre_and_post_process_time);
     }
@@ -338,11 +361,20 @@ Status DBImpl::WriteImpl(const WriteOptions& write_options,
 
     PERF_TIMER_STOP(write_pre_and_post_process_time);
 
+    // Feed the cost of this group back into the group sizing if it is bounded
+    // by a latency budget. Synced groups are left out since the sync cost
+    // does not scale with the group size.
+    const bool record_write_cost = write_thread_.latency_budget_enabled();
+    StopWatchNano cost_timer(immutable_db_options_.clock, record_write_cost);
     if (!two_write_queues_) {
       if (status.ok() && !write_options.disableWAL) {
         PERF_TIMER_GUARD(write_wal_time);
         io_s = WriteToWAL(write_group, log_writer, log_used, need_log_sync,
                           need_log_dir_sync, last_sequence + 1);
+        if (record_write_cost && io_s.ok() && !need_log_sync) {
+          write_thread_.RecordWalWriteCost(total_byte_size,
+                                           cost_timer.ElapsedNanos());
+        }
       }
     } else {
       if (status.ok() && !write_options.disableWAL) {
@@ -351,6 +383,10 @@ Status DBImpl::WriteImpl(const WriteOptions& write_options,
         // wal_write_mutex_ to ensure ordered events in WAL
         io_s = ConcurrentWriteToWAL(write_group, log_used, &last_sequence,
                                     seq_inc);
+        if (record_write_cost && io_s.ok() && !need_log_sync) {
+          write_thread_.RecordWalWriteCost(total_byte_size,
+                                           cost_timer.ElapsedNanos());
+        }
       } else {
         // Otherwise we inc seq number for memtable writes
         last_sequence = versions_->FetchAddLastAllocatedSequence(seq_inc);
@@ -395,7 +431,24 @@ Status DBImpl::WriteImpl(const WriteOptions& write_options,
     if (status.ok()) {
       PERF_TIMER_GUARD(write_memtable_time);
 
-      if (!parallel) {
+      if (record_write_cost) {
+        cost_timer.Start();
+      }
+      // A large batch written alone can still be inserted on several
+      // threads.
+      const size_t num_ranges = write_group.size == 1 &&
+                                        w.ShouldWriteToMemtable()
+                                    ? MemTableInsertRanges(w)
+                                    : 1;
+      if (num_ranges > 1) {
+        assert(w.sequence == current_sequence);
+        w.status = InsertRangesIntoMemTable(
+            &w, num_ranges, write_options.ignore_missing_column_families);
+        if (record_write_cost && w.status.ok()) {
+          write_thread_.RecordMemTableInsertCost(total_byte_size,
+                                                 cost_timer.ElapsedNanos());
+        }
+      } else if (!parallel) {
         // w.sequence will be set inside InsertInto
         w.status = WriteBatchInternal::InsertInto(
             write_group, current_sequence, column_family_memtables_.get(),
@@ -403,6 +456,10 @@ Status DBImpl::WriteImpl(const WriteOptions& write_options,
             write_options.ignore_missing_column_families,
             0 /*recovery_log_number*/, this, parallel, seq_per_batch_,
             batch_per_txn_);
+        if (record_write_cost && w.status.ok()) {
+          write_thread_.RecordMemTableInsertCost(total_byte_size,
+                                                 cost_timer.ElapsedNanos());
+        }
       } else {
         write_group.last_sequence = last_sequence;
         write_thread_.LaunchParallelMemTableWriters(&write_group);
@@ -411,16 +468,30 @@ Status DBImpl::WriteImpl(const WriteOptions& write_options,
         // Each parallel follower is doing each own writes. The leader should
         // also do its own.
         if (w.ShouldWriteToMemtable()) {
-          ColumnFamilyMemTablesImpl column_family_memtables(
-              versions_->GetColumnFamilySet());
           assert(w.sequence == current_sequence);
-          w.status = WriteBatchInternal::InsertInto(
-              &w, w.sequence, &column_family_memtables, &flush_scheduler_,
-              &trim_history_scheduler_,
-              write_options.ignore_missing_column_families, 0 /*log_number*/,
-              this, true /*concurrent_memtable_writes*/, seq_per_batch_,
-              w.batch_cnt, batch_per_txn_,
-              write_options.memtable_insert_hint_per_batch);
+          const size_t leader_ranges = MemTableInsertRanges(w);
+          if (leader_ranges > 1) {
+            w.status = InsertRangesIntoMemTable(
+                &w, leader_ranges,
+                write_options.ignore_missing_column_families);
+          } else {
+            ColumnFamilyMemTablesImpl column_family_memtables(
+                versions_->GetColumnFamilySet());
+            w.status = WriteBatchInternal::InsertInto(
+                &w, w.sequence, &column_family_memtables, &flush_scheduler_,
+                &trim_history_scheduler_,
+                write_options.ignore_missing_column_families,
+                0 /*log_number*/, this, true /*concurrent_memtable_writes*/,
+                seq_per_batch_, w.batch_cnt, batch_per_txn_,
+                write_options.memtable_insert_hint_per_batch);
+          }
+          // The followers insert at the same time, so the leader's own
+          // insert approximates the latency the group adds.
+          if (record_write_cost && w.status.ok()) {
+            write_thread_.RecordMemTableInsertCost(
+                WriteBatchInternal::ByteSize(w.batch),
+                cost_timer.ElapsedNanos());
+          }
         }
       }
       if (seq_used != nullptr) {
@@ -492,9 +563,7 @@ Status DBImpl::PipelinedWriteImpl(const WriteOptions& write_options,
   WriteThread::Writer w(write_options, my_batch, callback, log_ref,
                         disable_memtable);
 
-  if (DB_WRITE_FLOW == 1 && write_flag == 1) {
-    fprintf(stdout, "  [5]        \t|    PipelinedWriteImpl()   \t\t| db_impl_write.cc (line 493)\n"); // Signal.Jin
-  }
+  FLOW_TRACE_SCOPE(kFlowTraceWrite, "DBImpl::PipelinedWriteImpl");
 
   write_thread_.JoinBatchGroup(&w);
   TEST_SYNC_POINT("DBImplWrite::PipelinedWriteImpl:AfterJoinBatchGroup");
@@ -505,6 +574,13 @@ Status DBImpl::PipelinedWriteImpl(const WriteOptions& write_options,
     }
     mutex_.Lock();
     bool need_log_sync = !write_options.disableWAL && write_options.sync;
+    // The WAL sync thread syncs the logs after the group is appended, while
+    // the next group is appended.
+    const bool sync_in_background =
+        need_log_sync && UsePipelinedWalSync(logs_.back().writer);
+    if (sync_in_background) {
+      need_log_sync = false;
+    }
     bool need_log_dir_sync = need_log_sync && !log_dir_synced_;
     // PreprocessWrite does its own perf timing.
     PERF_TIMER_STOP(write_pre_and_post_process_time);
@@ -562,9 +638,16 @@ Status DBImpl::PipelinedWriteImpl(const WriteOptions& write_options,
                           wal_write_group.size - 1);
         RecordTick(stats_, WRITE_DONE_BY_OTHER, wal_write_group.size - 1);
       }
+      StopWatchNano cost_timer(immutable_db_options_.clock,
+                               write_thread_.latency_budget_enabled());
       io_s = WriteToWAL(wal_write_group, log_writer, log_used, need_log_sync,
                         need_log_dir_sync, current_sequence); // Expected as a function that proceeds WAL operation - Signal.Jin
       w.status = io_s;
+      if (write_thread_.latency_budget_enabled() && io_s.ok() &&
+          !need_log_sync) {
+        write_thread_.RecordWalWriteCost(total_byte_size,
+                                         cost_timer.ElapsedNanos());
+      }
     } // Write Log(WAL), before key-value pair written into memtable
 
     if (!w.CallbackFailed()) {
@@ -585,6 +668,13 @@ Status DBImpl::PipelinedWriteImpl(const WriteOptions& write_options,
       mutex_.Unlock();
     }
 
+    if (sync_in_background && w.status.ok()) {
+      const uint64_t ticket = RequestWalSync();
+      for (auto writer : wal_write_group) {
+        writer->wal_sync_ticket = ticket;
+      }
+    }
+
     write_thread_.ExitAsBatchGroupLeader(wal_write_group, w.status);
   }
 
@@ -598,16 +688,47 @@ Status DBImpl::PipelinedWriteImpl(const WriteOptions& write_options,
     PERF_TIMER_GUARD(write_memtable_time);
     assert(w.ShouldWriteToMemtable());
     write_thread_.EnterAsMemTableWriter(&w, &memtable_write_group);
-    if (memtable_write_group.size > 1 &&
-        immutable_db_options_.allow_concurrent_memtable_write) {
+    // Writes whose WAL sync is still running must not be inserted, let alone
+    // published, before they are durable.
+    uint64_t wal_sync_ticket = 0;
+    for (auto writer : memtable_write_group) {
+      wal_sync_ticket = std::max(wal_sync_ticket, writer->wal_sync_ticket);
+    }
+    if (wal_sync_ticket != 0) {
+      memtable_write_group.status = WaitForWalSync(wal_sync_ticket);
+    }
+    const size_t num_ranges =
+        memtable_write_group.size == 1 ? MemTableInsertRanges(w) : 1;
+    if (!memtable_write_group.status.ok()) {
+      write_thread_.ExitAsMemTableWriter(&w, memtable_write_group);
+    } else if (memtable_write_group.size > 1 &&
+               immutable_db_options_.allow_concurrent_memtable_write) {
       write_thread_.LaunchParallelMemTableWriters(&memtable_write_group);
+    } else if (num_ranges > 1) {
+      // A large batch written alone can still be inserted on several
+      // threads.
+      memtable_write_group.status = InsertRangesIntoMemTable(
+          &w, num_ranges, write_options.ignore_missing_column_families);
+      versions_->SetLastSequence(memtable_write_group.last_sequence);
+      write_thread_.ExitAsMemTableWriter(&w, memtable_write_group);
     } else { // Put into Memtable with Key-Value pair - Signal.Jin
       //fprintf(stdout, "InsertInto\n");
+      StopWatchNano cost_timer(immutable_db_options_.clock,
+                               write_thread_.latency_budget_enabled());
       memtable_write_group.status = WriteBatchInternal::InsertInto(
           memtable_write_group, w.sequence, column_family_memtables_.get(),
           &flush_scheduler_, &trim_history_scheduler_,
           write_options.ignore_missing_column_families, 0 /*log_number*/, this,
           false /*concurrent_memtable_writes*/, seq_per_batch_, batch_per_txn_);
+      if (write_thread_.latency_budget_enabled() &&
+          memtable_write_group.status.ok()) {
+        size_t group_bytes = 0;
+        for (auto writer : memtable_write_group) {
+          group_bytes += WriteBatchInternal::ByteSize(writer->batch);
+        }
+        write_thread_.RecordMemTableInsertCost(group_bytes,
+                                               cost_timer.ElapsedNanos());
+      }
       versions_->SetLastSequence(memtable_write_group.last_sequence);
       write_thread_.ExitAsMemTableWriter(&w, memtable_write_group);
     }
@@ -619,20 +740,35 @@ Status DBImpl::PipelinedWriteImpl(const WriteOptions& write_options,
 
   if (w.state == WriteThread::STATE_PARALLEL_MEMTABLE_WRITER) {
     assert(w.ShouldWriteToMemtable());
-    ColumnFamilyMemTablesImpl column_family_memtables(
-        versions_->GetColumnFamilySet());
-    w.status = WriteBatchInternal::InsertInto(
-        &w, w.sequence, &column_family_memtables, &flush_scheduler_,
-        &trim_history_scheduler_, write_options.ignore_missing_column_families,
-        0 /*log_number*/, this, true /*concurrent_memtable_writes*/,
-        false /*seq_per_batch*/, 0 /*batch_cnt*/, true /*batch_per_txn*/,
-        write_options.memtable_insert_hint_per_batch);
+    const size_t num_ranges = MemTableInsertRanges(w);
+    if (num_ranges > 1) {
+      w.status = InsertRangesIntoMemTable(
+          &w, num_ranges, write_options.ignore_missing_column_families);
+    } else {
+      ColumnFamilyMemTablesImpl column_family_memtables(
+          versions_->GetColumnFamilySet());
+      w.status = WriteBatchInternal::InsertInto(
+          &w, w.sequence, &column_family_memtables, &flush_scheduler_,
+          &trim_history_scheduler_,
+          write_options.ignore_missing_column_families, 0 /*log_number*/, this,
+          true /*concurrent_memtable_writes*/, false /*seq_per_batch*/,
+          0 /*batch_cnt*/, true /*batch_per_txn*/,
+          write_options.memtable_insert_hint_per_batch);
+    }
     if (write_thread_.CompleteParallelMemTableWriter(&w)) {
       MemTableInsertStatusCheck(w.status);
       versions_->SetLastSequence(w.write_group->last_sequence);
       write_thread_.ExitAsMemTableWriter(&w, *w.write_group);
     }
   }
+  if (w.wal_sync_ticket != 0) {
+    // Writers that skip the memtable were not waited for by a memtable
+    // writer leader.
+    Status s = WaitForWalSync(w.wal_sync_ticket);
+    if (!s.ok() && w.status.ok()) {
+      w.status = s;
+    }
+  }
   if (seq_used != nullptr) {
     *seq_used = w.sequence;
   }
@@ -641,6 +777,143 @@ Status DBImpl::PipelinedWriteImpl(const WriteOptions& write_options,
   return w.FinalStatus();
 }
 
+bool DBImpl::UsePipelinedWalSync(log::Writer* log_writer) const {
+  // With manual_wal_flush the appended data may still be buffered, and the
+  // WAL sync thread syncs without flushing.
+  return immutable_db_options_.pipelined_wal_sync && !manual_wal_flush_ &&
+         wal_sync_thread_.joinable() &&
+         log_writer->file()->writable_file()->IsSyncThreadSafe();
+}
+
+uint64_t DBImpl::RequestWalSync() {
+  InstrumentedMutexLock l(&wal_sync_mutex_);
+  const uint64_t ticket = ++wal_sync_requested_;
+  wal_sync_cv_.SignalAll();
+  return ticket;
+}
+
+Status DBImpl::WaitForWalSync(uint64_t ticket) {
+  InstrumentedMutexLock l(&wal_sync_mutex_);
+  while (wal_sync_done_ < ticket) {
+    wal_sync_cv_.Wait();
+  }
+  return wal_sync_status_;
+}
+
+void DBImpl::StartWalSyncThread() {
+  if (immutable_db_options_.enable_pipelined_write &&
+      immutable_db_options_.pipelined_wal_sync) {
+    assert(!wal_sync_thread_.joinable());
+    wal_sync_thread_ = port::Thread([this]() { BGWorkWalSync(); });
+  }
+}
+
+void DBImpl::StopWalSyncThread() {
+  if (!wal_sync_thread_.joinable()) {
+    return;
+  }
+  {
+    InstrumentedMutexLock l(&wal_sync_mutex_);
+    wal_sync_shutdown_ = true;
+    wal_sync_cv_.SignalAll();
+  }
+  wal_sync_thread_.join();
+}
+
+void DBImpl::BGWorkWalSync() {
+  InstrumentedMutexLock l(&wal_sync_mutex_);
+  while (true) {
+    while (!wal_sync_shutdown_ && wal_sync_done_ == wal_sync_requested_) {
+      wal_sync_cv_.Wait();
+    }
+    if (wal_sync_done_ == wal_sync_requested_) {
+      // Shutting down with no pending requests.
+      break;
+    }
+    // One sync covers all the groups appended before their request, so the
+    // requests that arrive while it runs are batched into the next one.
+    const uint64_t ticket = wal_sync_requested_;
+    Status s;
+    if (wal_sync_status_.ok()) {
+      wal_sync_mutex_.Unlock();
+      TEST_SYNC_POINT("DBImpl::BGWorkWalSync:BeforeSync");
+      s = SyncWAL();
+      wal_sync_mutex_.Lock();
+    }
+    if (!s.ok()) {
+      ROCKS_LOG_ERROR(immutable_db_options_.info_log,
+                      "Pipelined WAL sync error %s", s.ToString().c_str());
+      wal_sync_status_ = s;
+      // Stops the writes, like a failed inline sync, until Resume() flushed
+      // the memtables whose WALs may not be durable.
+      wal_sync_mutex_.Unlock();
+      WriteStatusCheck(s);
+      wal_sync_mutex_.Lock();
+    }
+    wal_sync_done_ = ticket;
+    wal_sync_cv_.SignalAll();
+  }
+}
+
+namespace {
+// Minimum size of the range of records each thread inserts with
+// max_write_batch_insert_threads.
+const size_t kMinWriteBatchInsertRangeBytes = 256 << 10;
+}  // namespace
+
+size_t DBImpl::MemTableInsertRanges(const WriteThread::Writer& w) const {
+  const size_t max_threads = immutable_db_options_.max_write_batch_insert_threads;
+  if (max_threads <= 1 ||
+      !immutable_db_options_.allow_concurrent_memtable_write ||
+      seq_per_batch_ || w.protection_bytes_per_key != 0) {
+    return 1;
+  }
+  const size_t num_ranges =
+      WriteBatchInternal::ByteSize(w.batch) / kMinWriteBatchInsertRangeBytes;
+  if (num_ranges <= 1 || WriteBatchInternal::Count(w.batch) <= 1 ||
+      w.batch->HasMerge() || w.batch->HasBeginPrepare() ||
+      w.batch->HasEndPrepare() || w.batch->HasCommit() ||
+      w.batch->HasRollback()) {
+    return 1;
+  }
+  return std::min(num_ranges, max_threads);
+}
+
+Status DBImpl::InsertRangesIntoMemTable(WriteThread::Writer* w,
+                                        size_t num_ranges,
+                                        bool ignore_missing_column_families) {
+  std::vector<WriteBatchInternal::RecordRange> ranges;
+  Status s = WriteBatchInternal::SplitRecords(w->batch, num_ranges, &ranges);
+  if (!s.ok()) {
+    return s;
+  }
+  TEST_SYNC_POINT_CALLBACK("DBImpl::InsertRangesIntoMemTable:Ranges", &ranges);
+  WriteBatchInternal::SetSequence(w->batch, w->sequence);
+  std::vector<Status> statuses(ranges.size());
+  auto insert = [&](size_t i) {
+    ColumnFamilyMemTablesImpl column_family_memtables(
+        versions_->GetColumnFamilySet());
+    statuses[i] = WriteBatchInternal::InsertInto(
+        w->batch, ranges[i], w->sequence + ranges[i].sequence_offset,
+        &column_family_memtables, &flush_scheduler_, &trim_history_scheduler_,
+        ignore_missing_column_families, this);
+  };
+  std::vector<port::Thread> threads;
+  for (size_t i = 1; i < ranges.size(); i++) {
+    threads.emplace_back(insert, i);
+  }
+  insert(0);
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  for (auto& range_status : statuses) {
+    if (!range_status.ok() && s.ok()) {
+      s = range_status;
+    }
+  }
+  return s;
+}
+
 Status DBImpl::UnorderedWriteMemtable(const WriteOptions& write_options,
                                       WriteBatch* my_batch,
                                       WriteCallback* callback, uint64_t log_ref,
@@ -660,14 +933,20 @@ Status DBImpl::UnorderedWriteMemtable(const WriteOptions& write_options,
     stats->AddDBStats(InternalStats::kIntStatsNumKeysWritten, total_count);
     RecordTick(stats_, NUMBER_KEYS_WRITTEN, total_count);
 
-    ColumnFamilyMemTablesImpl column_family_memtables(
-        versions_->GetColumnFamilySet());
-    w.status = WriteBatchInternal::InsertInto(
-        &w, w.sequence, &column_family_memtables, &flush_scheduler_,
-        &trim_history_scheduler_, write_options.ignore_missing_column_families,
-        0 /*log_number*/, this, true /*concurrent_memtable_writes*/,
-        seq_per_batch_, sub_batch_cnt, true /*batch_per_txn*/,
-        write_options.memtable_insert_hint_per_batch);
+    const size_t num_ranges = MemTableInsertRanges(w);
+    if (num_ranges > 1) {
+      w.status = InsertRangesIntoMemTable(
+          &w, num_ranges, write_options.ignore_missing_column_families);
+    } else {
+      ColumnFamilyMemTablesImpl column_family_memtables(
+          versions_->GetColumnFamilySet());
+      w.status = WriteBatchInternal::InsertInto(
+          &w, w.sequence, &column_family_memtables, &flush_scheduler_,
+          &trim_history_scheduler_,
+          write_options.ignore_missing_column_families, 0 /*log_number*/, this,
+          true /*concurrent_memtable_writes*/, seq_per_batch_, sub_batch_cnt,
+          true /*batch_per_txn*/, write_options.memtable_insert_hint_per_batch);
+    }
     if (write_options.disableWAL) {
       has_unpersisted_data_.store(true, std::memory_order_relaxed);
     }
@@ -698,7 +977,8 @@ Status DBImpl::WriteImplWALOnly(
     WriteBatch* my_batch, WriteCallback* callback, uint64_t* log_used,
     const uint64_t log_ref, uint64_t* seq_used, const size_t sub_batch_cnt,
     PreReleaseCallback* pre_release_callback, const AssignOrder assign_order,
-    const PublishLastSeq publish_last_seq, const bool disable_memtable) {
+    const PublishLastSeq publish_last_seq, const bool disable_memtable,
+    WalStream* wal_stream) {
   PERF_TIMER_GUARD(write_pre_and_post_process_time);
   WriteThread::Writer w(write_options, my_batch, callback, log_ref,
                         disable_memtable, sub_batch_cnt, pre_release_callback);
@@ -720,7 +1000,9 @@ Status DBImpl::WriteImplWALOnly(
   // else we are the leader of the write batch group
   assert(w.state == WriteThread::STATE_GROUP_LEADER);
 
-  if (publish_last_seq == kDoPublishLastSeq) {
+  // The leaders of WAL streams leave the preprocessing to write_thread_, see
+  // SelectWalStream()
+  if (publish_last_seq == kDoPublishLastSeq && wal_stream == nullptr) {
     Status status;
 
     // Currently we only use kDoPublishLastSeq in unordered_write
@@ -802,13 +1084,26 @@ Status DBImpl::WriteImplWALOnly(
   Status status;
   IOStatus io_s;
   io_s.PermitUncheckedError();  // Allow io_s to be uninitialized
-  if (!write_options.disableWAL) {
+  StopWatchNano cost_timer(immutable_db_options_.clock,
+                           write_thread->latency_budget_enabled());
+  if (wal_stream != nullptr) {
+    io_s = WalStreamWriteToWAL(write_group, wal_stream, log_used,
+                               &last_sequence, seq_inc);
+    status = io_s;
+  } else if (!write_options.disableWAL) {
     io_s = ConcurrentWriteToWAL(write_group, log_used, &last_sequence, seq_inc);
     status = io_s;
+  } else if (!wal_streams_.empty()) {
+    last_sequence = AllocateWalStreamSequence(seq_inc);
   } else {
     // Otherwise we inc seq number to do solely the seq allocation
     last_sequence = versions_->FetchAddLastAllocatedSequence(seq_inc);
   }
+  if (write_thread->latency_budget_enabled() && !write_options.disableWAL &&
+      io_s.ok()) {
+    write_thread->RecordWalWriteCost(total_byte_size,
+                                     cost_timer.ElapsedNanos());
+  }
 
   size_t memtable_write_cnt = 0;
   auto curr_seq = last_sequence + 1;
@@ -830,6 +1125,12 @@ Status DBImpl::WriteImplWALOnly(
     assert(!write_options.disableWAL);
     // Requesting sync with two_write_queues_ is expected to be very rare. We
     // hance provide a simple implementation that is not necessarily efficient.
+    if (!wal_streams_.empty()) {
+      // The groups with smaller sequence numbers may be in the WALs of other
+      // streams. They must be durable too, or recovery would replay this
+      // group without them.
+      WaitForEarlierWalStreamGroups(last_sequence + 1);
+    }
     if (manual_wal_flush_) {
       status = FlushWAL(true);
     } else {
@@ -861,7 +1162,11 @@ Status DBImpl::WriteImplWALOnly(
     }
   }
   if (publish_last_seq == kDoPublishLastSeq) {
-    versions_->SetLastSequence(last_sequence + seq_inc);
+    if (!wal_streams_.empty()) {
+      PublishWalStreamSequence(last_sequence + 1);
+    } else {
+      versions_->SetLastSequence(last_sequence + seq_inc);
+    }
     // Currently we only use kDoPublishLastSeq in unordered_write
     assert(immutable_db_options_.unordered_write);
   }
@@ -940,13 +1245,7 @@ Status DBImpl::PreprocessWrite(const WriteOptions& write_options,
   assert(write_context != nullptr && need_log_sync != nullptr);
   Status status;
 
-  if (DB_WRITE_FLOW == 1 && write_flag == 1) {
-    fprintf(stdout, "  [6]        \t|    PreporcessWrite()   \t\t| db_impl_write.cc (line 940)\n"); // Signal.Jin
-    fprintf(stdout, "  [7]        \t|   }\n"); 
-    fprintf(stdout, "  [8]        \t|  }\n"); 
-    fprintf(stdout, "  [9]        \t| } While End /*MemTable Full*/\n"); 
-    write_flag = 0;
-  }
+  FLOW_TRACE_SCOPE(kFlowTraceWrite, "DBImpl::PreprocessWrite");
 
   if (error_handler_.IsDBStopped()) {
     status = error_handler_.GetBGError();
@@ -958,8 +1257,10 @@ Status DBImpl::PreprocessWrite(const WriteOptions& write_options,
          versions_->GetColumnFamilySet()->NumberOfColumnFamilies() == 1);
   if (UNLIKELY(status.ok() && !single_column_family_mode_ &&
                total_log_size_ > GetMaxTotalWalSize())) {
+    EnterWalStreamsUnbatched();
     WaitForPendingWrites();
     status = SwitchWAL(write_context);
+    ExitWalStreamsUnbatched();
   }
 
   if (UNLIKELY(status.ok() && write_buffer_manager_->ShouldFlush())) {
@@ -968,8 +1269,10 @@ Status DBImpl::PreprocessWrite(const WriteOptions& write_options,
     // thread is writing to another DB with the same write buffer, they may also
     // be flushed. We may end up with flushing much more DBs than needed. It's
     // suboptimal but still correct.
+    EnterWalStreamsUnbatched();
     WaitForPendingWrites();
     status = HandleWriteBufferManagerFlush(write_context);
+    ExitWalStreamsUnbatched();
   }
 
   if (UNLIKELY(status.ok() && !trim_history_scheduler_.Empty())) {
@@ -977,8 +1280,10 @@ Status DBImpl::PreprocessWrite(const WriteOptions& write_options,
   }
 
   if (UNLIKELY(status.ok() && !flush_scheduler_.Empty())) {
+    EnterWalStreamsUnbatched();
     WaitForPendingWrites();
     status = ScheduleFlushes(write_context);
+    ExitWalStreamsUnbatched();
   }
 
   PERF_TIMER_STOP(write_scheduling_flushes_compactions_time);
@@ -1085,8 +1390,11 @@ IOStatus DBImpl::WriteToWAL(const WriteBatch& merged_batch,
                             log::Writer* log_writer, uint64_t* log_used,
                             uint64_t* log_size) {
   assert(log_size != nullptr);
-  Slice log_entry = WriteBatchInternal::Contents(&merged_batch);
-  *log_size = log_entry.size();
+  Slice parts[2];
+  SliceParts log_entry =
+      WriteBatchInternal::ContentsParts(&merged_batch, parts);
+  const size_t log_entry_size = WriteBatchInternal::ByteSize(&merged_batch);
+  *log_size = log_entry_size;
   // When two_write_queues_ WriteToWAL has to be protected from concurretn calls
   // from the two queues anyway and log_write_mutex_ is already held. Otherwise
   // if manual_wal_flush_ is enabled we need to protect log_writer->AddRecord
@@ -1106,10 +1414,10 @@ IOStatus DBImpl::WriteToWAL(const WriteBatch& merged_batch,
   if (log_used != nullptr) {
     *log_used = logfile_number_;
   }
-  total_log_size_ += log_entry.size();
+  total_log_size_ += log_entry_size;
   // TODO(myabandeh): it might be unsafe to access alive_log_files_.back() here
   // since alive_log_files_ might be modified concurrently
-  alive_log_files_.back().AddSize(log_entry.size());
+  alive_log_files_.back().AddSize(log_entry_size);
   log_empty_ = false;
   return io_s;
 }
@@ -1207,7 +1515,9 @@ IOStatus DBImpl::ConcurrentWriteToWAL(
       writer->log_used = logfile_number_;
     }
   }
-  *last_sequence = versions_->FetchAddLastAllocatedSequence(seq_inc);
+  *last_sequence = wal_streams_.empty()
+                       ? versions_->FetchAddLastAllocatedSequence(seq_inc)
+                       : AllocateWalStreamSequence(seq_inc);
   auto sequence = *last_sequence + 1;
   WriteBatchInternal::SetSequence(merged_batch, sequence);
 
@@ -1233,6 +1543,135 @@ IOStatus DBImpl::ConcurrentWriteToWAL(
   return io_s;
 }
 
+IOStatus DBImpl::WalStreamWriteToWAL(
+    const WriteThread::WriteGroup& write_group, WalStream* wal_stream,
+    uint64_t* log_used, SequenceNumber* last_sequence, size_t seq_inc) {
+  assert(!write_group.leader->disable_wal);
+  size_t write_with_wal = 0;
+  WriteBatch* to_be_cached_state = nullptr;
+  WriteBatch* merged_batch =
+      MergeBatch(write_group, &wal_stream->tmp_batch, &write_with_wal,
+                 &to_be_cached_state);
+  // Recoverable state is only written with two_write_queues
+  assert(to_be_cached_state == nullptr);
+  const uint64_t log_number = wal_stream->file->number;
+  if (merged_batch == write_group.leader->batch) {
+    write_group.leader->log_used = log_number;
+  } else if (write_with_wal > 1) {
+    for (auto writer : write_group) {
+      writer->log_used = log_number;
+    }
+  }
+  // The sequence numbers are allocated by the leader of the stream, so they
+  // are increasing within each WAL file of the stream.
+  *last_sequence = AllocateWalStreamSequence(seq_inc);
+  WriteBatchInternal::SetSequence(merged_batch, *last_sequence + 1);
+
+  Slice parts[2];
+  SliceParts log_entry = WriteBatchInternal::ContentsParts(merged_batch, parts);
+  const size_t log_entry_size = WriteBatchInternal::ByteSize(merged_batch);
+  IOStatus io_s = wal_stream->writer->AddRecord(log_entry);
+  if (log_used != nullptr) {
+    *log_used = log_number;
+  }
+  total_log_size_ += log_entry_size;
+  wal_stream->file->AddSize(log_entry_size);
+  wal_stream->empty = false;
+  if (merged_batch == &wal_stream->tmp_batch) {
+    wal_stream->tmp_batch.Clear();
+  }
+
+  if (io_s.ok()) {
+    const bool concurrent = true;
+    auto stats = default_cf_internal_stats_;
+    stats->AddDBStats(InternalStats::kIntStatsWalFileBytes, log_entry_size,
+                      concurrent);
+    RecordTick(stats_, WAL_FILE_BYTES, log_entry_size);
+    stats->AddDBStats(InternalStats::kIntStatsWriteWithWal, write_with_wal,
+                      concurrent);
+    RecordTick(stats_, WRITE_WITH_WAL, write_with_wal);
+  }
+  return io_s;
+}
+
+SequenceNumber DBImpl::AllocateWalStreamSequence(size_t seq_inc) {
+  std::lock_guard<std::mutex> lock(wal_streams_mutex_);
+  SequenceNumber last_sequence =
+      versions_->FetchAddLastAllocatedSequence(seq_inc);
+  wal_streams_unpublished_.insert(last_sequence + 1);
+  return last_sequence;
+}
+
+void DBImpl::PublishWalStreamSequence(SequenceNumber first_sequence) {
+  std::lock_guard<std::mutex> lock(wal_streams_mutex_);
+  auto it = wal_streams_unpublished_.find(first_sequence);
+  assert(it != wal_streams_unpublished_.end());
+  wal_streams_unpublished_.erase(it);
+  // Everything allocated before the oldest group still being written is in
+  // the WAL.
+  SequenceNumber last_sequence = wal_streams_unpublished_.empty()
+                                     ? versions_->LastAllocatedSequence()
+                                     : *wal_streams_unpublished_.begin() - 1;
+  if (last_sequence > versions_->LastSequence()) {
+    versions_->SetLastSequence(last_sequence);
+  }
+  wal_streams_published_cv_.notify_all();
+}
+
+void DBImpl::WaitForEarlierWalStreamGroups(SequenceNumber first_sequence) {
+  std::unique_lock<std::mutex> lock(wal_streams_mutex_);
+  // The group starting at first_sequence is not published yet, so the set is
+  // never empty here.
+  wal_streams_published_cv_.wait(lock, [&]() {
+    return *wal_streams_unpublished_.begin() >= first_sequence;
+  });
+}
+
+DBImpl::WalStream* DBImpl::SelectWalStream(const WriteOptions& write_options) {
+  if (wal_streams_.empty() || write_options.disableWAL) {
+    return nullptr;
+  }
+  size_t index = std::hash<std::thread::id>()(std::this_thread::get_id()) %
+                 (wal_streams_.size() + 1);
+  if (index == 0) {
+    return nullptr;
+  }
+  // Writes that may have to switch memtables, flush, stall or be delayed join
+  // write_thread_, whose leaders call PreprocessWrite(). These checks are racy
+  // but a write that misses a condition only postpones its handling to the
+  // next write of write_thread_, which happens at the latest when a memtable
+  // fills up.
+  if (error_handler_.IsDBStopped() || !flush_scheduler_.Empty() ||
+      !trim_history_scheduler_.Empty() || write_controller_.IsStopped() ||
+      write_controller_.NeedsDelay() || write_buffer_manager_->ShouldFlush() ||
+      write_buffer_manager_->ShouldStall()) {
+    return nullptr;
+  }
+  return wal_streams_[index - 1].get();
+}
+
+void DBImpl::EnterWalStreamsUnbatched() {
+  mutex_.AssertHeld();
+  if (wal_streams_unbatched_++ > 0) {
+    return;
+  }
+  for (auto& wal_stream : wal_streams_) {
+    wal_stream->unbatched_writer.reset(new WriteThread::Writer());
+    wal_stream->write_thread.EnterUnbatched(
+        wal_stream->unbatched_writer.get(), &mutex_);
+  }
+}
+
+void DBImpl::ExitWalStreamsUnbatched() {
+  assert(wal_streams_unbatched_ > 0);
+  if (--wal_streams_unbatched_ > 0) {
+    return;
+  }
+  for (auto it = wal_streams_.rbegin(); it != wal_streams_.rend(); ++it) {
+    (*it)->write_thread.ExitUnbatched((*it)->unbatched_writer.get());
+  }
+}
+
 Status DBImpl::WriteRecoverableState() {
   mutex_.AssertHeld();
   if (!cached_recoverable_state_empty_) {
@@ -1418,10 +1857,13 @@ Status DBImpl::HandleWriteBufferManagerFlush(WriteContext* write_context) {
   // thread is writing to another DB with the same write buffer, they may also
   // be flushed. We may end up with flushing much more DBs than needed. It's
   // suboptimal but still correct.
+  const bool cost_aware = write_buffer_manager_->cost_aware_flush() &&
+                          !immutable_db_options_.atomic_flush;
   ROCKS_LOG_INFO(
       immutable_db_options_.info_log,
-      "Flushing column family with oldest memtable entry. Write buffers are "
+      "Flushing column family with %s. Write buffers are "
       "using %" ROCKSDB_PRIszt " bytes out of a total of %" ROCKSDB_PRIszt ".",
+      cost_aware ? "best flush cost" : "oldest memtable entry",
       write_buffer_manager_->memory_usage(),
       write_buffer_manager_->buffer_size());
   // no need to refcount because drop is happening in write thread, so can't
@@ -1429,6 +1871,11 @@ Status DBImpl::HandleWriteBufferManagerFlush(WriteContext* write_context) {
   autovector<ColumnFamilyData*> cfds;
   if (immutable_db_options_.atomic_flush) {
     SelectColumnFamiliesForAtomicFlush(&cfds);
+  } else if (cost_aware) {
+    SelectColumnFamilyForCostAwareFlush(&cfds);
+    if (!cfds.empty()) {
+      MaybeFlushStatsCF(&cfds);
+    }
   } else {
     ColumnFamilyData* cfd_picked = nullptr;
     SequenceNumber seq_num_for_cf_picked = kMaxSequenceNumber;
@@ -1629,13 +2076,66 @@ Status DBImpl::ThrottleLowPriWritesIfNeeded(const WriteOptions& write_options,
       // progress.
       PERF_TIMER_GUARD(write_delay_time);
       write_controller_.low_pri_rate_limiter()->Request(
-          my_batch->GetDataSize(), Env::IO_HIGH, nullptr /* stats */,
+          WriteBatchInternal::ByteSize(my_batch), Env::IO_HIGH,
+          nullptr /* stats */,
           RateLimiter::OpType::kWrite);
     }
   }
   return Status::OK();
 }
 
+void DBImpl::SelectColumnFamilyForCostAwareFlush(
+    autovector<ColumnFamilyData*>* cfds) {
+  mutex_.AssertHeld();
+  WriteBufferFlushPolicy* policy = write_buffer_manager_->flush_policy();
+  assert(policy != nullptr);
+  const uint64_t now_micros = immutable_db_options_.clock->NowMicros();
+
+  ColumnFamilyData* oldest = nullptr;
+  SequenceNumber oldest_seq = kMaxSequenceNumber;
+  for (auto cfd : *versions_->GetColumnFamilySet()) {
+    if (cfd->IsDropped()) {
+      continue;
+    }
+    cfd->RefreshWriteBufferFlushCandidate(now_micros);
+    if (!cfd->mem()->IsEmpty() && cfd->mem()->GetCreationSeq() < oldest_seq) {
+      oldest = cfd;
+      oldest_seq = cfd->mem()->GetCreationSeq();
+    }
+  }
+
+  WriteBufferFlushPolicy::Decision decision =
+      policy->Pick(versions_->GetColumnFamilySet(), now_micros);
+  if (decision.deferred) {
+    RecordTick(stats_, WRITE_BUFFER_MANAGER_FLUSHES_DEFERRED);
+    return;
+  }
+  ColumnFamilyData* cfd =
+      decision.victim == nullptr
+          ? nullptr
+          : versions_->GetColumnFamilySet()->GetColumnFamily(
+                decision.victim->cf_id());
+  if (cfd == nullptr || cfd->mem()->IsEmpty()) {
+    return;
+  }
+  const WriteBufferFlushPolicy::Candidate& victim = *decision.victim;
+  ROCKS_LOG_INFO(immutable_db_options_.info_log,
+                 "[%s] Picked for flush with score %.0f: %" PRIu64
+                 " bytes in active memtable, write rate %.0f bytes/s, "
+                 "overwrite ratio %.2f, stall risk %.2f%s",
+                 cfd->GetName().c_str(), decision.score, victim.active_bytes(),
+                 victim.write_rate(), victim.overwrite_ratio(),
+                 victim.stall_risk(),
+                 cfd == oldest ? "" : " (not the oldest memtable)");
+  RecordTick(stats_, WRITE_BUFFER_MANAGER_COST_AWARE_FLUSHES);
+  RecordTick(stats_, WRITE_BUFFER_MANAGER_COST_AWARE_FLUSH_BYTES,
+             victim.active_bytes());
+  if (cfd != oldest) {
+    RecordTick(stats_, WRITE_BUFFER_MANAGER_FLUSHES_NOT_OLDEST);
+  }
+  cfds->push_back(cfd);
+}
+
 void DBImpl::MaybeFlushStatsCF(autovector<ColumnFamilyData*>* cfds) {
   assert(cfds != nullptr);
   if (!cfds->empty() && immutable_db_options_.persist_stats_to_disk) {
@@ -1702,12 +2202,7 @@ Status DBImpl::TrimMemtableHistory(WriteContext* context) {
 Status DBImpl::ScheduleFlushes(WriteContext* context) {
   autovector<ColumnFamilyData*> cfds;
 
-  if (DB_WRITE_FLOW == 1 && schedule_flag == 1) {
-    fprintf(stdout, "  [10]        \t| /*Will be Background Work Start*/\n"); // Signal.Jin
-    fprintf(stdout, "  [11]        \t| ScheduleFlushes() {     \t\t| db_impl_write.cc (line 1702)\n"); // Signal.Jin
-    //fprintf(stdout, "| ScheduleFlushes() : If memtable full, signal to flush to Storage |\n");
-    schedule_flag = 0;
-  }
+  FLOW_TRACE_SCOPE(kFlowTraceFlush, "DBImpl::ScheduleFlushes");
 
   if (immutable_db_options_.atomic_flush) {
     SelectColumnFamiliesForAtomicFlush(&cfds);
@@ -1790,12 +2285,7 @@ Status DBImpl::SwitchMemtable(ColumnFamilyData* cfd, WriteContext* context) {
   MemTable* new_mem = nullptr;
   IOStatus io_s;
 
-  if (DB_WRITE_FLOW == 1 && switch_flag == 1) {
-    fprintf(stdout, "  [12]        \t|  SwitchMemtable()      \t\t| db_impl_write.cc (line 1789)\n"); // Signal.Jin
-    fprintf(stdout, "  [13]        \t|  MaybeScheduleFlushOrCompaction() {   | db_impl_compaction_flush.cc (line 2230)\n"); // Signal.Jin
-    //fprintf(stdout, "| SwitchMemtable() : Change memtable to immutable memtable, ready to flush |\n");
-    switch_flag = 0;
-  }
+  FLOW_TRACE_SCOPE(kFlowTraceWrite, "DBImpl::SwitchMemtable");
 
   // Recoverable state is persisted in WAL. After memtable switch, WAL might
   // be deleted, so we write the state to memtable to be persisted as well.
@@ -1814,6 +2304,13 @@ Status DBImpl::SwitchMemtable(ColumnFamilyData* cfd, WriteContext* context) {
   if (two_write_queues_) {
     log_write_mutex_.Unlock();
   }
+  // The WAL streams switch to new files together with logs_
+  assert(wal_streams_.empty() || wal_streams_unbatched_ > 0);
+  for (auto& wal_stream : wal_streams_) {
+    if (!wal_stream->empty) {
+      creating_new_log = true;
+    }
+  }
   uint64_t recycle_log_number = 0;
   if (creating_new_log && immutable_db_options_.recycle_log_file_num &&
       !log_recycle_files_.empty()) {
@@ -1837,6 +2334,19 @@ Status DBImpl::SwitchMemtable(ColumnFamilyData* cfd, WriteContext* context) {
   int num_imm_unflushed = cfd->imm()->NumNotFlushed();
   const auto preallocate_block_size =
       GetWalPreallocateBlockSize(mutable_cf_options.write_buffer_size);
+  std::vector<uint64_t> new_stream_numbers;
+  std::vector<log::Writer*> new_stream_writers;
+  if (creating_new_log && !wal_streams_.empty()) {
+    // Keep SyncWAL() away from the current WAL files of the streams, which
+    // are synced and closed below.
+    while (wal_streams_getting_synced_) {
+      log_sync_cv_.Wait();
+    }
+    wal_streams_getting_synced_ = true;
+    for (size_t i = 0; i < wal_streams_.size(); i++) {
+      new_stream_numbers.push_back(versions_->NewFileNumber());
+    }
+  }
   mutex_.Unlock();
   if (creating_new_log) {
     // TODO: Write buffer size passed in should be max of all CF's instead
@@ -1847,6 +2357,33 @@ Status DBImpl::SwitchMemtable(ColumnFamilyData* cfd, WriteContext* context) {
       s = io_s;
     }
   }
+  for (size_t i = 0; s.ok() && i < new_stream_numbers.size(); i++) {
+    // Nothing is appended to the WAL streams while they are entered
+    // unbatched, so their files can be finished without holding the mutex.
+    // They are synced since SyncWAL() only syncs the current ones.
+    WalStream* wal_stream = wal_streams_[i].get();
+    if (!wal_stream->empty) {
+      io_s = wal_stream->writer->WriteBuffer();
+      if (io_s.ok()) {
+        io_s = wal_stream->writer->file()->Sync(
+            immutable_db_options_.use_fsync);
+      }
+    }
+    log::Writer* new_stream_writer = nullptr;
+    if (io_s.ok()) {
+      io_s = CreateWAL(new_stream_numbers[i], 0 /* recycle_log_number */,
+                       preallocate_block_size, &new_stream_writer);
+    }
+    if (io_s.ok()) {
+      new_stream_writers.push_back(new_stream_writer);
+    }
+    s = io_s;
+  }
+  if (s.ok() && !new_stream_writers.empty()) {
+    // Sync writes to the streams do not sync the WAL directory
+    io_s = directories_.GetWalDir()->Fsync(IOOptions(), nullptr);
+    s = io_s;
+  }
   if (s.ok()) {
     SequenceNumber seq = versions_->LastSequence();
     new_mem = cfd->ConstructNewMemtable(mutable_cf_options, seq);
@@ -1892,6 +2429,23 @@ Status DBImpl::SwitchMemtable(ColumnFamilyData* cfd, WriteContext* context) {
     }
     log_write_mutex_.Unlock();
   }
+  if (!new_stream_numbers.empty()) {
+    for (size_t i = 0; s.ok() && i < wal_streams_.size(); i++) {
+      WalStream* wal_stream = wal_streams_[i].get();
+      logs_to_free_.push_back(wal_stream->writer);
+      wal_stream->writer = new_stream_writers[i];
+      wal_stream_files_.emplace_back(new_stream_numbers[i]);
+      wal_stream->file = &wal_stream_files_.back();
+      wal_stream->empty = true;
+    }
+    if (!s.ok()) {
+      for (auto* new_stream_writer : new_stream_writers) {
+        delete new_stream_writer;
+      }
+    }
+    wal_streams_getting_synced_ = false;
+    log_sync_cv_.SignalAll();
+  }
 
   if (!s.ok()) {
     // how do we fail if we're not creating new log?
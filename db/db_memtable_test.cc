@@ -3,6 +3,7 @@
 //  COPYING file in the root directory) and Apache 2.0 License
 //  (found in the LICENSE.Apache file in the root directory).
 
+#include <algorithm>
 #include <memory>
 #include <string>
 
@@ -276,6 +277,427 @@ TEST_F(DBMemTableTest, ConcurrentMergeWrite) {
   delete mem;
 }
 
+#ifndef ROCKSDB_LITE
+TEST_F(DBMemTableTest, HashIndexedSkipList) {
+  const int kNumKeys = 50;
+  const SequenceNumber kNumOps = 2000;
+  Options options;
+  InternalKeyComparator cmp(BytewiseComparator());
+  // Few buckets, so that keys share index chains.
+  options.memtable_factory.reset(NewHashIndexedSkipListRepFactory(4));
+  options.allow_concurrent_memtable_write = true;
+  ImmutableOptions ioptions(options);
+  WriteBufferManager wb(options.db_write_buffer_size);
+  MemTable* mem = new MemTable(cmp, ioptions, MutableCFOptions(options), &wb,
+                               kMaxSequenceNumber, 0 /* column_family_id */);
+
+  // Sequence number `seq` writes key (seq % kNumKeys) with value `seq`. Two
+  // threads insert interleaved sequence numbers concurrently.
+  auto writer = [&](SequenceNumber first) {
+    MemTablePostProcessInfo post_process_info;
+    for (SequenceNumber seq = first; seq < kNumOps; seq += 2) {
+      ASSERT_OK(mem->Add(seq, kTypeValue, "key" + ToString(seq % kNumKeys),
+                         ToString(seq), nullptr /* kv_prot_info */,
+                         true /* allow_concurrent */, &post_process_info));
+    }
+  };
+  ROCKSDB_NAMESPACE::port::Thread write_thread1(writer, 1);
+  ROCKSDB_NAMESPACE::port::Thread write_thread2(writer, 2);
+  write_thread1.join();
+  write_thread2.join();
+
+  auto get = [&](const std::string& key, SequenceNumber snapshot,
+                 std::string* value) {
+    MergeContext merge_context;
+    SequenceNumber max_covering_tombstone_seq = 0;
+    Status status;
+    value->clear();
+    bool found = mem->Get(LookupKey(key, snapshot), value,
+                          /*timestamp=*/nullptr, &status, &merge_context,
+                          &max_covering_tombstone_seq, ReadOptions());
+    EXPECT_TRUE(status.ok() || status.IsNotFound());
+    return found;
+  };
+  std::string value;
+  for (int k = 0; k < kNumKeys; k++) {
+    std::string key = "key" + ToString(k);
+    // Latest value, served from the index.
+    SequenceNumber latest = kNumOps - kNumKeys + k;
+    ASSERT_TRUE(get(key, kMaxSequenceNumber, &value));
+    ASSERT_EQ(ToString(latest), value);
+    // Older snapshots fall back to a skip list search.
+    ASSERT_TRUE(get(key, latest - 1, &value));
+    ASSERT_EQ(ToString(latest - kNumKeys), value);
+  }
+  ASSERT_FALSE(get("key", kMaxSequenceNumber, &value));
+  ASSERT_FALSE(get("key" + ToString(kNumKeys), kMaxSequenceNumber, &value));
+
+  // Iteration sees every entry in order.
+  Arena arena;
+  ScopedArenaIterator iter(mem->NewIterator(ReadOptions(), &arena));
+  size_t count = 0;
+  std::string prev;
+  for (iter->SeekToFirst(); iter->Valid(); iter->Next()) {
+    if (count > 0) {
+      ASSERT_LT(cmp.Compare(prev, iter->key()), 0);
+    }
+    prev = iter->key().ToString();
+    count++;
+  }
+  ASSERT_EQ(kNumOps - 1, count);
+
+  delete mem;
+
+  // Only BytewiseComparator without timestamps is supported.
+  options = CurrentOptions();
+  options.memtable_factory.reset(NewHashIndexedSkipListRepFactory(16));
+  options.comparator = ReverseBytewiseComparator();
+  ASSERT_TRUE(TryReopen(options).IsInvalidArgument());
+  options.comparator = test::ComparatorWithU64Ts();
+  Status s = TryReopen(options);
+  ASSERT_TRUE(s.IsInvalidArgument());
+  ASSERT_NE(std::string::npos, s.ToString().find("timestamps"));
+  options.comparator = BytewiseComparator();
+  Reopen(options);
+  ASSERT_OK(Put("a", "v1"));
+  ASSERT_EQ("v1", Get("a"));
+}
+
+TEST_F(DBMemTableTest, ArtRep) {
+  const SequenceNumber kNumOps = 3000;
+  const int kNumThreads = 4;
+  InternalKeyComparator cmp(BytewiseComparator());
+  Random rnd(301);
+
+  // Short keys over a small alphabet including 0x00 and 0xff, so that keys
+  // are often prefixes of each other, and some 16-byte keys.
+  std::vector<std::string> user_keys = {"", "a", std::string("a\0", 2),
+                                        std::string("a\0\0", 3), "ab"};
+  const char kAlphabet[] = {'\0', '\1', 'a', '\xff'};
+  for (int i = 0; i < 200; i++) {
+    std::string key;
+    for (uint32_t len = rnd.Uniform(6); len > 0; len--) {
+      key.push_back(kAlphabet[rnd.Uniform(4)]);
+    }
+    user_keys.push_back(key);
+  }
+  for (int i = 0; i < 50; i++) {
+    user_keys.push_back(rnd.RandomString(16));
+  }
+  std::vector<std::string> key_of_seq(kNumOps + 1);
+  std::map<std::string, std::vector<SequenceNumber>> seqs_of_key;
+  std::vector<std::string> expected;
+  for (SequenceNumber seq = 1; seq <= kNumOps; seq++) {
+    key_of_seq[seq] = user_keys[rnd.Uniform(static_cast<int>(user_keys.size()))];
+    seqs_of_key[key_of_seq[seq]].push_back(seq);
+    expected.push_back(InternalKey(key_of_seq[seq], seq, kTypeValue).Encode()
+                           .ToString());
+  }
+  std::sort(expected.begin(), expected.end(),
+            [&cmp](const std::string& a, const std::string& b) {
+              return cmp.Compare(a, b) < 0;
+            });
+
+  for (bool concurrent : {false, true}) {
+    Options options;
+    options.memtable_factory.reset(NewArtRepFactory(concurrent));
+    options.allow_concurrent_memtable_write = concurrent;
+    ImmutableOptions ioptions(options);
+    WriteBufferManager wb(options.db_write_buffer_size);
+    MemTable* mem = new MemTable(cmp, ioptions, MutableCFOptions(options), &wb,
+                                 kMaxSequenceNumber, 0 /* column_family_id */);
+
+    auto writer = [&](SequenceNumber first, SequenceNumber step) {
+      MemTablePostProcessInfo post_process_info;
+      for (SequenceNumber seq = first; seq <= kNumOps; seq += step) {
+        ASSERT_OK(mem->Add(seq, kTypeValue, key_of_seq[seq], ToString(seq),
+                           nullptr /* kv_prot_info */, concurrent,
+                           concurrent ? &post_process_info : nullptr));
+      }
+    };
+    if (concurrent) {
+      std::vector<port::Thread> threads;
+      for (int t = 1; t <= kNumThreads; t++) {
+        threads.emplace_back(writer, t, kNumThreads);
+      }
+      for (auto& t : threads) {
+        t.join();
+      }
+    } else {
+      writer(1, 1);
+    }
+    // Duplicates are detected regardless of the value type.
+    ASSERT_TRUE(mem->Add(1, kTypeMerge, key_of_seq[1], "v",
+                         nullptr /* kv_prot_info */)
+                    .IsTryAgain());
+
+    Arena arena;
+    ScopedArenaIterator iter(mem->NewIterator(ReadOptions(), &arena));
+    size_t i = 0;
+    for (iter->SeekToFirst(); iter->Valid(); iter->Next(), i++) {
+      ASSERT_LT(i, expected.size());
+      ASSERT_EQ(expected[i], iter->key().ToString());
+    }
+    ASSERT_EQ(expected.size(), i);
+    for (iter->SeekToLast(); iter->Valid(); iter->Prev()) {
+      ASSERT_GT(i, 0);
+      ASSERT_EQ(expected[--i], iter->key().ToString());
+    }
+    ASSERT_EQ(0, i);
+
+    for (int probe = 0; probe < 1000; probe++) {
+      std::string user_key =
+          (probe % 2 == 0)
+              ? user_keys[rnd.Uniform(static_cast<int>(user_keys.size()))]
+              : rnd.RandomString(rnd.Uniform(4));
+      SequenceNumber snapshot = rnd.Uniform(static_cast<int>(kNumOps) + 2);
+      std::string target =
+          InternalKey(user_key, snapshot, kTypeValue).Encode().ToString();
+      auto lower = std::lower_bound(
+          expected.begin(), expected.end(), target,
+          [&cmp](const std::string& a, const std::string& b) {
+            return cmp.Compare(a, b) < 0;
+          });
+      iter->Seek(target);
+      if (lower == expected.end()) {
+        ASSERT_FALSE(iter->Valid());
+      } else {
+        ASSERT_TRUE(iter->Valid());
+        ASSERT_EQ(*lower, iter->key().ToString());
+      }
+      iter->SeekForPrev(target);
+      if (lower != expected.end() && *lower == target) {
+        ASSERT_TRUE(iter->Valid());
+        ASSERT_EQ(target, iter->key().ToString());
+      } else if (lower == expected.begin()) {
+        ASSERT_FALSE(iter->Valid());
+      } else {
+        ASSERT_TRUE(iter->Valid());
+        ASSERT_EQ(*(lower - 1), iter->key().ToString());
+      }
+
+      // Get returns the newest value visible at the snapshot.
+      SequenceNumber visible = 0;
+      for (SequenceNumber seq : seqs_of_key[user_key]) {
+        if (seq <= snapshot) {
+          visible = seq;
+        }
+      }
+      std::string value;
+      MergeContext merge_context;
+      SequenceNumber max_covering_tombstone_seq = 0;
+      Status s;
+      bool found = mem->Get(LookupKey(user_key, snapshot), &value,
+                            /*timestamp=*/nullptr, &s, &merge_context,
+                            &max_covering_tombstone_seq, ReadOptions());
+      ASSERT_EQ(visible != 0, found);
+      if (found) {
+        ASSERT_OK(s);
+        ASSERT_EQ(ToString(visible), value);
+      }
+    }
+    delete mem;
+  }
+
+  // Only BytewiseComparator is supported.
+  Options options = CurrentOptions();
+  options.memtable_factory.reset(NewArtRepFactory());
+  options.comparator = ReverseBytewiseComparator();
+  ASSERT_TRUE(TryReopen(options).IsInvalidArgument());
+  options.comparator = BytewiseComparator();
+  Reopen(options);
+  ASSERT_OK(Put("b", "v1"));
+  ASSERT_OK(Put("a", "v2"));
+  ASSERT_EQ("v1", Get("b"));
+  ASSERT_OK(Flush());
+  ASSERT_EQ("v2", Get("a"));
+}
+
+TEST_F(DBMemTableTest, SkipListKeyPrefix) {
+  Options options = CurrentOptions();
+  options.memtable_factory.reset(
+      new SkipListFactory(0 /* lookahead */, true /* use_key_prefix */));
+  options.comparator = ReverseBytewiseComparator();
+  ASSERT_TRUE(TryReopen(options).IsInvalidArgument());
+  options.comparator = BytewiseComparator();
+  Reopen(options);
+
+  // Keys shorter than, as long as and longer than the prefix, sharing it.
+  std::vector<std::string> keys = {"",         "a",         "abcdefg",
+                                   "abcdefgh", "abcdefgh1", "abcdefgh2",
+                                   "abcdefg\0", std::string("abcdefg\0", 8),
+                                   "abcdefgi", "b"};
+  std::sort(keys.begin(), keys.end());
+  keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+  for (size_t i = keys.size(); i > 0; i--) {
+    ASSERT_OK(Put(keys[i - 1], "v" + ToString(i - 1)));
+  }
+  for (size_t i = 0; i < keys.size(); i++) {
+    ASSERT_EQ("v" + ToString(i), Get(keys[i]));
+  }
+  ASSERT_EQ("NOT_FOUND", Get("abcdefgh0"));
+  std::unique_ptr<Iterator> iter(db_->NewIterator(ReadOptions()));
+  size_t i = 0;
+  for (iter->SeekToFirst(); iter->Valid(); iter->Next(), i++) {
+    ASSERT_EQ(keys[i], iter->key().ToString());
+  }
+  ASSERT_EQ(keys.size(), i);
+  iter->Seek("abcdefgh");
+  ASSERT_TRUE(iter->Valid());
+  ASSERT_EQ("abcdefgh", iter->key().ToString());
+}
+
+TEST_F(DBMemTableTest, ConcurrentInsertHashReps) {
+  const SequenceNumber kNumOps = 4000;
+  const int kNumThreads = 4;
+  InternalKeyComparator cmp(BytewiseComparator());
+  Random rnd(301);
+
+  // A few prefixes, so that buckets overflow into skip lists while being
+  // written from several threads.
+  std::vector<std::string> user_keys;
+  for (int i = 0; i < 400; i++) {
+    user_keys.push_back(std::string(1, static_cast<char>('a' + i % 5)) +
+                        rnd.RandomString(8));
+  }
+  std::vector<std::string> expected;
+  for (SequenceNumber seq = 1; seq <= kNumOps; seq++) {
+    expected.push_back(
+        InternalKey(user_keys[seq % user_keys.size()], seq, kTypeValue)
+            .Encode()
+            .ToString());
+  }
+  std::sort(expected.begin(), expected.end(),
+            [&cmp](const std::string& a, const std::string& b) {
+              return cmp.Compare(a, b) < 0;
+            });
+
+  std::vector<std::shared_ptr<MemTableRepFactory>> factories = {
+      std::shared_ptr<MemTableRepFactory>(NewHashSkipListRepFactory(4)),
+      std::shared_ptr<MemTableRepFactory>(NewHashLinkListRepFactory(
+          4, 0 /* huge_page_tlb_size */, 0 /* logging_threshold */,
+          false /* log_bucket_dist */, 16 /* threshold_use_skiplist */))};
+  for (auto& factory : factories) {
+    ASSERT_TRUE(factory->IsInsertConcurrentlySupported());
+    Options options;
+    options.memtable_factory = factory;
+    options.prefix_extractor.reset(NewFixedPrefixTransform(1));
+    options.allow_concurrent_memtable_write = true;
+    ImmutableOptions ioptions(options);
+    WriteBufferManager wb(options.db_write_buffer_size);
+    MemTable* mem = new MemTable(cmp, ioptions, MutableCFOptions(options), &wb,
+                                 kMaxSequenceNumber, 0 /* column_family_id */);
+
+    auto writer = [&](SequenceNumber first, SequenceNumber last,
+                      SequenceNumber step, bool concurrent) {
+      MemTablePostProcessInfo post_process_info;
+      for (SequenceNumber seq = first; seq <= last; seq += step) {
+        ASSERT_OK(mem->Add(seq, kTypeValue, user_keys[seq % user_keys.size()],
+                           ToString(seq), nullptr /* kv_prot_info */,
+                           concurrent,
+                           concurrent ? &post_process_info : nullptr));
+      }
+    };
+    // Alternate single-threaded and concurrent phases, as write groups of
+    // one and of several writers do.
+    const SequenceNumber kPhase = kNumOps / 4;
+    for (SequenceNumber begin = 1; begin <= kNumOps; begin += kPhase) {
+      SequenceNumber end = begin + kPhase - 1;
+      if ((begin / kPhase) % 2 == 0) {
+        writer(begin, end, 1, false);
+        continue;
+      }
+      std::vector<port::Thread> threads;
+      for (int t = 0; t < kNumThreads; t++) {
+        threads.emplace_back(writer, begin + t, end, kNumThreads, true);
+      }
+      for (auto& t : threads) {
+        t.join();
+      }
+    }
+
+    ReadOptions read_options;
+    read_options.total_order_seek = true;
+    Arena arena;
+    ScopedArenaIterator iter(mem->NewIterator(read_options, &arena));
+    size_t i = 0;
+    for (iter->SeekToFirst(); iter->Valid(); iter->Next(), i++) {
+      ASSERT_LT(i, expected.size());
+      ASSERT_EQ(expected[i], iter->key().ToString());
+    }
+    ASSERT_EQ(expected.size(), i);
+
+    for (SequenceNumber seq = 1; seq <= kNumOps; seq += 7) {
+      const std::string& user_key = user_keys[seq % user_keys.size()];
+      std::string value;
+      MergeContext merge_context;
+      SequenceNumber max_covering_tombstone_seq = 0;
+      Status s;
+      ASSERT_TRUE(mem->Get(LookupKey(user_key, seq), &value,
+                           /*timestamp=*/nullptr, &s, &merge_context,
+                           &max_covering_tombstone_seq, ReadOptions()));
+      ASSERT_OK(s);
+      ASSERT_EQ(ToString(seq), value);
+    }
+    delete mem;
+  }
+}
+
+TEST_F(DBMemTableTest, VectorRepParallelSort) {
+  // Enough entries for four sort threads.
+  const SequenceNumber kNumOps = 80000;
+  InternalKeyComparator cmp(BytewiseComparator());
+  Random rnd(301);
+
+  for (bool sorted_input : {false, true}) {
+    std::vector<std::string> user_keys;
+    for (SequenceNumber seq = 1; seq <= kNumOps; seq++) {
+      user_keys.push_back(sorted_input ? Key(static_cast<int>(seq))
+                                       : rnd.RandomString(10));
+    }
+    std::vector<std::string> expected;
+    for (SequenceNumber seq = 1; seq <= kNumOps; seq++) {
+      expected.push_back(InternalKey(user_keys[seq - 1], seq, kTypeValue)
+                             .Encode()
+                             .ToString());
+    }
+    std::sort(expected.begin(), expected.end(),
+              [&cmp](const std::string& a, const std::string& b) {
+                return cmp.Compare(a, b) < 0;
+              });
+
+    Options options;
+    options.memtable_factory.reset(new VectorRepFactory(0, 4));
+    options.allow_concurrent_memtable_write = false;
+    ImmutableOptions ioptions(options);
+    WriteBufferManager wb(options.db_write_buffer_size);
+    MemTable* mem = new MemTable(cmp, ioptions, MutableCFOptions(options), &wb,
+                                 kMaxSequenceNumber, 0 /* column_family_id */);
+    for (SequenceNumber seq = 1; seq <= kNumOps; seq++) {
+      ASSERT_OK(mem->Add(seq, kTypeValue, user_keys[seq - 1], ToString(seq),
+                         nullptr /* kv_prot_info */));
+    }
+    mem->MarkImmutable();
+
+    Arena arena;
+    ScopedArenaIterator iter(mem->NewIterator(ReadOptions(), &arena));
+    // Created before the entries are sorted by the first iterator.
+    ScopedArenaIterator iter2(mem->NewIterator(ReadOptions(), &arena));
+    size_t i = 0;
+    for (iter->SeekToFirst(); iter->Valid(); iter->Next(), i++) {
+      ASSERT_LT(i, expected.size());
+      ASSERT_EQ(expected[i], iter->key().ToString());
+    }
+    ASSERT_EQ(expected.size(), i);
+    ASSERT_FALSE(iter2->Valid());
+    iter2->SeekToLast();
+    ASSERT_TRUE(iter2->Valid());
+    ASSERT_EQ(expected.back(), iter2->key().ToString());
+    delete mem;
+  }
+}
+#endif  // ROCKSDB_LITE
+
 TEST_F(DBMemTableTest, InsertWithHint) {
   Options options;
   options.allow_concurrent_memtable_write = false;
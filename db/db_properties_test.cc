@@ -988,6 +988,42 @@ TEST_F(DBPropertiesTest, ApproximateMemoryUsage) {
   ASSERT_EQ(unflushed_mem, all_mem);
 }
 
+TEST_F(DBPropertiesTest, CurSizeAllMemTablesByNumaNode) {
+  Options options = CurrentOptions();
+  options.memtable_numa_aware = true;
+  options.memtable_transparent_huge_pages = true;
+  options.allow_concurrent_memtable_write = true;
+  DestroyAndReopen(options);
+
+  Random rnd(301);
+  for (int i = 0; i < 1000; ++i) {
+    ASSERT_OK(Put(Key(i), rnd.RandomString(100)));
+  }
+
+  std::map<std::string, std::string> by_node;
+  ASSERT_TRUE(dbfull()->GetMapProperty(
+      DB::Properties::kCurSizeAllMemTablesByNumaNode, &by_node));
+  uint64_t unflushed_mem;
+  ASSERT_TRUE(dbfull()->GetIntProperty(DB::Properties::kCurSizeAllMemTables,
+                                       &unflushed_mem));
+  // Only the memory of node-local shard arenas is reported, which is empty
+  // without NUMA support.
+  uint64_t total = 0;
+  for (const auto& node_and_size : by_node) {
+    total += std::stoull(node_and_size.second);
+  }
+  ASSERT_LE(total, unflushed_mem);
+  std::string by_node_str;
+  ASSERT_TRUE(dbfull()->GetProperty(
+      DB::Properties::kCurSizeAllMemTablesByNumaNode, &by_node_str));
+  ASSERT_EQ(by_node.empty(), by_node_str.empty());
+
+  ASSERT_OK(Flush());
+  for (int i = 0; i < 1000; ++i) {
+    ASSERT_EQ(100, Get(Key(i)).size());
+  }
+}
+
 TEST_F(DBPropertiesTest, EstimatePendingCompBytes) {
   // Set sizes to both background thread pool to be 1 and block them.
   env_->SetBackgroundThreads(1, Env::HIGH);
@@ -3652,6 +3652,7 @@ TEST_F(DBTest2, LowPriWrite) {
   options.level0_slowdown_writes_trigger = 12;
   options.level0_stop_writes_trigger = 30;
   options.delayed_write_rate = 8 * 1024 * 1024;
+  options.zero_copy_put_min_value_size = 512;
   Reopen(options);
 
   std::atomic<int> rate_limit_count(0);
@@ -3683,16 +3684,29 @@ TEST_F(DBTest2, LowPriWrite) {
   Put("", "", wo);
   ASSERT_EQ(1, rate_limit_count.load());
 
+  // The limiter is charged for the value too, which a Put() of a value
+  // larger than zero_copy_put_min_value_size does not copy into the batch.
+  RateLimiter* low_pri_rate_limiter =
+      dbfull()->TEST_write_controler().low_pri_rate_limiter();
+  const int64_t bytes_before =
+      low_pri_rate_limiter->GetTotalBytesThrough(Env::IO_HIGH);
+  wo.low_pri = true;
+  Put("k", std::string(1000, 'v'), wo);
+  ASSERT_EQ(2, rate_limit_count.load());
+  ASSERT_GT(low_pri_rate_limiter->GetTotalBytesThrough(Env::IO_HIGH) -
+                bytes_before,
+            1000);
+
   TEST_SYNC_POINT("DBTest.LowPriWrite:0");
   ROCKSDB_NAMESPACE::SyncPoint::GetInstance()->DisableProcessing();
 
   dbfull()->TEST_WaitForCompact();
   wo.low_pri = true;
   Put("", "", wo);
-  ASSERT_EQ(1, rate_limit_count.load());
+  ASSERT_EQ(2, rate_limit_count.load());
   wo.low_pri = false;
   Put("", "", wo);
-  ASSERT_EQ(1, rate_limit_count.load());
+  ASSERT_EQ(2, rate_limit_count.load());
 }
 
 #ifndef ROCKSDB_LITE
@@ -127,7 +127,8 @@ bool DBTestBase::ShouldSkipOptions(int option_config, int skip_mask) {
         option_config == kUniversalCompactionMultiLevel ||
         option_config == kUniversalSubcompactions ||
         option_config == kFIFOCompaction ||
-        option_config == kConcurrentSkipList) {
+        option_config == kConcurrentSkipList ||
+        option_config == kHashIndexedSkipList) {
       return true;
     }
 #endif
@@ -361,8 +362,6 @@ Options DBTestBase::GetOptions(
     case kHashSkipList:
       options.prefix_extractor.reset(NewFixedPrefixTransform(1));
       options.memtable_factory.reset(NewHashSkipListRepFactory(16));
-      options.allow_concurrent_memtable_write = false;
-      options.unordered_write = false;
       break;
     case kPlainTableFirstBytePrefix:
       options.table_factory.reset(NewPlainTableFactory());
@@ -401,8 +400,9 @@ Options DBTestBase::GetOptions(
       options.prefix_extractor.reset(NewFixedPrefixTransform(1));
       options.memtable_factory.reset(
           NewHashLinkListRepFactory(4, 0, 3, true, 4));
-      options.allow_concurrent_memtable_write = false;
-      options.unordered_write = false;
+      break;
+    case kHashIndexedSkipList:
+      options.memtable_factory.reset(NewHashIndexedSkipListRepFactory(16));
       break;
       case kDirectIO: {
         options.use_direct_reads = true;
@@ -941,6 +941,7 @@ class DBTestBase : public testing::Test {
     kUniversalSubcompactions,
     kxxHash64Checksum,
     kUnorderedWrite,
+    kHashIndexedSkipList,
     // This must be the last line
     kEnd,
   };
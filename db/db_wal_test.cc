@@ -302,6 +302,59 @@ TEST_F(DBWALTest, Recover) {
   } while (ChangeWalOptions());
 }
 
+TEST_F(DBWALTest, RecoverWithWalCompression) {
+  if (!StreamingCompressionTypeSupported(kZSTD)) {
+    ROCKSDB_GTEST_SKIP("Test requires ZSTD streaming support");
+    return;
+  }
+  Options options = CurrentOptions();
+  options.wal_compression = kZSTD;
+  CreateAndReopenWithCF({"pikachu"}, options);
+  const SequenceNumber start_seq = dbfull()->GetLatestSequenceNumber() + 1;
+  Random rnd(301);
+  std::vector<std::string> values;
+  for (int i = 0; i < 100; i++) {
+    values.push_back(rnd.RandomString(100) + std::string(1000, 'v'));
+    ASSERT_OK(Put(1, Key(i), values[i]));
+  }
+
+  // GetUpdatesSince() reads the compressed WAL.
+  std::unique_ptr<TransactionLogIterator> iter;
+  ASSERT_OK(dbfull()->GetUpdatesSince(start_seq, &iter));
+  int num_batches = 0;
+  for (; iter->Valid(); iter->Next()) {
+    BatchResult batch = iter->GetBatch();
+    ASSERT_EQ(start_seq + num_batches, batch.sequence);
+    ASSERT_EQ(1, batch.writeBatchPtr->Count());
+    num_batches++;
+  }
+  ASSERT_OK(iter->status());
+  ASSERT_EQ(100, num_batches);
+  iter.reset();
+
+  // So does recovery, also of a WAL written without compression.
+  ReopenWithColumnFamilies({"default", "pikachu"}, options);
+  for (int i = 0; i < 100; i++) {
+    ASSERT_EQ(values[i], Get(1, Key(i)));
+  }
+  ASSERT_OK(Put(1, "foo", "v1"));
+  options.wal_compression = kNoCompression;
+  ReopenWithColumnFamilies({"default", "pikachu"}, options);
+  ASSERT_OK(Put(1, "bar", "v2"));
+  options.wal_compression = kZSTD;
+  ReopenWithColumnFamilies({"default", "pikachu"}, options);
+  ASSERT_EQ("v1", Get(1, "foo"));
+  ASSERT_EQ("v2", Get(1, "bar"));
+
+  options.recycle_log_file_num = 1;
+  ASSERT_TRUE(TryReopenWithColumnFamilies({"default", "pikachu"}, options)
+                  .IsInvalidArgument());
+  options.recycle_log_file_num = 0;
+  options.wal_compression = kSnappyCompression;
+  ASSERT_TRUE(TryReopenWithColumnFamilies({"default", "pikachu"}, options)
+                  .IsInvalidArgument());
+}
+
 TEST_F(DBWALTest, RecoverWithTableHandle) {
   do {
     Options options = CurrentOptions();
@@ -1045,6 +1098,322 @@ TEST_F(DBWALTest, RecoverWithLargeLog) {
   } while (ChangeWalOptions());
 }
 
+TEST_F(DBWALTest, RecoverWithParallelInsert) {
+  Options options = CurrentOptions();
+  CreateAndReopenWithCF({"pikachu", "eevee"}, options);
+
+  Random rnd(301);
+  std::map<std::string, std::string> expected[3];
+  for (int i = 0; i < 2000; i++) {
+    WriteBatch batch;
+    for (int cf = 0; cf < 3; cf++) {
+      std::string key = Key(static_cast<int>(rnd.Uniform(1000)));
+      if (rnd.OneIn(10)) {
+        ASSERT_OK(batch.Delete(handles_[cf], key));
+        expected[cf].erase(key);
+      } else {
+        std::string value = rnd.RandomString(1000);
+        ASSERT_OK(batch.Put(handles_[cf], key, value));
+        expected[cf][key] = value;
+      }
+    }
+    ASSERT_OK(dbfull()->Write(WriteOptions(), &batch));
+  }
+  SequenceNumber last_sequence = db_->GetLatestSequenceNumber();
+
+  // Re-open with a small write buffer, so that memtables are flushed between
+  // the groups of write batches inserted concurrently.
+  options.wal_recovery_threads = 4;
+  options.write_buffer_size = 1 << 20;
+  ReopenWithColumnFamilies({"default", "pikachu", "eevee"}, options);
+  ASSERT_EQ(last_sequence, db_->GetLatestSequenceNumber());
+  ASSERT_GT(GetNumberOfSstFilesForColumnFamily(db_, "pikachu"), 0);
+  for (int cf = 0; cf < 3; cf++) {
+    std::unique_ptr<Iterator> iter(
+        db_->NewIterator(ReadOptions(), handles_[cf]));
+    auto expected_it = expected[cf].begin();
+    for (iter->SeekToFirst(); iter->Valid(); iter->Next(), ++expected_it) {
+      ASSERT_TRUE(expected_it != expected[cf].end());
+      ASSERT_EQ(expected_it->first, iter->key().ToString());
+      ASSERT_EQ(expected_it->second, iter->value().ToString());
+    }
+    ASSERT_OK(iter->status());
+    ASSERT_TRUE(expected_it == expected[cf].end());
+  }
+
+  ASSERT_OK(Put(1, "foo", "v1"));
+  ASSERT_EQ(last_sequence + 1, db_->GetLatestSequenceNumber());
+}
+
+TEST_F(DBWALTest, PointInTimeRecoveryWithParallelInsert) {
+  Options options = CurrentOptions();
+  options.wal_recovery_mode = WALRecoveryMode::kPointInTimeRecovery;
+  options.wal_recovery_threads = 4;
+  Reopen(options);
+
+  const int kNumKeys = 1000;
+  for (int i = 0; i < kNumKeys; i++) {
+    ASSERT_OK(Put(Key(i), DummyString(100)));
+  }
+  std::string fname = LogFileName(dbname_, dbfull()->TEST_LogfileNumber());
+  Close();
+  uint64_t size;
+  ASSERT_OK(env_->GetFileSize(fname, &size));
+  ASSERT_OK(test::CorruptFile(env_, fname, static_cast<int>(size / 2), 4,
+                              false));
+
+  // Only the keys written before the corruption are recovered.
+  Reopen(options);
+  int recovered = 0;
+  while (recovered < kNumKeys && Get(Key(recovered)) != "NOT_FOUND") {
+    recovered++;
+  }
+  ASSERT_GT(recovered, 0);
+  ASSERT_LT(recovered, kNumKeys);
+  for (int i = recovered; i < kNumKeys; i++) {
+    ASSERT_EQ("NOT_FOUND", Get(Key(i)));
+  }
+}
+
+TEST_F(DBWALTest, RecoverWithWalStreams) {
+  Options options = CurrentOptions();
+  options.wal_streams = 4;
+  ASSERT_TRUE(TryReopen(options).IsInvalidArgument());
+  options.unordered_write = true;
+  options.track_and_verify_wals_in_manifest = false;
+  // Small memtables so that the streams switch files while writing and
+  // memtables are flushed during recovery.
+  options.write_buffer_size = 64 << 10;
+  DestroyAndReopen(options);
+  CreateAndReopenWithCF({"pikachu"}, options);
+
+  constexpr int kNumThreads = 8;
+  constexpr int kNumKeys = 300;
+  auto value_of = [](int t, int i) {
+    return std::string(100, static_cast<char>('a' + t)) + ToString(i);
+  };
+  SequenceNumber first_sequence = db_->GetLatestSequenceNumber();
+  std::vector<port::Thread> threads;
+  for (int t = 0; t < kNumThreads; t++) {
+    threads.emplace_back([&, t]() {
+      for (int i = 0; i < kNumKeys; i++) {
+        WriteOptions write_options;
+        write_options.sync = (i % 50 == 0);
+        std::string key = "key" + ToString(t) + "_" + ToString(i);
+        ASSERT_OK(db_->Put(write_options, handles_[t % 2], key,
+                           value_of(t, i)));
+      }
+    });
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+  ASSERT_OK(dbfull()->SyncWAL());
+  SequenceNumber last_sequence = db_->GetLatestSequenceNumber();
+  ASSERT_EQ(first_sequence + kNumThreads * kNumKeys, last_sequence);
+  ASSERT_TRUE(db_->GetUpdatesSince(0, nullptr).IsNotSupported());
+
+  ReopenWithColumnFamilies({"default", "pikachu"}, options);
+  ASSERT_EQ(last_sequence, db_->GetLatestSequenceNumber());
+  for (int t = 0; t < kNumThreads; t++) {
+    for (int i = 0; i < kNumKeys; i++) {
+      ASSERT_EQ(value_of(t, i),
+                Get(t % 2, "key" + ToString(t) + "_" + ToString(i)));
+    }
+  }
+
+  // Writes after recovery get later sequence numbers and survive a reopen
+  // that only replays the WALs written since.
+  ASSERT_OK(Put(1, "foo", "v1"));
+  ASSERT_EQ(last_sequence + 1, db_->GetLatestSequenceNumber());
+  ASSERT_OK(Flush(1));
+  ASSERT_OK(Put(1, "foo", "v2"));
+  ReopenWithColumnFamilies({"default", "pikachu"}, options);
+  ASSERT_EQ("v2", Get(1, "foo"));
+  ASSERT_EQ(last_sequence + 2, db_->GetLatestSequenceNumber());
+}
+
+TEST_F(DBWALTest, RecoverWalStreamsWithSingleStream) {
+  Options options = CurrentOptions();
+  options.wal_streams = 4;
+  options.unordered_write = true;
+  options.track_and_verify_wals_in_manifest = false;
+  options.avoid_flush_during_recovery = true;
+  DestroyAndReopen(options);
+
+  constexpr int kNumThreads = 8;
+  constexpr int kNumKeys = 200;
+  auto write = [&](const std::string& value) {
+    std::vector<port::Thread> threads;
+    for (int t = 0; t < kNumThreads; t++) {
+      threads.emplace_back([&, t]() {
+        for (int i = 0; i < kNumKeys; i++) {
+          ASSERT_OK(Put("key" + ToString(t) + "_" + ToString(i),
+                        value + ToString(t) + "_" + ToString(i)));
+        }
+      });
+    }
+    for (auto& thread : threads) {
+      thread.join();
+    }
+  };
+  write("a");
+  SequenceNumber last_sequence = db_->GetLatestSequenceNumber();
+
+  // The WALs written by the streams interleave, and are replayed merged by
+  // sequence number whatever the options of the DB reopening them.
+  options.wal_streams = 1;
+  Reopen(options);
+  ASSERT_EQ(last_sequence, db_->GetLatestSequenceNumber());
+  for (int t = 0; t < kNumThreads; t++) {
+    for (int i = 0; i < kNumKeys; i++) {
+      ASSERT_EQ("a" + ToString(t) + "_" + ToString(i),
+                Get("key" + ToString(t) + "_" + ToString(i)));
+    }
+  }
+
+  // A single stream after the interleaved ones
+  write("b");
+  last_sequence = db_->GetLatestSequenceNumber();
+  Reopen(options);
+  ASSERT_EQ(last_sequence, db_->GetLatestSequenceNumber());
+  for (int t = 0; t < kNumThreads; t++) {
+    for (int i = 0; i < kNumKeys; i++) {
+      ASSERT_EQ("b" + ToString(t) + "_" + ToString(i),
+                Get("key" + ToString(t) + "_" + ToString(i)));
+    }
+  }
+}
+
+TEST_F(DBWALTest, PointInTimeRecoveryWithTruncatedWalStream) {
+  Options options = CurrentOptions();
+  options.wal_streams = 4;
+  options.unordered_write = true;
+  options.track_and_verify_wals_in_manifest = false;
+  options.wal_recovery_mode = WALRecoveryMode::kPointInTimeRecovery;
+  DestroyAndReopen(options);
+
+  constexpr int kNumThreads = 8;
+  constexpr int kNumKeys = 200;
+  auto key_of = [](int t, int i) {
+    return "key" + ToString(t) + "_" + ToString(i);
+  };
+  SequenceNumber first_sequence = db_->GetLatestSequenceNumber();
+  std::vector<port::Thread> threads;
+  for (int t = 0; t < kNumThreads; t++) {
+    threads.emplace_back([&, t]() {
+      for (int i = 0; i < kNumKeys; i++) {
+        ASSERT_OK(Put(key_of(t, i), DummyString(100)));
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  Close();
+
+  // Tear the last record of the largest WAL, as a crash while writing it
+  // would.
+  std::vector<std::string> filenames;
+  ASSERT_OK(env_->GetChildren(dbname_, &filenames));
+  std::string largest_wal;
+  uint64_t largest_size = 0;
+  for (const auto& fname : filenames) {
+    uint64_t number;
+    FileType type;
+    uint64_t size;
+    if (ParseFileName(fname, &number, &type) && type == kWalFile &&
+        env_->GetFileSize(dbname_ + "/" + fname, &size).ok() &&
+        size > largest_size) {
+      largest_wal = dbname_ + "/" + fname;
+      largest_size = size;
+    }
+  }
+  ASSERT_GT(largest_size, 0);
+  ASSERT_OK(test::TruncateFile(env_, largest_wal, largest_size - 1));
+
+  // The records are recovered up to the lost one, and no later ones of the
+  // other streams, so that every thread's keys are recovered up to a point.
+  Reopen(options);
+  SequenceNumber last_sequence = db_->GetLatestSequenceNumber();
+  uint64_t num_recovered = 0;
+  for (int t = 0; t < kNumThreads; t++) {
+    int recovered = 0;
+    while (recovered < kNumKeys && Get(key_of(t, recovered)) != "NOT_FOUND") {
+      recovered++;
+    }
+    for (int i = recovered; i < kNumKeys; i++) {
+      ASSERT_EQ("NOT_FOUND", Get(key_of(t, i)));
+    }
+    num_recovered += recovered;
+  }
+  ASSERT_LT(num_recovered, static_cast<uint64_t>(kNumThreads * kNumKeys));
+  ASSERT_EQ(first_sequence + num_recovered, last_sequence);
+
+  ASSERT_OK(Put("foo", "v1"));
+  ASSERT_EQ(last_sequence + 1, db_->GetLatestSequenceNumber());
+  Reopen(options);
+  ASSERT_EQ("v1", Get("foo"));
+}
+
+TEST_F(DBWALTest, SyncWriteOnWalStreamSyncsEarlierWrites) {
+  std::unique_ptr<FaultInjectionTestEnv> fault_env(
+      new FaultInjectionTestEnv(env_));
+  Options options = CurrentOptions();
+  options.env = fault_env.get();
+  options.wal_streams = 4;
+  options.unordered_write = true;
+  options.track_and_verify_wals_in_manifest = false;
+  DestroyAndReopen(options);
+
+  constexpr int kNumRounds = 8;
+  constexpr int kNumThreads = 8;
+  constexpr int kNumKeys = 20;
+  auto key_of = [](int round, int t, int i) {
+    return "key" + ToString(round) + "_" + ToString(t) + "_" + ToString(i);
+  };
+  // The stream of a write depends on its thread, so each round is likely to
+  // have unsynced writes in other streams than its sync write.
+  for (int round = 0; round < kNumRounds; round++) {
+    std::vector<port::Thread> threads;
+    for (int t = 0; t < kNumThreads; t++) {
+      threads.emplace_back([&, t]() {
+        for (int i = 0; i < kNumKeys; i++) {
+          ASSERT_OK(Put(key_of(round, t, i), "value"));
+        }
+      });
+    }
+    for (auto& thread : threads) {
+      thread.join();
+    }
+    port::Thread sync_thread([&]() {
+      WriteOptions write_options;
+      write_options.sync = true;
+      ASSERT_OK(db_->Put(write_options, "sync" + ToString(round), "value"));
+    });
+    sync_thread.join();
+    SequenceNumber last_sequence = db_->GetLatestSequenceNumber();
+
+    // Every write before a sync write is durable after it, whichever stream
+    // it was written to.
+    fault_env->SetFilesystemActive(false);
+    Close();
+    ASSERT_OK(fault_env->DropUnsyncedFileData());
+    fault_env->ResetState();
+    Reopen(options);
+    ASSERT_EQ(last_sequence, db_->GetLatestSequenceNumber());
+    for (int t = 0; t < kNumThreads; t++) {
+      for (int i = 0; i < kNumKeys; i++) {
+        ASSERT_EQ("value", Get(key_of(round, t, i)));
+      }
+    }
+    ASSERT_EQ("value", Get("sync" + ToString(round)));
+  }
+
+  // Close before fault_env destruct.
+  Close();
+}
+
 // In https://reviews.facebook.net/D20661 we change
 // recovery behavior: previously for each log file each column family
 // memtable was flushed, even it was empty. Now it's changed:
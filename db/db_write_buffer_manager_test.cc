@@ -780,6 +780,55 @@ TEST_P(DBWriteBufferManagerTest, MixedSlowDownOptionsMultipleDB) {
   ROCKSDB_NAMESPACE::SyncPoint::GetInstance()->DisableProcessing();
 }
 
+// Test that a cost-aware write buffer manager flushes the column family with
+// more memory and fewer L0 files instead of the one with the oldest memtable.
+TEST_P(DBWriteBufferManagerTest, CostAwareFlushAvoidsL0Stall) {
+  Options options = CurrentOptions();
+  options.arena_block_size = 4096;
+  options.write_buffer_size = 500000;  // this is never hit
+  options.max_write_buffer_number = 4;
+  options.level0_slowdown_writes_trigger = 4;
+  options.disable_auto_compactions = true;
+  options.statistics = ROCKSDB_NAMESPACE::CreateDBStatistics();
+  std::shared_ptr<Cache> cache = NewLRUCache(4 * 1024 * 1024, 2);
+  cost_cache_ = GetParam();
+  options.write_buffer_manager.reset(new WriteBufferManager(
+      100000, cost_cache_ ? cache : nullptr, false /* allow_stall */,
+      true /* cost_aware_flush */));
+
+  WriteOptions wo;
+  wo.disableWAL = true;
+
+  CreateAndReopenWithCF({"cf1", "cf2"}, options);
+  // Two more L0 files bring "cf1" close to a write slowdown.
+  for (int i = 0; i < 2; i++) {
+    ASSERT_OK(Put(1, Key(i), DummyString(1), wo));
+    ASSERT_OK(Flush(1));
+  }
+  ASSERT_EQ(2, NumTableFilesAtLevel(0, 1));
+
+  // "cf1" has the oldest memtable, "cf2" the most memory.
+  ASSERT_OK(Put(1, Key(1), DummyString(30000), wo));
+  ASSERT_OK(Put(2, Key(1), DummyString(30000), wo));
+  ASSERT_OK(Put(2, Key(2), DummyString(30000), wo));
+  // WriteBufferManager::buffer_size_ has exceeded after the previous write is
+  // completed.
+  ASSERT_OK(Put(0, Key(1), DummyString(1), wo));
+  ASSERT_OK(dbfull()->TEST_WaitForFlushMemTable(handles_[2]));
+
+  ASSERT_EQ(2, NumTableFilesAtLevel(0, 1));
+  ASSERT_EQ(1, NumTableFilesAtLevel(0, 2));
+  ASSERT_EQ(1, TestGetTickerCount(options,
+                                  WRITE_BUFFER_MANAGER_COST_AWARE_FLUSHES));
+  ASSERT_EQ(1, TestGetTickerCount(options,
+                                  WRITE_BUFFER_MANAGER_FLUSHES_NOT_OLDEST));
+  ASSERT_GE(TestGetTickerCount(options,
+                               WRITE_BUFFER_MANAGER_COST_AWARE_FLUSH_BYTES),
+            60000);
+  ASSERT_EQ(0, TestGetTickerCount(options,
+                                  WRITE_BUFFER_MANAGER_FLUSHES_DEFERRED));
+}
+
 INSTANTIATE_TEST_CASE_P(DBWriteBufferManagerTest, DBWriteBufferManagerTest,
                         testing::Bool());
 
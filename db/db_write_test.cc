@@ -18,6 +18,7 @@
 #include "util/random.h"
 #include "util/string_util.h"
 #include "utilities/fault_injection_env.h"
+#include "utilities/fault_injection_fs.h"
 
 namespace ROCKSDB_NAMESPACE {
 
@@ -451,6 +452,284 @@ TEST_P(DBWriteTest, ConcurrentlyDisabledWAL) {
     ASSERT_LE(bytes_num, 1024 * 100);
 }
 
+TEST_P(DBWriteTest, PipelinedWalSync) {
+  constexpr int kNumThreads = 4;
+  constexpr int kNumKeys = 100;
+  std::unique_ptr<FaultInjectionTestEnv> mock_env(
+      new FaultInjectionTestEnv(env_));
+  Options options = GetOptions();
+  options.env = mock_env.get();
+  // Only takes effect with enable_pipelined_write.
+  options.pipelined_wal_sync = true;
+  Reopen(options);
+
+  WriteOptions write_options;
+  write_options.sync = true;
+  std::vector<port::Thread> threads;
+  for (int t = 0; t < kNumThreads; t++) {
+    threads.emplace_back([&, t]() {
+      for (int i = 0; i < kNumKeys; i++) {
+        std::string key = "key" + ToString(t) + "_" + ToString(i);
+        ASSERT_OK(dbfull()->Put(write_options, key, "value" + ToString(i)));
+      }
+    });
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+
+  // Acknowledged sync writes survive losing everything that was not synced.
+  mock_env->SetFilesystemActive(false);
+  Close();
+  ASSERT_OK(mock_env->DropUnsyncedFileData());
+  mock_env->ResetState();
+  Reopen(options);
+  for (int t = 0; t < kNumThreads; t++) {
+    for (int i = 0; i < kNumKeys; i++) {
+      ASSERT_EQ("value" + ToString(i),
+                Get("key" + ToString(t) + "_" + ToString(i)));
+    }
+  }
+
+  // Close before mock_env destruct.
+  Close();
+}
+
+TEST_P(DBWriteTest, PipelinedWalSyncErrorRecovery) {
+  Options options = GetOptions();
+  if (!options.enable_pipelined_write) {
+    // pipelined_wal_sync only takes effect with enable_pipelined_write.
+    return;
+  }
+  std::shared_ptr<FaultInjectionTestFS> fault_fs(
+      new FaultInjectionTestFS(env_->GetFileSystem()));
+  std::unique_ptr<Env> fault_fs_env(NewCompositeEnv(fault_fs));
+  options.env = fault_fs_env.get();
+  options.pipelined_wal_sync = true;
+  // Resume() manually instead of waiting for the free space to be polled.
+  class NoAutoRecoveryListener : public EventListener {
+   public:
+    void OnErrorRecoveryBegin(BackgroundErrorReason /*reason*/,
+                              Status bg_error, bool* auto_recovery) override {
+      bg_error.PermitUncheckedError();
+      *auto_recovery = false;
+    }
+  };
+  options.listeners.emplace_back(new NoAutoRecoveryListener());
+  Reopen(options);
+
+  WriteOptions write_options;
+  write_options.sync = true;
+  ASSERT_OK(dbfull()->Put(write_options, "key0", "value0"));
+
+  // Fail the sync of the next write, after its record was appended.
+  SyncPoint::GetInstance()->SetCallBack(
+      "DBImpl::BGWorkWalSync:BeforeSync", [&](void* /*arg*/) {
+        fault_fs->SetFilesystemActive(false, IOStatus::NoSpace("Out of space"));
+      });
+  SyncPoint::GetInstance()->EnableProcessing();
+  ASSERT_NOK(dbfull()->Put(write_options, "key1", "value1"));
+  SyncPoint::GetInstance()->DisableProcessing();
+  SyncPoint::GetInstance()->ClearAllCallBacks();
+  fault_fs->SetFilesystemActive(true);
+
+  // Writes are stopped until the DB is resumed, and then succeed again.
+  ASSERT_NOK(dbfull()->Put(write_options, "key2", "value2"));
+  ASSERT_OK(dbfull()->Resume());
+  ASSERT_OK(dbfull()->Put(write_options, "key3", "value3"));
+  ASSERT_EQ("value0", Get("key0"));
+  ASSERT_EQ("NOT_FOUND", Get("key1"));
+  ASSERT_EQ("value3", Get("key3"));
+
+  // Acknowledged sync writes survive losing everything that was not synced.
+  fault_fs->SetFilesystemActive(false);
+  Close();
+  ASSERT_OK(fault_fs->DropUnsyncedFileData());
+  fault_fs->ResetState();
+  Reopen(options);
+  ASSERT_EQ("value0", Get("key0"));
+  ASSERT_EQ("NOT_FOUND", Get("key1"));
+  ASSERT_EQ("NOT_FOUND", Get("key2"));
+  ASSERT_EQ("value3", Get("key3"));
+
+  // Close before fault_fs_env destruct.
+  Close();
+}
+
+TEST_P(DBWriteTest, LatencyBudgetLimitsWriteGroup) {
+  constexpr int kNumThreads = 4;
+  Options options = GetOptions();
+  options.statistics = ROCKSDB_NAMESPACE::CreateDBStatistics();
+  // Any write costs far more than a microsecond per kilobyte, so no write
+  // below is grouped with another.
+  options.write_batch_group_latency_budget_micros = 1;
+  Reopen(options);
+  for (int i = 0; i < 10; i++) {
+    ASSERT_OK(Put("warmup" + ToString(i), "value"));
+  }
+  ASSERT_OK(options.statistics->Reset());
+
+  std::atomic<int> ready_count{0};
+  std::atomic<int> leader_count{0};
+  std::vector<port::Thread> threads;
+  // Wait until all threads linked to the write thread, so that the first
+  // leader could group all of them.
+  SyncPoint::GetInstance()->SetCallBack(
+      "WriteThread::JoinBatchGroup:Wait", [&](void* arg) {
+        ready_count++;
+        auto* w = reinterpret_cast<WriteThread::Writer*>(arg);
+        if (w->state == WriteThread::STATE_GROUP_LEADER) {
+          leader_count++;
+          while (ready_count < kNumThreads) {
+            // busy waiting
+          }
+        }
+      });
+  SyncPoint::GetInstance()->EnableProcessing();
+  for (int i = 0; i < kNumThreads; i++) {
+    threads.push_back(port::Thread(
+        [&](int index) {
+          ASSERT_OK(Put("key" + ToString(index), std::string(1024, 'v')));
+        },
+        i));
+  }
+  for (int i = 0; i < kNumThreads; i++) {
+    threads[i].join();
+  }
+  SyncPoint::GetInstance()->DisableProcessing();
+  SyncPoint::GetInstance()->ClearAllCallBacks();
+  ASSERT_EQ(1, leader_count);
+
+  ASSERT_EQ(0, TestGetTickerCount(options, WRITE_DONE_BY_OTHER));
+  ASSERT_EQ(kNumThreads, TestGetTickerCount(options, WRITE_DONE_BY_SELF));
+  ASSERT_EQ(kNumThreads,
+            TestGetTickerCount(options, WRITE_GROUP_LARGE_BATCH_ALONE));
+  ASSERT_GE(TestGetTickerCount(options, WRITE_GROUP_LATENCY_LIMITED), 1);
+  HistogramData limit_bytes;
+  options.statistics->histogramData(WRITE_GROUP_LATENCY_LIMIT_BYTES,
+                                    &limit_bytes);
+  ASSERT_EQ(kNumThreads, limit_bytes.count);
+  for (int i = 0; i < kNumThreads; i++) {
+    ASSERT_EQ(std::string(1024, 'v'), Get("key" + ToString(i)));
+  }
+}
+
+TEST_P(DBWriteTest, SplitLargeBatchInsert) {
+  constexpr int kNumKeys = 4000;
+  Options options = GetOptions();
+  options.max_write_batch_insert_threads = 4;
+  Reopen(options);
+
+  std::atomic<int> num_splits{0};
+  std::atomic<size_t> num_ranges{0};
+  SyncPoint::GetInstance()->SetCallBack(
+      "DBImpl::InsertRangesIntoMemTable:Ranges", [&](void* arg) {
+        num_splits++;
+        num_ranges = reinterpret_cast<
+                         std::vector<WriteBatchInternal::RecordRange>*>(arg)
+                         ->size();
+      });
+  SyncPoint::GetInstance()->EnableProcessing();
+
+  // Later records of the batch overwrite or delete keys of earlier ones,
+  // possibly in another range.
+  Random rnd(301);
+  WriteBatch batch;
+  for (int i = 0; i < kNumKeys; i++) {
+    ASSERT_OK(batch.Put(Key(i), rnd.RandomString(300)));
+  }
+  for (int i = 0; i < kNumKeys; i += 10) {
+    ASSERT_OK(batch.Put(Key(i), "overwritten" + ToString(i)));
+  }
+  for (int i = 5; i < kNumKeys; i += 10) {
+    ASSERT_OK(batch.Delete(Key(i)));
+  }
+  const SequenceNumber seq = db_->GetLatestSequenceNumber();
+  ASSERT_OK(dbfull()->Write(WriteOptions(), &batch));
+  ASSERT_EQ(seq + batch.Count(), db_->GetLatestSequenceNumber());
+  ASSERT_EQ(1, num_splits);
+  ASSERT_EQ(4, num_ranges);
+
+  // A small batch is not split.
+  ASSERT_OK(Put("small", "value"));
+  ASSERT_EQ(1, num_splits);
+  SyncPoint::GetInstance()->DisableProcessing();
+  SyncPoint::GetInstance()->ClearAllCallBacks();
+
+  auto verify = [&]() {
+    for (int i = 0; i < kNumKeys; i += 5) {
+      if (i % 10 == 0) {
+        ASSERT_EQ("overwritten" + ToString(i), Get(Key(i)));
+      } else {
+        ASSERT_EQ("NOT_FOUND", Get(Key(i)));
+      }
+    }
+    ASSERT_EQ(300, Get(Key(1)).size());
+    ASSERT_EQ("value", Get("small"));
+  };
+  verify();
+  Reopen(options);
+  verify();
+  ASSERT_OK(Flush());
+  verify();
+}
+
+TEST_P(DBWriteTest, ZeroCopyPut) {
+  constexpr int kNumThreads = 4;
+  constexpr int kNumKeysPerThread = 20;
+  constexpr size_t kValueSize = 64 << 10;
+  Options options = GetOptions();
+  options.zero_copy_put_min_value_size = kValueSize;
+  CreateAndReopenWithCF({"pikachu"}, options);
+
+  std::atomic<int> num_zero_copy{0};
+  SyncPoint::GetInstance()->SetCallBack(
+      "DBImpl::Put:ZeroCopy", [&](void* /*arg*/) { num_zero_copy++; });
+  SyncPoint::GetInstance()->EnableProcessing();
+
+  // Values spanning several WAL blocks are written by concurrent threads, so
+  // that some of them are also grouped with other writes.
+  auto key = [](int t, int i) { return Key(t * kNumKeysPerThread + i); };
+  auto value = [](int t, int i) {
+    return ToString(i) +
+           std::string(kValueSize + i, static_cast<char>('a' + t));
+  };
+  std::vector<port::Thread> threads;
+  for (int t = 0; t < kNumThreads; t++) {
+    threads.emplace_back([&, t]() {
+      for (int i = 0; i < kNumKeysPerThread; i++) {
+        ASSERT_OK(Put(t % 2, key(t, i), value(t, i)));
+      }
+    });
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+  ASSERT_EQ(kNumThreads * kNumKeysPerThread, num_zero_copy);
+
+  // Smaller values are copied into a batch as usual.
+  ASSERT_OK(Put("small", "value"));
+  ASSERT_EQ(kNumThreads * kNumKeysPerThread, num_zero_copy);
+  SyncPoint::GetInstance()->DisableProcessing();
+  SyncPoint::GetInstance()->ClearAllCallBacks();
+
+  auto verify = [&]() {
+    for (int t = 0; t < kNumThreads; t++) {
+      for (int i = 0; i < kNumKeysPerThread; i++) {
+        ASSERT_EQ(value(t, i), Get(t % 2, key(t, i)));
+      }
+    }
+    ASSERT_EQ("value", Get("small"));
+  };
+  verify();
+  // The values are recovered from the WAL.
+  ReopenWithColumnFamilies({"default", "pikachu"}, options);
+  verify();
+  ASSERT_OK(Flush(0));
+  ASSERT_OK(Flush(1));
+  verify();
+}
+
 INSTANTIATE_TEST_CASE_P(DBWriteTestInstance, DBWriteTest,
                         testing::Values(DBTestBase::kDefault,
                                         DBTestBase::kConcurrentWALWrites,
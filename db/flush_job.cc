@@ -15,6 +15,8 @@
 #include <vector>
 
 #include "db/builder.h"
+#include "db/compaction/clipping_iterator.h"
+#include "db/compaction/compaction_iterator.h"
 #include "db/db_iter.h"
 #include "db/dbformat.h"
 #include "db/event_helpers.h"
@@ -23,6 +25,8 @@
 #include "db/memtable.h"
 #include "db/memtable_list.h"
 #include "db/merge_context.h"
+#include "db/merge_helper.h"
+#include "db/range_del_aggregator.h"
 #include "db/range_tombstone_fragmenter.h"
 #include "db/version_set.h"
 #include "file/file_util.h"
@@ -30,6 +34,7 @@
 #include "logging/event_logger.h"
 #include "logging/log_buffer.h"
 #include "logging/logging.h"
+#include "monitoring/flow_trace.h"
 #include "monitoring/iostats_context_imp.h"
 #include "monitoring/perf_context_imp.h"
 #include "monitoring/thread_status_util.h"
@@ -47,9 +52,6 @@
 #include "util/mutexlock.h"
 #include "util/stop_watch.h"
 
-// Control Write Flow Print
-int flush_flag = 1;
-
 namespace ROCKSDB_NAMESPACE {
 
 const char* GetFlushReasonString (FlushReason flush_reason) {
@@ -173,10 +175,7 @@ void FlushJob::PickMemTable() {
   db_mutex_->AssertHeld();
   assert(!pick_memtable_called);
 
-  if (DB_WRITE_FLOW == 1 && flush_flag == 1) {
-    fprintf(stdout, "  [19]        \t|        PickMemTable()     \t\t| db_impl_compaction_and_flush.cc (line 177)\n"); // Signal.Jin
-    //fprintf(stdout, "| PickMemTable() : Pick the Memtable to flush from the list |\n");
-  }
+  FLOW_TRACE_SCOPE(kFlowTraceFlush, "FlushJob::PickMemTable");
 
   pick_memtable_called = true;
   // Save the contents of the earliest memtable as a new Table
@@ -211,10 +210,7 @@ Status FlushJob::Run(LogsWithPrepTracker* prep_tracker,
   db_mutex_->AssertHeld();
   assert(pick_memtable_called);
 
-  if (DB_WRITE_FLOW == 1 && flush_flag == 1) {
-    fprintf(stdout, "  [20]        \t|        Run() {     \t\t\t| flush_job.cc (line 215)\n"); // Signal.Jin
-    //fprintf(stdout, "| Run() : A background thread performs the flush operation |\n");
-  }
+  FLOW_TRACE_SCOPE(kFlowTraceFlush, "FlushJob::Run");
 
   AutoThreadOperationStageUpdater stage_run(
       ThreadStatus::STAGE_FLUSH_RUN);
@@ -224,6 +220,23 @@ Status FlushJob::Run(LogsWithPrepTracker* prep_tracker,
     return Status::OK();
   }
 
+  if (CompactMemTablesInMemory() && ShouldKeepCompactedMemTable()) {
+    ROCKS_LOG_BUFFER(log_buffer_,
+                     "[%s] [JOB %d] Keeping compacted memtable in memory",
+                     cfd_->GetName().c_str(), job_context_->job_id);
+    cfd_->imm()->RollbackMemtableFlush(mems_, meta_.fd.GetNumber());
+    base_->Unref();
+    kept_memtables_in_memory_ = true;
+#ifndef ROCKSDB_LITE
+    // Completes the flush announced by OnFlushBegin(), without a file.
+    std::unique_ptr<FlushJobInfo> info =
+        GetFlushJobInfo(FileMetaData(), TableProperties());
+    info->file_path.clear();
+    committed_flush_jobs_info_.push_back(std::move(info));
+#endif  // !ROCKSDB_LITE
+    return Status::OK();
+  }
+
   // I/O measurement variables
   PerfLevel prev_perf_level = PerfLevel::kEnableTime;
   uint64_t prev_write_nanos = 0;
@@ -321,6 +334,142 @@ void FlushJob::Cancel() {
   base_->Unref();
 }
 
+bool FlushJob::CompactMemTablesInMemory() {
+  db_mutex_->AssertHeld();
+  if (!mutable_cf_options_.in_memory_compaction || mems_.size() < 2 ||
+      !write_manifest_ || db_options_.atomic_flush ||
+      cfd_->user_comparator()->timestamp_size() > 0) {
+    return false;
+  }
+  const uint64_t start_micros = clock_->NowMicros();
+  MemTable* compacted =
+      cfd_->ConstructNewMemtable(mutable_cf_options_, kMaxSequenceNumber);
+  compacted->InheritFrom(mems_);
+
+  db_mutex_->Unlock();
+  Status s;
+  uint64_t num_input_entries = 0;
+  uint64_t input_data_size = 0;
+  {
+    ReadOptions ro;
+    ro.total_order_seek = true;
+    Arena arena;
+    std::vector<InternalIterator*> memtables;
+    std::unique_ptr<CompactionRangeDelAggregator> range_del_agg(
+        new CompactionRangeDelAggregator(&cfd_->internal_comparator(),
+                                         existing_snapshots_));
+    for (MemTable* m : mems_) {
+      memtables.push_back(m->NewIterator(ro, &arena));
+      auto* range_del_iter =
+          m->NewRangeTombstoneIterator(ro, kMaxSequenceNumber);
+      if (range_del_iter != nullptr) {
+        range_del_agg->AddTombstones(
+            std::unique_ptr<FragmentedRangeTombstoneIterator>(range_del_iter));
+      }
+      num_input_entries += m->num_entries();
+      input_data_size += m->get_data_size();
+    }
+    ScopedArenaIterator iter(
+        NewMergingIterator(&cfd_->internal_comparator(), &memtables[0],
+                           static_cast<int>(memtables.size()), &arena));
+    iter->SeekToFirst();
+
+    // Compaction filters are left to the flush that eventually writes the
+    // entries to an SST file.
+    MergeHelper merge(
+        db_options_.env, cfd_->user_comparator(),
+        cfd_->ioptions()->merge_operator.get(), nullptr /* compaction_filter */,
+        db_options_.info_log.get(),
+        true /* internal key corruption is not ok */,
+        existing_snapshots_.empty() ? 0 : existing_snapshots_.back(),
+        snapshot_checker_);
+    CompactionIterator c_iter(
+        iter.get(), cfd_->user_comparator(), &merge, kMaxSequenceNumber,
+        &existing_snapshots_, earliest_write_conflict_snapshot_,
+        snapshot_checker_, db_options_.env, false /* report_detailed_time */,
+        true /* internal key corruption is not ok */, range_del_agg.get(),
+        nullptr /* blob_file_builder */, db_options_.allow_data_in_errors,
+        /*compaction=*/nullptr, /*compaction_filter=*/nullptr, shutting_down_);
+    for (c_iter.SeekToFirst(); c_iter.Valid(); c_iter.Next()) {
+      const ParsedInternalKey& ikey = c_iter.ikey();
+      s = compacted->Add(ikey.sequence, ikey.type, ikey.user_key,
+                         c_iter.value(), nullptr /* kv_prot_info */);
+      if (!s.ok()) {
+        break;
+      }
+    }
+    if (!s.ok()) {
+      c_iter.status().PermitUncheckedError();
+    } else {
+      s = c_iter.status();
+    }
+    if (s.ok()) {
+      auto range_del_it = range_del_agg->NewIterator();
+      for (range_del_it->SeekToFirst(); s.ok() && range_del_it->Valid();
+           range_del_it->Next()) {
+        auto tombstone = range_del_it->Tombstone();
+        s = compacted->Add(tombstone.seq_, kTypeRangeDeletion,
+                           tombstone.start_key_, tombstone.end_key_,
+                           nullptr /* kv_prot_info */);
+      }
+    }
+  }
+  TEST_SYNC_POINT("FlushJob::CompactMemTablesInMemory:Done");
+  db_mutex_->Lock();
+
+  if (s.ok() && cfd_->IsDropped()) {
+    s = Status::ColumnFamilyDropped();
+  }
+  if (!s.ok()) {
+    ROCKS_LOG_BUFFER(log_buffer_,
+                     "[%s] [JOB %d] In-memory compaction of %" ROCKSDB_PRIszt
+                     " memtables failed, flushing them as they are: %s",
+                     cfd_->GetName().c_str(), job_context_->job_id,
+                     mems_.size(), s.ToString().c_str());
+    delete compacted;
+    return false;
+  }
+
+  event_logger_->Log() << "job" << job_context_->job_id << "event"
+                       << "in_memory_compaction"
+                       << "num_memtables" << mems_.size()
+                       << "num_input_entries" << num_input_entries
+                       << "num_output_entries" << compacted->num_entries()
+                       << "input_data_size" << input_data_size
+                       << "output_data_size" << compacted->get_data_size()
+                       << "micros" << clock_->NowMicros() - start_micros;
+
+  compacted->Ref();
+  cfd_->imm()->InstallInMemoryCompactionResult(
+      mems_, compacted, &job_context_->memtables_to_free);
+  mems_.clear();
+  mems_.push_back(compacted);
+  // The memtables' edit has been freed along with them.
+  edit_ = compacted->GetEdits();
+  edit_->SetPrevLogNumber(0);
+  edit_->SetLogNumber(compacted->GetNextLogNumber());
+  edit_->SetColumnFamily(cfd_->GetID());
+  return true;
+}
+
+bool FlushJob::ShouldKeepCompactedMemTable() const {
+  assert(mems_.size() == 1);
+  MemTable* compacted = mems_[0];
+  // Keep absorbing overwrites only while the flush is not urgent: it was
+  // triggered by a full write buffer rather than by a manual flush, memory
+  // pressure or shutdown, and more immutable memtables are to be merged
+  // before flushing. The compacted memtable must also stay below a write
+  // buffer, and the WAL it pins below max_write_buffer_number write buffers.
+  const uint64_t write_buffer_size = mutable_cf_options_.write_buffer_size;
+  const uint64_t max_written_data_size =
+      write_buffer_size * mutable_cf_options_.max_write_buffer_number;
+  return cfd_->GetFlushReason() == FlushReason::kWriteBufferFull &&
+         cfd_->ioptions()->min_write_buffer_number_to_merge > 1 &&
+         compacted->ApproximateMemoryUsage() < write_buffer_size &&
+         compacted->GetWrittenDataSize() < max_written_data_size &&
+         !shutting_down_->load(std::memory_order_acquire);
+}
+
 Status FlushJob::WriteLevel0Table() {
   AutoThreadOperationStageUpdater stage_updater(
       ThreadStatus::STAGE_FLUSH_WRITE_L0);
@@ -329,9 +478,7 @@ Status FlushJob::WriteLevel0Table() {
   const uint64_t start_cpu_micros = clock_->CPUNanos() / 1000;
   Status s;
 
-  if (DB_WRITE_FLOW == 1 && flush_flag == 1) {
-    fprintf(stdout, "  [21]        \t|         WriteLevel0Table() {     \t| flush_job.cc (line 333)\n"); // Signal.Jin
-  }
+  FLOW_TRACE_SCOPE(kFlowTraceFlush, "FlushJob::WriteLevel0Table");
 
   std::vector<BlobFileAddition> blob_file_additions;
 
@@ -351,6 +498,7 @@ Status FlushJob::WriteLevel0Table() {
     ro.total_order_seek = true;
     Arena arena;
     uint64_t total_num_entries = 0, total_num_deletes = 0;
+    uint64_t num_output_entries = 0;
     uint64_t total_data_size = 0;
     size_t total_memory_usage = 0;
     for (MemTable* m : mems_) {
@@ -379,14 +527,68 @@ Status FlushJob::WriteLevel0Table() {
                          << total_memory_usage << "flush_reason"
                          << GetFlushReasonString(cfd_->GetFlushReason());
 
+    // Output i gets the keys in [bounds[i - 1], bounds[i]), the first and
+    // last outputs being unbounded below and above.
+    std::vector<InternalKey> bounds;
+    if (range_del_iters.empty()) {
+      PickPartitionBounds(&bounds);
+    }
+    const size_t num_outputs = bounds.size() + 1;
+    partition_meta_.resize(num_outputs - 1);
+    std::vector<FileMetaData*> metas(1, &meta_);
+    for (auto& meta : partition_meta_) {
+      meta.fd = FileDescriptor(versions_->NewFileNumber(), 0, 0);
+      metas.push_back(&meta);
+    }
+
     {
-      ScopedArenaIterator iter(
+      // The first output reads the iterators created above, the others get
+      // their own.
+      std::vector<std::unique_ptr<Arena>> partition_arenas;
+      std::vector<ScopedArenaIterator> iters;
+      std::vector<std::unique_ptr<ClippingIterator>> clipping_iters;
+      std::vector<InternalIterator*> inputs;
+      iters.emplace_back(
           NewMergingIterator(&cfd_->internal_comparator(), &memtables[0],
                              static_cast<int>(memtables.size()), &arena));
-      ROCKS_LOG_INFO(db_options_.info_log,
-                     "[%s] [JOB %d] Level-0 flush table #%" PRIu64 ": started",
-                     cfd_->GetName().c_str(), job_context_->job_id,
-                     meta_.fd.GetNumber());
+      for (size_t i = 1; i < num_outputs; i++) {
+        partition_arenas.emplace_back(new Arena());
+        std::vector<InternalIterator*> partition_memtables;
+        for (MemTable* m : mems_) {
+          partition_memtables.push_back(
+              m->NewIterator(ro, partition_arenas.back().get()));
+        }
+        iters.emplace_back(NewMergingIterator(
+            &cfd_->internal_comparator(), &partition_memtables[0],
+            static_cast<int>(partition_memtables.size()),
+            partition_arenas.back().get()));
+      }
+      std::vector<Slice> encoded_bounds;
+      for (const auto& bound : bounds) {
+        encoded_bounds.push_back(bound.Encode());
+      }
+      if (num_outputs == 1) {
+        inputs.push_back(iters[0].get());
+      } else {
+        for (size_t i = 0; i < num_outputs; i++) {
+          clipping_iters.emplace_back(new ClippingIterator(
+              iters[i].get(), i > 0 ? &encoded_bounds[i - 1] : nullptr,
+              i + 1 < num_outputs ? &encoded_bounds[i] : nullptr,
+              &cfd_->internal_comparator()));
+          inputs.push_back(clipping_iters.back().get());
+        }
+      }
+      // Only unpartitioned flushes have range deletions.
+      std::vector<std::vector<std::unique_ptr<FragmentedRangeTombstoneIterator>>>
+          output_range_del_iters(num_outputs);
+      output_range_del_iters[0] = std::move(range_del_iters);
+      for (FileMetaData* meta : metas) {
+        ROCKS_LOG_INFO(db_options_.info_log,
+                       "[%s] [JOB %d] Level-0 flush table #%" PRIu64
+                       ": started",
+                       cfd_->GetName().c_str(), job_context_->job_id,
+                       meta->fd.GetNumber());
+      }
 
       TEST_SYNC_POINT_CALLBACK("FlushJob::WriteLevel0Table:output_compression",
                                &output_compression_);
@@ -412,43 +614,69 @@ Status FlushJob::WriteLevel0Table() {
       TEST_SYNC_POINT_CALLBACK(
           "FlushJob::WriteLevel0Table:oldest_ancester_time",
           &oldest_ancester_time);
-      meta_.oldest_ancester_time = oldest_ancester_time;
-
-      meta_.file_creation_time = current_time;
+      for (FileMetaData* meta : metas) {
+        meta->oldest_ancester_time = oldest_ancester_time;
+        meta->file_creation_time = current_time;
+      }
 
       uint64_t creation_time = (cfd_->ioptions()->compaction_style ==
                                 CompactionStyle::kCompactionStyleFIFO)
                                    ? current_time
                                    : meta_.oldest_ancester_time;
 
-      uint64_t num_input_entries = 0;
-      IOStatus io_s;
       const std::string* const full_history_ts_low =
           (full_history_ts_low_.empty()) ? nullptr : &full_history_ts_low_;
-      TableBuilderOptions tboptions(
-          *cfd_->ioptions(), mutable_cf_options_, cfd_->internal_comparator(),
-          cfd_->int_tbl_prop_collector_factories(), output_compression_,
-          mutable_cf_options_.compression_opts, cfd_->GetID(), cfd_->GetName(),
-          0 /* level */, false /* is_bottommost */,
-          TableFileCreationReason::kFlush, creation_time, oldest_key_time,
-          current_time, db_id_, db_session_id_, 0 /* target_file_size */,
-          meta_.fd.GetNumber());
-      s = BuildTable(
-          dbname_, versions_, db_options_, tboptions, file_options_,
-          cfd_->table_cache(), iter.get(), std::move(range_del_iters), &meta_,
-          &blob_file_additions, existing_snapshots_,
-          earliest_write_conflict_snapshot_, snapshot_checker_,
-          mutable_cf_options_.paranoid_file_checks, cfd_->internal_stats(),
-          &io_s, io_tracer_, event_logger_, job_context_->job_id, Env::IO_HIGH,
-          &table_properties_, write_hint, full_history_ts_low, blob_callback_,
-          &num_input_entries);
-      if (!io_s.ok()) {
-        io_status_ = io_s;
+      std::vector<Status> statuses(num_outputs);
+      std::vector<IOStatus> io_statuses(num_outputs);
+      std::vector<uint64_t> num_input_entries(num_outputs, 0);
+      partition_table_properties_.assign(num_outputs - 1, TableProperties());
+      auto build_output = [&](size_t i) {
+        TableBuilderOptions tboptions(
+            *cfd_->ioptions(), mutable_cf_options_,
+            cfd_->internal_comparator(),
+            cfd_->int_tbl_prop_collector_factories(), output_compression_,
+            mutable_cf_options_.compression_opts, cfd_->GetID(),
+            cfd_->GetName(), 0 /* level */, false /* is_bottommost */,
+            TableFileCreationReason::kFlush, creation_time, oldest_key_time,
+            current_time, db_id_, db_session_id_, 0 /* target_file_size */,
+            metas[i]->fd.GetNumber());
+        statuses[i] = BuildTable(
+            dbname_, versions_, db_options_, tboptions, file_options_,
+            cfd_->table_cache(), inputs[i],
+            std::move(output_range_del_iters[i]), metas[i],
+            i == 0 ? &blob_file_additions : nullptr, existing_snapshots_,
+            earliest_write_conflict_snapshot_, snapshot_checker_,
+            mutable_cf_options_.paranoid_file_checks, cfd_->internal_stats(),
+            &io_statuses[i], io_tracer_, event_logger_, job_context_->job_id,
+            Env::IO_HIGH,
+            i == 0 ? &table_properties_ : &partition_table_properties_[i - 1],
+            write_hint, full_history_ts_low, blob_callback_,
+            &num_input_entries[i]);
+      };
+      // The first output is written by this thread.
+      std::vector<port::Thread> partition_threads;
+      for (size_t i = 1; i < num_outputs; i++) {
+        partition_threads.emplace_back(build_output, i);
       }
-      if (num_input_entries != total_num_entries && s.ok()) {
+      build_output(0);
+      for (auto& thread : partition_threads) {
+        thread.join();
+      }
+
+      uint64_t total_num_input_entries = 0;
+      for (size_t i = 0; i < num_outputs; i++) {
+        if (!io_statuses[i].ok() && io_status_.ok()) {
+          io_status_ = io_statuses[i];
+        }
+        if (!statuses[i].ok() && s.ok()) {
+          s = statuses[i];
+        }
+        total_num_input_entries += num_input_entries[i];
+      }
+      if (total_num_input_entries != total_num_entries && s.ok()) {
         std::string msg = "Expected " + ToString(total_num_entries) +
                           " entries in memtables, but read " +
-                          ToString(num_input_entries);
+                          ToString(total_num_input_entries);
         ROCKS_LOG_WARN(db_options_.info_log, "[%s] [JOB %d] Level-0 flush %s",
                        cfd_->GetName().c_str(), job_context_->job_id,
                        msg.c_str());
@@ -456,71 +684,89 @@ Status FlushJob::WriteLevel0Table() {
           s = Status::Corruption(msg);
         }
       }
+      if (s.ok()) {
+        num_output_entries = table_properties_.num_entries;
+        for (const auto& props : partition_table_properties_) {
+          num_output_entries += props.num_entries;
+        }
+      }
       LogFlush(db_options_.info_log);
     }
-    ROCKS_LOG_INFO(db_options_.info_log,
-                   "[%s] [JOB %d] Level-0 flush table #%" PRIu64 ": %" PRIu64
-                   " bytes %s"
-                   "%s",
-                   cfd_->GetName().c_str(), job_context_->job_id,
-                   meta_.fd.GetNumber(), meta_.fd.GetFileSize(),
-                   s.ToString().c_str(),
-                   meta_.marked_for_compaction ? " (needs compaction)" : "");
+    for (FileMetaData* meta : metas) {
+      ROCKS_LOG_INFO(db_options_.info_log,
+                     "[%s] [JOB %d] Level-0 flush table #%" PRIu64
+                     ": %" PRIu64
+                     " bytes %s"
+                     "%s",
+                     cfd_->GetName().c_str(), job_context_->job_id,
+                     meta->fd.GetNumber(), meta->fd.GetFileSize(),
+                     s.ToString().c_str(),
+                     meta->marked_for_compaction ? " (needs compaction)" : "");
+    }
 
     if (s.ok() && output_file_directory_ != nullptr && sync_output_directory_) {
+      FLOW_TRACE_SCOPE(kFlowTraceFlush, "FlushJob::SyncOutputDirectory");
       s = output_file_directory_->Fsync(IOOptions(), nullptr);
-      if (DB_WRITE_FLOW == 1 && flush_flag == 1) {
-        fprintf(stdout, "  [22]        \t|          Fsync()     \t\t\t| flush_job.cc or io_posix (line 473)\n"); // Signal.Jin
-        fprintf(stdout, "  [23]        \t|         }\n");
-        fprintf(stdout, "  [24]        \t|        }\n");
-        fprintf(stdout, "  [25]        \t|       }\n");
-        fprintf(stdout, "  [26]        \t|      }\n");
-        fprintf(stdout, "  [27]        \t|     }\n");
-        fprintf(stdout, "  [28]        \t|    }\n");
-        fprintf(stdout, "  [29]        \t|   }\n");
-        fprintf(stdout, "  [30]        \t|  }\n");
-        fprintf(stdout, "  [31]        \t| } /*MemTable Flush To Storage Finish(One Time Loop)*/\n");
-        printf("#\n# Function Explanation (Write Flow)\n");
-        printf("# DoWrite() : Generate Random or Sequential Key and Value for Put(key, value) Operations\n");
-        printf("# Write() : Call WriteImpl() function\n");
-        printf("# WriteImpl() : Control main write queue and write options\n");
-        printf("# ScheduleFlushes() : If memtable full, signal to flush to Storage\n");
-        printf("# SwitchMemtable() : Change memtable to immutable memtable, ready to flush\n");
-        printf("# BackgroundFlush() : It actually flushes the immutable memtable to storage via a background thread\n");
-        printf("# PickMemTable() : Pick the Memtable to flush from the list\n");
-        printf("# MaybeScheduleFlushOrCompaction() : Always Check whether flush or compaction is required\n");
-        printf("# Run() : A background thread performs the flush operation\n");
-        printf("--------------------------------------------------------------------------------------\n");
-        flush_flag = 0;
-      }
     }
     TEST_SYNC_POINT_CALLBACK("FlushJob::WriteLevel0Table", &mems_);
     db_mutex_->Lock();
+    if (s.ok() && cfd_->write_buffer_flush_candidate() != nullptr) {
+      cfd_->write_buffer_flush_candidate()->RecordFlush(total_num_entries,
+                                                        num_output_entries);
+    }
   }
   base_->Unref();
 
+  std::vector<const FileMetaData*> outputs(1, &meta_);
+  for (const auto& meta : partition_meta_) {
+    outputs.push_back(&meta);
+  }
   // Note that if file_size is zero, the file has been deleted and
   // should not be added to the manifest.
-  const bool has_output = meta_.fd.GetFileSize() > 0;
+  uint64_t output_bytes = 0;
+  int num_output_files = 0;
+  for (const FileMetaData* meta : outputs) {
+    if (meta->fd.GetFileSize() > 0) {
+      output_bytes += meta->fd.GetFileSize();
+      num_output_files++;
+    }
+  }
+  const bool has_output = num_output_files > 0;
 
   if (s.ok() && has_output) {
     // if we have more than 1 background thread, then we cannot
     // insert files directly into higher levels because some other
     // threads could be concurrently producing compacted files for
     // that key range.
-    // Add file to L0
-    edit_->AddFile(0 /* level */, meta_.fd.GetNumber(), meta_.fd.GetPathId(),
-                   meta_.fd.GetFileSize(), meta_.smallest, meta_.largest,
-                   meta_.fd.smallest_seqno, meta_.fd.largest_seqno,
-                   meta_.marked_for_compaction, meta_.oldest_blob_file_number,
-                   meta_.oldest_ancester_time, meta_.file_creation_time,
-                   meta_.file_checksum, meta_.file_checksum_func_name);
+    // Add files to L0. The outputs of a partitioned flush are installed
+    // together by this edit.
+    for (const FileMetaData* meta : outputs) {
+      if (meta->fd.GetFileSize() == 0) {
+        continue;
+      }
+      edit_->AddFile(0 /* level */, meta->fd.GetNumber(),
+                     meta->fd.GetPathId(), meta->fd.GetFileSize(),
+                     meta->smallest, meta->largest, meta->fd.smallest_seqno,
+                     meta->fd.largest_seqno, meta->marked_for_compaction,
+                     meta->oldest_blob_file_number,
+                     meta->oldest_ancester_time, meta->file_creation_time,
+                     meta->file_checksum, meta->file_checksum_func_name);
+    }
 
     edit_->SetBlobFileAdditions(std::move(blob_file_additions));
   }
 #ifndef ROCKSDB_LITE
-  // Piggyback FlushJobInfo on the first first flushed memtable.
-  mems_[0]->SetFlushJobInfo(GetFlushJobInfo());
+  // Piggyback FlushJobInfo on the first first flushed memtable, one for each
+  // installed partition output besides the first.
+  if (s.ok()) {
+    mems_[0]->AddFlushJobInfo(GetFlushJobInfo(meta_, table_properties_));
+    for (size_t i = 0; i < partition_meta_.size(); i++) {
+      if (partition_meta_[i].fd.GetFileSize() > 0) {
+        mems_[0]->AddFlushJobInfo(GetFlushJobInfo(
+            partition_meta_[i], partition_table_properties_[i]));
+      }
+    }
+  }
 #endif  // !ROCKSDB_LITE
 
   // Note that here we treat flush as level 0 compaction in internal stats
@@ -529,8 +775,8 @@ Status FlushJob::WriteLevel0Table() {
   stats.cpu_micros = clock_->CPUNanos() / 1000 - start_cpu_micros;
 
   if (has_output) {
-    stats.bytes_written = meta_.fd.GetFileSize();
-    stats.num_output_files = 1;
+    stats.bytes_written = output_bytes;
+    stats.num_output_files = num_output_files;
   }
 
   const auto& blobs = edit_->GetBlobFileAdditions();
@@ -549,23 +795,63 @@ Status FlushJob::WriteLevel0Table() {
   return s;
 }
 
+void FlushJob::PickPartitionBounds(std::vector<InternalKey>* bounds) const {
+  const size_t num_partitions = mutable_cf_options_.flush_partitions;
+  const Comparator* ucmp = cfd_->user_comparator();
+  // Only level compaction treats the files of one flush as a single sorted
+  // run, and an atomic flush installs its results elsewhere.
+  if (num_partitions <= 1 ||
+      cfd_->ioptions()->compaction_style != kCompactionStyleLevel ||
+      !write_manifest_ || mutable_cf_options_.enable_blob_files ||
+      ucmp->timestamp_size() > 0) {
+    return;
+  }
+
+  // Enough samples per range for the ranges to get similar numbers of
+  // entries.
+  const size_t kSamplesPerPartition = 32;
+  std::vector<Slice> samples;
+  for (MemTable* m : mems_) {
+    m->SampleUserKeys(num_partitions * kSamplesPerPartition, &samples);
+  }
+  if (samples.size() < num_partitions) {
+    return;
+  }
+  std::sort(samples.begin(), samples.end(),
+            [ucmp](const Slice& a, const Slice& b) {
+              return ucmp->Compare(a, b) < 0;
+            });
+  for (size_t i = 1; i < num_partitions; i++) {
+    const Slice& user_key = samples[i * samples.size() / num_partitions];
+    // Bounds are user keys so that all entries of a key go to one file.
+    if (ucmp->Compare(user_key, samples.front()) > 0 &&
+        (bounds->empty() ||
+         ucmp->Compare(user_key, bounds->back().user_key()) > 0)) {
+      bounds->emplace_back();
+      bounds->back().SetMinPossibleForUserKey(user_key);
+    }
+  }
+  TEST_SYNC_POINT_CALLBACK("FlushJob::PickPartitionBounds", bounds);
+}
+
 #ifndef ROCKSDB_LITE
-std::unique_ptr<FlushJobInfo> FlushJob::GetFlushJobInfo() const {
+std::unique_ptr<FlushJobInfo> FlushJob::GetFlushJobInfo(
+    const FileMetaData& meta, const TableProperties& table_properties) const {
   db_mutex_->AssertHeld();
   std::unique_ptr<FlushJobInfo> info(new FlushJobInfo{});
   info->cf_id = cfd_->GetID();
   info->cf_name = cfd_->GetName();
 
-  const uint64_t file_number = meta_.fd.GetNumber();
+  const uint64_t file_number = meta.fd.GetNumber();
   info->file_path =
       MakeTableFileName(cfd_->ioptions()->cf_paths[0].path, file_number);
   info->file_number = file_number;
-  info->oldest_blob_file_number = meta_.oldest_blob_file_number;
+  info->oldest_blob_file_number = meta.oldest_blob_file_number;
   info->thread_id = db_options_.env->GetThreadID();
   info->job_id = job_context_->job_id;
-  info->smallest_seqno = meta_.fd.smallest_seqno;
-  info->largest_seqno = meta_.fd.largest_seqno;
-  info->table_properties = table_properties_;
+  info->smallest_seqno = meta.fd.smallest_seqno;
+  info->largest_seqno = meta.fd.largest_seqno;
+  info->table_properties = table_properties;
   info->flush_reason = cfd_->GetFlushReason();
   return info;
 }
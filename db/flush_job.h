@@ -96,13 +96,39 @@ class FlushJob {
   // Return the IO status
   IOStatus io_status() const { return io_status_; }
 
+  // The files written besides the one returned by Run() when the flush was
+  // split into key ranges (see flush_partitions). Empty otherwise. Files
+  // with a zero size were not installed.
+  const std::vector<FileMetaData>& GetPartitionOutputs() const {
+    return partition_meta_;
+  }
+
+  // True if Run() kept the memtables it compacted in memory (see
+  // in_memory_compaction) instead of writing a file.
+  bool KeptMemTablesInMemory() const { return kept_memtables_in_memory_; }
+
  private:
   void ReportStartedFlush();
   void ReportFlushInputSize(const autovector<MemTable*>& mems);
   void RecordFlushIOStats();
   Status WriteLevel0Table();
+  // Fills *bounds with the smallest internal keys of the second and later
+  // key ranges the memtables are split into, or leaves it empty if they are
+  // flushed to a single file.
+  void PickPartitionBounds(std::vector<InternalKey>* bounds) const;
+  // If in_memory_compaction is enabled and two or more memtables were
+  // picked, compacts them into a single memtable that replaces them in the
+  // immutable memtable list and in mems_, and returns true. Leaves mems_
+  // unchanged and returns false otherwise, including when the compaction
+  // fails, in which case the memtables are flushed as they are.
+  // This will release and re-acquire the mutex.
+  bool CompactMemTablesInMemory();
+  // Returns true if the memtable produced by CompactMemTablesInMemory()
+  // should stay in the immutable memtable list instead of being flushed.
+  bool ShouldKeepCompactedMemTable() const;
 #ifndef ROCKSDB_LITE
-  std::unique_ptr<FlushJobInfo> GetFlushJobInfo() const;
+  std::unique_ptr<FlushJobInfo> GetFlushJobInfo(
+      const FileMetaData& meta, const TableProperties& table_properties) const;
 #endif  // !ROCKSDB_LITE
 
   const std::string& dbname_;
@@ -156,6 +182,11 @@ class FlushJob {
 
   // Variables below are set by PickMemTable():
   FileMetaData meta_;
+  // Set by WriteLevel0Table(): the outputs of the second and later key
+  // ranges of a partitioned flush, meta_ being the first one.
+  std::vector<FileMetaData> partition_meta_;
+  std::vector<TableProperties> partition_table_properties_;
+  bool kept_memtables_in_memory_ = false;
   autovector<MemTable*> mems_;
   VersionEdit* edit_;
   Version* base_;
@@ -235,6 +235,8 @@ static const std::string background_errors = "background-errors";
 static const std::string cur_size_active_mem_table =
     "cur-size-active-mem-table";
 static const std::string cur_size_all_mem_tables = "cur-size-all-mem-tables";
+static const std::string cur_size_all_mem_tables_by_numa_node =
+    "cur-size-all-mem-tables-by-numa-node";
 static const std::string size_all_mem_tables = "size-all-mem-tables";
 static const std::string num_entries_active_mem_table =
     "num-entries-active-mem-table";
@@ -312,6 +314,8 @@ const std::string DB::Properties::kCurSizeActiveMemTable =
     rocksdb_prefix + cur_size_active_mem_table;
 const std::string DB::Properties::kCurSizeAllMemTables =
     rocksdb_prefix + cur_size_all_mem_tables;
+const std::string DB::Properties::kCurSizeAllMemTablesByNumaNode =
+    rocksdb_prefix + cur_size_all_mem_tables_by_numa_node;
 const std::string DB::Properties::kSizeAllMemTables =
     rocksdb_prefix + size_all_mem_tables;
 const std::string DB::Properties::kNumEntriesActiveMemTable =
@@ -426,6 +430,9 @@ const std::unordered_map<std::string, DBPropertyInfo>
         {DB::Properties::kCurSizeAllMemTables,
          {false, nullptr, &InternalStats::HandleCurSizeAllMemTables, nullptr,
           nullptr}},
+        {DB::Properties::kCurSizeAllMemTablesByNumaNode,
+         {false, &InternalStats::HandleCurSizeAllMemTablesByNumaNode, nullptr,
+          &InternalStats::HandleCurSizeAllMemTablesByNumaNodeMap, nullptr}},
         {DB::Properties::kSizeAllMemTables,
          {false, nullptr, &InternalStats::HandleSizeAllMemTables, nullptr,
           nullptr}},
@@ -929,6 +936,31 @@ bool InternalStats::HandleCurSizeAllMemTables(uint64_t* value, DBImpl* /*db*/,
   return true;
 }
 
+bool InternalStats::HandleCurSizeAllMemTablesByNumaNode(std::string* value,
+                                                        Slice suffix) {
+  std::map<std::string, std::string> values;
+  HandleCurSizeAllMemTablesByNumaNodeMap(&values, suffix);
+  value->clear();
+  for (const auto& node_and_size : values) {
+    value->append(node_and_size.first + "=" + node_and_size.second + "; ");
+  }
+  return true;
+}
+
+bool InternalStats::HandleCurSizeAllMemTablesByNumaNodeMap(
+    std::map<std::string, std::string>* values, Slice /*suffix*/) {
+  std::vector<size_t> usage;
+  cfd_->mem()->ApproximateMemoryUsageByNumaNode(&usage);
+  cfd_->imm()->ApproximateUnflushedMemTablesMemoryUsageByNumaNode(&usage);
+  values->clear();
+  for (size_t node = 0; node < usage.size(); ++node) {
+    if (usage[node] > 0) {
+      (*values)[ToString(node)] = ToString(usage[node]);
+    }
+  }
+  return true;
+}
+
 bool InternalStats::HandleSizeAllMemTables(uint64_t* value, DBImpl* /*db*/,
                                            Version* /*version*/) {
   // Using ApproximateMemoryUsageFast to avoid the need for synchronization
@@ -444,6 +444,18 @@ class InternalStats {
 
   uint64_t GetBackgroundErrorCount() const { return bg_error_count_; }
 
+  uint64_t GetBytesFlushed() const { return cf_stats_value_[BYTES_FLUSHED]; }
+
+  // Bytes read by compactions, from all levels.
+  uint64_t GetBytesCompacted() const {
+    uint64_t bytes = 0;
+    for (const auto& comp_stat : comp_stats_) {
+      bytes += comp_stat.bytes_read_non_output_levels +
+               comp_stat.bytes_read_output_level;
+    }
+    return bytes;
+  }
+
   uint64_t BumpAndGetBackgroundErrorCount() { return ++bg_error_count_; }
 
   bool GetStringProperty(const DBPropertyInfo& property_info,
@@ -631,6 +643,9 @@ class InternalStats {
   bool HandleCurSizeActiveMemTable(uint64_t* value, DBImpl* db,
                                    Version* version);
   bool HandleCurSizeAllMemTables(uint64_t* value, DBImpl* db, Version* version);
+  bool HandleCurSizeAllMemTablesByNumaNode(std::string* value, Slice suffix);
+  bool HandleCurSizeAllMemTablesByNumaNodeMap(
+      std::map<std::string, std::string>* values, Slice suffix);
   bool HandleSizeAllMemTables(uint64_t* value, DBImpl* db, Version* version);
   bool HandleNumEntriesActiveMemTable(uint64_t* value, DBImpl* db,
                                       Version* version);
@@ -768,6 +783,10 @@ class InternalStats {
 
   uint64_t GetBackgroundErrorCount() const { return 0; }
 
+  uint64_t GetBytesFlushed() const { return 0; }
+
+  uint64_t GetBytesCompacted() const { return 0; }
+
   uint64_t BumpAndGetBackgroundErrorCount() { return 0; }
 
   bool GetStringProperty(const DBPropertyInfo& /*property_info*/,
@@ -15,6 +15,7 @@
 #include "rocksdb/env.h"
 #include "test_util/sync_point.h"
 #include "util/coding.h"
+#include "util/compression.h"
 #include "util/crc32c.h"
 
 namespace ROCKSDB_NAMESPACE {
@@ -38,7 +39,8 @@ Reader::Reader(std::shared_ptr<Logger> info_log,
       last_record_offset_(0),
       end_of_buffer_offset_(0),
       log_number_(log_num),
-      recycled_(false) {}
+      recycled_(false),
+      compression_type_(kNoCompression) {}
 
 Reader::~Reader() {
   delete[] backing_store_;
@@ -79,6 +81,9 @@ bool Reader::ReadRecord(Slice* record, std::string* scratch,
         scratch->clear();
         *record = fragment;
         last_record_offset_ = prospective_record_offset;
+        if (!MaybeUncompress(record)) {
+          break;
+        }
         return true;
 
       case kFirstType:
@@ -114,10 +119,23 @@ bool Reader::ReadRecord(Slice* record, std::string* scratch,
           scratch->append(fragment.data(), fragment.size());
           *record = Slice(*scratch);
           last_record_offset_ = prospective_record_offset;
+          in_fragmented_record = false;
+          if (!MaybeUncompress(record)) {
+            break;
+          }
           return true;
         }
         break;
 
+      case kSetCompressionType:
+        if (in_fragmented_record) {
+          ReportCorruption(scratch->size(), "partial record without end(3)");
+          in_fragmented_record = false;
+          scratch->clear();
+        }
+        InitCompression(fragment);
+        break;
+
       case kBadHeader:
         if (wal_recovery_mode == WALRecoveryMode::kAbsoluteConsistency ||
             wal_recovery_mode == WALRecoveryMode::kPointInTimeRecovery) {
@@ -227,6 +245,33 @@ bool Reader::ReadRecord(Slice* record, std::string* scratch,
   return false;
 }
 
+void Reader::InitCompression(const Slice& payload) {
+  if (compression_type_ != kNoCompression || payload.size() != 1) {
+    ReportCorruption(payload.size(), "unexpected compression type record");
+    return;
+  }
+  compression_type_ = static_cast<CompressionType>(payload[0]);
+  uncompress_ = StreamingUncompress::Create(compression_type_);
+}
+
+bool Reader::MaybeUncompress(Slice* record) {
+  if (compression_type_ == kNoCompression) {
+    return true;
+  }
+  if (uncompress_ == nullptr) {
+    ReportDrop(record->size(), Status::NotSupported(
+                                   "Unsupported WAL compression type",
+                                   CompressionTypeToString(compression_type_)));
+    return false;
+  }
+  if (!uncompress_->Uncompress(*record, &uncompressed_record_)) {
+    ReportCorruption(record->size(), "failed to uncompress record");
+    return false;
+  }
+  *record = Slice(uncompressed_record_);
+  return true;
+}
+
 uint64_t Reader::LastRecordOffset() {
   return last_record_offset_;
 }
@@ -450,6 +495,9 @@ bool FragmentBufferedReader::ReadRecord(Slice* record, std::string* scratch,
         prospective_record_offset = physical_record_offset;
         last_record_offset_ = prospective_record_offset;
         in_fragmented_record_ = false;
+        if (!MaybeUncompress(record)) {
+          break;
+        }
         return true;
 
       case kFirstType:
@@ -484,10 +532,22 @@ bool FragmentBufferedReader::ReadRecord(Slice* record, std::string* scratch,
           *record = Slice(*scratch);
           last_record_offset_ = prospective_record_offset;
           in_fragmented_record_ = false;
+          if (!MaybeUncompress(record)) {
+            break;
+          }
           return true;
         }
         break;
 
+      case kSetCompressionType:
+        if (in_fragmented_record_) {
+          ReportCorruption(fragments_.size(), "partial record without end(3)");
+          in_fragmented_record_ = false;
+          fragments_.clear();
+        }
+        InitCompression(fragment);
+        break;
+
       case kBadHeader:
       case kBadRecord:
       case kEof:
@@ -19,6 +19,7 @@
 
 namespace ROCKSDB_NAMESPACE {
 class Logger;
+class StreamingUncompress;
 
 namespace log {
 
@@ -128,6 +129,12 @@ class Reader {
   // Whether this is a recycled log file
   bool recycled_;
 
+  // Set by the kSetCompressionType record of a compressed log file.
+  CompressionType compression_type_;
+  std::unique_ptr<StreamingUncompress> uncompress_;
+  // Storage for the uncompressed records returned by ReadRecord().
+  std::string uncompressed_record_;
+
   // Extend record types with the following special values
   enum {
     kEof = kMaxRecordType + 1,
@@ -154,6 +161,14 @@ class Reader {
 
   void UnmarkEOFInternal();
 
+  // Sets up uncompression from the payload of a kSetCompressionType record.
+  void InitCompression(const Slice& payload);
+
+  // If the log file is compressed, points `*record` to the uncompressed
+  // logical record. Returns false after reporting a corruption if it cannot
+  // be uncompressed.
+  bool MaybeUncompress(Slice* record);
+
   // Reports dropped bytes to the reporter.
   // buffer_ must be updated to remove the dropped bytes prior to invocation.
   void ReportCorruption(size_t bytes, const char* reason);
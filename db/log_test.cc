@@ -15,6 +15,7 @@
 #include "test_util/testharness.h"
 #include "test_util/testutil.h"
 #include "util/coding.h"
+#include "util/compression.h"
 #include "util/crc32c.h"
 #include "util/random.h"
 
@@ -175,10 +176,27 @@ class LogTest : public ::testing::TestWithParam<std::tuple<int, bool>> {
 
   Slice* get_reader_contents() { return &reader_contents_; }
 
+  // Replaces the writer by one compressing with `compression_type`. Must be
+  // called before anything is written.
+  void UseCompression(CompressionType compression_type) {
+    sink_ = new test::StringSink(&reader_contents_);
+    std::unique_ptr<FSWritableFile> sink_holder(sink_);
+    std::unique_ptr<WritableFileWriter> file_writer(new WritableFileWriter(
+        std::move(sink_holder), "" /* don't care */, FileOptions()));
+    writer_.reset(new Writer(std::move(file_writer), 123,
+                             std::get<0>(GetParam()), false /* manual_flush */,
+                             compression_type));
+    ASSERT_OK(writer_->AddCompressionTypeRecord());
+  }
+
   void Write(const std::string& msg) {
     ASSERT_OK(writer_->AddRecord(Slice(msg)));
   }
 
+  void WriteParts(const Slice* parts, int num_parts) {
+    ASSERT_OK(writer_->AddRecord(SliceParts(parts, num_parts)));
+  }
+
   size_t WrittenBytes() const {
     return dest_contents().size();
   }
@@ -285,6 +303,23 @@ TEST_P(LogTest, Fragmentation) {
   ASSERT_EQ("EOF", Read());
 }
 
+TEST_P(LogTest, GatheredParts) {
+  // A record is written as the concatenation of its parts, also when its
+  // fragments start or end inside a part and when some parts are empty.
+  const std::string head = BigString("head", 100);
+  const std::string body = BigString("body", 3 * kBlockSize);
+  const Slice parts[3] = {Slice(head), Slice(), Slice(body)};
+  WriteParts(parts, 3);
+  WriteParts(parts, 2);
+  WriteParts(parts + 1, 1);
+  Write("small");
+  ASSERT_EQ(head + body, Read());
+  ASSERT_EQ(head, Read());
+  ASSERT_EQ("", Read());
+  ASSERT_EQ("small", Read());
+  ASSERT_EQ("EOF", Read());
+}
+
 TEST_P(LogTest, MarginalTrailer) {
   // Make a trailer that is exactly the same length as an empty record.
   int header_size =
@@ -676,6 +711,57 @@ TEST_P(LogTest, Recycle) {
   ASSERT_EQ("EOF", Read());
 }
 
+TEST_P(LogTest, CompressedReadWrite) {
+  if (std::get<0>(GetParam()) != 0 ||
+      !StreamingCompressionTypeSupported(kZSTD)) {
+    ROCKSDB_GTEST_SKIP("Needs ZSTD streaming and a non-recycled log");
+    return;
+  }
+  UseCompression(kZSTD);
+  Write("foo");
+  Write("");
+  Write(BigString("bar", 100000));
+  const Slice parts[2] = {"ba", "z"};
+  WriteParts(parts, 2);
+  size_t raw_bytes = 0;
+  for (int i = 0; i < 1000; i++) {
+    std::string record = "{\"key\": " + NumberString(i) + ", \"value\": \"" +
+                         BigString("payload", 1000) + "\"}";
+    raw_bytes += record.size();
+    Write(record);
+  }
+  // Records are compressed with the previous ones as history.
+  ASSERT_LT(WrittenBytes(), raw_bytes / 10);
+
+  ASSERT_EQ("foo", Read());
+  ASSERT_EQ("", Read());
+  ASSERT_EQ(BigString("bar", 100000), Read());
+  ASSERT_EQ("baz", Read());
+  for (int i = 0; i < 1000; i++) {
+    ASSERT_EQ("{\"key\": " + NumberString(i) + ", \"value\": \"" +
+                  BigString("payload", 1000) + "\"}",
+              Read());
+  }
+  ASSERT_EQ("EOF", Read());
+  ASSERT_EQ(0U, DroppedBytes());
+}
+
+TEST_P(LogTest, CompressedChecksumMismatch) {
+  if (std::get<0>(GetParam()) != 0 ||
+      !StreamingCompressionTypeSupported(kZSTD)) {
+    ROCKSDB_GTEST_SKIP("Needs ZSTD streaming and a non-recycled log");
+    return;
+  }
+  UseCompression(kZSTD);
+  Write("foooooo");
+  Write("bar");
+  // Corrupt the payload of the first record after the compression type
+  // record.
+  IncrementByte(kHeaderSize + 1 + kHeaderSize, 10);
+  ASSERT_EQ("EOF", Read());
+  ASSERT_EQ("OK", MatchError("checksum mismatch"));
+}
+
 INSTANTIATE_TEST_CASE_P(bool, LogTest,
                         ::testing::Values(std::make_tuple(0, false),
                                           std::make_tuple(0, true),
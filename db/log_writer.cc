@@ -10,25 +10,36 @@
 #include "db/log_writer.h"
 
 #include <stdint.h>
+
+#include <algorithm>
+
 #include "file/writable_file_writer.h"
 #include "rocksdb/env.h"
 #include "util/coding.h"
+#include "util/compression.h"
 #include "util/crc32c.h"
 
 namespace ROCKSDB_NAMESPACE {
 namespace log {
 
 Writer::Writer(std::unique_ptr<WritableFileWriter>&& dest, uint64_t log_number,
-               bool recycle_log_files, bool manual_flush)
+               bool recycle_log_files, bool manual_flush,
+               CompressionType compression_type)
     : dest_(std::move(dest)),
       block_offset_(0),
       log_number_(log_number),
       recycle_log_files_(recycle_log_files),
-      manual_flush_(manual_flush) {
+      manual_flush_(manual_flush),
+      compression_type_(compression_type) {
   for (int i = 0; i <= kMaxRecordType; i++) {
     char t = static_cast<char>(i);
     type_crc_[i] = crc32c::Value(&t, 1);
   }
+  if (compression_type_ != kNoCompression) {
+    compress_ = StreamingCompress::Create(compression_type_);
+    assert(compress_ != nullptr);
+    assert(!recycle_log_files_);
+  }
 }
 
 Writer::~Writer() {
@@ -48,9 +59,45 @@ IOStatus Writer::Close() {
   return s;
 }
 
+IOStatus Writer::AddCompressionTypeRecord() {
+  if (compress_ == nullptr) {
+    return IOStatus::OK();
+  }
+  // Must be the first record, so it always fits in the first block.
+  assert(block_offset_ == 0);
+  const char type = static_cast<char>(compression_type_);
+  const Slice payload(&type, 1);
+  IOStatus s = EmitPhysicalRecord(kSetCompressionType, &payload, 1, 1);
+  if (s.ok() && !manual_flush_) {
+    s = dest_->Flush();
+  }
+  return s;
+}
+
 IOStatus Writer::AddRecord(const Slice& slice) {
-  const char* ptr = slice.data();
-  size_t left = slice.size();
+  return AddRecord(SliceParts(&slice, 1));
+}
+
+IOStatus Writer::AddRecord(const SliceParts& parts) {
+  const Slice* part = parts.parts;
+  size_t left = 0;
+  for (int i = 0; i < parts.num_parts; i++) {
+    left += parts.parts[i].size();
+  }
+  Slice compressed;
+  if (compress_ != nullptr) {
+    compressed_record_.clear();
+    for (int i = 0; i < parts.num_parts; i++) {
+      if (!compress_->Compress(parts.parts[i], &compressed_record_)) {
+        return IOStatus::Corruption("Failed to compress WAL record");
+      }
+    }
+    compressed = Slice(compressed_record_);
+    part = &compressed;
+    left = compressed.size();
+  }
+  // Offset of the next byte to write in *part
+  size_t part_offset = 0;
 
   // Header size varies depending on whether we are recycling or not.
   const int header_size =
@@ -97,8 +144,20 @@ IOStatus Writer::AddRecord(const Slice& slice) {
       type = recycle_log_files_ ? kRecyclableMiddleType : kMiddleType;
     }
 
-    s = EmitPhysicalRecord(type, ptr, fragment_length);
-    ptr += fragment_length;
+    // Gather the pieces of the parts that make up the fragment
+    fragment_.clear();
+    for (size_t needed = fragment_length; needed > 0;) {
+      while (part_offset == part->size()) {
+        part++;
+        part_offset = 0;
+      }
+      const size_t n = std::min(needed, part->size() - part_offset);
+      fragment_.emplace_back(part->data() + part_offset, n);
+      part_offset += n;
+      needed -= n;
+    }
+    s = EmitPhysicalRecord(type, fragment_.data(), fragment_.size(),
+                           fragment_length);
     left -= fragment_length;
     begin = false;
   } while (s.ok() && left > 0);
@@ -114,7 +173,8 @@ IOStatus Writer::AddRecord(const Slice& slice) {
 
 bool Writer::TEST_BufferIsEmpty() { return dest_->TEST_BufferIsEmpty(); }
 
-IOStatus Writer::EmitPhysicalRecord(RecordType t, const char* ptr, size_t n) {
+IOStatus Writer::EmitPhysicalRecord(RecordType t, const Slice* pieces,
+                                    size_t num_pieces, size_t n) {
   assert(n <= 0xffff);  // Must fit in two bytes
 
   size_t header_size;
@@ -126,7 +186,7 @@ IOStatus Writer::EmitPhysicalRecord(RecordType t, const char* ptr, size_t n) {
   buf[6] = static_cast<char>(t);
 
   uint32_t crc = type_crc_[t];
-  if (t < kRecyclableFullType) {
+  if (t < kRecyclableFullType || t > kRecyclableLastType) {
     // Legacy record format
     assert(block_offset_ + kHeaderSize + n <= kBlockSize);
     header_size = kHeaderSize;
@@ -145,7 +205,9 @@ IOStatus Writer::EmitPhysicalRecord(RecordType t, const char* ptr, size_t n) {
   }
 
   // Compute the crc of the record type and the payload.
-  crc = crc32c::Extend(crc, ptr, n);
+  for (size_t i = 0; i < num_pieces; i++) {
+    crc = crc32c::Extend(crc, pieces[i].data(), pieces[i].size());
+  }
   crc = crc32c::Mask(crc);  // Adjust for storage
   TEST_SYNC_POINT_CALLBACK("LogWriter::EmitPhysicalRecord:BeforeEncodeChecksum",
                            &crc);
@@ -153,8 +215,8 @@ IOStatus Writer::EmitPhysicalRecord(RecordType t, const char* ptr, size_t n) {
 
   // Write the header and the payload
   IOStatus s = dest_->Append(Slice(buf, header_size));
-  if (s.ok()) {
-    s = dest_->Append(Slice(ptr, n));
+  for (size_t i = 0; s.ok() && i < num_pieces; i++) {
+    s = dest_->Append(pieces[i]);
   }
   block_offset_ += header_size + n;
   return s;
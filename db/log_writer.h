@@ -10,14 +10,18 @@
 
 #include <cstdint>
 #include <memory>
+#include <string>
+#include <vector>
 
 #include "db/log_format.h"
+#include "rocksdb/compression_type.h"
 #include "rocksdb/io_status.h"
 #include "rocksdb/slice.h"
 #include "rocksdb/status.h"
 
 namespace ROCKSDB_NAMESPACE {
 
+class StreamingCompress;
 class WritableFileWriter;
 
 namespace log {
@@ -64,6 +68,13 @@ namespace log {
  * Same as above, with the addition of
  * Log number = 32bit log file number, so that we can distinguish between
  * records written by the most recent log writer vs a previous one.
+ *
+ * Compressed log files start with a kSetCompressionType record whose 1 byte
+ * payload is the CompressionType. The payloads of all the following logical
+ * records are then the outputs of one StreamingCompress, so each record is
+ * compressed with the previous records of the file as history, and the
+ * records can only be uncompressed in order from the start of the file.
+ * Recycled log files are never compressed.
  */
 class Writer {
  public:
@@ -72,7 +83,8 @@ class Writer {
   // "*dest" must remain live while this Writer is in use.
   explicit Writer(std::unique_ptr<WritableFileWriter>&& dest,
                   uint64_t log_number, bool recycle_log_files,
-                  bool manual_flush = false);
+                  bool manual_flush = false,
+                  CompressionType compression_type = kNoCompression);
   // No copying allowed
   Writer(const Writer&) = delete;
   void operator=(const Writer&) = delete;
@@ -80,6 +92,15 @@ class Writer {
   ~Writer();
 
   IOStatus AddRecord(const Slice& slice);
+  // Adds a record made of the concatenation of the parts, which are written
+  // out one after the other rather than copied into one buffer first.
+  IOStatus AddRecord(const SliceParts& parts);
+
+  // Writes the kSetCompressionType record if the writer compresses. Must be
+  // called before the first AddRecord().
+  IOStatus AddCompressionTypeRecord();
+
+  CompressionType compression_type() const { return compression_type_; }
 
   WritableFileWriter* file() { return dest_.get(); }
   const WritableFileWriter* file() const { return dest_.get(); }
@@ -103,11 +124,21 @@ class Writer {
   // record type stored in the header.
   uint32_t type_crc_[kMaxRecordType + 1];
 
-  IOStatus EmitPhysicalRecord(RecordType type, const char* ptr, size_t length);
+  // Emits a physical record whose payload is the concatenation of the
+  // `num_pieces` slices starting at `pieces`, `length` bytes in total.
+  IOStatus EmitPhysicalRecord(RecordType type, const Slice* pieces,
+                              size_t num_pieces, size_t length);
 
   // If true, it does not flush after each write. Instead it relies on the upper
   // layer to manually does the flush by calling ::WriteBuffer()
   bool manual_flush_;
+
+  CompressionType compression_type_;
+  std::unique_ptr<StreamingCompress> compress_;
+  // Buffer for the compressed payload of the current record.
+  std::string compressed_record_;
+  // Pieces of the record parts making up the current fragment.
+  std::vector<Slice> fragment_;
 };
 
 }  // namespace log
@@ -23,6 +23,7 @@
 #include "db/read_callback.h"
 #include "memory/arena.h"
 #include "memory/memory_usage.h"
+#include "monitoring/flow_trace.h"
 #include "monitoring/perf_context_imp.h"
 #include "monitoring/statistics.h"
 #include "port/lang.h"
@@ -40,9 +41,6 @@
 #include "util/coding.h"
 #include "util/mutexlock.h"
 
-// Control Print Flow - Signal.Jin
-int mem_get_flag = 1;
-
 namespace ROCKSDB_NAMESPACE {
 
 ImmutableMemTableOptions::ImmutableMemTableOptions(
@@ -82,7 +80,9 @@ MemTable::MemTable(const InternalKeyComparator& cmp,
                write_buffer_manager->cost_to_cache()))
                  ? &mem_tracker_
                  : nullptr,
-             mutable_cf_options.memtable_huge_page_size),
+             mutable_cf_options.memtable_huge_page_size,
+             mutable_cf_options.memtable_transparent_huge_pages,
+             mutable_cf_options.memtable_numa_aware),
       table_(ioptions.memtable_factory->CreateMemTableRep(
           comparator_, &arena_, mutable_cf_options.prefix_extractor.get(),
           ioptions.logger, column_family_id)),
@@ -151,6 +151,18 @@ size_t MemTable::ApproximateMemoryUsage() {
   return total_usage;
 }
 
+void MemTable::ApproximateMemoryUsageByNumaNode(
+    std::vector<size_t>* usage) const {
+  std::vector<size_t> arena_usage;
+  arena_.ApproximateMemoryUsageByNumaNode(&arena_usage);
+  if (usage->size() < arena_usage.size()) {
+    usage->resize(arena_usage.size(), 0);
+  }
+  for (size_t node = 0; node < arena_usage.size(); ++node) {
+    (*usage)[node] += arena_usage[node];
+  }
+}
+
 bool MemTable::ShouldFlushNow() {
   size_t write_buffer_size = write_buffer_size_.load(std::memory_order_relaxed);
   // In a lot of times, we cannot allocate arena blocks that exactly matches the
@@ -266,6 +278,20 @@ Slice MemTableRep::UserKey(const char* key) const {
   return Slice(slice.data(), slice.size() - 8);
 }
 
+uint64_t MemTableRep::KeyComparator::KeyPrefix(
+    const char* prefix_len_key) const {
+  Slice user_key = ExtractUserKey(GetLengthPrefixedSlice(prefix_len_key));
+  if (user_key.size() >= sizeof(uint64_t)) {
+    return EndianSwapValue(DecodeFixed64(user_key.data()));
+  }
+  uint64_t prefix = 0;
+  for (size_t i = 0; i < user_key.size(); i++) {
+    prefix |= static_cast<uint64_t>(static_cast<uint8_t>(user_key[i]))
+              << (56 - 8 * i);
+  }
+  return prefix;
+}
+
 KeyHandle MemTableRep::Allocate(const size_t len, char** buf) {
   *buf = allocator_->Allocate(len);
   return static_cast<KeyHandle>(*buf);
@@ -490,6 +516,15 @@ MemTable::MemTableStats MemTable::ApproximateStats(const Slice& start_ikey,
   return {entry_count * (data_size / n), entry_count};
 }
 
+void MemTable::SampleUserKeys(size_t target,
+                              std::vector<Slice>* user_keys) const {
+  std::vector<const char*> entries;
+  table_->SampleEntries(target, &entries);
+  for (const char* entry : entries) {
+    user_keys->push_back(ExtractUserKey(GetLengthPrefixedSlice(entry)));
+  }
+}
+
 Status MemTable::VerifyEncodedEntry(Slice encoded,
                                     const ProtectionInfoKVOTS64& kv_prot_info) {
   uint32_t ikey_len = 0;
@@ -883,10 +918,7 @@ bool MemTable::Get(const LookupKey& key, std::string* value,
                    ReadCallback* callback, bool* is_blob_index, bool do_merge) {
   // The sequence number is updated synchronously in version_set.h
 
-  if (DB_READ_FLOW == 1 && mem_get_flag == 1) {
-    fprintf(stdout, "  [4]        \t|    Get() /*Memtable*     \t\t| memtable.cc (line 876)\n"); // Signal.Jin
-    mem_get_flag = 0;
-  }
+  FLOW_TRACE_SCOPE(kFlowTraceRead, "MemTable::Get");
 
   if (IsEmpty()) {
     // Avoiding recording stats for speed.
@@ -1276,4 +1308,34 @@ uint64_t MemTable::GetMinLogContainingPrepSection() {
   return min_prep_log_referenced_.load();
 }
 
+void MemTable::InheritFrom(const autovector<MemTable*>& mems) {
+  assert(IsEmpty());
+  assert(!mems.empty());
+  id_ = mems.front()->GetID();
+  creation_seq_ = mems.front()->GetCreationSeq();
+  mem_next_logfile_number_ = mems.back()->GetNextLogNumber();
+  for (MemTable* m : mems) {
+    inherited_data_size_ += m->GetWrittenDataSize();
+    SequenceNumber first_seqno = m->GetFirstSequenceNumber();
+    if (first_seqno != 0 &&
+        (first_seqno_ == 0 || first_seqno < first_seqno_)) {
+      first_seqno_.store(first_seqno, std::memory_order_relaxed);
+    }
+    if (m->GetEarliestSequenceNumber() < earliest_seqno_) {
+      earliest_seqno_.store(m->GetEarliestSequenceNumber(),
+                            std::memory_order_relaxed);
+    }
+    if (m->ApproximateOldestKeyTime() < oldest_key_time_) {
+      oldest_key_time_.store(m->ApproximateOldestKeyTime(),
+                             std::memory_order_relaxed);
+    }
+    uint64_t log = m->GetMinLogContainingPrepSection();
+    if (log > 0) {
+      RefLogContainingPrepSection(log);
+    }
+  }
+  assert(first_seqno_.load() == 0 ||
+         first_seqno_.load() >= earliest_seqno_.load());
+}
+
 }  // namespace ROCKSDB_NAMESPACE
@@ -28,6 +28,7 @@
 #include "rocksdb/db.h"
 #include "rocksdb/memtablerep.h"
 #include "table/multiget_context.h"
+#include "util/autovector.h"
 #include "util/dynamic_bloom.h"
 #include "util/hash.h"
 
@@ -145,6 +146,11 @@ class MemTable {
     return approximate_memory_usage_.load(std::memory_order_relaxed);
   }
 
+  // Adds to (*usage)[n] the approximate memory usage of the arena blocks
+  // that prefer NUMA node n, growing *usage as needed. Adds nothing unless
+  // memtable_numa_aware took effect for this memtable.
+  void ApproximateMemoryUsageByNumaNode(std::vector<size_t>* usage) const;
+
   // This method heuristically determines if the memtable should continue to
   // host more data.
   bool ShouldScheduleFlush() const {
@@ -313,6 +319,12 @@ class MemTable {
     return data_size_.load(std::memory_order_relaxed);
   }
 
+  // Returns the size of the data written to this memtable or, if it was
+  // produced by in-memory compaction, to the memtables compacted into it.
+  uint64_t GetWrittenDataSize() const {
+    return inherited_data_size_ > 0 ? inherited_data_size_ : get_data_size();
+  }
+
   // Dynamically change the memtable's capacity. If set below the current usage,
   // the next key added will trigger a flush. Can only increase size when
   // memtable prefix bloom is disabled, since we can't easily allocate more
@@ -414,6 +426,12 @@ class MemTable {
   MemTableStats ApproximateStats(const Slice& start_ikey,
                                  const Slice& end_ikey);
 
+  // Appends to *user_keys, in order, the user keys of up to about `target`
+  // entries spread over the memtable. The slices point into the memtable.
+  // Appends nothing if the MemTableRep does not support sampling.
+  // REQUIRES: the memtable is immutable.
+  void SampleUserKeys(size_t target, std::vector<Slice>* user_keys) const;
+
   // Get the lock associated for the key
   port::RWMutex* GetLock(const Slice& key);
 
@@ -434,6 +452,14 @@ class MemTable {
 
   uint64_t GetID() const { return id_; }
 
+  // Takes over the ID, sequence numbers, oldest key time and referenced logs
+  // of `mems`, ordered from oldest to newest, whose entries are about to be
+  // compacted into this memtable. Entries may then be added in any sequence
+  // number order.
+  // REQUIRES: db_mutex held, this memtable is empty and not yet visible to
+  // readers.
+  void InheritFrom(const autovector<MemTable*>& mems);
+
   void SetFlushCompleted(bool completed) { flush_completed_ = completed; }
 
   uint64_t GetFileNumber() const { return file_number_; }
@@ -445,12 +471,19 @@ class MemTable {
   }
 
 #ifndef ROCKSDB_LITE
-  void SetFlushJobInfo(std::unique_ptr<FlushJobInfo>&& info) {
-    flush_job_info_ = std::move(info);
+  // One FlushJobInfo per output file of the flush.
+  void AddFlushJobInfo(std::unique_ptr<FlushJobInfo>&& info) {
+    flush_job_infos_.push_back(std::move(info));
   }
 
-  std::unique_ptr<FlushJobInfo> ReleaseFlushJobInfo() {
-    return std::move(flush_job_info_);
+  // Drops the infos of a flush that is rolled back, so that they are not
+  // reported by a later attempt.
+  void ClearFlushJobInfos() { flush_job_infos_.clear(); }
+
+  std::vector<std::unique_ptr<FlushJobInfo>> ReleaseFlushJobInfos() {
+    std::vector<std::unique_ptr<FlushJobInfo>> infos;
+    infos.swap(flush_job_infos_);
+    return infos;
   }
 #endif  // !ROCKSDB_LITE
 
@@ -526,6 +559,9 @@ class MemTable {
   // Memtable id to track flush.
   uint64_t id_ = 0;
 
+  // Set by InheritFrom().
+  uint64_t inherited_data_size_ = 0;
+
   // Sequence number of the atomic flush that is responsible for this memtable.
   // The sequence number of atomic flush is a seq, such that no writes with
   // sequence numbers greater than or equal to seq are flushed, while all
@@ -538,7 +574,7 @@ class MemTable {
 
 #ifndef ROCKSDB_LITE
   // Flush job info of the current memtable.
-  std::unique_ptr<FlushJobInfo> flush_job_info_;
+  std::vector<std::unique_ptr<FlushJobInfo>> flush_job_infos_;
 #endif  // !ROCKSDB_LITE
 
   // Returns a heuristic flush decision
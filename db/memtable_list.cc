@@ -5,6 +5,7 @@
 //
 #include "db/memtable_list.h"
 
+#include <algorithm>
 #include <cinttypes>
 #include <limits>
 #include <queue>
@@ -14,6 +15,7 @@
 #include "db/range_tombstone_fragmenter.h"
 #include "db/version_set.h"
 #include "logging/log_buffer.h"
+#include "monitoring/flow_trace.h"
 #include "monitoring/thread_status_util.h"
 #include "rocksdb/db.h"
 #include "rocksdb/env.h"
@@ -22,9 +24,6 @@
 #include "test_util/sync_point.h"
 #include "util/coding.h"
 
-// Control Print Flow - Signal.Jin
-int imm_get_flag = 1;
-
 namespace ROCKSDB_NAMESPACE {
 
 class InternalKeyComparator;
@@ -157,10 +156,7 @@ bool MemTableListVersion::GetFromList(
     const ReadOptions& read_opts, ReadCallback* callback, bool* is_blob_index) {
   *seq = kMaxSequenceNumber;
 
-  if (DB_READ_FLOW == 1 && imm_get_flag == 1) {
-    fprintf(stdout, "  [5]        \t|    GetFromList()/*Immutable memtable*/| memtable_list.cc (line 160)\n"); // Signal.Jin
-    imm_get_flag = 0;
-  }
+  FLOW_TRACE_SCOPE(kFlowTraceRead, "MemTableListVersion::GetFromList");
 
   for (auto& memtable : *list) {
     SequenceNumber current_seq = kMaxSequenceNumber;
@@ -288,6 +284,26 @@ void MemTableListVersion::Remove(MemTable* m,
   }
 }
 
+// Replaces the adjacent memtables in mems with m. Unlike Remove(), the
+// replaced memtables are not kept in the history since m holds their data.
+// Caller should NOT Unref the memtables in mems, and is responsible for
+// referencing m.
+void MemTableListVersion::Replace(const autovector<MemTable*>& mems,
+                                  MemTable* m,
+                                  autovector<MemTable*>* to_delete) {
+  assert(refs_ == 1);  // only when refs_ == 1 is MemTableListVersion mutable
+  assert(!mems.empty());
+  // memlist_ is ordered from newest to oldest, mems from oldest to newest.
+  auto pos = std::find(memlist_.begin(), memlist_.end(), mems.back());
+  assert(pos != memlist_.end());
+  memlist_.insert(pos, m);
+  *parent_memtable_list_memory_usage_ += m->ApproximateMemoryUsage();
+  for (MemTable* old : mems) {
+    memlist_.remove(old);
+    UnrefMemTable(to_delete, old);
+  }
+}
+
 // return the total memory usage assuming the oldest flushed memtable is dropped
 size_t MemTableListVersion::ApproximateMemoryUsageExcludingLast() const {
   size_t total_memtable_size = 0;
@@ -373,6 +389,17 @@ void MemTableList::PickMemtablesToFlush(uint64_t max_memtable_id,
   }
 }
 
+void MemTableList::InstallInMemoryCompactionResult(
+    const autovector<MemTable*>& mems, MemTable* compacted,
+    autovector<MemTable*>* to_delete) {
+  assert(!mems.empty());
+  InstallNewVersion();
+  compacted->MarkImmutable();
+  compacted->flush_in_progress_ = true;
+  current_->Replace(mems, compacted, to_delete);
+  UpdateCachedValuesFromMemTableListVersion();
+}
+
 void MemTableList::RollbackMemtableFlush(const autovector<MemTable*>& mems,
                                          uint64_t /*file_number*/) {
   AutoThreadOperationStageUpdater stage_updater(
@@ -388,6 +415,9 @@ void MemTableList::RollbackMemtableFlush(const autovector<MemTable*>& mems,
     m->flush_in_progress_ = false;
     m->flush_completed_ = false;
     m->edit_.Clear();
+#ifndef ROCKSDB_LITE
+    m->ClearFlushJobInfos();
+#endif  // !ROCKSDB_LITE
     num_flush_not_started_++;
   }
   imm_flush_needed.store(true, std::memory_order_release);
@@ -470,8 +500,7 @@ Status MemTableList::TryInstallMemtableFlushResults(
         edit_list.push_back(&m->edit_);
         memtables_to_flush.push_back(m);
 #ifndef ROCKSDB_LITE
-        std::unique_ptr<FlushJobInfo> info = m->ReleaseFlushJobInfo();
-        if (info != nullptr) {
+        for (auto& info : m->ReleaseFlushJobInfos()) {
           committed_flush_jobs_info->push_back(std::move(info));
         }
 #else
@@ -561,6 +590,13 @@ size_t MemTableList::ApproximateUnflushedMemTablesMemoryUsage() {
   return total_size;
 }
 
+void MemTableList::ApproximateUnflushedMemTablesMemoryUsageByNumaNode(
+    std::vector<size_t>* usage) const {
+  for (auto& memtable : current_->memlist_) {
+    memtable->ApproximateMemoryUsageByNumaNode(usage);
+  }
+}
+
 size_t MemTableList::ApproximateMemoryUsage() { return current_memory_usage_; }
 
 size_t MemTableList::ApproximateMemoryUsageExcludingLast() const {
@@ -676,6 +712,9 @@ void MemTableList::RemoveMemTablesOrRestoreFlags(
       m->flush_completed_ = false;
       m->flush_in_progress_ = false;
       m->edit_.Clear();
+#ifndef ROCKSDB_LITE
+      m->ClearFlushJobInfos();
+#endif  // !ROCKSDB_LITE
       num_flush_not_started_++;
       m->file_number_ = 0;
       imm_flush_needed.store(true, std::memory_order_release);
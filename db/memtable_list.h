@@ -147,6 +147,9 @@ class MemTableListVersion {
   void Add(MemTable* m, autovector<MemTable*>* to_delete);
   // REQUIRE: m is an immutable memtable
   void Remove(MemTable* m, autovector<MemTable*>* to_delete);
+  // REQUIRE: m and the memtables in mems are immutable memtables
+  void Replace(const autovector<MemTable*>& mems, MemTable* m,
+               autovector<MemTable*>* to_delete);
 
   // Return true if memtable is trimmed
   bool TrimHistory(autovector<MemTable*>* to_delete, size_t usage);
@@ -254,6 +257,15 @@ class MemTableList {
   void PickMemtablesToFlush(uint64_t max_memtable_id,
                             autovector<MemTable*>* mems);
 
+  // Replaces `mems`, adjacent memtables picked for flush and ordered from
+  // oldest to newest, with `compacted`, the result of compacting them in
+  // memory. `compacted` takes their place in the list and stays picked for
+  // flush; the caller either flushes it or calls RollbackMemtableFlush().
+  // Takes ownership of the reference held on *compacted by the caller.
+  void InstallInMemoryCompactionResult(const autovector<MemTable*>& mems,
+                                       MemTable* compacted,
+                                       autovector<MemTable*>* to_delete);
+
   // Reset status of the given memtable list back to pending state so that
   // they can get picked up again on the next round of flush.
   void RollbackMemtableFlush(const autovector<MemTable*>& mems,
@@ -300,6 +312,11 @@ class MemTableList {
   // the unflushed mem-tables.
   size_t ApproximateUnflushedMemTablesMemoryUsage();
 
+  // Adds to (*usage)[n] the memory usage of the unflushed memtables on NUMA
+  // node n, see MemTable::ApproximateMemoryUsageByNumaNode().
+  void ApproximateUnflushedMemTablesMemoryUsageByNumaNode(
+      std::vector<size_t>* usage) const;
+
   // Returns an estimate of the timestamp of the earliest key.
   uint64_t ApproximateOldestKeyTime() const;
 
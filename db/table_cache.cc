@@ -16,6 +16,7 @@
 #include "file/file_util.h"
 #include "file/filename.h"
 #include "file/random_access_file_reader.h"
+#include "monitoring/flow_trace.h"
 #include "monitoring/perf_context_imp.h"
 #include "rocksdb/statistics.h"
 #include "table/block_based/block_based_table_reader.h"
@@ -30,9 +31,6 @@
 #include "util/coding.h"
 #include "util/stop_watch.h"
 
-// Control Print Flow - Signal.Jin
-int cache_get_flag = 1;
-
 namespace ROCKSDB_NAMESPACE {
 
 namespace {
@@ -402,10 +400,7 @@ Status TableCache::Get(const ReadOptions& options,
   std::string* row_cache_entry = nullptr;
   bool done = false;
 
-  if (DB_READ_FLOW == 1 && cache_get_flag == 1) {
-    fprintf(stdout, "  [8]        \t|     Get() {    \t\t\t| table_cache.cc (line 403)\n"); // Signal.Jin
-    cache_get_flag = 0;
-  }
+  FLOW_TRACE_SCOPE(kFlowTraceRead, "TableCache::Get");
 
 #ifndef ROCKSDB_LITE
   IterKey row_cache_key;
@@ -613,6 +608,33 @@ Status TableCache::MultiGet(const ReadOptions& options,
   return s;
 }
 
+void TableCache::MultiGetPrefetch(
+    const ReadOptions& options,
+    const InternalKeyComparator& internal_comparator,
+    const FileMetaData& file_meta, const MultiGetContext::Range* mget_range,
+    const SliceTransform* prefix_extractor, HistogramImpl* file_read_hist,
+    bool skip_filters, int level) {
+  auto& fd = file_meta.fd;
+  TableReader* t = fd.table_reader;
+  Cache::Handle* handle = nullptr;
+  if (t == nullptr) {
+    Status s = FindTable(options, file_options_, internal_comparator, fd,
+                         &handle, prefix_extractor, false /* no_io */,
+                         true /* record_read_stats */, file_read_hist,
+                         skip_filters, level);
+    if (!s.ok()) {
+      // MultiGet() reports the error.
+      return;
+    }
+    t = GetTableReaderFromHandle(handle);
+    assert(t);
+  }
+  t->MultiGetPrefetch(options, mget_range, prefix_extractor, skip_filters);
+  if (handle != nullptr) {
+    ReleaseHandle(handle);
+  }
+}
+
 Status TableCache::GetTableProperties(
     const FileOptions& file_options,
     const InternalKeyComparator& internal_comparator, const FileDescriptor& fd,
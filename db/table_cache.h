@@ -122,6 +122,17 @@ class TableCache {
                   HistogramImpl* file_read_hist = nullptr,
                   bool skip_filters = false, int level = -1);
 
+  // Asks the table reader of the specified file to prefetch the data blocks
+  // that may contain the keys of `mget_range`, without waiting for them. See
+  // ReadOptions::optimize_multiget_for_io.
+  void MultiGetPrefetch(const ReadOptions& options,
+                        const InternalKeyComparator& internal_comparator,
+                        const FileMetaData& file_meta,
+                        const MultiGetContext::Range* mget_range,
+                        const SliceTransform* prefix_extractor = nullptr,
+                        HistogramImpl* file_read_hist = nullptr,
+                        bool skip_filters = false, int level = -1);
+
   // Evict any entry for the specified file number
   static void Evict(Cache* cache, uint64_t file_number);
 
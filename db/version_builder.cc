@@ -289,6 +289,10 @@ class VersionBuilder::Rep {
       UpdateExpectedLinkedSsts(level_files[0]->fd.GetNumber(),
                                level_files[0]->oldest_blob_file_number,
                                &expected_linked_ssts);
+      // The L0 sorted run ending at the file before level_files[i]: files
+      // [run_start, i) and their smallest sequence number.
+      size_t run_start = 0;
+      SequenceNumber run_smallest_seqno = level_files[0]->fd.smallest_seqno;
       for (size_t i = 1; i < level_files.size(); i++) {
         assert(level_files[i]);
         UpdateExpectedLinkedSsts(level_files[i]->fd.GetNumber(),
@@ -306,6 +310,28 @@ class VersionBuilder::Rep {
             return Status::Corruption("L0 files are not sorted properly");
           }
 
+          if (InSameL0SortedRun(f1, f2)) {
+            // The files of a partitioned flush have interleaving sequence
+            // numbers, so reads rely on their key ranges being disjoint.
+            const Comparator* ucmp =
+                vstorage->InternalComparator()->user_comparator();
+            for (size_t j = run_start; j < i; j++) {
+              auto f = level_files[j];
+              if (ucmp->Compare(f2->largest.user_key(),
+                                f->smallest.user_key()) >= 0 &&
+                  ucmp->Compare(f2->smallest.user_key(),
+                                f->largest.user_key()) <= 0) {
+                return Status::Corruption(
+                    "L0 files of the same flush overlap: file #" +
+                    NumberToString(f->fd.GetNumber()) + " vs. file #" +
+                    NumberToString(f2->fd.GetNumber()));
+              }
+            }
+            run_smallest_seqno =
+                std::min(run_smallest_seqno, f2->fd.smallest_seqno);
+            continue;
+          }
+
           if (f2->fd.smallest_seqno == f2->fd.largest_seqno) {
             // This is an external file that we ingested
             SequenceNumber external_file_seqno = f2->fd.smallest_seqno;
@@ -319,15 +345,17 @@ class VersionBuilder::Rep {
                   NumberToString(external_file_seqno) + " with fileNumber " +
                   NumberToString(f1->fd.GetNumber()));
             }
-          } else if (f1->fd.smallest_seqno <= f2->fd.smallest_seqno) {
+          } else if (run_smallest_seqno <= f2->fd.smallest_seqno) {
             return Status::Corruption(
-                "L0 files seqno " + NumberToString(f1->fd.smallest_seqno) +
+                "L0 files seqno " + NumberToString(run_smallest_seqno) +
                 " " + NumberToString(f1->fd.largest_seqno) + " " +
                 NumberToString(f1->fd.GetNumber()) + " vs. " +
                 NumberToString(f2->fd.smallest_seqno) + " " +
                 NumberToString(f2->fd.largest_seqno) + " " +
                 NumberToString(f2->fd.GetNumber()));
           }
+          run_start = i;
+          run_smallest_seqno = f2->fd.smallest_seqno;
         } else {
 #ifndef NDEBUG
           auto pair = std::make_pair(&f1, &f2);
@@ -1521,6 +1521,81 @@ TEST_F(VersionBuilderTest, CheckConsistencyForFileDeletedTwice) {
   UnrefFilesInVersion(&new_vstorage2);
 }
 
+TEST_F(VersionBuilderTest, CheckConsistencyForPartitionedFlush) {
+  // An older L0 file.
+  Add(0, 1U, "150", "350", 100U, 0, 10, 20, 0, 0, false, 10, 20);
+  UpdateVersionStorageInfo();
+
+  EnvOptions env_options;
+  constexpr TableCache* table_cache = nullptr;
+  constexpr VersionSet* version_set = nullptr;
+
+  // The files of a partitioned flush have interleaving sequence numbers but
+  // disjoint key ranges.
+  {
+    VersionEdit version_edit;
+    version_edit.AddFile(0, 10U, 0, 100U, GetInternalKey("100", 30),
+                         GetInternalKey("199", 60), 30, 60, false,
+                         kInvalidBlobFileNumber, kUnknownOldestAncesterTime,
+                         kUnknownFileCreationTime, kUnknownFileChecksum,
+                         kUnknownFileChecksumFuncName);
+    version_edit.AddFile(0, 11U, 0, 100U, GetInternalKey("200", 21),
+                         GetInternalKey("299", 58), 21, 58, false,
+                         kInvalidBlobFileNumber, kUnknownOldestAncesterTime,
+                         kUnknownFileCreationTime, kUnknownFileChecksum,
+                         kUnknownFileChecksumFuncName);
+    version_edit.AddFile(0, 12U, 0, 100U, GetInternalKey("300", 25),
+                         GetInternalKey("399", 59), 25, 59, false,
+                         kInvalidBlobFileNumber, kUnknownOldestAncesterTime,
+                         kUnknownFileCreationTime, kUnknownFileChecksum,
+                         kUnknownFileChecksumFuncName);
+
+    VersionBuilder version_builder(env_options, &ioptions_, table_cache,
+                                   &vstorage_, version_set);
+    VersionStorageInfo new_vstorage(&icmp_, ucmp_, options_.num_levels,
+                                    kCompactionStyleLevel, nullptr,
+                                    true /* force_consistency_checks */);
+    ASSERT_OK(version_builder.Apply(&version_edit));
+    ASSERT_OK(version_builder.SaveTo(&new_vstorage));
+    ASSERT_EQ(4U, new_vstorage.LevelFiles(0).size());
+
+    UnrefFilesInVersion(&new_vstorage);
+  }
+
+  // Files with interleaving sequence numbers must not overlap.
+  {
+    VersionEdit version_edit;
+    version_edit.AddFile(0, 10U, 0, 100U, GetInternalKey("100", 30),
+                         GetInternalKey("199", 60), 30, 60, false,
+                         kInvalidBlobFileNumber, kUnknownOldestAncesterTime,
+                         kUnknownFileCreationTime, kUnknownFileChecksum,
+                         kUnknownFileChecksumFuncName);
+    version_edit.AddFile(0, 11U, 0, 100U, GetInternalKey("200", 21),
+                         GetInternalKey("299", 58), 21, 58, false,
+                         kInvalidBlobFileNumber, kUnknownOldestAncesterTime,
+                         kUnknownFileCreationTime, kUnknownFileChecksum,
+                         kUnknownFileChecksumFuncName);
+    version_edit.AddFile(0, 12U, 0, 100U, GetInternalKey("150", 25),
+                         GetInternalKey("160", 59), 25, 59, false,
+                         kInvalidBlobFileNumber, kUnknownOldestAncesterTime,
+                         kUnknownFileCreationTime, kUnknownFileChecksum,
+                         kUnknownFileChecksumFuncName);
+
+    VersionBuilder version_builder(env_options, &ioptions_, table_cache,
+                                   &vstorage_, version_set);
+    VersionStorageInfo new_vstorage(&icmp_, ucmp_, options_.num_levels,
+                                    kCompactionStyleLevel, nullptr,
+                                    true /* force_consistency_checks */);
+    ASSERT_OK(version_builder.Apply(&version_edit));
+    const Status s = version_builder.SaveTo(&new_vstorage);
+    ASSERT_TRUE(s.IsCorruption());
+    ASSERT_TRUE(
+        std::strstr(s.getState(), "L0 files of the same flush overlap"));
+
+    UnrefFilesInVersion(&new_vstorage);
+  }
+}
+
 TEST_F(VersionBuilderTest, EstimatedActiveKeys) {
   const uint32_t kTotalSamples = 20;
   const uint32_t kNumLevels = 5;
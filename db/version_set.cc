@@ -40,6 +40,7 @@
 #include "file/read_write_util.h"
 #include "file/writable_file_writer.h"
 #include "monitoring/file_read_sample.h"
+#include "monitoring/flow_trace.h"
 #include "monitoring/perf_context_imp.h"
 #include "monitoring/persistent_stats_history.h"
 #include "options/options_helper.h"
@@ -62,9 +63,6 @@
 #include "util/string_util.h"
 #include "util/user_comparator_wrapper.h"
 
-// Control Print Flow - Signal.Jin
-int sst_get_flag = 1;
-
 namespace ROCKSDB_NAMESPACE {
 
 namespace {
@@ -162,10 +160,7 @@ class FilePicker {
 
   FdWithKeyRange* GetNextFile() {
 
-    if (DB_READ_FLOW == 1 && sst_get_flag == 1) {
-      fprintf(stdout, "  [7]        \t|     GetNextFile()     \t\t| version_set.cc (line 166)\n"); // Signal.Jin
-      sst_get_flag = 0;
-    }
+    FLOW_TRACE_SCOPE(kFlowTraceRead, "FilePicker::GetNextFile");
 
     while (!search_ended_) {  // Loops over different levels.
       while (curr_index_in_curr_level_ < curr_file_level_->num_files) {
@@ -848,6 +843,21 @@ static bool BeforeFile(const Comparator* ucmp,
                                         ExtractUserKey(f->smallest_key)) < 0);
 }
 
+bool InSameL0SortedRun(SequenceNumber newer_smallest_seqno,
+                       SequenceNumber newer_largest_seqno,
+                       SequenceNumber older_smallest_seqno,
+                       SequenceNumber older_largest_seqno) {
+  return newer_smallest_seqno < newer_largest_seqno &&
+         older_smallest_seqno < older_largest_seqno &&
+         older_largest_seqno > newer_smallest_seqno &&
+         newer_largest_seqno > older_smallest_seqno;
+}
+
+bool InSameL0SortedRun(const FileMetaData* newer, const FileMetaData* older) {
+  return InSameL0SortedRun(newer->fd.smallest_seqno, newer->fd.largest_seqno,
+                           older->fd.smallest_seqno, older->fd.largest_seqno);
+}
+
 bool SomeFileOverlapsRange(
     const InternalKeyComparator& icmp,
     bool disjoint_sorted_files,
@@ -1864,9 +1874,7 @@ void Version::Get(const ReadOptions& read_options, const LookupKey& k,
                   bool* key_exists, SequenceNumber* seq, ReadCallback* callback,
                   bool* is_blob, bool do_merge) {
 
-  if (DB_READ_FLOW == 1 && sst_get_flag == 1) {
-    fprintf(stdout, "  [6]        \t|    Get() { /*SSTable*/     \t\t| version_set.cc (line 1866)\n"); // Signal.Jin
-  }
+  FLOW_TRACE_SCOPE(kFlowTraceRead, "Version::Get");
 
   Slice ikey = k.internal_key();
   Slice user_key = k.user_key();
@@ -2088,6 +2096,11 @@ void Version::MultiGet(const ReadOptions& read_options, MultiGetRange* range,
     iter->get_context = &(get_ctx[get_ctx_index]);
   }
 
+  if (read_options.optimize_multiget_for_io &&
+      read_options.read_tier != kBlockCacheTier) {
+    MultiGetPrefetch(read_options, *range);
+  }
+
   MultiGetRange file_picker_range(*range, range->begin(), range->end());
   FilePickerMultiGet fp(
       &file_picker_range,
@@ -2293,6 +2306,25 @@ void Version::MultiGet(const ReadOptions& read_options, MultiGetRange* range,
   }
 }
 
+void Version::MultiGetPrefetch(const ReadOptions& read_options,
+                               const MultiGetRange& range) {
+  MultiGetRange prefetch_range(range, range.begin(), range.end());
+  FilePickerMultiGet fp(
+      &prefetch_range, &storage_info_.level_files_brief_,
+      storage_info_.num_non_empty_levels_, &storage_info_.file_indexer_,
+      user_comparator(), internal_comparator());
+  for (FdWithKeyRange* f = fp.GetNextFile(); f != nullptr;
+       f = fp.GetNextFile()) {
+    MultiGetRange file_range = fp.CurrentFileRange();
+    int level = static_cast<int>(fp.GetHitFileLevel());
+    table_cache_->MultiGetPrefetch(
+        read_options, *internal_comparator(), *f->file_metadata, &file_range,
+        mutable_cf_options_.prefix_extractor.get(),
+        cfd_->internal_stats()->GetFileReadHist(level),
+        IsFilterSkipped(level, fp.IsHitFileLastInLevel()), level);
+  }
+}
+
 bool Version::IsFilterSkipped(int level, bool is_file_last_in_level) {
   // Reaching the bottom level implies misses at all upper levels, so we'll
   // skip checking the filters when we predict a hit.
@@ -2605,10 +2637,15 @@ void VersionStorageInfo::ComputeCompactionScore(
       // overwrites/deletions).
       int num_sorted_runs = 0;
       uint64_t total_size = 0;
+      const FileMetaData* prev = nullptr;
       for (auto* f : files_[level]) {
         if (!f->being_compacted) {
           total_size += f->compensated_file_size;
-          num_sorted_runs++;
+          // The files of a partitioned flush form one sorted run.
+          if (prev == nullptr || !InSameL0SortedRun(prev, f)) {
+            num_sorted_runs++;
+          }
+          prev = f;
         }
       }
       if (compaction_style_ == kCompactionStyleUniversal) {
@@ -3436,7 +3473,12 @@ void VersionStorageInfo::CalculateBaseBytes(const ImmutableOptions& ioptions,
                                             const MutableCFOptions& options) {
   // Special logic to set number of sorted runs.
   // It is to match the previous behavior when all files are in L0.
-  int num_l0_count = static_cast<int>(files_[0].size());
+  int num_l0_count = 0;
+  for (size_t i = 0; i < files_[0].size(); i++) {
+    if (i == 0 || !InSameL0SortedRun(files_[0][i - 1], files_[0][i])) {
+      num_l0_count++;
+    }
+  }
   if (compaction_style_ == kCompactionStyleUniversal) {
     // For universal compaction, we use level0 score to indicate
     // compaction score for the whole DB. Adding other levels as if
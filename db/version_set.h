@@ -101,6 +101,19 @@ extern bool SomeFileOverlapsRange(const InternalKeyComparator& icmp,
                                   const Slice* smallest_user_key,
                                   const Slice* largest_user_key);
 
+// Returns true iff the sequence number ranges of L0 file `older`, which
+// follows `newer` in newest-first order, and of `newer` interleave, which
+// means they were written by the same partitioned flush (see
+// AdvancedColumnFamilyOptions::flush_partitions). The sequence number ranges
+// of other adjacent L0 files only overlap when one of them is an ingested
+// file, which covers a single sequence number.
+extern bool InSameL0SortedRun(const FileMetaData* newer,
+                              const FileMetaData* older);
+extern bool InSameL0SortedRun(SequenceNumber newer_smallest_seqno,
+                              SequenceNumber newer_largest_seqno,
+                              SequenceNumber older_smallest_seqno,
+                              SequenceNumber older_largest_seqno);
+
 // Generate LevelFilesBrief from vector<FdWithKeyRange*>
 // Would copy smallest_key and largest_key data to sequential memory
 // arena: Arena used to allocate the memory
@@ -814,6 +827,11 @@ class Version {
   // that it eventually expires from the cache.
   bool IsFilterSkipped(int level, bool is_file_last_in_level = false);
 
+  // Prefetches the data blocks of all the files, in all levels, that may
+  // contain keys of `range`. See ReadOptions::optimize_multiget_for_io.
+  void MultiGetPrefetch(const ReadOptions& read_options,
+                        const MultiGetRange& range);
+
   // The helper function of UpdateAccumulatedStats, which may fill the missing
   // fields of file_meta from its associated TableProperties.
   // Returns true if it does initialize FileMetaData.
@@ -32,6 +32,10 @@
 // varstring :=
 //    len: varint32
 //    data: uint8[len]
+//
+// A batch built by WriteBatchInternal::PutValueRef() holds a single
+// kTypeValue or kTypeColumnFamilyValue record whose varstring value stops
+// after its length: the value data is *value_ref_.
 
 #include "rocksdb/write_batch.h"
 
@@ -299,6 +303,7 @@ WriteBatch::WriteBatch(const WriteBatch& src)
     : wal_term_point_(src.wal_term_point_),
       content_flags_(src.content_flags_.load(std::memory_order_relaxed)),
       max_bytes_(src.max_bytes_),
+      value_ref_(src.value_ref_),
       rep_(src.rep_),
       timestamp_size_(src.timestamp_size_) {
   if (src.save_points_ != nullptr) {
@@ -317,6 +322,7 @@ WriteBatch::WriteBatch(WriteBatch&& src) noexcept
       content_flags_(src.content_flags_.load(std::memory_order_relaxed)),
       max_bytes_(src.max_bytes_),
       prot_info_(std::move(src.prot_info_)),
+      value_ref_(src.value_ref_),
       rep_(std::move(src.rep_)),
       timestamp_size_(src.timestamp_size_) {}
 
@@ -364,6 +370,7 @@ void WriteBatch::Clear() {
   if (prot_info_ != nullptr) {
     prot_info_->entries_.clear();
   }
+  value_ref_ = nullptr;
   wal_term_point_.clear();
 }
 
@@ -556,6 +563,9 @@ Status WriteBatch::Iterate(Handler* handler) const {
   if (rep_.size() < WriteBatchInternal::kHeader) {
     return Status::Corruption("malformed WriteBatch (too small)");
   }
+  if (value_ref_ != nullptr) {
+    return WriteBatchInternal::IterateValueRef(this, handler);
+  }
 
   return WriteBatchInternal::Iterate(this, handler, WriteBatchInternal::kHeader,
                                      rep_.size());
@@ -564,6 +574,8 @@ Status WriteBatch::Iterate(Handler* handler) const {
 Status WriteBatchInternal::Iterate(const WriteBatch* wb,
                                    WriteBatch::Handler* handler, size_t begin,
                                    size_t end) {
+  // Ranges of records are not supported for batches with a value reference.
+  assert(wb->value_ref_ == nullptr);
   if (begin > wb->rep_.size() || end > wb->rep_.size() || end < begin) {
     return Status::Corruption("Invalid start/end bounds for Iterate");
   }
@@ -772,6 +784,43 @@ Status WriteBatchInternal::Iterate(const WriteBatch* wb,
   }
 }
 
+Status WriteBatchInternal::IterateValueRef(const WriteBatch* wb,
+                                           WriteBatch::Handler* handler) {
+  assert(wb->value_ref_ != nullptr);
+  Slice input(wb->rep_);
+  input.remove_prefix(WriteBatchInternal::kHeader);
+  uint32_t column_family = 0;  // default
+  Slice key;
+  uint32_t value_size = 0;
+  if (input.empty() || Count(wb) != 1) {
+    return Status::Corruption("bad WriteBatch value reference");
+  }
+  const char tag = input[0];
+  input.remove_prefix(1);
+  if ((tag != kTypeValue && tag != kTypeColumnFamilyValue) ||
+      (tag == kTypeColumnFamilyValue &&
+       !GetVarint32(&input, &column_family)) ||
+      !GetLengthPrefixedSlice(&input, &key) ||
+      !GetVarint32(&input, &value_size) || !input.empty() ||
+      value_size != wb->value_ref_->size()) {
+    return Status::Corruption("bad WriteBatch value reference");
+  }
+  if (!handler->Continue()) {
+    return Status::OK();
+  }
+  Status s = handler->PutCF(column_family, key, *wb->value_ref_);
+  if (UNLIKELY(s.IsTryAgain())) {
+    // As in Iterate(), the handler is given one more chance.
+    s = handler->PutCF(column_family, key, *wb->value_ref_);
+    if (UNLIKELY(s.IsTryAgain())) {
+      return Status::Corruption(
+          "two consecutive TryAgain in WriteBatch handler; this is either a "
+          "software bug or data corruption.");
+    }
+  }
+  return s;
+}
+
 bool WriteBatchInternal::IsLatestPersistentState(const WriteBatch* b) {
   return b->is_latest_persistent_state_;
 }
@@ -871,6 +920,36 @@ Status WriteBatchInternal::CheckSlicePartsLength(const SliceParts& key,
   return Status::OK();
 }
 
+Status WriteBatchInternal::PutValueRef(WriteBatch* b,
+                                       uint32_t column_family_id,
+                                       const Slice& key, const Slice* value) {
+  assert(Count(b) == 0);
+  assert(b->max_bytes_ == 0);
+  assert(b->prot_info_ == nullptr);
+  assert(b->timestamp_size_ == 0);
+  if (key.size() > size_t{port::kMaxUint32}) {
+    return Status::InvalidArgument("key is too large");
+  }
+  if (value->size() > size_t{port::kMaxUint32}) {
+    return Status::InvalidArgument("value is too large");
+  }
+
+  WriteBatchInternal::SetCount(b, 1);
+  if (column_family_id == 0) {
+    b->rep_.push_back(static_cast<char>(kTypeValue));
+  } else {
+    b->rep_.push_back(static_cast<char>(kTypeColumnFamilyValue));
+    PutVarint32(&b->rep_, column_family_id);
+  }
+  PutLengthPrefixedSlice(&b->rep_, key);
+  PutVarint32(&b->rep_, static_cast<uint32_t>(value->size()));
+  b->value_ref_ = value;
+  b->content_flags_.store(
+      b->content_flags_.load(std::memory_order_relaxed) | ContentFlags::HAS_PUT,
+      std::memory_order_relaxed);
+  return Status::OK();
+}
+
 Status WriteBatchInternal::Put(WriteBatch* b, uint32_t column_family_id,
                                const SliceParts& key, const SliceParts& value) {
   Status s = CheckSlicePartsLength(key, value);
@@ -2401,6 +2480,78 @@ Status WriteBatchInternal::InsertInto(
   return s;
 }
 
+Status WriteBatchInternal::SplitRecords(const WriteBatch* b,
+                                        size_t max_ranges,
+                                        std::vector<RecordRange>* ranges) {
+  ranges->clear();
+  if (b->rep_.size() < WriteBatchInternal::kHeader) {
+    return Status::Corruption("malformed WriteBatch (too small)");
+  }
+  const size_t records_size = b->rep_.size() - WriteBatchInternal::kHeader;
+  const size_t target_size = records_size / std::max<size_t>(max_ranges, 1);
+  Slice input(b->rep_.data() + WriteBatchInternal::kHeader, records_size);
+  Slice key, value, blob, xid;
+  char tag = 0;
+  uint32_t column_family = 0;
+  RecordRange range{WriteBatchInternal::kHeader, WriteBatchInternal::kHeader,
+                    0};
+  uint32_t sequence_offset = 0;
+  while (!input.empty()) {
+    const size_t offset = b->rep_.size() - input.size();
+    if (offset > range.begin && offset - range.begin >= target_size &&
+        ranges->size() + 1 < max_ranges) {
+      range.end = offset;
+      ranges->push_back(range);
+      range.begin = offset;
+      range.sequence_offset = sequence_offset;
+    }
+    Status s = ReadRecordFromWriteBatch(&input, &tag, &column_family, &key,
+                                        &value, &blob, &xid);
+    if (!s.ok()) {
+      return s;
+    }
+    switch (tag) {
+      case kTypeColumnFamilyValue:
+      case kTypeValue:
+      case kTypeColumnFamilyDeletion:
+      case kTypeDeletion:
+      case kTypeColumnFamilySingleDeletion:
+      case kTypeSingleDeletion:
+      case kTypeColumnFamilyRangeDeletion:
+      case kTypeRangeDeletion:
+      case kTypeColumnFamilyMerge:
+      case kTypeMerge:
+      case kTypeColumnFamilyBlobIndex:
+      case kTypeBlobIndex:
+        sequence_offset++;
+        break;
+      case kTypeLogData:
+        break;
+      default:
+        return Status::NotSupported(
+            "Only key updates and log data can be split into ranges");
+    }
+  }
+  range.end = b->rep_.size();
+  ranges->push_back(range);
+  return Status::OK();
+}
+
+Status WriteBatchInternal::InsertInto(
+    const WriteBatch* batch, const RecordRange& range, SequenceNumber sequence,
+    ColumnFamilyMemTables* memtables, FlushScheduler* flush_scheduler,
+    TrimHistoryScheduler* trim_history_scheduler,
+    bool ignore_missing_column_families, DB* db) {
+  MemTableInserter inserter(
+      sequence, memtables, flush_scheduler, trim_history_scheduler,
+      ignore_missing_column_families, 0 /* recovery_log_number */, db,
+      true /* concurrent_memtable_writes */, nullptr /* prot_info */,
+      nullptr /* has_valid_writes */);
+  Status s = Iterate(batch, &inserter, range.begin, range.end);
+  inserter.PostProcess();
+  return s;
+}
+
 Status WriteBatchInternal::SetContents(WriteBatch* b, const Slice& contents) {
   assert(contents.size() >= WriteBatchInternal::kHeader);
   assert(b->prot_info_ == nullptr);
@@ -2413,6 +2564,7 @@ Status WriteBatchInternal::Append(WriteBatch* dst, const WriteBatch* src,
                                   const bool wal_only) {
   assert(dst->Count() == 0 ||
          (dst->prot_info_ == nullptr) == (src->prot_info_ == nullptr));
+  assert(dst->value_ref_ == nullptr);
   size_t src_len;
   int src_count;
   uint32_t src_flags;
@@ -2439,6 +2591,9 @@ Status WriteBatchInternal::Append(WriteBatch* dst, const WriteBatch* src,
   SetCount(dst, Count(dst) + src_count);
   assert(src->rep_.size() >= WriteBatchInternal::kHeader);
   dst->rep_.append(src->rep_.data() + WriteBatchInternal::kHeader, src_len);
+  if (src->value_ref_ != nullptr && src_count > 0) {
+    dst->rep_.append(src->value_ref_->data(), src->value_ref_->size());
+  }
   dst->content_flags_.store(
       dst->content_flags_.load(std::memory_order_relaxed) | src_flags,
       std::memory_order_relaxed);
@@ -86,6 +86,13 @@ class WriteBatchInternal {
   static Status Put(WriteBatch* batch, uint32_t column_family_id,
                     const SliceParts& key, const SliceParts& value);
 
+  // Adds a Put to an empty batch without copying the value into it. The
+  // batch then references *value, which must outlive the batch, and cannot
+  // take any other record. Batches with protection info, timestamps or a
+  // maximum size are not supported.
+  static Status PutValueRef(WriteBatch* batch, uint32_t column_family_id,
+                            const Slice& key, const Slice* value);
+
   static Status Delete(WriteBatch* batch, uint32_t column_family_id,
                        const SliceParts& key);
 
@@ -141,12 +148,31 @@ class WriteBatchInternal {
   // This offset is only valid if the batch is not empty.
   static size_t GetFirstOffset(WriteBatch* batch);
 
+  // Returns the contents of the batch, minus the referenced value of a batch
+  // built by PutValueRef(). Use ContentsParts() to write the batch out.
   static Slice Contents(const WriteBatch* batch) {
     return Slice(batch->rep_);
   }
 
+  // Returns the contents of the batch as one part, or as two for a batch
+  // built by PutValueRef(): rep_ and the referenced value. `parts` must have
+  // room for two slices.
+  static SliceParts ContentsParts(const WriteBatch* batch, Slice* parts) {
+    parts[0] = Slice(batch->rep_);
+    if (batch->value_ref_ == nullptr) {
+      return SliceParts(parts, 1);
+    }
+    parts[1] = *batch->value_ref_;
+    return SliceParts(parts, 2);
+  }
+
+  static bool HasValueRef(const WriteBatch* batch) {
+    return batch->value_ref_ != nullptr;
+  }
+
   static size_t ByteSize(const WriteBatch* batch) {
-    return batch->rep_.size();
+    return batch->rep_.size() +
+           (batch->value_ref_ != nullptr ? batch->value_ref_->size() : 0);
   }
 
   static Status SetContents(WriteBatch* batch, const Slice& contents);
@@ -201,6 +227,33 @@ class WriteBatchInternal {
                            bool batch_per_txn = true,
                            bool hint_per_batch = false);
 
+  // A range of the records of a write batch, see SplitRecords().
+  struct RecordRange {
+    // Offsets of the first record and past the last record in the contents.
+    size_t begin;
+    size_t end;
+    // Number of records before `begin` that consume a sequence number.
+    uint32_t sequence_offset;
+  };
+
+  // Splits the records of `b` into up to `max_ranges` ranges of about equal
+  // byte size. Returns NotSupported if the batch has records other than
+  // key updates and log data, e.g. transaction markers.
+  static Status SplitRecords(const WriteBatch* b, size_t max_ranges,
+                             std::vector<RecordRange>* ranges);
+
+  // Inserts the records of `range` of `batch` into the memtables as a
+  // concurrent memtable write, assigning sequence numbers from `sequence`
+  // on. Ranges of the same batch may be inserted by different threads at
+  // the same time. Requires that the batch does not need one sequence number
+  // per batch.
+  static Status InsertInto(const WriteBatch* batch, const RecordRange& range,
+                           SequenceNumber sequence,
+                           ColumnFamilyMemTables* memtables,
+                           FlushScheduler* flush_scheduler,
+                           TrimHistoryScheduler* trim_history_scheduler,
+                           bool ignore_missing_column_families, DB* db);
+
   static Status Append(WriteBatch* dst, const WriteBatch* src,
                        const bool WAL_only = false);
 
@@ -212,6 +265,10 @@ class WriteBatchInternal {
   static Status Iterate(const WriteBatch* wb, WriteBatch::Handler* handler,
                         size_t begin, size_t end);
 
+  // Iterate over the record of a batch built by PutValueRef()
+  static Status IterateValueRef(const WriteBatch* wb,
+                                WriteBatch::Handler* handler);
+
   // This write batch includes the latest state that should be persisted. Such
   // state meant to be used only during recovery.
   static void SetAsLastestPersistentState(WriteBatch* b);
@@ -899,6 +899,106 @@ TEST_F(WriteBatchTest, MemoryLimitTest) {
   ASSERT_TRUE(s.IsMemoryLimit());
 }
 
+TEST_F(WriteBatchTest, SplitRecords) {
+  WriteBatch batch;
+  for (int i = 0; i < 100; i++) {
+    ASSERT_OK(batch.Put("key" + ToString(i), std::string(100, 'v')));
+    if (i % 10 == 0) {
+      ASSERT_OK(batch.PutLogData("blob"));
+    }
+  }
+  std::vector<WriteBatchInternal::RecordRange> ranges;
+  ASSERT_OK(WriteBatchInternal::SplitRecords(&batch, 4, &ranges));
+  ASSERT_EQ(4, ranges.size());
+  ASSERT_EQ(static_cast<size_t>(WriteBatchInternal::kHeader),
+            ranges.front().begin);
+  ASSERT_EQ(0, ranges.front().sequence_offset);
+  ASSERT_EQ(WriteBatchInternal::ByteSize(&batch), ranges.back().end);
+  for (size_t i = 1; i < ranges.size(); i++) {
+    ASSERT_EQ(ranges[i - 1].end, ranges[i].begin);
+    ASSERT_GT(ranges[i].sequence_offset, ranges[i - 1].sequence_offset);
+  }
+
+  // Every range starts at a record, and the log data does not consume
+  // sequence numbers.
+  struct Counter : public WriteBatch::Handler {
+    uint32_t puts = 0;
+    Status PutCF(uint32_t /*column_family_id*/, const Slice& /*key*/,
+                 const Slice& /*value*/) override {
+      puts++;
+      return Status::OK();
+    }
+  };
+  uint32_t puts = 0;
+  for (const auto& range : ranges) {
+    ASSERT_EQ(puts, range.sequence_offset);
+    Counter counter;
+    ASSERT_OK(
+        WriteBatchInternal::Iterate(&batch, &counter, range.begin, range.end));
+    puts += counter.puts;
+  }
+  ASSERT_EQ(100, puts);
+
+  // Small batches yield fewer ranges, transaction markers none.
+  WriteBatch small;
+  ASSERT_OK(small.Put("a", "b"));
+  ASSERT_OK(WriteBatchInternal::SplitRecords(&small, 4, &ranges));
+  ASSERT_EQ(1, ranges.size());
+  ASSERT_OK(WriteBatchInternal::InsertNoop(&small));
+  ASSERT_TRUE(
+      WriteBatchInternal::SplitRecords(&small, 4, &ranges).IsNotSupported());
+}
+
+TEST_F(WriteBatchTest, PutValueRef) {
+  const std::string value(1000, 'v');
+  const Slice value_slice(value);
+  auto joined_contents = [](const WriteBatch* b) {
+    Slice parts[2];
+    SliceParts contents = WriteBatchInternal::ContentsParts(b, parts);
+    std::string joined;
+    for (int i = 0; i < contents.num_parts; i++) {
+      joined.append(contents.parts[i].data(), contents.parts[i].size());
+    }
+    return joined;
+  };
+
+  // The value is not copied into the batch, which reads and is written out
+  // as if it was.
+  WriteBatch batch;
+  ASSERT_OK(WriteBatchInternal::PutValueRef(&batch, 0, "foo", &value_slice));
+  WriteBatchInternal::SetSequence(&batch, 100);
+  WriteBatch expected;
+  ASSERT_OK(expected.Put("foo", value));
+  WriteBatchInternal::SetSequence(&expected, 100);
+  ASSERT_TRUE(WriteBatchInternal::HasValueRef(&batch));
+  ASSERT_EQ(1, batch.Count());
+  ASSERT_TRUE(batch.HasPut());
+  ASSERT_EQ(expected.GetDataSize() - value.size(), batch.GetDataSize());
+  ASSERT_EQ(WriteBatchInternal::ByteSize(&expected),
+            WriteBatchInternal::ByteSize(&batch));
+  ASSERT_EQ(expected.Data(), joined_contents(&batch));
+  ASSERT_EQ(PrintContents(&expected), PrintContents(&batch));
+
+  // Appending it to another batch copies the value.
+  WriteBatch appended;
+  ASSERT_OK(WriteBatchInternal::Append(&appended, &batch));
+  WriteBatchInternal::SetSequence(&appended, 100);
+  ASSERT_FALSE(WriteBatchInternal::HasValueRef(&appended));
+  ASSERT_EQ(expected.Data(), appended.Data());
+
+  // Same with a column family.
+  WriteBatch cf_batch;
+  ASSERT_OK(WriteBatchInternal::PutValueRef(&cf_batch, 3, "bar", &value_slice));
+  WriteBatch cf_expected;
+  ASSERT_OK(WriteBatchInternal::Put(&cf_expected, 3, "bar", value));
+  ASSERT_EQ(cf_expected.Data(), joined_contents(&cf_batch));
+
+  batch.Clear();
+  ASSERT_FALSE(WriteBatchInternal::HasValueRef(&batch));
+  ASSERT_EQ(static_cast<size_t>(WriteBatchInternal::kHeader),
+            WriteBatchInternal::ByteSize(&batch));
+}
+
 }  // namespace ROCKSDB_NAMESPACE
 
 int main(int argc, char** argv) {
@@ -118,4 +118,130 @@ CompactionPressureToken::~CompactionPressureToken() {
   assert(controller_->total_compaction_pressure_ >= 0);
 }
 
+namespace {
+// Moves `rate` towards `delta` per `elapsed_micros`. The weight of the new
+// sample grows with `elapsed_micros`, so a burst of samples close together
+// moves the rate as much as one sample covering the same change.
+void UpdateRate(double* rate, double delta, uint64_t elapsed_micros) {
+  const double kMicrosPerSecond = 1000000.0;
+  if (elapsed_micros >= WriteStallPredictor::kRateWindowMicros) {
+    *rate = delta * kMicrosPerSecond / static_cast<double>(elapsed_micros);
+    return;
+  }
+  const double window_secs =
+      WriteStallPredictor::kRateWindowMicros / kMicrosPerSecond;
+  *rate += (delta - *rate * (elapsed_micros / kMicrosPerSecond)) /
+           window_secs;
+}
+
+double Pressure(double predicted, double slowdown, double stop) {
+  assert(stop > slowdown);
+  return (predicted - slowdown) / (stop - slowdown);
+}
+}  // namespace
+
+void WriteStallPredictor::Update(uint64_t now_micros, int num_l0_files,
+                                 uint64_t compaction_needed_bytes,
+                                 uint64_t bytes_flushed,
+                                 uint64_t bytes_compacted) {
+  double l0 = static_cast<double>(num_l0_files);
+  double debt = static_cast<double>(compaction_needed_bytes);
+  if (has_sample_) {
+    uint64_t elapsed = now_micros > last_micros_ ? now_micros - last_micros_
+                                                 : 0;
+    uint64_t flushed =
+        bytes_flushed >= bytes_flushed_ ? bytes_flushed - bytes_flushed_ : 0;
+    uint64_t compacted = bytes_compacted >= bytes_compacted_
+                             ? bytes_compacted - bytes_compacted_
+                             : 0;
+    total_bytes_flushed_ += flushed;
+    total_bytes_compacted_ += compacted;
+    UpdateRate(&l0_growth_rate_, l0 - num_l0_files_, elapsed);
+    UpdateRate(&debt_growth_rate_, debt - compaction_needed_bytes_, elapsed);
+    UpdateRate(&compaction_rate_, static_cast<double>(compacted), elapsed);
+    if (compaction_rate_ < 0) {
+      compaction_rate_ = 0;
+    }
+  } else {
+    first_micros_ = now_micros;
+  }
+  has_sample_ = true;
+  last_micros_ = std::max(last_micros_, now_micros);
+  num_l0_files_ = l0;
+  compaction_needed_bytes_ = debt;
+  bytes_flushed_ = bytes_flushed;
+  bytes_compacted_ = bytes_compacted;
+}
+
+double WriteStallPredictor::L0Pressure(int slowdown_trigger,
+                                       int stop_trigger) const {
+  if (slowdown_trigger < 0) {
+    return 0;
+  }
+  const double horizon_secs = kHorizonMicros / 1000000.0;
+  double predicted = std::max(
+      num_l0_files_, num_l0_files_ + l0_growth_rate_ * horizon_secs);
+  double stop = std::max(stop_trigger, slowdown_trigger + 1);
+  return Pressure(predicted, slowdown_trigger, stop);
+}
+
+double WriteStallPredictor::CompactionDebtPressure(uint64_t soft_limit,
+                                                   uint64_t hard_limit) const {
+  if (soft_limit == 0) {
+    return 0;
+  }
+  const double horizon_secs = kHorizonMicros / 1000000.0;
+  double predicted =
+      std::max(compaction_needed_bytes_,
+               compaction_needed_bytes_ + debt_growth_rate_ * horizon_secs);
+  double soft = static_cast<double>(soft_limit);
+  double hard = hard_limit > soft_limit ? static_cast<double>(hard_limit)
+                                        : 2 * soft;
+  return Pressure(predicted, soft, hard);
+}
+
+uint64_t WriteStallPredictor::SustainableWriteRate(
+    uint64_t max_write_rate) const {
+  if (total_bytes_flushed_ == 0 || total_bytes_compacted_ == 0 ||
+      last_micros_ <= first_micros_) {
+    return max_write_rate;
+  }
+  // Compaction finishes in jobs that can take longer than the rate window,
+  // so the recent rate is not allowed to fall below the long-term one.
+  double long_term_compaction_rate =
+      static_cast<double>(total_bytes_compacted_) * 1000000.0 /
+      static_cast<double>(last_micros_ - first_micros_);
+  double compaction_rate =
+      std::max(compaction_rate_, long_term_compaction_rate);
+  // Every flushed byte costs this many bytes of compaction input.
+  double compaction_bytes_per_flushed_byte =
+      static_cast<double>(total_bytes_compacted_) /
+      static_cast<double>(total_bytes_flushed_);
+  double rate = compaction_rate / compaction_bytes_per_flushed_byte;
+  if (rate >= static_cast<double>(max_write_rate)) {
+    return max_write_rate;
+  }
+  return static_cast<uint64_t>(rate);
+}
+
+uint64_t WriteStallPredictor::GetWriteRate(double pressure,
+                                           uint64_t max_write_rate) const {
+  // The paced rate is 1 / (1 + kGain * pressure) of the sustainable rate, so
+  // it decreases continuously, from the sustainable rate when the prediction
+  // crosses the slowdown threshold to a quarter of it at the stop threshold,
+  // and keeps decreasing, never reaching zero, beyond it.
+  const double kGain = 3.0;
+  assert(pressure > 0);
+  double rate = static_cast<double>(SustainableWriteRate(max_write_rate)) /
+                (1.0 + kGain * pressure);
+  uint64_t min_rate = kMinWriteRate;
+  if (min_rate > max_write_rate) {
+    min_rate = max_write_rate;
+  }
+  if (rate <= static_cast<double>(min_rate)) {
+    return min_rate;
+  }
+  return static_cast<uint64_t>(rate);
+}
+
 }  // namespace ROCKSDB_NAMESPACE
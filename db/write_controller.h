@@ -144,4 +144,65 @@ class CompactionPressureToken : public WriteControllerToken {
   virtual ~CompactionPressureToken();
 };
 
+// WriteStallPredictor is used by DBOptions::predictive_write_stall_control.
+// It follows one column family: how fast compaction reads its input, how
+// many compaction bytes each flushed byte costs, and how fast the number of
+// L0 files and the pending compaction bytes are growing. From these it
+// predicts where the L0 file count and the compaction debt are heading and
+// picks a write rate that steers them back below their slowdown thresholds.
+// Not thread-safe; called while holding DB mutex.
+class WriteStallPredictor {
+ public:
+  // Rates are averaged over about this long.
+  static const uint64_t kRateWindowMicros = 10 * 1000 * 1000;
+  // How far ahead the L0 file count and the compaction debt are predicted.
+  static const uint64_t kHorizonMicros = 5 * 1000 * 1000;
+  // Minimum paced write rate, in bytes per second.
+  static const uint64_t kMinWriteRate = 16 * 1024u;
+
+  WriteStallPredictor() {}
+
+  // Takes a sample of the column family. `bytes_flushed` and
+  // `bytes_compacted` are cumulative; a counter going backwards, e.g. after
+  // its stats were reset, restarts it.
+  void Update(uint64_t now_micros, int num_l0_files,
+              uint64_t compaction_needed_bytes, uint64_t bytes_flushed,
+              uint64_t bytes_compacted);
+
+  // How far above its slowdown threshold the predicted L0 file count is, as
+  // a fraction of the distance from the slowdown to the stop trigger. Zero
+  // or less means no slowdown is needed.
+  double L0Pressure(int slowdown_trigger, int stop_trigger) const;
+  // The same for the predicted pending compaction bytes and the soft and hard
+  // limits. A hard limit of 0 is taken as twice the soft limit.
+  double CompactionDebtPressure(uint64_t soft_limit,
+                                uint64_t hard_limit) const;
+
+  // The write rate, in bytes per second, at which compaction keeps up with
+  // flushes, capped at `max_write_rate`. `max_write_rate` until compaction
+  // throughput has been measured.
+  uint64_t SustainableWriteRate(uint64_t max_write_rate) const;
+
+  // The rate to pace writes at under `pressure` > 0: the sustainable rate,
+  // reduced smoothly as the pressure grows, a quarter of it at pressure 1.
+  uint64_t GetWriteRate(double pressure, uint64_t max_write_rate) const;
+
+ private:
+  bool has_sample_ = false;
+  uint64_t first_micros_ = 0;
+  uint64_t last_micros_ = 0;
+  double num_l0_files_ = 0;
+  double compaction_needed_bytes_ = 0;
+  uint64_t bytes_flushed_ = 0;
+  uint64_t bytes_compacted_ = 0;
+  // Since the last restart of the counters.
+  uint64_t total_bytes_flushed_ = 0;
+  uint64_t total_bytes_compacted_ = 0;
+
+  // Per second.
+  double l0_growth_rate_ = 0;
+  double debt_growth_rate_ = 0;
+  double compaction_rate_ = 0;
+};
+
 }  // namespace ROCKSDB_NAMESPACE
@@ -239,6 +239,43 @@ TEST_F(WriteControllerTest, CreditAccumulation) {
   ASSERT_EQ(10 SECS, controller.GetDelay(clock_.get(), 10 MB));
 }
 
+TEST_F(WriteControllerTest, WriteStallPredictor) {
+  WriteStallPredictor predictor;
+  predictor.Update(0, 10, 0, 0, 0);
+  ASSERT_LT(predictor.L0Pressure(32, 48), 0);
+  ASSERT_LT(predictor.CompactionDebtPressure(125 MB, 175 MB), 0);
+  ASSERT_EQ(0, predictor.CompactionDebtPressure(0, 0));
+  // Nothing compacted yet
+  ASSERT_EQ(40 MBPS, predictor.SustainableWriteRate(40 MBPS));
+
+  // 2 L0 files and 10MB of compaction debt per second. Both are still below
+  // their slowdown thresholds, but will be above them in 5 seconds.
+  predictor.Update(10 SECS, 30, 100 MB, 100 MB, 200 MB);
+  ASSERT_EQ(0.5, predictor.L0Pressure(32, 48));
+  ASSERT_EQ(0.5, predictor.CompactionDebtPressure(125 MB, 175 MB));
+  // No hard limit
+  ASSERT_EQ(0.2, predictor.CompactionDebtPressure(125 MB, 0));
+  // No slowdown trigger
+  ASSERT_EQ(0, predictor.L0Pressure(-1, 48));
+
+  // Compaction reads 20MB/s, 2 bytes per flushed byte
+  ASSERT_EQ(10 MBPS, predictor.SustainableWriteRate(40 MBPS));
+  ASSERT_EQ(5 MBPS, predictor.SustainableWriteRate(5 MBPS));
+  // Smoothly slower with more pressure, never zero
+  ASSERT_EQ(4 MBPS, predictor.GetWriteRate(0.5, 40 MBPS));
+  ASSERT_EQ(2500000u, predictor.GetWriteRate(1, 40 MBPS));
+  ASSERT_EQ(16 * 1024u, predictor.GetWriteRate(1000, 40 MBPS));
+
+  // Shrinking L0 does not predict less than what is there
+  predictor.Update(20 SECS, 20, 50 MB, 100 MB, 300 MB);
+  ASSERT_EQ(-0.75, predictor.L0Pressure(32, 48));
+  ASSERT_EQ(-0.75, predictor.CompactionDebtPressure(125 MB, 225 MB));
+  // No compaction for a while: the long-term compaction rate, 7.5MB/s, is
+  // used, at 3 bytes per flushed byte.
+  predictor.Update(40 SECS, 20, 50 MB, 100 MB, 300 MB);
+  ASSERT_EQ(2500000u, predictor.SustainableWriteRate(40 MBPS));
+}
+
 }  // namespace ROCKSDB_NAMESPACE
 
 int main(int argc, char** argv) {
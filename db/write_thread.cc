@@ -8,6 +8,7 @@
 #include <thread>
 #include "db/column_family.h"
 #include "monitoring/perf_context_imp.h"
+#include "monitoring/statistics.h"
 #include "port/port.h"
 #include "test_util/sync_point.h"
 #include "util/random.h"
@@ -24,6 +25,11 @@ WriteThread::WriteThread(const ImmutableDBOptions& db_options)
       enable_pipelined_write_(db_options.enable_pipelined_write),
       max_write_batch_group_size_bytes(
           db_options.max_write_batch_group_size_bytes),
+      latency_budget_nanos_(
+          db_options.write_batch_group_latency_budget_micros * 1000),
+      stats_(db_options.stats),
+      wal_nanos_per_byte_(0),
+      memtable_nanos_per_byte_(0),
       newest_writer_(nullptr),
       newest_memtable_writer_(nullptr),
       last_sequence_(0),
@@ -412,6 +418,52 @@ void WriteThread::JoinBatchGroup(Writer* w) {
   }
 }
 
+void WriteThread::UpdateCostPerByte(std::atomic<double>* cost, size_t bytes,
+                                    uint64_t nanos) {
+  if (bytes == 0) {
+    return;
+  }
+  double sample = static_cast<double>(nanos) / static_cast<double>(bytes);
+  double prev = cost->load(std::memory_order_relaxed);
+  // Exponential moving average over roughly the last eight groups. Only
+  // group leaders report, one at a time, so a plain load and store is enough.
+  cost->store(prev > 0 ? prev + (sample - prev) / 8 : sample,
+              std::memory_order_relaxed);
+}
+
+bool WriteThread::ApplyLatencyBudget(size_t leader_size, bool include_wal,
+                                     bool include_memtable, size_t* max_size) {
+  if (latency_budget_nanos_ == 0) {
+    return false;
+  }
+  double nanos_per_byte = 0;
+  if (include_wal) {
+    nanos_per_byte += wal_nanos_per_byte_.load(std::memory_order_relaxed);
+  }
+  if (include_memtable) {
+    nanos_per_byte += memtable_nanos_per_byte_.load(std::memory_order_relaxed);
+  }
+  if (nanos_per_byte <= 0) {
+    return false;
+  }
+  double limit = static_cast<double>(latency_budget_nanos_) / nanos_per_byte;
+  size_t limit_bytes = limit < static_cast<double>(*max_size)
+                           ? static_cast<size_t>(limit)
+                           : *max_size;
+  RecordInHistogram(stats_, WRITE_GROUP_LATENCY_LIMIT_BYTES, limit_bytes);
+  if (leader_size >= limit_bytes) {
+    // The leader alone uses up the budget. Write it in a group of its own
+    // rather than making the writers queued behind it wait even longer.
+    RecordTick(stats_, WRITE_GROUP_LARGE_BATCH_ALONE);
+    limit_bytes = leader_size;
+  }
+  if (limit_bytes >= *max_size) {
+    return false;
+  }
+  *max_size = limit_bytes;
+  return true;
+}
+
 size_t WriteThread::EnterAsBatchGroupLeader(Writer* leader,
                                             WriteGroup* write_group) {
   assert(leader->link_older == nullptr);
@@ -428,6 +480,11 @@ size_t WriteThread::EnterAsBatchGroupLeader(Writer* leader,
   if (size <= min_batch_size_bytes) {
     max_size = size + min_batch_size_bytes;
   }
+  const size_t unlimited_max_size = max_size;
+  const bool latency_limited =
+      ApplyLatencyBudget(size, !leader->disable_wal /* include_wal */,
+                         !enable_pipelined_write_ /* include_memtable */,
+                         &max_size);
 
   leader->write_group = write_group;
   write_group->leader = leader;
@@ -485,6 +542,9 @@ size_t WriteThread::EnterAsBatchGroupLeader(Writer* leader,
     auto batch_size = WriteBatchInternal::ByteSize(w->batch);
     if (size + batch_size > max_size) {
       // Do not make batch too big
+      if (latency_limited && size + batch_size <= unlimited_max_size) {
+        RecordTick(stats_, WRITE_GROUP_LATENCY_LIMITED);
+      }
       break;
     }
 
@@ -514,6 +574,12 @@ void WriteThread::EnterAsMemTableWriter(Writer* leader,
   if (size <= min_batch_size_bytes) {
     max_size = size + min_batch_size_bytes;
   }
+  const size_t unlimited_max_size = max_size;
+  // Concurrent memtable writers are not grouped by size.
+  const bool latency_limited =
+      !allow_concurrent_memtable_write_ &&
+      ApplyLatencyBudget(size, false /* include_wal */,
+                         true /* include_memtable */, &max_size);
 
   leader->write_group = write_group;
   write_group->leader = leader;
@@ -541,6 +607,9 @@ void WriteThread::EnterAsMemTableWriter(Writer* leader,
         auto batch_size = WriteBatchInternal::ByteSize(w->batch);
         if (size + batch_size > max_size) {
           // Do not make batch too big
+          if (latency_limited && size + batch_size <= unlimited_max_size) {
+            RecordTick(stats_, WRITE_GROUP_LATENCY_LIMITED);
+          }
           break;
         }
         size += batch_size;
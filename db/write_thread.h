@@ -123,6 +123,7 @@ class WriteThread {
     PreReleaseCallback* pre_release_callback;
     uint64_t log_used;  // log number that this batch was inserted into
     uint64_t log_ref;   // log number that memtable insert should reference
+    uint64_t wal_sync_ticket;  // WAL sync to wait for, 0 if none
     WriteCallback* callback;
     bool made_waitable;          // records lazy construction of mutex and cv
     std::atomic<uint8_t> state;  // write under StateMutex() or pre-link
@@ -147,6 +148,7 @@ class WriteThread {
           pre_release_callback(nullptr),
           log_used(0),
           log_ref(0),
+          wal_sync_ticket(0),
           callback(nullptr),
           made_waitable(false),
           state(STATE_INIT),
@@ -169,6 +171,7 @@ class WriteThread {
           pre_release_callback(_pre_release_callback),
           log_used(0),
           log_ref(_log_ref),
+          wal_sync_ticket(0),
           callback(_callback),
           made_waitable(false),
           state(STATE_INIT),
@@ -354,6 +357,21 @@ class WriteThread {
   // Remove the dummy writer and wake up waiting writers
   void EndWriteStall();
 
+  // True if write groups are sized against
+  // write_batch_group_latency_budget_micros, in which case the group leaders
+  // report the cost of their writes below.
+  bool latency_budget_enabled() const { return latency_budget_nanos_ > 0; }
+
+  // Reports that writing `bytes` of a write group to the WAL, excluding any
+  // sync, or inserting them into the memtables took `nanos`. Only called by
+  // the leader of the corresponding group.
+  void RecordWalWriteCost(size_t bytes, uint64_t nanos) {
+    UpdateCostPerByte(&wal_nanos_per_byte_, bytes, nanos);
+  }
+  void RecordMemTableInsertCost(size_t bytes, uint64_t nanos) {
+    UpdateCostPerByte(&memtable_nanos_per_byte_, bytes, nanos);
+  }
+
  private:
   // See AwaitState.
   const uint64_t max_yield_usec_;
@@ -370,6 +388,16 @@ class WriteThread {
   // is larger than 1/8 of this limit.
   const uint64_t max_write_batch_group_size_bytes;
 
+  // write_batch_group_latency_budget_micros, in nanoseconds.
+  const uint64_t latency_budget_nanos_;
+
+  Statistics* const stats_;
+
+  // Moving averages of the observed WAL write and memtable insert cost, in
+  // nanoseconds per byte. Zero until the first report.
+  std::atomic<double> wal_nanos_per_byte_;
+  std::atomic<double> memtable_nanos_per_byte_;
+
   // Points to the newest pending writer. Only leader can remove
   // elements, adding can be done lock-free by anybody.
   std::atomic<Writer*> newest_writer_;
@@ -406,6 +434,18 @@ class WriteThread {
   // Set writer state and wake the writer up if it is waiting.
   void SetState(Writer* w, uint8_t new_state);
 
+  static void UpdateCostPerByte(std::atomic<double>* cost, size_t bytes,
+                                uint64_t nanos);
+
+  // Lowers `*max_size`, the size limit of a group led by a batch of
+  // `leader_size` bytes, to what the group can write within the latency
+  // budget given the observed cost of the steps the leader performs, i.e. the
+  // WAL write if `include_wal` and the memtable insert if `include_memtable`.
+  // A leader that alone exceeds the budget gets a limit of its own size.
+  // Returns true if the limit was lowered.
+  bool ApplyLatencyBudget(size_t leader_size, bool include_wal,
+                          bool include_memtable, size_t* max_size);
+
   // Links w into the newest_writer list. Return true if w was linked directly
   // into the leader position.  Safe to call from multiple threads without
   // external locking.
@@ -360,6 +360,29 @@ struct AdvancedColumnFamilyOptions {
   // Dynamically changeable through SetOptions() API
   size_t memtable_huge_page_size = 0;
 
+  // If true, the arena blocks of the memtable whose size is a multiple of
+  // 2MB (see arena_block_size) are mapped at a 2MB boundary and advised to
+  // be backed by transparent huge pages, which does not require reserving
+  // huge pages like memtable_huge_page_size does. If the mapping fails, it
+  // will fall back to malloc.
+  //
+  // Default: false
+  //
+  // Dynamically changeable through SetOptions() API
+  bool memtable_transparent_huge_pages = false;
+
+  // If true, RocksDB is built with NUMA support and the machine has more
+  // than one NUMA node, concurrent memtable writers (see
+  // allow_concurrent_memtable_write) allocate from arena blocks that prefer
+  // the memory of the node they run on, so that inserts do not touch remote
+  // memory. The usage per node is reported by the
+  // "rocksdb.cur-size-all-mem-tables-by-numa-node" property.
+  //
+  // Default: false
+  //
+  // Dynamically changeable through SetOptions() API
+  bool memtable_numa_aware = false;
+
   // If non-nullptr, memtable will use the specified function to extract
   // prefixes for keys, and for each prefix maintain a hint of insert location
   // to reduce CPU usage for inserting keys with the prefix. Keys out of
@@ -678,6 +701,51 @@ struct AdvancedColumnFamilyOptions {
   // Default: false
   bool optimize_filters_for_hits = false;
 
+  // Number of key ranges a flush splits the memtables into. The ranges are
+  // chosen by sampling the memtables and are written to that many
+  // non-overlapping L0 files by concurrent threads, which are installed in
+  // a single VersionEdit. The files of one flush whose sequence numbers
+  // interleave count as a single sorted run towards
+  // level0_file_num_compaction_trigger and the write stall triggers (the
+  // files of a sequential load are ordered by sequence number anyway and
+  // count separately).
+  // This speeds up flushing large write buffers when flush is CPU bound.
+  //
+  // The memtables are flushed to a single file as usual if the column family
+  // does not use level compaction, the flush is part of an atomic flush, the
+  // memtables contain range deletions, blob files are enabled, user-defined
+  // timestamps are used, or the memtable representation cannot be sampled
+  // (only SkipListFactory can).
+  //
+  // Default: 1 (no partitioning)
+  //
+  // Dynamically changeable through SetOptions() API
+  size_t flush_partitions = 1;
+
+  // If true, a flush that picks two or more immutable memtables first
+  // compacts them in memory into a single memtable, dropping the versions
+  // that are shadowed by newer writes and not needed by any snapshot, and
+  // combining merge operands where the merge operator allows it. When the
+  // flush was triggered by a full write buffer and
+  // min_write_buffer_number_to_merge > 1, the compacted memtable stays in
+  // the immutable memtable list instead of being flushed, so that it can
+  // absorb further overwrites before reaching L0. It is flushed
+  // once it reaches write_buffer_size, or once the data written into it
+  // reaches max_write_buffer_number write buffers, which bounds the WAL it
+  // keeps alive.
+  //
+  // This reduces flush bytes and L0 write amplification for update-heavy
+  // workloads with hot keys at the cost of CPU time on the flush thread.
+  // Compaction filters still only run when data is written to SST files.
+  //
+  // Not supported with atomic_flush or user-defined timestamps, in which
+  // case the option is ignored.
+  //
+  // Default: false
+  //
+  // Dynamically changeable through SetOptions() API
+  bool in_memory_compaction = false;
+
   // During flush or compaction, check whether keys inserted to output files
   // are in order.
   //
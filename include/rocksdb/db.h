@@ -829,6 +829,13 @@ class DB {
     //      and unflushed immutable memtables (bytes).
     static const std::string kCurSizeAllMemTables;
 
+    //  "rocksdb.cur-size-all-mem-tables-by-numa-node" - returns a map from
+    //      NUMA node id to the approximate size (bytes) of the active and
+    //      unflushed immutable memtable memory preferring that node, or as a
+    //      string, "<node>=<bytes>; " per node. Only populated when
+    //      memtable_numa_aware is in effect.
+    static const std::string kCurSizeAllMemTablesByNumaNode;
+
     //  "rocksdb.size-all-mem-tables" - returns approximate size of active,
     //      unflushed immutable, and pinned immutable memtables (bytes).
     static const std::string kSizeAllMemTables;
@@ -0,0 +1,56 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+//
+// Flow tracing records when the internal stages of the write, read, flush
+// and compaction paths start and how long they take. Tracepoints are compiled
+// in but cost a single relaxed atomic load while their category is disabled.
+// Categories are enabled through DBOptions::flow_trace_categories (mutable
+// via DB::SetDBOptions); a category is traced while at least one open DB
+// enables it. Events are kept in per-thread in-memory buffers and can be
+// exported in the Chrome trace event format, which chrome://tracing and
+// Perfetto can display.
+
+#pragma once
+
+#include <stdint.h>
+
+#include <string>
+
+#include "rocksdb/rocksdb_namespace.h"
+#include "rocksdb/status.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+class Env;
+
+// Bits of DBOptions::flow_trace_categories.
+enum FlowTraceCategory : uint32_t {
+  // DB::Write down to the WAL and memtable insertion, including write
+  // throttling and memtable switches.
+  kFlowTraceWrite = 0x1,
+  // DB::Get through the memtables, table cache and block-based tables.
+  kFlowTraceRead = 0x2,
+  // Flush scheduling and FlushJob.
+  kFlowTraceFlush = 0x4,
+  // Compaction scheduling, level and universal compaction picking and
+  // CompactionJob.
+  kFlowTraceCompaction = 0x8,
+  kFlowTraceAll = 0xF,
+};
+
+// Parses a comma separated list of category names ("write", "read", "flush",
+// "compaction", "all" or "none") into a mask of FlowTraceCategory bits.
+extern Status ParseFlowTraceCategories(const std::string& names,
+                                       uint32_t* categories);
+
+// Writes every event buffered so far, from all threads, to `path` as a
+// Chrome trace event JSON object. The buffers of exited threads are kept for
+// export, up to the 256 that exited last. Buffers are not cleared.
+extern Status ExportFlowTrace(Env* env, const std::string& path);
+
+// Drops every buffered event, and the buffers of exited threads.
+extern void ClearFlowTrace();
+
+}  // namespace ROCKSDB_NAMESPACE
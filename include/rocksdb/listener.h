@@ -208,7 +208,9 @@ struct FlushJobInfo {
   uint32_t cf_id;
   // the name of the column family
   std::string cf_name;
-  // the path to the newly created file
+  // the path to the newly created file. Empty, like file_number is 0, if the
+  // flushed memtables were compacted and kept in memory instead (see
+  // in_memory_compaction).
   std::string file_path;
   // the file number of the newly created file
   uint64_t file_number;
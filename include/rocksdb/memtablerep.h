@@ -40,6 +40,7 @@
 #include <stdlib.h>
 #include <memory>
 #include <stdexcept>
+#include <vector>
 
 namespace ROCKSDB_NAMESPACE {
 
@@ -75,6 +76,11 @@ class MemTableRep {
     virtual int operator()(const char* prefix_len_key,
                            const Slice& key) const = 0;
 
+    // Returns the first 8 bytes of the user key of prefix_len_key as a
+    // big-endian integer, padded with zero bytes. With BytewiseComparator,
+    // a smaller prefix means a smaller key.
+    uint64_t KeyPrefix(const char* prefix_len_key) const;
+
     virtual ~KeyComparator() {}
   };
 
@@ -194,6 +200,12 @@ class MemTableRep {
     return 0;
   }
 
+  // Appends to *entries, in order, up to about `target` entries spread
+  // evenly over the key space, e.g. to split it into ranges of similar size.
+  // Only called on immutable memtables. The default appends nothing.
+  virtual void SampleEntries(size_t /*target*/,
+                             std::vector<const char*>* /*entries*/) const {}
+
   // Report an approximation of how much memory has been used other than memory
   // that was allocated through the allocator.  Safe to call from any thread.
   virtual size_t ApproximateMemoryUsage() = 0;
@@ -299,6 +311,12 @@ class MemTableRepFactory {
   // false when if the <key,seq> already exists.
   // Default: false
   virtual bool CanHandleDuplicatedKey() const { return false; }
+
+  // Return true if the current MemTableRep orders keys by their bytes and
+  // therefore only works with BytewiseComparator() (without user-defined
+  // timestamps). Column families using another comparator fail to open.
+  // Default: false
+  virtual bool RequiresBytewiseComparator() const { return false; }
 };
 
 // This uses a skip list to store keys. It is the default.
@@ -308,9 +326,16 @@ class MemTableRepFactory {
 //     search from the previously visited record (doing at most 'lookahead'
 //     steps). This is an optimization for the access pattern including many
 //     seeks with consecutive keys.
+//   use_key_prefix: If true, each skip list node also stores the first 8
+//     bytes of its user key as an integer next to its links, and searches
+//     compare these integers before falling back to the full comparator.
+//     This makes most comparisons a single integer compare on an already
+//     loaded cache line, at the cost of 8 bytes per entry. Requires
+//     BytewiseComparator.
 class SkipListFactory : public MemTableRepFactory {
  public:
-  explicit SkipListFactory(size_t lookahead = 0) : lookahead_(lookahead) {}
+  explicit SkipListFactory(size_t lookahead = 0, bool use_key_prefix = false)
+      : lookahead_(lookahead), use_key_prefix_(use_key_prefix) {}
 
   using MemTableRepFactory::CreateMemTableRep;
   virtual MemTableRep* CreateMemTableRep(const MemTableRep::KeyComparator&,
@@ -322,8 +347,11 @@ class SkipListFactory : public MemTableRepFactory {
 
   bool CanHandleDuplicatedKey() const override { return true; }
 
+  bool RequiresBytewiseComparator() const override { return use_key_prefix_; }
+
  private:
   const size_t lookahead_;
+  const bool use_key_prefix_;
 };
 
 #ifndef ROCKSDB_LITE
@@ -335,11 +363,17 @@ class SkipListFactory : public MemTableRepFactory {
 //   count: Passed to the constructor of the underlying std::vector of each
 //     VectorRep. On initialization, the underlying array will be at least count
 //     bytes reserved for usage.
+//   sort_threads: Number of threads, including the calling one, that sort the
+//     entries the first time an iterator is used, e.g. by flush. Large
+//     memtables are sorted with a parallel sample sort; 1 sorts in the
+//     calling thread. At most 64.
 class VectorRepFactory : public MemTableRepFactory {
   const size_t count_;
+  const size_t sort_threads_;
 
  public:
-  explicit VectorRepFactory(size_t count = 0) : count_(count) {}
+  explicit VectorRepFactory(size_t count = 0, size_t sort_threads = 1)
+      : count_(count), sort_threads_(sort_threads) {}
 
   using MemTableRepFactory::CreateMemTableRep;
   virtual MemTableRep* CreateMemTableRep(const MemTableRep::KeyComparator&,
@@ -355,6 +389,8 @@ class VectorRepFactory : public MemTableRepFactory {
 // skiplist_height: the max height of the skiplist
 // skiplist_branching_factor: probabilistic size ratio between adjacent
 //                            link lists in the skiplist
+// Concurrent inserts (allow_concurrent_memtable_write) are supported if
+// skiplist_height is at most 32.
 extern MemTableRepFactory* NewHashSkipListRepFactory(
     size_t bucket_count = 1000000, int32_t skiplist_height = 4,
     int32_t skiplist_branching_factor = 4);
@@ -375,11 +411,34 @@ extern MemTableRepFactory* NewHashSkipListRepFactory(
 //                                 entries when flushing.
 // @threshold_use_skiplist: a bucket switches to skip list if number of
 //                          entries exceed this parameter.
+// Concurrent inserts (allow_concurrent_memtable_write) are supported.
 extern MemTableRepFactory* NewHashLinkListRepFactory(
     size_t bucket_count = 50000, size_t huge_page_tlb_size = 0,
     int bucket_entries_logging_threshold = 4096,
     bool if_log_bucket_dist_when_flash = true,
     uint32_t threshold_use_skiplist = 256);
 
+// This creates MemTableReps that keep, next to the skip list used for
+// iteration and flush, a hash index from each user key to its entry with
+// the highest sequence number. A point lookup that can see that entry
+// starts from it instead of searching the skip list, making Get O(1) for
+// reads at the latest sequence number; reads at older snapshots fall back to
+// a skip list search. Concurrent inserts are supported. Keys are hashed
+// bytewise, so only BytewiseComparator() without user-defined timestamps is
+// supported.
+// @bucket_count: number of buckets of the hash index. Each bucket takes 8
+//                bytes of the memtable's arena.
+extern MemTableRepFactory* NewHashIndexedSkipListRepFactory(
+    size_t bucket_count = 1000000);
+
+// This creates MemTableReps backed by an adaptive radix tree, which finds
+// keys by following their bytes instead of comparing them and stores short
+// keys densely. Only BytewiseComparator() is supported.
+// @concurrent_inserts: if true, writers lock only the tree nodes they change,
+//                      so allow_concurrent_memtable_write can be used.
+//                      Otherwise inserts are a little cheaper but must be
+//                      serialized.
+extern MemTableRepFactory* NewArtRepFactory(bool concurrent_inserts = true);
+
 #endif  // ROCKSDB_LITE
 }  // namespace ROCKSDB_NAMESPACE
@@ -927,6 +927,13 @@ struct DBOptions {
   // Default: false
   bool strict_bytes_per_sync = false;
 
+  // Mask of FlowTraceCategory bits (see rocksdb/flow_trace.h) selecting the
+  // internal code paths that record flow trace events while this DB is
+  // open. Dynamically changeable through SetDBOptions() API.
+  //
+  // Default: 0 (no tracing)
+  uint32_t flow_trace_categories = 0;
+
   // A vector of EventListeners whose callback functions will be called
   // when specific RocksDB event happens.
   std::vector<std::shared_ptr<EventListener>> listeners;
@@ -955,6 +962,22 @@ struct DBOptions {
   // Dynamically changeable through SetDBOptions() API.
   uint64_t delayed_write_rate = 0;
 
+  // If true, writes are not stalled in steps when a column family reaches
+  // level0_slowdown_writes_trigger or soft_pending_compaction_bytes_limit.
+  // Instead, RocksDB keeps estimating, per column family, how fast compaction
+  // is paying off its debt and how fast the number of L0 files and the
+  // pending compaction bytes are growing. When either is predicted to go
+  // above its slowdown threshold within a few seconds, writes are paced at
+  // the rate compaction can sustain, reduced smoothly the further above the
+  // threshold the prediction is. level0_stop_writes_trigger and
+  // hard_pending_compaction_bytes_limit no longer stop writes; reaching them
+  // slows writes to a quarter of the sustainable rate. Stalls because of
+  // max_write_buffer_number are not affected. The paced rate never exceeds
+  // `delayed_write_rate`.
+  //
+  // Default: false
+  bool predictive_write_stall_control = false;
+
   // By default, a single write thread queue is maintained. The thread gets
   // to the head of the queue becomes write batch group leader and responsible
   // for writing to WAL and memtable for the batch group.
@@ -970,6 +993,22 @@ struct DBOptions {
   // Default: false
   bool enable_pipelined_write = false;
 
+  // If true and enable_pipelined_write is true, the WAL write group of a
+  // write with WriteOptions::sync = true does not sync the WAL itself. It
+  // appends its records, hands the sync to a dedicated WAL sync thread and
+  // leaves the WAL writer queue, so that the next write groups can append to
+  // the WAL while the sync is in flight. One sync covers all the groups
+  // appended before it started. The writers of a group still return, and
+  // their writes only become visible, after a sync covering their records
+  // completed, so durability is unchanged. After a failed sync, all sync
+  // writes fail until the DB is reopened.
+  //
+  // Has no effect with manual_wal_flush or if the WAL files do not support
+  // syncing concurrently with appends (FSWritableFile::IsSyncThreadSafe()).
+  //
+  // Default: false
+  bool pipelined_wal_sync = false;
+
   // Setting unordered_write to true trades higher write throughput with
   // relaxing the immutability guarantee of snapshots. This violates the
   // repeatability one expects from ::Get from a snapshot, as well as
@@ -996,9 +1035,32 @@ struct DBOptions {
   // Default: false
   bool unordered_write = false;
 
+  // If greater than 1 and unordered_write is true, writes are spread over
+  // this many WAL streams, each a separate WAL file with its own writer queue,
+  // so that the WAL write groups of different threads can append and sync
+  // concurrently. A write picks its stream by the id of its thread. Sequence
+  // numbers are still allocated from a single counter, and a write only
+  // becomes visible once all writes with lower sequence numbers on any stream
+  // are in the WAL. The streams switch to new files together with the
+  // memtables. Recovery replays the WAL files of all the streams merged by
+  // sequence number, on a single thread, and point-in-time recovery stops at
+  // the first corruption in any of them. Writes that were not synced may be
+  // lost on one stream while later ones on another stream are recovered.
+  //
+  // A DB whose WAL was written with several streams must be reopened with
+  // wal_streams greater than 1 until its memtables are flushed, since the WAL
+  // files are otherwise replayed one after the other.
+  //
+  // Not compatible with two_write_queues, manual_wal_flush, recycled WAL files,
+  // track_and_verify_wals_in_manifest, wal_filter or GetUpdatesSince().
+  //
+  // Default: 1
+  int wal_streams = 1;
+
   // If true, allow multi-writers to update mem tables in parallel.
-  // Only some memtable_factory-s support concurrent writes; currently it
-  // is implemented only for SkipListFactory.  Concurrent memtable writes
+  // Only some memtable_factory-s support concurrent writes, see
+  // MemTableRepFactory::IsInsertConcurrentlySupported(); among the built-in
+  // ones, all but VectorRepFactory do.  Concurrent memtable writes
   // are not compatible with inplace_update_support or filter_deletes.
   // It is strongly recommended to set enable_write_thread_adaptive_yield
   // if you are going to use this feature.
@@ -1006,6 +1068,28 @@ struct DBOptions {
   // Default: true
   bool allow_concurrent_memtable_write = true;
 
+  // With allow_concurrent_memtable_write, a write batch of at least 512KB is
+  // split into ranges of records, at least 256KB each, that are inserted into
+  // the memtables on up to this many threads, the writing thread included.
+  // The sequence numbers of the records are assigned before the split, so
+  // the result is the same as a serial insert. Batches of WritePrepared or
+  // WriteUnprepared transactions, with transaction markers, with merge
+  // operands or with protection_bytes_per_key are never split.
+  //
+  // Default: 1 (disabled)
+  uint32_t max_write_batch_insert_threads = 1;
+
+  // DB::Put of a value at least this large does not copy the value into a
+  // write batch. The WAL record is written from the batch header and the
+  // caller's value, and the memtable entry is encoded from the caller's
+  // value, which saves one copy of the value. The value is still copied if
+  // the write is grouped with other writes for the WAL. Not used with
+  // WritePrepared or WriteUnprepared transactions or with user-defined
+  // timestamps.
+  //
+  // Default: 0 (disabled)
+  size_t zero_copy_put_min_value_size = 0;
+
   // If true, threads synchronizing with the write batch group leader will
   // wait for up to write_thread_max_yield_usec before blocking on a mutex.
   // This can substantially improve throughput for concurrent workloads,
@@ -1021,6 +1105,17 @@ struct DBOptions {
   // Default: 1 MB
   uint64_t max_write_batch_group_size_bytes = 1 << 20;
 
+  // If non-zero, a write group leader also limits the group so that writing
+  // it to the WAL and the memtables is expected to take about this many
+  // microseconds. The expectation is based on the cost per byte observed for
+  // recent groups. A batch that alone exceeds the budget is written as its
+  // own group, so that small writes are not delayed behind it. This trades
+  // throughput for lower tail latency under mixed small and large writes.
+  // The adaptation is reported through the WRITE_GROUP_* statistics.
+  //
+  // Default: 0 (disabled)
+  uint64_t write_batch_group_latency_budget_micros = 0;
+
   // The maximum number of microseconds that a write operation will use
   // a yielding spin loop to coordinate with other write threads before
   // blocking on a mutex.  (Assuming write_thread_slow_yield_usec is
@@ -1062,6 +1157,23 @@ struct DBOptions {
   // Default: kPointInTimeRecovery
   WALRecoveryMode wal_recovery_mode = WALRecoveryMode::kPointInTimeRecovery;
 
+  // Number of threads DB::Open() uses to replay the WAL. If greater than 1,
+  // a reader thread reads and checks the records of each WAL ahead, while
+  // groups of consecutive write batches are inserted into the memtables by
+  // this many threads at once. Write batches carry their sequence numbers,
+  // so the memtables end up the same as with a serial replay.
+  //
+  // Only used if every memtable supports concurrent inserts, none of
+  // allow_2pc, inplace_update_support and max_successive_merges is set and
+  // the DB is not a WritePrepared or WriteUnprepared TransactionDB;
+  // otherwise the WAL is replayed serially.
+  // A write batch that is read and checked but cannot be inserted fails the
+  // recovery, also with kPointInTimeRecovery, since later batches of its
+  // group may already be in the memtables.
+  //
+  // Default: 1
+  int wal_recovery_threads = 1;
+
   // if set to false then recovery will fail when a prepared
   // transaction is encountered in the WAL
   bool allow_2pc = false;
@@ -1146,6 +1258,16 @@ struct DBOptions {
   // file.
   bool manual_wal_flush = false;
 
+  // If not kNoCompression, the records of each WAL file are compressed as one
+  // stream, each record using the previous records of the file as history,
+  // which compresses small records much better than compressing them one by
+  // one. Only kZSTD is supported, in builds with ZSTD 1.4.0 or newer. WAL
+  // files written with compression cannot be read by older RocksDB versions.
+  // Not compatible with recycle_log_file_num > 0.
+  //
+  // Default: kNoCompression
+  CompressionType wal_compression = kNoCompression;
+
   // If true, RocksDB supports flushing multiple column families and committing
   // their results atomically to MANIFEST. Note that it is not
   // necessary to set atomic_flush to true if WAL is always enabled since WAL
@@ -1501,6 +1623,20 @@ struct ReadOptions {
   // Default: std::numeric_limits<uint64_t>::max()
   uint64_t value_size_soft_limit;
 
+  // If true, MultiGet first looks up the filters and indexes of all the SST
+  // files, in all levels, that may contain the keys of the batch, and asks
+  // the file system to prefetch the data blocks that may contain them and
+  // are not in the block cache. The reads of the different files and levels
+  // are then in flight together rather than issued one file after the
+  // other. The lookup then proceeds level by level as usual. This speeds up
+  // MultiGet on data that is not cached, at the cost of reading the blocks
+  // of the lower levels for keys found in upper levels. It has no effect
+  // with direct reads, with read_tier == kBlockCacheTier, or with file
+  // systems that do not implement FSRandomAccessFile::Prefetch().
+  //
+  // Default: false
+  bool optimize_multiget_for_io;
+
   ReadOptions();
   ReadOptions(bool cksum, bool cache);
 };
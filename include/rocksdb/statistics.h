@@ -383,6 +383,25 @@ enum Tickers : uint32_t {
   ERROR_HANDLER_AUTORESUME_RETRY_TOTAL_COUNT,
   ERROR_HANDLER_AUTORESUME_SUCCESS_COUNT,
 
+  // Cost-aware flush selection of a WriteBufferManager (cost_aware_flush).
+  // # of column families picked for flush.
+  WRITE_BUFFER_MANAGER_COST_AWARE_FLUSHES,
+  // # of picks other than the column family with the oldest active memtable.
+  // REQUIRES: <= WRITE_BUFFER_MANAGER_COST_AWARE_FLUSHES
+  WRITE_BUFFER_MANAGER_FLUSHES_NOT_OLDEST,
+  // # of times a DB flushed nothing because the column family picked belongs
+  // to another DB.
+  WRITE_BUFFER_MANAGER_FLUSHES_DEFERRED,
+  // Bytes of the active memtables picked for flush.
+  WRITE_BUFFER_MANAGER_COST_AWARE_FLUSH_BYTES,
+
+  // Latency-bounded write grouping (write_batch_group_latency_budget_micros).
+  // # of write groups cut short by the latency budget.
+  WRITE_GROUP_LATENCY_LIMITED,
+  // # of write groups whose leader batch alone exceeded the latency budget
+  // and was written without followers.
+  WRITE_GROUP_LARGE_BATCH_ALONE,
+
   TICKER_ENUM_MAX
 };
 
@@ -484,6 +503,9 @@ enum Histograms : uint32_t {
   // Error handler statistics
   ERROR_HANDLER_AUTORESUME_RETRY_COUNT,
 
+  // Group size limit in bytes derived from the write group latency budget.
+  WRITE_GROUP_LATENCY_LIMIT_BYTES,
+
   HISTOGRAM_ENUM_MAX,
 };
 
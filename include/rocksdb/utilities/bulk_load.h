@@ -0,0 +1,85 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+//
+// A bulk load session loads key-sorted data into a column family without
+// writing it to the WAL or the memtables. The data is cut into SST files that
+// are built by background threads while more data is added, and all of them
+// are ingested into the column family together when the session finishes.
+
+#pragma once
+#ifndef ROCKSDB_LITE
+
+#include <memory>
+#include <string>
+
+#include "rocksdb/status.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+class ColumnFamilyHandle;
+class DB;
+class WriteBatch;
+
+struct BulkLoadOptions {
+  // Directory the SST files are built in, each session in a subdirectory of
+  // its own. It should be on the same file system as the DB, so that the
+  // files are moved rather than copied into the DB when they are ingested.
+  // Created if missing. Opening a session deletes the files left behind by
+  // the sessions of processes that exited without finishing them.
+  //
+  // Default: empty, meaning the DB directory name followed by ".bulk_load",
+  // next to the DB directory
+  std::string working_dir;
+
+  // The loaded data is cut into SST files of about this many bytes of write
+  // batch data, i.e. before compression. Files are cut between records, also
+  // within the batches passed to Add().
+  //
+  // Default: 64MB
+  uint64_t target_file_size = 64 << 20;
+
+  // Number of background threads building SST files. The data of a file is
+  // kept in memory until it is built, and Add() blocks while this many files
+  // are waiting for a thread, so up to 2 * num_threads + 1 files worth of
+  // data are in memory.
+  //
+  // Default: 2
+  int num_threads = 2;
+};
+
+class BulkLoadSession {
+ public:
+  // Starts a session loading into `column_family` of `db`, or into its
+  // default column family if `column_family` is nullptr.
+  static Status Open(DB* db, ColumnFamilyHandle* column_family,
+                     const BulkLoadOptions& options,
+                     std::unique_ptr<BulkLoadSession>* session);
+
+  // Aborts the session unless Finish() was called.
+  virtual ~BulkLoadSession() {}
+
+  // Adds the Put, Merge and Delete records of `batch`. All records must be
+  // for the session's column family and their keys must be in strictly
+  // increasing order, within the batch and after the keys of the previously
+  // added batches. Otherwise InvalidArgument or NotSupported is returned and
+  // no record of the batch is added. Also returns the error of a failed
+  // background build, after which the session can only be aborted.
+  virtual Status Add(const WriteBatch& batch) = 0;
+
+  // Waits for the remaining SST files to be built and ingests all of them
+  // into the column family with one IngestExternalFile() call, so that
+  // either all or none of the loaded data becomes visible. Each file is
+  // placed in the bottommost level where it does not overlap existing data,
+  // and the loaded records take precedence over existing records with the
+  // same keys. No other call is allowed afterwards.
+  virtual Status Finish() = 0;
+
+  // Stops the background threads and deletes the SST files built so far.
+  // Nothing is loaded. No other call is allowed afterwards.
+  virtual void Abort() = 0;
+};
+
+}  // namespace ROCKSDB_NAMESPACE
+#endif  // !ROCKSDB_LITE
@@ -285,7 +285,9 @@ class WriteBatch : public WriteBatchBase {
   // Retrieve the serialized version of this batch.
   const std::string& Data() const { return rep_; }
 
-  // Retrieve data size of the batch.
+  // Retrieve data size of the batch, which is the size of Data(). A value
+  // referenced by a batch built internally for DB::Put() is not included;
+  // use WriteBatchInternal::ByteSize() for the full size.
   size_t GetDataSize() const { return rep_.size(); }
 
   // Returns the number of updates in the batch
@@ -377,6 +379,11 @@ class WriteBatch : public WriteBatchBase {
 
   std::unique_ptr<ProtectionInfo> prot_info_;
 
+  // Value of the only record of a batch built by
+  // WriteBatchInternal::PutValueRef(), which follows rep_ instead of being
+  // copied into it.
+  const Slice* value_ref_ = nullptr;
+
  protected:
   std::string rep_;  // See comment in write_batch.cc for the format of rep_
   const size_t timestamp_size_;
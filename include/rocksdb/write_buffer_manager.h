@@ -22,6 +22,8 @@
 
 namespace ROCKSDB_NAMESPACE {
 
+class WriteBufferFlushPolicy;
+
 // Interface to block and signal DB instances.
 // Each DB instance contains ptr to StallInterface.
 class StallInterface {
@@ -46,9 +48,21 @@ class WriteBufferManager {
   // allow_stall: if set true, it will enable stalling of writes when
   // memory_usage() exceeds buffer_size. It will wait for flush to complete and
   // memory usage to drop down.
+  //
+  // cost_aware_flush: if set true, when ShouldFlush() returns true the
+  // column family to flush is picked among all column families of all DBs
+  // sharing this manager by a cost model, instead of the one with the oldest
+  // active memtable in the DB that is writing. The model tracks the write
+  // rate, the fraction of entries dropped by recent flushes (overwrites) and
+  // the L0 files, immutable memtables and compaction debt of every column
+  // family, and prefers large, idle memtables whose flush is unlikely to
+  // cause a write stall or to give up absorbing overwrites. A pick of a column
+  // family of another DB is left to that DB's next write. The decisions are
+  // counted by the WRITE_BUFFER_MANAGER_* tickers. Not used with atomic_flush.
   explicit WriteBufferManager(size_t _buffer_size,
                               std::shared_ptr<Cache> cache = {},
-                              bool allow_stall = false);
+                              bool allow_stall = false,
+                              bool cost_aware_flush = false);
   // No copying allowed
   WriteBufferManager(const WriteBufferManager&) = delete;
   WriteBufferManager& operator=(const WriteBufferManager&) = delete;
@@ -62,6 +76,9 @@ class WriteBufferManager {
   // Returns true if pointer to cache is passed.
   bool cost_to_cache() const { return cache_rep_ != nullptr; }
 
+  // Returns true if cost_aware_flush is passed.
+  bool cost_aware_flush() const { return flush_policy_ != nullptr; }
+
   // Returns the total memory used by memtables.
   // Only valid if enabled()
   size_t memory_usage() const {
@@ -157,6 +174,10 @@ class WriteBufferManager {
 
   void RemoveDBFromQueue(StallInterface* wbm_stall);
 
+  // Returns the state of cost-aware flush selection, or nullptr if
+  // cost_aware_flush is not set.
+  WriteBufferFlushPolicy* flush_policy() const { return flush_policy_.get(); }
+
  private:
   std::atomic<size_t> buffer_size_;
   std::atomic<size_t> mutable_limit_;
@@ -171,6 +192,7 @@ class WriteBufferManager {
   std::mutex mu_;
   bool allow_stall_;
   std::atomic<bool> stall_active_;
+  std::unique_ptr<WriteBufferFlushPolicy> flush_policy_;
 
   void ReserveMemWithCache(size_t mem);
   void FreeMemWithCache(size_t mem);
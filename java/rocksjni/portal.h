@@ -4996,6 +4996,19 @@ class TickerTypeJni {
         return -0x1A;
       case ROCKSDB_NAMESPACE::Tickers::ERROR_HANDLER_AUTORESUME_SUCCESS_COUNT:
         return -0x1B;
+      case ROCKSDB_NAMESPACE::Tickers::WRITE_BUFFER_MANAGER_COST_AWARE_FLUSHES:
+        return -0x1C;
+      case ROCKSDB_NAMESPACE::Tickers::WRITE_BUFFER_MANAGER_FLUSHES_NOT_OLDEST:
+        return -0x1D;
+      case ROCKSDB_NAMESPACE::Tickers::WRITE_BUFFER_MANAGER_FLUSHES_DEFERRED:
+        return -0x1E;
+      case ROCKSDB_NAMESPACE::Tickers::
+          WRITE_BUFFER_MANAGER_COST_AWARE_FLUSH_BYTES:
+        return -0x1F;
+      case ROCKSDB_NAMESPACE::Tickers::WRITE_GROUP_LATENCY_LIMITED:
+        return -0x20;
+      case ROCKSDB_NAMESPACE::Tickers::WRITE_GROUP_LARGE_BATCH_ALONE:
+        return -0x21;
       case ROCKSDB_NAMESPACE::Tickers::TICKER_ENUM_MAX:
         // 0x5F for backwards compatibility on current minor version.
         return 0x5F;
@@ -5322,6 +5335,22 @@ class TickerTypeJni {
       case -0x1B:
         return ROCKSDB_NAMESPACE::Tickers::
             ERROR_HANDLER_AUTORESUME_SUCCESS_COUNT;
+      case -0x1C:
+        return ROCKSDB_NAMESPACE::Tickers::
+            WRITE_BUFFER_MANAGER_COST_AWARE_FLUSHES;
+      case -0x1D:
+        return ROCKSDB_NAMESPACE::Tickers::
+            WRITE_BUFFER_MANAGER_FLUSHES_NOT_OLDEST;
+      case -0x1E:
+        return ROCKSDB_NAMESPACE::Tickers::
+            WRITE_BUFFER_MANAGER_FLUSHES_DEFERRED;
+      case -0x1F:
+        return ROCKSDB_NAMESPACE::Tickers::
+            WRITE_BUFFER_MANAGER_COST_AWARE_FLUSH_BYTES;
+      case -0x20:
+        return ROCKSDB_NAMESPACE::Tickers::WRITE_GROUP_LATENCY_LIMITED;
+      case -0x21:
+        return ROCKSDB_NAMESPACE::Tickers::WRITE_GROUP_LARGE_BATCH_ALONE;
       case 0x5F:
         // 0x5F for backwards compatibility on current minor version.
         return ROCKSDB_NAMESPACE::Tickers::TICKER_ENUM_MAX;
@@ -5443,6 +5472,8 @@ class HistogramTypeJni {
         return 0x31;
       case ROCKSDB_NAMESPACE::Histograms::ERROR_HANDLER_AUTORESUME_RETRY_COUNT:
         return 0x31;
+      case ROCKSDB_NAMESPACE::Histograms::WRITE_GROUP_LATENCY_LIMIT_BYTES:
+        return 0x33;
       case ROCKSDB_NAMESPACE::Histograms::HISTOGRAM_ENUM_MAX:
         // 0x1F for backwards compatibility on current minor version.
         return 0x1F;
@@ -5560,6 +5591,8 @@ class HistogramTypeJni {
       case 0x32:
         return ROCKSDB_NAMESPACE::Histograms::
             ERROR_HANDLER_AUTORESUME_RETRY_COUNT;
+      case 0x33:
+        return ROCKSDB_NAMESPACE::Histograms::WRITE_GROUP_LATENCY_LIMIT_BYTES;
       case 0x1F:
         // 0x1F for backwards compatibility on current minor version.
         return ROCKSDB_NAMESPACE::Histograms::HISTOGRAM_ENUM_MAX;
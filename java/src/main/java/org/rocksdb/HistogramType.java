@@ -180,6 +180,11 @@ public enum HistogramType {
    */
   ERROR_HANDLER_AUTORESUME_RETRY_COUNT((byte) 0x32),
 
+  /**
+   * Group size limit in bytes derived from the write group latency budget.
+   */
+  WRITE_GROUP_LATENCY_LIMIT_BYTES((byte) 0x33),
+
   // 0x1F for backwards compatibility on current minor version.
   HISTOGRAM_ENUM_MAX((byte) 0x1F);
 
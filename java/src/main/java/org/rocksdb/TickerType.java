@@ -752,6 +752,20 @@ public enum TickerType {
     ERROR_HANDLER_AUTORESUME_RETRY_TOTAL_COUNT((byte) -0x1A),
     ERROR_HANDLER_AUTORESUME_SUCCESS_COUNT((byte) -0x1B),
 
+    /**
+     * Cost-aware flush selection of a WriteBufferManager statistics
+     */
+    WRITE_BUFFER_MANAGER_COST_AWARE_FLUSHES((byte) -0x1C),
+    WRITE_BUFFER_MANAGER_FLUSHES_NOT_OLDEST((byte) -0x1D),
+    WRITE_BUFFER_MANAGER_FLUSHES_DEFERRED((byte) -0x1E),
+    WRITE_BUFFER_MANAGER_COST_AWARE_FLUSH_BYTES((byte) -0x1F),
+
+    /**
+     * Latency-bounded write grouping statistics
+     */
+    WRITE_GROUP_LATENCY_LIMITED((byte) -0x20),
+    WRITE_GROUP_LARGE_BATCH_ALONE((byte) -0x21),
+
     TICKER_ENUM_MAX((byte) 0x5F);
 
     private final byte value;
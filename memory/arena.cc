@@ -11,6 +11,9 @@
 #ifndef OS_WIN
 #include <sys/mman.h>
 #endif
+#ifdef NUMA
+#include <numaif.h>
+#endif
 #include <algorithm>
 
 #include "logging/logging.h"
@@ -29,6 +32,7 @@ const size_t Arena::kInlineSize;
 
 const size_t Arena::kMinBlockSize = 4096;
 const size_t Arena::kMaxBlockSize = 2u << 30;
+const size_t Arena::kTransparentHugePageSize = 2u << 20;
 static const int kAlignUnit = alignof(max_align_t);
 
 size_t OptimizeBlockSize(size_t block_size) {
@@ -44,8 +48,12 @@ size_t OptimizeBlockSize(size_t block_size) {
   return block_size;
 }
 
-Arena::Arena(size_t block_size, AllocTracker* tracker, size_t huge_page_size)
-    : kBlockSize(OptimizeBlockSize(block_size)), tracker_(tracker) {
+Arena::Arena(size_t block_size, AllocTracker* tracker, size_t huge_page_size,
+             bool transparent_huge_pages, int numa_node)
+    : kBlockSize(OptimizeBlockSize(block_size)),
+      transparent_huge_pages_(transparent_huge_pages),
+      numa_node_(numa_node),
+      tracker_(tracker) {
   assert(kBlockSize >= kMinBlockSize && kBlockSize <= kMaxBlockSize &&
          kBlockSize % kAlignUnit == 0);
   TEST_SYNC_POINT_CALLBACK("Arena::Arena:0", const_cast<size_t*>(&kBlockSize));
@@ -75,7 +83,7 @@ Arena::~Arena() {
     delete[] block;
   }
 
-#ifdef MAP_HUGETLB
+#ifndef OS_WIN
   for (const auto& mmap_info : huge_blocks_) {
     if (mmap_info.addr_ == nullptr) {
       continue;
@@ -200,7 +208,83 @@ char* Arena::AllocateAligned(size_t bytes, size_t huge_page_size,
   return result;
 }
 
+char* Arena::AllocateMappedBlock(size_t block_bytes) {
+#ifndef OS_WIN
+  bool huge = false;
+#ifdef MADV_HUGEPAGE
+  huge = transparent_huge_pages_ && block_bytes % kTransparentHugePageSize == 0;
+#else
+  (void)transparent_huge_pages_;
+#endif
+  bool bind = false;
+#ifdef NUMA
+  bind = numa_node_ >= 0 &&
+         numa_node_ < static_cast<int>(sizeof(unsigned long) * 8);
+#endif
+  if (!huge && !bind) {
+    return nullptr;
+  }
+  // Reserve space in `huge_blocks_` before calling `mmap`, see
+  // AllocateFromHugePage().
+  huge_blocks_.emplace_back(nullptr /* addr */, 0 /* length */);
+
+  // Map an extra huge page so that the block can start at a huge page
+  // boundary, and unmap what is left on both sides.
+  const size_t map_bytes =
+      huge ? block_bytes + kTransparentHugePageSize : block_bytes;
+  void* addr = mmap(nullptr, map_bytes, (PROT_READ | PROT_WRITE),
+                    (MAP_PRIVATE | MAP_ANONYMOUS), -1, 0);
+  if (addr == MAP_FAILED) {
+    huge_blocks_.pop_back();
+    return nullptr;
+  }
+  char* block = reinterpret_cast<char*>(addr);
+#ifdef MADV_HUGEPAGE
+  if (huge) {
+    const uintptr_t start = reinterpret_cast<uintptr_t>(addr);
+    const uintptr_t aligned = (start + kTransparentHugePageSize - 1) &
+                              ~(uintptr_t{kTransparentHugePageSize} - 1);
+    const size_t head = aligned - start;
+    const size_t tail = map_bytes - head - block_bytes;
+    block = reinterpret_cast<char*>(aligned);
+    if (head > 0) {
+      munmap(addr, head);
+    }
+    if (tail > 0) {
+      munmap(block + block_bytes, tail);
+    }
+    // Failing to advise only costs the huge pages.
+    madvise(block, block_bytes, MADV_HUGEPAGE);
+  }
+#endif  // MADV_HUGEPAGE
+#ifdef NUMA
+  if (bind) {
+    // Pages are allocated on first touch, so the preference applies to the
+    // whole block. Failing to bind only costs the locality.
+    unsigned long nodemask = 1UL << numa_node_;
+    mbind(block, block_bytes, MPOL_PREFERRED, &nodemask,
+          sizeof(nodemask) * 8, 0);
+  }
+#endif  // NUMA
+  huge_blocks_.back() = MmapInfo(block, block_bytes);
+  blocks_memory_ += block_bytes;
+  if (tracker_ != nullptr) {
+    tracker_->Allocate(block_bytes);
+  }
+  return block;
+#else
+  (void)block_bytes;
+  (void)transparent_huge_pages_;
+  return nullptr;
+#endif  // OS_WIN
+}
+
 char* Arena::AllocateNewBlock(size_t block_bytes) {
+  char* mapped = AllocateMappedBlock(block_bytes);
+  if (mapped != nullptr) {
+    return mapped;
+  }
+
   // Reserve space in `blocks_` before allocating memory via new.
   // Use `emplace_back()` instead of `reserve()` to let std::vector manage its
   // own memory and do fewer reallocations.
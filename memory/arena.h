@@ -34,12 +34,21 @@ class Arena : public Allocator {
   static const size_t kInlineSize = 2048;
   static const size_t kMinBlockSize;
   static const size_t kMaxBlockSize;
+  static const size_t kTransparentHugePageSize;
 
   // huge_page_size: if 0, don't use huge page TLB. If > 0 (should set to the
   // supported hugepage size of the system), block allocation will try huge
   // page TLB first. If allocation fails, will fall back to normal case.
+  // transparent_huge_pages: if true, blocks whose size is a multiple of
+  // kTransparentHugePageSize are mapped at a huge page boundary and advised
+  // to be backed by transparent huge pages. If mapping fails, will fall back
+  // to normal case.
+  // numa_node: if >= 0, blocks are mapped with a preference for the memory
+  // of that NUMA node, which falls back to other nodes when it is exhausted.
+  // Only takes effect when built with NUMA support.
   explicit Arena(size_t block_size = kMinBlockSize,
-                 AllocTracker* tracker = nullptr, size_t huge_page_size = 0);
+                 AllocTracker* tracker = nullptr, size_t huge_page_size = 0,
+                 bool transparent_huge_pages = false, int numa_node = -1);
   ~Arena();
 
   char* Allocate(size_t bytes) override;
@@ -81,6 +90,9 @@ class Arena : public Allocator {
     return blocks_.empty();
   }
 
+  // The NUMA node the arena's blocks prefer, or -1 if none.
+  int numa_node() const { return numa_node_; }
+
  private:
   char inline_block_[kInlineSize] __attribute__((__aligned__(alignof(max_align_t))));
   // Number of bytes allocated in one block
@@ -111,9 +123,14 @@ class Arena : public Allocator {
 #ifdef MAP_HUGETLB
   size_t hugetlb_size_ = 0;
 #endif  // MAP_HUGETLB
+  const bool transparent_huge_pages_;
+  const int numa_node_;
   char* AllocateFromHugePage(size_t bytes);
   char* AllocateFallback(size_t bytes, bool aligned);
   char* AllocateNewBlock(size_t block_bytes);
+  // Maps a block backed by transparent huge pages or bound to numa_node_,
+  // or returns nullptr if neither applies or the mapping fails.
+  char* AllocateMappedBlock(size_t block_bytes);
 
   // Bytes of memory in blocks allocated so far
   size_t blocks_memory_ = 0;
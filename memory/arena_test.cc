@@ -196,6 +196,32 @@ TEST_F(ArenaTest, Simple) {
   SimpleTest(0);
   SimpleTest(kHugePageSize);
 }
+
+TEST_F(ArenaTest, TransparentHugePages) {
+  const size_t kBlockSize = Arena::kTransparentHugePageSize;
+  Arena arena(kBlockSize, nullptr /* tracker */, 0 /* huge_page_size */,
+              true /* transparent_huge_pages */);
+  ASSERT_EQ(arena.MemoryAllocatedBytes(), Arena::kInlineSize);
+
+  // Exhaust the inline block so that the next allocation needs a block.
+  arena.AllocateAligned(Arena::kInlineSize);
+  char* p = arena.AllocateAligned(4096);
+  ASSERT_NE(p, nullptr);
+  memset(p, 0xab, 4096);
+  ASSERT_EQ(arena.MemoryAllocatedBytes(), Arena::kInlineSize + kBlockSize);
+#if !defined(OS_WIN) && defined(MADV_HUGEPAGE)
+  // The block was mapped at a huge page boundary.
+  ASSERT_EQ(reinterpret_cast<uintptr_t>(p) % Arena::kTransparentHugePageSize,
+            0u);
+#endif
+
+  // Allocations keep being served from the mapped block.
+  for (int i = 0; i < 100; ++i) {
+    char* q = arena.Allocate(1000);
+    memset(q, i, 1000);
+  }
+  ASSERT_EQ(arena.MemoryAllocatedBytes(), Arena::kInlineSize + kBlockSize);
+}
 }  // namespace ROCKSDB_NAMESPACE
 
 int main(int argc, char** argv) {
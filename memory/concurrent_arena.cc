@@ -8,6 +8,9 @@
 // found in the LICENSE file. See the AUTHORS file for names of contributors.
 
 #include "memory/concurrent_arena.h"
+#ifdef NUMA
+#include <numa.h>
+#endif
 #include <thread>
 #include "port/port.h"
 #include "util/random.h"
@@ -27,13 +30,52 @@ const size_t kMaxShardBlockSize = size_t{128 * 1024};
 }  // namespace
 
 ConcurrentArena::ConcurrentArena(size_t block_size, AllocTracker* tracker,
-                                 size_t huge_page_size)
+                                 size_t huge_page_size,
+                                 bool transparent_huge_pages, bool numa_aware)
     : shard_block_size_(std::min(kMaxShardBlockSize, block_size / 8)),
       shards_(),
-      arena_(block_size, tracker, huge_page_size) {
+      arena_(block_size, tracker, huge_page_size, transparent_huge_pages) {
+#ifdef NUMA
+  if (numa_aware && numa_available() != -1 && numa_max_node() > 0) {
+    const int num_nodes = numa_max_node() + 1;
+    for (int node = 0; node < num_nodes; ++node) {
+      numa_arenas_.emplace_back(new NumaArena(block_size, tracker,
+                                              transparent_huge_pages, node));
+    }
+    // Shard i is used by core i (see CoreLocalArray), so it takes its
+    // blocks from the arena of that core's node.
+    for (size_t i = 0; i < shards_.Size(); ++i) {
+      const int node = numa_node_of_cpu(static_cast<int>(i));
+      if (node >= 0 && node < num_nodes) {
+        shards_.AccessAtCore(i)->numa_arena_ = numa_arenas_[node].get();
+      }
+    }
+  }
+#else
+  (void)numa_aware;
+#endif  // NUMA
   Fixup();
 }
 
+void ConcurrentArena::ApproximateMemoryUsageByNumaNode(
+    std::vector<size_t>* usage) const {
+  usage->assign(numa_arenas_.size(), 0);
+  for (size_t node = 0; node < numa_arenas_.size(); ++node) {
+    std::lock_guard<SpinMutex> lock(numa_arenas_[node]->mutex);
+    (*usage)[node] = numa_arenas_[node]->arena.ApproximateMemoryUsage();
+  }
+  for (size_t i = 0; i < shards_.Size(); ++i) {
+    const Shard* s = shards_.AccessAtCore(i);
+    if (s->numa_arena_ != nullptr) {
+      const size_t node =
+          static_cast<size_t>(s->numa_arena_->arena.numa_node());
+      const size_t unused =
+          s->allocated_and_unused_.load(std::memory_order_relaxed);
+      (*usage)[node] -= std::min((*usage)[node], unused);
+    }
+  }
+}
+
 ConcurrentArena::Shard* ConcurrentArena::Repick() {
   auto shard_and_index = shards_.AccessElementAndIndex();
 #ifdef ROCKSDB_SUPPORT_THREAD_LOCAL
@@ -11,6 +11,7 @@
 #include <atomic>
 #include <memory>
 #include <utility>
+#include <vector>
 #include "memory/allocator.h"
 #include "memory/arena.h"
 #include "port/lang.h"
@@ -40,13 +41,18 @@ class Logger;
 // shard blocks are allocated from the underlying main arena.
 class ConcurrentArena : public Allocator {
  public:
-  // block_size and huge_page_size are the same as for Arena (and are
-  // in fact just passed to the constructor of arena_.  The core-local
-  // shards compute their shard_block_size as a fraction of block_size
-  // that varies according to the hardware concurrency level.
+  // block_size, huge_page_size and transparent_huge_pages are the same as
+  // for Arena (and are in fact just passed to the constructor of arena_.
+  // The core-local shards compute their shard_block_size as a fraction of
+  // block_size that varies according to the hardware concurrency level.
+  // If numa_aware is true, built with NUMA support and running on more than
+  // one NUMA node, the shards of the cores of each node take their blocks
+  // from an arena whose memory prefers that node, instead of from arena_.
   explicit ConcurrentArena(size_t block_size = Arena::kMinBlockSize,
                            AllocTracker* tracker = nullptr,
-                           size_t huge_page_size = 0);
+                           size_t huge_page_size = 0,
+                           bool transparent_huge_pages = false,
+                           bool numa_aware = false);
 
   char* Allocate(size_t bytes) override {
     return AllocateImpl(bytes, false /*force_arena*/,
@@ -67,18 +73,33 @@ class ConcurrentArena : public Allocator {
   }
 
   size_t ApproximateMemoryUsage() const {
+    size_t usage = NumaArenasMemoryUsage();
     std::unique_lock<SpinMutex> lock(arena_mutex_, std::defer_lock);
     lock.lock();
-    return arena_.ApproximateMemoryUsage() - ShardAllocatedAndUnused();
+    return usage + arena_.ApproximateMemoryUsage() - ShardAllocatedAndUnused();
   }
 
+  // Sets (*usage)[n] to the approximate memory usage of the blocks that
+  // prefer NUMA node n. Clears *usage if the arena is not NUMA-aware.
+  void ApproximateMemoryUsageByNumaNode(std::vector<size_t>* usage) const;
+
   size_t MemoryAllocatedBytes() const {
-    return memory_allocated_bytes_.load(std::memory_order_relaxed);
+    size_t total = memory_allocated_bytes_.load(std::memory_order_relaxed);
+    for (const auto& numa_arena : numa_arenas_) {
+      total +=
+          numa_arena->memory_allocated_bytes.load(std::memory_order_relaxed);
+    }
+    return total;
   }
 
   size_t AllocatedAndUnused() const {
-    return arena_allocated_and_unused_.load(std::memory_order_relaxed) +
-           ShardAllocatedAndUnused();
+    size_t total = arena_allocated_and_unused_.load(std::memory_order_relaxed) +
+                   ShardAllocatedAndUnused();
+    for (const auto& numa_arena : numa_arenas_) {
+      total +=
+          numa_arena->allocated_and_unused.load(std::memory_order_relaxed);
+    }
+    return total;
   }
 
   size_t IrregularBlockNum() const {
@@ -88,13 +109,31 @@ class ConcurrentArena : public Allocator {
   size_t BlockSize() const override { return arena_.BlockSize(); }
 
  private:
+  // The blocks of the shards of one NUMA node.
+  struct NumaArena {
+    NumaArena(size_t block_size, AllocTracker* tracker,
+              bool transparent_huge_pages, int numa_node)
+        : arena(block_size, tracker, 0 /* huge_page_size */,
+                transparent_huge_pages, numa_node),
+          allocated_and_unused(0),
+          memory_allocated_bytes(0) {}
+
+    mutable SpinMutex mutex;
+    Arena arena;
+    std::atomic<size_t> allocated_and_unused;
+    std::atomic<size_t> memory_allocated_bytes;
+  };
+
   struct Shard {
-    char padding[40] ROCKSDB_FIELD_UNUSED;
+    char padding[32] ROCKSDB_FIELD_UNUSED;
     mutable SpinMutex mutex;
     char* free_begin_;
     std::atomic<size_t> allocated_and_unused_;
+    // Where the shard gets its blocks from, or nullptr for arena_.
+    NumaArena* numa_arena_;
 
-    Shard() : free_begin_(nullptr), allocated_and_unused_(0) {}
+    Shard()
+        : free_begin_(nullptr), allocated_and_unused_(0), numa_arena_(nullptr) {}
   };
 
 #ifdef ROCKSDB_SUPPORT_THREAD_LOCAL
@@ -115,10 +154,22 @@ class ConcurrentArena : public Allocator {
   std::atomic<size_t> memory_allocated_bytes_;
   std::atomic<size_t> irregular_block_num_;
 
+  // Indexed by NUMA node. Empty unless NUMA-aware.
+  std::vector<std::unique_ptr<NumaArena>> numa_arenas_;
+
   char padding1[56] ROCKSDB_FIELD_UNUSED;
 
   Shard* Repick();
 
+  size_t NumaArenasMemoryUsage() const {
+    size_t total = 0;
+    for (const auto& numa_arena : numa_arenas_) {
+      std::lock_guard<SpinMutex> lock(numa_arena->mutex);
+      total += numa_arena->arena.ApproximateMemoryUsage();
+    }
+    return total;
+  }
+
   size_t ShardAllocatedAndUnused() const {
     size_t total = 0;
     for (size_t i = 0; i < shards_.Size(); ++i) {
@@ -159,7 +210,17 @@ class ConcurrentArena : public Allocator {
     std::unique_lock<SpinMutex> lock(s->mutex, std::adopt_lock);
 
     size_t avail = s->allocated_and_unused_.load(std::memory_order_relaxed);
-    if (avail < bytes) {
+    if (avail < bytes && s->numa_arena_ != nullptr) {
+      // reload from the arena of the shard's NUMA node
+      NumaArena* numa_arena = s->numa_arena_;
+      std::lock_guard<SpinMutex> reload_lock(numa_arena->mutex);
+      avail = shard_block_size_;
+      s->free_begin_ = numa_arena->arena.AllocateAligned(avail);
+      numa_arena->allocated_and_unused.store(
+          numa_arena->arena.AllocatedAndUnused(), std::memory_order_relaxed);
+      numa_arena->memory_allocated_bytes.store(
+          numa_arena->arena.MemoryAllocatedBytes(), std::memory_order_relaxed);
+    } else if (avail < bytes) {
       // reload
       std::lock_guard<SpinMutex> reload_lock(arena_mutex_);
 
@@ -0,0 +1,761 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+//
+// An Adaptive Radix Tree (Leis et al., ICDE 2013) memtable. Inner nodes
+// grow through 4, 16, 48 and 256 children as keys are added, compress
+// single-child paths into a prefix, and store a leaf as soon as its key is
+// unique below the node (lazy expansion). Lookups follow one node per key
+// byte instead of comparing keys.
+//
+// Readers never lock. A node is never modified in a way that a concurrent
+// reader could observe half done: children are added by publishing a fully
+// written slot, and a node whose prefix or capacity must change is copied
+// and the copy swapped into its parent. With concurrent inserts, writers
+// follow ROWEX (read-optimized write exclusion): a writer locks the nodes
+// it changes, parent before child, and restarts from the root if a node
+// turned obsolete or changed since it was traversed.
+
+#ifndef ROCKSDB_LITE
+#include "memtable/art_rep.h"
+
+#include <assert.h>
+#include <string.h>
+
+#include <algorithm>
+#include <atomic>
+#include <string>
+
+#include "db/dbformat.h"
+#include "memory/arena.h"
+#include "port/port.h"
+#include "rocksdb/memtablerep.h"
+#include "rocksdb/slice.h"
+#include "util/coding.h"
+
+namespace ROCKSDB_NAMESPACE {
+namespace {
+
+// The tree orders entries by the bytes of their tree key, which re-encodes
+// an internal key so that memcmp() order matches InternalKeyComparator
+// order over BytewiseComparator: every 0x00 in the user key becomes
+// 0x00 0xff, the user key is terminated by 0x00 0x00, and the 7-byte
+// sequence number follows inverted and big-endian so that newer entries
+// come first. Like the memtable's comparator, it leaves out the value type,
+// so entries that differ only in type are duplicates. No tree key is a
+// prefix of another.
+const int kSequenceBytes = 7;
+
+size_t TreeKeyLength(const Slice& internal_key) {
+  Slice user_key = ExtractUserKey(internal_key);
+  size_t zeros = std::count(user_key.data(), user_key.data() + user_key.size(),
+                            '\0');
+  return user_key.size() + zeros + 2 + kSequenceBytes;
+}
+
+void EncodeTreeKey(const Slice& internal_key, uint8_t* dst) {
+  Slice user_key = ExtractUserKey(internal_key);
+  for (size_t i = 0; i < user_key.size(); i++) {
+    *dst++ = static_cast<uint8_t>(user_key[i]);
+    if (user_key[i] == '\0') {
+      *dst++ = 0xff;
+    }
+  }
+  *dst++ = 0;
+  *dst++ = 0;
+  uint64_t seq = ~(ExtractInternalKeyFooter(internal_key) >> 8);
+  for (int shift = 8 * (kSequenceBytes - 1); shift >= 0; shift -= 8) {
+    *dst++ = static_cast<uint8_t>(seq >> shift);
+  }
+}
+
+void EncodeTreeKey(const Slice& internal_key, std::string* dst) {
+  dst->resize(TreeKeyLength(internal_key));
+  EncodeTreeKey(internal_key, reinterpret_cast<uint8_t*>(&(*dst)[0]));
+}
+
+class ArtRep : public MemTableRep {
+ public:
+  ArtRep(Allocator* allocator, bool concurrent_inserts);
+
+  void Insert(KeyHandle handle) override { InsertKey(handle); }
+
+  bool InsertKey(KeyHandle handle) override;
+
+  void InsertConcurrently(KeyHandle handle) override {
+    InsertKeyConcurrently(handle);
+  }
+
+  bool InsertKeyConcurrently(KeyHandle handle) override {
+    assert(concurrent_inserts_);
+    return InsertKey(handle);
+  }
+
+  bool Contains(const char* key) const override;
+
+  size_t ApproximateMemoryUsage() override {
+    // All memory is allocated through allocator; nothing to report here
+    return 0;
+  }
+
+  void Get(const LookupKey& k, void* callback_args,
+           bool (*callback_func)(void* arg, const char* entry)) override;
+
+  ~ArtRep() override {}
+
+  MemTableRep::Iterator* GetIterator(Arena* arena = nullptr) override;
+
+ private:
+  // Children are tagged pointers: a Leaf if the low bit is set, a Node
+  // otherwise, and absent if 0.
+  static const uintptr_t kLeafTag = 1;
+
+  struct Leaf {
+    // The memtable entry.
+    const char* entry;
+    uint32_t key_size;
+    // Followed by the key_size bytes of the tree key.
+    const uint8_t* key() const {
+      return reinterpret_cast<const uint8_t*>(this + 1);
+    }
+  };
+
+  enum NodeType : uint8_t { kNode4, kNode16, kNode48, kNode256 };
+
+  struct Node {
+    NodeType type;
+    // Only taken with concurrent inserts.
+    std::atomic<bool> locked;
+    // Set under the lock when the node has been replaced by a copy. Readers
+    // may still traverse it, but writers must not change it any more.
+    bool obsolete;
+    // The compressed path: the bytes after the parent's child byte that all
+    // keys below the node share. Points into the key of one of their leaves.
+    uint32_t prefix_len;
+    const uint8_t* prefix;
+  };
+
+  // Node4 and Node16. Children are appended unsorted and `count` is
+  // published last, so readers only ever see fully written slots.
+  template <uint8_t kCapacity>
+  struct SmallNode : Node {
+    std::atomic<uint8_t> count;
+    uint8_t keys[kCapacity];
+    std::atomic<uintptr_t> children[kCapacity];
+  };
+  typedef SmallNode<4> Node4;
+  typedef SmallNode<16> Node16;
+
+  struct Node48 : Node {
+    std::atomic<uint8_t> count;
+    // One more than the slot in `children` of each key byte, or 0.
+    std::atomic<uint8_t> child_index[256];
+    std::atomic<uintptr_t> children[48];
+  };
+
+  struct Node256 : Node {
+    std::atomic<uintptr_t> children[256];
+  };
+
+  class Iterator : public MemTableRep::Iterator {
+   public:
+    explicit Iterator(const ArtRep* rep) : rep_(rep), leaf_(nullptr) {}
+
+    bool Valid() const override { return leaf_ != nullptr; }
+
+    const char* key() const override {
+      assert(Valid());
+      return leaf_->entry;
+    }
+
+    void Next() override {
+      assert(Valid());
+      leaf_ = LowerBound(rep_->Root(), leaf_->key(), leaf_->key_size, 0,
+                         true /* strict */);
+    }
+
+    void Prev() override {
+      assert(Valid());
+      leaf_ = Floor(rep_->Root(), leaf_->key(), leaf_->key_size, 0,
+                    true /* strict */);
+    }
+
+    void Seek(const Slice& internal_key, const char* memtable_key) override {
+      EncodeTreeKey(memtable_key != nullptr
+                        ? GetLengthPrefixedSlice(memtable_key)
+                        : internal_key,
+                    &tmp_);
+      leaf_ = LowerBound(rep_->Root(), Data(tmp_), tmp_.size(), 0,
+                         false /* strict */);
+    }
+
+    void SeekForPrev(const Slice& internal_key,
+                     const char* memtable_key) override {
+      EncodeTreeKey(memtable_key != nullptr
+                        ? GetLengthPrefixedSlice(memtable_key)
+                        : internal_key,
+                    &tmp_);
+      leaf_ =
+          Floor(rep_->Root(), Data(tmp_), tmp_.size(), 0, false /* strict */);
+    }
+
+    void SeekToFirst() override { leaf_ = Min(rep_->Root()); }
+
+    void SeekToLast() override { leaf_ = Max(rep_->Root()); }
+
+   private:
+    const ArtRep* rep_;
+    const Leaf* leaf_;
+    std::string tmp_;  // For passing to EncodeTreeKey
+  };
+
+  enum InsertResult { kInserted, kDuplicate, kRestart };
+
+  static bool IsLeaf(uintptr_t child) { return (child & kLeafTag) != 0; }
+
+  static const Leaf* AsLeaf(uintptr_t child) {
+    return reinterpret_cast<const Leaf*>(child & ~kLeafTag);
+  }
+
+  static Node* AsNode(uintptr_t child) {
+    return reinterpret_cast<Node*>(child);
+  }
+
+  static const uint8_t* Data(const std::string& s) {
+    return reinterpret_cast<const uint8_t*>(s.data());
+  }
+
+  uintptr_t Root() const { return reinterpret_cast<uintptr_t>(root_); }
+
+  // Returns the child for key byte `b`, or 0.
+  static uintptr_t FindChild(const Node* node, uint8_t b);
+  // Returns the child of the smallest key byte >= `from`, or 0.
+  static uintptr_t NextChild(const Node* node, int from);
+  // Returns the child of the largest key byte <= `to`, or 0.
+  static uintptr_t PrevChild(const Node* node, int to);
+
+  // The leaf with the smallest (largest) key below `child`, or nullptr.
+  static const Leaf* Min(uintptr_t child);
+  static const Leaf* Max(uintptr_t child);
+
+  // Returns the leaf with the smallest key >= `key` (> if `strict`) below
+  // `child`, whose keys all share the first `depth` bytes of `key`.
+  static const Leaf* LowerBound(uintptr_t child, const uint8_t* key,
+                                size_t key_size, size_t depth, bool strict);
+  // Returns the leaf with the largest key <= `key` (< if `strict`).
+  static const Leaf* Floor(uintptr_t child, const uint8_t* key,
+                           size_t key_size, size_t depth, bool strict);
+
+  static int CompareLeaf(const Leaf* leaf, const uint8_t* key,
+                         size_t key_size) {
+    int r = memcmp(leaf->key(), key, std::min<size_t>(leaf->key_size, key_size));
+    if (r == 0) {
+      r = (leaf->key_size < key_size) ? -1 : (leaf->key_size > key_size);
+    }
+    return r;
+  }
+
+  template <class SmallNodeType>
+  static uintptr_t FindSmallChild(const SmallNodeType* node, uint8_t b);
+  template <class SmallNodeType>
+  static uintptr_t NextSmallChild(const SmallNodeType* node, int from);
+  template <class SmallNodeType>
+  static uintptr_t PrevSmallChild(const SmallNodeType* node, int to);
+  template <class SmallNodeType>
+  static void AddSmallChild(SmallNodeType* node, uint8_t b, uintptr_t child);
+  template <class SmallNodeType>
+  static void ReplaceSmallChild(SmallNodeType* node, uint8_t b,
+                                uintptr_t child);
+
+  // Writers only: the caller holds the node's lock or inserts are not
+  // concurrent.
+  static bool IsFull(const Node* node);
+  static void AddChild(Node* node, uint8_t b, uintptr_t child);
+  static void ReplaceChild(Node* node, uint8_t b, uintptr_t child);
+
+  Node* NewNode(NodeType type, const uint8_t* prefix, size_t prefix_len);
+  // Returns a new node of `type` with the children of `node`.
+  Node* CopyNode(const Node* node, NodeType type, const uint8_t* prefix,
+                 size_t prefix_len);
+
+  void Lock(Node* node) {
+    if (concurrent_inserts_) {
+      while (node->locked.exchange(true, std::memory_order_acquire)) {
+        port::AsmVolatilePause();
+      }
+    }
+  }
+
+  void Unlock(Node* node) {
+    if (concurrent_inserts_) {
+      node->locked.store(false, std::memory_order_release);
+    }
+  }
+
+  InsertResult TryInsert(uintptr_t leaf_child);
+
+  const bool concurrent_inserts_;
+  // A Node256 with an empty prefix, so it never needs to be replaced.
+  Node* const root_;
+};
+
+ArtRep::ArtRep(Allocator* allocator, bool concurrent_inserts)
+    : MemTableRep(allocator),
+      concurrent_inserts_(concurrent_inserts),
+      root_(NewNode(kNode256, nullptr, 0)) {}
+
+ArtRep::Node* ArtRep::NewNode(NodeType type, const uint8_t* prefix,
+                              size_t prefix_len) {
+  // Value-initialization zeroes the children and counts.
+  Node* node = nullptr;
+  switch (type) {
+    case kNode4:
+      node = new (allocator_->AllocateAligned(sizeof(Node4))) Node4();
+      break;
+    case kNode16:
+      node = new (allocator_->AllocateAligned(sizeof(Node16))) Node16();
+      break;
+    case kNode48:
+      node = new (allocator_->AllocateAligned(sizeof(Node48))) Node48();
+      break;
+    case kNode256:
+      node = new (allocator_->AllocateAligned(sizeof(Node256))) Node256();
+      break;
+  }
+  node->type = type;
+  node->locked.store(false, std::memory_order_relaxed);
+  node->obsolete = false;
+  node->prefix_len = static_cast<uint32_t>(prefix_len);
+  node->prefix = prefix;
+  return node;
+}
+
+ArtRep::Node* ArtRep::CopyNode(const Node* node, NodeType type,
+                               const uint8_t* prefix, size_t prefix_len) {
+  Node* copy = NewNode(type, prefix, prefix_len);
+  for (int b = 0; b < 256; b++) {
+    uintptr_t child = FindChild(node, static_cast<uint8_t>(b));
+    if (child != 0) {
+      AddChild(copy, static_cast<uint8_t>(b), child);
+    }
+  }
+  return copy;
+}
+
+template <class SmallNodeType>
+uintptr_t ArtRep::FindSmallChild(const SmallNodeType* node, uint8_t b) {
+  uint8_t count = node->count.load(std::memory_order_acquire);
+  for (uint8_t i = 0; i < count; i++) {
+    if (node->keys[i] == b) {
+      return node->children[i].load(std::memory_order_acquire);
+    }
+  }
+  return 0;
+}
+
+template <class SmallNodeType>
+void ArtRep::AddSmallChild(SmallNodeType* node, uint8_t b, uintptr_t child) {
+  uint8_t count = node->count.load(std::memory_order_relaxed);
+  node->keys[count] = b;
+  node->children[count].store(child, std::memory_order_relaxed);
+  node->count.store(count + 1, std::memory_order_release);
+}
+
+template <class SmallNodeType>
+void ArtRep::ReplaceSmallChild(SmallNodeType* node, uint8_t b,
+                               uintptr_t child) {
+  uint8_t count = node->count.load(std::memory_order_relaxed);
+  for (uint8_t i = 0; i < count; i++) {
+    if (node->keys[i] == b) {
+      node->children[i].store(child, std::memory_order_release);
+      return;
+    }
+  }
+  assert(false);
+}
+
+uintptr_t ArtRep::FindChild(const Node* node, uint8_t b) {
+  switch (node->type) {
+    case kNode4:
+      return FindSmallChild(static_cast<const Node4*>(node), b);
+    case kNode16:
+      return FindSmallChild(static_cast<const Node16*>(node), b);
+    case kNode48: {
+      auto n = static_cast<const Node48*>(node);
+      uint8_t index = n->child_index[b].load(std::memory_order_acquire);
+      return index == 0 ? 0
+                        : n->children[index - 1].load(std::memory_order_acquire);
+    }
+    case kNode256:
+      return static_cast<const Node256*>(node)->children[b].load(
+          std::memory_order_acquire);
+  }
+  return 0;
+}
+
+template <class SmallNodeType>
+uintptr_t ArtRep::NextSmallChild(const SmallNodeType* node, int from) {
+  uint8_t count = node->count.load(std::memory_order_acquire);
+  int best = 256;
+  uint8_t best_slot = 0;
+  for (uint8_t i = 0; i < count; i++) {
+    if (node->keys[i] >= from && node->keys[i] < best) {
+      best = node->keys[i];
+      best_slot = i;
+    }
+  }
+  return best == 256 ? 0
+                     : node->children[best_slot].load(std::memory_order_acquire);
+}
+
+template <class SmallNodeType>
+uintptr_t ArtRep::PrevSmallChild(const SmallNodeType* node, int to) {
+  uint8_t count = node->count.load(std::memory_order_acquire);
+  int best = -1;
+  uint8_t best_slot = 0;
+  for (uint8_t i = 0; i < count; i++) {
+    if (node->keys[i] <= to && node->keys[i] > best) {
+      best = node->keys[i];
+      best_slot = i;
+    }
+  }
+  return best == -1 ? 0
+                    : node->children[best_slot].load(std::memory_order_acquire);
+}
+
+uintptr_t ArtRep::NextChild(const Node* node, int from) {
+  if (node->type == kNode4) {
+    return NextSmallChild(static_cast<const Node4*>(node), from);
+  } else if (node->type == kNode16) {
+    return NextSmallChild(static_cast<const Node16*>(node), from);
+  }
+  for (int b = from; b < 256; b++) {
+    uintptr_t child = FindChild(node, static_cast<uint8_t>(b));
+    if (child != 0) {
+      return child;
+    }
+  }
+  return 0;
+}
+
+uintptr_t ArtRep::PrevChild(const Node* node, int to) {
+  if (node->type == kNode4) {
+    return PrevSmallChild(static_cast<const Node4*>(node), to);
+  } else if (node->type == kNode16) {
+    return PrevSmallChild(static_cast<const Node16*>(node), to);
+  }
+  for (int b = to; b >= 0; b--) {
+    uintptr_t child = FindChild(node, static_cast<uint8_t>(b));
+    if (child != 0) {
+      return child;
+    }
+  }
+  return 0;
+}
+
+bool ArtRep::IsFull(const Node* node) {
+  switch (node->type) {
+    case kNode4:
+      return static_cast<const Node4*>(node)->count.load(
+                 std::memory_order_relaxed) == 4;
+    case kNode16:
+      return static_cast<const Node16*>(node)->count.load(
+                 std::memory_order_relaxed) == 16;
+    case kNode48:
+      return static_cast<const Node48*>(node)->count.load(
+                 std::memory_order_relaxed) == 48;
+    case kNode256:
+      return false;
+  }
+  return false;
+}
+
+void ArtRep::AddChild(Node* node, uint8_t b, uintptr_t child) {
+  assert(!IsFull(node));
+  switch (node->type) {
+    case kNode4:
+      AddSmallChild(static_cast<Node4*>(node), b, child);
+      break;
+    case kNode16:
+      AddSmallChild(static_cast<Node16*>(node), b, child);
+      break;
+    case kNode48: {
+      auto n = static_cast<Node48*>(node);
+      uint8_t count = n->count.load(std::memory_order_relaxed);
+      n->children[count].store(child, std::memory_order_relaxed);
+      n->count.store(count + 1, std::memory_order_relaxed);
+      n->child_index[b].store(count + 1, std::memory_order_release);
+      break;
+    }
+    case kNode256:
+      static_cast<Node256*>(node)->children[b].store(
+          child, std::memory_order_release);
+      break;
+  }
+}
+
+void ArtRep::ReplaceChild(Node* node, uint8_t b, uintptr_t child) {
+  switch (node->type) {
+    case kNode4:
+      ReplaceSmallChild(static_cast<Node4*>(node), b, child);
+      break;
+    case kNode16:
+      ReplaceSmallChild(static_cast<Node16*>(node), b, child);
+      break;
+    case kNode48: {
+      auto n = static_cast<Node48*>(node);
+      uint8_t index = n->child_index[b].load(std::memory_order_relaxed);
+      assert(index != 0);
+      n->children[index - 1].store(child, std::memory_order_release);
+      break;
+    }
+    case kNode256:
+      static_cast<Node256*>(node)->children[b].store(
+          child, std::memory_order_release);
+      break;
+  }
+}
+
+const ArtRep::Leaf* ArtRep::Min(uintptr_t child) {
+  while (child != 0 && !IsLeaf(child)) {
+    child = NextChild(AsNode(child), 0);
+  }
+  return child == 0 ? nullptr : AsLeaf(child);
+}
+
+const ArtRep::Leaf* ArtRep::Max(uintptr_t child) {
+  while (child != 0 && !IsLeaf(child)) {
+    child = PrevChild(AsNode(child), 255);
+  }
+  return child == 0 ? nullptr : AsLeaf(child);
+}
+
+const ArtRep::Leaf* ArtRep::LowerBound(uintptr_t child, const uint8_t* key,
+                                       size_t key_size, size_t depth,
+                                       bool strict) {
+  if (child == 0) {
+    return nullptr;
+  }
+  if (IsLeaf(child)) {
+    const Leaf* leaf = AsLeaf(child);
+    int r = CompareLeaf(leaf, key, key_size);
+    return (r > 0 || (r == 0 && !strict)) ? leaf : nullptr;
+  }
+  const Node* node = AsNode(child);
+  size_t n = std::min<size_t>(node->prefix_len, key_size - depth);
+  int r = memcmp(node->prefix, key + depth, n);
+  if (r != 0) {
+    return r > 0 ? Min(child) : nullptr;
+  }
+  depth += node->prefix_len;
+  if (depth >= key_size) {
+    // `key` is a prefix of every key below the node.
+    return Min(child);
+  }
+  uint8_t b = key[depth];
+  const Leaf* leaf =
+      LowerBound(FindChild(node, b), key, key_size, depth + 1, strict);
+  if (leaf == nullptr) {
+    leaf = Min(NextChild(node, b + 1));
+  }
+  return leaf;
+}
+
+const ArtRep::Leaf* ArtRep::Floor(uintptr_t child, const uint8_t* key,
+                                  size_t key_size, size_t depth, bool strict) {
+  if (child == 0) {
+    return nullptr;
+  }
+  if (IsLeaf(child)) {
+    const Leaf* leaf = AsLeaf(child);
+    int r = CompareLeaf(leaf, key, key_size);
+    return (r < 0 || (r == 0 && !strict)) ? leaf : nullptr;
+  }
+  const Node* node = AsNode(child);
+  size_t n = std::min<size_t>(node->prefix_len, key_size - depth);
+  int r = memcmp(node->prefix, key + depth, n);
+  if (r != 0) {
+    return r < 0 ? Max(child) : nullptr;
+  }
+  depth += node->prefix_len;
+  if (depth >= key_size) {
+    // Every key below the node extends `key`.
+    return nullptr;
+  }
+  uint8_t b = key[depth];
+  const Leaf* leaf = Floor(FindChild(node, b), key, key_size, depth + 1, strict);
+  if (leaf == nullptr && b > 0) {
+    leaf = Max(PrevChild(node, b - 1));
+  }
+  return leaf;
+}
+
+ArtRep::InsertResult ArtRep::TryInsert(uintptr_t leaf_child) {
+  const Leaf* leaf = AsLeaf(leaf_child);
+  const uint8_t* key = leaf->key();
+  Node* parent = nullptr;
+  uint8_t parent_byte = 0;
+  Node* node = root_;
+  size_t depth = 0;
+  while (true) {
+    // Tree keys are prefix-free, so the key differs from any other before
+    // either ends.
+    uint32_t p = 0;
+    while (p < node->prefix_len && depth + p < leaf->key_size &&
+           node->prefix[p] == key[depth + p]) {
+      p++;
+    }
+    if (p < node->prefix_len) {
+      // The key leaves the compressed path. Put a Node4 with the shared
+      // part of the path in the node's place, holding the new leaf and a
+      // copy of the node with the rest of the path.
+      assert(parent != nullptr && depth + p < leaf->key_size);
+      Lock(parent);
+      Lock(node);
+      if (parent->obsolete || node->obsolete ||
+          FindChild(parent, parent_byte) != reinterpret_cast<uintptr_t>(node)) {
+        Unlock(node);
+        Unlock(parent);
+        return kRestart;
+      }
+      Node* split = NewNode(kNode4, node->prefix, p);
+      Node* rest = CopyNode(node, node->type, node->prefix + p + 1,
+                            node->prefix_len - p - 1);
+      AddChild(split, node->prefix[p], reinterpret_cast<uintptr_t>(rest));
+      AddChild(split, key[depth + p], leaf_child);
+      ReplaceChild(parent, parent_byte, reinterpret_cast<uintptr_t>(split));
+      node->obsolete = true;
+      Unlock(node);
+      Unlock(parent);
+      return kInserted;
+    }
+    depth += node->prefix_len;
+    uint8_t b = key[depth];
+    uintptr_t child = FindChild(node, b);
+
+    if (child == 0 && IsFull(node)) {
+      // Replace the node with a larger copy that has room for the leaf.
+      // Only the root has no parent, and it is a Node256.
+      assert(parent != nullptr);
+      Lock(parent);
+      Lock(node);
+      if (parent->obsolete || node->obsolete ||
+          FindChild(parent, parent_byte) != reinterpret_cast<uintptr_t>(node) ||
+          FindChild(node, b) != 0) {
+        Unlock(node);
+        Unlock(parent);
+        return kRestart;
+      }
+      Node* grown = CopyNode(node, static_cast<NodeType>(node->type + 1),
+                             node->prefix, node->prefix_len);
+      AddChild(grown, b, leaf_child);
+      ReplaceChild(parent, parent_byte, reinterpret_cast<uintptr_t>(grown));
+      node->obsolete = true;
+      Unlock(node);
+      Unlock(parent);
+      return kInserted;
+    }
+
+    if (child == 0) {
+      Lock(node);
+      if (node->obsolete || FindChild(node, b) != 0 || IsFull(node)) {
+        Unlock(node);
+        return kRestart;
+      }
+      AddChild(node, b, leaf_child);
+      Unlock(node);
+      return kInserted;
+    }
+
+    if (IsLeaf(child)) {
+      // Lazy expansion: replace the leaf by a Node4 holding both leaves,
+      // with their common bytes as its prefix.
+      const Leaf* other = AsLeaf(child);
+      size_t limit = std::min<size_t>(leaf->key_size, other->key_size);
+      size_t d = depth + 1;
+      while (d < limit && key[d] == other->key()[d]) {
+        d++;
+      }
+      if (d == limit) {
+        assert(leaf->key_size == other->key_size);
+        return kDuplicate;
+      }
+      Lock(node);
+      if (node->obsolete || FindChild(node, b) != child) {
+        Unlock(node);
+        return kRestart;
+      }
+      Node* split = NewNode(kNode4, key + depth + 1, d - depth - 1);
+      AddChild(split, other->key()[d], child);
+      AddChild(split, key[d], leaf_child);
+      ReplaceChild(node, b, reinterpret_cast<uintptr_t>(split));
+      Unlock(node);
+      return kInserted;
+    }
+
+    parent = node;
+    parent_byte = b;
+    node = AsNode(child);
+    depth++;
+  }
+}
+
+bool ArtRep::InsertKey(KeyHandle handle) {
+  const char* entry = static_cast<const char*>(handle);
+  Slice internal_key = GetLengthPrefixedSlice(entry);
+  size_t key_size = TreeKeyLength(internal_key);
+  auto mem = allocator_->AllocateAligned(sizeof(Leaf) + key_size);
+  Leaf* leaf = new (mem) Leaf();
+  leaf->entry = entry;
+  leaf->key_size = static_cast<uint32_t>(key_size);
+  EncodeTreeKey(internal_key, reinterpret_cast<uint8_t*>(leaf + 1));
+
+  InsertResult result;
+  do {
+    result = TryInsert(reinterpret_cast<uintptr_t>(leaf) | kLeafTag);
+  } while (result == kRestart);
+  // A duplicate leaf stays unused in the arena.
+  return result == kInserted;
+}
+
+bool ArtRep::Contains(const char* key) const {
+  std::string tmp;
+  EncodeTreeKey(GetLengthPrefixedSlice(key), &tmp);
+  const Leaf* leaf =
+      LowerBound(Root(), Data(tmp), tmp.size(), 0, false /* strict */);
+  return leaf != nullptr && CompareLeaf(leaf, Data(tmp), tmp.size()) == 0;
+}
+
+void ArtRep::Get(const LookupKey& k, void* callback_args,
+                 bool (*callback_func)(void* arg, const char* entry)) {
+  std::string tmp;
+  EncodeTreeKey(k.internal_key(), &tmp);
+  for (const Leaf* leaf =
+           LowerBound(Root(), Data(tmp), tmp.size(), 0, false /* strict */);
+       leaf != nullptr && callback_func(callback_args, leaf->entry);
+       leaf = LowerBound(Root(), leaf->key(), leaf->key_size, 0,
+                         true /* strict */)) {
+  }
+}
+
+MemTableRep::Iterator* ArtRep::GetIterator(Arena* arena) {
+  void* mem = arena ? arena->AllocateAligned(sizeof(Iterator))
+                    : operator new(sizeof(Iterator));
+  return new (mem) Iterator(this);
+}
+
+}  // anon namespace
+
+MemTableRep* ArtRepFactory::CreateMemTableRep(
+    const MemTableRep::KeyComparator& /*compare*/, Allocator* allocator,
+    const SliceTransform* /*transform*/, Logger* /*logger*/) {
+  return new ArtRep(allocator, concurrent_inserts_);
+}
+
+MemTableRepFactory* NewArtRepFactory(bool concurrent_inserts) {
+  return new ArtRepFactory(concurrent_inserts);
+}
+
+}  // namespace ROCKSDB_NAMESPACE
+#endif  // ROCKSDB_LITE
@@ -0,0 +1,39 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#pragma once
+#ifndef ROCKSDB_LITE
+#include "rocksdb/memtablerep.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+class ArtRepFactory : public MemTableRepFactory {
+ public:
+  explicit ArtRepFactory(bool concurrent_inserts)
+      : concurrent_inserts_(concurrent_inserts) {}
+
+  virtual ~ArtRepFactory() {}
+
+  using MemTableRepFactory::CreateMemTableRep;
+  virtual MemTableRep* CreateMemTableRep(
+      const MemTableRep::KeyComparator& compare, Allocator* allocator,
+      const SliceTransform* transform, Logger* logger) override;
+
+  virtual const char* Name() const override { return "ArtRepFactory"; }
+
+  bool IsInsertConcurrentlySupported() const override {
+    return concurrent_inserts_;
+  }
+
+  bool CanHandleDuplicatedKey() const override { return true; }
+
+  bool RequiresBytewiseComparator() const override { return true; }
+
+ private:
+  const bool concurrent_inserts_;
+};
+
+}  // namespace ROCKSDB_NAMESPACE
+#endif  // ROCKSDB_LITE
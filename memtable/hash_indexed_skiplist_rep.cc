@@ -0,0 +1,282 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+//
+
+#ifndef ROCKSDB_LITE
+#include "memtable/hash_indexed_skiplist_rep.h"
+
+#include <algorithm>
+#include <atomic>
+
+#include "db/dbformat.h"
+#include "db/memtable.h"
+#include "memory/arena.h"
+#include "memtable/inlineskiplist.h"
+#include "rocksdb/memtablerep.h"
+#include "rocksdb/slice.h"
+#include "util/hash.h"
+
+namespace ROCKSDB_NAMESPACE {
+namespace {
+
+// An InlineSkipList holding all entries in order, plus a hash index from
+// each user key to the entry of that key with the highest sequence number.
+// Iterators, flush and reads at older snapshots use the skip list; a Get
+// that can see the newest entry of its key starts there directly instead of
+// searching the list.
+//
+// The index is a fixed array of buckets, each the head of a singly linked
+// list of IndexEntry. Entries are only ever prepended with a CAS on the
+// bucket head and never removed, and an entry's `newest` pointer only moves
+// to newer skip list entries, also by CAS, so concurrent inserts and
+// lookups need no locks. An entry is published in the index after it is
+// linked into the skip list, so the index never points at a node that
+// iteration cannot reach.
+class HashIndexedSkipListRep : public MemTableRep {
+ public:
+  HashIndexedSkipListRep(const MemTableRep::KeyComparator& compare,
+                         Allocator* allocator, size_t bucket_size);
+
+  KeyHandle Allocate(const size_t len, char** buf) override {
+    *buf = skip_list_.AllocateKey(len);
+    return static_cast<KeyHandle>(*buf);
+  }
+
+  void Insert(KeyHandle handle) override { InsertKey(handle); }
+
+  bool InsertKey(KeyHandle handle) override {
+    return AddToIndex(skip_list_.Insert(static_cast<char*>(handle)), handle);
+  }
+
+  void InsertWithHint(KeyHandle handle, void** hint) override {
+    InsertKeyWithHint(handle, hint);
+  }
+
+  bool InsertKeyWithHint(KeyHandle handle, void** hint) override {
+    return AddToIndex(
+        skip_list_.InsertWithHint(static_cast<char*>(handle), hint), handle);
+  }
+
+  void InsertWithHintConcurrently(KeyHandle handle, void** hint) override {
+    InsertKeyWithHintConcurrently(handle, hint);
+  }
+
+  bool InsertKeyWithHintConcurrently(KeyHandle handle, void** hint) override {
+    return AddToIndex(skip_list_.InsertWithHintConcurrently(
+                          static_cast<char*>(handle), hint),
+                      handle);
+  }
+
+  void InsertConcurrently(KeyHandle handle) override {
+    InsertKeyConcurrently(handle);
+  }
+
+  bool InsertKeyConcurrently(KeyHandle handle) override {
+    return AddToIndex(
+        skip_list_.InsertConcurrently(static_cast<char*>(handle)), handle);
+  }
+
+  bool Contains(const char* key) const override {
+    return skip_list_.Contains(key);
+  }
+
+  size_t ApproximateMemoryUsage() override {
+    // All memory is allocated through allocator; nothing to report here
+    return 0;
+  }
+
+  void Get(const LookupKey& k, void* callback_args,
+           bool (*callback_func)(void* arg, const char* entry)) override;
+
+  uint64_t ApproximateNumEntries(const Slice& start_ikey,
+                                 const Slice& end_ikey) override {
+    std::string tmp;
+    uint64_t start_count =
+        skip_list_.EstimateCount(EncodeKey(&tmp, start_ikey));
+    uint64_t end_count = skip_list_.EstimateCount(EncodeKey(&tmp, end_ikey));
+    return (end_count >= start_count) ? (end_count - start_count) : 0;
+  }
+
+  ~HashIndexedSkipListRep() override {}
+
+  MemTableRep::Iterator* GetIterator(Arena* arena = nullptr) override;
+
+ private:
+  typedef InlineSkipList<const MemTableRep::KeyComparator&> SkipListType;
+
+  struct IndexEntry {
+    // Skip list entry with the highest sequence number for the user key.
+    std::atomic<const char*> newest;
+    // Immutable once the entry is published.
+    IndexEntry* next;
+  };
+
+  class Iterator : public MemTableRep::Iterator {
+   public:
+    explicit Iterator(const SkipListType* list) : iter_(list) {}
+
+    bool Valid() const override { return iter_.Valid(); }
+    const char* key() const override { return iter_.key(); }
+    void Next() override { iter_.Next(); }
+    void Prev() override { iter_.Prev(); }
+
+    void Seek(const Slice& internal_key, const char* memtable_key) override {
+      iter_.Seek(memtable_key != nullptr ? memtable_key
+                                         : EncodeKey(&tmp_, internal_key));
+    }
+
+    void SeekForPrev(const Slice& internal_key,
+                     const char* memtable_key) override {
+      iter_.SeekForPrev(memtable_key != nullptr
+                            ? memtable_key
+                            : EncodeKey(&tmp_, internal_key));
+    }
+
+    void SeekToFirst() override { iter_.SeekToFirst(); }
+    void SeekToLast() override { iter_.SeekToLast(); }
+
+   private:
+    SkipListType::Iterator iter_;
+    std::string tmp_;  // For passing to EncodeKey
+  };
+
+  static Slice EntryUserKey(const char* key) {
+    return ExtractUserKey(GetLengthPrefixedSlice(key));
+  }
+
+  size_t GetBucket(const Slice& user_key) const {
+    return GetSliceRangedNPHash(user_key, bucket_size_);
+  }
+
+  // Returns the IndexEntry for `user_key` among the entries from `head` up
+  // to, but excluding, `end`, or nullptr.
+  static IndexEntry* FindEntry(IndexEntry* head, IndexEntry* end,
+                               const Slice& user_key) {
+    for (IndexEntry* e = head; e != end; e = e->next) {
+      if (EntryUserKey(e->newest.load(std::memory_order_acquire)) == user_key) {
+        return e;
+      }
+    }
+    return nullptr;
+  }
+
+  // Makes `key` the newest entry of `e` unless a newer one is already there.
+  void Promote(IndexEntry* e, const char* key) {
+    const char* cur = e->newest.load(std::memory_order_acquire);
+    while (cmp_(key, cur) < 0 &&
+           !e->newest.compare_exchange_weak(cur, key,
+                                            std::memory_order_release,
+                                            std::memory_order_acquire)) {
+    }
+  }
+
+  // Adds `handle`, just inserted into the skip list, to the index.
+  bool AddToIndex(bool inserted, KeyHandle handle);
+
+  SkipListType skip_list_;
+  const MemTableRep::KeyComparator& cmp_;
+  const size_t bucket_size_;
+  std::atomic<IndexEntry*>* buckets_;
+};
+
+HashIndexedSkipListRep::HashIndexedSkipListRep(
+    const MemTableRep::KeyComparator& compare, Allocator* allocator,
+    size_t bucket_size)
+    : MemTableRep(allocator),
+      skip_list_(compare, allocator),
+      cmp_(compare),
+      bucket_size_(bucket_size) {
+  auto mem =
+      allocator->AllocateAligned(sizeof(std::atomic<void*>) * bucket_size);
+  buckets_ = new (mem) std::atomic<IndexEntry*>[bucket_size];
+
+  for (size_t i = 0; i < bucket_size_; ++i) {
+    buckets_[i].store(nullptr, std::memory_order_relaxed);
+  }
+}
+
+bool HashIndexedSkipListRep::AddToIndex(bool inserted, KeyHandle handle) {
+  if (!inserted) {
+    // Duplicate <key, seq>; the skip list is unchanged.
+    return false;
+  }
+  const char* key = static_cast<const char*>(handle);
+  Slice user_key = EntryUserKey(key);
+  std::atomic<IndexEntry*>& bucket = buckets_[GetBucket(user_key)];
+
+  IndexEntry* head = bucket.load(std::memory_order_acquire);
+  IndexEntry* scanned_until = nullptr;
+  IndexEntry* entry = nullptr;
+  while (true) {
+    IndexEntry* existing = FindEntry(head, scanned_until, user_key);
+    if (existing != nullptr) {
+      // Another insert of the same user key won the race to create the
+      // entry; `entry`, if allocated, stays unused in the arena.
+      Promote(existing, key);
+      return true;
+    }
+    if (entry == nullptr) {
+      auto mem = allocator_->AllocateAligned(sizeof(IndexEntry));
+      entry = new (mem) IndexEntry();
+      entry->newest.store(key, std::memory_order_relaxed);
+    }
+    entry->next = head;
+    scanned_until = head;
+    // On failure `head` is reloaded and only the entries prepended since
+    // are scanned again.
+    if (bucket.compare_exchange_weak(head, entry, std::memory_order_release,
+                                     std::memory_order_acquire)) {
+      return true;
+    }
+  }
+}
+
+void HashIndexedSkipListRep::Get(const LookupKey& k, void* callback_args,
+                                 bool (*callback_func)(void* arg,
+                                                       const char* entry)) {
+  Slice user_key = k.user_key();
+  IndexEntry* e =
+      FindEntry(buckets_[GetBucket(user_key)].load(std::memory_order_acquire),
+                nullptr, user_key);
+  if (e == nullptr) {
+    // Nothing in the memtable has this user key, so the first entry >= k
+    // would belong to another key and be rejected by the callback.
+    return;
+  }
+  SkipListType::Iterator iter(&skip_list_);
+  const char* newest = e->newest.load(std::memory_order_acquire);
+  if (cmp_(newest, k.internal_key()) >= 0) {
+    // The newest entry is visible to the lookup, so it is the first entry
+    // >= k.
+    iter.SeekToEntry(newest);
+  } else {
+    // Read at an older snapshot.
+    iter.Seek(k.memtable_key().data());
+  }
+  for (; iter.Valid() && callback_func(callback_args, iter.key());
+       iter.Next()) {
+  }
+}
+
+MemTableRep::Iterator* HashIndexedSkipListRep::GetIterator(Arena* arena) {
+  void* mem = arena ? arena->AllocateAligned(sizeof(Iterator))
+                    : operator new(sizeof(Iterator));
+  return new (mem) Iterator(&skip_list_);
+}
+
+}  // anon namespace
+
+MemTableRep* HashIndexedSkipListRepFactory::CreateMemTableRep(
+    const MemTableRep::KeyComparator& compare, Allocator* allocator,
+    const SliceTransform* /*transform*/, Logger* /*logger*/) {
+  return new HashIndexedSkipListRep(compare, allocator, bucket_count_);
+}
+
+MemTableRepFactory* NewHashIndexedSkipListRepFactory(size_t bucket_count) {
+  return new HashIndexedSkipListRepFactory(std::max<size_t>(bucket_count, 1));
+}
+
+}  // namespace ROCKSDB_NAMESPACE
+#endif  // ROCKSDB_LITE
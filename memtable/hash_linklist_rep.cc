@@ -30,9 +30,14 @@ typedef std::atomic<void*> Pointer;
 struct BucketHeader {
   Pointer next;
   std::atomic<uint32_t> num_entries;
+  // Number of entries of a linked list bucket that are fully linked. It can
+  // lag num_entries while concurrent inserts are in progress, and becomes
+  // threshold_use_skiplist + 1 once a concurrent insert has claimed the
+  // conversion to a skip list.
+  std::atomic<uint32_t> num_linked;
 
   explicit BucketHeader(void* n, uint32_t count)
-      : next(n), num_entries(count) {}
+      : next(n), num_entries(count), num_linked(count) {}
 
   bool IsSkipListBucket() {
     return next.load(std::memory_order_relaxed) == this;
@@ -47,6 +52,8 @@ struct BucketHeader {
     // Only one thread can do write at one time. No need to do atomic
     // incremental. Update it with relaxed load and store.
     num_entries.store(GetNumEntries() + 1, std::memory_order_relaxed);
+    num_linked.store(num_linked.load(std::memory_order_relaxed) + 1,
+                     std::memory_order_relaxed);
   }
 };
 
@@ -82,6 +89,10 @@ struct Node {
 
   void NoBarrier_SetNext(Node* x) { next_.store(x, std::memory_order_relaxed); }
 
+  bool CASNext(Node* expected, Node* x) {
+    return next_.compare_exchange_strong(expected, x);
+  }
+
   // Needed for placement new below which is fine
   Node() {}
 
@@ -155,6 +166,20 @@ struct Node {
 //     to itself, so no matter a reader sees any stale or newer value, it will
 //     be able to correctly distinguish case 3 and 4.
 //
+// Concurrent inserts (InsertConcurrently()) make the same changes with CAS:
+// (1) Cases 1->2 and 2->3 CAS the bucket pointer, and whoever loses the race
+//     starts over with the new bucket content. Because a single node and a
+//     header are told apart by the next pointer, the bucket pointer is
+//     reloaded after reading it, to catch a single node that has just been
+//     moved under a header and got a successor.
+// (2) Inserts into a linked list first reserve a slot by incrementing the
+//     header's count up to the threshold, then CAS the node into the sorted
+//     list and increment num_linked. The insert that finds the list full
+//     waits for num_linked to reach the threshold, claims the conversion to
+//     case 4 and publishes the skip list; inserts arriving meanwhile wait for
+//     the bucket pointer to change.
+// (3) Skip list buckets use SkipList::InsertConcurrently().
+//
 // The reason that we use case 2 is we want to make the format to be efficient
 // when the utilization of buckets is relatively low. If we use case 3 for
 // single entry bucket, we will need to waste 12 bytes for every entry,
@@ -172,6 +197,8 @@ class HashLinkListRep : public MemTableRep {
 
   void Insert(KeyHandle handle) override;
 
+  void InsertConcurrently(KeyHandle handle) override;
+
   bool Contains(const char* key) const override;
 
   size_t ApproximateMemoryUsage() override;
@@ -258,6 +285,14 @@ class HashLinkListRep : public MemTableRep {
   Node* FindGreaterOrEqualInBucket(Node* head, const Slice& key) const;
   Node* FindLessOrEqualInBucket(Node* head, const Slice& key) const;
 
+  // Returns a skip list bucket holding the entries of the linked list
+  // bucket `header` plus `x`.
+  SkipListBucketHeader* ConvertToSkipListBucket(BucketHeader* header, Node* x);
+
+  // Links `x` into the sorted linked list of `header` with CAS.
+  void LinkListInsertConcurrently(BucketHeader* header, Node* x,
+                                  const Slice& internal_key);
+
   class FullListIterator : public MemTableRep::Iterator {
    public:
     explicit FullListIterator(MemtableSkipList* list, Allocator* allocator)
@@ -627,23 +662,9 @@ void HashLinkListRep::Insert(KeyHandle handle) {
   if (header->GetNumEntries() == threshold_use_skiplist_) {
     // Case 3. number of entries reaches the threshold so need to convert to
     // skip list.
-    LinkListIterator bucket_iter(
-        this, reinterpret_cast<Node*>(
-                  first_next_pointer->load(std::memory_order_relaxed)));
-    auto mem = allocator_->AllocateAligned(sizeof(SkipListBucketHeader));
-    SkipListBucketHeader* new_skip_list_header = new (mem)
-        SkipListBucketHeader(compare_, allocator_, header->GetNumEntries() + 1);
-    auto& skip_list = new_skip_list_header->skip_list;
-
-    // Add all current entries to the skip list
-    for (bucket_iter.SeekToHead(); bucket_iter.Valid(); bucket_iter.Next()) {
-      skip_list.Insert(bucket_iter.key());
-    }
-
-    // insert the new entry
-    skip_list.Insert(x->key);
     // Set the bucket
-    bucket.store(new_skip_list_header, std::memory_order_release);
+    bucket.store(ConvertToSkipListBucket(header, x),
+                 std::memory_order_release);
   } else {
     // Case 5. Need to insert to the sorted linked list without changing the
     // header.
@@ -690,6 +711,154 @@ void HashLinkListRep::Insert(KeyHandle handle) {
   }
 }
 
+SkipListBucketHeader* HashLinkListRep::ConvertToSkipListBucket(
+    BucketHeader* header, Node* x) {
+  LinkListIterator bucket_iter(
+      this,
+      reinterpret_cast<Node*>(header->next.load(std::memory_order_acquire)));
+  auto mem = allocator_->AllocateAligned(sizeof(SkipListBucketHeader));
+  SkipListBucketHeader* new_skip_list_header = new (mem)
+      SkipListBucketHeader(compare_, allocator_, header->GetNumEntries() + 1);
+  auto& skip_list = new_skip_list_header->skip_list;
+
+  // Add all current entries to the skip list
+  for (bucket_iter.SeekToHead(); bucket_iter.Valid(); bucket_iter.Next()) {
+    skip_list.Insert(bucket_iter.key());
+  }
+
+  // insert the new entry
+  skip_list.Insert(x->key);
+  return new_skip_list_header;
+}
+
+void HashLinkListRep::LinkListInsertConcurrently(BucketHeader* header, Node* x,
+                                                 const Slice& internal_key) {
+  Node* prev = nullptr;
+  Node* cur =
+      reinterpret_cast<Node*>(header->next.load(std::memory_order_acquire));
+  while (true) {
+    while (KeyIsAfterNode(internal_key, cur)) {
+      prev = cur;
+      cur = cur->Next();
+    }
+
+    // Our data structure does not allow duplicate insertion
+    assert(cur == nullptr || !Equal(x->key, cur->key));
+
+    x->NoBarrier_SetNext(cur);
+    // Nodes are never removed, so on a failed CAS the search can resume
+    // from prev, which is still before x.
+    if (prev != nullptr) {
+      if (prev->CASNext(cur, x)) {
+        return;
+      }
+      cur = prev->Next();
+    } else {
+      void* expected = cur;
+      if (header->next.compare_exchange_strong(expected, x)) {
+        return;
+      }
+      cur = static_cast<Node*>(expected);
+    }
+  }
+}
+
+void HashLinkListRep::InsertConcurrently(KeyHandle handle) {
+  Node* x = static_cast<Node*>(handle);
+  Slice internal_key = GetLengthPrefixedSlice(x->key);
+  auto transformed = GetPrefix(internal_key);
+  auto& bucket = buckets_[GetHash(transformed)];
+  // Header for converting a single entry bucket, allocated at most once.
+  char* header_mem = nullptr;
+
+  while (true) {
+    Pointer* first_next_pointer =
+        static_cast<Pointer*>(bucket.load(std::memory_order_acquire));
+
+    if (first_next_pointer == nullptr) {
+      // Case 1. empty bucket
+      x->NoBarrier_SetNext(nullptr);
+      void* expected = nullptr;
+      if (bucket.compare_exchange_strong(expected, x)) {
+        return;
+      }
+      continue;
+    }
+
+    void* first_next = first_next_pointer->load(std::memory_order_acquire);
+    if (bucket.load(std::memory_order_acquire) != first_next_pointer) {
+      continue;
+    }
+
+    if (first_next == nullptr) {
+      // Case 2. only one entry in the bucket; convert to a counting bucket
+      // and retry.
+      if (header_mem == nullptr) {
+        header_mem = allocator_->AllocateAligned(sizeof(BucketHeader));
+      }
+      auto* header = new (header_mem) BucketHeader(first_next_pointer, 1);
+      void* expected = first_next_pointer;
+      if (bucket.compare_exchange_strong(expected, header)) {
+        header_mem = nullptr;
+      }
+      continue;
+    }
+
+    BucketHeader* header = reinterpret_cast<BucketHeader*>(first_next_pointer);
+    if (header->IsSkipListBucket()) {
+      // Case 4. Bucket is already a skip list
+      auto* skip_list_bucket_header =
+          reinterpret_cast<SkipListBucketHeader*>(header);
+      skip_list_bucket_header->Counting_header.num_entries.fetch_add(
+          1, std::memory_order_relaxed);
+      skip_list_bucket_header->skip_list.InsertConcurrently(x->key);
+      return;
+    }
+
+    // Reserve a slot in the linked list, unless it is full.
+    uint32_t num_entries = header->GetNumEntries();
+    while (num_entries < threshold_use_skiplist_ &&
+           !header->num_entries.compare_exchange_weak(num_entries,
+                                                      num_entries + 1)) {
+    }
+    if (num_entries < threshold_use_skiplist_) {
+      if (bucket_entries_logging_threshold_ > 0 &&
+          num_entries ==
+              static_cast<uint32_t>(bucket_entries_logging_threshold_)) {
+        Info(logger_,
+             "HashLinkedList bucket %" ROCKSDB_PRIszt
+             " has more than %d "
+             "entries. Key to insert: %s",
+             GetHash(transformed), num_entries,
+             internal_key.ToString(true).c_str());
+      }
+      // Case 5. Insert to the sorted linked list.
+      LinkListInsertConcurrently(header, x, internal_key);
+      header->num_linked.fetch_add(1, std::memory_order_release);
+      return;
+    }
+
+    // Case 3. The linked list is full. Wait for the reserved inserts to be
+    // linked, and then either convert the bucket to a skip list or wait for
+    // the insert that does.
+    while (true) {
+      uint32_t num_linked = header->num_linked.load(std::memory_order_acquire);
+      if (num_linked == threshold_use_skiplist_ &&
+          header->num_linked.compare_exchange_strong(num_linked,
+                                                     num_linked + 1)) {
+        bucket.store(ConvertToSkipListBucket(header, x),
+                     std::memory_order_release);
+        return;
+      }
+      if (num_linked > threshold_use_skiplist_ &&
+          bucket.load(std::memory_order_acquire) != first_next_pointer) {
+        break;
+      }
+      port::AsmVolatilePause();
+    }
+  }
+}
+
 bool HashLinkListRep::Contains(const char* key) const {
   Slice internal_key = GetLengthPrefixedSlice(key);
 
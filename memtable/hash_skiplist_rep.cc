@@ -30,6 +30,8 @@ class HashSkipListRep : public MemTableRep {
 
   void Insert(KeyHandle handle) override;
 
+  void InsertConcurrently(KeyHandle handle) override;
+
   bool Contains(const char* key) const override;
 
   size_t ApproximateMemoryUsage() override;
@@ -77,6 +79,9 @@ class HashSkipListRep : public MemTableRep {
   // Get a bucket from buckets_. If the bucket hasn't been initialized yet,
   // initialize it before returning.
   Bucket* GetInitializedBucket(const Slice& transformed);
+  // Same as GetInitializedBucket(), but safe to call from concurrent
+  // inserts.
+  Bucket* GetInitializedBucketConcurrently(const Slice& transformed);
 
   class Iterator : public MemTableRep::Iterator {
    public:
@@ -265,6 +270,25 @@ HashSkipListRep::Bucket* HashSkipListRep::GetInitializedBucket(
   return bucket;
 }
 
+HashSkipListRep::Bucket* HashSkipListRep::GetInitializedBucketConcurrently(
+    const Slice& transformed) {
+  size_t hash = GetHash(transformed);
+  auto bucket = GetBucket(hash);
+  if (bucket == nullptr) {
+    auto addr = allocator_->AllocateAligned(sizeof(Bucket));
+    auto new_bucket = new (addr) Bucket(compare_, allocator_, skiplist_height_,
+                                        skiplist_branching_factor_);
+    // If another insert installed a bucket first, use that one; new_bucket
+    // stays unused in the allocator.
+    if (buckets_[hash].compare_exchange_strong(bucket, new_bucket,
+                                               std::memory_order_acq_rel,
+                                               std::memory_order_acquire)) {
+      bucket = new_bucket;
+    }
+  }
+  return bucket;
+}
+
 void HashSkipListRep::Insert(KeyHandle handle) {
   auto* key = static_cast<char*>(handle);
   assert(!Contains(key));
@@ -273,6 +297,13 @@ void HashSkipListRep::Insert(KeyHandle handle) {
   bucket->Insert(key);
 }
 
+void HashSkipListRep::InsertConcurrently(KeyHandle handle) {
+  auto* key = static_cast<char*>(handle);
+  auto transformed = transform_->Transform(UserKey(key));
+  auto bucket = GetInitializedBucketConcurrently(transformed);
+  bucket->InsertConcurrently(key);
+}
+
 bool HashSkipListRep::Contains(const char* key) const {
   auto transformed = transform_->Transform(UserKey(key));
   auto bucket = GetBucket(transformed);
@@ -331,6 +362,12 @@ MemTableRep::Iterator* HashSkipListRep::GetDynamicPrefixIterator(Arena* arena) {
 
 } // anon namespace
 
+bool HashSkipListRepFactory::IsInsertConcurrentlySupported() const {
+  return skiplist_height_ <=
+         SkipList<const char*,
+                  const MemTableRep::KeyComparator&>::kMaxPossibleHeight;
+}
+
 MemTableRep* HashSkipListRepFactory::CreateMemTableRep(
     const MemTableRep::KeyComparator& compare, Allocator* allocator,
     const SliceTransform* transform, Logger* /*logger*/) {
@@ -34,6 +34,8 @@ class HashSkipListRepFactory : public MemTableRepFactory {
     return "HashSkipListRepFactory";
   }
 
+  bool IsInsertConcurrentlySupported() const override;
+
  private:
   const size_t bucket_count_;
   const int32_t skiplist_height_;
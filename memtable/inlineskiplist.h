@@ -39,6 +39,16 @@
 //
 // ... prev vs. next pointer ordering ...
 //
+// Key prefixes -------------
+//
+// With use_key_prefix, every node also stores an 8-byte prefix of its key,
+// computed by Comparator::KeyPrefix(), between its level-0 link and the key.
+// A prefix must be an order-preserving summary of the key: a smaller prefix
+// implies a smaller key. Searches then compare the search key's prefix with
+// the prefix of each visited node, which sits on the cache line that was
+// already loaded to follow the link, and only decode and compare the full
+// keys when the prefixes are equal.
+//
 
 #pragma once
 #include <assert.h>
@@ -46,6 +56,7 @@
 #include <algorithm>
 #include <atomic>
 #include <type_traits>
+#include <vector>
 #include "memory/allocator.h"
 #include "port/likely.h"
 #include "port/port.h"
@@ -70,10 +81,12 @@ class InlineSkipList {
   // Create a new InlineSkipList object that will use "cmp" for comparing
   // keys, and will allocate memory using "*allocator".  Objects allocated
   // in the allocator must remain allocated for the lifetime of the
-  // skiplist object.
+  // skiplist object. If use_key_prefix is true, nodes store the key prefix
+  // returned by cmp.KeyPrefix() to speed up searches (see above).
   explicit InlineSkipList(Comparator cmp, Allocator* allocator,
                           int32_t max_height = 12,
-                          int32_t branching_factor = 4);
+                          int32_t branching_factor = 4,
+                          bool use_key_prefix = false);
   // No copying allowed
   InlineSkipList(const InlineSkipList&) = delete;
   InlineSkipList& operator=(const InlineSkipList&) = delete;
@@ -141,6 +154,11 @@ class InlineSkipList {
   // Return estimated number of entries smaller than `key`.
   uint64_t EstimateCount(const char* key) const;
 
+  // Appends to *keys, in order, the keys of the highest level that has at
+  // least `target` nodes, or of level 0 if none has. Node heights are
+  // random, so these keys are spread evenly over the list.
+  void SampleKeys(size_t target, std::vector<const char*>* keys) const;
+
   // Validate correctness of the skip-list.
   void TEST_Validate() const;
 
@@ -185,6 +203,11 @@ class InlineSkipList {
     // Final state of iterator is Valid() iff list is not empty.
     void SeekToLast();
 
+    // Position at the entry holding `key` without searching.
+    // REQUIRES: `key` was returned by AllocateKey() and successfully inserted
+    // into this list.
+    void SeekToEntry(const char* key);
+
    private:
     const InlineSkipList* list_;
     Node* node_;
@@ -199,6 +222,9 @@ class InlineSkipList {
   Allocator* const allocator_;  // Allocator used for allocations of nodes
   // Immutable after construction
   Comparator const compare_;
+  const bool use_key_prefix_;
+  // Distance from Node::Key() to the key: the size of the key prefix, or 0.
+  const size_t key_offset_;
   Node* const head_;
 
   // Modified only by Insert().  Read racily by readers, but stale
@@ -218,6 +244,28 @@ class InlineSkipList {
 
   Node* AllocateNode(size_t key_size, int height);
 
+  const char* KeyOf(const Node* n) const { return n->Key() + key_offset_; }
+
+  Node* NodeOf(const char* key) const {
+    return reinterpret_cast<Node*>(const_cast<char*>(key) - key_offset_) - 1;
+  }
+
+  uint64_t KeyPrefixOf(const char* key) const {
+    return use_key_prefix_ ? compare_.KeyPrefix(key) : 0;
+  }
+
+  // Compares the key in "n" with key, whose prefix is key_prefix if key
+  // prefixes are used. n should not be head_ or nullptr.
+  int CompareNode(Node* n, uint64_t key_prefix, const DecodedKey& key) const {
+    if (use_key_prefix_) {
+      uint64_t node_prefix = n->KeyPrefix();
+      if (node_prefix != key_prefix) {
+        return node_prefix < key_prefix ? -1 : 1;
+      }
+    }
+    return compare_(KeyOf(n), key);
+  }
+
   bool Equal(const char* a, const char* b) const {
     return (compare_(a, b) == 0);
   }
@@ -230,6 +278,8 @@ class InlineSkipList {
   // is considered infinite.  n should not be head_.
   bool KeyIsAfterNode(const char* key, Node* n) const;
   bool KeyIsAfterNode(const DecodedKey& key, Node* n) const;
+  bool KeyIsAfterNode(const DecodedKey& key, uint64_t key_prefix,
+                      Node* n) const;
 
   // Returns the earliest node with a key >= key.
   // Return nullptr if there is no such node.
@@ -259,13 +309,14 @@ class InlineSkipList {
   // a node that is after the key.  after should be nullptr if a good after
   // node isn't conveniently available.
   template<bool prefetch_before>
-  void FindSpliceForLevel(const DecodedKey& key, Node* before, Node* after, int level,
+  void FindSpliceForLevel(const DecodedKey& key, uint64_t key_prefix,
+                          Node* before, Node* after, int level,
                           Node** out_prev, Node** out_next);
 
   // Recomputes Splice levels from highest_level (inclusive) down to
   // lowest_level (inclusive).
-  void RecomputeSpliceLevels(const DecodedKey& key, Splice* splice,
-                             int recompute_level);
+  void RecomputeSpliceLevels(const DecodedKey& key, uint64_t key_prefix,
+                             Splice* splice, int recompute_level);
 };
 
 // Implementation details follow
@@ -305,8 +356,21 @@ struct InlineSkipList<Comparator>::Node {
     return rv;
   }
 
+  // The bytes after the node: the key, preceded by the key prefix if key
+  // prefixes are used. See InlineSkipList::KeyOf().
   const char* Key() const { return reinterpret_cast<const char*>(&next_[1]); }
 
+  // Only valid if key prefixes are used.
+  uint64_t KeyPrefix() const {
+    uint64_t rv;
+    memcpy(&rv, &next_[1], sizeof(rv));
+    return rv;
+  }
+
+  void SetKeyPrefix(uint64_t key_prefix) {
+    memcpy(static_cast<void*>(&next_[1]), &key_prefix, sizeof(key_prefix));
+  }
+
   // Accessors/mutators for links.  Wrapped in methods so we can add
   // the appropriate barriers as necessary, and perform the necessary
   // addressing trickery for storing links below the Node in memory.
@@ -375,7 +439,7 @@ inline bool InlineSkipList<Comparator>::Iterator::Valid() const {
 template <class Comparator>
 inline const char* InlineSkipList<Comparator>::Iterator::key() const {
   assert(Valid());
-  return node_->Key();
+  return list_->KeyOf(node_);
 }
 
 template <class Comparator>
@@ -389,7 +453,7 @@ inline void InlineSkipList<Comparator>::Iterator::Prev() {
   // Instead of using explicit "prev" links, we just search for the
   // last node that falls before key.
   assert(Valid());
-  node_ = list_->FindLessThan(node_->Key());
+  node_ = list_->FindLessThan(list_->KeyOf(node_));
   if (node_ == list_->head_) {
     node_ = nullptr;
   }
@@ -436,6 +500,12 @@ inline void InlineSkipList<Comparator>::Iterator::SeekToLast() {
   }
 }
 
+template <class Comparator>
+inline void InlineSkipList<Comparator>::Iterator::SeekToEntry(
+    const char* key) {
+  node_ = list_->NodeOf(key);
+}
+
 template <class Comparator>
 int InlineSkipList<Comparator>::RandomHeight() {
   auto rnd = Random::GetTLSInstance();
@@ -457,15 +527,24 @@ bool InlineSkipList<Comparator>::KeyIsAfterNode(const char* key,
                                                 Node* n) const {
   // nullptr n is considered infinite
   assert(n != head_);
-  return (n != nullptr) && (compare_(n->Key(), key) < 0);
+  return (n != nullptr) && (compare_(KeyOf(n), key) < 0);
+}
+
+template <class Comparator>
+bool InlineSkipList<Comparator>::KeyIsAfterNode(const DecodedKey& key,
+                                                Node* n) const {
+  // nullptr n is considered infinite
+  assert(n != head_);
+  return (n != nullptr) && (compare_(KeyOf(n), key) < 0);
 }
 
 template <class Comparator>
 bool InlineSkipList<Comparator>::KeyIsAfterNode(const DecodedKey& key,
+                                                uint64_t key_prefix,
                                                 Node* n) const {
   // nullptr n is considered infinite
   assert(n != head_);
-  return (n != nullptr) && (compare_(n->Key(), key) < 0);
+  return (n != nullptr) && (CompareNode(n, key_prefix, key) < 0);
 }
 
 template <class Comparator>
@@ -489,6 +568,7 @@ InlineSkipList<Comparator>::FindGreaterOrEqual(const char* key) const {
   //printf("level = %d\n", level);
   Node* last_bigger = nullptr;
   const DecodedKey key_decoded = compare_.decode_key(key);
+  const uint64_t key_prefix = KeyPrefixOf(key);
   while (true) {
     //count_skiplist++; // Signal.Jin
     Node* next = x->Next(level);
@@ -496,13 +576,13 @@ InlineSkipList<Comparator>::FindGreaterOrEqual(const char* key) const {
       PREFETCH(next->Next(level), 0, 1);
     }
     // Make sure the lists are sorted
-    assert(x == head_ || next == nullptr || KeyIsAfterNode(next->Key(), x));
+    assert(x == head_ || next == nullptr || KeyIsAfterNode(KeyOf(next), x));
     // Make sure we haven't overshot during our search
     assert(x == head_ || KeyIsAfterNode(key_decoded, x));
     //clock_gettime(CLOCK_MONOTONIC, &s_time);
     int cmp = (next == nullptr || next == last_bigger)
                   ? 1
-                  : compare_(next->Key(), key_decoded);
+                  : CompareNode(next, key_prefix, key_decoded);
     //clock_gettime(CLOCK_MONOTONIC, &e_time);
     //r_time = (e_time.tv_nsec - s_time.tv_nsec)*0.001;
     //fprintf(stdout, "Skiplist Compare time = %.2f\n", r_time); // Signal.Jin
@@ -539,15 +619,17 @@ InlineSkipList<Comparator>::FindLessThan(const char* key, Node** prev,
   // KeyIsAfter(key, last_not_after) is definitely false
   Node* last_not_after = nullptr;
   const DecodedKey key_decoded = compare_.decode_key(key);
+  const uint64_t key_prefix = KeyPrefixOf(key);
   while (true) {
     assert(x != nullptr);
     Node* next = x->Next(level);
     if (next != nullptr) {
       PREFETCH(next->Next(level), 0, 1);
     }
-    assert(x == head_ || next == nullptr || KeyIsAfterNode(next->Key(), x));
+    assert(x == head_ || next == nullptr || KeyIsAfterNode(KeyOf(next), x));
     assert(x == head_ || KeyIsAfterNode(key_decoded, x));
-    if (next != last_not_after && KeyIsAfterNode(key_decoded, next)) {
+    if (next != last_not_after &&
+        KeyIsAfterNode(key_decoded, key_prefix, next)) {
       // Keep searching in this list
       assert(next != nullptr);
       x = next;
@@ -594,12 +676,12 @@ uint64_t InlineSkipList<Comparator>::EstimateCount(const char* key) const {
   int level = GetMaxHeight() - 1;
   const DecodedKey key_decoded = compare_.decode_key(key);
   while (true) {
-    assert(x == head_ || compare_(x->Key(), key_decoded) < 0);
+    assert(x == head_ || compare_(KeyOf(x), key_decoded) < 0);
     Node* next = x->Next(level);
     if (next != nullptr) {
       PREFETCH(next->Next(level), 0, 1);
     }
-    if (next == nullptr || compare_(next->Key(), key_decoded) >= 0) {
+    if (next == nullptr || compare_(KeyOf(next), key_decoded) >= 0) {
       if (level == 0) {
         return count;
       } else {
@@ -614,16 +696,40 @@ uint64_t InlineSkipList<Comparator>::EstimateCount(const char* key) const {
   }
 }
 
+template <class Comparator>
+void InlineSkipList<Comparator>::SampleKeys(
+    size_t target, std::vector<const char*>* keys) const {
+  // Each level has about kBranching_ times fewer nodes than the one below,
+  // so counting the levels from the top down visits O(target) nodes.
+  int level = GetMaxHeight() - 1;
+  for (; level > 0; level--) {
+    size_t count = 0;
+    for (Node* x = head_->Next(level); x != nullptr && count < target;
+         x = x->Next(level)) {
+      count++;
+    }
+    if (count >= target) {
+      break;
+    }
+  }
+  for (Node* x = head_->Next(level); x != nullptr; x = x->Next(level)) {
+    keys->push_back(KeyOf(x));
+  }
+}
+
 template <class Comparator>
 InlineSkipList<Comparator>::InlineSkipList(const Comparator cmp,
                                            Allocator* allocator,
                                            int32_t max_height,
-                                           int32_t branching_factor)
+                                           int32_t branching_factor,
+                                           bool use_key_prefix)
     : kMaxHeight_(static_cast<uint16_t>(max_height)),
       kBranching_(static_cast<uint16_t>(branching_factor)),
       kScaledInverseBranching_((Random::kMaxNext + 1) / kBranching_),
       allocator_(allocator),
       compare_(cmp),
+      use_key_prefix_(use_key_prefix),
+      key_offset_(use_key_prefix ? sizeof(uint64_t) : 0),
       head_(AllocateNode(0, max_height)),
       max_height_(1),
       seq_splice_(AllocateSplice()) {
@@ -639,7 +745,8 @@ InlineSkipList<Comparator>::InlineSkipList(const Comparator cmp,
 
 template <class Comparator>
 char* InlineSkipList<Comparator>::AllocateKey(size_t key_size) {
-  return const_cast<char*>(AllocateNode(key_size, RandomHeight())->Key());
+  return const_cast<char*>(
+      KeyOf(AllocateNode(key_offset_ + key_size, RandomHeight())));
 }
 
 template <class Comparator>
@@ -733,6 +840,7 @@ bool InlineSkipList<Comparator>::InsertWithHintConcurrently(const char* key,
 template <class Comparator>
 template <bool prefetch_before>
 void InlineSkipList<Comparator>::FindSpliceForLevel(const DecodedKey& key,
+                                                    uint64_t key_prefix,
                                                     Node* before, Node* after,
                                                     int level, Node** out_prev,
                                                     Node** out_next) {
@@ -747,9 +855,9 @@ void InlineSkipList<Comparator>::FindSpliceForLevel(const DecodedKey& key,
       }
     }
     assert(before == head_ || next == nullptr ||
-           KeyIsAfterNode(next->Key(), before));
+           KeyIsAfterNode(KeyOf(next), before));
     assert(before == head_ || KeyIsAfterNode(key, before));
-    if (next == after || !KeyIsAfterNode(key, next)) {
+    if (next == after || !KeyIsAfterNode(key, key_prefix, next)) {
       // found it
       *out_prev = before;
       *out_next = next;
@@ -761,13 +869,15 @@ void InlineSkipList<Comparator>::FindSpliceForLevel(const DecodedKey& key,
 
 template <class Comparator>
 void InlineSkipList<Comparator>::RecomputeSpliceLevels(const DecodedKey& key,
+                                                       uint64_t key_prefix,
                                                        Splice* splice,
                                                        int recompute_level) {
   assert(recompute_level > 0);
   assert(recompute_level <= splice->height_);
   for (int i = recompute_level - 1; i >= 0; --i) {
-    FindSpliceForLevel<true>(key, splice->prev_[i + 1], splice->next_[i + 1], i,
-                       &splice->prev_[i], &splice->next_[i]);
+    FindSpliceForLevel<true>(key, key_prefix, splice->prev_[i + 1],
+                             splice->next_[i + 1], i, &splice->prev_[i],
+                             &splice->next_[i]);
   }
 }
 
@@ -775,8 +885,14 @@ template <class Comparator>
 template <bool UseCAS>
 bool InlineSkipList<Comparator>::Insert(const char* key, Splice* splice,
                                         bool allow_partial_splice_fix) {
-  Node* x = reinterpret_cast<Node*>(const_cast<char*>(key)) - 1;
+  Node* x = NodeOf(key);
   const DecodedKey key_decoded = compare_.decode_key(key);
+  const uint64_t key_prefix = KeyPrefixOf(key);
+  if (use_key_prefix_) {
+    // Readers see the prefix once the node is published by the release
+    // stores that link it.
+    x->SetKeyPrefix(key_prefix);
+  }
   int height = x->UnstashHeight();
   assert(height >= 1 && height <= kMaxHeight_);
 
@@ -844,7 +960,7 @@ bool InlineSkipList<Comparator>::Insert(const char* key, Splice* splice,
         // our chances of success.
         ++recompute_height;
       } else if (splice->prev_[recompute_height] != head_ &&
-                 !KeyIsAfterNode(key_decoded,
+                 !KeyIsAfterNode(key_decoded, key_prefix,
                                  splice->prev_[recompute_height])) {
         // key is from before splice
         if (allow_partial_splice_fix) {
@@ -857,7 +973,7 @@ bool InlineSkipList<Comparator>::Insert(const char* key, Splice* splice,
           // we're pessimistic, recompute everything
           recompute_height = max_height;
         }
-      } else if (KeyIsAfterNode(key_decoded,
+      } else if (KeyIsAfterNode(key_decoded, key_prefix,
                                 splice->next_[recompute_height])) {
         // key is from after splice
         if (allow_partial_splice_fix) {
@@ -876,7 +992,7 @@ bool InlineSkipList<Comparator>::Insert(const char* key, Splice* splice,
   }
   assert(recompute_height <= max_height);
   if (recompute_height > 0) {
-    RecomputeSpliceLevels(key_decoded, splice, recompute_height);
+    RecomputeSpliceLevels(key_decoded, key_prefix, splice, recompute_height);
   }
 
   bool splice_is_valid = true;
@@ -885,19 +1001,19 @@ bool InlineSkipList<Comparator>::Insert(const char* key, Splice* splice,
       while (true) {
         // Checking for duplicate keys on the level 0 is sufficient
         if (UNLIKELY(i == 0 && splice->next_[i] != nullptr &&
-                     compare_(x->Key(), splice->next_[i]->Key()) >= 0)) {
+                     compare_(KeyOf(x), KeyOf(splice->next_[i])) >= 0)) {
           // duplicate key
           return false;
         }
         if (UNLIKELY(i == 0 && splice->prev_[i] != head_ &&
-                     compare_(splice->prev_[i]->Key(), x->Key()) >= 0)) {
+                     compare_(KeyOf(splice->prev_[i]), KeyOf(x)) >= 0)) {
           // duplicate key
           return false;
         }
         assert(splice->next_[i] == nullptr ||
-               compare_(x->Key(), splice->next_[i]->Key()) < 0);
+               compare_(KeyOf(x), KeyOf(splice->next_[i])) < 0);
         assert(splice->prev_[i] == head_ ||
-               compare_(splice->prev_[i]->Key(), x->Key()) < 0);
+               compare_(KeyOf(splice->prev_[i]), KeyOf(x)) < 0);
         x->NoBarrier_SetNext(i, splice->next_[i]);
         if (splice->prev_[i]->CASNext(i, splice->next_[i], x)) {
           // success
@@ -908,8 +1024,9 @@ bool InlineSkipList<Comparator>::Insert(const char* key, Splice* splice,
         // search, because it should be unlikely that lots of nodes have
         // been inserted between prev[i] and next[i]. No point in using
         // next[i] as the after hint, because we know it is stale.
-        FindSpliceForLevel<false>(key_decoded, splice->prev_[i], nullptr, i,
-                                  &splice->prev_[i], &splice->next_[i]);
+        FindSpliceForLevel<false>(key_decoded, key_prefix, splice->prev_[i],
+                                  nullptr, i, &splice->prev_[i],
+                                  &splice->next_[i]);
 
         // Since we've narrowed the bracket for level i, we might have
         // violated the Splice constraint between i and i-1.  Make sure
@@ -923,24 +1040,25 @@ bool InlineSkipList<Comparator>::Insert(const char* key, Splice* splice,
     for (int i = 0; i < height; ++i) {
       if (i >= recompute_height &&
           splice->prev_[i]->Next(i) != splice->next_[i]) {
-        FindSpliceForLevel<false>(key_decoded, splice->prev_[i], nullptr, i,
-                                  &splice->prev_[i], &splice->next_[i]);
+        FindSpliceForLevel<false>(key_decoded, key_prefix, splice->prev_[i],
+                                  nullptr, i, &splice->prev_[i],
+                                  &splice->next_[i]);
       }
       // Checking for duplicate keys on the level 0 is sufficient
       if (UNLIKELY(i == 0 && splice->next_[i] != nullptr &&
-                   compare_(x->Key(), splice->next_[i]->Key()) >= 0)) {
+                   compare_(KeyOf(x), KeyOf(splice->next_[i])) >= 0)) {
         // duplicate key
         return false;
       }
       if (UNLIKELY(i == 0 && splice->prev_[i] != head_ &&
-                   compare_(splice->prev_[i]->Key(), x->Key()) >= 0)) {
+                   compare_(KeyOf(splice->prev_[i]), KeyOf(x)) >= 0)) {
         // duplicate key
         return false;
       }
       assert(splice->next_[i] == nullptr ||
-             compare_(x->Key(), splice->next_[i]->Key()) < 0);
+             compare_(KeyOf(x), KeyOf(splice->next_[i])) < 0);
       assert(splice->prev_[i] == head_ ||
-             compare_(splice->prev_[i]->Key(), x->Key()) < 0);
+             compare_(KeyOf(splice->prev_[i]), KeyOf(x)) < 0);
       assert(splice->prev_[i]->Next(i) == splice->next_[i]);
       x->NoBarrier_SetNext(i, splice->next_[i]);
       splice->prev_[i]->SetNext(i, x);
@@ -954,16 +1072,16 @@ bool InlineSkipList<Comparator>::Insert(const char* key, Splice* splice,
     assert(splice->next_[splice->height_] == nullptr);
     for (int i = 0; i < splice->height_; ++i) {
       assert(splice->next_[i] == nullptr ||
-             compare_(key, splice->next_[i]->Key()) < 0);
+             compare_(key, KeyOf(splice->next_[i])) < 0);
       assert(splice->prev_[i] == head_ ||
-             compare_(splice->prev_[i]->Key(), key) <= 0);
+             compare_(KeyOf(splice->prev_[i]), key) <= 0);
       assert(splice->prev_[i + 1] == splice->prev_[i] ||
              splice->prev_[i + 1] == head_ ||
-             compare_(splice->prev_[i + 1]->Key(), splice->prev_[i]->Key()) <
+             compare_(KeyOf(splice->prev_[i + 1]), KeyOf(splice->prev_[i])) <
                  0);
       assert(splice->next_[i + 1] == splice->next_[i] ||
              splice->next_[i + 1] == nullptr ||
-             compare_(splice->next_[i]->Key(), splice->next_[i + 1]->Key()) <
+             compare_(KeyOf(splice->next_[i]), KeyOf(splice->next_[i + 1])) <
                  0);
     }
   } else {
@@ -975,7 +1093,7 @@ bool InlineSkipList<Comparator>::Insert(const char* key, Splice* splice,
 template <class Comparator>
 bool InlineSkipList<Comparator>::Contains(const char* key) const {
   Node* x = FindGreaterOrEqual(key);
-  if (x != nullptr && Equal(key, x->Key())) {
+  if (x != nullptr && Equal(key, KeyOf(x))) {
     return true;
   } else {
     return false;
@@ -998,7 +1116,7 @@ void InlineSkipList<Comparator>::TEST_Validate() const {
     if (l0_next == nullptr) {
       break;
     }
-    assert(nodes[0] == head_ || compare_(nodes[0]->Key(), l0_next->Key()) < 0);
+    assert(nodes[0] == head_ || compare_(KeyOf(nodes[0]), KeyOf(l0_next)) < 0);
     nodes[0] = l0_next;
 
     int i = 1;
@@ -1007,7 +1125,7 @@ void InlineSkipList<Comparator>::TEST_Validate() const {
       if (next == nullptr) {
         break;
       }
-      auto cmp = compare_(nodes[0]->Key(), next->Key());
+      auto cmp = compare_(KeyOf(nodes[0]), KeyOf(next));
       assert(cmp <= 0);
       if (cmp == 0) {
         assert(next == nodes[0]);
@@ -10,6 +10,7 @@
 #include "memtable/inlineskiplist.h"
 #include <set>
 #include <unordered_set>
+#include <vector>
 #include "memory/concurrent_arena.h"
 #include "rocksdb/env.h"
 #include "test_util/testharness.h"
@@ -57,6 +58,9 @@ struct TestComparator {
       return 0;
     }
   }
+
+  // Coarse, so that many keys share a prefix.
+  uint64_t KeyPrefix(const char* key) const { return Decode(key) >> 6; }
 };
 
 typedef InlineSkipList<TestComparator> TestInlineSkipList;
@@ -170,6 +174,14 @@ TEST_F(InlineSkipTest, InsertAndLookup) {
     iter.SeekToLast();
     ASSERT_TRUE(iter.Valid());
     ASSERT_EQ(*(keys.rbegin()), Decode(iter.key()));
+
+    InlineSkipList<TestComparator>::Iterator entry_iter(&list);
+    entry_iter.SeekToEntry(iter.key());
+    ASSERT_TRUE(entry_iter.Valid());
+    ASSERT_EQ(*(keys.rbegin()), Decode(entry_iter.key()));
+    entry_iter.Prev();
+    iter.Prev();
+    ASSERT_EQ(Decode(iter.key()), Decode(entry_iter.key()));
   }
 
   // Forward iteration test
@@ -309,6 +321,107 @@ TEST_F(InlineSkipTest, InsertWithHint_CompatibleWithInsertWithoutHint) {
   Validate(&list);
 }
 
+TEST_F(InlineSkipTest, SampleKeys) {
+  ConcurrentArena arena;
+  TestComparator cmp;
+  InlineSkipList<TestComparator> list(cmp, &arena);
+  std::vector<const char*> samples;
+  list.SampleKeys(10, &samples);
+  ASSERT_TRUE(samples.empty());
+
+  const int N = 20000;
+  for (Key key = 0; key < N; key++) {
+    char* buf = list.AllocateKey(sizeof(Key));
+    memcpy(buf, &key, sizeof(Key));
+    list.Insert(buf);
+  }
+  for (size_t target : {1, 10, 100, 1000}) {
+    samples.clear();
+    list.SampleKeys(target, &samples);
+    // One level of a list with branching factor 4 holds about 4 times
+    // fewer keys than the one below.
+    ASSERT_GE(samples.size(), target);
+    ASSERT_LE(samples.size(), target * 16);
+    for (size_t i = 1; i < samples.size(); i++) {
+      ASSERT_LT(Decode(samples[i - 1]), Decode(samples[i]));
+    }
+  }
+  samples.clear();
+  list.SampleKeys(N + 1, &samples);
+  ASSERT_EQ(static_cast<size_t>(N), samples.size());
+}
+
+TEST_F(InlineSkipTest, KeyPrefix) {
+  const int N = 20000;
+  Random rnd(301);
+  ConcurrentArena arena;
+  TestComparator cmp;
+  TestInlineSkipList list(cmp, &arena, 12 /* max_height */,
+                          4 /* branching_factor */, true /* use_key_prefix */);
+  std::set<Key> keys;
+  void* hint = nullptr;
+  for (int i = 0; i < N; i++) {
+    Key key = rnd.Uniform(N * 4);
+    if (!keys.insert(key).second) {
+      continue;
+    }
+    if (i % 2 == 0) {
+      Insert(&list, key);
+    } else {
+      InsertWithHint(&list, key, &hint);
+    }
+  }
+  Validate(&list);
+
+  // Duplicates are still detected.
+  Key dup = *keys.begin();
+  char* buf = list.AllocateKey(sizeof(Key));
+  memcpy(buf, &dup, sizeof(Key));
+  ASSERT_FALSE(list.Insert(buf));
+
+  TestInlineSkipList::Iterator iter(&list);
+  auto model_iter = keys.rbegin();
+  for (iter.SeekToLast(); iter.Valid(); iter.Prev(), ++model_iter) {
+    ASSERT_EQ(*model_iter, Decode(iter.key()));
+  }
+  ASSERT_TRUE(model_iter == keys.rend());
+  Key target = N;
+  iter.SeekForPrev(Encode(&target));
+  ASSERT_TRUE(iter.Valid());
+  ASSERT_EQ(*--keys.upper_bound(target), Decode(iter.key()));
+  TestInlineSkipList::Iterator entry_iter(&list);
+  entry_iter.SeekToEntry(iter.key());
+  ASSERT_TRUE(entry_iter.Valid());
+  ASSERT_EQ(Decode(iter.key()), Decode(entry_iter.key()));
+
+  // Concurrent inserts.
+  const int kThreads = 4;
+  TestInlineSkipList concurrent_list(cmp, &arena, 12 /* max_height */,
+                                     4 /* branching_factor */,
+                                     true /* use_key_prefix */);
+  std::vector<port::Thread> threads;
+  for (int t = 0; t < kThreads; t++) {
+    threads.emplace_back([&concurrent_list, t]() {
+      for (Key key = t; key < static_cast<Key>(N); key += kThreads) {
+        char* key_buf = concurrent_list.AllocateKey(sizeof(Key));
+        memcpy(key_buf, &key, sizeof(Key));
+        ASSERT_TRUE(concurrent_list.InsertConcurrently(key_buf));
+      }
+    });
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+  concurrent_list.TEST_Validate();
+  TestInlineSkipList::Iterator concurrent_iter(&concurrent_list);
+  Key expected = 0;
+  for (concurrent_iter.SeekToFirst(); concurrent_iter.Valid();
+       concurrent_iter.Next()) {
+    ASSERT_EQ(expected++, Decode(concurrent_iter.key()));
+  }
+  ASSERT_EQ(static_cast<Key>(N), expected);
+}
+
 #ifndef ROCKSDB_VALGRIND_RUN
 // We want to make sure that with a single writer and multiple
 // concurrent readers (with no synchronization other than when a
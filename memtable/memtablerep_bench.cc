@@ -15,6 +15,8 @@ int main() {
 }
 #else
 
+#include <inttypes.h>
+
 #include <atomic>
 #include <iostream>
 #include <memory>
@@ -24,7 +26,9 @@ int main() {
 
 #include "db/dbformat.h"
 #include "db/memtable.h"
-#include "memory/arena.h"
+#include "memory/concurrent_arena.h"
+#include "memtable/skiplist.h"
+#include "monitoring/latency_timeline.h"
 #include "port/port.h"
 #include "port/stack_trace.h"
 #include "rocksdb/comparator.h"
@@ -35,8 +39,10 @@ int main() {
 #include "rocksdb/write_buffer_manager.h"
 #include "test_util/testutil.h"
 #include "util/gflags_compat.h"
+#include "util/key_distribution.h"
 #include "util/mutexlock.h"
 #include "util/stop_watch.h"
+#include "util/string_util.h"
 
 using GFLAGS_NAMESPACE::ParseCommandLineFlags;
 using GFLAGS_NAMESPACE::RegisterFlagValidator;
@@ -46,23 +52,35 @@ DEFINE_string(benchmarks, "fillrandom",
               "Comma-separated list of benchmarks to run. Options:\n"
               "\tfillrandom             -- write N random values\n"
               "\tfillseq                -- write N values in sequential order\n"
-              "\treadrandom             -- read N values in random order\n"
+              "\tfillconcurrent         -- write N random values from "
+              "--num_threads\n"
+              "\t                          threads using InsertConcurrently()\n"
+              "\treadrandom             -- read N values drawn from "
+              "--key_distribution\n"
               "\treadseq                -- scan the DB\n"
               "\treadwrite              -- 1 thread writes while N - 1 threads "
               "do random\n"
               "\t                          reads\n"
               "\tseqreadwrite           -- 1 thread writes while N - 1 threads "
-              "do scans\n");
+              "do scans\n"
+              "\tmixed                  -- every thread mixes reads and writes "
+              "as set by\n"
+              "\t                          --read_ratio\n");
 
 DEFINE_string(memtablerep, "skiplist",
-              "Which implementation of memtablerep to use. See "
-              "include/memtablerep.h for\n"
+              "Comma-separated list of memtablerep implementations to "
+              "benchmark, one after another. See include/memtablerep.h for\n"
               "  more details. Options:\n"
-              "\tskiplist            -- backed by a skiplist\n"
+              "\tskiplist            -- backed by an InlineSkipList\n"
+              "\tprefixskiplist      -- backed by an InlineSkipList whose "
+              "nodes store key prefixes\n"
+              "\tclassic_skiplist    -- backed by the non-inline SkipList\n"
               "\tvector              -- backed by an std::vector\n"
               "\thashskiplist        -- backed by a hash skip list\n"
               "\thashlinklist        -- backed by a hash linked list\n"
-              "\tcuckoo              -- backed by a cuckoo hash table");
+              "\thashindexedskiplist -- backed by an InlineSkipList with a "
+              "hash index for point lookups\n"
+              "\tart                 -- backed by an adaptive radix tree");
 
 DEFINE_int64(bucket_count, 1000000,
              "bucket_count parameter to pass into NewHashSkiplistRepFactory or "
@@ -97,8 +115,12 @@ DEFINE_int64(write_buffer_size, 256,
 
 DEFINE_int32(
     num_threads, 1,
-    "Number of concurrent threads to run. If the benchmark includes writes,\n"
-    "then at most one thread will be a writer");
+    "Number of concurrent threads to run. For readwrite and seqreadwrite\n"
+    "one of them is the writer");
+
+DEFINE_string(thread_counts, "",
+              "Comma-separated list of thread counts, e.g. 1,2,4,8. The "
+              "benchmarks are run once per count, overriding --num_threads");
 
 DEFINE_int32(num_operations, 1000000,
              "Number of operations to do for write and random read benchmarks");
@@ -113,10 +135,27 @@ DEFINE_int32(item_size, 100, "Number of bytes each item should be");
 DEFINE_int32(prefix_length, 8,
              "Prefix length to pass into NewFixedPrefixTransform");
 
+DEFINE_string(key_distribution, "uniform",
+              "Distribution of the keys read by readrandom, readwrite and "
+              "mixed, and of the keys written by mixed: uniform, zipfian, "
+              "scrambled_zipfian, latest, hotspot or exponential. Keys are "
+              "drawn from [0, num_operations)");
+
+DEFINE_int32(read_ratio, 90,
+             "Percentage of the operations of the mixed benchmark that are "
+             "reads; the rest are writes");
+
+DEFINE_bool(histogram, true,
+            "Time every operation and report latency percentiles. Disable to "
+            "keep the clock reads out of the throughput numbers");
+
 /* VectorRep settings */
 DEFINE_int64(vectorrep_count, 0,
              "Number of entries to reserve on VectorRep initialization");
 
+DEFINE_int32(vectorrep_sort_threads, 1,
+             "Number of threads that sort a VectorRep for iteration");
+
 DEFINE_int64(seed, 0,
              "Seed base for random number generators. "
              "When 0 it is deterministic.");
@@ -128,10 +167,125 @@ struct CallbackVerifyArgs {
   bool found;
   LookupKey* key;
   MemTableRep* table;
-  InternalKeyComparator* comparator;
+  const InternalKeyComparator* comparator;
 };
 }  // namespace
 
+// Forwards to MemTable::KeyComparator and counts the comparisons made by
+// the calling thread, so that lookups and inserts can report how many
+// comparisons they took whatever the memtablerep.
+class CountingKeyComparator : public MemTableRep::KeyComparator {
+ public:
+  explicit CountingKeyComparator(const InternalKeyComparator& comparator)
+      : comparator_(comparator) {}
+
+  DecodedType decode_key(const char* key) const override {
+    return comparator_.decode_key(key);
+  }
+
+  int operator()(const char* prefix_len_key1,
+                 const char* prefix_len_key2) const override {
+    ++count_;
+    return comparator_(prefix_len_key1, prefix_len_key2);
+  }
+
+  int operator()(const char* prefix_len_key, const Slice& key) const override {
+    ++count_;
+    return comparator_(prefix_len_key, key);
+  }
+
+  // Comparisons made so far by the calling thread.
+  static uint64_t count() { return count_; }
+
+ private:
+  static thread_local uint64_t count_;
+  const MemTable::KeyComparator comparator_;
+};
+
+thread_local uint64_t CountingKeyComparator::count_ = 0;
+
+// MemTableRep over the original, non-inline SkipList, to compare it with
+// the InlineSkipList behind SkipListFactory.
+class ClassicSkipListRep : public MemTableRep {
+ public:
+  ClassicSkipListRep(const MemTableRep::KeyComparator& compare,
+                     Allocator* allocator)
+      : MemTableRep(allocator), skip_list_(compare, allocator, 12, 4) {}
+
+  void Insert(KeyHandle handle) override {
+    skip_list_.Insert(static_cast<char*>(handle));
+  }
+
+  bool Contains(const char* key) const override {
+    return skip_list_.Contains(key);
+  }
+
+  size_t ApproximateMemoryUsage() override { return 0; }
+
+  void Get(const LookupKey& k, void* callback_args,
+           bool (*callback_func)(void* arg, const char* entry)) override {
+    Iterator iter(&skip_list_);
+    for (iter.Seek(Slice(), k.memtable_key().data());
+         iter.Valid() && callback_func(callback_args, iter.key());
+         iter.Next()) {
+    }
+  }
+
+  MemTableRep::Iterator* GetIterator(Arena* arena) override {
+    if (arena == nullptr) {
+      return new Iterator(&skip_list_);
+    }
+    auto mem = arena->AllocateAligned(sizeof(Iterator));
+    return new (mem) Iterator(&skip_list_);
+  }
+
+ private:
+  typedef SkipList<const char*, const MemTableRep::KeyComparator&> Bucket;
+
+  class Iterator : public MemTableRep::Iterator {
+   public:
+    explicit Iterator(const Bucket* list) : iter_(list) {}
+
+    bool Valid() const override { return iter_.Valid(); }
+    const char* key() const override { return iter_.key(); }
+    void Next() override { iter_.Next(); }
+    void Prev() override { iter_.Prev(); }
+
+    void Seek(const Slice& internal_key, const char* memtable_key) override {
+      iter_.Seek(memtable_key != nullptr ? memtable_key
+                                         : EncodeKey(&tmp_, internal_key));
+    }
+
+    void SeekForPrev(const Slice& internal_key,
+                     const char* memtable_key) override {
+      iter_.SeekForPrev(memtable_key != nullptr
+                            ? memtable_key
+                            : EncodeKey(&tmp_, internal_key));
+    }
+
+    void SeekToFirst() override { iter_.SeekToFirst(); }
+    void SeekToLast() override { iter_.SeekToLast(); }
+
+   private:
+    Bucket::Iterator iter_;
+    std::string tmp_;
+  };
+
+  Bucket skip_list_;
+};
+
+class ClassicSkipListFactory : public MemTableRepFactory {
+ public:
+  using MemTableRepFactory::CreateMemTableRep;
+  MemTableRep* CreateMemTableRep(const MemTableRep::KeyComparator& compare,
+                                 Allocator* allocator,
+                                 const SliceTransform* /*transform*/,
+                                 Logger* /*logger*/) override {
+    return new ClassicSkipListRep(compare, allocator);
+  }
+  const char* Name() const override { return "ClassicSkipListFactory"; }
+};
+
 // Helper for quickly generating random data.
 class RandomGenerator {
  private:
@@ -158,10 +312,13 @@ class RandomGenerator {
 
 enum WriteMode { SEQUENTIAL, RANDOM, UNIQUE_RANDOM };
 
+// Shared by all the threads of a benchmark. SEQUENTIAL and UNIQUE_RANDOM
+// hand out every key once across the threads; RANDOM draws from the calling
+// thread's distribution.
 class KeyGenerator {
  public:
-  KeyGenerator(Random64* rand, WriteMode mode, uint64_t num)
-      : rand_(rand), mode_(mode), num_(num), next_(0) {
+  KeyGenerator(WriteMode mode, uint64_t num)
+      : mode_(mode), num_(num), next_(0) {
     if (mode_ == UNIQUE_RANDOM) {
       // NOTE: if memory consumption of this approach becomes a concern,
       // we can either break it into pieces and only random shuffle a section
@@ -176,64 +333,89 @@ class KeyGenerator {
     }
   }
 
-  uint64_t Next() {
+  uint64_t Next(Random64* rand, KeyDistribution* dist) {
     switch (mode_) {
       case SEQUENTIAL:
-        return next_++;
+        return next_.fetch_add(1, std::memory_order_relaxed);
       case RANDOM:
-        return rand_->Next() % num_;
+        return dist->Next(rand);
       case UNIQUE_RANDOM:
-        return values_[next_++];
+        return values_[next_.fetch_add(1, std::memory_order_relaxed) % num_];
     }
     assert(false);
     return std::numeric_limits<uint64_t>::max();
   }
 
  private:
-  Random64* rand_;
   WriteMode mode_;
   const uint64_t num_;
-  uint64_t next_;
+  std::atomic<uint64_t> next_;
   std::vector<uint64_t> values_;
 };
 
+// Results of one thread, merged once the threads are joined.
+struct ThreadStats {
+  uint64_t bytes_written = 0;
+  uint64_t bytes_read = 0;
+  uint64_t read_hits = 0;
+  uint64_t writes = 0;
+  uint64_t reads = 0;
+  uint64_t write_comparisons = 0;
+  uint64_t read_comparisons = 0;
+  LogLinearHistogram write_latency;
+  LogLinearHistogram read_latency;
+
+  void Merge(const ThreadStats& other) {
+    bytes_written += other.bytes_written;
+    bytes_read += other.bytes_read;
+    read_hits += other.read_hits;
+    writes += other.writes;
+    reads += other.reads;
+    write_comparisons += other.write_comparisons;
+    read_comparisons += other.read_comparisons;
+    write_latency.Merge(other.write_latency);
+    read_latency.Merge(other.read_latency);
+  }
+};
+
 class BenchmarkThread {
  public:
   explicit BenchmarkThread(MemTableRep* table, KeyGenerator* key_gen,
-                           uint64_t* bytes_written, uint64_t* bytes_read,
-                           uint64_t* sequence, uint64_t num_ops,
-                           uint64_t* read_hits)
+                           std::atomic<uint64_t>* sequence, uint64_t num_ops,
+                           ThreadStats* stats, uint32_t thread_index)
       : table_(table),
         key_gen_(key_gen),
-        bytes_written_(bytes_written),
-        bytes_read_(bytes_read),
         sequence_(sequence),
         num_ops_(num_ops),
-        read_hits_(read_hits) {}
+        stats_(stats),
+        rand_(FLAGS_seed + 1000 * (thread_index + 1)),
+        clock_(SystemClock::Default().get()),
+        internal_key_comp_(BytewiseComparator()) {
+    KeyDistributionType type;
+    if (!ParseKeyDistributionType(FLAGS_key_distribution, &type)) {
+      type = KeyDistributionType::kUniform;
+    }
+    dist_ = KeyDistribution::Create(type, FLAGS_num_operations);
+  }
 
   virtual void operator()() = 0;
   virtual ~BenchmarkThread() {}
 
  protected:
-  MemTableRep* table_;
-  KeyGenerator* key_gen_;
-  uint64_t* bytes_written_;
-  uint64_t* bytes_read_;
-  uint64_t* sequence_;
-  uint64_t num_ops_;
-  uint64_t* read_hits_;
-  RandomGenerator generator_;
-};
+  uint64_t StartTimer() const {
+    return FLAGS_histogram ? clock_->NowNanos() : 0;
+  }
 
-class FillBenchmarkThread : public BenchmarkThread {
- public:
-  FillBenchmarkThread(MemTableRep* table, KeyGenerator* key_gen,
-                      uint64_t* bytes_written, uint64_t* bytes_read,
-                      uint64_t* sequence, uint64_t num_ops, uint64_t* read_hits)
-      : BenchmarkThread(table, key_gen, bytes_written, bytes_read, sequence,
-                        num_ops, read_hits) {}
+  void StopTimer(uint64_t start, LogLinearHistogram* hist) const {
+    if (FLAGS_histogram) {
+      hist->Add(clock_->NowNanos() - start);
+    }
+  }
 
-  void FillOne() {
+  // Inserts one item, using InsertConcurrently() if `concurrently`.
+  void FillOne(bool concurrently) {
+    uint64_t comparisons = CountingKeyComparator::count();
+    uint64_t start = StartTimer();
     char* buf = nullptr;
     auto internal_key_size = 16;
     auto encoded_len =
@@ -241,58 +423,30 @@ class FillBenchmarkThread : public BenchmarkThread {
     KeyHandle handle = table_->Allocate(encoded_len, &buf);
     assert(buf != nullptr);
     char* p = EncodeVarint32(buf, internal_key_size);
-    auto key = key_gen_->Next();
+    auto key = key_gen_->Next(&rand_, dist_.get());
     EncodeFixed64(p, key);
     p += 8;
-    EncodeFixed64(p, ++(*sequence_));
+    // Keys may repeat, so each insert gets its own sequence number.
+    EncodeFixed64(p, PackSequenceAndType(
+                         sequence_->fetch_add(1, std::memory_order_relaxed) + 1,
+                         kTypeValue));
     p += 8;
     Slice bytes = generator_.Generate(FLAGS_item_size);
     memcpy(p, bytes.data(), FLAGS_item_size);
     p += FLAGS_item_size;
     assert(p == buf + encoded_len);
-    table_->Insert(handle);
-    *bytes_written_ += encoded_len;
-  }
-
-  void operator()() override {
-    for (unsigned int i = 0; i < num_ops_; ++i) {
-      FillOne();
-    }
-  }
-};
-
-class ConcurrentFillBenchmarkThread : public FillBenchmarkThread {
- public:
-  ConcurrentFillBenchmarkThread(MemTableRep* table, KeyGenerator* key_gen,
-                                uint64_t* bytes_written, uint64_t* bytes_read,
-                                uint64_t* sequence, uint64_t num_ops,
-                                uint64_t* read_hits,
-                                std::atomic_int* threads_done)
-      : FillBenchmarkThread(table, key_gen, bytes_written, bytes_read, sequence,
-                            num_ops, read_hits) {
-    threads_done_ = threads_done;
-  }
-
-  void operator()() override {
-    // # of read threads will be total threads - write threads (always 1). Loop
-    // while all reads complete.
-    while ((*threads_done_).load() < (FLAGS_num_threads - 1)) {
-      FillOne();
+    if (concurrently) {
+      table_->InsertConcurrently(handle);
+    } else {
+      table_->Insert(handle);
     }
+    dist_->ObserveInsert(key);
+    StopTimer(start, &stats_->write_latency);
+    stats_->write_comparisons += CountingKeyComparator::count() - comparisons;
+    stats_->bytes_written += encoded_len;
+    stats_->writes++;
   }
 
- private:
-  std::atomic_int* threads_done_;
-};
-
-class ReadBenchmarkThread : public BenchmarkThread {
- public:
-  ReadBenchmarkThread(MemTableRep* table, KeyGenerator* key_gen,
-                      uint64_t* bytes_written, uint64_t* bytes_read,
-                      uint64_t* sequence, uint64_t num_ops, uint64_t* read_hits)
-      : BenchmarkThread(table, key_gen, bytes_written, bytes_read, sequence,
-                        num_ops, read_hits) {}
-
   static bool callback(void* arg, const char* entry) {
     CallbackVerifyArgs* callback_args = static_cast<CallbackVerifyArgs*>(arg);
     assert(callback_args != nullptr);
@@ -308,50 +462,121 @@ class ReadBenchmarkThread : public BenchmarkThread {
   }
 
   void ReadOne() {
+    uint64_t comparisons = CountingKeyComparator::count();
+    uint64_t start = StartTimer();
     std::string user_key;
-    auto key = key_gen_->Next();
+    auto key = key_gen_->Next(&rand_, dist_.get());
     PutFixed64(&user_key, key);
-    LookupKey lookup_key(user_key, *sequence_);
-    InternalKeyComparator internal_key_comp(BytewiseComparator());
+    LookupKey lookup_key(user_key,
+                         sequence_->load(std::memory_order_relaxed));
     CallbackVerifyArgs verify_args;
     verify_args.found = false;
     verify_args.key = &lookup_key;
     verify_args.table = table_;
-    verify_args.comparator = &internal_key_comp;
+    verify_args.comparator = &internal_key_comp_;
     table_->Get(lookup_key, &verify_args, callback);
+    StopTimer(start, &stats_->read_latency);
+    stats_->read_comparisons += CountingKeyComparator::count() - comparisons;
+    stats_->reads++;
     if (verify_args.found) {
-      *bytes_read_ += VarintLength(16) + 16 + FLAGS_item_size;
-      ++*read_hits_;
+      stats_->bytes_read += VarintLength(16) + 16 + FLAGS_item_size;
+      stats_->read_hits++;
+    }
+  }
+
+  void ReadOneSeq() {
+    uint64_t start = StartTimer();
+    std::unique_ptr<MemTableRep::Iterator> iter(table_->GetIterator());
+    for (iter->SeekToFirst(); iter->Valid(); iter->Next()) {
+      // pretend to read the value
+      stats_->bytes_read += VarintLength(16) + 16 + FLAGS_item_size;
     }
+    StopTimer(start, &stats_->read_latency);
+    stats_->reads++;
+    stats_->read_hits++;
   }
+
+  MemTableRep* table_;
+  KeyGenerator* key_gen_;
+  std::atomic<uint64_t>* sequence_;
+  uint64_t num_ops_;
+  ThreadStats* stats_;
+  Random64 rand_;
+  std::shared_ptr<KeyDistribution> dist_;
+  SystemClock* clock_;
+  InternalKeyComparator internal_key_comp_;
+  RandomGenerator generator_;
+};
+
+class FillBenchmarkThread : public BenchmarkThread {
+ public:
+  FillBenchmarkThread(MemTableRep* table, KeyGenerator* key_gen,
+                      std::atomic<uint64_t>* sequence, uint64_t num_ops,
+                      ThreadStats* stats, uint32_t thread_index,
+                      bool concurrently = false)
+      : BenchmarkThread(table, key_gen, sequence, num_ops, stats,
+                        thread_index),
+        concurrently_(concurrently) {}
+
   void operator()() override {
     for (unsigned int i = 0; i < num_ops_; ++i) {
-      ReadOne();
+      FillOne(concurrently_);
     }
   }
+
+ private:
+  const bool concurrently_;
 };
 
-class SeqReadBenchmarkThread : public BenchmarkThread {
+class ConcurrentFillBenchmarkThread : public BenchmarkThread {
  public:
-  SeqReadBenchmarkThread(MemTableRep* table, KeyGenerator* key_gen,
-                         uint64_t* bytes_written, uint64_t* bytes_read,
-                         uint64_t* sequence, uint64_t num_ops,
-                         uint64_t* read_hits)
-      : BenchmarkThread(table, key_gen, bytes_written, bytes_read, sequence,
-                        num_ops, read_hits) {}
+  ConcurrentFillBenchmarkThread(MemTableRep* table, KeyGenerator* key_gen,
+                                std::atomic<uint64_t>* sequence,
+                                uint64_t num_ops, ThreadStats* stats,
+                                uint32_t thread_index,
+                                std::atomic_int* threads_done)
+      : BenchmarkThread(table, key_gen, sequence, num_ops, stats,
+                        thread_index),
+        threads_done_(threads_done) {}
 
-  void ReadOneSeq() {
-    std::unique_ptr<MemTableRep::Iterator> iter(table_->GetIterator());
-    for (iter->SeekToFirst(); iter->Valid(); iter->Next()) {
-      // pretend to read the value
-      *bytes_read_ += VarintLength(16) + 16 + FLAGS_item_size;
+  void operator()() override {
+    // # of read threads will be total threads - write threads (always 1). Loop
+    // while all reads complete.
+    while ((*threads_done_).load() < (FLAGS_num_threads - 1)) {
+      FillOne(false);
+    }
+  }
+
+ private:
+  std::atomic_int* threads_done_;
+};
+
+class ReadBenchmarkThread : public BenchmarkThread {
+ public:
+  ReadBenchmarkThread(MemTableRep* table, KeyGenerator* key_gen,
+                      std::atomic<uint64_t>* sequence, uint64_t num_ops,
+                      ThreadStats* stats, uint32_t thread_index)
+      : BenchmarkThread(table, key_gen, sequence, num_ops, stats,
+                        thread_index) {}
+
+  void operator()() override {
+    for (unsigned int i = 0; i < num_ops_; ++i) {
+      ReadOne();
     }
-    ++*read_hits_;
   }
+};
+
+class SeqReadBenchmarkThread : public BenchmarkThread {
+ public:
+  SeqReadBenchmarkThread(MemTableRep* table, KeyGenerator* key_gen,
+                         std::atomic<uint64_t>* sequence, uint64_t num_ops,
+                         ThreadStats* stats, uint32_t thread_index)
+      : BenchmarkThread(table, key_gen, sequence, num_ops, stats,
+                        thread_index) {}
 
   void operator()() override {
     for (unsigned int i = 0; i < num_ops_; ++i) {
-      { ReadOneSeq(); }
+      ReadOneSeq();
     }
   }
 };
@@ -359,19 +584,16 @@ class SeqReadBenchmarkThread : public BenchmarkThread {
 class ConcurrentReadBenchmarkThread : public ReadBenchmarkThread {
  public:
   ConcurrentReadBenchmarkThread(MemTableRep* table, KeyGenerator* key_gen,
-                                uint64_t* bytes_written, uint64_t* bytes_read,
-                                uint64_t* sequence, uint64_t num_ops,
-                                uint64_t* read_hits,
+                                std::atomic<uint64_t>* sequence,
+                                uint64_t num_ops, ThreadStats* stats,
+                                uint32_t thread_index,
                                 std::atomic_int* threads_done)
-      : ReadBenchmarkThread(table, key_gen, bytes_written, bytes_read, sequence,
-                            num_ops, read_hits) {
-    threads_done_ = threads_done;
-  }
+      : ReadBenchmarkThread(table, key_gen, sequence, num_ops, stats,
+                            thread_index),
+        threads_done_(threads_done) {}
 
   void operator()() override {
-    for (unsigned int i = 0; i < num_ops_; ++i) {
-      ReadOne();
-    }
+    ReadBenchmarkThread::operator()();
     ++*threads_done_;
   }
 
@@ -382,141 +604,213 @@ class ConcurrentReadBenchmarkThread : public ReadBenchmarkThread {
 class SeqConcurrentReadBenchmarkThread : public SeqReadBenchmarkThread {
  public:
   SeqConcurrentReadBenchmarkThread(MemTableRep* table, KeyGenerator* key_gen,
-                                   uint64_t* bytes_written,
-                                   uint64_t* bytes_read, uint64_t* sequence,
-                                   uint64_t num_ops, uint64_t* read_hits,
+                                   std::atomic<uint64_t>* sequence,
+                                   uint64_t num_ops, ThreadStats* stats,
+                                   uint32_t thread_index,
                                    std::atomic_int* threads_done)
-      : SeqReadBenchmarkThread(table, key_gen, bytes_written, bytes_read,
-                               sequence, num_ops, read_hits) {
-    threads_done_ = threads_done;
+      : SeqReadBenchmarkThread(table, key_gen, sequence, num_ops, stats,
+                               thread_index),
+        threads_done_(threads_done) {}
+
+  void operator()() override {
+    SeqReadBenchmarkThread::operator()();
+    ++*threads_done_;
   }
 
+ private:
+  std::atomic_int* threads_done_;
+};
+
+// Reads with probability --read_ratio and writes otherwise. Writes go
+// through InsertConcurrently() when the rep supports it; otherwise they are
+// serialized on `write_mutex`, which memtablereps allow alongside readers.
+class MixedBenchmarkThread : public BenchmarkThread {
+ public:
+  MixedBenchmarkThread(MemTableRep* table, KeyGenerator* key_gen,
+                       std::atomic<uint64_t>* sequence, uint64_t num_ops,
+                       ThreadStats* stats, uint32_t thread_index,
+                       port::Mutex* write_mutex)
+      : BenchmarkThread(table, key_gen, sequence, num_ops, stats,
+                        thread_index),
+        write_mutex_(write_mutex) {}
+
   void operator()() override {
     for (unsigned int i = 0; i < num_ops_; ++i) {
-      ReadOneSeq();
+      if (static_cast<int>(rand_.Uniform(100)) < FLAGS_read_ratio) {
+        ReadOne();
+      } else if (write_mutex_ != nullptr) {
+        MutexLock l(write_mutex_);
+        FillOne(false);
+      } else {
+        FillOne(true);
+      }
     }
-    ++*threads_done_;
   }
 
  private:
-  std::atomic_int* threads_done_;
+  port::Mutex* write_mutex_;
+};
+
+// One line of the summary printed after all benchmarks.
+struct BenchmarkResult {
+  std::string memtablerep;
+  std::string benchmark;
+  uint32_t num_threads;
+  double ops_per_sec;
+  LogLinearHistogram latency;
+  double comparisons_per_op;
 };
 
 class Benchmark {
  public:
   explicit Benchmark(MemTableRep* table, KeyGenerator* key_gen,
-                     uint64_t* sequence, uint32_t num_threads)
+                     std::atomic<uint64_t>* sequence, uint32_t num_threads)
       : table_(table),
         key_gen_(key_gen),
         sequence_(sequence),
-        num_threads_(num_threads) {}
+        num_threads_(num_threads),
+        stats_(num_threads) {}
 
   virtual ~Benchmark() {}
-  virtual void Run() {
+  virtual void Run(BenchmarkResult* result) {
     std::cout << "Number of threads: " << num_threads_ << std::endl;
     std::vector<port::Thread> threads;
-    uint64_t bytes_written = 0;
-    uint64_t bytes_read = 0;
-    uint64_t read_hits = 0;
     StopWatchNano timer(SystemClock::Default().get(), true);
-    RunThreads(&threads, &bytes_written, &bytes_read, true, &read_hits);
+    RunThreads(&threads);
     auto elapsed_time = static_cast<double>(timer.ElapsedNanos() / 1000);
     std::cout << "Elapsed time: " << static_cast<int>(elapsed_time) << " us"
               << std::endl;
 
-    if (bytes_written > 0) {
-      auto MiB_written = static_cast<double>(bytes_written) / (1 << 20);
+    ThreadStats total;
+    for (const auto& stats : stats_) {
+      total.Merge(stats);
+    }
+    if (total.bytes_written > 0) {
+      auto MiB_written = static_cast<double>(total.bytes_written) / (1 << 20);
       auto write_throughput = MiB_written / (elapsed_time / 1000000);
       std::cout << "Total bytes written: " << MiB_written << " MiB"
                 << std::endl;
       std::cout << "Write throughput: " << write_throughput << " MiB/s"
                 << std::endl;
-      auto us_per_op = elapsed_time / num_write_ops_per_thread_;
-      std::cout << "write us/op: " << us_per_op << std::endl;
+      PrintOps("write", total.writes, elapsed_time, total.write_latency,
+               total.write_comparisons, "insert");
     }
-    if (bytes_read > 0) {
-      auto MiB_read = static_cast<double>(bytes_read) / (1 << 20);
+    if (total.reads > 0) {
+      auto MiB_read = static_cast<double>(total.bytes_read) / (1 << 20);
       auto read_throughput = MiB_read / (elapsed_time / 1000000);
       std::cout << "Total bytes read: " << MiB_read << " MiB" << std::endl;
       std::cout << "Read throughput: " << read_throughput << " MiB/s"
                 << std::endl;
-      auto us_per_op = elapsed_time / num_read_ops_per_thread_;
-      std::cout << "read us/op: " << us_per_op << std::endl;
+      std::cout << "read hit%: "
+                << (static_cast<double>(total.read_hits) / total.reads) * 100
+                << std::endl;
+      PrintOps("read", total.reads, elapsed_time, total.read_latency,
+               total.read_comparisons, "lookup");
     }
+
+    uint64_t ops = total.writes + total.reads;
+    result->num_threads = num_threads_;
+    result->ops_per_sec = ops / std::max(elapsed_time / 1000000, 1e-9);
+    result->latency.Merge(total.write_latency);
+    result->latency.Merge(total.read_latency);
+    result->comparisons_per_op =
+        static_cast<double>(total.write_comparisons + total.read_comparisons) /
+        std::max<uint64_t>(ops, 1);
   }
 
-  virtual void RunThreads(std::vector<port::Thread>* threads,
-                          uint64_t* bytes_written, uint64_t* bytes_read,
-                          bool write, uint64_t* read_hits) = 0;
+  virtual void RunThreads(std::vector<port::Thread>* threads) = 0;
 
  protected:
+  static void PrintOps(const char* kind, uint64_t ops, double elapsed_time,
+                       const LogLinearHistogram& latency,
+                       uint64_t comparisons, const char* op_name) {
+    std::cout << kind << " ops/sec: "
+              << static_cast<uint64_t>(ops / (elapsed_time / 1000000))
+              << std::endl;
+    if (latency.count() > 0) {
+      char buf[200];
+      snprintf(buf, sizeof(buf),
+               "%s latency (us): avg %.3f p50 %.3f p99 %.3f p999 %.3f max "
+               "%.3f",
+               kind, latency.Average() / 1000,
+               latency.Percentile(50) / 1000.0,
+               latency.Percentile(99) / 1000.0,
+               latency.Percentile(99.9) / 1000.0, latency.max() / 1000.0);
+      std::cout << buf << std::endl;
+    }
+    std::cout << "comparisons/" << op_name << ": "
+              << static_cast<double>(comparisons) / ops << std::endl;
+  }
+
+  void JoinThreads(std::vector<port::Thread>* threads) {
+    for (auto& thread : *threads) {
+      thread.join();
+    }
+  }
+
   MemTableRep* table_;
   KeyGenerator* key_gen_;
-  uint64_t* sequence_;
-  uint64_t num_write_ops_per_thread_ = 0;
-  uint64_t num_read_ops_per_thread_ = 0;
+  std::atomic<uint64_t>* sequence_;
   const uint32_t num_threads_;
+  std::vector<ThreadStats> stats_;
 };
 
 class FillBenchmark : public Benchmark {
  public:
   explicit FillBenchmark(MemTableRep* table, KeyGenerator* key_gen,
-                         uint64_t* sequence)
-      : Benchmark(table, key_gen, sequence, 1) {
-    num_write_ops_per_thread_ = FLAGS_num_operations;
+                         std::atomic<uint64_t>* sequence)
+      : Benchmark(table, key_gen, sequence, 1) {}
+
+  void RunThreads(std::vector<port::Thread>* /*threads*/) override {
+    FillBenchmarkThread(table_, key_gen_, sequence_, FLAGS_num_operations,
+                        &stats_[0], 0)();
   }
+};
 
-  void RunThreads(std::vector<port::Thread>* /*threads*/, uint64_t* bytes_written,
-                  uint64_t* bytes_read, bool /*write*/,
-                  uint64_t* read_hits) override {
-    FillBenchmarkThread(table_, key_gen_, bytes_written, bytes_read, sequence_,
-                        num_write_ops_per_thread_, read_hits)();
+class ConcurrentFillBenchmark : public Benchmark {
+ public:
+  explicit ConcurrentFillBenchmark(MemTableRep* table, KeyGenerator* key_gen,
+                                   std::atomic<uint64_t>* sequence)
+      : Benchmark(table, key_gen, sequence, FLAGS_num_threads) {}
+
+  void RunThreads(std::vector<port::Thread>* threads) override {
+    uint64_t num_ops = FLAGS_num_operations / FLAGS_num_threads;
+    for (uint32_t i = 0; i < num_threads_; ++i) {
+      threads->emplace_back(FillBenchmarkThread(
+          table_, key_gen_, sequence_, num_ops, &stats_[i], i, true));
+    }
+    JoinThreads(threads);
   }
 };
 
 class ReadBenchmark : public Benchmark {
  public:
   explicit ReadBenchmark(MemTableRep* table, KeyGenerator* key_gen,
-                         uint64_t* sequence)
-      : Benchmark(table, key_gen, sequence, FLAGS_num_threads) {
-    num_read_ops_per_thread_ = FLAGS_num_operations / FLAGS_num_threads;
-  }
-
-  void RunThreads(std::vector<port::Thread>* threads, uint64_t* bytes_written,
-                  uint64_t* bytes_read, bool /*write*/,
-                  uint64_t* read_hits) override {
-    for (int i = 0; i < FLAGS_num_threads; ++i) {
-      threads->emplace_back(
-          ReadBenchmarkThread(table_, key_gen_, bytes_written, bytes_read,
-                              sequence_, num_read_ops_per_thread_, read_hits));
-    }
-    for (auto& thread : *threads) {
-      thread.join();
+                         std::atomic<uint64_t>* sequence)
+      : Benchmark(table, key_gen, sequence, FLAGS_num_threads) {}
+
+  void RunThreads(std::vector<port::Thread>* threads) override {
+    uint64_t num_ops = FLAGS_num_operations / FLAGS_num_threads;
+    for (uint32_t i = 0; i < num_threads_; ++i) {
+      threads->emplace_back(ReadBenchmarkThread(table_, key_gen_, sequence_,
+                                                num_ops, &stats_[i], i));
     }
-    std::cout << "read hit%: "
-              << (static_cast<double>(*read_hits) / FLAGS_num_operations) * 100
-              << std::endl;
+    JoinThreads(threads);
   }
 };
 
 class SeqReadBenchmark : public Benchmark {
  public:
-  explicit SeqReadBenchmark(MemTableRep* table, uint64_t* sequence)
-      : Benchmark(table, nullptr, sequence, FLAGS_num_threads) {
-    num_read_ops_per_thread_ = FLAGS_num_scans;
-  }
+  explicit SeqReadBenchmark(MemTableRep* table,
+                            std::atomic<uint64_t>* sequence)
+      : Benchmark(table, nullptr, sequence, FLAGS_num_threads) {}
 
-  void RunThreads(std::vector<port::Thread>* threads, uint64_t* bytes_written,
-                  uint64_t* bytes_read, bool /*write*/,
-                  uint64_t* read_hits) override {
-    for (int i = 0; i < FLAGS_num_threads; ++i) {
+  void RunThreads(std::vector<port::Thread>* threads) override {
+    for (uint32_t i = 0; i < num_threads_; ++i) {
       threads->emplace_back(SeqReadBenchmarkThread(
-          table_, key_gen_, bytes_written, bytes_read, sequence_,
-          num_read_ops_per_thread_, read_hits));
-    }
-    for (auto& thread : *threads) {
-      thread.join();
+          table_, key_gen_, sequence_, FLAGS_num_scans, &stats_[i], i));
     }
+    JoinThreads(threads);
   }
 };
 
@@ -524,34 +818,187 @@ template <class ReadThreadType>
 class ReadWriteBenchmark : public Benchmark {
  public:
   explicit ReadWriteBenchmark(MemTableRep* table, KeyGenerator* key_gen,
-                              uint64_t* sequence)
-      : Benchmark(table, key_gen, sequence, FLAGS_num_threads) {
-    num_read_ops_per_thread_ =
+                              std::atomic<uint64_t>* sequence)
+      : Benchmark(table, key_gen, sequence, FLAGS_num_threads) {}
+
+  void RunThreads(std::vector<port::Thread>* threads) override {
+    uint64_t num_read_ops_per_thread =
         FLAGS_num_threads <= 1
             ? 0
             : (FLAGS_num_operations / (FLAGS_num_threads - 1));
-    num_write_ops_per_thread_ = FLAGS_num_operations;
-  }
-
-  void RunThreads(std::vector<port::Thread>* threads, uint64_t* bytes_written,
-                  uint64_t* bytes_read, bool /*write*/,
-                  uint64_t* read_hits) override {
     std::atomic_int threads_done;
     threads_done.store(0);
     threads->emplace_back(ConcurrentFillBenchmarkThread(
-        table_, key_gen_, bytes_written, bytes_read, sequence_,
-        num_write_ops_per_thread_, read_hits, &threads_done));
-    for (int i = 1; i < FLAGS_num_threads; ++i) {
-      threads->emplace_back(
-          ReadThreadType(table_, key_gen_, bytes_written, bytes_read, sequence_,
-                         num_read_ops_per_thread_, read_hits, &threads_done));
+        table_, key_gen_, sequence_, FLAGS_num_operations, &stats_[0], 0,
+        &threads_done));
+    for (uint32_t i = 1; i < num_threads_; ++i) {
+      threads->emplace_back(ReadThreadType(table_, key_gen_, sequence_,
+                                           num_read_ops_per_thread, &stats_[i],
+                                           i, &threads_done));
     }
-    for (auto& thread : *threads) {
-      thread.join();
+    JoinThreads(threads);
+  }
+};
+
+class MixedBenchmark : public Benchmark {
+ public:
+  explicit MixedBenchmark(MemTableRep* table, KeyGenerator* key_gen,
+                          std::atomic<uint64_t>* sequence,
+                          bool insert_concurrently)
+      : Benchmark(table, key_gen, sequence, FLAGS_num_threads),
+        insert_concurrently_(insert_concurrently) {}
+
+  void RunThreads(std::vector<port::Thread>* threads) override {
+    uint64_t num_ops = FLAGS_num_operations / FLAGS_num_threads;
+    port::Mutex write_mutex;
+    for (uint32_t i = 0; i < num_threads_; ++i) {
+      threads->emplace_back(MixedBenchmarkThread(
+          table_, key_gen_, sequence_, num_ops, &stats_[i], i,
+          insert_concurrently_ ? nullptr : &write_mutex));
     }
+    JoinThreads(threads);
   }
+
+ private:
+  const bool insert_concurrently_;
 };
 
+static MemTableRepFactory* NewFactory(const std::string& name,
+                                      Options* options) {
+  if (name == "skiplist") {
+    return new SkipListFactory;
+  } else if (name == "prefixskiplist") {
+    return new SkipListFactory(0 /* lookahead */, true /* use_key_prefix */);
+  } else if (name == "classic_skiplist") {
+    return new ClassicSkipListFactory;
+#ifndef ROCKSDB_LITE
+  } else if (name == "vector") {
+    return new VectorRepFactory(FLAGS_vectorrep_count,
+                                FLAGS_vectorrep_sort_threads);
+  } else if (name == "hashskiplist") {
+    options->prefix_extractor.reset(
+        NewFixedPrefixTransform(FLAGS_prefix_length));
+    return NewHashSkipListRepFactory(FLAGS_bucket_count,
+                                     FLAGS_hashskiplist_height,
+                                     FLAGS_hashskiplist_branching_factor);
+  } else if (name == "hashlinklist") {
+    options->prefix_extractor.reset(
+        NewFixedPrefixTransform(FLAGS_prefix_length));
+    return NewHashLinkListRepFactory(
+        FLAGS_bucket_count, FLAGS_huge_page_tlb_size,
+        FLAGS_bucket_entries_logging_threshold,
+        FLAGS_if_log_bucket_dist_when_flash, FLAGS_threshold_use_skiplist);
+  } else if (name == "hashindexedskiplist") {
+    return NewHashIndexedSkipListRepFactory(FLAGS_bucket_count);
+  } else if (name == "art") {
+    return NewArtRepFactory();
+#endif  // ROCKSDB_LITE
+  }
+  return nullptr;
+}
+
+// Runs the --benchmarks list against one memtablerep with `num_threads`
+// threads, appending a result per benchmark.
+static void RunBenchmarks(const std::string& rep_name,
+                          MemTableRepFactory* factory, const Options& options,
+                          std::vector<BenchmarkResult>* results) {
+  InternalKeyComparator internal_key_comp(BytewiseComparator());
+  CountingKeyComparator key_comp(internal_key_comp);
+  // Declared before the memtablerep, which must go first.
+  std::unique_ptr<ConcurrentArena> arena;
+  std::unique_ptr<MemTableRep> memtablerep;
+  std::atomic<uint64_t> sequence;
+  auto createMemtableRep = [&] {
+    memtablerep.reset();
+    arena.reset(new ConcurrentArena());
+    sequence.store(0);
+    memtablerep.reset(factory->CreateMemTableRep(
+        key_comp, arena.get(), options.prefix_extractor.get(),
+        options.info_log.get()));
+  };
+  for (const std::string& name : StringSplit(FLAGS_benchmarks, ',')) {
+    std::unique_ptr<KeyGenerator> key_gen;
+    std::unique_ptr<Benchmark> benchmark;
+    if (name == "fillseq") {
+      createMemtableRep();
+      key_gen.reset(new KeyGenerator(SEQUENTIAL, FLAGS_num_operations));
+      benchmark.reset(
+          new FillBenchmark(memtablerep.get(), key_gen.get(), &sequence));
+    } else if (name == "fillrandom") {
+      createMemtableRep();
+      key_gen.reset(new KeyGenerator(UNIQUE_RANDOM, FLAGS_num_operations));
+      benchmark.reset(
+          new FillBenchmark(memtablerep.get(), key_gen.get(), &sequence));
+    } else if (name == "fillconcurrent") {
+      if (!factory->IsInsertConcurrentlySupported()) {
+        std::cout << "WARNING: skipping fillconcurrent, " << rep_name
+                  << " does not support concurrent inserts" << std::endl;
+        continue;
+      }
+      createMemtableRep();
+      key_gen.reset(new KeyGenerator(UNIQUE_RANDOM, FLAGS_num_operations));
+      benchmark.reset(new ConcurrentFillBenchmark(memtablerep.get(),
+                                                  key_gen.get(), &sequence));
+    } else if (name == "readrandom") {
+      if (memtablerep == nullptr) {
+        createMemtableRep();
+      }
+      key_gen.reset(new KeyGenerator(RANDOM, FLAGS_num_operations));
+      benchmark.reset(
+          new ReadBenchmark(memtablerep.get(), key_gen.get(), &sequence));
+    } else if (name == "readseq") {
+      if (memtablerep == nullptr) {
+        createMemtableRep();
+      }
+      benchmark.reset(new SeqReadBenchmark(memtablerep.get(), &sequence));
+    } else if (name == "readwrite") {
+      createMemtableRep();
+      key_gen.reset(new KeyGenerator(RANDOM, FLAGS_num_operations));
+      benchmark.reset(
+          new ReadWriteBenchmark<ConcurrentReadBenchmarkThread>(
+              memtablerep.get(), key_gen.get(), &sequence));
+    } else if (name == "seqreadwrite") {
+      createMemtableRep();
+      key_gen.reset(new KeyGenerator(RANDOM, FLAGS_num_operations));
+      benchmark.reset(
+          new ReadWriteBenchmark<SeqConcurrentReadBenchmarkThread>(
+              memtablerep.get(), key_gen.get(), &sequence));
+    } else if (name == "mixed") {
+      // Runs on top of the previous fill, if any.
+      if (memtablerep == nullptr) {
+        createMemtableRep();
+      }
+      key_gen.reset(new KeyGenerator(RANDOM, FLAGS_num_operations));
+      benchmark.reset(new MixedBenchmark(
+          memtablerep.get(), key_gen.get(), &sequence,
+          factory->IsInsertConcurrentlySupported()));
+    } else {
+      std::cout << "WARNING: skipping unknown benchmark '" << name << "'"
+                << std::endl;
+      continue;
+    }
+    std::cout << "Running " << name << " on " << rep_name << std::endl;
+    results->emplace_back();
+    BenchmarkResult* result = &results->back();
+    result->memtablerep = rep_name;
+    result->benchmark = name;
+    benchmark->Run(result);
+  }
+}
+
+static void PrintSummary(const std::vector<BenchmarkResult>& results) {
+  fprintf(stdout, "\n%-18s %-15s %7s %12s %10s %10s %10s %8s\n",
+          "memtablerep", "benchmark", "threads", "ops/sec", "p50(us)",
+          "p99(us)", "p999(us)", "cmp/op");
+  for (const auto& r : results) {
+    fprintf(stdout, "%-18s %-15s %7" PRIu32 " %12.0f %10.3f %10.3f %10.3f %8.2f\n",
+            r.memtablerep.c_str(), r.benchmark.c_str(), r.num_threads,
+            r.ops_per_sec, r.latency.Percentile(50) / 1000.0,
+            r.latency.Percentile(99) / 1000.0,
+            r.latency.Percentile(99.9) / 1000.0, r.comparisons_per_op);
+  }
+}
+
 }  // namespace ROCKSDB_NAMESPACE
 
 void PrintWarnings() {
@@ -573,104 +1020,44 @@ int main(int argc, char** argv) {
 
   PrintWarnings();
 
-  ROCKSDB_NAMESPACE::Options options;
-
-  std::unique_ptr<ROCKSDB_NAMESPACE::MemTableRepFactory> factory;
-  if (FLAGS_memtablerep == "skiplist") {
-    factory.reset(new ROCKSDB_NAMESPACE::SkipListFactory);
-#ifndef ROCKSDB_LITE
-  } else if (FLAGS_memtablerep == "vector") {
-    factory.reset(new ROCKSDB_NAMESPACE::VectorRepFactory);
-  } else if (FLAGS_memtablerep == "hashskiplist") {
-    factory.reset(ROCKSDB_NAMESPACE::NewHashSkipListRepFactory(
-        FLAGS_bucket_count, FLAGS_hashskiplist_height,
-        FLAGS_hashskiplist_branching_factor));
-    options.prefix_extractor.reset(
-        ROCKSDB_NAMESPACE::NewFixedPrefixTransform(FLAGS_prefix_length));
-  } else if (FLAGS_memtablerep == "hashlinklist") {
-    factory.reset(ROCKSDB_NAMESPACE::NewHashLinkListRepFactory(
-        FLAGS_bucket_count, FLAGS_huge_page_tlb_size,
-        FLAGS_bucket_entries_logging_threshold,
-        FLAGS_if_log_bucket_dist_when_flash, FLAGS_threshold_use_skiplist));
-    options.prefix_extractor.reset(
-        ROCKSDB_NAMESPACE::NewFixedPrefixTransform(FLAGS_prefix_length));
-#endif  // ROCKSDB_LITE
-  } else {
-    fprintf(stdout, "Unknown memtablerep: %s\n", FLAGS_memtablerep.c_str());
+  ROCKSDB_NAMESPACE::KeyDistributionType key_distribution;
+  if (!ROCKSDB_NAMESPACE::ParseKeyDistributionType(FLAGS_key_distribution,
+                                                   &key_distribution)) {
+    fprintf(stdout, "Unknown key_distribution: %s\n",
+            FLAGS_key_distribution.c_str());
+    exit(1);
+  }
+  if (FLAGS_read_ratio < 0 || FLAGS_read_ratio > 100) {
+    fprintf(stdout, "read_ratio must be in [0, 100]\n");
     exit(1);
   }
 
-  ROCKSDB_NAMESPACE::InternalKeyComparator internal_key_comp(
-      ROCKSDB_NAMESPACE::BytewiseComparator());
-  ROCKSDB_NAMESPACE::MemTable::KeyComparator key_comp(internal_key_comp);
-  ROCKSDB_NAMESPACE::Arena arena;
-  ROCKSDB_NAMESPACE::WriteBufferManager wb(FLAGS_write_buffer_size);
-  uint64_t sequence;
-  auto createMemtableRep = [&] {
-    sequence = 0;
-    return factory->CreateMemTableRep(key_comp, &arena,
-                                      options.prefix_extractor.get(),
-                                      options.info_log.get());
-  };
-  std::unique_ptr<ROCKSDB_NAMESPACE::MemTableRep> memtablerep;
-  ROCKSDB_NAMESPACE::Random64 rng(FLAGS_seed);
-  const char* benchmarks = FLAGS_benchmarks.c_str();
-  while (benchmarks != nullptr) {
-    std::unique_ptr<ROCKSDB_NAMESPACE::KeyGenerator> key_gen;
-    const char* sep = strchr(benchmarks, ',');
-    ROCKSDB_NAMESPACE::Slice name;
-    if (sep == nullptr) {
-      name = benchmarks;
-      benchmarks = nullptr;
-    } else {
-      name = ROCKSDB_NAMESPACE::Slice(benchmarks, sep - benchmarks);
-      benchmarks = sep + 1;
+  std::vector<int32_t> thread_counts;
+  for (const std::string& count :
+       ROCKSDB_NAMESPACE::StringSplit(FLAGS_thread_counts, ',')) {
+    thread_counts.push_back(std::max(1, atoi(count.c_str())));
+  }
+  if (thread_counts.empty()) {
+    thread_counts.push_back(std::max(1, FLAGS_num_threads));
+  }
+
+  std::vector<ROCKSDB_NAMESPACE::BenchmarkResult> results;
+  for (const std::string& rep_name :
+       ROCKSDB_NAMESPACE::StringSplit(FLAGS_memtablerep, ',')) {
+    ROCKSDB_NAMESPACE::Options options;
+    std::unique_ptr<ROCKSDB_NAMESPACE::MemTableRepFactory> factory(
+        ROCKSDB_NAMESPACE::NewFactory(rep_name, &options));
+    if (factory == nullptr) {
+      fprintf(stdout, "Unknown memtablerep: %s\n", rep_name.c_str());
+      exit(1);
     }
-    std::unique_ptr<ROCKSDB_NAMESPACE::Benchmark> benchmark;
-    if (name == ROCKSDB_NAMESPACE::Slice("fillseq")) {
-      memtablerep.reset(createMemtableRep());
-      key_gen.reset(new ROCKSDB_NAMESPACE::KeyGenerator(
-          &rng, ROCKSDB_NAMESPACE::SEQUENTIAL, FLAGS_num_operations));
-      benchmark.reset(new ROCKSDB_NAMESPACE::FillBenchmark(
-          memtablerep.get(), key_gen.get(), &sequence));
-    } else if (name == ROCKSDB_NAMESPACE::Slice("fillrandom")) {
-      memtablerep.reset(createMemtableRep());
-      key_gen.reset(new ROCKSDB_NAMESPACE::KeyGenerator(
-          &rng, ROCKSDB_NAMESPACE::UNIQUE_RANDOM, FLAGS_num_operations));
-      benchmark.reset(new ROCKSDB_NAMESPACE::FillBenchmark(
-          memtablerep.get(), key_gen.get(), &sequence));
-    } else if (name == ROCKSDB_NAMESPACE::Slice("readrandom")) {
-      key_gen.reset(new ROCKSDB_NAMESPACE::KeyGenerator(
-          &rng, ROCKSDB_NAMESPACE::RANDOM, FLAGS_num_operations));
-      benchmark.reset(new ROCKSDB_NAMESPACE::ReadBenchmark(
-          memtablerep.get(), key_gen.get(), &sequence));
-    } else if (name == ROCKSDB_NAMESPACE::Slice("readseq")) {
-      key_gen.reset(new ROCKSDB_NAMESPACE::KeyGenerator(
-          &rng, ROCKSDB_NAMESPACE::SEQUENTIAL, FLAGS_num_operations));
-      benchmark.reset(new ROCKSDB_NAMESPACE::SeqReadBenchmark(memtablerep.get(),
-                                                              &sequence));
-    } else if (name == ROCKSDB_NAMESPACE::Slice("readwrite")) {
-      memtablerep.reset(createMemtableRep());
-      key_gen.reset(new ROCKSDB_NAMESPACE::KeyGenerator(
-          &rng, ROCKSDB_NAMESPACE::RANDOM, FLAGS_num_operations));
-      benchmark.reset(new ROCKSDB_NAMESPACE::ReadWriteBenchmark<
-                      ROCKSDB_NAMESPACE::ConcurrentReadBenchmarkThread>(
-          memtablerep.get(), key_gen.get(), &sequence));
-    } else if (name == ROCKSDB_NAMESPACE::Slice("seqreadwrite")) {
-      memtablerep.reset(createMemtableRep());
-      key_gen.reset(new ROCKSDB_NAMESPACE::KeyGenerator(
-          &rng, ROCKSDB_NAMESPACE::RANDOM, FLAGS_num_operations));
-      benchmark.reset(new ROCKSDB_NAMESPACE::ReadWriteBenchmark<
-                      ROCKSDB_NAMESPACE::SeqConcurrentReadBenchmarkThread>(
-          memtablerep.get(), key_gen.get(), &sequence));
-    } else {
-      std::cout << "WARNING: skipping unknown benchmark '" << name.ToString()
-                << std::endl;
-      continue;
+    for (int32_t num_threads : thread_counts) {
+      FLAGS_num_threads = num_threads;
+      ROCKSDB_NAMESPACE::RunBenchmarks(rep_name, factory.get(), options,
+                                       &results);
     }
-    std::cout << "Running " << name.ToString() << std::endl;
-    benchmark->Run();
   }
+  ROCKSDB_NAMESPACE::PrintSummary(results);
 
   return 0;
 }
@@ -10,7 +10,9 @@
 // Thread safety
 // -------------
 //
-// Writes require external synchronization, most likely a mutex.
+// Writes require external synchronization, most likely a mutex, except
+// that InsertConcurrently() may be called from several threads at once (but
+// not concurrently with Insert()).
 // Reads require a guarantee that the SkipList will not be destroyed
 // while the read is in progress.  Apart from that, reads progress
 // without any internal locking or synchronization.
@@ -106,6 +108,12 @@ class SkipList {
   // REQUIRES: nothing that compares equal to key is currently in the list.
   void Insert(const Key& key);
 
+  // Like Insert(), but external synchronization is not required.
+  // REQUIRES: the list was created with max_height <= kMaxPossibleHeight.
+  void InsertConcurrently(const Key& key);
+
+  static const int kMaxPossibleHeight = 32;
+
   void Insert_Buf(const Key& key);
 
   void Insert_B2hSL(const Key& key); // B2hSL insert function - Signal.Jin
@@ -215,6 +223,10 @@ class SkipList {
   // values are ok.
   std::atomic<int> max_height_;  // Height of the entire list
 
+  // Set by InsertConcurrently(), which does not maintain prev_, so that the
+  // next Insert() recomputes it.
+  std::atomic<bool> prev_stale_;
+
   // Used for optimizing sequential insert patterns.  Tricky.  prev_[i] for
   // i up to max_height_ is the predecessor of prev_[0] and prev_height_
   // is the height of prev_[0].  prev_[0] can only be equal to head before
@@ -289,6 +301,11 @@ class SkipList {
   // level in [0..max_height_-1], if prev is non-null.
   Node* FindLessThan(const Key& key, Node** prev = nullptr) const;
 
+  // Starting at "before", which must be before key at "level", finds the
+  // adjacent nodes *out_prev < key <= *out_next at that level.
+  void FindSpliceForLevel(const Key& key, Node* before, int level,
+                          Node** out_prev, Node** out_next) const;
+
   // Return the last node in the list.
   // Return head_ if list is empty.
   Node* FindLast() const;
@@ -328,6 +345,11 @@ struct SkipList<Key, Comparator>::Node {
     next_[n].store(x, std::memory_order_relaxed);
   }
 
+  bool CASNext(int n, Node* expected, Node* x) {
+    assert(n >= 0);
+    return next_[n].compare_exchange_strong(expected, x);
+  }
+
  private:
   // Array of length equal to the node height.  next_[0] is lowest level link.
   std::atomic<Node*> next_[1];
@@ -1569,6 +1591,7 @@ SkipList<Key, Comparator>::SkipList(const Comparator cmp, Allocator* allocator,
       //single_cursor_(NewNode(0, max_height)),
       //cs_level(-1),
       max_height_(1),
+      prev_stale_(false),
       prev_height_(1) {
   assert(max_height > 0 && kMaxHeight_ == static_cast<uint32_t>(max_height));
   assert(branching_factor > 0 &&
@@ -1601,9 +1624,14 @@ SkipList<Key, Comparator>::SkipList(const Comparator cmp, Allocator* allocator,
 
 template<typename Key, class Comparator>
 void SkipList<Key, Comparator>::Insert(const Key& key) {
-  // fast path for sequential insertion
-  if (!KeyIsAfterNode(key, prev_[0]->NoBarrier_Next(0)) &&
-      (prev_[0] == head_ || KeyIsAfterNode(key, prev_[0]))) {
+  if (prev_stale_.load(std::memory_order_relaxed)) {
+    // Nodes inserted concurrently may sit between prev_[i] and prev_[0] at
+    // the upper levels, so the fast path below cannot be trusted.
+    prev_stale_.store(false, std::memory_order_relaxed);
+    FindLessThan(key, prev_);
+  } else if (!KeyIsAfterNode(key, prev_[0]->NoBarrier_Next(0)) &&
+             (prev_[0] == head_ || KeyIsAfterNode(key, prev_[0]))) {
+    // fast path for sequential insertion
     assert(prev_[0] != head_ || (prev_height_ == 1 && GetMaxHeight() == 1));
 
     // Outside of this method prev_[1..max_height_] is the predecessor
@@ -1652,6 +1680,72 @@ void SkipList<Key, Comparator>::Insert(const Key& key) {
   prev_height_ = height;
 }
 
+template <typename Key, class Comparator>
+void SkipList<Key, Comparator>::FindSpliceForLevel(const Key& key,
+                                                   Node* before, int level,
+                                                   Node** out_prev,
+                                                   Node** out_next) const {
+  while (true) {
+    Node* next = before->Next(level);
+    if (!KeyIsAfterNode(key, next)) {
+      *out_prev = before;
+      *out_next = next;
+      return;
+    }
+    before = next;
+  }
+}
+
+template <typename Key, class Comparator>
+void SkipList<Key, Comparator>::InsertConcurrently(const Key& key) {
+  assert(kMaxHeight_ <= kMaxPossibleHeight);
+  Node* prev[kMaxPossibleHeight];
+  Node* next[kMaxPossibleHeight];
+
+  int height = RandomHeight();
+  int max_height = max_height_.load(std::memory_order_relaxed);
+  while (height > max_height) {
+    if (max_height_.compare_exchange_weak(max_height, height)) {
+      // successfully updated it
+      max_height = height;
+      break;
+    }
+    // else retry, possibly exiting the loop because somebody else
+    // increased it
+  }
+
+  // Find the splice top-down. Levels above the height of every node
+  // inserted so far start at head_ with a nullptr successor.
+  Node* before = head_;
+  for (int i = max_height - 1; i >= 0; --i) {
+    FindSpliceForLevel(key, before, i, &prev[i], &next[i]);
+    before = prev[i];
+  }
+
+  // Our data structure does not allow duplicate insertion
+  assert(next[0] == nullptr || !Equal(key, next[0]->key));
+
+  Node* x = NewNode(key, height);
+  // Link bottom-up, so that a node reachable at some level is reachable at
+  // every level below it. A failed CAS means another node was linked into
+  // the splice at this level; search again from the old predecessor, which
+  // is still before key.
+  for (int i = 0; i < height; ++i) {
+    while (true) {
+      x->NoBarrier_SetNext(i, next[i]);
+      if (prev[i]->CASNext(i, next[i], x)) {
+        break;
+      }
+      FindSpliceForLevel(key, prev[i], i, &prev[i], &next[i]);
+      assert(i > 0 || next[i] == nullptr || !Equal(key, next[i]->key));
+    }
+  }
+
+  if (!prev_stale_.load(std::memory_order_relaxed)) {
+    prev_stale_.store(true, std::memory_order_relaxed);
+  }
+}
+
 template<typename Key, class Comparator>
 void SkipList<Key, Comparator>::Insert_Buf(const Key& key) {
   // fast path for sequential insertion
@@ -9,19 +9,14 @@
 
 #include "memtable/skiplist.h"
 #include <set>
+#include <vector>
 #include "memory/arena.h"
 #include "rocksdb/env.h"
 #include "test_util/testharness.h"
 #include "util/hash.h"
+#include "util/key_distribution.h"
 #include "util/random.h"
 
-#include <chrono>
-typedef std::chrono::high_resolution_clock Clock;
-
-// Zipfian pattern generator from util directory - Signal.Jin
-#include "util/zipf.h"
-#include "util/latest-generator.h"
-
 namespace ROCKSDB_NAMESPACE {
 
 typedef uint64_t Key;
@@ -39,325 +34,41 @@ struct TestComparator {
 };
 
 class SkipTest : public testing::Test {};
-/*
-TEST_F(SkipTest, NodeCompareTest) {
-  const int N = 100000; // Write Count - Signal.Jin
-  const int R = 6000;
-  Random rnd(1000);
-  std::set<Key> keys;
-  Arena arena;
-  TestComparator cmp;
-  SkipList<Key, TestComparator> list(cmp, &arena);
-
-  float *lat = (float *)malloc(sizeof(float)*R);
-  //float *system_s = (float *)malloc(sizeof(float)*R);
-  //float *system_e = (float *)malloc(sizeof(float)*R);
-  int j = 0;
 
-  std::random_device rd;
-  std::mt19937 gen(rd());
-  std::uniform_int_distribution<int> distr(0, N);
-
-  uint64_t *rnd_val = (uint64_t *)malloc(sizeof(uint64_t)*R);
-
-  //uint64_t *zipf_val = (uint64_t *)malloc(sizeof(uint64_t)*R);
-
-  FILE *fp_sk_test;
-  fp_sk_test = fopen("NodeCompare.csv", "at");
-
-  // Insert key sequential pattern in skiplist
-  for (int i = 0; i < N; i++) {
-    Key key = i;
-    if (keys.insert(key).second) {
-      list.Insert(key);
-    }
-  }
-
-  // Init Zipfian Generator - Signal.Jin
-  //init_latestgen(N);
-  //init_zipf_generator(0, N);
-
-  for(int i = 0; i < R; i++) {
-    //rnd_val[i] = rnd.Next() % N;
-    rnd_val[i] = distr(gen);
-  } // Generate Random Key - Signal.Jin
-
-  for(int i = 0; i < R; i++) {
-    zipf_val[i] = nextValue() % N;
-  } // Zipfian Key Pattern - Signal.Jin
-
-  //sleep(10);
-  for(int i = 0; i < R; i++) {
-    Key Gkey = rnd_val[i];
-    //Key Zkey = zipf_val[i];
-    //std::chrono::system_clock::time_point start = std::chrono::system_clock::now();
-    auto start_time = Clock::now();
-    if (list.Contains(Gkey)) { // Maybe estimate time in here - Signal.Jin
-      ASSERT_EQ(keys.count(Gkey), 1U);
-    } else {
-      ASSERT_EQ(keys.count(Gkey), 0U);
-    }
-    auto end_time = Clock::now();
-    //auto dur_s = start_time.time_since_epoch();
-    //auto dur_e = end_time.time_since_epoch();
-    //std::chrono::system_clock::time_point end = std::chrono::system_clock::now();
-    lat[j] = std::chrono::duration_cast<std::chrono::nanoseconds>(end_time - start_time).count() * 0.001;
-    //system_s[j] = std::chrono::duration_cast<std::chrono::nanoseconds>(dur_s);
-    //system_s[j] = start_time.time_since_epoch().count();
-    //system_e[j] = std::chrono::duration_cast<std::chrono::nanoseconds>(dur_e);
-    j++;
-  }
-
-  for(int i = 0; i < R; i++) {
-    //fprintf(fp_sk_test, "%.2f\n", system_s[i]); // Signal.Jin  
-    fprintf(fp_sk_test, "%.2f\n", lat[i]); // Signal.Jin  
-    //fprintf(fp_sk_test, "%.2f\n\n", system_e[i]); // Signal.Jin  
-  }
-
-  fclose(fp_sk_test);
-  //free(zipf_val);
-  free(rnd_val);
-  free(lat);
-  //free(system_s);
-  //free(system_e);
-  //fprintf(stdout, "Time (us) = %.2f\n", r_time); // Signal.Jin
-  //fprintf(stdout, "Count = %d\n", count);
-}
-*/
-/*
-TEST_F(SkipTest, SeqInsertAndLookupX) { // Skiplist test for Sequential Pattern (Find nothing) - Signal.Jin
-  const int N = 100000; // Write Count - Signal.Jin
-  const int R = 50000; // Read Count - Signal.Jin
+TEST_F(SkipTest, ZipfianInsertAndLookup) {
+  const int N = 100000;
   std::set<Key> keys;
   Arena arena;
   TestComparator cmp;
   SkipList<Key, TestComparator> list(cmp, &arena);
 
-  FILE *fp_sk_test;
-  float *lat = (float *)malloc(sizeof(float)*R);
-  int j = 0;
-
-  fp_sk_test = fopen("Xseq_test_skiplist.txt", "at");
-  struct timespec s_time, e_time;
-  double r_time;
-
-  // Insert key sequential pattern in skiplist
+  Random64 key_rnd(1000);
+  auto zipf = KeyDistribution::Create(KeyDistributionType::kZipfian, N);
+  std::vector<Key> zipf_keys(N);
   for (int i = 0; i < N; i++) {
-    Key key = i;
-    if (keys.insert(key).second) {
-      list.Insert(key);
-    }
-  }
-
-  for (int i = N; i < R+N; i++) { 
-    clock_gettime(CLOCK_MONOTONIC, &s_time);
-    if (list.Contains(i)) { // Maybe estimate time in here - Signal.Jin
-      ASSERT_EQ(keys.count(i), 1U);
-    } else {
-      ASSERT_EQ(keys.count(i), 0U);
-    }
-    clock_gettime(CLOCK_MONOTONIC, &e_time);
-    r_time = (e_time.tv_sec - s_time.tv_sec) + (e_time.tv_nsec - s_time.tv_nsec)*0.001;
-    lat[j] = r_time;
-    j++;  
+    zipf_keys[i] = zipf->Next(&key_rnd);
   }
 
-  for(int i = 0; i < R; i++) {
-    fprintf(fp_sk_test, "%.2f\n", lat[i]); // Signal.Jin  
-  }
-  fclose(fp_sk_test);
-  free(lat);
-}
-*/
-/*
-TEST_F(SkipTest, SeqInsertAndLookupO) { // Skiplist test for Sequential Pattern (Find all keys) - Signal.Jin
-  const int N = 480000; // Write Count - Signal.Jin
-  //const int R = 100000; // Read Count - Signal.Jin
-  std::set<Key> keys;
-  Arena arena;
-  TestComparator cmp;
-  SkipList<Key, TestComparator> list(cmp, &arena);
-
-  //FILE *fp_sk_test;
-  //float *lat = (float *)malloc(sizeof(float)*R);
-  //int j = 0;
-
-  //fp_sk_test = fopen("./opt_sc_exp/seq/100k/sc_seq_100k.csv", "at");
-
-  // Insert key sequential pattern in skiplist
-  for (int i = 0; i < N; i++) {
-    Key key = i;
+  for (Key key : zipf_keys) {
     if (keys.insert(key).second) {
       list.Insert(key);
     }
   }
+  // Skewed keys repeat, so far fewer than N are distinct.
+  ASSERT_LT(keys.size(), static_cast<size_t>(N));
 
-  int start_p = rand() % (N-R);
-
-  for (int i = start_p; i < R + start_p; i++) { 
-    //auto start_time = Clock::now();
-    if (list.Contains(i)) { // Maybe estimate time in here - Signal.Jin
-      ASSERT_EQ(keys.count(i), 1U);
-    } else {
-      ASSERT_EQ(keys.count(i), 0U);
-    }
-    //auto end_time = Clock::now();
-    //r_time = (e_time.tv_sec - s_time.tv_sec) + (e_time.tv_nsec - s_time.tv_nsec)*0.001;
-    // lat[j] = std::chrono::duration_cast<std::chrono::nanoseconds>(end_time - start_time).count() * 0.001;
-    // j++;
+  for (Key key : zipf_keys) {
+    ASSERT_TRUE(list.Contains(key));
   }
-
-  // for(int k = 0; k < R; k++) {
-  //   fprintf(fp_sk_test, "%.2f\n", lat[k]); // Signal.Jin  
-  // }
-  // fclose(fp_sk_test);
-  // free(lat);
-}
-*/
-/*
-TEST_F(SkipTest, UniRandInsertAndLookup) { // Skiplist test for Random Pattern - Signal.Jin
-  const int N = 4000000; // Write Count - Signal.Jin
-  const int R = 4000000; // Read Count - Signal.Jin
-  Random rnd(5326);
-  std::set<Key> keys;
-  Arena arena;
-  TestComparator cmp;
-  SkipList<Key, TestComparator> list(cmp, &arena);
-
-  std::random_device rd;
-  std::mt19937 gen(rd());
-  std::uniform_int_distribution<int> distr(0, N);
-  
-  FILE *fp_sk_test;
-  float *lat = (float *)malloc(sizeof(float)*R);
-  uint64_t *rnd_val = (uint64_t *)malloc(sizeof(uint64_t)*R);
-  for(int i = 0; i < R; i++) {
-    //rnd_val[i] = rnd.Next() % N;
-    rnd_val[i] = distr(gen);
-  } // Generate Random Key - Signal.Jin
-
-  fp_sk_test = fopen("./rbtree/default_uni_4m.csv", "at");
-  //printf("\nBefore Insert\n");
-  //auto w_start = Clock::now();
   for (int i = 0; i < N; i++) {
-    Key key = rnd_val[i];
-    //Key key = i;
-    if (keys.insert(key).second) {
-      list.Insert(key);
-      //list.Batch_Insert(key);
-    }
-  }
-  //auto w_end = Clock::now();
-
-  //auto r_start = Clock::now();
-  int j = 0;
-  for (int i = 0; i < R; i++) { 
-    Key Gkey = rnd_val[i];
-    auto start_time = Clock::now();
-    if (list.Contains(Gkey)) { // Maybe estimate time in here - Signal.Jin
-     ASSERT_EQ(keys.count(Gkey), 1U);
-    } else {
-     ASSERT_EQ(keys.count(Gkey), 0U);
-    }
-    auto end_time = Clock::now();
-    lat[j] = std::chrono::duration_cast<std::chrono::nanoseconds>(end_time - start_time).count() * 0.001;
-    j++;
+    ASSERT_EQ(keys.count(i), list.Contains(i) ? 1U : 0U);
   }
-  //auto r_end = Clock::now();
-
-  //float r_time, w_time;
-  //r_time = std::chrono::duration_cast<std::chrono::nanoseconds>(r_end - r_start).count() * 0.001;
-  //w_time = std::chrono::duration_cast<std::chrono::nanoseconds>(w_end - w_start).count() * 0.001;
-
-  //printf("\nW = %.lf, R = %.lf\n", w_time, r_time);
-
-  for(int k = 0; k < R; k++) {
-    fprintf(fp_sk_test, "%.2f\n", lat[k]);
-  }
-
-  fclose(fp_sk_test);
-  free(lat);
-  free(rnd_val);
 }
-*/
 
-TEST_F(SkipTest, ZipRandInsertAndLookup) { // Skiplist test for Random Pattern - Signal.Jin
-  const int N = 1000000; // Write Count - Signal.Jin
-  const int R = 1000000; // Read Count - Signal.Jin
-  Random rnd(1000);
-  std::set<Key> keys;
-  Arena arena;
-  TestComparator cmp;
-  SkipList<Key, TestComparator> list(cmp, &arena);
-
-  // Init Zipfian Generator - Signal.Jin
-  init_zipf_generator(0, N);
-
-  //FILE *fp_sk_test;
-  //fp_sk_test = fopen("./rbtree/default_zipf_4m.csv", "at");
-
-  float *lat = (float *)malloc(sizeof(float)*R);
-  uint64_t *zipf_val = (uint64_t *)malloc(sizeof(uint64_t)*R);
-
-  for(int i = 0; i < R; i++) {
-    zipf_val[i] = nextValue() % N;
-    //zipf_val[i] = i+1;
-  } // Zipfian Key Pattern - Signal.Jin
-
-  // Insert key Random pattern in skiplist
-  //auto w_start = Clock::now();
-  for (int i = 0; i < N; i++) {
-    Key key = zipf_val[i];
-    if (keys.insert(key).second) {
-      //list.Insert(key);
-      //list.Insert_B2hSL(key);
-      list.Insert(key);
-    }
-  }
-  //auto w_end = Clock::now();
-  
-  //int j = 0;
-  //auto r_start = Clock::now();
-  for (int i = 0; i < R; i++) { 
-    Key Zkey = zipf_val[i];
-    //auto start_time = Clock::now();
-    if (list.Contains(Zkey)) { // Maybe estimate time in here - Signal.Jin
-      ASSERT_EQ(keys.count(Zkey), 1U);
-    } else {
-      ASSERT_EQ(keys.count(Zkey), 0U);
-    }
-    //auto end_time = Clock::now();
-    //lat[j] = std::chrono::duration_cast<std::chrono::nanoseconds>(end_time - start_time).count() * 0.001;
-    //j++;
-  }
-  //auto r_end = Clock::now();
 
-  //float r_time, w_time;
-  //r_time = std::chrono::duration_cast<std::chrono::nanoseconds>(r_end - r_start).count() * 0.001;
-  //w_time = std::chrono::duration_cast<std::chrono::nanoseconds>(w_end - w_start).count() * 0.001;
-
-  //printf("\n%.lf, %.lf\n", w_time, r_time);
-  /*float sum = 0;
-  for(int i = 0; i < R; i++) {
-    sum += lat[i];
-  }
-  float avg = sum / R;
-
-  printf("Avg [%d] = %lf\n", R, avg);*/
-
-  //for(int k = 0; k < R; k++) {
-    //fprintf(fp_sk_test, "%.2f\n", lat[k]);
-    //printf("%.2f\n", lat[k]);
-  //}
-  //fclose(fp_sk_test);
-  free(zipf_val);
-  free(lat);
-}
-
-/*
-TEST_F(SkipTest, InsertAndLookup) { /// In here, Main step for Skiplist_test (Write and Read) - Signal.Jin
-  const int N = 2000; // Write Count - Signal.Jin
-  const int R = 5000; // Read Count - Signal.Jin
+TEST_F(SkipTest, InsertAndLookup) {
+  const int N = 2000;
+  const int R = 5000;
   Random rnd(1000);
   std::set<Key> keys;
   Arena arena;
@@ -371,8 +82,8 @@ TEST_F(SkipTest, InsertAndLookup) { /// In here, Main step for Skiplist_test (Wr
     }
   }
 
-  for (int i = 0; i < R; i++) { 
-    if (list.Contains(i)) { // Maybe estimate time in here - Signal.Jin
+  for (int i = 0; i < R; i++) {
+    if (list.Contains(i)) {
       ASSERT_EQ(keys.count(i), 1U);
     } else {
       ASSERT_EQ(keys.count(i), 0U);
@@ -439,7 +150,65 @@ TEST_F(SkipTest, InsertAndLookup) { /// In here, Main step for Skiplist_test (Wr
     }
   }
 }
-*/
+
+
+TEST_F(SkipTest, InsertConcurrently) {
+  const int kThreads = 4;
+  const Key kPerThread = 2000;
+  Arena arena;
+  TestComparator cmp;
+  SkipList<Key, TestComparator> list(cmp, &arena);
+
+  // Thread t inserts the keys k * 2 * kThreads + 2 * t + 1; the even keys
+  // are left for Insert() below.
+  std::vector<port::Thread> threads;
+  for (int t = 0; t < kThreads; t++) {
+    threads.emplace_back([&list, t]() {
+      Random rnd(301 + t);
+      std::vector<Key> keys;
+      for (Key k = 0; k < kPerThread; k++) {
+        keys.push_back(k * 2 * kThreads + 2 * t + 1);
+      }
+      for (size_t i = keys.size(); i > 1; i--) {
+        std::swap(keys[i - 1], keys[rnd.Uniform(static_cast<int>(i))]);
+      }
+      for (Key key : keys) {
+        list.InsertConcurrently(key);
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  // Insert() after InsertConcurrently() must not reuse its cached splice.
+  std::set<Key> keys;
+  for (Key key = 1; key < kPerThread * 2 * kThreads; key += 2) {
+    keys.insert(key);
+  }
+  for (Key key = 0; key < 64; key += 2) {
+    list.Insert(key);
+    keys.insert(key);
+  }
+  list.InsertConcurrently(kPerThread * 2 * kThreads + 1);
+  keys.insert(kPerThread * 2 * kThreads + 1);
+  for (Key key = 1000; key < 1064; key += 2) {
+    list.Insert(key);
+    keys.insert(key);
+  }
+
+  SkipList<Key, TestComparator>::Iterator iter(&list);
+  auto model_iter = keys.begin();
+  for (iter.SeekToFirst(); iter.Valid(); iter.Next(), ++model_iter) {
+    ASSERT_TRUE(model_iter != keys.end());
+    ASSERT_EQ(*model_iter, iter.key());
+  }
+  ASSERT_TRUE(model_iter == keys.end());
+  for (Key key : keys) {
+    ASSERT_TRUE(list.Contains(key));
+  }
+  ASSERT_FALSE(list.Contains(kPerThread * 2 * kThreads + 3));
+}
 
 // We want to make sure that with a single writer and multiple
 // concurrent readers (with no synchronization other than when a
@@ -601,11 +370,10 @@ const uint32_t ConcurrentTest::K;
 
 // Simple test that does single-threaded testing of the ConcurrentTest
 // scaffolding.
-/*
 TEST_F(SkipTest, ConcurrentWithoutThreads) {
   ConcurrentTest test;
   Random rnd(test::RandomSeed());
-  for (int i = 0; i < 1; i++) {
+  for (int i = 0; i < 10000; i++) {
     test.ReadStep(&rnd);
     test.WriteStep(&rnd);
   }
@@ -659,11 +427,11 @@ static void ConcurrentReader(void* arg) {
   state->Change(TestState::DONE);
 }
 
-static void RunConcurrent(int run) { // In here, Main step for Skiplist_test (WriteStep) - Signal.Jin
+static void RunConcurrent(int run) {
   const int seed = test::RandomSeed() + (run * 100);
   Random rnd(seed);
-  const int N = 1; // Number of Key-value pair - Signal.Jin
-  const int kSize = 1;
+  const int N = 1000;
+  const int kSize = 1000;
   for (int i = 0; i < N; i++) {
     if ((i % 100) == 0) {
       fprintf(stderr, "Run %d of %d\n", i, N);
@@ -681,11 +449,11 @@ static void RunConcurrent(int run) { // In here, Main step for Skiplist_test (Wr
 }
 
 TEST_F(SkipTest, Concurrent1) { RunConcurrent(1); }
-//TEST_F(SkipTest, Concurrent2) { RunConcurrent(2); }
-//TEST_F(SkipTest, Concurrent3) { RunConcurrent(3); }
-//TEST_F(SkipTest, Concurrent4) { RunConcurrent(4); }
-//TEST_F(SkipTest, Concurrent5) { RunConcurrent(5); }
-*/
+TEST_F(SkipTest, Concurrent2) { RunConcurrent(2); }
+TEST_F(SkipTest, Concurrent3) { RunConcurrent(3); }
+TEST_F(SkipTest, Concurrent4) { RunConcurrent(4); }
+TEST_F(SkipTest, Concurrent5) { RunConcurrent(5); }
+
 }  // namespace ROCKSDB_NAMESPACE
 
 int main(int argc, char** argv) {
@@ -20,9 +20,10 @@ class SkipListRep : public MemTableRep {
 public:
  explicit SkipListRep(const MemTableRep::KeyComparator& compare,
                       Allocator* allocator, const SliceTransform* transform,
-                      const size_t lookahead)
+                      const size_t lookahead, bool use_key_prefix)
      : MemTableRep(allocator),
-       skip_list_(compare, allocator),
+       skip_list_(compare, allocator, 12 /* max_height */,
+                  4 /* branching_factor */, use_key_prefix),
        cmp_(compare),
        transform_(transform),
        lookahead_(lookahead) {}
@@ -96,6 +97,11 @@ public:
     return (end_count >= start_count) ? (end_count - start_count) : 0;
   }
 
+  void SampleEntries(size_t target,
+                     std::vector<const char*>* entries) const override {
+    skip_list_.SampleKeys(target, entries);
+  }
+
   ~SkipListRep() override {}
 
   // Iteration over the contents of a skip list
@@ -283,7 +289,8 @@ public:
 MemTableRep* SkipListFactory::CreateMemTableRep(
     const MemTableRep::KeyComparator& compare, Allocator* allocator,
     const SliceTransform* transform, Logger* /*logger*/) {
-  return new SkipListRep(compare, allocator, transform, lookahead_);
+  return new SkipListRep(compare, allocator, transform, lookahead_,
+                         use_key_prefix_);
 }
 
 }  // namespace ROCKSDB_NAMESPACE
@@ -10,6 +10,9 @@
 #include <set>
 #include <memory>
 #include <algorithm>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
 #include <type_traits>
 
 #include "db/memtable.h"
@@ -17,15 +20,129 @@
 #include "memtable/stl_wrappers.h"
 #include "port/port.h"
 #include "util/mutexlock.h"
+#include "util/threadpool_imp.h"
 
 namespace ROCKSDB_NAMESPACE {
 namespace {
 
 using namespace stl_wrappers;
 
+const size_t kMaxSortThreads = 64;
+
+// Helper threads shared by all sorts. It grows to the largest number of
+// helpers a sort has asked for, at most kMaxSortThreads - 1. Leaked so that
+// it outlives other static destructors.
+ThreadPoolImpl* GetSortThreadPool() {
+  static ThreadPoolImpl* pool = new ThreadPoolImpl();
+  return pool;
+}
+
+// Runs fn(0), ..., fn(n - 1) concurrently, the first one in the calling
+// thread and the others on the sort thread pool.
+void RunInParallel(size_t n, const std::function<void(size_t)>& fn) {
+  ThreadPoolImpl* pool = GetSortThreadPool();
+  pool->IncBackgroundThreadsIfNeeded(static_cast<int>(n - 1));
+  std::mutex mutex;
+  std::condition_variable cv;
+  size_t pending = n - 1;
+  for (size_t i = 1; i < n; i++) {
+    pool->SubmitJob([&, i]() {
+      fn(i);
+      std::lock_guard<std::mutex> lock(mutex);
+      if (--pending == 0) {
+        cv.notify_one();
+      }
+    });
+  }
+  fn(0);
+  std::unique_lock<std::mutex> lock(mutex);
+  cv.wait(lock, [&pending] { return pending == 0; });
+}
+
+// Sorts `keys` using up to `threads` threads. Keys are partitioned into one
+// range per thread by splitters drawn from a sample, the ranges are sorted
+// independently and end up adjacent, so there is no merge step. The keys are
+// sorted within the storage of `keys`, so iterators over it stay valid.
+void ParallelSort(std::vector<const char*>* keys,
+                  const MemTableRep::KeyComparator& compare, size_t threads) {
+  // Below this many keys per thread, starting threads costs more than it
+  // saves.
+  const size_t kMinKeysPerThread = 16384;
+  const size_t kOversampling = 64;
+  const size_t n = keys->size();
+  Compare cmp(compare);
+  threads = std::min(threads, n / kMinKeysPerThread);
+  if (threads <= 1) {
+    std::sort(keys->begin(), keys->end(), cmp);
+    return;
+  }
+  assert(threads <= kMaxSortThreads);
+
+  std::vector<const char*> splitters;
+  {
+    const size_t sample_size = threads * kOversampling;
+    const size_t stride = n / sample_size;
+    std::vector<const char*> sample;
+    sample.reserve(sample_size);
+    for (size_t i = 0; i < sample_size; i++) {
+      sample.push_back((*keys)[i * stride]);
+    }
+    std::sort(sample.begin(), sample.end(), cmp);
+    for (size_t b = 1; b < threads; b++) {
+      splitters.push_back(sample[b * kOversampling]);
+    }
+  }
+
+  // Thread t classifies the keys of chunk t, [n * t / threads,
+  // n * (t + 1) / threads), counts them per range and copies them out to be
+  // scattered back into `keys`.
+  auto chunk_begin = [n, threads](size_t t) { return n * t / threads; };
+  std::vector<uint8_t> range_of(n);
+  std::vector<size_t> counts(threads * threads, 0);
+  std::vector<const char*> source(n);
+  RunInParallel(threads, [&](size_t t) {
+    size_t* chunk_counts = &counts[t * threads];
+    for (size_t i = chunk_begin(t); i < chunk_begin(t + 1); i++) {
+      const char* key = (*keys)[i];
+      size_t range =
+          std::upper_bound(splitters.begin(), splitters.end(), key, cmp) -
+          splitters.begin();
+      range_of[i] = static_cast<uint8_t>(range);
+      chunk_counts[range]++;
+      source[i] = key;
+    }
+  });
+
+  // Where each chunk's keys of each range go.
+  std::vector<size_t> offsets(threads * threads);
+  std::vector<size_t> range_begin(threads + 1);
+  size_t pos = 0;
+  for (size_t range = 0; range < threads; range++) {
+    range_begin[range] = pos;
+    for (size_t t = 0; t < threads; t++) {
+      offsets[t * threads + range] = pos;
+      pos += counts[t * threads + range];
+    }
+  }
+  range_begin[threads] = pos;
+  assert(pos == n);
+
+  RunInParallel(threads, [&](size_t t) {
+    size_t* chunk_offsets = &offsets[t * threads];
+    for (size_t i = chunk_begin(t); i < chunk_begin(t + 1); i++) {
+      (*keys)[chunk_offsets[range_of[i]]++] = source[i];
+    }
+  });
+  RunInParallel(threads, [&](size_t range) {
+    std::sort(keys->begin() + range_begin[range],
+              keys->begin() + range_begin[range + 1], cmp);
+  });
+}
+
 class VectorRep : public MemTableRep {
  public:
-  VectorRep(const KeyComparator& compare, Allocator* allocator, size_t count);
+  VectorRep(const KeyComparator& compare, Allocator* allocator, size_t count,
+            size_t sort_threads);
 
   // Insert key into the collection. (The caller will pack key and value into a
   // single buffer and pass that in as the parameter to Insert)
@@ -104,6 +221,7 @@ class VectorRep : public MemTableRep {
   bool immutable_;
   bool sorted_;
   const KeyComparator& compare_;
+  const size_t sort_threads_;
 };
 
 void VectorRep::Insert(KeyHandle handle) {
@@ -134,12 +252,14 @@ size_t VectorRep::ApproximateMemoryUsage() {
 }
 
 VectorRep::VectorRep(const KeyComparator& compare, Allocator* allocator,
-                     size_t count)
+                     size_t count, size_t sort_threads)
     : MemTableRep(allocator),
       bucket_(new Bucket()),
       immutable_(false),
       sorted_(false),
-      compare_(compare) {
+      compare_(compare),
+      sort_threads_(std::min(std::max<size_t>(sort_threads, 1),
+                             kMaxSortThreads)) {
   bucket_.get()->reserve(count);
 }
 
@@ -157,7 +277,7 @@ void VectorRep::Iterator::DoSort() const {
   if (!sorted_ && vrep_ != nullptr) {
     WriteLock l(&vrep_->rwlock_);
     if (!vrep_->sorted_) {
-      std::sort(bucket_->begin(), bucket_->end(), Compare(compare_));
+      ParallelSort(bucket_.get(), compare_, vrep_->sort_threads_);
       cit_ = bucket_->begin();
       vrep_->sorted_ = true;
     }
@@ -295,7 +415,7 @@ MemTableRep::Iterator* VectorRep::GetIterator(Arena* arena) {
 MemTableRep* VectorRepFactory::CreateMemTableRep(
     const MemTableRep::KeyComparator& compare, Allocator* allocator,
     const SliceTransform*, Logger* /*logger*/) {
-  return new VectorRep(compare, allocator, count_);
+  return new VectorRep(compare, allocator, count_, sort_threads_);
 }
 }  // namespace ROCKSDB_NAMESPACE
 #endif  // ROCKSDB_LITE
@@ -0,0 +1,140 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+//
+// WriteBufferFlushPolicy picks the column family to flush when a
+// WriteBufferManager created with cost_aware_flush = true is over its limit.
+// Every column family charging its memtables to the manager registers a
+// Candidate, whatever DB it belongs to. A DB refreshes the inputs of its own
+// candidates under its DB mutex; picks read the candidates of all DBs.
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <string>
+
+#include "rocksdb/rocksdb_namespace.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+class WriteBufferFlushPolicy {
+ public:
+  // Candidates of other DBs are only picked if their DB refreshed them this
+  // recently, i.e. the DB is writing and will pick its candidate itself.
+  static const uint64_t kActiveOwnerMicros = 100 * 1000;
+  // Write rates are averaged over about this long.
+  static const uint64_t kRateWindowMicros = 1000 * 1000;
+  // A column family that would take this long to fill its write buffer is
+  // considered idle.
+  static const uint64_t kIdleHorizonMicros = 10 * 1000 * 1000;
+
+  class Candidate {
+   public:
+    Candidate(const void* owner, uint32_t cf_id, const std::string& cf_name)
+        : owner_(owner), cf_id_(cf_id), cf_name_(cf_name) {}
+
+    const void* owner() const { return owner_; }
+    uint32_t cf_id() const { return cf_id_; }
+    const std::string& cf_name() const { return cf_name_; }
+
+    // Updates the state of the active memtable and the write stall risk.
+    // `stall_risk` is how close one more L0 file or immutable memtable brings
+    // the column family to a write slowdown, 1 meaning it would trigger one.
+    // Only called by the owner, under its DB mutex.
+    void Refresh(uint64_t memtable_id, uint64_t active_bytes,
+                 uint64_t data_size, uint64_t write_buffer_size,
+                 double stall_risk, uint64_t now_micros);
+
+    // Records that a flush turned `input_entries` memtable entries into
+    // `output_entries` table entries. Only called by the owner.
+    void RecordFlush(uint64_t input_entries, uint64_t output_entries);
+
+    // Marks the active memtable as gone, e.g. when the column family is
+    // dropped.
+    void Clear() { active_bytes_.store(0, std::memory_order_relaxed); }
+
+    uint64_t active_bytes() const {
+      return active_bytes_.load(std::memory_order_relaxed);
+    }
+    uint64_t write_buffer_size() const {
+      return write_buffer_size_.load(std::memory_order_relaxed);
+    }
+    // Bytes per second written to the column family.
+    double write_rate() const {
+      return write_rate_.load(std::memory_order_relaxed);
+    }
+    // Fraction of the memtable entries that recent flushes dropped.
+    double overwrite_ratio() const {
+      return overwrite_ratio_.load(std::memory_order_relaxed);
+    }
+    double stall_risk() const {
+      return stall_risk_.load(std::memory_order_relaxed);
+    }
+    uint64_t refresh_micros() const {
+      return refresh_micros_.load(std::memory_order_relaxed);
+    }
+
+   private:
+    friend class WriteBufferFlushPolicy;
+
+    const void* const owner_;
+    const uint32_t cf_id_;
+    const std::string cf_name_;
+
+    std::atomic<uint64_t> active_bytes_{0};
+    std::atomic<uint64_t> write_buffer_size_{0};
+    std::atomic<double> write_rate_{0};
+    std::atomic<double> overwrite_ratio_{0};
+    std::atomic<double> stall_risk_{0};
+    std::atomic<uint64_t> refresh_micros_{0};
+    // Set when another DB picked this candidate, cleared when the owner
+    // picks it. Protected by WriteBufferFlushPolicy::mu_.
+    bool requested_ = false;
+    // Owner-only state for the write rate.
+    uint64_t memtable_id_ = 0;
+    uint64_t data_size_ = 0;
+    bool has_flushed_ = false;
+  };
+
+  struct Decision {
+    // Candidate of the picking DB to flush, if any.
+    Candidate* victim = nullptr;
+    // True if the best candidate belongs to another DB that is writing. That
+    // DB flushes it on its next write, so the picking DB flushes nothing.
+    bool deferred = false;
+    double score = 0;
+  };
+
+  WriteBufferFlushPolicy() {}
+  // No copying allowed
+  WriteBufferFlushPolicy(const WriteBufferFlushPolicy&) = delete;
+  WriteBufferFlushPolicy& operator=(const WriteBufferFlushPolicy&) = delete;
+
+  ~WriteBufferFlushPolicy();
+
+  Candidate* Register(const void* owner, uint32_t cf_id,
+                      const std::string& cf_name);
+  void Unregister(Candidate* candidate);
+
+  // Picks the candidate with the highest Score() among those of `owner` and
+  // those of other active owners. A candidate another DB deferred to is
+  // picked again until its owner flushes it, so that DBs with slightly
+  // different views of the scores do not keep deferring to each other.
+  Decision Pick(const void* owner, uint64_t now_micros);
+
+  // How much flushing the candidate's active memtable now is worth: the
+  // bytes it releases, doubled for idle column families whose memory would
+  // otherwise stay pinned, divided by the write amplification of flushing
+  // before more overwrites are absorbed and by the risk of a write stall.
+  static double Score(const Candidate& candidate);
+
+ private:
+  std::mutex mu_;
+  std::list<Candidate> candidates_;
+};
+
+}  // namespace ROCKSDB_NAMESPACE
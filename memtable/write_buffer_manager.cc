@@ -9,8 +9,11 @@
 
 #include "rocksdb/write_buffer_manager.h"
 
+#include <algorithm>
+
 #include "cache/cache_entry_roles.h"
 #include "db/db_impl/db_impl.h"
+#include "memtable/write_buffer_flush_policy.h"
 #include "util/coding.h"
 
 namespace ROCKSDB_NAMESPACE {
@@ -52,7 +55,7 @@ struct WriteBufferManager::CacheRep {};
 
 WriteBufferManager::WriteBufferManager(size_t _buffer_size,
                                        std::shared_ptr<Cache> cache,
-                                       bool allow_stall)
+                                       bool allow_stall, bool cost_aware_flush)
     : buffer_size_(_buffer_size),
       mutable_limit_(buffer_size_ * 7 / 8),
       memory_used_(0),
@@ -60,7 +63,9 @@ WriteBufferManager::WriteBufferManager(size_t _buffer_size,
       dummy_size_(0),
       cache_rep_(nullptr),
       allow_stall_(allow_stall),
-      stall_active_(false) {
+      stall_active_(false),
+      flush_policy_(cost_aware_flush ? new WriteBufferFlushPolicy()
+                                     : nullptr) {
 #ifndef ROCKSDB_LITE
   if (cache) {
     // Construct the cache key using the pointer to this.
@@ -225,4 +230,143 @@ void WriteBufferManager::RemoveDBFromQueue(StallInterface* wbm_stall) {
   }
 }
 
+void WriteBufferFlushPolicy::Candidate::Refresh(
+    uint64_t memtable_id, uint64_t active_bytes, uint64_t data_size,
+    uint64_t write_buffer_size, double stall_risk, uint64_t now_micros) {
+  const uint64_t last_micros = refresh_micros();
+  if (last_micros == 0 || now_micros > last_micros) {
+    if (last_micros > 0) {
+      // After a memtable switch only the bytes of the new memtable are known
+      // to have been written since the last refresh.
+      const uint64_t written = memtable_id == memtable_id_ &&
+                                       data_size >= data_size_
+                                   ? data_size - data_size_
+                                   : data_size;
+      const uint64_t elapsed = now_micros - last_micros;
+      const double sample = static_cast<double>(written) * 1e6 / elapsed;
+      const double weight =
+          std::min(1.0, static_cast<double>(elapsed) / kRateWindowMicros);
+      const double rate = write_rate();
+      write_rate_.store(rate + weight * (sample - rate),
+                        std::memory_order_relaxed);
+    }
+    memtable_id_ = memtable_id;
+    data_size_ = data_size;
+    refresh_micros_.store(now_micros, std::memory_order_relaxed);
+  }
+  active_bytes_.store(active_bytes, std::memory_order_relaxed);
+  write_buffer_size_.store(write_buffer_size, std::memory_order_relaxed);
+  stall_risk_.store(stall_risk, std::memory_order_relaxed);
+}
+
+void WriteBufferFlushPolicy::Candidate::RecordFlush(uint64_t input_entries,
+                                                    uint64_t output_entries) {
+  if (input_entries == 0) {
+    return;
+  }
+  const double ratio =
+      1.0 - std::min(1.0, static_cast<double>(output_entries) / input_entries);
+  if (has_flushed_) {
+    overwrite_ratio_.store((overwrite_ratio() + ratio) / 2,
+                           std::memory_order_relaxed);
+  } else {
+    overwrite_ratio_.store(ratio, std::memory_order_relaxed);
+    has_flushed_ = true;
+  }
+}
+
+WriteBufferFlushPolicy::~WriteBufferFlushPolicy() {
+  // Every column family unregisters before its DB releases the manager.
+  assert(candidates_.empty());
+}
+
+WriteBufferFlushPolicy::Candidate* WriteBufferFlushPolicy::Register(
+    const void* owner, uint32_t cf_id, const std::string& cf_name) {
+  std::lock_guard<std::mutex> lock(mu_);
+  candidates_.emplace_back(owner, cf_id, cf_name);
+  return &candidates_.back();
+}
+
+void WriteBufferFlushPolicy::Unregister(Candidate* candidate) {
+  std::lock_guard<std::mutex> lock(mu_);
+  for (auto it = candidates_.begin(); it != candidates_.end(); ++it) {
+    if (&*it == candidate) {
+      candidates_.erase(it);
+      return;
+    }
+  }
+  assert(false);
+}
+
+double WriteBufferFlushPolicy::Score(const Candidate& candidate) {
+  // Write stalls cost more than the extra compaction work of an early flush.
+  static const double kStallWeight = 4;
+
+  const double active_bytes = static_cast<double>(candidate.active_bytes());
+  if (active_bytes == 0) {
+    return 0;
+  }
+  // A column family that keeps writing soon fills its write buffer and
+  // flushes by itself. The memtable of one that does not stays pinned, with
+  // its WAL, until something flushes it.
+  double idle = 1;
+  const double rate = candidate.write_rate();
+  if (rate > 0) {
+    const double write_buffer_size =
+        static_cast<double>(candidate.write_buffer_size());
+    const double fill_micros =
+        std::max(0.0, write_buffer_size - active_bytes) / rate * 1e6;
+    idle = std::min(1.0, fill_micros / kIdleHorizonMicros);
+  }
+  return active_bytes * (1 + idle) /
+         (1 + candidate.overwrite_ratio() +
+          kStallWeight * candidate.stall_risk());
+}
+
+WriteBufferFlushPolicy::Decision WriteBufferFlushPolicy::Pick(
+    const void* owner, uint64_t now_micros) {
+  std::lock_guard<std::mutex> lock(mu_);
+  Candidate* best = nullptr;
+  double best_score = 0;
+  bool best_requested = false;
+  for (auto& candidate : candidates_) {
+    const bool own = candidate.owner() == owner;
+    if (!own &&
+        now_micros > candidate.refresh_micros() + kActiveOwnerMicros) {
+      // Its DB is not writing, so it would not pick the candidate up.
+      candidate.requested_ = false;
+      continue;
+    }
+    if (candidate.active_bytes() == 0) {
+      candidate.requested_ = false;
+      continue;
+    }
+    const bool requested = candidate.requested_;
+    if (best_requested && !requested) {
+      continue;
+    }
+    const double score = Score(candidate);
+    if (best == nullptr || (requested && !best_requested) ||
+        score > best_score) {
+      best = &candidate;
+      best_score = score;
+      best_requested = requested;
+    }
+  }
+
+  Decision decision;
+  if (best == nullptr) {
+    return decision;
+  }
+  decision.score = best_score;
+  if (best->owner() == owner) {
+    best->requested_ = false;
+    decision.victim = best;
+  } else {
+    best->requested_ = true;
+    decision.deferred = true;
+  }
+  return decision;
+}
+
 }  // namespace ROCKSDB_NAMESPACE
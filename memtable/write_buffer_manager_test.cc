@@ -8,6 +8,7 @@
 // found in the LICENSE file. See the AUTHORS file for names of contributors.
 
 #include "rocksdb/write_buffer_manager.h"
+#include "memtable/write_buffer_flush_policy.h"
 #include "test_util/testharness.h"
 
 namespace ROCKSDB_NAMESPACE {
@@ -222,6 +223,101 @@ TEST_F(WriteBufferManagerTest, CacheFull) {
 }
 
 #endif  // ROCKSDB_LITE
+
+TEST_F(WriteBufferManagerTest, CostAwareFlushScore) {
+  const uint64_t kMB = 1024 * 1024;
+  const uint64_t kSecond = 1000 * 1000;
+  std::unique_ptr<WriteBufferManager> wbf(new WriteBufferManager(
+      64 * kMB, nullptr /* cache */, false /* allow_stall */,
+      true /* cost_aware_flush */));
+  ASSERT_FALSE(WriteBufferManager(64 * kMB).cost_aware_flush());
+  ASSERT_TRUE(wbf->cost_aware_flush());
+  WriteBufferFlushPolicy* policy = wbf->flush_policy();
+  int owner = 0;
+  auto* hot = policy->Register(&owner, 1, "hot");
+  auto* cold = policy->Register(&owner, 2, "cold");
+
+  // "hot" writes 8MB per second and fills its write buffer in 7 seconds.
+  hot->Refresh(1 /* memtable_id */, 0, 0, 64 * kMB, 0, 1 * kSecond);
+  hot->Refresh(1, 8 * kMB, 8 * kMB, 64 * kMB, 0, 2 * kSecond);
+  ASSERT_EQ(8.0 * kMB, hot->write_rate());
+  // "cold" holds as much memory but no longer writes.
+  cold->Refresh(1, 8 * kMB, 8 * kMB, 64 * kMB, 0, 1 * kSecond);
+  cold->Refresh(1, 8 * kMB, 8 * kMB, 64 * kMB, 0, 2 * kSecond);
+  ASSERT_EQ(0.0, cold->write_rate());
+  ASSERT_GT(WriteBufferFlushPolicy::Score(*cold),
+            WriteBufferFlushPolicy::Score(*hot));
+  WriteBufferFlushPolicy::Decision decision =
+      policy->Pick(&owner, 2 * kSecond);
+  ASSERT_EQ(cold, decision.victim);
+  ASSERT_FALSE(decision.deferred);
+
+  // One more L0 file would slow down writes to "cold".
+  cold->Refresh(1, 8 * kMB, 8 * kMB, 64 * kMB, 1.0, 3 * kSecond);
+  ASSERT_LT(WriteBufferFlushPolicy::Score(*cold),
+            WriteBufferFlushPolicy::Score(*hot));
+  cold->Refresh(1, 8 * kMB, 8 * kMB, 64 * kMB, 0, 4 * kSecond);
+
+  // Flushes of "cold" drop 80% of its entries.
+  cold->RecordFlush(100, 20);
+  ASSERT_DOUBLE_EQ(0.8, cold->overwrite_ratio());
+  ASSERT_LT(WriteBufferFlushPolicy::Score(*cold),
+            WriteBufferFlushPolicy::Score(*hot));
+
+  // A switched memtable counts its bytes as written since the last refresh.
+  hot->Refresh(2, 1 * kMB, 1 * kMB, 64 * kMB, 0, 3 * kSecond);
+  ASSERT_EQ(1.0 * kMB, hot->write_rate());
+
+  // An empty memtable is never picked.
+  hot->Clear();
+  cold->Clear();
+  ASSERT_EQ(0, WriteBufferFlushPolicy::Score(*hot));
+  decision = policy->Pick(&owner, 4 * kSecond);
+  ASSERT_EQ(nullptr, decision.victim);
+  ASSERT_FALSE(decision.deferred);
+
+  policy->Unregister(hot);
+  policy->Unregister(cold);
+}
+
+TEST_F(WriteBufferManagerTest, CostAwareFlushAcrossDBs) {
+  const uint64_t kMB = 1024 * 1024;
+  const uint64_t kSecond = 1000 * 1000;
+  std::unique_ptr<WriteBufferManager> wbf(new WriteBufferManager(
+      64 * kMB, nullptr /* cache */, false /* allow_stall */,
+      true /* cost_aware_flush */));
+  WriteBufferFlushPolicy* policy = wbf->flush_policy();
+  int db1 = 0, db2 = 0;
+  auto* small = policy->Register(&db1, 0, "small");
+  auto* large = policy->Register(&db2, 0, "large");
+  small->Refresh(1, 1 * kMB, 1 * kMB, 64 * kMB, 0, kSecond);
+  large->Refresh(1, 8 * kMB, 8 * kMB, 64 * kMB, 0, kSecond);
+
+  // db2 is writing, so db1 leaves the larger memtable to it.
+  WriteBufferFlushPolicy::Decision decision = policy->Pick(&db1, kSecond);
+  ASSERT_EQ(nullptr, decision.victim);
+  ASSERT_TRUE(decision.deferred);
+  // db1 keeps deferring to it even if its own memtable has grown larger.
+  small->Refresh(1, 16 * kMB, 16 * kMB, 64 * kMB, 0, kSecond + 1);
+  decision = policy->Pick(&db1, kSecond + 1);
+  ASSERT_TRUE(decision.deferred);
+  // until db2 flushes it.
+  decision = policy->Pick(&db2, kSecond + 2);
+  ASSERT_EQ(large, decision.victim);
+  large->Refresh(2, 0, 0, 64 * kMB, 0, kSecond + 3);
+  decision = policy->Pick(&db1, kSecond + 3);
+  ASSERT_EQ(small, decision.victim);
+
+  // db1 does not wait for a DB that stopped writing.
+  large->Refresh(2, 32 * kMB, 32 * kMB, 64 * kMB, 0, kSecond + 4);
+  decision = policy->Pick(
+      &db1, kSecond + 5 + WriteBufferFlushPolicy::kActiveOwnerMicros);
+  ASSERT_EQ(small, decision.victim);
+  ASSERT_FALSE(decision.deferred);
+
+  policy->Unregister(small);
+  policy->Unregister(large);
+}
 }  // namespace ROCKSDB_NAMESPACE
 
 int main(int argc, char** argv) {
@@ -0,0 +1,309 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include "monitoring/background_event_timeline.h"
+
+#include <assert.h>
+#include <inttypes.h>
+#include <stdio.h>
+
+#include <algorithm>
+
+#include "file/filename.h"
+#include "rocksdb/env.h"
+#include "rocksdb/system_clock.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+const char* BackgroundEventTypeName(BackgroundEventType type) {
+  switch (type) {
+    case BackgroundEventType::kFlush:
+      return "flush";
+    case BackgroundEventType::kCompaction:
+      return "compaction";
+    case BackgroundEventType::kWriteDelay:
+      return "write_delay";
+    case BackgroundEventType::kWriteStop:
+      return "write_stop";
+    case BackgroundEventType::kWalSync:
+      return "wal_sync";
+    default:
+      return "unknown";
+  }
+}
+
+#ifndef ROCKSDB_LITE
+constexpr size_t BackgroundEventListener::kDefaultMaxEvents;
+
+BackgroundEventListener::BackgroundEventListener(SystemClock* clock,
+                                                 size_t max_events)
+    : clock_(clock), max_events_(std::max<size_t>(max_events, 1)) {}
+
+void BackgroundEventListener::AddEvent(const BackgroundEvent& event) {
+  if (events_.size() < max_events_) {
+    events_.push_back(event);
+  } else {
+    events_[events_added_ % max_events_] = event;
+  }
+  events_added_++;
+}
+
+void BackgroundEventListener::Begin(std::map<int, OpenEvent>* open, int key,
+                                    uint64_t thread_id,
+                                    BackgroundEventType type) {
+  uint64_t now = clock_->NowNanos();
+  std::lock_guard<std::mutex> lock(mutex_);
+  (*open)[key] = {now, thread_id, type};
+}
+
+void BackgroundEventListener::End(std::map<int, OpenEvent>* open, int key,
+                                  uint64_t thread_id, uint64_t bytes,
+                                  BackgroundEventType type) {
+  uint64_t now = clock_->NowNanos();
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = open->find(key);
+  // Without a matching begin, e.g. when the listener was added late, the
+  // event is kept as an instant.
+  uint64_t start = now;
+  if (it != open->end()) {
+    start = it->second.start_nanos;
+    open->erase(it);
+  }
+  AddEvent({start, now, thread_id, bytes, type});
+}
+
+void BackgroundEventListener::OnFlushBegin(DB* /*db*/,
+                                           const FlushJobInfo& info) {
+  Begin(&flushes_, info.job_id, info.thread_id, BackgroundEventType::kFlush);
+}
+
+void BackgroundEventListener::OnFlushCompleted(DB* /*db*/,
+                                               const FlushJobInfo& info) {
+  const TableProperties& props = info.table_properties;
+  End(&flushes_, info.job_id, info.thread_id,
+      props.data_size + props.index_size + props.filter_size,
+      BackgroundEventType::kFlush);
+}
+
+void BackgroundEventListener::OnCompactionBegin(
+    DB* /*db*/, const CompactionJobInfo& info) {
+  Begin(&compactions_, info.job_id, info.thread_id,
+        BackgroundEventType::kCompaction);
+}
+
+void BackgroundEventListener::OnCompactionCompleted(
+    DB* /*db*/, const CompactionJobInfo& info) {
+  End(&compactions_, info.job_id, info.thread_id,
+      info.stats.total_output_bytes, BackgroundEventType::kCompaction);
+}
+
+void BackgroundEventListener::OnStallConditionsChanged(
+    const WriteStallInfo& info) {
+  uint64_t now = clock_->NowNanos();
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = stalls_.find(info.cf_name);
+  if (it != stalls_.end()) {
+    AddEvent({it->second.start_nanos, now, 0, 0, it->second.type});
+    stalls_.erase(it);
+  }
+  if (info.condition.cur != WriteStallCondition::kNormal) {
+    stalls_[info.cf_name] = {now, 0,
+                             info.condition.cur == WriteStallCondition::kDelayed
+                                 ? BackgroundEventType::kWriteDelay
+                                 : BackgroundEventType::kWriteStop};
+  }
+}
+
+void BackgroundEventListener::OnFileSyncFinish(const FileOperationInfo& info) {
+  OnWalSync(info);
+}
+
+void BackgroundEventListener::OnFileRangeSyncFinish(
+    const FileOperationInfo& info) {
+  OnWalSync(info);
+}
+
+void BackgroundEventListener::OnWalSync(const FileOperationInfo& info) {
+  size_t slash = info.path.find_last_of('/');
+  uint64_t number;
+  FileType type;
+  if (!ParseFileName(slash == std::string::npos
+                         ? info.path
+                         : info.path.substr(slash + 1),
+                     &number, &type) ||
+      type != kWalFile) {
+    return;
+  }
+  uint64_t now = clock_->NowNanos();
+  uint64_t duration = static_cast<uint64_t>(info.duration.count());
+  uint64_t thread_id = Env::Default()->GetThreadID();
+  std::lock_guard<std::mutex> lock(mutex_);
+  AddEvent({now - std::min(now, duration), now, thread_id, 0,
+            BackgroundEventType::kWalSync});
+}
+
+std::vector<BackgroundEvent> BackgroundEventListener::GetEvents() const {
+  uint64_t now = clock_->NowNanos();
+  std::vector<BackgroundEvent> events;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    events = events_;
+    for (const auto* open : {&flushes_, &compactions_}) {
+      for (const auto& kv : *open) {
+        events.push_back({kv.second.start_nanos, now, kv.second.thread_id, 0,
+                          kv.second.type});
+      }
+    }
+    for (const auto& kv : stalls_) {
+      events.push_back({kv.second.start_nanos, now, 0, 0, kv.second.type});
+    }
+  }
+  std::sort(events.begin(), events.end(),
+            [](const BackgroundEvent& a, const BackgroundEvent& b) {
+              return a.start_nanos < b.start_nanos;
+            });
+  return events;
+}
+
+uint64_t BackgroundEventListener::GetNumDroppedEvents() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return events_added_ - events_.size();
+}
+
+void BackgroundEventListener::Clear() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  events_.clear();
+  events_added_ = 0;
+}
+#endif  // !ROCKSDB_LITE
+
+std::string LatencySpikeCausesToString(uint32_t causes) {
+  if (causes == 0) {
+    return "none";
+  }
+  std::string result;
+  for (uint32_t t = 0;
+       t < static_cast<uint32_t>(BackgroundEventType::kNumTypes); ++t) {
+    if (causes & (1u << t)) {
+      if (!result.empty()) {
+        result.push_back('+');
+      }
+      result.append(BackgroundEventTypeName(static_cast<BackgroundEventType>(t)));
+    }
+  }
+  return result;
+}
+
+std::string LatencySpikeReport::ToString() const {
+  char buf[256];
+  snprintf(buf, sizeof(buf),
+           "Latency spikes: %" PRIu64 " of %" PRIu64
+           " operations slower than %" PRIu64 " ns\n%-40s %10s %7s %12s %12s\n",
+           num_spikes, num_records, threshold_nanos, "Overlapping", "Count",
+           "Share", "Avg(us)", "Max(us)");
+  std::string result = buf;
+  for (const Row& row : rows) {
+    snprintf(buf, sizeof(buf), "%-40s %10" PRIu64 " %6.2f%% %12.1f %12.1f\n",
+             LatencySpikeCausesToString(row.causes).c_str(), row.count,
+             100.0 * row.count / std::max<uint64_t>(num_spikes, 1),
+             row.total_nanos / 1000.0 / std::max<uint64_t>(row.count, 1),
+             row.max_nanos / 1000.0);
+    result.append(buf);
+  }
+  return result;
+}
+
+void AttributeLatencySpikes(
+    const std::vector<const LatencyTimeline*>& timelines,
+    const std::vector<BackgroundEvent>& events, double percentile,
+    std::vector<LatencySpike>* spikes, LatencySpikeReport* report) {
+  assert(percentile > 0 && percentile < 100);
+  *report = LatencySpikeReport();
+
+  std::vector<uint64_t> latencies;
+  for (const LatencyTimeline* t : timelines) {
+    for (size_t i = 0; i < t->size(); ++i) {
+      latencies.push_back(t->Get(i).latency_nanos);
+    }
+  }
+  report->num_records = latencies.size();
+  if (latencies.empty()) {
+    if (spikes != nullptr) {
+      spikes->clear();
+    }
+    return;
+  }
+  size_t rank = static_cast<size_t>(percentile / 100.0 * latencies.size());
+  rank = std::min(rank, latencies.size() - 1);
+  std::nth_element(latencies.begin(), latencies.begin() + rank,
+                   latencies.end());
+  report->threshold_nanos = latencies[rank];
+
+  std::vector<LatencySpike> found;
+  for (const LatencyTimeline* t : timelines) {
+    for (size_t i = 0; i < t->size(); ++i) {
+      const LatencyRecord& rec = t->Get(i);
+      if (rec.latency_nanos > report->threshold_nanos) {
+        found.push_back({rec.start_nanos, rec.latency_nanos, t->thread_id(),
+                         rec.op_type, 0});
+      }
+    }
+  }
+  std::sort(found.begin(), found.end(),
+            [](const LatencySpike& a, const LatencySpike& b) {
+              return a.start_nanos < b.start_nanos;
+            });
+
+  // Sweep over both lists in start order. `active` holds the events that
+  // started before the current spike ended and may still overlap it; since
+  // spikes start in order, an event that ended before a spike started
+  // cannot overlap any later spike.
+  std::vector<BackgroundEvent> sorted_events = events;
+  std::sort(sorted_events.begin(), sorted_events.end(),
+            [](const BackgroundEvent& a, const BackgroundEvent& b) {
+              return a.start_nanos < b.start_nanos;
+            });
+  std::vector<const BackgroundEvent*> active;
+  size_t next_event = 0;
+  std::map<uint32_t, LatencySpikeReport::Row> rows;
+  for (LatencySpike& spike : found) {
+    uint64_t spike_end = spike.start_nanos + spike.latency_nanos;
+    while (next_event < sorted_events.size() &&
+           sorted_events[next_event].start_nanos <= spike_end) {
+      active.push_back(&sorted_events[next_event++]);
+    }
+    active.erase(std::remove_if(active.begin(), active.end(),
+                                [&spike](const BackgroundEvent* e) {
+                                  return e->end_nanos < spike.start_nanos;
+                                }),
+                 active.end());
+    for (const BackgroundEvent* e : active) {
+      if (e->start_nanos <= spike_end) {
+        spike.causes |= 1u << static_cast<uint32_t>(e->type);
+      }
+    }
+
+    LatencySpikeReport::Row& row = rows[spike.causes];
+    row.causes = spike.causes;
+    row.count++;
+    row.total_nanos += spike.latency_nanos;
+    row.max_nanos = std::max(row.max_nanos, spike.latency_nanos);
+  }
+
+  report->num_spikes = found.size();
+  for (const auto& kv : rows) {
+    report->rows.push_back(kv.second);
+  }
+  std::stable_sort(report->rows.begin(), report->rows.end(),
+                   [](const LatencySpikeReport::Row& a,
+                      const LatencySpikeReport::Row& b) {
+                     return a.count > b.count;
+                   });
+  if (spikes != nullptr) {
+    spikes->swap(found);
+  }
+}
+
+}  // namespace ROCKSDB_NAMESPACE
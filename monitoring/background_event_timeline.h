@@ -0,0 +1,154 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+//
+// Attribution of foreground latency spikes to background activity. An
+// EventListener records the intervals of flushes, compactions, write stalls
+// and WAL syncs; AttributeLatencySpikes() then joins them with the
+// per-operation records of LatencyTimelines (see latency_timeline.h) and
+// labels every outlier with the kinds of activity it overlapped.
+
+#pragma once
+
+#include <stdint.h>
+
+#include <map>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "monitoring/latency_timeline.h"
+#include "rocksdb/listener.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+class SystemClock;
+
+enum class BackgroundEventType : uint8_t {
+  kFlush = 0,
+  kCompaction,
+  kWriteDelay,
+  kWriteStop,
+  kWalSync,
+  kNumTypes,
+};
+
+extern const char* BackgroundEventTypeName(BackgroundEventType type);
+
+struct BackgroundEvent {
+  // Interval in SystemClock::NowNanos() time, like LatencyRecord.
+  uint64_t start_nanos;
+  uint64_t end_nanos;
+  // The background thread for flushes, compactions and syncs; 0 for stalls.
+  uint64_t thread_id;
+  // Output bytes of flushes and compactions, 0 otherwise.
+  uint64_t bytes;
+  BackgroundEventType type;
+};
+
+#ifndef ROCKSDB_LITE
+// Records background events of the DBs it is registered with. Timestamps are
+// taken from `clock` when callbacks fire, so they share a time base with
+// LatencyTimelines filled using the same clock. Callbacks run on background
+// threads and serialize on a mutex; they are rare compared to foreground
+// operations. At most `max_events` completed events are kept; after that the
+// oldest ones are overwritten and counted as dropped.
+class BackgroundEventListener : public EventListener {
+ public:
+  static constexpr size_t kDefaultMaxEvents = size_t{1} << 18;
+
+  explicit BackgroundEventListener(SystemClock* clock,
+                                   size_t max_events = kDefaultMaxEvents);
+
+  void OnFlushBegin(DB* db, const FlushJobInfo& info) override;
+  void OnFlushCompleted(DB* db, const FlushJobInfo& info) override;
+  void OnCompactionBegin(DB* db, const CompactionJobInfo& info) override;
+  void OnCompactionCompleted(DB* db, const CompactionJobInfo& info) override;
+  void OnStallConditionsChanged(const WriteStallInfo& info) override;
+  void OnFileSyncFinish(const FileOperationInfo& info) override;
+  void OnFileRangeSyncFinish(const FileOperationInfo& info) override;
+  bool ShouldBeNotifiedOnFileIO() override { return true; }
+
+  // Returns the recorded events sorted by start time. Intervals still open
+  // are reported as ending now.
+  std::vector<BackgroundEvent> GetEvents() const;
+  // Number of completed events overwritten since the last Clear().
+  uint64_t GetNumDroppedEvents() const;
+  // Drops the completed events. Intervals still open are kept.
+  void Clear();
+
+ private:
+  struct OpenEvent {
+    uint64_t start_nanos;
+    uint64_t thread_id;
+    BackgroundEventType type;
+  };
+
+  void Begin(std::map<int, OpenEvent>* open, int key, uint64_t thread_id,
+             BackgroundEventType type);
+  void End(std::map<int, OpenEvent>* open, int key, uint64_t thread_id,
+           uint64_t bytes, BackgroundEventType type);
+  void OnWalSync(const FileOperationInfo& info);
+  // REQUIRES: mutex_ held
+  void AddEvent(const BackgroundEvent& event);
+
+  SystemClock* const clock_;
+  const size_t max_events_;
+  mutable std::mutex mutex_;
+  // Ring of the completed events; events_added_ % max_events_ is the slot of
+  // the next one once it is full.
+  std::vector<BackgroundEvent> events_;
+  uint64_t events_added_ = 0;
+  // Keyed by job id.
+  std::map<int, OpenEvent> flushes_;
+  std::map<int, OpenEvent> compactions_;
+  // Keyed by column family name.
+  std::unordered_map<std::string, OpenEvent> stalls_;
+};
+#endif  // !ROCKSDB_LITE
+
+// An operation slower than the spike threshold.
+struct LatencySpike {
+  uint64_t start_nanos;
+  uint64_t latency_nanos;
+  uint32_t thread_id;
+  uint8_t op_type;
+  // Bit (1 << type) is set for every BackgroundEventType that overlapped
+  // the operation.
+  uint32_t causes;
+};
+
+struct LatencySpikeReport {
+  struct Row {
+    uint32_t causes;
+    uint64_t count;
+    uint64_t total_nanos;
+    uint64_t max_nanos;
+  };
+
+  // Operations slower than this are spikes.
+  uint64_t threshold_nanos = 0;
+  uint64_t num_records = 0;
+  uint64_t num_spikes = 0;
+  // One row per distinct combination of causes, most frequent first.
+  std::vector<Row> rows;
+
+  std::string ToString() const;
+};
+
+// "flush+compaction", or "none" for 0.
+extern std::string LatencySpikeCausesToString(uint32_t causes);
+
+// Finds the records of `timelines` whose latency exceeds the `percentile`-th
+// percentile of all their records and labels each with the `events`
+// overlapping it. Only records still held by the timelines are considered.
+// `spikes`, if not null, receives every spike in start time order.
+// REQUIRES: 0 < percentile < 100
+extern void AttributeLatencySpikes(
+    const std::vector<const LatencyTimeline*>& timelines,
+    const std::vector<BackgroundEvent>& events, double percentile,
+    std::vector<LatencySpike>* spikes, LatencySpikeReport* report);
+
+}  // namespace ROCKSDB_NAMESPACE
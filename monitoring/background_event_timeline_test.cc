@@ -0,0 +1,184 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include "monitoring/background_event_timeline.h"
+
+#include <string>
+#include <vector>
+
+#include "rocksdb/db.h"
+#include "rocksdb/env.h"
+#include "rocksdb/system_clock.h"
+#include "test_util/testharness.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+namespace {
+uint32_t Bit(BackgroundEventType type) {
+  return 1u << static_cast<uint32_t>(type);
+}
+
+size_t CountEvents(const std::vector<BackgroundEvent>& events,
+                   BackgroundEventType type) {
+  size_t count = 0;
+  for (const auto& e : events) {
+    if (e.type == type) {
+      ++count;
+      EXPECT_LE(e.start_nanos, e.end_nanos);
+    }
+  }
+  return count;
+}
+}  // namespace
+
+TEST(BackgroundEventTimelineTest, AttributeSpikes) {
+  // 200 operations of 10ns, every 100ns, on two threads; four are slow.
+  LatencyTimeline t0(0, 1000), t1(1, 1000);
+  for (uint64_t i = 0; i < 100; ++i) {
+    uint64_t latency = 10;
+    if (i == 2 || i == 3 || i == 50) {
+      latency = 1000;
+    }
+    t0.Record(i * 100, latency, 0, 0);
+    t1.Record(i * 100 + 50, i == 80 ? 2000 : 10, 1, 0);
+  }
+  std::vector<BackgroundEvent> events = {
+      {5000, 5100, 7, 100, BackgroundEventType::kCompaction},
+      {150, 400, 8, 100, BackgroundEventType::kFlush},
+      {1250, 1260, 9, 0, BackgroundEventType::kWalSync},
+      {9000, 9500, 0, 0, BackgroundEventType::kWriteStop},
+  };
+
+  std::vector<LatencySpike> spikes;
+  LatencySpikeReport report;
+  AttributeLatencySpikes({&t0, &t1}, events, 90.0, &spikes, &report);
+  ASSERT_EQ(200U, report.num_records);
+  ASSERT_EQ(10U, report.threshold_nanos);
+  ASSERT_EQ(4U, report.num_spikes);
+  ASSERT_EQ(4U, spikes.size());
+
+  // [200, 1200] overlaps the flush.
+  ASSERT_EQ(200U, spikes[0].start_nanos);
+  ASSERT_EQ(Bit(BackgroundEventType::kFlush), spikes[0].causes);
+  // [300, 1300] also overlaps the WAL sync.
+  ASSERT_EQ(Bit(BackgroundEventType::kFlush) |
+                Bit(BackgroundEventType::kWalSync),
+            spikes[1].causes);
+  // [5000, 6000] overlaps the compaction.
+  ASSERT_EQ(Bit(BackgroundEventType::kCompaction), spikes[2].causes);
+  // [8050, 10050] on thread 1 overlaps the stop.
+  ASSERT_EQ(1U, spikes[3].thread_id);
+  ASSERT_EQ(2000U, spikes[3].latency_nanos);
+  ASSERT_EQ(Bit(BackgroundEventType::kWriteStop), spikes[3].causes);
+
+  // All counts tie, so rows stay ordered by causes.
+  ASSERT_EQ(4U, report.rows.size());
+  ASSERT_EQ(1U, report.rows[3].count);
+  ASSERT_EQ("flush+wal_sync",
+            LatencySpikeCausesToString(report.rows[3].causes));
+  ASSERT_EQ("none", LatencySpikeCausesToString(0));
+  std::string table = report.ToString();
+  ASSERT_NE(std::string::npos, table.find("4 of 200 operations"));
+  ASSERT_NE(std::string::npos, table.find("write_stop"));
+
+  // Nothing is slower than the maximum.
+  AttributeLatencySpikes({&t0, &t1}, events, 99.9, nullptr, &report);
+  ASSERT_EQ(2000U, report.threshold_nanos);
+  ASSERT_EQ(0U, report.num_spikes);
+}
+
+#ifndef ROCKSDB_LITE
+TEST(BackgroundEventTimelineTest, Listener) {
+  auto listener = std::make_shared<BackgroundEventListener>(
+      SystemClock::Default().get());
+  Options options;
+  options.create_if_missing = true;
+  options.listeners.push_back(listener);
+  std::string dbname = test::PerThreadDBPath("background_event_timeline");
+  ASSERT_OK(DestroyDB(dbname, options));
+  DB* db = nullptr;
+  ASSERT_OK(DB::Open(options, dbname, &db));
+
+  WriteOptions sync;
+  sync.sync = true;
+  for (int i = 0; i < 2; ++i) {
+    ASSERT_OK(db->Put(sync, "key" + std::to_string(i), "value"));
+    ASSERT_OK(db->Flush(FlushOptions()));
+  }
+  // Forced, so that the files are rewritten rather than trivially moved.
+  CompactRangeOptions cro;
+  cro.bottommost_level_compaction = BottommostLevelCompaction::kForce;
+  ASSERT_OK(db->CompactRange(cro, nullptr, nullptr));
+
+  std::vector<BackgroundEvent> events = listener->GetEvents();
+  ASSERT_EQ(2U, CountEvents(events, BackgroundEventType::kFlush));
+  ASSERT_EQ(1U, CountEvents(events, BackgroundEventType::kCompaction));
+  ASSERT_LE(2U, CountEvents(events, BackgroundEventType::kWalSync));
+  for (const auto& e : events) {
+    if (e.type == BackgroundEventType::kFlush ||
+        e.type == BackgroundEventType::kCompaction) {
+      ASSERT_GT(e.bytes, 0U);
+      ASSERT_NE(0U, e.thread_id);
+    }
+  }
+  for (size_t i = 1; i < events.size(); ++i) {
+    ASSERT_LE(events[i - 1].start_nanos, events[i].start_nanos);
+  }
+  delete db;
+  ASSERT_OK(DestroyDB(dbname, options));
+
+  // A delay turning into a stop closes the delay; the open stop is
+  // reported as ending now.
+  listener->Clear();
+  WriteStallInfo info;
+  info.cf_name = "default";
+  info.condition.prev = WriteStallCondition::kNormal;
+  info.condition.cur = WriteStallCondition::kDelayed;
+  listener->OnStallConditionsChanged(info);
+  info.condition.prev = WriteStallCondition::kDelayed;
+  info.condition.cur = WriteStallCondition::kStopped;
+  listener->OnStallConditionsChanged(info);
+  events = listener->GetEvents();
+  ASSERT_EQ(1U, CountEvents(events, BackgroundEventType::kWriteDelay));
+  ASSERT_EQ(1U, CountEvents(events, BackgroundEventType::kWriteStop));
+  info.condition.prev = WriteStallCondition::kStopped;
+  info.condition.cur = WriteStallCondition::kNormal;
+  listener->OnStallConditionsChanged(info);
+  ASSERT_EQ(2U, listener->GetEvents().size());
+}
+
+TEST(BackgroundEventTimelineTest, ListenerKeepsLatestEvents) {
+  BackgroundEventListener listener(SystemClock::Default().get(),
+                                   /*max_events=*/3);
+  WriteStallInfo info;
+  info.cf_name = "default";
+  // Five delays, alternating with stops.
+  for (int i = 0; i < 10; ++i) {
+    info.condition.prev = info.condition.cur;
+    info.condition.cur = i % 2 == 0 ? WriteStallCondition::kDelayed
+                                    : WriteStallCondition::kStopped;
+    listener.OnStallConditionsChanged(info);
+  }
+  // Nine completed events, plus the open stop.
+  std::vector<BackgroundEvent> events = listener.GetEvents();
+  ASSERT_EQ(4U, events.size());
+  ASSERT_EQ(6U, listener.GetNumDroppedEvents());
+  ASSERT_EQ(BackgroundEventType::kWriteDelay, events[0].type);
+  ASSERT_EQ(BackgroundEventType::kWriteStop, events[1].type);
+  ASSERT_EQ(BackgroundEventType::kWriteDelay, events[2].type);
+  ASSERT_EQ(BackgroundEventType::kWriteStop, events[3].type);
+
+  listener.Clear();
+  ASSERT_EQ(0U, listener.GetNumDroppedEvents());
+  ASSERT_EQ(1U, listener.GetEvents().size());
+}
+#endif  // !ROCKSDB_LITE
+
+}  // namespace ROCKSDB_NAMESPACE
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
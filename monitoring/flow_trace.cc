@@ -0,0 +1,382 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include "monitoring/flow_trace.h"
+
+#include <inttypes.h>
+#include <stdio.h>
+
+#ifdef OS_WIN
+#include <process.h>
+#else
+#include <unistd.h>
+#endif
+
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <mutex>
+
+#include "port/port.h"
+#include "rocksdb/env.h"
+#include "util/string_util.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+std::atomic<uint32_t> FlowTracer::enabled_mask_{0};
+
+namespace {
+
+const int kNumCategories = 4;
+
+// Slots are written by their owning thread while exporters may read them, so
+// every field is atomic. Relaxed accesses compile to plain loads and stores.
+struct EventSlot {
+  std::atomic<const char*> name;
+  std::atomic<uint64_t> start_nanos;
+  std::atomic<uint64_t> duration_nanos;
+  std::atomic<uint32_t> category;
+  std::atomic<char> phase;
+};
+
+const size_t kSlotsPerChunk = 1024;
+const size_t kNumChunks = FlowTracer::kEventsPerThread / kSlotsPerChunk;
+
+// At most this many buffers of exited threads are kept for export. Helper
+// threads that are created per operation would otherwise grow the registry
+// without bound.
+const size_t kMaxExitedBuffers = 256;
+
+// Events of one thread, in a ring of lazily allocated chunks. Only the owning
+// thread appends, without locking. Readers detect the slots overwritten while
+// they copy them the way a seqlock does: the writer publishes the index it is
+// about to write in `begun` before writing the slot and in `total` after.
+struct ThreadBuffer {
+  explicit ThreadBuffer(uint64_t id) : thread_id(id) {
+    for (auto& chunk : chunks) {
+      chunk.store(nullptr, std::memory_order_relaxed);
+    }
+  }
+  ~ThreadBuffer() {
+    for (auto& chunk : chunks) {
+      delete[] chunk.load(std::memory_order_relaxed);
+    }
+  }
+
+  EventSlot* Slot(uint64_t index) const {
+    EventSlot* chunk = chunks[(index % FlowTracer::kEventsPerThread) /
+                             kSlotsPerChunk]
+                           .load(std::memory_order_acquire);
+    return chunk + index % kSlotsPerChunk;
+  }
+
+  const uint64_t thread_id;
+  std::atomic<uint64_t> begun{0};
+  std::atomic<uint64_t> total{0};
+  // Events before this index were cleared.
+  std::atomic<uint64_t> cleared{0};
+  std::atomic<EventSlot*> chunks[kNumChunks];
+  // Protected by the registry mutex.
+  bool exited = false;
+};
+
+// Buffers are owned by the registry rather than by their threads so that
+// events of threads that have exited can still be exported.
+struct Registry {
+  std::mutex mutex;
+  uint32_t refs[kNumCategories] = {};
+  std::vector<std::shared_ptr<ThreadBuffer>> buffers;
+  size_t num_exited = 0;
+};
+
+Registry& GetRegistry() {
+  // Leaked to stay usable from other static destructors.
+  static Registry* registry = new Registry();
+  return *registry;
+}
+
+// Drops the exited buffers that hold no events, and the oldest exited ones
+// beyond kMaxExitedBuffers.
+// REQUIRES: registry.mutex held
+void ReclaimExitedBuffers(Registry* registry) {
+  auto& buffers = registry->buffers;
+  size_t excess = registry->num_exited > kMaxExitedBuffers
+                      ? registry->num_exited - kMaxExitedBuffers
+                      : 0;
+  size_t kept = 0;
+  for (size_t i = 0; i < buffers.size(); ++i) {
+    ThreadBuffer* buffer = buffers[i].get();
+    if (buffer->exited &&
+        (excess > 0 || buffer->total.load(std::memory_order_relaxed) ==
+                           buffer->cleared.load(std::memory_order_relaxed))) {
+      if (excess > 0) {
+        --excess;
+      }
+      registry->num_exited--;
+      continue;
+    }
+    buffers[kept++] = std::move(buffers[i]);
+  }
+  buffers.resize(kept);
+}
+
+// Registers the buffer of a thread on its first event and hands it back to
+// the registry when the thread exits.
+struct ThreadBufferHolder {
+  ~ThreadBufferHolder() {
+    if (buffer == nullptr) {
+      return;
+    }
+    Registry& registry = GetRegistry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    buffer->exited = true;
+    registry.num_exited++;
+    ReclaimExitedBuffers(&registry);
+  }
+
+  ThreadBuffer* buffer = nullptr;
+};
+
+ThreadBuffer* GetThreadBuffer() {
+  thread_local ThreadBufferHolder holder;
+  if (holder.buffer == nullptr) {
+    auto owned = std::make_shared<ThreadBuffer>(Env::Default()->GetThreadID());
+    Registry& registry = GetRegistry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    registry.buffers.push_back(owned);
+    holder.buffer = owned.get();
+  }
+  return holder.buffer;
+}
+
+const char* CategoryName(uint32_t category) {
+  switch (category) {
+    case kFlowTraceWrite:
+      return "write";
+    case kFlowTraceRead:
+      return "read";
+    case kFlowTraceFlush:
+      return "flush";
+    case kFlowTraceCompaction:
+      return "compaction";
+    default:
+      return "unknown";
+  }
+}
+
+void AppendJsonString(std::string* out, const char* s) {
+  out->push_back('"');
+  for (; *s != '\0'; ++s) {
+    if (*s == '"' || *s == '\\') {
+      out->push_back('\\');
+    }
+    out->push_back(*s);
+  }
+  out->push_back('"');
+}
+
+}  // namespace
+
+void FlowTracer::EnableCategories(uint32_t categories) {
+  Registry& registry = GetRegistry();
+  std::lock_guard<std::mutex> lock(registry.mutex);
+  for (int i = 0; i < kNumCategories; ++i) {
+    if ((categories & (1u << i)) && registry.refs[i]++ == 0) {
+      enabled_mask_.fetch_or(1u << i, std::memory_order_relaxed);
+    }
+  }
+}
+
+void FlowTracer::DisableCategories(uint32_t categories) {
+  Registry& registry = GetRegistry();
+  std::lock_guard<std::mutex> lock(registry.mutex);
+  for (int i = 0; i < kNumCategories; ++i) {
+    if ((categories & (1u << i)) && registry.refs[i] > 0 &&
+        --registry.refs[i] == 0) {
+      enabled_mask_.fetch_and(~(1u << i), std::memory_order_relaxed);
+    }
+  }
+}
+
+uint64_t FlowTracer::NowNanos() {
+  return static_cast<uint64_t>(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(
+          std::chrono::steady_clock::now().time_since_epoch())
+          .count());
+}
+
+void FlowTracer::Record(uint32_t category, const char* name,
+                        uint64_t start_nanos, uint64_t duration_nanos,
+                        char phase) {
+  ThreadBuffer* buffer = GetThreadBuffer();
+  const uint64_t index = buffer->total.load(std::memory_order_relaxed);
+  auto& chunk = buffer->chunks[(index % kEventsPerThread) / kSlotsPerChunk];
+  if (chunk.load(std::memory_order_relaxed) == nullptr) {
+    chunk.store(new EventSlot[kSlotsPerChunk], std::memory_order_release);
+  }
+  buffer->begun.store(index + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  EventSlot* slot = buffer->Slot(index);
+  slot->name.store(name, std::memory_order_relaxed);
+  slot->start_nanos.store(start_nanos, std::memory_order_relaxed);
+  slot->duration_nanos.store(duration_nanos, std::memory_order_relaxed);
+  slot->category.store(category, std::memory_order_relaxed);
+  slot->phase.store(phase, std::memory_order_relaxed);
+  buffer->total.store(index + 1, std::memory_order_release);
+}
+
+void FlowTracer::Collect(std::vector<FlowTraceEvent>* events,
+                         std::vector<uint64_t>* thread_ids) {
+  events->clear();
+  if (thread_ids != nullptr) {
+    thread_ids->clear();
+  }
+  Registry& registry = GetRegistry();
+  std::lock_guard<std::mutex> lock(registry.mutex);
+  std::vector<FlowTraceEvent> copied;
+  for (const auto& buffer : registry.buffers) {
+    const uint64_t end = buffer->total.load(std::memory_order_acquire);
+    uint64_t begin = std::max(buffer->cleared.load(std::memory_order_relaxed),
+                              end > kEventsPerThread ? end - kEventsPerThread
+                                                     : uint64_t{0});
+    copied.clear();
+    for (uint64_t i = begin; i < end; ++i) {
+      const EventSlot* slot = buffer->Slot(i);
+      copied.push_back({slot->name.load(std::memory_order_relaxed),
+                        slot->start_nanos.load(std::memory_order_relaxed),
+                        slot->duration_nanos.load(std::memory_order_relaxed),
+                        slot->category.load(std::memory_order_relaxed),
+                        slot->phase.load(std::memory_order_relaxed)});
+    }
+    // Slots of events the owner started to overwrite during the copy are
+    // not consistent.
+    std::atomic_thread_fence(std::memory_order_acquire);
+    const uint64_t begun = buffer->begun.load(std::memory_order_relaxed);
+    size_t skip = 0;
+    if (begun > begin + kEventsPerThread) {
+      skip = static_cast<size_t>(
+          std::min<uint64_t>(begun - kEventsPerThread - begin, copied.size()));
+    }
+    events->insert(events->end(), copied.begin() + skip, copied.end());
+    if (thread_ids != nullptr) {
+      thread_ids->resize(events->size(), buffer->thread_id);
+    }
+  }
+}
+
+Status FlowTracer::ExportChromeTrace(Env* env, const std::string& path) {
+  std::vector<FlowTraceEvent> events;
+  std::vector<uint64_t> thread_ids;
+  Collect(&events, &thread_ids);
+  std::vector<size_t> order(events.size());
+  for (size_t i = 0; i < order.size(); ++i) {
+    order[i] = i;
+  }
+  std::sort(order.begin(), order.end(), [&events](size_t a, size_t b) {
+    return events[a].start_nanos < events[b].start_nanos;
+  });
+
+  std::unique_ptr<WritableFile> file;
+  Status s = env->NewWritableFile(path, &file, EnvOptions());
+  if (!s.ok()) {
+    return s;
+  }
+#ifdef OS_WIN
+  const int pid = _getpid();
+#else
+  const int pid = static_cast<int>(getpid());
+#endif
+  // Timestamps are microseconds in the Chrome format; keep nanosecond
+  // precision in the fraction.
+  std::string out = "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+  char buf[256];
+  for (size_t n = 0; n < order.size(); ++n) {
+    const FlowTraceEvent& e = events[order[n]];
+    if (n > 0) {
+      out.push_back(',');
+    }
+    out.append("\n{\"name\":");
+    AppendJsonString(&out, e.name);
+    snprintf(buf, sizeof(buf),
+             ",\"cat\":\"%s\",\"ph\":\"%c\",\"ts\":%" PRIu64 ".%03u,"
+             "\"pid\":%d,\"tid\":%" PRIu64,
+             CategoryName(e.category), e.phase, e.start_nanos / 1000,
+             static_cast<unsigned>(e.start_nanos % 1000), pid,
+             thread_ids[order[n]]);
+    out.append(buf);
+    if (e.phase == 'X') {
+      snprintf(buf, sizeof(buf), ",\"dur\":%" PRIu64 ".%03u",
+               e.duration_nanos / 1000,
+               static_cast<unsigned>(e.duration_nanos % 1000));
+      out.append(buf);
+    } else {
+      out.append(",\"s\":\"t\"");
+    }
+    out.push_back('}');
+    if (out.size() >= (1 << 20)) {
+      s = file->Append(out);
+      if (!s.ok()) {
+        return s;
+      }
+      out.clear();
+    }
+  }
+  out.append("\n]}\n");
+  s = file->Append(out);
+  if (s.ok()) {
+    s = file->Close();
+  }
+  return s;
+}
+
+void FlowTracer::Clear() {
+  Registry& registry = GetRegistry();
+  std::lock_guard<std::mutex> lock(registry.mutex);
+  for (const auto& buffer : registry.buffers) {
+    buffer->cleared.store(buffer->total.load(std::memory_order_acquire),
+                          std::memory_order_relaxed);
+  }
+  ReclaimExitedBuffers(&registry);
+}
+
+size_t FlowTracer::TEST_NumThreadBuffers() {
+  Registry& registry = GetRegistry();
+  std::lock_guard<std::mutex> lock(registry.mutex);
+  return registry.buffers.size();
+}
+
+Status ParseFlowTraceCategories(const std::string& names,
+                                uint32_t* categories) {
+  uint32_t mask = 0;
+  for (const std::string& raw : StringSplit(names, ',')) {
+    std::string name = trim(raw);
+    if (name.empty() || name == "none") {
+      continue;
+    } else if (name == "all") {
+      mask |= kFlowTraceAll;
+    } else {
+      bool found = false;
+      for (int i = 0; i < kNumCategories; ++i) {
+        if (name == CategoryName(1u << i)) {
+          mask |= 1u << i;
+          found = true;
+        }
+      }
+      if (!found) {
+        return Status::InvalidArgument("Unknown flow trace category", name);
+      }
+    }
+  }
+  *categories = mask;
+  return Status::OK();
+}
+
+Status ExportFlowTrace(Env* env, const std::string& path) {
+  return FlowTracer::ExportChromeTrace(env, path);
+}
+
+void ClearFlowTrace() { FlowTracer::Clear(); }
+
+}  // namespace ROCKSDB_NAMESPACE
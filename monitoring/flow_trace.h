@@ -0,0 +1,122 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+//
+// Internal side of flow tracing (see include/rocksdb/flow_trace.h). Code
+// paths mark themselves with
+//
+//   FLOW_TRACE_SCOPE(kFlowTraceWrite, "DBImpl::WriteImpl");
+//
+// which, while the category is enabled, records one complete event covering
+// the rest of the enclosing scope. While it is disabled the cost is one
+// relaxed load of a global mask. Defining ROCKSDB_DISABLE_FLOW_TRACE removes
+// the tracepoints entirely.
+
+#pragma once
+
+#include <stdint.h>
+
+#include <atomic>
+#include <string>
+#include <vector>
+
+#include "port/likely.h"
+#include "rocksdb/flow_trace.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+struct FlowTraceEvent {
+  // Must point to storage that outlives the trace, normally a literal.
+  const char* name;
+  uint64_t start_nanos;
+  // 0 for instant events.
+  uint64_t duration_nanos;
+  uint32_t category;
+  // 'X' (complete) or 'i' (instant), as in the Chrome trace format.
+  char phase;
+};
+
+class FlowTracer {
+ public:
+  // Maximum number of events kept per thread; older events are overwritten.
+  static constexpr size_t kEventsPerThread = size_t{1} << 16;
+
+  static bool Enabled(uint32_t category) {
+    return (enabled_mask_.load(std::memory_order_relaxed) & category) != 0;
+  }
+
+  // Enabling is reference counted per category so that several DB instances
+  // can trace independently: every EnableCategories(mask) must eventually be
+  // matched by a DisableCategories(mask).
+  static void EnableCategories(uint32_t categories);
+  static void DisableCategories(uint32_t categories);
+
+  // Monotonic clock used for all events.
+  static uint64_t NowNanos();
+
+  static void Record(uint32_t category, const char* name, uint64_t start_nanos,
+                     uint64_t duration_nanos, char phase);
+
+  // Copies out the buffered events of all threads. `thread_ids`, if not
+  // null, receives the id of the thread that recorded each event.
+  static void Collect(std::vector<FlowTraceEvent>* events,
+                      std::vector<uint64_t>* thread_ids);
+
+  static Status ExportChromeTrace(Env* env, const std::string& path);
+  // Drops the buffered events, and the buffers of threads that have exited.
+  static void Clear();
+
+  static size_t TEST_NumThreadBuffers();
+
+ private:
+  static std::atomic<uint32_t> enabled_mask_;
+};
+
+// Records a complete event from construction to destruction if `category`
+// was enabled at construction time.
+class FlowTraceScope {
+ public:
+  FlowTraceScope(uint32_t category, const char* name)
+      : category_(category),
+        name_(name),
+        start_nanos_(UNLIKELY(FlowTracer::Enabled(category))
+                         ? FlowTracer::NowNanos()
+                         : 0) {}
+
+  ~FlowTraceScope() {
+    if (UNLIKELY(start_nanos_ != 0)) {
+      FlowTracer::Record(category_, name_, start_nanos_,
+                         FlowTracer::NowNanos() - start_nanos_, 'X');
+    }
+  }
+
+  FlowTraceScope(const FlowTraceScope&) = delete;
+  FlowTraceScope& operator=(const FlowTraceScope&) = delete;
+
+ private:
+  const uint32_t category_;
+  const char* const name_;
+  const uint64_t start_nanos_;
+};
+
+#ifdef ROCKSDB_DISABLE_FLOW_TRACE
+#define FLOW_TRACE_SCOPE(category, name)
+#define FLOW_TRACE_INSTANT(category, name)
+#else
+#define FLOW_TRACE_CONCAT_(a, b) a##b
+#define FLOW_TRACE_CONCAT(a, b) FLOW_TRACE_CONCAT_(a, b)
+#define FLOW_TRACE_SCOPE(category, name)                              \
+  ROCKSDB_NAMESPACE::FlowTraceScope FLOW_TRACE_CONCAT(flow_trace_scope_, \
+                                                      __LINE__)(category, name)
+#define FLOW_TRACE_INSTANT(category, name)                             \
+  do {                                                                 \
+    if (UNLIKELY(ROCKSDB_NAMESPACE::FlowTracer::Enabled(category))) {  \
+      ROCKSDB_NAMESPACE::FlowTracer::Record(                           \
+          category, name, ROCKSDB_NAMESPACE::FlowTracer::NowNanos(), 0, \
+          'i');                                                        \
+    }                                                                  \
+  } while (0)
+#endif
+
+}  // namespace ROCKSDB_NAMESPACE
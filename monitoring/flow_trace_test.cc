@@ -0,0 +1,166 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include "monitoring/flow_trace.h"
+
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "rocksdb/db.h"
+#include "rocksdb/env.h"
+#include "test_util/testharness.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+class FlowTraceTest : public testing::Test {
+ public:
+  FlowTraceTest() { ClearFlowTrace(); }
+};
+
+namespace {
+size_t CountEvents(const char* name) {
+  std::vector<FlowTraceEvent> events;
+  FlowTracer::Collect(&events, nullptr);
+  size_t count = 0;
+  for (const auto& e : events) {
+    if (std::string(e.name) == name) {
+      ++count;
+    }
+  }
+  return count;
+}
+}  // namespace
+
+TEST_F(FlowTraceTest, ParseCategories) {
+  uint32_t mask = 0;
+  ASSERT_OK(ParseFlowTraceCategories("write, compaction", &mask));
+  ASSERT_EQ(kFlowTraceWrite | kFlowTraceCompaction, mask);
+  ASSERT_OK(ParseFlowTraceCategories("all", &mask));
+  ASSERT_EQ(static_cast<uint32_t>(kFlowTraceAll), mask);
+  ASSERT_OK(ParseFlowTraceCategories("none", &mask));
+  ASSERT_EQ(0U, mask);
+  ASSERT_TRUE(ParseFlowTraceCategories("write,bogus", &mask).IsInvalidArgument());
+}
+
+TEST_F(FlowTraceTest, EnableIsReferenceCounted) {
+  ASSERT_FALSE(FlowTracer::Enabled(kFlowTraceRead));
+  FlowTracer::EnableCategories(kFlowTraceRead | kFlowTraceWrite);
+  FlowTracer::EnableCategories(kFlowTraceRead);
+  ASSERT_TRUE(FlowTracer::Enabled(kFlowTraceRead));
+  ASSERT_TRUE(FlowTracer::Enabled(kFlowTraceWrite));
+  ASSERT_FALSE(FlowTracer::Enabled(kFlowTraceFlush));
+
+  FlowTracer::DisableCategories(kFlowTraceRead | kFlowTraceWrite);
+  ASSERT_TRUE(FlowTracer::Enabled(kFlowTraceRead));
+  ASSERT_FALSE(FlowTracer::Enabled(kFlowTraceWrite));
+  FlowTracer::DisableCategories(kFlowTraceRead);
+  ASSERT_FALSE(FlowTracer::Enabled(kFlowTraceRead));
+}
+
+TEST_F(FlowTraceTest, ScopesRecordOnlyWhenEnabled) {
+  { FLOW_TRACE_SCOPE(kFlowTraceFlush, "Disabled"); }
+  FlowTracer::EnableCategories(kFlowTraceFlush);
+  { FLOW_TRACE_SCOPE(kFlowTraceFlush, "Enabled"); }
+  { FLOW_TRACE_SCOPE(kFlowTraceRead, "OtherCategory"); }
+  FLOW_TRACE_INSTANT(kFlowTraceFlush, "Instant");
+  FlowTracer::DisableCategories(kFlowTraceFlush);
+
+  ASSERT_EQ(0U, CountEvents("Disabled"));
+  ASSERT_EQ(1U, CountEvents("Enabled"));
+  ASSERT_EQ(0U, CountEvents("OtherCategory"));
+  ASSERT_EQ(1U, CountEvents("Instant"));
+}
+
+TEST_F(FlowTraceTest, ThreadsAndExport) {
+  FlowTracer::EnableCategories(kFlowTraceWrite);
+  const int kThreads = 4;
+  const size_t kPerThread = FlowTracer::kEventsPerThread + 100;
+  std::vector<std::thread> threads;
+  for (int t = 0; t < kThreads; ++t) {
+    threads.emplace_back([&]() {
+      for (size_t i = 0; i < kPerThread; ++i) {
+        FLOW_TRACE_SCOPE(kFlowTraceWrite, "Worker");
+      }
+    });
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+  FlowTracer::DisableCategories(kFlowTraceWrite);
+  // Threads have exited, but their (wrapped) buffers are kept.
+  ASSERT_EQ(kThreads * FlowTracer::kEventsPerThread, CountEvents("Worker"));
+
+  ClearFlowTrace();
+  FlowTracer::EnableCategories(kFlowTraceWrite);
+  { FLOW_TRACE_SCOPE(kFlowTraceWrite, "Quoted\"Name"); }
+  FlowTracer::DisableCategories(kFlowTraceWrite);
+
+  Env* env = Env::Default();
+  std::string path = test::PerThreadDBPath("flow_trace.json");
+  ASSERT_OK(ExportFlowTrace(env, path));
+  std::string contents;
+  ASSERT_OK(ReadFileToString(env, path, &contents));
+  ASSERT_EQ(0U, contents.find("{\"displayTimeUnit\":\"ns\",\"traceEvents\":["));
+  ASSERT_NE(std::string::npos, contents.find("\"name\":\"Quoted\\\"Name\""));
+  ASSERT_NE(std::string::npos, contents.find("\"cat\":\"write\",\"ph\":\"X\""));
+  ASSERT_NE(std::string::npos, contents.find("\"dur\":"));
+  ASSERT_EQ(std::string::npos, contents.find("Worker"));
+  ASSERT_OK(env->DeleteFile(path));
+}
+
+TEST_F(FlowTraceTest, ExitedThreadBuffersAreReclaimed) {
+  const size_t base = FlowTracer::TEST_NumThreadBuffers();
+  FlowTracer::EnableCategories(kFlowTraceFlush);
+  // Short-lived helper threads, one event each.
+  const size_t kThreads = 300;
+  for (size_t t = 0; t < kThreads; ++t) {
+    std::thread thread([]() { FLOW_TRACE_INSTANT(kFlowTraceFlush, "Helper"); });
+    thread.join();
+  }
+  FlowTracer::DisableCategories(kFlowTraceFlush);
+  // Only the buffers of the threads that exited last are kept.
+  ASSERT_EQ(256U, CountEvents("Helper"));
+  ASSERT_LE(FlowTracer::TEST_NumThreadBuffers(), base + 256);
+
+  ClearFlowTrace();
+  ASSERT_EQ(0U, CountEvents("Helper"));
+  ASSERT_LE(FlowTracer::TEST_NumThreadBuffers(), base);
+}
+
+TEST_F(FlowTraceTest, DBOptions) {
+  Options options;
+  options.create_if_missing = true;
+  options.flow_trace_categories = kFlowTraceRead;
+  std::string dbname = test::PerThreadDBPath("flow_trace_db");
+  ASSERT_OK(DestroyDB(dbname, options));
+  DB* db = nullptr;
+  ASSERT_OK(DB::Open(options, dbname, &db));
+  ASSERT_TRUE(FlowTracer::Enabled(kFlowTraceRead));
+  ASSERT_FALSE(FlowTracer::Enabled(kFlowTraceWrite));
+
+  ASSERT_OK(db->Put(WriteOptions(), "key", "value"));
+  std::string value;
+  ASSERT_OK(db->Get(ReadOptions(), "key", &value));
+  ASSERT_EQ(0U, CountEvents("DBImpl::WriteImpl"));
+  ASSERT_EQ(1U, CountEvents("DBImpl::GetImpl"));
+
+  ASSERT_OK(db->SetDBOptions({{"flow_trace_categories", "1"}}));
+  ASSERT_FALSE(FlowTracer::Enabled(kFlowTraceRead));
+  ASSERT_TRUE(FlowTracer::Enabled(kFlowTraceWrite));
+  ASSERT_OK(db->Put(WriteOptions(), "key", "value2"));
+  ASSERT_EQ(1U, CountEvents("DBImpl::WriteImpl"));
+
+  delete db;
+  ASSERT_FALSE(FlowTracer::Enabled(kFlowTraceAll));
+  ASSERT_OK(DestroyDB(dbname, options));
+}
+
+}  // namespace ROCKSDB_NAMESPACE
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,224 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include "monitoring/latency_timeline.h"
+
+#include <assert.h>
+#include <inttypes.h>
+#include <stdio.h>
+
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <queue>
+#include <utility>
+
+#include "port/port.h"
+#include "rocksdb/env.h"
+#include "util/coding.h"
+#include "util/math.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+constexpr int LogLinearHistogram::kSubBucketBits;
+constexpr size_t LogLinearHistogram::kSubBucketCount;
+constexpr size_t LogLinearHistogram::kBucketCount;
+
+LogLinearHistogram::LogLinearHistogram() : counts_(kBucketCount, 0) {
+  Clear();
+}
+
+size_t LogLinearHistogram::IndexForValue(uint64_t value) {
+  if (value < kSubBucketCount) {
+    return static_cast<size_t>(value);
+  }
+  int shift = FloorLog2(value) - (kSubBucketBits - 1);
+  size_t top = static_cast<size_t>(value >> shift);
+  return kSubBucketCount + (shift - 1) * (kSubBucketCount / 2) +
+         (top - kSubBucketCount / 2);
+}
+
+uint64_t LogLinearHistogram::ValueForIndex(size_t index) {
+  if (index < kSubBucketCount) {
+    return index;
+  }
+  size_t j = index - kSubBucketCount;
+  int shift = static_cast<int>(j / (kSubBucketCount / 2)) + 1;
+  uint64_t top = j % (kSubBucketCount / 2) + kSubBucketCount / 2;
+  // Wraps to the maximum value for the very last bucket.
+  return ((top + 1) << shift) - 1;
+}
+
+void LogLinearHistogram::Add(uint64_t value) {
+  counts_[IndexForValue(value)]++;
+  count_++;
+  sum_ += static_cast<double>(value);
+  min_ = std::min(min_, value);
+  max_ = std::max(max_, value);
+}
+
+void LogLinearHistogram::Merge(const LogLinearHistogram& other) {
+  for (size_t i = 0; i < kBucketCount; ++i) {
+    counts_[i] += other.counts_[i];
+  }
+  count_ += other.count_;
+  sum_ += other.sum_;
+  min_ = std::min(min_, other.min_);
+  max_ = std::max(max_, other.max_);
+}
+
+void LogLinearHistogram::Clear() {
+  std::fill(counts_.begin(), counts_.end(), 0);
+  count_ = 0;
+  min_ = port::kMaxUint64;
+  max_ = 0;
+  sum_ = 0;
+}
+
+double LogLinearHistogram::Average() const {
+  return count_ == 0 ? 0 : sum_ / static_cast<double>(count_);
+}
+
+uint64_t LogLinearHistogram::Percentile(double p) const {
+  if (count_ == 0) {
+    return 0;
+  }
+  if (p <= 0) {
+    return min_;
+  }
+  double threshold = static_cast<double>(count_) * p / 100.0;
+  uint64_t cumulative = 0;
+  for (size_t i = 0; i < kBucketCount; ++i) {
+    cumulative += counts_[i];
+    if (cumulative > 0 && static_cast<double>(cumulative) >= threshold) {
+      return std::max(std::min(ValueForIndex(i), max_), min_);
+    }
+  }
+  return max_;
+}
+
+std::string LogLinearHistogram::ToString() const {
+  char buf[256];
+  snprintf(buf, sizeof(buf),
+           "Count: %" PRIu64 " Average: %.1f Min: %" PRIu64 " P50: %" PRIu64
+           " P99: %" PRIu64 " P99.9: %" PRIu64 " P99.99: %" PRIu64
+           " Max: %" PRIu64,
+           count_, Average(), min(), Percentile(50), Percentile(99),
+           Percentile(99.9), Percentile(99.99), max_);
+  return buf;
+}
+
+LatencyTimeline::LatencyTimeline(uint32_t thread_id, size_t capacity)
+    : thread_id_(thread_id), capacity_(capacity), total_(0) {}
+
+void LatencyTimeline::Record(uint64_t start_nanos, uint64_t latency_nanos,
+                             uint8_t op_type, uint64_t bytes) {
+  assert(op_type < kMaxOpTypes);
+  auto& hist = histograms_[op_type];
+  if (!hist) {
+    hist.reset(new LogLinearHistogram());
+  }
+  hist->Add(latency_nanos);
+
+  if (capacity_ == 0) {
+    return;
+  }
+  uint64_t pos = total_ % capacity_;
+  if (pos / kRecordsPerChunk >= chunks_.size()) {
+    chunks_.emplace_back(new LatencyRecord[kRecordsPerChunk]);
+  }
+  LatencyRecord* rec = Slot(pos);
+  rec->start_nanos = start_nanos;
+  rec->latency_nanos = latency_nanos;
+  rec->bytes = static_cast<uint32_t>(
+      std::min<uint64_t>(bytes, std::numeric_limits<uint32_t>::max()));
+  rec->op_type = op_type;
+  total_++;
+}
+
+size_t LatencyTimeline::size() const {
+  return static_cast<size_t>(std::min<uint64_t>(total_, capacity_));
+}
+
+const LatencyRecord& LatencyTimeline::Get(size_t i) const {
+  assert(i < size());
+  uint64_t first = total_ > capacity_ ? total_ % capacity_ : 0;
+  uint64_t n = (first + i) % capacity_;
+  return chunks_[n / kRecordsPerChunk][n % kRecordsPerChunk];
+}
+
+Status WriteLatencyTimelines(
+    const std::vector<const LatencyTimeline*>& timelines,
+    const std::string& label, const std::vector<std::string>& op_names,
+    LatencyTimelineFormat format, bool write_header, WritableFile* file) {
+  const bool csv = format == LatencyTimelineFormat::kCsv;
+  std::string buf;
+  if (write_header) {
+    buf = csv ? "label,thread,start_nanos,op,latency_nanos,bytes\n"
+              : "RDBLTL01";
+  }
+  if (!csv) {
+    uint64_t total = 0;
+    for (const LatencyTimeline* t : timelines) {
+      total += t->size();
+    }
+    PutFixed32(&buf, static_cast<uint32_t>(label.size()));
+    buf.append(label);
+    PutFixed64(&buf, total);
+  }
+
+  // (start_nanos, (timeline index, record index)), earliest on top.
+  typedef std::pair<uint64_t, std::pair<size_t, size_t>> Cursor;
+  std::priority_queue<Cursor, std::vector<Cursor>, std::greater<Cursor>> heap;
+  for (size_t t = 0; t < timelines.size(); ++t) {
+    if (timelines[t]->size() > 0) {
+      heap.push({timelines[t]->Get(0).start_nanos, {t, 0}});
+    }
+  }
+
+  const size_t kFlushSize = 1 << 20;
+  char line[128];
+  while (!heap.empty()) {
+    Cursor top = heap.top();
+    heap.pop();
+    const LatencyTimeline* t = timelines[top.second.first];
+    size_t i = top.second.second;
+    const LatencyRecord& rec = t->Get(i);
+    if (csv) {
+      buf.append(label);
+      std::string op = rec.op_type < op_names.size()
+                           ? op_names[rec.op_type]
+                           : std::to_string(rec.op_type);
+      snprintf(line, sizeof(line),
+               ",%" PRIu32 ",%" PRIu64 ",%s,%" PRIu64 ",%" PRIu32 "\n",
+               t->thread_id(), rec.start_nanos, op.c_str(), rec.latency_nanos,
+               rec.bytes);
+      buf.append(line);
+    } else {
+      PutFixed64(&buf, rec.start_nanos);
+      PutFixed64(&buf, rec.latency_nanos);
+      PutFixed32(&buf, rec.bytes);
+      PutFixed32(&buf, t->thread_id());
+      buf.push_back(static_cast<char>(rec.op_type));
+    }
+    if (i + 1 < t->size()) {
+      heap.push({t->Get(i + 1).start_nanos, {top.second.first, i + 1}});
+    }
+    if (buf.size() >= kFlushSize) {
+      Status s = file->Append(buf);
+      if (!s.ok()) {
+        return s;
+      }
+      buf.clear();
+    }
+  }
+  Status s = file->Append(buf);
+  if (s.ok()) {
+    s = file->Flush();
+  }
+  return s;
+}
+
+}  // namespace ROCKSDB_NAMESPACE
@@ -0,0 +1,138 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+//
+// Per-operation latency capture for benchmarks. Every benchmark thread owns
+// one LatencyTimeline, so recording never touches shared state: no locks,
+// no atomics and no allocation on the hot path except when a new chunk of
+// records is needed. Timelines are combined only after the threads that
+// filled them have finished.
+
+#pragma once
+
+#include <stdint.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "rocksdb/rocksdb_namespace.h"
+#include "rocksdb/status.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+class WritableFile;
+
+// Histogram with log-linear buckets in the style of HdrHistogram: values
+// below 2^kSubBucketBits are counted exactly and larger values fall into
+// buckets whose width is at most 1/2^(kSubBucketBits-1) of their lower bound,
+// giving < 0.8% relative error over the full uint64_t range. Unlike
+// HistogramImpl it is not thread-safe, which keeps Add() to a couple of
+// instructions; use one instance per thread and Merge() afterwards.
+class LogLinearHistogram {
+ public:
+  static constexpr int kSubBucketBits = 8;
+  static constexpr size_t kSubBucketCount = size_t{1} << kSubBucketBits;
+  static constexpr size_t kBucketCount =
+      kSubBucketCount + (64 - kSubBucketBits) * (kSubBucketCount / 2);
+
+  LogLinearHistogram();
+
+  void Add(uint64_t value);
+  void Merge(const LogLinearHistogram& other);
+  void Clear();
+
+  uint64_t count() const { return count_; }
+  uint64_t min() const { return count_ == 0 ? 0 : min_; }
+  uint64_t max() const { return max_; }
+  double Average() const;
+  // Returns the smallest recorded bucket value such that at least p percent
+  // of the samples are less than or equal to it. REQUIRES: 0 <= p <= 100
+  uint64_t Percentile(double p) const;
+
+  std::string ToString() const;
+
+  static size_t IndexForValue(uint64_t value);
+  // Highest value that maps to bucket `index`.
+  static uint64_t ValueForIndex(size_t index);
+
+ private:
+  std::vector<uint64_t> counts_;
+  uint64_t count_;
+  uint64_t min_;
+  uint64_t max_;
+  double sum_;
+};
+
+struct LatencyRecord {
+  // Start of the operation, in SystemClock::NowNanos() time.
+  uint64_t start_nanos;
+  uint64_t latency_nanos;
+  uint32_t bytes;
+  uint8_t op_type;
+};
+
+// Single-writer record of every operation of one thread. Storage grows in
+// fixed-size chunks up to `capacity` records; after that the oldest records
+// are overwritten, so the buffer always holds the most recent part of the
+// run. The per-op-type histograms always cover every operation, including
+// overwritten ones.
+class LatencyTimeline {
+ public:
+  static constexpr size_t kMaxOpTypes = 32;
+  static constexpr size_t kRecordsPerChunk = size_t{1} << 16;
+
+  LatencyTimeline(uint32_t thread_id, size_t capacity);
+
+  LatencyTimeline(const LatencyTimeline&) = delete;
+  LatencyTimeline& operator=(const LatencyTimeline&) = delete;
+
+  // REQUIRES: op_type < kMaxOpTypes
+  void Record(uint64_t start_nanos, uint64_t latency_nanos, uint8_t op_type,
+              uint64_t bytes);
+
+  uint32_t thread_id() const { return thread_id_; }
+  // Number of records currently held.
+  size_t size() const;
+  // Number of records lost to wrap-around.
+  uint64_t overwritten() const { return total_ - size(); }
+  // The i-th oldest record held. REQUIRES: i < size()
+  const LatencyRecord& Get(size_t i) const;
+
+  // nullptr if no operation of this type was recorded.
+  const LogLinearHistogram* histogram(uint8_t op_type) const {
+    return histograms_[op_type].get();
+  }
+
+ private:
+  LatencyRecord* Slot(uint64_t n) {
+    return &chunks_[n / kRecordsPerChunk][n % kRecordsPerChunk];
+  }
+
+  const uint32_t thread_id_;
+  const size_t capacity_;
+  uint64_t total_;
+  std::vector<std::unique_ptr<LatencyRecord[]>> chunks_;
+  std::unique_ptr<LogLinearHistogram> histograms_[kMaxOpTypes];
+};
+
+enum class LatencyTimelineFormat : unsigned char {
+  // One "label,thread,start_nanos,op,latency_nanos,bytes" line per record.
+  kCsv,
+  // "RDBLTL01" magic followed, per call, by a length-prefixed label, the
+  // number of records, and fixed64 start, fixed64 latency, fixed32 bytes,
+  // fixed32 thread id and one op byte per record.
+  kBinary,
+};
+
+// Writes the records of all `timelines`, merged into start time order, to
+// `file`. `label` identifies the run (e.g. the benchmark name) and
+// `op_names[op]`, when present, replaces the numeric op type in CSV output.
+// A CSV header or the binary magic is written iff `write_header` is true.
+extern Status WriteLatencyTimelines(
+    const std::vector<const LatencyTimeline*>& timelines,
+    const std::string& label, const std::vector<std::string>& op_names,
+    LatencyTimelineFormat format, bool write_header, WritableFile* file);
+
+}  // namespace ROCKSDB_NAMESPACE
@@ -0,0 +1,142 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include "monitoring/latency_timeline.h"
+
+#include <string>
+#include <vector>
+
+#include "rocksdb/env.h"
+#include "test_util/testharness.h"
+#include "util/coding.h"
+#include "util/random.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+namespace {
+class StringFile : public WritableFile {
+ public:
+  using WritableFile::Append;
+  Status Append(const Slice& data) override {
+    contents_.append(data.data(), data.size());
+    return Status::OK();
+  }
+  Status Close() override { return Status::OK(); }
+  Status Flush() override { return Status::OK(); }
+  Status Sync() override { return Status::OK(); }
+
+  std::string contents_;
+};
+}  // namespace
+
+class LatencyTimelineTest : public testing::Test {};
+
+TEST_F(LatencyTimelineTest, BucketBoundaries) {
+  size_t last = 0;
+  for (uint64_t v : {uint64_t{0}, uint64_t{1}, uint64_t{127}, uint64_t{128},
+                     uint64_t{255}, uint64_t{256}, uint64_t{257},
+                     uint64_t{1000}, uint64_t{123456789},
+                     port::kMaxUint64 / 3, port::kMaxUint64}) {
+    size_t index = LogLinearHistogram::IndexForValue(v);
+    ASSERT_LT(index, LogLinearHistogram::kBucketCount);
+    ASSERT_GE(index, last);
+    last = index;
+    uint64_t upper = LogLinearHistogram::ValueForIndex(index);
+    ASSERT_GE(upper, v);
+    // Relative error below 1/128.
+    ASSERT_LE(upper - v, v / 128 + 1);
+    if (index + 1 < LogLinearHistogram::kBucketCount) {
+      ASSERT_EQ(index + 1, LogLinearHistogram::IndexForValue(upper + 1));
+    }
+  }
+  ASSERT_EQ(LogLinearHistogram::kBucketCount - 1,
+            LogLinearHistogram::IndexForValue(port::kMaxUint64));
+}
+
+TEST_F(LatencyTimelineTest, HistogramPercentilesAndMerge) {
+  LogLinearHistogram a, b;
+  for (uint64_t i = 1; i <= 1000; ++i) {
+    a.Add(i * 1000);
+  }
+  b.Add(10000000);
+  a.Merge(b);
+  ASSERT_EQ(1001U, a.count());
+  ASSERT_EQ(1000U, a.min());
+  ASSERT_EQ(10000000U, a.max());
+  uint64_t p50 = a.Percentile(50);
+  ASSERT_GE(p50, 500000U);
+  ASSERT_LE(p50, 510000U);
+  ASSERT_EQ(10000000U, a.Percentile(100));
+  ASSERT_EQ(1000U, a.Percentile(0));
+}
+
+TEST_F(LatencyTimelineTest, RingBufferKeepsNewest) {
+  const size_t kCapacity = LatencyTimeline::kRecordsPerChunk + 10;
+  LatencyTimeline timeline(3, kCapacity);
+  const uint64_t kTotal = 2 * kCapacity + 5;
+  for (uint64_t i = 0; i < kTotal; ++i) {
+    timeline.Record(i, i % 100, static_cast<uint8_t>(i % 2), 16);
+  }
+  ASSERT_EQ(kCapacity, timeline.size());
+  ASSERT_EQ(kTotal - kCapacity, timeline.overwritten());
+  for (size_t i = 0; i < timeline.size(); ++i) {
+    ASSERT_EQ(kTotal - kCapacity + i, timeline.Get(i).start_nanos);
+  }
+  ASSERT_EQ((kTotal + 1) / 2, timeline.histogram(0)->count());
+  ASSERT_EQ(kTotal / 2, timeline.histogram(1)->count());
+  ASSERT_EQ(nullptr, timeline.histogram(2));
+}
+
+TEST_F(LatencyTimelineTest, WriteMergesByStartTime) {
+  LatencyTimeline t0(0, 100), t1(1, 100);
+  t0.Record(10, 5, 0, 100);
+  t0.Record(30, 5, 1, 0);
+  t1.Record(20, 7, 0, 200);
+  std::vector<const LatencyTimeline*> timelines = {&t0, &t1};
+
+  StringFile csv;
+  ASSERT_OK(WriteLatencyTimelines(timelines, "bench", {"read", "write"},
+                                  LatencyTimelineFormat::kCsv, true, &csv));
+  ASSERT_EQ(
+      "label,thread,start_nanos,op,latency_nanos,bytes\n"
+      "bench,0,10,read,5,100\n"
+      "bench,1,20,read,7,200\n"
+      "bench,0,30,write,5,0\n",
+      csv.contents_);
+
+  StringFile bin;
+  ASSERT_OK(WriteLatencyTimelines(timelines, "b", {},
+                                  LatencyTimelineFormat::kBinary, true, &bin));
+  Slice in(bin.contents_);
+  ASSERT_TRUE(in.starts_with("RDBLTL01"));
+  in.remove_prefix(8);
+  uint32_t label_len;
+  ASSERT_TRUE(GetFixed32(&in, &label_len));
+  ASSERT_EQ(1U, label_len);
+  in.remove_prefix(label_len);
+  uint64_t count;
+  ASSERT_TRUE(GetFixed64(&in, &count));
+  ASSERT_EQ(3U, count);
+  uint64_t prev = 0;
+  for (uint64_t i = 0; i < count; ++i) {
+    uint64_t start, latency;
+    uint32_t bytes, thread;
+    ASSERT_TRUE(GetFixed64(&in, &start));
+    ASSERT_TRUE(GetFixed64(&in, &latency));
+    ASSERT_TRUE(GetFixed32(&in, &bytes));
+    ASSERT_TRUE(GetFixed32(&in, &thread));
+    in.remove_prefix(1);
+    ASSERT_GT(start, prev);
+    prev = start;
+  }
+  ASSERT_TRUE(in.empty());
+}
+
+}  // namespace ROCKSDB_NAMESPACE
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
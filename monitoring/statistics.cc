@@ -201,6 +201,16 @@ const std::vector<std::pair<Tickers, std::string>> TickersNameMap = {
      "rocksdb.error.handler.autoresume.retry.total.count"},
     {ERROR_HANDLER_AUTORESUME_SUCCESS_COUNT,
      "rocksdb.error.handler.autoresume.success.count"},
+    {WRITE_BUFFER_MANAGER_COST_AWARE_FLUSHES,
+     "rocksdb.write.buffer.manager.cost.aware.flushes"},
+    {WRITE_BUFFER_MANAGER_FLUSHES_NOT_OLDEST,
+     "rocksdb.write.buffer.manager.flushes.not.oldest"},
+    {WRITE_BUFFER_MANAGER_FLUSHES_DEFERRED,
+     "rocksdb.write.buffer.manager.flushes.deferred"},
+    {WRITE_BUFFER_MANAGER_COST_AWARE_FLUSH_BYTES,
+     "rocksdb.write.buffer.manager.cost.aware.flush.bytes"},
+    {WRITE_GROUP_LATENCY_LIMITED, "rocksdb.write.group.latency.limited"},
+    {WRITE_GROUP_LARGE_BATCH_ALONE, "rocksdb.write.group.large.batch.alone"},
 };
 
 const std::vector<std::pair<Histograms, std::string>> HistogramsNameMap = {
@@ -258,6 +268,8 @@ const std::vector<std::pair<Histograms, std::string>> HistogramsNameMap = {
     {NUM_SST_READ_PER_LEVEL, "rocksdb.num.sst.read.per.level"},
     {ERROR_HANDLER_AUTORESUME_RETRY_COUNT,
      "rocksdb.error.handler.autoresume.retry.count"},
+    {WRITE_GROUP_LATENCY_LIMIT_BYTES,
+     "rocksdb.write.group.latency.limit.bytes"},
 };
 
 std::shared_ptr<Statistics> CreateDBStatistics() {
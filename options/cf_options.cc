@@ -225,6 +225,14 @@ static std::unordered_map<std::string, OptionTypeInfo>
         {"filter_deletes",
          {0, OptionType::kBoolean, OptionVerificationType::kDeprecated,
           OptionTypeFlags::kMutable}},
+        {"flush_partitions",
+         {offsetof(struct MutableCFOptions, flush_partitions),
+          OptionType::kSizeT, OptionVerificationType::kNormal,
+          OptionTypeFlags::kMutable}},
+        {"in_memory_compaction",
+         {offsetof(struct MutableCFOptions, in_memory_compaction),
+          OptionType::kBoolean, OptionVerificationType::kNormal,
+          OptionTypeFlags::kMutable}},
         {"check_flush_compaction_key_order",
          {offsetof(struct MutableCFOptions, check_flush_compaction_key_order),
           OptionType::kBoolean, OptionVerificationType::kNormal,
@@ -301,6 +309,14 @@ static std::unordered_map<std::string, OptionTypeInfo>
          {offsetof(struct MutableCFOptions, memtable_huge_page_size),
           OptionType::kSizeT, OptionVerificationType::kNormal,
           OptionTypeFlags::kMutable}},
+        {"memtable_transparent_huge_pages",
+         {offsetof(struct MutableCFOptions, memtable_transparent_huge_pages),
+          OptionType::kBoolean, OptionVerificationType::kNormal,
+          OptionTypeFlags::kMutable}},
+        {"memtable_numa_aware",
+         {offsetof(struct MutableCFOptions, memtable_numa_aware),
+          OptionType::kBoolean, OptionVerificationType::kNormal,
+          OptionTypeFlags::kMutable}},
         {"memtable_prefix_bloom_huge_page_tlb_size",
          {0, OptionType::kSizeT, OptionVerificationType::kDeprecated,
           OptionTypeFlags::kMutable}},
@@ -922,6 +938,10 @@ void MutableCFOptions::Dump(Logger* log) const {
   ROCKS_LOG_INFO(log,
                  "                  memtable_huge_page_size: %" ROCKSDB_PRIszt,
                  memtable_huge_page_size);
+  ROCKS_LOG_INFO(log, "          memtable_transparent_huge_pages: %d",
+                 memtable_transparent_huge_pages);
+  ROCKS_LOG_INFO(log, "                      memtable_numa_aware: %d",
+                 memtable_numa_aware);
   ROCKS_LOG_INFO(log,
                  "                    max_successive_merges: %" ROCKSDB_PRIszt,
                  max_successive_merges);
@@ -973,6 +993,11 @@ void MutableCFOptions::Dump(Logger* log) const {
                  result.c_str());
   ROCKS_LOG_INFO(log, "        max_sequential_skip_in_iterations: %" PRIu64,
                  max_sequential_skip_in_iterations);
+  ROCKS_LOG_INFO(log,
+                 "                         flush_partitions: %" ROCKSDB_PRIszt,
+                 flush_partitions);
+  ROCKS_LOG_INFO(log, "                     in_memory_compaction: %d",
+                 in_memory_compaction);
   ROCKS_LOG_INFO(log, "         check_flush_compaction_key_order: %d",
                  check_flush_compaction_key_order);
   ROCKS_LOG_INFO(log, "                     paranoid_file_checks: %d",
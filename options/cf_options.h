@@ -13,11 +13,6 @@
 #include "rocksdb/options.h"
 #include "util/compression.h"
 
-#define DB_WRITE_FLOW 0
-#define DB_LVL_COMPACTION_FLOW 0
-#define DB_UNI_COMPACTION_FLOW 0
-#define DB_READ_FLOW 0
-
 namespace ROCKSDB_NAMESPACE {
 
 // ImmutableCFOptions is a data struct used by RocksDB internal. It contains a
@@ -116,6 +111,9 @@ struct MutableCFOptions {
             options.memtable_prefix_bloom_size_ratio),
         memtable_whole_key_filtering(options.memtable_whole_key_filtering),
         memtable_huge_page_size(options.memtable_huge_page_size),
+        memtable_transparent_huge_pages(
+            options.memtable_transparent_huge_pages),
+        memtable_numa_aware(options.memtable_numa_aware),
         max_successive_merges(options.max_successive_merges),
         inplace_update_num_locks(options.inplace_update_num_locks),
         prefix_extractor(options.prefix_extractor),
@@ -148,6 +146,8 @@ struct MutableCFOptions {
             options.blob_garbage_collection_age_cutoff),
         max_sequential_skip_in_iterations(
             options.max_sequential_skip_in_iterations),
+        flush_partitions(options.flush_partitions),
+        in_memory_compaction(options.in_memory_compaction),
         check_flush_compaction_key_order(
             options.check_flush_compaction_key_order),
         paranoid_file_checks(options.paranoid_file_checks),
@@ -169,6 +169,8 @@ struct MutableCFOptions {
         memtable_prefix_bloom_size_ratio(0),
         memtable_whole_key_filtering(false),
         memtable_huge_page_size(0),
+        memtable_transparent_huge_pages(false),
+        memtable_numa_aware(false),
         max_successive_merges(0),
         inplace_update_num_locks(0),
         prefix_extractor(nullptr),
@@ -193,6 +195,8 @@ struct MutableCFOptions {
         enable_blob_garbage_collection(false),
         blob_garbage_collection_age_cutoff(0.0),
         max_sequential_skip_in_iterations(0),
+        flush_partitions(1),
+        in_memory_compaction(false),
         check_flush_compaction_key_order(true),
         paranoid_file_checks(false),
         report_bg_io_stats(false),
@@ -227,6 +231,8 @@ struct MutableCFOptions {
   double memtable_prefix_bloom_size_ratio;
   bool memtable_whole_key_filtering;
   size_t memtable_huge_page_size;
+  bool memtable_transparent_huge_pages;
+  bool memtable_numa_aware;
   size_t max_successive_merges;
   size_t inplace_update_num_locks;
   std::shared_ptr<const SliceTransform> prefix_extractor;
@@ -259,6 +265,8 @@ struct MutableCFOptions {
 
   // Misc options
   uint64_t max_sequential_skip_in_iterations;
+  size_t flush_partitions;
+  bool in_memory_compaction;
   bool check_flush_compaction_key_order;
   bool paranoid_file_checks;
   bool report_bg_io_stats;
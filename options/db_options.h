@@ -46,6 +46,7 @@ struct ImmutableDBOptions {
   uint64_t WAL_ttl_seconds;
   uint64_t WAL_size_limit_MB;
   uint64_t max_write_batch_group_size_bytes;
+  uint64_t write_batch_group_latency_budget_micros;
   size_t manifest_preallocation_size;
   bool allow_mmap_reads;
   bool allow_mmap_writes;
@@ -62,15 +63,21 @@ struct ImmutableDBOptions {
   bool use_adaptive_mutex;
   std::vector<std::shared_ptr<EventListener>> listeners;
   bool enable_thread_tracking;
+  bool predictive_write_stall_control;
   bool enable_pipelined_write;
+  bool pipelined_wal_sync;
   bool unordered_write;
+  int wal_streams;
   bool allow_concurrent_memtable_write;
+  uint32_t max_write_batch_insert_threads;
+  size_t zero_copy_put_min_value_size;
   bool enable_write_thread_adaptive_yield;
   uint64_t write_thread_max_yield_usec;
   uint64_t write_thread_slow_yield_usec;
   bool skip_stats_update_on_db_open;
   bool skip_checking_sst_file_sizes_on_db_open;
   WALRecoveryMode wal_recovery_mode;
+  int wal_recovery_threads;
   bool allow_2pc;
   std::shared_ptr<Cache> row_cache;
 #ifndef ROCKSDB_LITE
@@ -83,6 +90,7 @@ struct ImmutableDBOptions {
   bool preserve_deletes;
   bool two_write_queues;
   bool manual_wal_flush;
+  CompressionType wal_compression;
   bool atomic_flush;
   bool avoid_unnecessary_blocking_io;
   bool persist_stats_to_disk;
@@ -129,6 +137,7 @@ struct MutableDBOptions {
   bool strict_bytes_per_sync;
   size_t compaction_readahead_size;
   int max_background_flushes;
+  uint32_t flow_trace_categories;
 };
 
 #ifndef ROCKSDB_LITE
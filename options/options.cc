@@ -52,6 +52,8 @@ AdvancedColumnFamilyOptions::AdvancedColumnFamilyOptions(const Options& options)
           options.memtable_prefix_bloom_size_ratio),
       memtable_whole_key_filtering(options.memtable_whole_key_filtering),
       memtable_huge_page_size(options.memtable_huge_page_size),
+      memtable_transparent_huge_pages(options.memtable_transparent_huge_pages),
+      memtable_numa_aware(options.memtable_numa_aware),
       memtable_insert_with_hint_prefix_extractor(
           options.memtable_insert_with_hint_prefix_extractor),
       bloom_locality(options.bloom_locality),
@@ -83,6 +85,8 @@ AdvancedColumnFamilyOptions::AdvancedColumnFamilyOptions(const Options& options)
           options.table_properties_collector_factories),
       max_successive_merges(options.max_successive_merges),
       optimize_filters_for_hits(options.optimize_filters_for_hits),
+      flush_partitions(options.flush_partitions),
+      in_memory_compaction(options.in_memory_compaction),
       paranoid_file_checks(options.paranoid_file_checks),
       force_consistency_checks(options.force_consistency_checks),
       report_bg_io_stats(options.report_bg_io_stats),
@@ -363,6 +367,10 @@ void ColumnFamilyOptions::Dump(Logger* log) const {
 
     ROCKS_LOG_HEADER(log, "  Options.memtable_huge_page_size: %" ROCKSDB_PRIszt,
                      memtable_huge_page_size);
+    ROCKS_LOG_HEADER(log, "  Options.memtable_transparent_huge_pages: %d",
+                     memtable_transparent_huge_pages);
+    ROCKS_LOG_HEADER(log, "  Options.memtable_numa_aware: %d",
+                     memtable_numa_aware);
     ROCKS_LOG_HEADER(log,
                      "                          Options.bloom_locality: %d",
                      bloom_locality);
@@ -371,6 +379,12 @@ void ColumnFamilyOptions::Dump(Logger* log) const {
         log,
         "                   Options.max_successive_merges: %" ROCKSDB_PRIszt,
         max_successive_merges);
+    ROCKS_LOG_HEADER(
+        log, "                        Options.flush_partitions: %" ROCKSDB_PRIszt,
+        flush_partitions);
+    ROCKS_LOG_HEADER(log,
+                     "                    Options.in_memory_compaction: %d",
+                     in_memory_compaction);
     ROCKS_LOG_HEADER(log,
                      "               Options.optimize_filters_for_hits: %d",
                      optimize_filters_for_hits);
@@ -644,7 +658,8 @@ ReadOptions::ReadOptions()
       iter_start_ts(nullptr),
       deadline(std::chrono::microseconds::zero()),
       io_timeout(std::chrono::microseconds::zero()),
-      value_size_soft_limit(std::numeric_limits<uint64_t>::max()) {}
+      value_size_soft_limit(std::numeric_limits<uint64_t>::max()),
+      optimize_multiget_for_io(false) {}
 
 ReadOptions::ReadOptions(bool cksum, bool cache)
     : snapshot(nullptr),
@@ -668,6 +683,7 @@ ReadOptions::ReadOptions(bool cksum, bool cache)
       iter_start_ts(nullptr),
       deadline(std::chrono::microseconds::zero()),
       io_timeout(std::chrono::microseconds::zero()),
-      value_size_soft_limit(std::numeric_limits<uint64_t>::max()) {}
+      value_size_soft_limit(std::numeric_limits<uint64_t>::max()),
+      optimize_multiget_for_io(false) {}
 
 }  // namespace ROCKSDB_NAMESPACE
@@ -95,6 +95,7 @@ DBOptions BuildDBOptions(const ImmutableDBOptions& immutable_db_options,
   options.strict_bytes_per_sync = mutable_db_options.strict_bytes_per_sync;
   options.max_subcompactions = mutable_db_options.max_subcompactions;
   options.max_background_flushes = mutable_db_options.max_background_flushes;
+  options.flow_trace_categories = mutable_db_options.flow_trace_categories;
   options.max_log_file_size = immutable_db_options.max_log_file_size;
   options.log_file_time_to_roll = immutable_db_options.log_file_time_to_roll;
   options.keep_log_file_num = immutable_db_options.keep_log_file_num;
@@ -135,15 +136,25 @@ DBOptions BuildDBOptions(const ImmutableDBOptions& immutable_db_options,
   options.use_adaptive_mutex = immutable_db_options.use_adaptive_mutex;
   options.listeners = immutable_db_options.listeners;
   options.enable_thread_tracking = immutable_db_options.enable_thread_tracking;
+  options.predictive_write_stall_control =
+      immutable_db_options.predictive_write_stall_control;
   options.delayed_write_rate = mutable_db_options.delayed_write_rate;
   options.enable_pipelined_write = immutable_db_options.enable_pipelined_write;
+  options.pipelined_wal_sync = immutable_db_options.pipelined_wal_sync;
   options.unordered_write = immutable_db_options.unordered_write;
+  options.wal_streams = immutable_db_options.wal_streams;
   options.allow_concurrent_memtable_write =
       immutable_db_options.allow_concurrent_memtable_write;
+  options.max_write_batch_insert_threads =
+      immutable_db_options.max_write_batch_insert_threads;
+  options.zero_copy_put_min_value_size =
+      immutable_db_options.zero_copy_put_min_value_size;
   options.enable_write_thread_adaptive_yield =
       immutable_db_options.enable_write_thread_adaptive_yield;
   options.max_write_batch_group_size_bytes =
       immutable_db_options.max_write_batch_group_size_bytes;
+  options.write_batch_group_latency_budget_micros =
+      immutable_db_options.write_batch_group_latency_budget_micros;
   options.write_thread_max_yield_usec =
       immutable_db_options.write_thread_max_yield_usec;
   options.write_thread_slow_yield_usec =
@@ -153,6 +164,7 @@ DBOptions BuildDBOptions(const ImmutableDBOptions& immutable_db_options,
   options.skip_checking_sst_file_sizes_on_db_open =
       immutable_db_options.skip_checking_sst_file_sizes_on_db_open;
   options.wal_recovery_mode = immutable_db_options.wal_recovery_mode;
+  options.wal_recovery_threads = immutable_db_options.wal_recovery_threads;
   options.allow_2pc = immutable_db_options.allow_2pc;
   options.row_cache = immutable_db_options.row_cache;
 #ifndef ROCKSDB_LITE
@@ -171,6 +183,7 @@ DBOptions BuildDBOptions(const ImmutableDBOptions& immutable_db_options,
       immutable_db_options.preserve_deletes;
   options.two_write_queues = immutable_db_options.two_write_queues;
   options.manual_wal_flush = immutable_db_options.manual_wal_flush;
+  options.wal_compression = immutable_db_options.wal_compression;
   options.atomic_flush = immutable_db_options.atomic_flush;
   options.avoid_unnecessary_blocking_io =
       immutable_db_options.avoid_unnecessary_blocking_io;
@@ -209,6 +222,9 @@ void UpdateColumnFamilyOptions(const MutableCFOptions& moptions,
       moptions.memtable_prefix_bloom_size_ratio;
   cf_opts->memtable_whole_key_filtering = moptions.memtable_whole_key_filtering;
   cf_opts->memtable_huge_page_size = moptions.memtable_huge_page_size;
+  cf_opts->memtable_transparent_huge_pages =
+      moptions.memtable_transparent_huge_pages;
+  cf_opts->memtable_numa_aware = moptions.memtable_numa_aware;
   cf_opts->max_successive_merges = moptions.max_successive_merges;
   cf_opts->inplace_update_num_locks = moptions.inplace_update_num_locks;
   cf_opts->prefix_extractor = moptions.prefix_extractor;
@@ -254,6 +270,8 @@ void UpdateColumnFamilyOptions(const MutableCFOptions& moptions,
   // Misc options
   cf_opts->max_sequential_skip_in_iterations =
       moptions.max_sequential_skip_in_iterations;
+  cf_opts->flush_partitions = moptions.flush_partitions;
+  cf_opts->in_memory_compaction = moptions.in_memory_compaction;
   cf_opts->check_flush_compaction_key_order =
       moptions.check_flush_compaction_key_order;
   cf_opts->paranoid_file_checks = moptions.paranoid_file_checks;
@@ -265,6 +265,9 @@ TEST_F(OptionsSettableTest, DBOptionsAllFieldsSettable) {
                              "WAL_ttl_seconds=4295008036;"
                              "WAL_size_limit_MB=4295036161;"
                              "max_write_batch_group_size_bytes=1048576;"
+                             "write_batch_group_latency_budget_micros=200;"
+                             "max_write_batch_insert_threads=4;"
+                             "zero_copy_put_min_value_size=65536;"
                              "wal_dir=path/to/wal_dir;"
                              "db_write_buffer_size=2587;"
                              "max_subcompactions=64330;"
@@ -293,10 +296,12 @@ TEST_F(OptionsSettableTest, DBOptionsAllFieldsSettable) {
                              "bytes_per_sync=4295013613;"
                              "strict_bytes_per_sync=true;"
                              "enable_thread_tracking=false;"
+                             "predictive_write_stall_control=true;"
                              "recycle_log_file_num=0;"
                              "create_missing_column_families=true;"
                              "log_file_time_to_roll=3097;"
                              "max_background_flushes=35;"
+                             "flow_trace_categories=5;"
                              "create_if_missing=false;"
                              "error_if_exists=true;"
                              "delayed_write_rate=4294976214;"
@@ -315,9 +320,12 @@ TEST_F(OptionsSettableTest, DBOptionsAllFieldsSettable) {
                              "advise_random_on_open=true;"
                              "fail_if_options_file_error=false;"
                              "enable_pipelined_write=false;"
+                             "pipelined_wal_sync=false;"
                              "unordered_write=false;"
+                             "wal_streams=2;"
                              "allow_concurrent_memtable_write=true;"
                              "wal_recovery_mode=kPointInTimeRecovery;"
+                             "wal_recovery_threads=4;"
                              "enable_write_thread_adaptive_yield=true;"
                              "write_thread_slow_yield_usec=5;"
                              "write_thread_max_yield_usec=1000;"
@@ -332,6 +340,7 @@ TEST_F(OptionsSettableTest, DBOptionsAllFieldsSettable) {
                              "concurrent_prepare=false;"
                              "two_write_queues=false;"
                              "manual_wal_flush=false;"
+                             "wal_compression=kNoCompression;"
                              "seq_per_batch=false;"
                              "atomic_flush=false;"
                              "avoid_unnecessary_blocking_io=false;"
@@ -466,6 +475,8 @@ TEST_F(OptionsSettableTest, ColumnFamilyOptionsAllFieldsSettable) {
       "bloom_locality=8016;"
       "target_file_size_base=4294976376;"
       "memtable_huge_page_size=2557;"
+      "memtable_transparent_huge_pages=true;"
+      "memtable_numa_aware=true;"
       "max_successive_merges=5497;"
       "max_sequential_skip_in_iterations=4294971408;"
       "arena_block_size=1893;"
@@ -493,6 +504,8 @@ TEST_F(OptionsSettableTest, ColumnFamilyOptionsAllFieldsSettable) {
       "memtable_prefix_bloom_size_ratio=0.4642;"
       "memtable_whole_key_filtering=true;"
       "memtable_insert_with_hint_prefix_extractor=rocksdb.CappedPrefix.13;"
+      "flush_partitions=5;"
+      "in_memory_compaction=true;"
       "check_flush_compaction_key_order=false;"
       "paranoid_file_checks=true;"
       "force_consistency_checks=true;"
@@ -148,6 +148,7 @@ TEST_F(OptionsTest, GetOptionsFromMapTest) {
       {"bytes_per_sync", "47"},
       {"wal_bytes_per_sync", "48"},
       {"strict_bytes_per_sync", "true"},
+      {"flow_trace_categories", "6"},
   };
 
   ColumnFamilyOptions base_cf_opt;
@@ -306,6 +307,7 @@ TEST_F(OptionsTest, GetOptionsFromMapTest) {
   ASSERT_EQ(new_db_opt.bytes_per_sync, static_cast<uint64_t>(47));
   ASSERT_EQ(new_db_opt.wal_bytes_per_sync, static_cast<uint64_t>(48));
   ASSERT_EQ(new_db_opt.strict_bytes_per_sync, true);
+  ASSERT_EQ(new_db_opt.flow_trace_categories, 6U);
 
   db_options_map["max_open_files"] = "hello";
   Status s =
@@ -1097,6 +1099,13 @@ TEST_F(OptionsTest, GetMemTableRepFactoryFromString) {
   ASSERT_OK(GetMemTableRepFactoryFromString("skip_list", &new_mem_factory));
   ASSERT_OK(GetMemTableRepFactoryFromString("skip_list:16", &new_mem_factory));
   ASSERT_EQ(std::string(new_mem_factory->Name()), "SkipListFactory");
+  ASSERT_FALSE(new_mem_factory->RequiresBytewiseComparator());
+  ASSERT_OK(GetMemTableRepFactoryFromString("skip_list:16:true",
+                                            &new_mem_factory));
+  ASSERT_EQ(std::string(new_mem_factory->Name()), "SkipListFactory");
+  ASSERT_TRUE(new_mem_factory->RequiresBytewiseComparator());
+  ASSERT_NOK(GetMemTableRepFactoryFromString("skip_list:16:true:invalid_opt",
+                                             &new_mem_factory));
   ASSERT_NOK(GetMemTableRepFactoryFromString("skip_list:16:invalid_opt",
                                              &new_mem_factory));
 
@@ -1115,8 +1124,32 @@ TEST_F(OptionsTest, GetMemTableRepFactoryFromString) {
   ASSERT_NOK(GetMemTableRepFactoryFromString("hash_linkedlist:1000:invalid_opt",
                                              &new_mem_factory));
 
+  ASSERT_OK(GetMemTableRepFactoryFromString("hash_indexed_skip_list",
+                                            &new_mem_factory));
+  ASSERT_OK(GetMemTableRepFactoryFromString("hash_indexed_skip_list:1000",
+                                            &new_mem_factory));
+  ASSERT_EQ(std::string(new_mem_factory->Name()),
+            "HashIndexedSkipListRepFactory");
+  ASSERT_TRUE(new_mem_factory->IsInsertConcurrentlySupported());
+  ASSERT_TRUE(new_mem_factory->RequiresBytewiseComparator());
+  ASSERT_NOK(GetMemTableRepFactoryFromString(
+      "hash_indexed_skip_list:1000:invalid_opt", &new_mem_factory));
+
+  ASSERT_OK(GetMemTableRepFactoryFromString("art", &new_mem_factory));
+  ASSERT_EQ(std::string(new_mem_factory->Name()), "ArtRepFactory");
+  ASSERT_TRUE(new_mem_factory->IsInsertConcurrentlySupported());
+  ASSERT_TRUE(new_mem_factory->RequiresBytewiseComparator());
+  ASSERT_OK(GetMemTableRepFactoryFromString("art:false", &new_mem_factory));
+  ASSERT_FALSE(new_mem_factory->IsInsertConcurrentlySupported());
+  ASSERT_NOK(
+      GetMemTableRepFactoryFromString("art:true:invalid_opt", &new_mem_factory));
+
   ASSERT_OK(GetMemTableRepFactoryFromString("vector", &new_mem_factory));
   ASSERT_OK(GetMemTableRepFactoryFromString("vector:1024", &new_mem_factory));
+  ASSERT_OK(GetMemTableRepFactoryFromString("vector:1024:4", &new_mem_factory));
+  ASSERT_EQ(std::string(new_mem_factory->Name()), "VectorRepFactory");
+  ASSERT_NOK(GetMemTableRepFactoryFromString("vector:1024:4:invalid_opt",
+                                             &new_mem_factory));
   ASSERT_EQ(std::string(new_mem_factory->Name()), "VectorRepFactory");
   ASSERT_NOK(GetMemTableRepFactoryFromString("vector:1024:invalid_opt",
                                              &new_mem_factory));
@@ -1973,6 +2006,7 @@ TEST_F(OptionsOldApiTest, GetOptionsFromMapTest) {
       {"bytes_per_sync", "47"},
       {"wal_bytes_per_sync", "48"},
       {"strict_bytes_per_sync", "true"},
+      {"flow_trace_categories", "6"},
   };
 
   ColumnFamilyOptions base_cf_opt;
@@ -2125,6 +2159,7 @@ TEST_F(OptionsOldApiTest, GetOptionsFromMapTest) {
   ASSERT_EQ(new_db_opt.bytes_per_sync, static_cast<uint64_t>(47));
   ASSERT_EQ(new_db_opt.wal_bytes_per_sync, static_cast<uint64_t>(48));
   ASSERT_EQ(new_db_opt.strict_bytes_per_sync, true);
+  ASSERT_EQ(new_db_opt.flow_trace_categories, 6U);
 
   db_options_map["max_open_files"] = "hello";
   ASSERT_NOK(GetDBOptionsFromMap(base_db_opt, db_options_map, &new_db_opt));
@@ -111,14 +111,19 @@ LIB_SOURCES =                                                   \
   memory/jemalloc_nodump_allocator.cc                           \
   memory/memkind_kmem_allocator.cc                              \
   memtable/alloc_tracker.cc                                     \
+  memtable/art_rep.cc                                           \
   memtable/hash_linklist_rep.cc                                 \
+  memtable/hash_indexed_skiplist_rep.cc                         \
   memtable/hash_skiplist_rep.cc                                 \
   memtable/skiplistrep.cc                                       \
   memtable/vectorrep.cc                                         \
   memtable/write_buffer_manager.cc                              \
+  monitoring/background_event_timeline.cc                       \
+  monitoring/flow_trace.cc                                      \
   monitoring/histogram.cc                                       \
   monitoring/histogram_windowing.cc                             \
   monitoring/in_memory_stats_history.cc                         \
+  monitoring/latency_timeline.cc                                \
   monitoring/instrumented_mutex.cc                              \
   monitoring/iostats_context.cc                                 \
   monitoring/perf_context.cc                                    \
@@ -210,6 +215,7 @@ LIB_SOURCES =                                                   \
   util/crc32c_arm64.cc                                          \
   util/dynamic_bloom.cc                                         \
   util/hash.cc                                                  \
+  util/key_distribution.cc                                      \
   util/murmurhash.cc                                            \
   util/random.cc                                                \
   util/rate_limiter.cc                                          \
@@ -221,14 +227,13 @@ LIB_SOURCES =                                                   \
   util/thread_local.cc                                          \
   util/threadpool_imp.cc                                        \
   util/xxhash.cc                                                \
-  util/zipf.cc                                                  \
-  util/latest-generator.cc                                      \
   utilities/backupable/backupable_db.cc                         \
   utilities/blob_db/blob_compaction_filter.cc                   \
   utilities/blob_db/blob_db.cc                                  \
   utilities/blob_db/blob_db_impl.cc                             \
   utilities/blob_db/blob_db_impl_filesnapshot.cc                \
   utilities/blob_db/blob_file.cc                                \
+  utilities/bulk_load/bulk_load_session.cc                      \
   utilities/cassandra/cassandra_compaction_filter.cc            \
   utilities/cassandra/format.cc                                 \
   utilities/cassandra/merge_operator.cc                         \
@@ -483,8 +488,11 @@ TEST_MAIN_SOURCES =                                                     \
   memtable/inlineskiplist_test.cc                                       \
   memtable/skiplist_test.cc                                             \
   memtable/write_buffer_manager_test.cc                                 \
+  monitoring/background_event_timeline_test.cc                          \
+  monitoring/flow_trace_test.cc                                         \
   monitoring/histogram_test.cc                                          \
   monitoring/iostats_context_test.cc                                    \
+  monitoring/latency_timeline_test.cc                                   \
   monitoring/statistics_test.cc                                         \
   monitoring/stats_history_test.cc                                      \
   options/configurable_test.cc                                          \
@@ -523,6 +531,7 @@ TEST_MAIN_SOURCES =                                                     \
   util/file_reader_writer_test.cc                                       \
   util/hash_test.cc                                                     \
   util/heap_test.cc                                                     \
+  util/key_distribution_test.cc                                         \
   util/random_test.cc                                                   \
   util/rate_limiter_test.cc                                             \
   util/repeatable_thread_test.cc                                        \
@@ -536,6 +545,7 @@ TEST_MAIN_SOURCES =                                                     \
   util/work_queue_test.cc                                               \
   utilities/backupable/backupable_db_test.cc                            \
   utilities/blob_db/blob_db_test.cc                                     \
+  utilities/bulk_load/bulk_load_session_test.cc                         \
   utilities/cassandra/cassandra_format_test.cc                          \
   utilities/cassandra/cassandra_functional_test.cc                      \
   utilities/cassandra/cassandra_row_merge_test.cc                       \
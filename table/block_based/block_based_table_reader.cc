@@ -22,6 +22,7 @@
 #include "file/file_prefetch_buffer.h"
 #include "file/file_util.h"
 #include "file/random_access_file_reader.h"
+#include "monitoring/flow_trace.h"
 #include "monitoring/perf_context_imp.h"
 #include "options/options_helper.h"
 #include "port/lang.h"
@@ -68,10 +69,6 @@
 #include <chrono>
 typedef std::chrono::high_resolution_clock Clock;
 
-// Control Print Flow - Signal.Jin
-int block_get_flag = 1;
-int retrieve_get_flag = 0;
-
 namespace ROCKSDB_NAMESPACE {
 
 extern const uint64_t kBlockBasedTableMagicNumber;
@@ -1377,9 +1374,7 @@ InternalIteratorBase<IndexValue>* BlockBasedTable::NewIndexIterator(
   // We don't return pinned data from index blocks, so no need
   // to set `block_contents_pinned`.
 
-  if (DB_READ_FLOW == 1 && block_get_flag == 1) {
-    fprintf(stdout, "  [11]        \t|       NewIndexIterator()    \t\t| block_based_table_reader.cc (line 1375)\n"); // Signal.Jin
-  }
+  FLOW_TRACE_SCOPE(kFlowTraceRead, "BlockBasedTable::NewIndexIterator");
 
   return rep_->index_reader->NewIterator(read_options, disable_prefix_seek,
                                          input_iter, get_context,
@@ -1887,27 +1882,7 @@ Status BlockBasedTable::RetrieveBlock(
   assert(block_entry);
   assert(block_entry->IsEmpty());
 
-  if (DB_READ_FLOW == 1 && retrieve_get_flag == 1) {
-    fprintf(stdout, "  [13]        \t|        RetrieveBlock()    \t\t| block_based_table_reader.cc (line 1881)\n"); // Signal.Jin
-    fprintf(stdout, "  [14]        \t|       }\n");
-    fprintf(stdout, "  [15]        \t|      }\n");
-    fprintf(stdout, "  [16]        \t|     }\n");
-    fprintf(stdout, "  [17]        \t|    }\n");
-    fprintf(stdout, "  [18]        \t|   }\n");
-    fprintf(stdout, "  [19]        \t|  }\n");
-    fprintf(stdout, "  [20]        \t| } /*The process of executing the get operation once*/\n");
-    printf("#\n# Function Explanation (Read(Get) Flow)\n");
-    printf("# ReadRandom() : Functions performed via readrandom option in db_bench\n");
-    printf("# memtable.cc Get() : If the requested key is in the memtable, read key and value\n");
-    printf("# memtable_list.cc GetListFrom() : If the requested key is in the immutable memtable, read key and value\n");
-    printf("# version_set.cc Get() : If the requested key is in the storage(sstable), read key and value\n");
-    printf("# GetNextFile() : Sequentially fetching sstable information\n");
-    printf("# FullFilterKeyMayMatch() : Check if the requested key exists using a bloom filter\n");
-    printf("# NewIndexIterator() : Find out where the key is inside sstable through index block\n");
-    printf("# NewDataBlockIterator() : Find the data block inside sstable using offset obtained through index block\n");
-    printf("# RetrieveBlock() : Read the actual data block and load it into the cache if neccessary\n");
-    retrieve_get_flag = 0;
-  }
+  FLOW_TRACE_SCOPE(kFlowTraceRead, "BlockBasedTable::RetrieveBlock");
 
   Status s;
   if (use_cache) {
@@ -2219,9 +2194,7 @@ bool BlockBasedTable::FullFilterKeyMayMatch(
     const SliceTransform* prefix_extractor, GetContext* get_context,
     BlockCacheLookupContext* lookup_context) const {
 
-  if (DB_READ_FLOW == 1 && block_get_flag == 1) {
-    fprintf(stdout, "  [10]        \t|       FullFilterKeyMayMatch()    \t| block_based_table_reader.cc (line 2186)\n"); // Signal.Jin
-  }
+  FLOW_TRACE_SCOPE(kFlowTraceRead, "BlockBasedTable::FullFilterKeyMayMatch");
 
   if (filter == nullptr || filter->IsBlockBased()) {
     //printf("Return Here?\n"); // Yes - Signal.Jin
@@ -2305,9 +2278,7 @@ Status BlockBasedTable::Get(const ReadOptions& read_options, const Slice& key,
   Status s;
   const bool no_io = read_options.read_tier == kBlockCacheTier;
   
-  if (DB_READ_FLOW == 1 && block_get_flag == 1) {
-    fprintf(stdout, "  [9]        \t|      Get() {    \t\t\t| block_based_table_reader.cc (line 2265)\n"); // Signal.Jin
-  }
+  FLOW_TRACE_SCOPE(kFlowTraceRead, "BlockBasedTable::Get");
 
   FilterBlockReader* const filter =
       !skip_filters ? rep_->filter.get() : nullptr;
@@ -2393,16 +2364,15 @@ Status BlockBasedTable::Get(const ReadOptions& read_options, const Slice& key,
       DataBlockIter biter;
       uint64_t referenced_data_size = 0;
       
-      if (DB_READ_FLOW == 1 && block_get_flag == 1) {
-        fprintf(stdout, "  [12]        \t|       NewDataBlockIterator() {    \t| block_based_table_reader.cc (line 2361)\n"); // Signal.Jin
-        block_get_flag = 0;
-        retrieve_get_flag = 1;
-      }
       //printf("NewDataBlockIterator\n"); // Signal.Jin
-      NewDataBlockIterator<DataBlockIter>(
-          read_options, v.handle, &biter, BlockType::kData, get_context,
-          &lookup_data_block_context,
-          /*s=*/Status(), /*prefetch_buffer*/ nullptr);
+      {
+        FLOW_TRACE_SCOPE(kFlowTraceRead,
+                         "BlockBasedTable::NewDataBlockIterator");
+        NewDataBlockIterator<DataBlockIter>(
+            read_options, v.handle, &biter, BlockType::kData, get_context,
+            &lookup_data_block_context,
+            /*s=*/Status(), /*prefetch_buffer*/ nullptr);
+      }
 
       if (no_io && biter.status().IsIncomplete()) {
         // couldn't get block from block_cache
@@ -2849,6 +2819,100 @@ void BlockBasedTable::MultiGet(const ReadOptions& read_options,
   }
 }
 
+void BlockBasedTable::MultiGetPrefetch(const ReadOptions& read_options,
+                                       const MultiGetRange* mget_range,
+                                       const SliceTransform* prefix_extractor,
+                                       bool skip_filters) {
+  // Prefetch() does not read into the user buffers of direct reads.
+  if (mget_range->empty() || rep_->file->use_direct_io() ||
+      read_options.read_tier == kBlockCacheTier) {
+    return;
+  }
+  // The index and filter lookups are repeated by MultiGet(), which counts
+  // them in the statistics. They are counted in a scratch GetContext here,
+  // which is never reported, instead of in the statistics directly. The data
+  // block lookups bypass the metrics.
+  GetContext scratch_get_context(
+      rep_->internal_comparator.user_comparator(), /*merge_operator=*/nullptr,
+      /*logger=*/nullptr, /*statistics=*/nullptr, GetContext::kNotFound,
+      Slice(), /*value=*/nullptr, /*value_found=*/nullptr,
+      /*merge_context=*/nullptr, /*do_merge=*/true,
+      /*max_covering_tombstone_seq=*/nullptr, /*clock=*/nullptr);
+  FilterBlockReader* const filter =
+      !skip_filters && rep_->whole_key_filtering ? rep_->filter.get()
+                                                 : nullptr;
+  BlockCacheLookupContext lookup_context{TableReaderCaller::kUserMultiGet};
+  bool need_upper_bound_check = false;
+  if (rep_->index_type == BlockBasedTableOptions::kHashSearch) {
+    need_upper_bound_check = PrefixExtractorChanged(
+        rep_->table_properties.get(), prefix_extractor);
+  }
+  IndexBlockIter iiter_on_stack;
+  auto iiter = NewIndexIterator(read_options, need_upper_bound_check,
+                                &iiter_on_stack, &scratch_get_context,
+                                &lookup_context);
+  std::unique_ptr<InternalIteratorBase<IndexValue>> iiter_unique_ptr;
+  if (iiter != &iiter_on_stack) {
+    iiter_unique_ptr.reset(iiter);
+  }
+  Cache* const block_cache = rep_->table_options.block_cache.get();
+  size_t ts_sz = rep_->internal_comparator.user_comparator()->timestamp_size();
+
+  // Adjacent blocks are prefetched together.
+  uint64_t prefetch_offset = 0;
+  uint64_t prefetch_end = 0;
+  auto flush_prefetch = [&]() {
+    if (prefetch_end > prefetch_offset) {
+      TEST_SYNC_POINT_CALLBACK("BlockBasedTable::MultiGetPrefetch:Prefetch",
+                               &prefetch_offset);
+      rep_->file
+          ->Prefetch(prefetch_offset,
+                     static_cast<size_t>(prefetch_end - prefetch_offset))
+          .PermitUncheckedError();
+    }
+    prefetch_offset = prefetch_end = 0;
+  };
+  uint64_t last_offset = std::numeric_limits<uint64_t>::max();
+  for (auto miter = mget_range->begin(); miter != mget_range->end(); ++miter) {
+    const Slice& ikey = miter->ikey;
+    if (filter != nullptr && !filter->IsBlockBased()) {
+      Slice user_key_without_ts =
+          StripTimestampFromUserKey(ExtractUserKey(ikey), ts_sz);
+      if (!filter->KeyMayMatch(user_key_without_ts, prefix_extractor,
+                               kNotValid, /*no_io=*/false, &ikey,
+                               &scratch_get_context, &lookup_context)) {
+        continue;
+      }
+    }
+    iiter->Seek(ikey);
+    if (!iiter->Valid()) {
+      continue;
+    }
+    BlockHandle handle = iiter->value().handle;
+    if (handle.offset() == last_offset) {
+      continue;
+    }
+    last_offset = handle.offset();
+    if (block_cache != nullptr) {
+      char cache_key[kMaxCacheKeyPrefixSize + kMaxVarint64Length];
+      Slice key = GetCacheKey(rep_->cache_key_prefix,
+                              rep_->cache_key_prefix_size, handle, cache_key);
+      Cache::Handle* cache_handle = block_cache->Lookup(key);
+      if (cache_handle != nullptr) {
+        block_cache->Release(cache_handle);
+        continue;
+      }
+    }
+    uint64_t end = handle.offset() + block_size(handle);
+    if (handle.offset() != prefetch_end) {
+      flush_prefetch();
+      prefetch_offset = handle.offset();
+    }
+    prefetch_end = end;
+  }
+  flush_prefetch();
+}
+
 Status BlockBasedTable::Prefetch(const Slice* const begin,
                                  const Slice* const end) {
   auto& comparator = rep_->internal_comparator;
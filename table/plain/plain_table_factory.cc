@@ -158,7 +158,10 @@ Status GetMemTableRepFactoryFromString(
   std::vector<std::string> opts_list = StringSplit(opts_str, ':');
   size_t len = opts_list.size();
 
-  if (opts_list.empty() || opts_list.size() > 2) {
+  if (opts_list.empty() || opts_list.size() > 3 ||
+      (opts_list.size() == 3 && opts_list[0] != "skip_list" &&
+       opts_list[0] != "SkipListFactory" && opts_list[0] != "vector" &&
+       opts_list[0] != "VectorRepFactory")) {
     return Status::InvalidArgument("Can't parse memtable_factory option ",
                                    opts_str);
   }
@@ -167,8 +170,18 @@ Status GetMemTableRepFactoryFromString(
 
   if (opts_list[0] == "skip_list" || opts_list[0] == "SkipListFactory") {
     // Expecting format
-    // skip_list:<lookahead>
-    if (2 == len) {
+    // skip_list:<lookahead>[:<use_key_prefix>]
+    if (3 == len) {
+      size_t lookahead = ParseSizeT(opts_list[1]);
+      if (opts_list[2] == "true" || opts_list[2] == "1") {
+        mem_factory = new SkipListFactory(lookahead, true);
+      } else if (opts_list[2] == "false" || opts_list[2] == "0") {
+        mem_factory = new SkipListFactory(lookahead, false);
+      } else {
+        return Status::InvalidArgument("Can't parse memtable_factory option ",
+                                       opts_str);
+      }
+    } else if (2 == len) {
       size_t lookahead = ParseSizeT(opts_list[1]);
       mem_factory = new SkipListFactory(lookahead);
     } else if (1 == len) {
@@ -194,10 +207,38 @@ Status GetMemTableRepFactoryFromString(
     } else if (1 == len) {
       mem_factory = NewHashLinkListRepFactory();
     }
-  } else if (opts_list[0] == "vector" || opts_list[0] == "VectorRepFactory") {
+  } else if (opts_list[0] == "hash_indexed_skip_list" ||
+             opts_list[0] == "HashIndexedSkipListRepFactory") {
     // Expecting format
-    // vector:<count>
+    // hash_indexed_skip_list:<hash_bucket_count>
     if (2 == len) {
+      size_t hash_bucket_count = ParseSizeT(opts_list[1]);
+      mem_factory = NewHashIndexedSkipListRepFactory(hash_bucket_count);
+    } else if (1 == len) {
+      mem_factory = NewHashIndexedSkipListRepFactory();
+    }
+  } else if (opts_list[0] == "art" || opts_list[0] == "ArtRepFactory") {
+    // Expecting format
+    // art:<concurrent_inserts>
+    if (2 == len) {
+      bool concurrent_inserts = ParseBoolean("", opts_list[1]);
+      mem_factory = NewArtRepFactory(concurrent_inserts);
+    } else if (1 == len) {
+      mem_factory = NewArtRepFactory();
+    }
+  } else if (opts_list[0] == "vector" || opts_list[0] == "VectorRepFactory") {
+    // Expecting format
+    // vector:<count>[:<sort_threads>]
+    if (3 == len) {
+      size_t count = ParseSizeT(opts_list[1]);
+      if (opts_list[2].empty() ||
+          opts_list[2].find_first_not_of("0123456789") != std::string::npos) {
+        return Status::InvalidArgument("Can't parse memtable_factory option ",
+                                       opts_str);
+      }
+      size_t sort_threads = ParseSizeT(opts_list[2]);
+      mem_factory = new VectorRepFactory(count, sort_threads);
+    } else if (2 == len) {
       size_t count = ParseSizeT(opts_list[1]);
       mem_factory = new VectorRepFactory(count);
     } else if (1 == len) {
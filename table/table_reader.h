@@ -120,6 +120,15 @@ class TableReader {
     }
   }
 
+  // Asks the file system to prefetch the data blocks that may contain the
+  // keys of `mget_range`, without waiting for the reads, so that a later
+  // MultiGet() of the same keys finds them in memory. Only a hint; the
+  // default implementation does nothing.
+  virtual void MultiGetPrefetch(const ReadOptions& /*readOptions*/,
+                                const MultiGetContext::Range* /*mget_range*/,
+                                const SliceTransform* /*prefix_extractor*/,
+                                bool /*skip_filters*/ = false) {}
+
   // Prefetch data corresponding to a give range of keys
   // Typically this functionality is required for table implementations that
   // persists the data on a non volatile storage medium like disk/SSD
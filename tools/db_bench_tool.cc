@@ -38,8 +38,12 @@
 #include "db/db_impl/db_impl.h"
 #include "db/malloc_stats.h"
 #include "db/version_set.h"
+#include "file/file_util.h"
+#include "file/filename.h"
 #include "hdfs/env_hdfs.h"
+#include "monitoring/background_event_timeline.h"
 #include "monitoring/histogram.h"
+#include "monitoring/latency_timeline.h"
 #include "monitoring/statistics.h"
 #include "options/cf_options.h"
 #include "port/port.h"
@@ -49,6 +53,7 @@
 #include "rocksdb/db.h"
 #include "rocksdb/env.h"
 #include "rocksdb/filter_policy.h"
+#include "rocksdb/flow_trace.h"
 #include "rocksdb/memtablerep.h"
 #include "rocksdb/options.h"
 #include "rocksdb/perf_context.h"
@@ -58,6 +63,7 @@
 #include "rocksdb/slice.h"
 #include "rocksdb/slice_transform.h"
 #include "rocksdb/stats_history.h"
+#include "rocksdb/utilities/checkpoint.h"
 #include "rocksdb/utilities/object_registry.h"
 #include "rocksdb/utilities/optimistic_transaction_db.h"
 #include "rocksdb/utilities/options_type.h"
@@ -73,6 +79,7 @@
 #include "util/compression.h"
 #include "util/crc32c.h"
 #include "util/gflags_compat.h"
+#include "util/key_distribution.h"
 #include "util/mutexlock.h"
 #include "util/random.h"
 #include "util/stderr_logger.h"
@@ -84,12 +91,6 @@
 #include "utilities/merge_operators/sortlist.h"
 #include "utilities/persistent_cache/block_cache_tier.h"
 
-// Zipfian pattern generator from util directory - Signal.Jin
-#include "util/zipf.h"
-#include "util/latest-generator.h"
-#include <chrono>
-typedef std::chrono::high_resolution_clock Clock;
-
 #ifdef MEMKIND
 #include "memory/memkind_kmem_allocator.h"
 #endif
@@ -341,8 +342,88 @@ DEFINE_double(read_random_exp_range, 0.0,
               "The larger the number is, the more skewed the reads are. "
               "Only used in readrandom and multireadrandom benchmarks.");
 
+DEFINE_string(key_distribution, "",
+              "Distribution of the keys picked by fillrandom, overwrite, "
+              "updaterandom-style writers and testmemtablerand. One of "
+              "uniform, zipfian, scrambled_zipfian, latest, hotspot, "
+              "exponential. Empty keeps each benchmark's default: uniform, "
+              "or zipfian for testmemtablerand.");
+
+DEFINE_double(key_dist_zipf_theta, 0.99,
+              "Skew of the zipfian, scrambled_zipfian and latest key "
+              "distributions. Must be positive.");
+
+DEFINE_double(key_dist_hot_set_fraction, 0.2,
+              "Fraction of the key space that is hot for "
+              "--key_distribution=hotspot");
+
+DEFINE_double(key_dist_hot_op_fraction, 0.8,
+              "Fraction of the operations that go to the hot set for "
+              "--key_distribution=hotspot");
+
+DEFINE_double(key_dist_exponential_percentile, 95.0,
+              "For --key_distribution=exponential, this percent of the keys "
+              "fall into the first --key_dist_exponential_fraction of the "
+              "key space");
+
+DEFINE_double(key_dist_exponential_fraction, 0.8571428571,
+              "See --key_dist_exponential_percentile");
+
 DEFINE_bool(histogram, false, "Print histogram of operation timings");
 
+DEFINE_string(latency_timeline_file, "",
+              "If non-empty, every benchmark thread records the start time, "
+              "type, latency and bytes of each operation in a private ring "
+              "buffer. After each benchmark the buffers are merged in time "
+              "order and appended to this file, and nanosecond percentiles "
+              "of the merged per-thread histograms are printed. As with "
+              "--histogram, an operation's latency is the time since the "
+              "previous operation of the same thread finished.");
+
+DEFINE_string(latency_timeline_format, "csv",
+              "Format of --latency_timeline_file: csv or binary");
+
+DEFINE_uint64(latency_timeline_max_records, 1000000,
+              "Per-thread capacity of the --latency_timeline_file ring "
+              "buffer. Once full, the oldest records are overwritten; the "
+              "histograms still cover every operation. 0 records histograms "
+              "only.");
+
+DEFINE_string(sweep, "",
+              "Run --benchmarks once for every cell of a parameter matrix, "
+              "in this process. Format: flag=v1,v2[;flag=v1,v2...], where "
+              "each flag is a db_bench flag; the cells are the cross product "
+              "of all value lists. Values are applied with SetOptions or "
+              "SetDBOptions when the option is mutable and by reopening the "
+              "DB otherwise. Flags consumed only at startup (e.g. "
+              "cache_size) are not re-applied. One row per benchmark and "
+              "cell is written to --sweep_report_file.");
+
+DEFINE_string(sweep_load_benchmarks, "",
+              "With --sweep, benchmarks (e.g. fillrandom) run once before the "
+              "first cell. The loaded DB is checkpointed and every cell "
+              "starts from a restored copy of the checkpoint, which is "
+              "reopened with the cell's options.");
+
+DEFINE_string(sweep_report_file, "",
+              "Where --sweep rows are written; stdout if empty");
+
+DEFINE_string(sweep_report_format, "csv",
+              "Format of --sweep_report_file: csv, or json for one JSON "
+              "object per line");
+
+DEFINE_double(latency_spike_percentile, 0,
+              "If in (0, 100), after each benchmark the --latency_timeline_file "
+              "records slower than this percentile are labeled with the "
+              "flushes, compactions, write stalls and WAL syncs that "
+              "overlapped them, and a table attributing the spikes to each "
+              "combination is printed. Background activity is recorded by an "
+              "EventListener.");
+
+DEFINE_string(latency_spike_file, "",
+              "If non-empty, --latency_spike_percentile also appends one CSV "
+              "line per spike to this file");
+
 DEFINE_bool(enable_numa, false,
             "Make operations aware of NUMA architecture and bind memory "
             "and cpus corresponding to nodes together. In NUMA, memory "
@@ -358,6 +439,11 @@ DEFINE_int64(db_write_buffer_size,
 DEFINE_bool(cost_write_buffer_to_cache, false,
             "The usage of memtable is costed to the block cache");
 
+DEFINE_bool(cost_aware_flush, false,
+            "When --db_write_buffer_size is exceeded, pick the column family "
+            "to flush by its write rate, overwrite ratio and write stall risk "
+            "instead of the oldest memtable");
+
 DEFINE_int64(arena_block_size, ROCKSDB_NAMESPACE::Options().arena_block_size,
              "The size, in bytes, of one block in arena memory allocation.");
 
@@ -593,6 +679,11 @@ DEFINE_int32(file_opening_threads,
              "If open_files is set to -1, this option set the number of "
              "threads that will be used to open files during DB::Open()");
 
+DEFINE_int32(wal_recovery_threads,
+             ROCKSDB_NAMESPACE::Options().wal_recovery_threads,
+             "Number of threads that insert the write batches of the WAL "
+             "into the memtables during DB::Open()");
+
 DEFINE_bool(new_table_reader_for_compaction_inputs, true,
              "If true, uses a separate file handle for compaction inputs");
 
@@ -619,6 +710,13 @@ DEFINE_bool(memtable_whole_key_filtering, false,
 DEFINE_bool(memtable_use_huge_page, false,
             "Try to use huge page in memtables.");
 
+DEFINE_bool(memtable_transparent_huge_pages, false,
+            "Back memtable arena blocks with transparent huge pages.");
+
+DEFINE_bool(memtable_numa_aware, false,
+            "Allocate memtable arena blocks of concurrent writers from their "
+            "NUMA node. Requires building with NUMA support.");
+
 DEFINE_bool(whole_key_filtering,
             ROCKSDB_NAMESPACE::BlockBasedTableOptions().whole_key_filtering,
             "Use whole keys (in addition to prefixes) in SST bloom filter."); // RocksDB New Options - Signal.Jin
@@ -690,6 +788,10 @@ DEFINE_bool(disable_wal, false, "If true, do not write WAL for write.");
 
 DEFINE_string(wal_dir, "", "If not empty, use the given dir for WAL");
 
+DEFINE_string(wal_compression, "none",
+              "Algorithm to compress the WAL with as one stream per WAL file. "
+              "Only zstd is supported");
+
 DEFINE_string(truth_db, "/dev/shm/truth_db/dbbench",
               "Truth key/values used when using verify");
 
@@ -943,6 +1045,16 @@ DEFINE_bool(use_stderr_info_logger, false,
 
 DEFINE_string(trace_file, "", "Trace workload to a file. ");
 
+DEFINE_string(flow_trace_categories, "",
+              "Comma separated internal flow trace categories to enable: "
+              "write, read, flush, compaction or all. Sets "
+              "Options::flow_trace_categories.");
+
+DEFINE_string(flow_trace_file, "",
+              "If non-empty, the buffered flow trace events are written to "
+              "this file in Chrome trace JSON format after the last "
+              "benchmark.");
+
 DEFINE_int32(trace_replay_fast_forward, 1,
              "Fast forward trace replay, must >= 1. ");
 DEFINE_int32(block_cache_trace_sampling_frequency, 1,
@@ -1106,17 +1218,41 @@ DEFINE_uint64(delayed_write_rate, 8388608u,
               "Limited bytes allowed to DB when soft_rate_limit or "
               "level0_slowdown_writes_trigger triggers");
 
+DEFINE_bool(predictive_write_stall_control,
+            ROCKSDB_NAMESPACE::Options().predictive_write_stall_control,
+            "Pace writes at the rate compaction is estimated to sustain "
+            "instead of delaying and stopping them in steps");
+
 DEFINE_bool(enable_pipelined_write, true,
             "Allow WAL and memtable writes to be pipelined");
 
+DEFINE_bool(pipelined_wal_sync, false,
+            "With --enable_pipelined_write and --sync, sync the WAL on a "
+            "dedicated thread while the next write groups append to it");
+
 DEFINE_bool(
     unordered_write, false,
     "Enable the unordered write feature, which provides higher throughput but "
     "relaxes the guarantees around atomic reads and immutable snapshots");
 
+DEFINE_int32(wal_streams, 1,
+             "With --unordered_write, number of WAL streams the writes are "
+             "spread over");
+
 DEFINE_bool(allow_concurrent_memtable_write, true,
             "Allow multi-writers to update mem tables in parallel.");
 
+DEFINE_uint32(max_write_batch_insert_threads,
+              ROCKSDB_NAMESPACE::Options().max_write_batch_insert_threads,
+              "With allow_concurrent_memtable_write, the number of threads a "
+              "large write batch is inserted into the memtables on.");
+
+DEFINE_uint64(zero_copy_put_min_value_size,
+              ROCKSDB_NAMESPACE::Options().zero_copy_put_min_value_size,
+              "Minimum size of the values that Put writes to the WAL and the "
+              "memtable without copying them into a write batch. 0 disables "
+              "it.");
+
 DEFINE_bool(inplace_update_support,
             ROCKSDB_NAMESPACE::Options().inplace_update_support,
             "Support in-place memtable update for smaller or same-size values");
@@ -1136,6 +1272,13 @@ DEFINE_uint64(write_thread_slow_yield_usec, 3,
               "The threshold at which a slow yield is considered a signal that "
               "other processes or threads want the core.");
 
+DEFINE_uint64(write_batch_group_latency_budget_micros,
+              ROCKSDB_NAMESPACE::Options()
+                  .write_batch_group_latency_budget_micros,
+              "If non-zero, write groups are limited to what is expected to "
+              "be written within this many microseconds, and larger batches "
+              "are written alone.");
+
 DEFINE_int32(rate_limit_delay_max_milliseconds, 1000,
              "When hard_rate_limit is set then this is the max time a put will"
              " be stalled.");
@@ -1325,6 +1468,13 @@ DEFINE_int32(num_deletion_threads, 1,
 DEFINE_int32(max_successive_merges, 0, "Maximum number of successive merge"
              " operations on a key in the memtable");
 
+DEFINE_int32(flush_partitions, 1, "Number of key ranges a flush writes to "
+             "separate L0 files in parallel");
+
+DEFINE_bool(in_memory_compaction,
+            ROCKSDB_NAMESPACE::Options().in_memory_compaction,
+            "Compact immutable memtables in memory before flushing them");
+
 static bool ValidatePrefixSize(const char* flagname, int32_t value) {
   if (value < 0 || value>=2000000000) {
     fprintf(stderr, "Invalid value for --%s: %d. 0<= PrefixSize <=2000000000\n",
@@ -1373,12 +1523,17 @@ DEFINE_uint64(stats_history_buffer_size,
 DEFINE_int64(multiread_stride, 0,
              "Stride length for the keys in a MultiGet batch");
 DEFINE_bool(multiread_batched, false, "Use the new MultiGet API");
+DEFINE_bool(optimize_multiget_for_io, false,
+            "With --multiread_batched, prefetch the data blocks of all levels "
+            "before looking up the keys of a MultiGet batch");
 
 enum RepFactory {
   kSkipList,
   kPrefixHash,
   kVectorRep,
   kHashLinkedList,
+  kHashIndexedSkipList,
+  kArt,
 };
 
 static enum RepFactory StringToRepFactory(const char* ctype) {
@@ -1392,6 +1547,10 @@ static enum RepFactory StringToRepFactory(const char* ctype) {
     return kVectorRep;
   else if (!strcasecmp(ctype, "hash_linkedlist"))
     return kHashLinkedList;
+  else if (!strcasecmp(ctype, "hash_indexed_skip_list"))
+    return kHashIndexedSkipList;
+  else if (!strcasecmp(ctype, "art"))
+    return kArt;
 
   fprintf(stdout, "Cannot parse memreptable %s\n", ctype);
   return kSkipList;
@@ -1417,6 +1576,11 @@ DEFINE_string(merge_operator, "", "The merge operator to use with the database."
 DEFINE_int32(skip_list_lookahead, 0, "Used with skip_list memtablerep; try "
              "linear search first for this many steps from the previous "
              "position");
+DEFINE_bool(skip_list_key_prefix, false, "Used with skip_list memtablerep; "
+            "store the first 8 bytes of each key in the skip list nodes to "
+            "speed up comparisons. Requires the bytewise comparator");
+DEFINE_int32(vector_rep_sort_threads, 1, "Used with vector memtablerep; "
+             "number of threads that sort a memtable before it is flushed");
 DEFINE_bool(report_file_operations, false, "if report number of file "
             "operations");
 DEFINE_int32(readahead_size, 0, "Iterator readahead size");
@@ -1620,6 +1784,69 @@ static enum DistributionType StringToDistributionType(const char* ctype) {
   return kFixed;  // default value
 }
 
+static uint32_t FLAGS_flow_trace_categories_e = 0;
+
+static bool FLAGS_key_distribution_set = false;
+static ROCKSDB_NAMESPACE::KeyDistributionType FLAGS_key_distribution_e =
+    ROCKSDB_NAMESPACE::KeyDistributionType::kUniform;
+
+// Derives the enum flags above from their string or integer flags. Called at
+// startup and again by --sweep after it changes flags.
+static void DeriveEnumFlags() {
+  FLAGS_compaction_style_e =
+      (ROCKSDB_NAMESPACE::CompactionStyle)FLAGS_compaction_style;
+  FLAGS_compaction_pri_e =
+      (ROCKSDB_NAMESPACE::CompactionPri)FLAGS_compaction_pri;
+  FLAGS_compression_type_e =
+      StringToCompressionType(FLAGS_compression_type.c_str());
+  FLAGS_value_size_distribution_type_e =
+      StringToDistributionType(FLAGS_value_size_distribution_type.c_str());
+  FLAGS_rep_factory = StringToRepFactory(FLAGS_memtablerep.c_str());
+}
+
+// --sweep parsed into (flag, values) axes.
+static std::vector<std::pair<std::string, std::vector<std::string>>>
+    FLAGS_sweep_v;
+
+static bool ParseSweep(const std::string& spec) {
+  FLAGS_sweep_v.clear();
+  for (const std::string& raw : ROCKSDB_NAMESPACE::StringSplit(spec, ';')) {
+    std::string axis = ROCKSDB_NAMESPACE::trim(raw);
+    if (axis.empty()) {
+      continue;
+    }
+    size_t eq = axis.find('=');
+    std::string flag = ROCKSDB_NAMESPACE::trim(axis.substr(0, eq));
+    GFLAGS_NAMESPACE::CommandLineFlagInfo info;
+    if (eq == std::string::npos ||
+        !GFLAGS_NAMESPACE::GetCommandLineFlagInfo(flag.c_str(), &info)) {
+      fprintf(stderr, "--sweep: unknown flag in '%s'\n", axis.c_str());
+      return false;
+    }
+    if (flag == "benchmarks" || flag == "db" || flag.find("sweep") == 0) {
+      fprintf(stderr, "--sweep: --%s cannot be swept\n", flag.c_str());
+      return false;
+    }
+    std::vector<std::string> values;
+    for (const std::string& value :
+         ROCKSDB_NAMESPACE::StringSplit(axis.substr(eq + 1), ',')) {
+      if (!ROCKSDB_NAMESPACE::trim(value).empty()) {
+        values.push_back(ROCKSDB_NAMESPACE::trim(value));
+      }
+    }
+    if (values.empty()) {
+      fprintf(stderr, "--sweep: no values for --%s\n", flag.c_str());
+      return false;
+    }
+    FLAGS_sweep_v.emplace_back(flag, values);
+  }
+  if (FLAGS_sweep_v.empty()) {
+    fprintf(stderr, "--sweep: empty sweep\n");
+    return false;
+  }
+  return true;
+}
+
 class BaseDistribution {
  public:
   BaseDistribution(unsigned int _min, unsigned int _max)
@@ -1969,7 +2196,7 @@ static std::unordered_map<OperationType, std::string, std::hash<unsigned char>>
   {kMerge, "merge"},
   {kUpdate, "update"},
   {kCompress, "compress"},
-  {kCompress, "uncompress"},
+  {kUncompress, "uncompress"},
   {kCrc, "crc"},
   {kHash, "hash"},
   {kOthers, "op"}
@@ -1992,6 +2219,11 @@ class Stats {
   uint64_t last_report_finish_;
   std::unordered_map<OperationType, std::shared_ptr<HistogramImpl>,
                      std::hash<unsigned char>> hist_;
+  // Only set for benchmark threads when --latency_timeline_file or --sweep
+  // is given.
+  std::shared_ptr<LatencyTimeline> timeline_;
+  uint64_t last_op_finish_nanos_ = 0;
+  uint64_t timeline_bytes_ = 0;
   std::string message_;
   bool exclude_from_merge_;
   ReporterAgent* reporter_agent_;  // does not own
@@ -2020,7 +2252,25 @@ class Stats {
     message_.clear();
     // When set, stats from this thread won't be merged with others.
     exclude_from_merge_ = false;
-  }
+    timeline_.reset();
+    if (id >= 0 &&
+        (!FLAGS_latency_timeline_file.empty() || !FLAGS_sweep.empty())) {
+      // --sweep only needs the histograms.
+      size_t capacity =
+          FLAGS_latency_timeline_file.empty()
+              ? 0
+              : static_cast<size_t>(FLAGS_latency_timeline_max_records);
+      timeline_.reset(
+          new LatencyTimeline(static_cast<uint32_t>(id), capacity));
+      last_op_finish_nanos_ = clock_->NowNanos();
+      timeline_bytes_ = 0;
+    }
+  }
+
+  const LatencyTimeline* timeline() const { return timeline_.get(); }
+  uint64_t done() const { return done_; }
+  uint64_t bytes() const { return bytes_; }
+  double ElapsedSeconds() const { return (finish_ - start_) * 1e-6; }
 
   void Merge(const Stats& other) {
     if (other.exclude_from_merge_)
@@ -2100,6 +2350,9 @@ class Stats {
   void ResetLastOpTime() {
     // Set to now to avoid latency from calls to SleepForMicroseconds
     last_op_finish_ = clock_->NowMicros();
+    if (timeline_) {
+      last_op_finish_nanos_ = clock_->NowNanos();
+    }
   }
 
   void FinishedOps(DBWithColumnFamilies* db_with_cfh, DB* db, int64_t num_ops,
@@ -2108,17 +2361,13 @@ class Stats {
       reporter_agent_->ReportFinishedOps(num_ops);
     }
 
-    FILE *fp_test;
-    fp_test = fopen("time.txt", "at");
-
-    /*Time Estimation with Gettimeofday() in RocksDB - Signal.Jin*/
-    uint64_t now_ = FLAGS_env->NowMicros();
-    uint64_t micros_ = now_ - last_op_finish_;
-    if (op_type == kRead) {
-      fprintf(fp_test, "%lu\n", micros_);
+    if (timeline_) {
+      uint64_t now_nanos = clock_->NowNanos();
+      timeline_->Record(last_op_finish_nanos_, now_nanos - last_op_finish_nanos_,
+                        op_type, timeline_bytes_);
+      last_op_finish_nanos_ = now_nanos;
+      timeline_bytes_ = 0;
     }
-    fclose(fp_test);
-    last_op_finish_ = now_;
 
     if (FLAGS_histogram) {
       uint64_t now = clock_->NowMicros();
@@ -2229,6 +2478,9 @@ class Stats {
 
   void AddBytes(int64_t n) {
     bytes_ += n;
+    // Attributed to the next finished op; benchmarks that only add their
+    // bytes at the end leave per-record bytes at 0.
+    timeline_bytes_ += n;
   }
 
   void Report(const Slice& name) {
@@ -2484,6 +2736,14 @@ class Benchmark {
   bool report_file_operations_;
   bool use_blob_db_;  // Stacked BlobDB
   std::vector<std::string> keys_;
+  // Opened on the first benchmark when --latency_timeline_file is given.
+  std::unique_ptr<WritableFile> latency_timeline_file_;
+  // --sweep: flag values of the current cell, in --sweep order.
+  std::vector<std::pair<std::string, std::string>> sweep_cell_;
+  // --sweep: latencies of all operations of the last RunBenchmark().
+  LogLinearHistogram sweep_latency_;
+  std::unique_ptr<WritableFile> sweep_report_file_;
+  bool sweep_header_written_ = false;
 
   class ErrorHandlerListener : public EventListener {
    public:
@@ -2536,6 +2796,11 @@ class Benchmark {
   };
 
   std::shared_ptr<ErrorHandlerListener> listener_;
+#ifndef ROCKSDB_LITE
+  // Set when --latency_spike_percentile is given.
+  std::shared_ptr<BackgroundEventListener> background_events_;
+#endif  // ROCKSDB_LITE
+  std::unique_ptr<WritableFile> latency_spike_file_;
 
   std::unique_ptr<TimestampEmulator> mock_app_clock_;
 
@@ -2619,6 +2884,12 @@ class Benchmark {
       case kHashLinkedList:
         fprintf(stdout, "Memtablerep: hash_linkedlist\n");
         break;
+      case kHashIndexedSkipList:
+        fprintf(stdout, "Memtablerep: hash_indexed_skip_list\n");
+        break;
+      case kArt:
+        fprintf(stdout, "Memtablerep: art\n");
+        break;
     }
     fprintf(stdout, "Perf Level: %d\n", FLAGS_perf_level);
 
@@ -2936,6 +3207,12 @@ class Benchmark {
     }
 
     listener_.reset(new ErrorHandlerListener());
+#ifndef ROCKSDB_LITE
+    if (FLAGS_latency_spike_percentile > 0) {
+      background_events_.reset(
+          new BackgroundEventListener(FLAGS_env->GetSystemClock().get()));
+    }
+#endif  // ROCKSDB_LITE
     if (user_timestamp_size_ > 0) {
       mock_app_clock_.reset(new TimestampEmulator());
     }
@@ -3100,9 +3377,68 @@ class Benchmark {
     Open(&open_options_);
     //sleep(2000); // Signal.Jin
     PrintHeader();
-    std::stringstream benchmark_stream(FLAGS_benchmarks);
     std::string name;
-    std::unique_ptr<ExpiredTimeFilter> filter;
+    if (FLAGS_sweep.empty()) {
+      name = RunBenchmarks(FLAGS_benchmarks);
+    } else {
+      name = RunSweep();
+    }
+
+    if (secondary_update_thread_) {
+      secondary_update_stopped_.store(1, std::memory_order_relaxed);
+      secondary_update_thread_->join();
+      secondary_update_thread_.reset();
+    }
+
+#ifndef ROCKSDB_LITE
+    if (name != "replay" && FLAGS_trace_file != "") {
+      Status s = db_.db->EndTrace();
+      if (!s.ok()) {
+        fprintf(stderr, "Encountered an error ending the trace, %s\n",
+                s.ToString().c_str());
+      }
+    }
+    if (!FLAGS_block_cache_trace_file.empty()) {
+      Status s = db_.db->EndBlockCacheTrace();
+      if (!s.ok()) {
+        fprintf(stderr,
+                "Encountered an error ending the block cache tracing, %s\n",
+                s.ToString().c_str());
+      }
+    }
+#endif  // ROCKSDB_LITE
+
+    if (FLAGS_statistics) {
+      fprintf(stdout, "STATISTICS:\n%s\n", dbstats->ToString().c_str());
+    }
+    if (FLAGS_simcache_size >= 0) {
+      fprintf(
+          stdout, "SIMULATOR CACHE STATISTICS:\n%s\n",
+          static_cast_with_check<SimCache>(cache_.get())->ToString().c_str());
+    }
+    if (!FLAGS_flow_trace_file.empty()) {
+      Status s = ExportFlowTrace(FLAGS_env, FLAGS_flow_trace_file);
+      if (!s.ok()) {
+        fprintf(stderr, "Failed to export flow trace to %s: %s\n",
+                FLAGS_flow_trace_file.c_str(), s.ToString().c_str());
+      }
+    }
+
+#ifndef ROCKSDB_LITE
+    if (FLAGS_use_secondary_db) {
+      fprintf(stdout, "Secondary instance updated  %" PRIu64 " times.\n",
+              secondary_db_updates_);
+    }
+#endif  // ROCKSDB_LITE
+  }
+
+ private:
+  // Runs a comma-separated list of benchmarks and returns the name of the
+  // last one.
+  std::string RunBenchmarks(const std::string& benchmarks) {
+    std::stringstream benchmark_stream(benchmarks);
+    std::string name;
+    std::string last_name;
     while (std::getline(benchmark_stream, name, ',')) {
       // Sanitize parameters
       num_ = FLAGS_num;
@@ -3349,9 +3685,10 @@ class Benchmark {
       } else if (name == "timeseries") {
         timestamp_emulator_.reset(new TimestampEmulator());
         if (FLAGS_expire_style == "compaction_filter") {
-          filter.reset(new ExpiredTimeFilter(timestamp_emulator_));
+          expired_time_filter_.reset(
+              new ExpiredTimeFilter(timestamp_emulator_));
           fprintf(stdout, "Compaction filter is used to remove expired data");
-          open_options_.compaction_filter = filter.get();
+          open_options_.compaction_filter = expired_time_filter_.get();
         }
         fresh_db = true;
         method = &Benchmark::TimeSeries;
@@ -3498,8 +3835,15 @@ class Benchmark {
 
         CombinedStats combined_stats;
         for (int i = 0; i < num_repeat; i++) {
+          SweepCounters sweep_counters = {};
+          if (!sweep_cell_.empty()) {
+            sweep_counters = GetSweepCounters();
+          }
           Stats stats = RunBenchmark(num_threads, name, method);
           combined_stats.AddStats(stats);
+          if (!sweep_cell_.empty()) {
+            ReportSweepRow(name, stats, sweep_counters);
+          }
         }
         if (num_repeat > 1) {
           combined_stats.Report(name);
@@ -3508,51 +3852,276 @@ class Benchmark {
       if (post_process_method != nullptr) {
         (this->*post_process_method)();
       }
+      last_name = name;
     }
+    return last_name;
+  }
 
-    if (secondary_update_thread_) {
-      secondary_update_stopped_.store(1, std::memory_order_relaxed);
-      secondary_update_thread_->join();
-      secondary_update_thread_.reset();
+  // Runs FLAGS_benchmarks once for every cell of --sweep and returns the
+  // name of the last benchmark.
+  std::string RunSweep() {
+    std::string base_dir;
+    if (!FLAGS_sweep_load_benchmarks.empty()) {
+      RunBenchmarks(FLAGS_sweep_load_benchmarks);
+      base_dir = FLAGS_db + "_sweep_base";
+      CreateSweepBase(base_dir);
     }
 
-#ifndef ROCKSDB_LITE
-    if (name != "replay" && FLAGS_trace_file != "") {
-      Status s = db_.db->EndTrace();
-      if (!s.ok()) {
-        fprintf(stderr, "Encountered an error ending the trace, %s\n",
-                s.ToString().c_str());
+    size_t num_cells = 1;
+    std::vector<std::string> saved_values;
+    for (const auto& axis : FLAGS_sweep_v) {
+      num_cells *= axis.second.size();
+      GFLAGS_NAMESPACE::CommandLineFlagInfo info;
+      GFLAGS_NAMESPACE::GetCommandLineFlagInfo(axis.first.c_str(), &info);
+      saved_values.push_back(info.current_value);
+    }
+    std::string name;
+    for (size_t cell = 0; cell < num_cells; cell++) {
+      // The last axis varies fastest.
+      sweep_cell_.assign(FLAGS_sweep_v.size(),
+                         std::pair<std::string, std::string>());
+      size_t rest = cell;
+      for (size_t i = FLAGS_sweep_v.size(); i > 0; i--) {
+        const auto& axis = FLAGS_sweep_v[i - 1];
+        sweep_cell_[i - 1] = {axis.first,
+                              axis.second[rest % axis.second.size()]};
+        rest /= axis.second.size();
+      }
+      std::string desc;
+      for (const auto& kv : sweep_cell_) {
+        if (GFLAGS_NAMESPACE::SetCommandLineOption(kv.first.c_str(),
+                                                   kv.second.c_str())
+                .empty()) {
+          fprintf(stderr, "Invalid value for --%s: %s\n", kv.first.c_str(),
+                  kv.second.c_str());
+          ErrorExit();
+        }
+        desc += " " + kv.first + "=" + kv.second;
       }
+      DeriveEnumFlags();
+      fprintf(stdout, "Sweep cell %" ROCKSDB_PRIszt "/%" ROCKSDB_PRIszt ":%s\n",
+              cell + 1, num_cells, desc.c_str());
+
+      if (base_dir.empty()) {
+        ApplySweepCell();
+      } else {
+        db_.DeleteDBs();
+        RestoreSweepBase(base_dir);
+        Open(&open_options_);
+      }
+      name = RunBenchmarks(FLAGS_benchmarks);
     }
-    if (!FLAGS_block_cache_trace_file.empty()) {
-      Status s = db_.db->EndBlockCacheTrace();
+    sweep_cell_.clear();
+    for (size_t i = 0; i < FLAGS_sweep_v.size(); i++) {
+      GFLAGS_NAMESPACE::SetCommandLineOption(FLAGS_sweep_v[i].first.c_str(),
+                                             saved_values[i].c_str());
+    }
+    DeriveEnumFlags();
+
+    if (!base_dir.empty()) {
+      Status s = DestroyDir(FLAGS_env, base_dir);
       if (!s.ok()) {
-        fprintf(stderr,
-                "Encountered an error ending the block cache tracing, %s\n",
+        fprintf(stderr, "Failed to remove %s: %s\n", base_dir.c_str(),
                 s.ToString().c_str());
       }
     }
+    return name;
+  }
+
+  void CreateSweepBase(const std::string& base_dir) {
+#ifndef ROCKSDB_LITE
+    Status s = DestroyDir(FLAGS_env, base_dir);
+    if (s.ok() || s.IsNotFound()) {
+      Checkpoint* checkpoint = nullptr;
+      s = Checkpoint::Create(db_.db, &checkpoint);
+      if (s.ok()) {
+        s = checkpoint->CreateCheckpoint(base_dir);
+        delete checkpoint;
+      }
+    }
+    if (!s.ok()) {
+      fprintf(stderr, "Failed to checkpoint the loaded DB to %s: %s\n",
+              base_dir.c_str(), s.ToString().c_str());
+      ErrorExit();
+    }
+    fprintf(stdout, "Sweep base checkpoint: [%s]\n", base_dir.c_str());
+#else
+    (void)base_dir;
+    fprintf(stderr, "--sweep_load_benchmarks is not supported in LITE mode\n");
+    ErrorExit();
 #endif  // ROCKSDB_LITE
+  }
 
-    if (FLAGS_statistics) {
-      fprintf(stdout, "STATISTICS:\n%s\n", dbstats->ToString().c_str());
+  // Replaces FLAGS_db, which must be closed, by a copy of the checkpoint in
+  // `base_dir`. Table and blob files are immutable, so they are hard-linked
+  // when the file system allows it.
+  void RestoreSweepBase(const std::string& base_dir) {
+    DestroyDB(FLAGS_db, open_options_);
+    std::vector<std::string> files;
+    Status s = FLAGS_env->CreateDirIfMissing(FLAGS_db);
+    if (s.ok()) {
+      s = FLAGS_env->GetChildren(base_dir, &files);
     }
-    if (FLAGS_simcache_size >= 0) {
-      fprintf(
-          stdout, "SIMULATOR CACHE STATISTICS:\n%s\n",
-          static_cast_with_check<SimCache>(cache_.get())->ToString().c_str());
+    for (size_t i = 0; s.ok() && i < files.size(); i++) {
+      uint64_t number;
+      FileType type;
+      if (!ParseFileName(files[i], &number, &type)) {
+        continue;
+      }
+      const std::string src = base_dir + "/" + files[i];
+      const std::string dst = FLAGS_db + "/" + files[i];
+      if (type == kTableFile || type == kBlobFile) {
+        s = FLAGS_env->LinkFile(src, dst);
+        if (s.ok()) {
+          continue;
+        }
+      }
+      s = CopyFile(FLAGS_env->GetFileSystem(), src, dst, 0 /* size */,
+                   open_options_.use_fsync);
     }
+    if (!s.ok()) {
+      fprintf(stderr, "Failed to restore %s from %s: %s\n", FLAGS_db.c_str(),
+              base_dir.c_str(), s.ToString().c_str());
+      ErrorExit();
+    }
+  }
 
-#ifndef ROCKSDB_LITE
-    if (FLAGS_use_secondary_db) {
-      fprintf(stdout, "Secondary instance updated  %" PRIu64 " times.\n",
-              secondary_db_updates_);
+  // Applies the flags of the current sweep cell to the open DB. Mutable
+  // options are changed in place; if any flag is not one, the DB is
+  // reopened so that the options are rebuilt from the flags.
+  void ApplySweepCell() {
+    bool reopen = false;
+    for (const auto& kv : sweep_cell_) {
+      std::unordered_map<std::string, std::string> opts = {kv};
+      Status s;
+      if (db_.cfh.empty()) {
+        s = db_.db->SetOptions(opts);
+      } else {
+        for (ColumnFamilyHandle* cfh : db_.cfh) {
+          if (cfh != nullptr && s.ok()) {
+            s = db_.db->SetOptions(cfh, opts);
+          }
+        }
+      }
+      if (!s.ok()) {
+        s = db_.db->SetDBOptions(opts);
+      }
+      if (!s.ok()) {
+        reopen = true;
+      }
+    }
+    if (reopen) {
+      db_.DeleteDBs();
+      Open(&open_options_);
+    }
+  }
+
+  struct SweepCounters {
+    uint64_t user_bytes;
+    uint64_t flush_bytes;
+    uint64_t compact_bytes;
+    uint64_t stall_micros;
+  };
+
+  SweepCounters GetSweepCounters() {
+    SweepCounters counters;
+    counters.user_bytes = dbstats->getTickerCount(BYTES_WRITTEN);
+    counters.flush_bytes = dbstats->getTickerCount(FLUSH_WRITE_BYTES);
+    counters.compact_bytes = dbstats->getTickerCount(COMPACT_WRITE_BYTES);
+    counters.stall_micros = dbstats->getTickerCount(STALL_MICROS);
+    return counters;
+  }
+
+  // Writes one --sweep row for a benchmark run of the current cell. Write
+  // amplification counts flush and compaction output written while the
+  // benchmark ran, relative to the bytes written by the user.
+  void ReportSweepRow(const std::string& name, const Stats& stats,
+                      const SweepCounters& before) {
+    SweepCounters after = GetSweepCounters();
+    const bool json = !strcasecmp(FLAGS_sweep_report_format.c_str(), "json");
+    const double seconds = stats.ElapsedSeconds();
+    const uint64_t user_bytes = after.user_bytes - before.user_bytes;
+    const uint64_t table_bytes = (after.flush_bytes - before.flush_bytes) +
+                                 (after.compact_bytes - before.compact_bytes);
+
+    std::string row;
+    if (!sweep_header_written_ && !json) {
+      for (const auto& kv : sweep_cell_) {
+        row += kv.first + ",";
+      }
+      row +=
+          "benchmark,ops,seconds,ops_per_sec,mb_per_sec,p50_us,p99_us,"
+          "p999_us,max_us,write_amp,stall_micros\n";
+    }
+    sweep_header_written_ = true;
+    if (json) {
+      row += "{";
+      for (const auto& kv : sweep_cell_) {
+        row += "\"" + kv.first + "\":\"" + kv.second + "\",";
+      }
+      row += "\"benchmark\":\"" + name + "\"";
+    } else {
+      for (const auto& kv : sweep_cell_) {
+        row += kv.second + ",";
+      }
+      row += name;
+    }
+    const char* const kFields[] = {"ops",        "seconds", "ops_per_sec",
+                                   "mb_per_sec", "p50_us",  "p99_us",
+                                   "p999_us",    "max_us",  "write_amp",
+                                   "stall_micros"};
+    const double values[] = {
+        static_cast<double>(stats.done()),
+        seconds,
+        seconds > 0 ? stats.done() / seconds : 0.0,
+        seconds > 0 ? stats.bytes() / 1048576.0 / seconds : 0.0,
+        sweep_latency_.Percentile(50) / 1000.0,
+        sweep_latency_.Percentile(99) / 1000.0,
+        sweep_latency_.Percentile(99.9) / 1000.0,
+        sweep_latency_.max() / 1000.0,
+        user_bytes > 0 ? static_cast<double>(table_bytes) / user_bytes : 0.0,
+        static_cast<double>(after.stall_micros - before.stall_micros)};
+    const int kDecimals[] = {0, 3, 1, 2, 3, 3, 3, 3, 3, 0};
+    char buf[64];
+    for (size_t i = 0; i < sizeof(values) / sizeof(values[0]); i++) {
+      if (json) {
+        snprintf(buf, sizeof(buf), ",\"%s\":%.*f", kFields[i], kDecimals[i],
+                 values[i]);
+      } else {
+        snprintf(buf, sizeof(buf), ",%.*f", kDecimals[i], values[i]);
+      }
+      row += buf;
+    }
+    row += json ? "}\n" : "\n";
+
+    if (FLAGS_sweep_report_file.empty()) {
+      fputs(row.c_str(), stdout);
+      fflush(stdout);
+      return;
+    }
+    Status s;
+    if (!sweep_report_file_) {
+      s = FLAGS_env->NewWritableFile(FLAGS_sweep_report_file,
+                                     &sweep_report_file_, EnvOptions());
+      if (!s.ok()) {
+        fprintf(stderr, "Cannot open sweep report file %s: %s\n",
+                FLAGS_sweep_report_file.c_str(), s.ToString().c_str());
+        ErrorExit();
+      }
+    }
+    s = sweep_report_file_->Append(row);
+    if (s.ok()) {
+      s = sweep_report_file_->Flush();
+    }
+    if (!s.ok()) {
+      fprintf(stderr, "Failed to write sweep report: %s\n",
+              s.ToString().c_str());
     }
-#endif  // ROCKSDB_LITE
   }
 
- private:
   std::shared_ptr<TimestampEmulator> timestamp_emulator_;
+  // Set by the timeseries benchmark; outlives it since the DB keeps using it.
+  std::unique_ptr<ExpiredTimeFilter> expired_time_filter_;
   std::unique_ptr<port::Thread> secondary_update_thread_;
   std::atomic<int> secondary_update_stopped_{0};
 #ifndef ROCKSDB_LITE
@@ -3665,6 +4234,29 @@ class Benchmark {
       merge_stats.Merge(arg[i].thread->stats);
     }
     merge_stats.Report(name);
+    if (!FLAGS_latency_timeline_file.empty()) {
+      std::vector<const LatencyTimeline*> timelines;
+      for (int i = 0; i < n; i++) {
+        if (arg[i].thread->stats.timeline() != nullptr) {
+          timelines.push_back(arg[i].thread->stats.timeline());
+        }
+      }
+      ReportLatencyTimelines(name, timelines);
+    }
+    if (!FLAGS_sweep.empty()) {
+      sweep_latency_.Clear();
+      for (int i = 0; i < n; i++) {
+        const LatencyTimeline* timeline = arg[i].thread->stats.timeline();
+        for (size_t op = 0;
+             timeline != nullptr && op < LatencyTimeline::kMaxOpTypes; op++) {
+          const LogLinearHistogram* hist =
+              timeline->histogram(static_cast<uint8_t>(op));
+          if (hist != nullptr) {
+            sweep_latency_.Merge(*hist);
+          }
+        }
+      }
+    }
 
     for (int i = 0; i < n; i++) {
       delete arg[i].thread;
@@ -3674,6 +4266,130 @@ class Benchmark {
     return merge_stats;
   }
 
+  void ReportLatencyTimelines(
+      const Slice& name, const std::vector<const LatencyTimeline*>& timelines) {
+    LogLinearHistogram merged[LatencyTimeline::kMaxOpTypes];
+    uint64_t overwritten = 0;
+    for (const LatencyTimeline* timeline : timelines) {
+      for (size_t op = 0; op < LatencyTimeline::kMaxOpTypes; op++) {
+        const LogLinearHistogram* hist =
+            timeline->histogram(static_cast<uint8_t>(op));
+        if (hist != nullptr) {
+          merged[op].Merge(*hist);
+        }
+      }
+      overwritten += timeline->overwritten();
+    }
+    std::vector<std::string> op_names(kOthers + 1);
+    for (const auto& op_name : OperationTypeString) {
+      op_names[op_name.first] = op_name.second;
+    }
+    for (size_t op = 0; op < op_names.size(); op++) {
+      if (merged[op].count() > 0) {
+        fprintf(stdout, "Nanoseconds per %s: %s\n", op_names[op].c_str(),
+                merged[op].ToString().c_str());
+      }
+    }
+
+    bool write_header = false;
+    if (!latency_timeline_file_) {
+      Status s = FLAGS_env->NewWritableFile(FLAGS_latency_timeline_file,
+                                            &latency_timeline_file_,
+                                            EnvOptions());
+      if (!s.ok()) {
+        fprintf(stderr, "Cannot open latency timeline file %s: %s\n",
+                FLAGS_latency_timeline_file.c_str(), s.ToString().c_str());
+        exit(1);
+      }
+      write_header = true;
+    }
+    LatencyTimelineFormat format = LatencyTimelineFormat::kCsv;
+    if (!strcasecmp(FLAGS_latency_timeline_format.c_str(), "binary")) {
+      format = LatencyTimelineFormat::kBinary;
+    }
+    Status s = WriteLatencyTimelines(timelines, name.ToString(), op_names,
+                                     format, write_header,
+                                     latency_timeline_file_.get());
+    if (!s.ok()) {
+      fprintf(stderr, "Failed to write latency timeline: %s\n",
+              s.ToString().c_str());
+      exit(1);
+    }
+    if (overwritten > 0) {
+      fprintf(stdout,
+              "Latency timeline: %" PRIu64
+              " oldest records overwritten, raise "
+              "--latency_timeline_max_records to keep them\n",
+              overwritten);
+    }
+#ifndef ROCKSDB_LITE
+    if (background_events_) {
+      ReportLatencySpikes(name, timelines, op_names);
+      // The next benchmark only needs its own events.
+      background_events_->Clear();
+    }
+#endif  // ROCKSDB_LITE
+  }
+
+#ifndef ROCKSDB_LITE
+  // Labels the operations slower than --latency_spike_percentile with the
+  // flushes, compactions, stalls and WAL syncs that overlapped them.
+  void ReportLatencySpikes(const Slice& name,
+                           const std::vector<const LatencyTimeline*>& timelines,
+                           const std::vector<std::string>& op_names) {
+    std::vector<LatencySpike> spikes;
+    LatencySpikeReport report;
+    AttributeLatencySpikes(timelines, background_events_->GetEvents(),
+                           FLAGS_latency_spike_percentile, &spikes, &report);
+    fprintf(stdout, "%s", report.ToString().c_str());
+    uint64_t dropped = background_events_->GetNumDroppedEvents();
+    if (dropped > 0) {
+      fprintf(stdout,
+              "Background events: %" PRIu64
+              " oldest events dropped, spikes before them are not "
+              "attributed\n",
+              dropped);
+    }
+    if (FLAGS_latency_spike_file.empty()) {
+      return;
+    }
+
+    std::string buf;
+    if (!latency_spike_file_) {
+      Status s = FLAGS_env->NewWritableFile(
+          FLAGS_latency_spike_file, &latency_spike_file_, EnvOptions());
+      if (!s.ok()) {
+        fprintf(stderr, "Cannot open latency spike file %s: %s\n",
+                FLAGS_latency_spike_file.c_str(), s.ToString().c_str());
+        exit(1);
+      }
+      buf = "label,thread,start_nanos,op,latency_nanos,overlapping\n";
+    }
+    char line[128];
+    for (const LatencySpike& spike : spikes) {
+      std::string op = spike.op_type < op_names.size()
+                           ? op_names[spike.op_type]
+                           : ToString(spike.op_type);
+      snprintf(line, sizeof(line), ",%" PRIu32 ",%" PRIu64 ",%s,%" PRIu64 ",",
+               spike.thread_id, spike.start_nanos, op.c_str(),
+               spike.latency_nanos);
+      buf.append(name.data(), name.size());
+      buf.append(line);
+      buf.append(LatencySpikeCausesToString(spike.causes));
+      buf.push_back('\n');
+    }
+    Status s = latency_spike_file_->Append(buf);
+    if (s.ok()) {
+      s = latency_spike_file_->Flush();
+    }
+    if (!s.ok()) {
+      fprintf(stderr, "Failed to write latency spikes: %s\n",
+              s.ToString().c_str());
+      exit(1);
+    }
+  }
+#endif  // ROCKSDB_LITE
+
   void Crc32c(ThreadState* thread) {
     // Checksum about 500MB of data total
     const int size = FLAGS_block_size; // use --block_size option for db_bench
@@ -3833,8 +4549,9 @@ class Benchmark {
     options.env = FLAGS_env;
     options.max_open_files = FLAGS_open_files;
     if (FLAGS_cost_write_buffer_to_cache || FLAGS_db_write_buffer_size != 0) {
-      options.write_buffer_manager.reset(
-          new WriteBufferManager(FLAGS_db_write_buffer_size, cache_));
+      options.write_buffer_manager.reset(new WriteBufferManager(
+          FLAGS_db_write_buffer_size, cache_, false /* allow_stall */,
+          FLAGS_cost_aware_flush));
     }
     options.arena_block_size = FLAGS_arena_block_size;
     options.write_buffer_size = FLAGS_write_buffer_size;
@@ -3877,6 +4594,9 @@ class Benchmark {
       options.info_log.reset(new StderrLogger());
     }
     options.memtable_huge_page_size = FLAGS_memtable_use_huge_page ? 2048 : 0;
+    options.memtable_transparent_huge_pages =
+        FLAGS_memtable_transparent_huge_pages;
+    options.memtable_numa_aware = FLAGS_memtable_numa_aware;
     options.memtable_prefix_bloom_size_ratio = FLAGS_memtable_bloom_size_ratio;
     options.memtable_whole_key_filtering = FLAGS_memtable_whole_key_filtering;
     if (FLAGS_memtable_insert_with_hint_prefix_size > 0) {
@@ -3886,6 +4606,7 @@ class Benchmark {
     }
     options.bloom_locality = FLAGS_bloom_locality;
     options.max_file_opening_threads = FLAGS_file_opening_threads;
+    options.wal_recovery_threads = FLAGS_wal_recovery_threads;
     options.new_table_reader_for_compaction_inputs =
         FLAGS_new_table_reader_for_compaction_inputs;
     options.compaction_readahead_size = FLAGS_compaction_readahead_size;
@@ -3910,7 +4631,7 @@ class Benchmark {
     switch (FLAGS_rep_factory) {
       case kSkipList:
         options.memtable_factory.reset(new SkipListFactory(
-            FLAGS_skip_list_lookahead));
+            FLAGS_skip_list_lookahead, FLAGS_skip_list_key_prefix));
         break;
 #ifndef ROCKSDB_LITE
       case kPrefixHash:
@@ -3921,10 +4642,16 @@ class Benchmark {
         options.memtable_factory.reset(NewHashLinkListRepFactory(
             FLAGS_hash_bucket_count));
         break;
+      case kHashIndexedSkipList:
+        options.memtable_factory.reset(
+            NewHashIndexedSkipListRepFactory(FLAGS_hash_bucket_count));
+        break;
+      case kArt:
+        options.memtable_factory.reset(NewArtRepFactory());
+        break;
       case kVectorRep:
         options.memtable_factory.reset(
-          new VectorRepFactory
-        );
+            new VectorRepFactory(0, FLAGS_vector_rep_sort_threads));
         break;
 #else
       default:
@@ -4150,16 +4877,26 @@ class Benchmark {
     options.hard_pending_compaction_bytes_limit =
         FLAGS_hard_pending_compaction_bytes_limit;
     options.delayed_write_rate = FLAGS_delayed_write_rate;
+    options.predictive_write_stall_control =
+        FLAGS_predictive_write_stall_control;
     options.allow_concurrent_memtable_write =
         FLAGS_allow_concurrent_memtable_write;
+    options.max_write_batch_insert_threads =
+        FLAGS_max_write_batch_insert_threads;
+    options.zero_copy_put_min_value_size =
+        static_cast<size_t>(FLAGS_zero_copy_put_min_value_size);
     options.inplace_update_support = FLAGS_inplace_update_support;
     options.inplace_update_num_locks = FLAGS_inplace_update_num_locks;
     options.enable_write_thread_adaptive_yield =
         FLAGS_enable_write_thread_adaptive_yield;
     options.enable_pipelined_write = FLAGS_enable_pipelined_write;
+    options.pipelined_wal_sync = FLAGS_pipelined_wal_sync;
     options.unordered_write = FLAGS_unordered_write;
+    options.wal_streams = FLAGS_wal_streams;
     options.write_thread_max_yield_usec = FLAGS_write_thread_max_yield_usec;
     options.write_thread_slow_yield_usec = FLAGS_write_thread_slow_yield_usec;
+    options.write_batch_group_latency_budget_micros =
+        FLAGS_write_batch_group_latency_budget_micros;
     options.rate_limit_delay_max_milliseconds =
       FLAGS_rate_limit_delay_max_milliseconds;
     options.table_cache_numshardbits = FLAGS_table_cache_numshardbits;
@@ -4174,6 +4911,7 @@ class Benchmark {
     options.use_adaptive_mutex = FLAGS_use_adaptive_mutex;
     options.bytes_per_sync = FLAGS_bytes_per_sync;
     options.wal_bytes_per_sync = FLAGS_wal_bytes_per_sync;
+    options.flow_trace_categories = FLAGS_flow_trace_categories_e;
 
     // merge operator options
     options.merge_operator = MergeOperators::CreateFromStringId(
@@ -4184,6 +4922,8 @@ class Benchmark {
       exit(1);
     }
     options.max_successive_merges = FLAGS_max_successive_merges;
+    options.flush_partitions = static_cast<size_t>(FLAGS_flush_partitions);
+    options.in_memory_compaction = FLAGS_in_memory_compaction;
     options.report_bg_io_stats = FLAGS_report_bg_io_stats;
 
     // set universal style compaction configurations, if applicable
@@ -4252,6 +4992,8 @@ class Benchmark {
     options.create_missing_column_families = FLAGS_num_column_families > 1;
     options.statistics = dbstats;
     options.wal_dir = FLAGS_wal_dir;
+    options.wal_compression =
+        StringToCompressionType(FLAGS_wal_compression.c_str());
     options.create_if_missing = !FLAGS_use_existing_db;
     options.dump_malloc_stats = FLAGS_dump_malloc_stats;
     options.stats_dump_period_sec =
@@ -4323,6 +5065,14 @@ class Benchmark {
     }
 
     options.listeners.emplace_back(listener_);
+#ifndef ROCKSDB_LITE
+    // Open() may run more than once on the same options.
+    if (background_events_ &&
+        std::find(options.listeners.begin(), options.listeners.end(),
+                  background_events_) == options.listeners.end()) {
+      options.listeners.emplace_back(background_events_);
+    }
+#endif  // ROCKSDB_LITE
 
     if (FLAGS_num_multi_db <= 1) {
       OpenDb(options, FLAGS_db, &db_);
@@ -4557,6 +5307,10 @@ class Benchmark {
     KeyGenerator(Random64* rand, WriteMode mode, uint64_t num,
                  uint64_t /*num_per_set*/ = 64 * 1024)
         : rand_(rand), mode_(mode), num_(num), next_(0) {
+      if (mode_ == RANDOM && FLAGS_key_distribution_set &&
+          FLAGS_key_distribution_e != KeyDistributionType::kUniform) {
+        key_dist_ = NewKeyDistribution(FLAGS_key_distribution_e, num_);
+      }
       if (mode_ == UNIQUE_RANDOM) {
         // NOTE: if memory consumption of this approach becomes a concern,
         // we can either break it into pieces and only random shuffle a section
@@ -4576,6 +5330,9 @@ class Benchmark {
         case SEQUENTIAL:
           return next_++;
         case RANDOM:
+          if (key_dist_) {
+            return key_dist_->Next(rand_);
+          }
           return rand_->Next() % num_;
           //return GenerateNormalKey(num_);
         case UNIQUE_RANDOM:
@@ -4592,8 +5349,23 @@ class Benchmark {
     const uint64_t num_;
     uint64_t next_;
     std::vector<uint64_t> values_;
+    std::unique_ptr<KeyDistribution> key_dist_;
   };
 
+  // Returns a distribution over [0, num) configured by the --key_dist_*
+  // flags. The result must only be used by the calling thread.
+  static std::unique_ptr<KeyDistribution> NewKeyDistribution(
+      KeyDistributionType type, uint64_t num) {
+    KeyDistributionOptions dist_options;
+    dist_options.zipf_theta = FLAGS_key_dist_zipf_theta;
+    dist_options.hot_set_fraction = FLAGS_key_dist_hot_set_fraction;
+    dist_options.hot_op_fraction = FLAGS_key_dist_hot_op_fraction;
+    dist_options.exponential_percentile = FLAGS_key_dist_exponential_percentile;
+    dist_options.exponential_fraction = FLAGS_key_dist_exponential_fraction;
+    dist_options.scramble_seed = FLAGS_seed;
+    return KeyDistribution::Create(type, num, dist_options);
+  }
+
   DB* SelectDB(ThreadState* thread) {
     return SelectDBWithCfh(thread)->db;
   }
@@ -4680,10 +5452,6 @@ class Benchmark {
     put_cnt = rand() % FLAGS_num;
     get_cnt = rand() % FLAGS_num;
 
-    FILE *fp_test = fopen("bench_mem_seqO.csv", "at");
-    float *lat = (float *)malloc(sizeof(float)*(FLAGS_num*0.2));
-    int j = 0;
-
     while(1) {
       if (!(put_cnt <= (FLAGS_num * 0.2))) {
         put_cnt = rand() % FLAGS_num;
@@ -4735,11 +5503,7 @@ class Benchmark {
         gen_num_for_key = GenerateTestPutKey(get_cnt);
         GenerateKeyFromInt(gen_num_for_key, FLAGS_num, &key);
         get_cnt++;
-        auto start_time = Clock::now(); // Signal.Jin
         Status s = db->Get(options, key, &value);
-        auto end_time = Clock::now(); // Signal.Jin
-        lat[j] = std::chrono::duration_cast<std::chrono::nanoseconds>(end_time - start_time).count() * 0.001;
-        j++; // Signal.Jin
         if (!s.ok() && !s.IsNotFound()) {
           fprintf(stderr, "get error: %s\n", s.ToString().c_str());
           // we continue after error rather than exiting so that we can
@@ -4753,12 +5517,6 @@ class Benchmark {
       }
     }
 
-  for(int i = 0; i < (FLAGS_num*0.2); i++) {
-    fprintf(fp_test, "%.2f\n", lat[i]); // Signal.Jin  
-  }
-  free(lat);
-  fclose(fp_test);
-
     char msg[100];
     snprintf(msg, sizeof(msg), "( reads:%" PRIu64 " writes:%" PRIu64 \
              " total:%" PRIu64 " found:%" PRIu64 ")",
@@ -4871,9 +5629,12 @@ class Benchmark {
     ReadOptions options(FLAGS_verify_checksum, true);
     RandomGenerator gen;
 
-    // Init Zipfian Generator - Signal.Jin
-    init_latestgen(FLAGS_num);
-    init_zipf_generator(0, FLAGS_num);
+    // Read keys are zipfian unless --key_distribution says otherwise. Each
+    // thread owns its distribution, so threads do not share sampler state.
+    std::unique_ptr<KeyDistribution> key_dist = NewKeyDistribution(
+        FLAGS_key_distribution_set ? FLAGS_key_distribution_e
+                                   : KeyDistributionType::kZipfian,
+        FLAGS_num);
 
     std::string value;
     int64_t found = 0;
@@ -4896,9 +5657,7 @@ class Benchmark {
 
     // Generate Random Number
     //srand(time(NULL));
-    FILE *fp_test = fopen("bench_mem_rand.csv", "at");
-    float *lat = (float *)malloc(sizeof(float)*(FLAGS_num*0.2));
-    int j = 0; int put_k = 0;
+    int put_k = 0;
 
     // The number of iterations is the larger of read_ or write_
     while (!duration.Done(1)) {
@@ -4909,7 +5668,7 @@ class Benchmark {
         put_weight = FLAGS_num - get_weight;
       }
       //gen_num_for_key = rand() % FLAGS_num; // Random Generate - Signal.Jin
-      gen_num_for_key = nextValue() % FLAGS_num;
+      gen_num_for_key = key_dist->Next(&thread->rand);
       if (put_weight > 0) {
         // Generate Put Key pattern with loop count - Signal.Jin
         GenerateKeyFromInt(put_k, FLAGS_num, &key);
@@ -4920,6 +5679,7 @@ class Benchmark {
           fprintf(stderr, "put error: %s\n", s.ToString().c_str());
           ErrorExit();
         }
+        key_dist->ObserveInsert(put_k);
         put_k++; //Signal.Jin
         put_weight--;
         writes_done++;
@@ -4927,11 +5687,7 @@ class Benchmark {
       } else if (get_weight > 0) {
         // Generate Get Key pattern with loop count - Signal.Jin
         GenerateKeyFromInt(gen_num_for_key, FLAGS_num, &key);
-        auto start_time = Clock::now(); // Signal.Jin
         Status s = db->Get(options, key, &value);
-        auto end_time = Clock::now(); // Signal.Jin
-        lat[j] = std::chrono::duration_cast<std::chrono::nanoseconds>(end_time - start_time).count() * 0.001;
-        j++; // Signal.Jin
         if (!s.ok() && !s.IsNotFound()) {
           fprintf(stderr, "get error: %s\n", s.ToString().c_str());
           // we continue after error rather than exiting so that we can
@@ -4945,12 +5701,6 @@ class Benchmark {
       }
     }
 
-  for(int i = 0; i < (FLAGS_num*0.2); i++) {
-    fprintf(fp_test, "%.2f\n", lat[i]); // Signal.Jin  
-  }
-  free(lat);
-  fclose(fp_test);
-
     char msg[100];
     snprintf(msg, sizeof(msg), "( reads:%" PRIu64 " writes:%" PRIu64 \
              " total:%" PRIu64 " found:%" PRIu64 ")",
@@ -4962,17 +5712,6 @@ class Benchmark {
     const int test_duration = write_mode == RANDOM ? FLAGS_duration : 0;
     const int64_t num_ops = writes_ == 0 ? num_ : writes_;
 
-    int write_flag = 1;
-
-    if (DB_WRITE_FLOW == 1 && write_flag == 1) {
-      printf("--------------------------------------------------------------------------------------\n");
-      printf("# RocksDB Tracer: Function Graph (Write Flow)\n#\n");
-      printf("# Seq. Number\t Function Calls\t\t\t\t File Location\n");
-      fprintf(stdout, "  [1]        \t| DoWrite()     \t\t\t| db_bench_tool.cc (line 4559)\n"); // Signal.Jin
-      //fprintf(stdout, "| DoWrite() : Generate Random or Sequential Key and Value for Put(key, value) Operations |\n");
-      write_flag = 0;
-    }
-
     // Signal.Jin time
     //clock_t start, end;
 
@@ -5739,13 +6478,6 @@ class Benchmark {
       ts_guard.reset(new char[user_timestamp_size_]);
     }
 
-    if (DB_READ_FLOW == 1) {
-      printf("--------------------------------------------------------------------------------------\n");
-      printf("# RocksDB Tracer: Function Graph (Read Flow)\n#\n");
-      printf("# Seq. Number\t Function Calls\t\t\t\t File Location\n");
-      fprintf(stdout, "  [1]        \t| ReadRandom() {     \t\t\t| db_bench_tool.cc (line 5318)\n"); // Signal.Jin
-    }
-
     Duration duration(FLAGS_duration, reads_);
     while (!duration.Done(1)) {
       DBWithColumnFamilies* db_with_cfh = SelectDBWithCfh(thread);
@@ -5823,6 +6555,7 @@ class Benchmark {
     int64_t num_multireads = 0;
     int64_t found = 0;
     ReadOptions options(FLAGS_verify_checksum, true);
+    options.optimize_multiget_for_io = FLAGS_optimize_multiget_for_io;
     std::vector<Slice> keys;
     std::vector<std::unique_ptr<const char[]> > key_guards;
     std::vector<std::string> values(entries_per_batch_);
@@ -8077,8 +8810,7 @@ int db_bench_tool(int argc, char** argv) {
     initialized = true;
   }
   ParseCommandLineFlags(&argc, &argv, true);
-  FLAGS_compaction_style_e =
-      (ROCKSDB_NAMESPACE::CompactionStyle)FLAGS_compaction_style;
+  DeriveEnumFlags();
 #ifndef ROCKSDB_LITE
   if (FLAGS_statistics && !FLAGS_statistics_string.empty()) {
     fprintf(stderr,
@@ -8102,9 +8834,6 @@ int db_bench_tool(int argc, char** argv) {
   if (dbstats) {
     dbstats->set_stats_level(static_cast<StatsLevel>(FLAGS_stats_level));
   }
-  FLAGS_compaction_pri_e =
-      (ROCKSDB_NAMESPACE::CompactionPri)FLAGS_compaction_pri;
-
   std::vector<std::string> fanout = ROCKSDB_NAMESPACE::StringSplit(
       FLAGS_max_bytes_for_level_multiplier_additional, ',');
   for (size_t j = 0; j < fanout.size(); j++) {
@@ -8116,9 +8845,6 @@ int db_bench_tool(int argc, char** argv) {
 #endif
   }
 
-  FLAGS_compression_type_e =
-    StringToCompressionType(FLAGS_compression_type.c_str());
-
 #ifndef ROCKSDB_LITE
   // Stacked BlobDB
   FLAGS_blob_db_compression_type_e =
@@ -8172,10 +8898,76 @@ int db_bench_tool(int argc, char** argv) {
             FLAGS_compaction_fadvice.c_str());
   }
 
-  FLAGS_value_size_distribution_type_e =
-    StringToDistributionType(FLAGS_value_size_distribution_type.c_str());
+  if (strcasecmp(FLAGS_latency_timeline_format.c_str(), "csv") &&
+      strcasecmp(FLAGS_latency_timeline_format.c_str(), "binary")) {
+    fprintf(stderr, "Unknown latency timeline format: %s\n",
+            FLAGS_latency_timeline_format.c_str());
+    exit(1);
+  }
 
-  FLAGS_rep_factory = StringToRepFactory(FLAGS_memtablerep.c_str());
+  if (FLAGS_latency_spike_percentile != 0) {
+#ifdef ROCKSDB_LITE
+    fprintf(stderr, "--latency_spike_percentile is not supported in LITE\n");
+    exit(1);
+#endif  // ROCKSDB_LITE
+    if (FLAGS_latency_spike_percentile < 0 ||
+        FLAGS_latency_spike_percentile >= 100 ||
+        FLAGS_latency_timeline_file.empty()) {
+      fprintf(stderr,
+              "--latency_spike_percentile must be in (0, 100) and requires "
+              "--latency_timeline_file\n");
+      exit(1);
+    }
+  }
+
+  if (!FLAGS_sweep.empty()) {
+    if (!ParseSweep(FLAGS_sweep)) {
+      exit(1);
+    }
+    if (strcasecmp(FLAGS_sweep_report_format.c_str(), "csv") &&
+        strcasecmp(FLAGS_sweep_report_format.c_str(), "json")) {
+      fprintf(stderr, "Unknown sweep report format: %s\n",
+              FLAGS_sweep_report_format.c_str());
+      exit(1);
+    }
+    if (FLAGS_num_multi_db > 1) {
+      fprintf(stderr, "--sweep does not support --num_multi_db\n");
+      exit(1);
+    }
+    if (!FLAGS_sweep_load_benchmarks.empty() &&
+        (!FLAGS_wal_dir.empty() || FLAGS_use_blob_db)) {
+      fprintf(stderr,
+              "--sweep_load_benchmarks does not support --wal_dir or "
+              "--use_blob_db\n");
+      exit(1);
+    }
+    // Write amplification and stall time come from the statistics.
+    if (!dbstats) {
+      dbstats = ROCKSDB_NAMESPACE::CreateDBStatistics();
+    }
+  }
+
+  ROCKSDB_NAMESPACE::Status flow_trace_status =
+      ROCKSDB_NAMESPACE::ParseFlowTraceCategories(
+          FLAGS_flow_trace_categories, &FLAGS_flow_trace_categories_e);
+  if (!flow_trace_status.ok()) {
+    fprintf(stderr, "%s\n", flow_trace_status.ToString().c_str());
+    exit(1);
+  }
+
+  if (!FLAGS_key_distribution.empty()) {
+    if (!ROCKSDB_NAMESPACE::ParseKeyDistributionType(
+            FLAGS_key_distribution, &FLAGS_key_distribution_e)) {
+      fprintf(stderr, "Unknown key distribution: %s\n",
+              FLAGS_key_distribution.c_str());
+      exit(1);
+    }
+    FLAGS_key_distribution_set = true;
+  }
+  if (FLAGS_key_dist_zipf_theta <= 0) {
+    fprintf(stderr, "--key_dist_zipf_theta must be positive\n");
+    exit(1);
+  }
 
   // Note options sanitization may increase thread pool sizes according to
   // max_background_flushes/max_background_compactions/max_background_jobs
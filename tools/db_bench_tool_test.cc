@@ -15,6 +15,7 @@
 #include "test_util/testharness.h"
 #include "test_util/testutil.h"
 #include "util/random.h"
+#include "util/string_util.h"
 
 #ifdef GFLAGS
 #include "util/gflags_compat.h"
@@ -318,6 +319,32 @@ TEST_F(DBBenchTest, OptionsFileFromFile) {
   VerifyOptions(SanitizeOptions(db_path_, opt));
 }
 
+TEST_F(DBBenchTest, Sweep) {
+  const std::string report = test_path_ + "/sweep.csv";
+  AppendArgs({"./db_bench", "--benchmarks=readrandom,overwrite",
+              "--use_existing_db=0", "--num=1000", "--compression_type=none",
+              "--sweep_load_benchmarks=fillrandom",
+              "--sweep=write_buffer_size=65536,131072;num=500,1000,2000",
+              std::string("--sweep_report_file=") + report,
+              std::string("--db=") + db_path_,
+              // Left over from the tests above.
+              "--wal_dir=", "--options_file="});
+  ASSERT_EQ(0, db_bench_tool(argc(), argv()));
+
+  std::string contents;
+  ASSERT_OK(ReadFileToString(Env::Default(), report, &contents));
+  std::vector<std::string> rows = StringSplit(contents, '\n');
+  // Header, then 2 * 3 cells * 2 benchmarks.
+  ASSERT_EQ(13U, rows.size());
+  ASSERT_EQ(0U, rows[0].find("write_buffer_size,num,benchmark,ops,seconds,"));
+  ASSERT_EQ(0U, rows[1].find("65536,500,readrandom,500,"));
+  ASSERT_EQ(0U, rows[2].find("65536,500,overwrite,500,"));
+  ASSERT_EQ(0U, rows[12].find("131072,2000,overwrite,2000,"));
+  // The checkpoint of the loaded DB is removed after the sweep.
+  ASSERT_TRUE(
+      Env::Default()->FileExists(db_path_ + "_sweep_base").IsNotFound());
+}
+
 }  // namespace ROCKSDB_NAMESPACE
 
 int main(int argc, char** argv) {
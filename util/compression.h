@@ -11,6 +11,7 @@
 
 #include <algorithm>
 #include <limits>
+#include <memory>
 #ifdef ROCKSDB_MALLOC_USABLE_SIZE
 #ifdef OS_FREEBSD
 #include <malloc_np.h>
@@ -1451,6 +1452,152 @@ inline std::string ZSTD_TrainDictionary(const std::string& samples,
 #endif  // ZSTD_VERSION_NUMBER >= 10103
 }
 
+// ZSTD_compressStream2() and the advanced parameter API are stable since
+// v1.4.0.
+#if defined(ZSTD) && ZSTD_VERSION_NUMBER >= 10400
+#define ROCKSDB_ZSTD_STREAMING
+#endif
+
+inline bool ZSTD_Streaming_Supported() {
+#ifdef ROCKSDB_ZSTD_STREAMING
+  return true;
+#else
+  return false;
+#endif
+}
+
+// Whether StreamingCompress::Create() supports `compression_type`.
+inline bool StreamingCompressionTypeSupported(
+    CompressionType compression_type) {
+  switch (compression_type) {
+    case kZSTD:
+      return ZSTD_Streaming_Supported();
+    default:
+      return false;
+  }
+}
+
+// Compresses a sequence of records into one stream, each record using the
+// previous ones as history, so that small similar records compress well.
+// The output of each Compress() call can be uncompressed as soon as it is
+// received, by a StreamingUncompress fed the outputs of all the previous
+// calls in order.
+class StreamingCompress {
+ public:
+  // Returns nullptr if the compression type is not supported.
+  static std::unique_ptr<StreamingCompress> Create(
+      CompressionType compression_type);
+
+  virtual ~StreamingCompress() {}
+
+  // Appends the compressed `input` to `*output`. Returns false on error,
+  // after which the stream cannot be continued.
+  virtual bool Compress(const Slice& input, std::string* output) = 0;
+};
+
+class StreamingUncompress {
+ public:
+  // Returns nullptr if the compression type is not supported.
+  static std::unique_ptr<StreamingUncompress> Create(
+      CompressionType compression_type);
+
+  virtual ~StreamingUncompress() {}
+
+  // Replaces `*output` by the uncompressed `input`, the output of one or more
+  // consecutive StreamingCompress::Compress() calls. Returns false on error,
+  // after which the stream cannot be continued.
+  virtual bool Uncompress(const Slice& input, std::string* output) = 0;
+};
+
+#ifdef ROCKSDB_ZSTD_STREAMING
+class ZSTDStreamingCompress : public StreamingCompress {
+ public:
+  ZSTDStreamingCompress() : cctx_(ZSTD_createCCtx()) {}
+  ~ZSTDStreamingCompress() override { ZSTD_freeCCtx(cctx_); }
+
+  bool Compress(const Slice& input, std::string* output) override {
+    if (cctx_ == nullptr) {
+      return false;
+    }
+    ZSTD_inBuffer in = {input.data(), input.size(), 0};
+    size_t remaining;
+    do {
+      const size_t start = output->size();
+      output->resize(start + ZSTD_CStreamOutSize());
+      ZSTD_outBuffer out = {&(*output)[start], output->size() - start, 0};
+      // Flushing ends the block, not the frame, so the next record is still
+      // compressed with this one as history.
+      remaining = ZSTD_compressStream2(cctx_, &out, &in, ZSTD_e_flush);
+      output->resize(start + out.pos);
+      if (ZSTD_isError(remaining)) {
+        return false;
+      }
+    } while (remaining != 0 || in.pos < in.size);
+    return true;
+  }
+
+ private:
+  ZSTD_CCtx* const cctx_;
+};
+
+class ZSTDStreamingUncompress : public StreamingUncompress {
+ public:
+  ZSTDStreamingUncompress() : dctx_(ZSTD_createDCtx()) {}
+  ~ZSTDStreamingUncompress() override { ZSTD_freeDCtx(dctx_); }
+
+  bool Uncompress(const Slice& input, std::string* output) override {
+    output->clear();
+    if (dctx_ == nullptr) {
+      return false;
+    }
+    ZSTD_inBuffer in = {input.data(), input.size(), 0};
+    while (true) {
+      const size_t start = output->size();
+      output->resize(start + ZSTD_DStreamOutSize());
+      ZSTD_outBuffer out = {&(*output)[start], output->size() - start, 0};
+      const size_t ret = ZSTD_decompressStream(dctx_, &out, &in);
+      output->resize(start + out.pos);
+      if (ZSTD_isError(ret)) {
+        return false;
+      }
+      // Once the input is consumed, an output buffer that was not filled up
+      // means everything flushed by the compressor has been returned.
+      if (in.pos == in.size && out.pos < out.size) {
+        return true;
+      }
+    }
+  }
+
+ private:
+  ZSTD_DCtx* const dctx_;
+};
+#endif  // ROCKSDB_ZSTD_STREAMING
+
+inline std::unique_ptr<StreamingCompress> StreamingCompress::Create(
+    CompressionType compression_type) {
+  switch (compression_type) {
+#ifdef ROCKSDB_ZSTD_STREAMING
+    case kZSTD:
+      return std::unique_ptr<StreamingCompress>(new ZSTDStreamingCompress());
+#endif  // ROCKSDB_ZSTD_STREAMING
+    default:
+      return nullptr;
+  }
+}
+
+inline std::unique_ptr<StreamingUncompress> StreamingUncompress::Create(
+    CompressionType compression_type) {
+  switch (compression_type) {
+#ifdef ROCKSDB_ZSTD_STREAMING
+    case kZSTD:
+      return std::unique_ptr<StreamingUncompress>(
+          new ZSTDStreamingUncompress());
+#endif  // ROCKSDB_ZSTD_STREAMING
+    default:
+      return nullptr;
+  }
+}
+
 inline bool CompressData(const Slice& raw,
                          const CompressionInfo& compression_info,
                          uint32_t compress_format_version,
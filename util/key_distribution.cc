@@ -0,0 +1,278 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include "util/key_distribution.h"
+
+#include <assert.h>
+
+#include <algorithm>
+#include <cmath>
+
+#include "util/coding.h"
+#include "util/hash.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+namespace {
+
+// log1p(x) / x, accurate for x close to zero.
+double Log1pOverX(double x) {
+  if (std::fabs(x) > 1e-8) {
+    return std::log1p(x) / x;
+  }
+  return 1.0 - x * (0.5 - x * (1.0 / 3.0 - 0.25 * x));
+}
+
+// expm1(x) / x, accurate for x close to zero.
+double Expm1OverX(double x) {
+  if (std::fabs(x) > 1e-8) {
+    return std::expm1(x) / x;
+  }
+  return 1.0 + x * 0.5 * (1.0 + x * (1.0 / 3.0) * (1.0 + 0.25 * x));
+}
+
+class UniformKeyDistribution : public KeyDistribution {
+ public:
+  explicit UniformKeyDistribution(uint64_t num) : KeyDistribution(num) {}
+
+  KeyDistributionType type() const override {
+    return KeyDistributionType::kUniform;
+  }
+
+  uint64_t Next(Random64* rnd) override { return rnd->Next() % num_; }
+};
+
+class ZipfianKeyDistribution : public KeyDistribution {
+ public:
+  ZipfianKeyDistribution(uint64_t num, double theta)
+      : KeyDistribution(num), zipf_(num, theta) {}
+
+  KeyDistributionType type() const override {
+    return KeyDistributionType::kZipfian;
+  }
+
+  uint64_t Next(Random64* rnd) override { return zipf_.Next(rnd); }
+
+ private:
+  ZipfianGenerator zipf_;
+};
+
+class ScrambledZipfianKeyDistribution : public KeyDistribution {
+ public:
+  ScrambledZipfianKeyDistribution(uint64_t num, double theta, uint64_t seed)
+      : KeyDistribution(num), zipf_(num, theta), seed_(seed) {}
+
+  KeyDistributionType type() const override {
+    return KeyDistributionType::kScrambledZipfian;
+  }
+
+  uint64_t Next(Random64* rnd) override {
+    char buf[sizeof(uint64_t)];
+    EncodeFixed64(buf, zipf_.Next(rnd));
+    return FastRange64(NPHash64(buf, sizeof(buf), seed_), num_);
+  }
+
+ private:
+  ZipfianGenerator zipf_;
+  const uint64_t seed_;
+};
+
+class LatestKeyDistribution : public KeyDistribution {
+ public:
+  LatestKeyDistribution(uint64_t num, double theta)
+      : KeyDistribution(num), latest_(num - 1), zipf_(num, theta) {}
+
+  KeyDistributionType type() const override {
+    return KeyDistributionType::kLatest;
+  }
+
+  uint64_t Next(Random64* rnd) override { return latest_ - zipf_.Next(rnd); }
+
+  void ObserveInsert(uint64_t key) override {
+    if (key < num_ && key != latest_) {
+      latest_ = key;
+      zipf_.Reset(latest_ + 1);
+    }
+  }
+
+ private:
+  uint64_t latest_;
+  ZipfianGenerator zipf_;
+};
+
+class HotspotKeyDistribution : public KeyDistribution {
+ public:
+  HotspotKeyDistribution(uint64_t num, double hot_set_fraction,
+                         double hot_op_fraction)
+      : KeyDistribution(num), hot_op_fraction_(hot_op_fraction) {
+    hot_set_fraction = std::min(std::max(hot_set_fraction, 0.0), 1.0);
+    hot_keys_ = static_cast<uint64_t>(static_cast<double>(num) *
+                                      hot_set_fraction);
+    hot_keys_ = std::min(std::max<uint64_t>(hot_keys_, 1), num);
+  }
+
+  KeyDistributionType type() const override {
+    return KeyDistributionType::kHotspot;
+  }
+
+  uint64_t Next(Random64* rnd) override {
+    if (hot_keys_ == num_ || NextUniformDouble(rnd) < hot_op_fraction_) {
+      return rnd->Next() % hot_keys_;
+    }
+    return hot_keys_ + rnd->Next() % (num_ - hot_keys_);
+  }
+
+ private:
+  const double hot_op_fraction_;
+  uint64_t hot_keys_;
+};
+
+class ExponentialKeyDistribution : public KeyDistribution {
+ public:
+  ExponentialKeyDistribution(uint64_t num, double percentile, double fraction)
+      : KeyDistribution(num) {
+    percentile = std::min(std::max(percentile, 1e-6), 100.0 - 1e-6);
+    double range = std::max(static_cast<double>(num) * fraction, 1.0);
+    gamma_ = -std::log(1.0 - percentile / 100.0) / range;
+  }
+
+  KeyDistributionType type() const override {
+    return KeyDistributionType::kExponential;
+  }
+
+  uint64_t Next(Random64* rnd) override {
+    double x = -std::log1p(-NextUniformDouble(rnd)) / gamma_;
+    return static_cast<uint64_t>(x) % num_;
+  }
+
+ private:
+  double gamma_;
+};
+
+}  // namespace
+
+bool ParseKeyDistributionType(const std::string& name,
+                              KeyDistributionType* type) {
+  if (name == "uniform") {
+    *type = KeyDistributionType::kUniform;
+  } else if (name == "zipfian") {
+    *type = KeyDistributionType::kZipfian;
+  } else if (name == "scrambled_zipfian") {
+    *type = KeyDistributionType::kScrambledZipfian;
+  } else if (name == "latest") {
+    *type = KeyDistributionType::kLatest;
+  } else if (name == "hotspot") {
+    *type = KeyDistributionType::kHotspot;
+  } else if (name == "exponential") {
+    *type = KeyDistributionType::kExponential;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+const char* KeyDistributionTypeToString(KeyDistributionType type) {
+  switch (type) {
+    case KeyDistributionType::kUniform:
+      return "uniform";
+    case KeyDistributionType::kZipfian:
+      return "zipfian";
+    case KeyDistributionType::kScrambledZipfian:
+      return "scrambled_zipfian";
+    case KeyDistributionType::kLatest:
+      return "latest";
+    case KeyDistributionType::kHotspot:
+      return "hotspot";
+    case KeyDistributionType::kExponential:
+      return "exponential";
+  }
+  assert(false);
+  return "unknown";
+}
+
+std::unique_ptr<KeyDistribution> KeyDistribution::Create(
+    KeyDistributionType type, uint64_t num,
+    const KeyDistributionOptions& options) {
+  assert(num > 0);
+  switch (type) {
+    case KeyDistributionType::kUniform:
+      return std::unique_ptr<KeyDistribution>(
+          new UniformKeyDistribution(num));
+    case KeyDistributionType::kZipfian:
+      return std::unique_ptr<KeyDistribution>(
+          new ZipfianKeyDistribution(num, options.zipf_theta));
+    case KeyDistributionType::kScrambledZipfian:
+      return std::unique_ptr<KeyDistribution>(
+          new ScrambledZipfianKeyDistribution(num, options.zipf_theta,
+                                              options.scramble_seed));
+    case KeyDistributionType::kLatest:
+      return std::unique_ptr<KeyDistribution>(
+          new LatestKeyDistribution(num, options.zipf_theta));
+    case KeyDistributionType::kHotspot:
+      return std::unique_ptr<KeyDistribution>(new HotspotKeyDistribution(
+          num, options.hot_set_fraction, options.hot_op_fraction));
+    case KeyDistributionType::kExponential:
+      return std::unique_ptr<KeyDistribution>(new ExponentialKeyDistribution(
+          num, options.exponential_percentile, options.exponential_fraction));
+  }
+  assert(false);
+  return nullptr;
+}
+
+ZipfianGenerator::ZipfianGenerator(uint64_t n, double theta)
+    : n_(0), theta_(theta) {
+  assert(theta > 0);
+  Reset(n);
+}
+
+void ZipfianGenerator::Reset(uint64_t n) {
+  assert(n > 0);
+  n_ = n;
+  h_integral_x1_ = HIntegral(1.5) - 1.0;
+  h_integral_n_ = HIntegral(static_cast<double>(n) + 0.5);
+  s_ = 2.0 - HIntegralInverse(HIntegral(2.5) - H(2.0));
+}
+
+uint64_t ZipfianGenerator::Next(Random64* rnd) {
+  // Ranks are 1-based inside the sampler and 0-based for callers.
+  const double n = static_cast<double>(n_);
+  while (true) {
+    double u = h_integral_n_ +
+               NextUniformDouble(rnd) * (h_integral_x1_ - h_integral_n_);
+    double x = HIntegralInverse(u);
+    double k = std::floor(x + 0.5);
+    if (k < 1.0) {
+      k = 1.0;
+    } else if (k > n) {
+      k = n;
+    }
+    if (k - x <= s_ || u >= HIntegral(k + 0.5) - H(k)) {
+      return static_cast<uint64_t>(k) - 1;
+    }
+  }
+}
+
+// h(x) = x^-theta, the unnormalized probability of rank x.
+double ZipfianGenerator::H(double x) const {
+  return std::exp(-theta_ * std::log(x));
+}
+
+// An antiderivative of h: (x^(1-theta) - 1) / (1 - theta), or log(x) when
+// theta == 1.
+double ZipfianGenerator::HIntegral(double x) const {
+  double log_x = std::log(x);
+  return Expm1OverX((1.0 - theta_) * log_x) * log_x;
+}
+
+double ZipfianGenerator::HIntegralInverse(double x) const {
+  double t = x * (1.0 - theta_);
+  if (t < -1.0) {
+    // Only possible through rounding error.
+    t = -1.0;
+  }
+  return std::exp(Log1pOverX(t) * x);
+}
+
+}  // namespace ROCKSDB_NAMESPACE
@@ -0,0 +1,130 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+//
+// Key index distributions for benchmarks and tests. Every KeyDistribution
+// object owns all of its state, so each benchmark thread is expected to
+// create its own instance; no object is shared between threads and there is
+// no process-wide state. Sampling is O(1) for every distribution, including
+// zipfian, which uses rejection-inversion sampling and therefore needs no
+// O(n) zeta precomputation at construction time.
+
+#pragma once
+
+#include <stdint.h>
+
+#include <memory>
+#include <string>
+
+#include "rocksdb/rocksdb_namespace.h"
+#include "util/random.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+enum class KeyDistributionType : unsigned char {
+  kUniform,
+  // Rank 0 is the most popular key, rank 1 the second most popular, etc.
+  kZipfian,
+  // Zipfian popularity, but popular keys are spread over the key space.
+  kScrambledZipfian,
+  // Zipfian popularity relative to the most recently inserted key.
+  kLatest,
+  // A fraction of the operations goes to a contiguous hot set of keys.
+  kHotspot,
+  // Exponentially decaying popularity starting from key 0.
+  kExponential,
+};
+
+// Parses the lower case name of a distribution ("uniform", "zipfian",
+// "scrambled_zipfian", "latest", "hotspot", "exponential"). Returns false if
+// the name is not recognized.
+extern bool ParseKeyDistributionType(const std::string& name,
+                                     KeyDistributionType* type);
+
+extern const char* KeyDistributionTypeToString(KeyDistributionType type);
+
+struct KeyDistributionOptions {
+  // Skew of the zipfian based distributions. Must be positive; 0.99 matches
+  // the YCSB default.
+  double zipf_theta = 0.99;
+
+  // kHotspot: fraction of the key space that is hot, and fraction of the
+  // samples that are drawn from the hot set.
+  double hot_set_fraction = 0.2;
+  double hot_op_fraction = 0.8;
+
+  // kExponential: `exponential_percentile` percent of the samples fall into
+  // the first `exponential_fraction` of the key space.
+  double exponential_percentile = 95.0;
+  double exponential_fraction = 0.8571428571;
+
+  // Seed used to scramble kScrambledZipfian ranks into key indexes. Threads
+  // sharing the seed agree on which keys are hot.
+  uint64_t scramble_seed = 0;
+};
+
+// Generates key indexes in [0, num). Not thread-safe: use one instance per
+// thread together with that thread's Random64.
+class KeyDistribution {
+ public:
+  // REQUIRES: num > 0
+  static std::unique_ptr<KeyDistribution> Create(
+      KeyDistributionType type, uint64_t num,
+      const KeyDistributionOptions& options = KeyDistributionOptions());
+
+  explicit KeyDistribution(uint64_t num) : num_(num) {}
+  virtual ~KeyDistribution() {}
+
+  virtual KeyDistributionType type() const = 0;
+
+  // Returns the next key index in [0, num()).
+  virtual uint64_t Next(Random64* rnd) = 0;
+
+  // Tells the distribution that `key` has just been inserted. Only kLatest
+  // makes use of it: the most recently inserted key becomes the most popular
+  // one. Until the first call, key num() - 1 is treated as the latest.
+  virtual void ObserveInsert(uint64_t /*key*/) {}
+
+  uint64_t num() const { return num_; }
+
+ protected:
+  const uint64_t num_;
+};
+
+// Zipfian distribution over ranks [0, n) sampled with the rejection-inversion
+// method of Hormann and Derflinger ("Rejection-inversion to generate variates
+// from monotone discrete distributions", 1996). Construction and Reset() are
+// O(1) and every sample costs a small, bounded expected number of exp/log
+// evaluations.
+class ZipfianGenerator {
+ public:
+  // REQUIRES: n > 0, theta > 0
+  ZipfianGenerator(uint64_t n, double theta);
+
+  // Changes the number of ranks, keeping theta. O(1).
+  void Reset(uint64_t n);
+
+  // Returns a rank in [0, n); rank 0 is the most likely.
+  uint64_t Next(Random64* rnd);
+
+  uint64_t n() const { return n_; }
+
+ private:
+  double H(double x) const;
+  double HIntegral(double x) const;
+  double HIntegralInverse(double x) const;
+
+  uint64_t n_;
+  const double theta_;
+  double h_integral_x1_;
+  double h_integral_n_;
+  double s_;
+};
+
+// Returns a double uniformly distributed in [0, 1).
+inline double NextUniformDouble(Random64* rnd) {
+  return static_cast<double>(rnd->Next() >> 11) * (1.0 / 9007199254740992.0);
+}
+
+}  // namespace ROCKSDB_NAMESPACE
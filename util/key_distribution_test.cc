@@ -0,0 +1,158 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include "util/key_distribution.h"
+
+#include <cmath>
+#include <vector>
+
+#include "test_util/testharness.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+class KeyDistributionTest : public testing::Test {};
+
+TEST_F(KeyDistributionTest, ParseAndName) {
+  for (KeyDistributionType type :
+       {KeyDistributionType::kUniform, KeyDistributionType::kZipfian,
+        KeyDistributionType::kScrambledZipfian, KeyDistributionType::kLatest,
+        KeyDistributionType::kHotspot, KeyDistributionType::kExponential}) {
+    KeyDistributionType parsed;
+    ASSERT_TRUE(
+        ParseKeyDistributionType(KeyDistributionTypeToString(type), &parsed));
+    ASSERT_EQ(type, parsed);
+    ASSERT_EQ(type, KeyDistribution::Create(type, 10)->type());
+  }
+  KeyDistributionType parsed;
+  ASSERT_FALSE(ParseKeyDistributionType("zipf", &parsed));
+}
+
+TEST_F(KeyDistributionTest, InRange) {
+  Random64 rnd(301);
+  for (KeyDistributionType type :
+       {KeyDistributionType::kUniform, KeyDistributionType::kZipfian,
+        KeyDistributionType::kScrambledZipfian, KeyDistributionType::kLatest,
+        KeyDistributionType::kHotspot, KeyDistributionType::kExponential}) {
+    for (uint64_t num : {uint64_t{1}, uint64_t{2}, uint64_t{7},
+                         uint64_t{1000}, uint64_t{1} << 40}) {
+      auto dist = KeyDistribution::Create(type, num);
+      for (int i = 0; i < 1000; ++i) {
+        ASSERT_LT(dist->Next(&rnd), num);
+      }
+    }
+  }
+}
+
+TEST_F(KeyDistributionTest, ZipfianMatchesPmf) {
+  const uint64_t kNum = 100;
+  const int kSamples = 1000000;
+  for (double theta : {0.5, 0.99, 1.0, 1.5}) {
+    ZipfianGenerator zipf(kNum, theta);
+    Random64 rnd(42);
+    std::vector<int> counts(kNum, 0);
+    for (int i = 0; i < kSamples; ++i) {
+      ++counts[zipf.Next(&rnd)];
+    }
+    double zeta = 0;
+    for (uint64_t i = 1; i <= kNum; ++i) {
+      zeta += 1.0 / std::pow(static_cast<double>(i), theta);
+    }
+    for (uint64_t rank : {0, 1, 2, 9, 99}) {
+      double expected = kSamples / std::pow(rank + 1.0, theta) / zeta;
+      double sigma = std::sqrt(expected);
+      EXPECT_NEAR(counts[rank], expected, 5 * sigma + 5)
+          << "theta " << theta << " rank " << rank;
+    }
+  }
+}
+
+TEST_F(KeyDistributionTest, ZipfianLargeKeySpace) {
+  // Construction must not depend on the key space size.
+  ZipfianGenerator zipf(uint64_t{1} << 50, 0.99);
+  Random64 rnd(7);
+  int zero = 0;
+  for (int i = 0; i < 10000; ++i) {
+    if (zipf.Next(&rnd) == 0) {
+      ++zero;
+    }
+  }
+  ASSERT_GT(zero, 0);
+}
+
+TEST_F(KeyDistributionTest, Latest) {
+  const uint64_t kNum = 1000;
+  auto dist = KeyDistribution::Create(KeyDistributionType::kLatest, kNum);
+  Random64 rnd(11);
+  dist->ObserveInsert(500);
+  int at_latest = 0;
+  for (int i = 0; i < 10000; ++i) {
+    uint64_t key = dist->Next(&rnd);
+    ASSERT_LE(key, 500U);
+    if (key == 500) {
+      ++at_latest;
+    }
+  }
+  // Rank 0 of a 0.99 zipfian over 501 keys has probability ~14%.
+  ASSERT_GT(at_latest, 1000);
+}
+
+TEST_F(KeyDistributionTest, Hotspot) {
+  KeyDistributionOptions options;
+  options.hot_set_fraction = 0.1;
+  options.hot_op_fraction = 0.9;
+  const uint64_t kNum = 1000;
+  auto dist =
+      KeyDistribution::Create(KeyDistributionType::kHotspot, kNum, options);
+  Random64 rnd(13);
+  int hot = 0;
+  const int kSamples = 100000;
+  for (int i = 0; i < kSamples; ++i) {
+    if (dist->Next(&rnd) < 100) {
+      ++hot;
+    }
+  }
+  EXPECT_NEAR(hot, kSamples * 0.9, kSamples * 0.01);
+}
+
+TEST_F(KeyDistributionTest, Exponential) {
+  KeyDistributionOptions options;
+  options.exponential_percentile = 90;
+  options.exponential_fraction = 0.5;
+  const uint64_t kNum = 100000;
+  auto dist = KeyDistribution::Create(KeyDistributionType::kExponential, kNum,
+                                      options);
+  Random64 rnd(17);
+  int head = 0;
+  const int kSamples = 100000;
+  for (int i = 0; i < kSamples; ++i) {
+    if (dist->Next(&rnd) < kNum / 2) {
+      ++head;
+    }
+  }
+  // 90% below kNum / 2, plus a little wrapped around from the tail.
+  EXPECT_NEAR(head, kSamples * 0.9, kSamples * 0.02);
+}
+
+TEST_F(KeyDistributionTest, IndependentInstances) {
+  // Two instances driven by equally seeded generators produce the same
+  // sequence, regardless of interleaving with other instances.
+  auto a = KeyDistribution::Create(KeyDistributionType::kScrambledZipfian,
+                                   1 << 20);
+  auto b = KeyDistribution::Create(KeyDistributionType::kScrambledZipfian,
+                                   1 << 20);
+  auto other = KeyDistribution::Create(KeyDistributionType::kZipfian, 10);
+  Random64 rnd_a(5), rnd_b(5), rnd_other(6);
+  for (int i = 0; i < 1000; ++i) {
+    other->Next(&rnd_other);
+    ASSERT_EQ(a->Next(&rnd_a), b->Next(&rnd_b));
+  }
+}
+
+}  // namespace ROCKSDB_NAMESPACE
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
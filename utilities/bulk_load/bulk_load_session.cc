@@ -0,0 +1,473 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#ifndef ROCKSDB_LITE
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "db/write_batch_internal.h"
+#include "port/port.h"
+#include "rocksdb/comparator.h"
+#include "rocksdb/db.h"
+#include "rocksdb/env.h"
+#include "rocksdb/options.h"
+#include "rocksdb/sst_file_writer.h"
+#include "rocksdb/utilities/bulk_load.h"
+#include "rocksdb/write_batch.h"
+#include "util/string_util.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+namespace {
+
+// Checks that the records of a batch can be bulk loaded and that their keys
+// follow `prev_key`, if any.
+class SortedBatchChecker : public WriteBatch::Handler {
+ public:
+  SortedBatchChecker(uint32_t column_family_id, const Comparator* comparator,
+                     const std::string* prev_key)
+      : column_family_id_(column_family_id),
+        comparator_(comparator),
+        prev_key_(prev_key) {}
+
+  Status PutCF(uint32_t column_family_id, const Slice& key,
+               const Slice& /*value*/) override {
+    return Check(column_family_id, key);
+  }
+
+  Status DeleteCF(uint32_t column_family_id, const Slice& key) override {
+    return Check(column_family_id, key);
+  }
+
+  Status MergeCF(uint32_t column_family_id, const Slice& key,
+                 const Slice& /*value*/) override {
+    return Check(column_family_id, key);
+  }
+
+  Status SingleDeleteCF(uint32_t /*column_family_id*/,
+                        const Slice& /*key*/) override {
+    return Status::NotSupported("SingleDelete cannot be bulk loaded");
+  }
+
+  Status DeleteRangeCF(uint32_t /*column_family_id*/,
+                       const Slice& /*begin_key*/,
+                       const Slice& /*end_key*/) override {
+    return Status::NotSupported("DeleteRange cannot be bulk loaded");
+  }
+
+  Status PutBlobIndexCF(uint32_t /*column_family_id*/, const Slice& /*key*/,
+                        const Slice& /*value*/) override {
+    return Status::NotSupported("Blob indexes cannot be bulk loaded");
+  }
+
+  // The largest key of the batch, if it has any records.
+  bool has_last_key() const { return has_last_key_; }
+  const Slice& last_key() const { return last_key_; }
+
+ private:
+  Status Check(uint32_t column_family_id, const Slice& key) {
+    if (column_family_id != column_family_id_) {
+      return Status::InvalidArgument(
+          "Record for another column family than the bulk load session's");
+    }
+    if (has_last_key_) {
+      if (comparator_->Compare(key, last_key_) <= 0) {
+        return Status::InvalidArgument(
+            "Keys must be added in strictly increasing order");
+      }
+    } else if (prev_key_ != nullptr &&
+               comparator_->Compare(key, *prev_key_) <= 0) {
+      return Status::InvalidArgument(
+          "Keys must be added in strictly increasing order");
+    }
+    // Points into the batch, which outlives the checker.
+    last_key_ = key;
+    has_last_key_ = true;
+    return Status::OK();
+  }
+
+  const uint32_t column_family_id_;
+  const Comparator* const comparator_;
+  const std::string* const prev_key_;
+  Slice last_key_;
+  bool has_last_key_ = false;
+};
+
+class SstFileInserter : public WriteBatch::Handler {
+ public:
+  explicit SstFileInserter(SstFileWriter* writer) : writer_(writer) {}
+
+  Status PutCF(uint32_t /*column_family_id*/, const Slice& key,
+               const Slice& value) override {
+    return writer_->Put(key, value);
+  }
+
+  Status DeleteCF(uint32_t /*column_family_id*/, const Slice& key) override {
+    return writer_->Delete(key);
+  }
+
+  Status MergeCF(uint32_t /*column_family_id*/, const Slice& key,
+                 const Slice& value) override {
+    return writer_->Merge(key, value);
+  }
+
+ private:
+  SstFileWriter* const writer_;
+};
+
+// Each session builds its files in a directory of its own, locked by the
+// session while it is open.
+const char* const kSessionDirPrefix = "session-";
+const char* const kSessionLockFileName = "LOCK";
+
+// Deletes the files of a session directory and the directory.
+void DeleteSessionDir(Env* env, const std::string& dir) {
+  std::vector<std::string> children;
+  if (env->GetChildren(dir, &children).ok()) {
+    for (const auto& child : children) {
+      if (child != "." && child != "..") {
+        env->DeleteFile(dir + "/" + child).PermitUncheckedError();
+      }
+    }
+  }
+  env->DeleteDir(dir).PermitUncheckedError();
+}
+
+// Deletes the session directories in `working_dir` whose lock is not held,
+// i.e. those left behind by processes that exited with open sessions.
+void DeleteStaleSessionDirs(Env* env, const std::string& working_dir) {
+  std::vector<std::string> children;
+  if (!env->GetChildren(working_dir, &children).ok()) {
+    return;
+  }
+  for (const auto& child : children) {
+    if (!Slice(child).starts_with(kSessionDirPrefix)) {
+      continue;
+    }
+    const std::string dir = working_dir + "/" + child;
+    FileLock* lock = nullptr;
+    if (env->LockFile(dir + "/" + kSessionLockFileName, &lock).ok()) {
+      env->UnlockFile(lock).PermitUncheckedError();
+      DeleteSessionDir(env, dir);
+    }
+  }
+}
+
+class BulkLoadSessionImpl : public BulkLoadSession {
+ public:
+  BulkLoadSessionImpl(DB* db, ColumnFamilyHandle* column_family,
+                      const BulkLoadOptions& options,
+                      const Options& cf_options,
+                      const std::string& working_dir, const std::string& dir,
+                      FileLock* dir_lock)
+      : db_(db),
+        column_family_(column_family),
+        options_(options),
+        cf_options_(cf_options),
+        env_options_(cf_options_),
+        working_dir_(working_dir),
+        dir_(dir),
+        dir_lock_(dir_lock) {
+    for (int i = 0; i < options_.num_threads; ++i) {
+      threads_.emplace_back(&BulkLoadSessionImpl::BGWork, this);
+    }
+  }
+
+  ~BulkLoadSessionImpl() override { Abort(); }
+
+  Status Add(const WriteBatch& batch) override;
+  Status Finish() override;
+  void Abort() override;
+
+ private:
+  // The data of one SST file. Files are numbered in key order.
+  struct Chunk {
+    size_t index = 0;
+    WriteBatch batch;
+  };
+
+  // Appends the records of a checked batch to `current_`, queueing it
+  // whenever it reaches target_file_size.
+  class RecordAppender : public WriteBatch::Handler {
+   public:
+    explicit RecordAppender(BulkLoadSessionImpl* session)
+        : session_(session) {}
+
+    Status PutCF(uint32_t column_family_id, const Slice& key,
+                 const Slice& value) override {
+      Status s = WriteBatchInternal::Put(&session_->current_,
+                                         column_family_id, key, value);
+      return s.ok() ? session_->MaybeSubmitCurrent() : s;
+    }
+
+    Status DeleteCF(uint32_t column_family_id, const Slice& key) override {
+      Status s =
+          WriteBatchInternal::Delete(&session_->current_, column_family_id, key);
+      return s.ok() ? session_->MaybeSubmitCurrent() : s;
+    }
+
+    Status MergeCF(uint32_t column_family_id, const Slice& key,
+                   const Slice& value) override {
+      Status s = WriteBatchInternal::Merge(&session_->current_,
+                                           column_family_id, key, value);
+      return s.ok() ? session_->MaybeSubmitCurrent() : s;
+    }
+
+   private:
+    BulkLoadSessionImpl* const session_;
+  };
+
+  Status MaybeSubmitCurrent() {
+    if (current_.GetDataSize() >= options_.target_file_size) {
+      return SubmitCurrent();
+    }
+    return Status::OK();
+  }
+  // Queues `current_` to be built into a file, waiting for room in the queue.
+  Status SubmitCurrent();
+  void BGWork();
+  Status BuildFile(const Chunk& chunk, std::string* path);
+  // Lets the background threads build the queued files, or drops them if
+  // `drop_queued`, and waits for the threads to exit.
+  void StopThreads(bool drop_queued);
+  void DeleteFiles();
+
+  DB* const db_;
+  ColumnFamilyHandle* const column_family_;
+  const BulkLoadOptions options_;
+  const Options cf_options_;
+  const EnvOptions env_options_;
+  const std::string working_dir_;
+  const std::string dir_;
+  FileLock* dir_lock_;
+
+  // Only accessed by the thread calling Add(), Finish() or Abort().
+  WriteBatch current_;
+  std::string last_key_;
+  bool has_last_key_ = false;
+  bool done_ = false;
+
+  std::mutex mu_;
+  std::condition_variable cv_;
+  std::deque<Chunk> queue_;
+  bool closing_ = false;
+  Status bg_status_;
+  // Path of each file by index, empty until it is built.
+  std::vector<std::string> files_;
+  std::vector<port::Thread> threads_;
+};
+
+Status BulkLoadSessionImpl::Add(const WriteBatch& batch) {
+  if (done_) {
+    return Status::InvalidArgument("Bulk load session is finished");
+  }
+  {
+    std::lock_guard<std::mutex> lock(mu_);
+    if (!bg_status_.ok()) {
+      return bg_status_;
+    }
+  }
+  SortedBatchChecker checker(column_family_->GetID(),
+                             column_family_->GetComparator(),
+                             has_last_key_ ? &last_key_ : nullptr);
+  Status s = batch.Iterate(&checker);
+  if (!s.ok()) {
+    return s;
+  }
+  if (checker.has_last_key()) {
+    last_key_.assign(checker.last_key().data(), checker.last_key().size());
+    has_last_key_ = true;
+  }
+  RecordAppender appender(this);
+  return batch.Iterate(&appender);
+}
+
+Status BulkLoadSessionImpl::SubmitCurrent() {
+  Chunk chunk;
+  chunk.batch = std::move(current_);
+  current_.Clear();
+
+  std::unique_lock<std::mutex> lock(mu_);
+  cv_.wait(lock, [this] {
+    return queue_.size() < threads_.size() || !bg_status_.ok();
+  });
+  if (!bg_status_.ok()) {
+    return bg_status_;
+  }
+  chunk.index = files_.size();
+  files_.emplace_back();
+  queue_.push_back(std::move(chunk));
+  cv_.notify_all();
+  return Status::OK();
+}
+
+void BulkLoadSessionImpl::BGWork() {
+  while (true) {
+    Chunk chunk;
+    {
+      std::unique_lock<std::mutex> lock(mu_);
+      cv_.wait(lock, [this] { return !queue_.empty() || closing_; });
+      if (queue_.empty()) {
+        return;
+      }
+      chunk = std::move(queue_.front());
+      queue_.pop_front();
+      // Room for another chunk.
+      cv_.notify_all();
+      if (!bg_status_.ok()) {
+        continue;
+      }
+    }
+    std::string path;
+    Status s = BuildFile(chunk, &path);
+    std::lock_guard<std::mutex> lock(mu_);
+    if (s.ok()) {
+      files_[chunk.index] = path;
+    } else if (bg_status_.ok()) {
+      bg_status_ = s;
+      cv_.notify_all();
+    }
+  }
+}
+
+Status BulkLoadSessionImpl::BuildFile(const Chunk& chunk, std::string* path) {
+  std::string file_path = dir_ + "/" + ToString(chunk.index) + ".sst";
+  SstFileWriter writer(env_options_, cf_options_, column_family_);
+  Status s = writer.Open(file_path);
+  if (!s.ok()) {
+    return s;
+  }
+  SstFileInserter inserter(&writer);
+  s = chunk.batch.Iterate(&inserter);
+  if (s.ok()) {
+    s = writer.Finish();
+  }
+  if (s.ok()) {
+    *path = file_path;
+  } else {
+    // The file is incomplete.
+    cf_options_.env->DeleteFile(file_path).PermitUncheckedError();
+  }
+  return s;
+}
+
+Status BulkLoadSessionImpl::Finish() {
+  if (done_) {
+    return Status::InvalidArgument("Bulk load session is finished");
+  }
+  done_ = true;
+  Status s;
+  if (current_.Count() > 0) {
+    s = SubmitCurrent();
+  }
+  StopThreads(!s.ok());
+  if (s.ok()) {
+    s = bg_status_;
+  }
+  if (s.ok() && !files_.empty()) {
+    IngestExternalFileOptions ingest_options;
+    ingest_options.move_files = true;
+    s = db_->IngestExternalFile(column_family_, files_, ingest_options);
+  }
+  // The ingested files were moved into the DB.
+  DeleteFiles();
+  return s;
+}
+
+void BulkLoadSessionImpl::Abort() {
+  done_ = true;
+  StopThreads(true /* drop_queued */);
+  DeleteFiles();
+}
+
+void BulkLoadSessionImpl::StopThreads(bool drop_queued) {
+  {
+    std::lock_guard<std::mutex> lock(mu_);
+    closing_ = true;
+    if (drop_queued) {
+      queue_.clear();
+    }
+    cv_.notify_all();
+  }
+  for (auto& thread : threads_) {
+    thread.join();
+  }
+  threads_.clear();
+}
+
+void BulkLoadSessionImpl::DeleteFiles() {
+  Env* env = cf_options_.env;
+  for (const auto& file : files_) {
+    if (!file.empty()) {
+      env->DeleteFile(file).PermitUncheckedError();
+    }
+  }
+  files_.clear();
+  if (dir_lock_ != nullptr) {
+    env->UnlockFile(dir_lock_).PermitUncheckedError();
+    dir_lock_ = nullptr;
+    DeleteSessionDir(env, dir_);
+    // Fails if other sessions use the directory too.
+    env->DeleteDir(working_dir_).PermitUncheckedError();
+  }
+}
+
+}  // namespace
+
+Status BulkLoadSession::Open(DB* db, ColumnFamilyHandle* column_family,
+                             const BulkLoadOptions& options,
+                             std::unique_ptr<BulkLoadSession>* session) {
+  if (db == nullptr || session == nullptr) {
+    return Status::InvalidArgument("db and session must not be null");
+  }
+  if (options.num_threads < 1) {
+    return Status::InvalidArgument("num_threads must be at least 1");
+  }
+  if (column_family == nullptr) {
+    column_family = db->DefaultColumnFamily();
+  }
+  std::string working_dir = options.working_dir;
+  if (working_dir.empty()) {
+    // Outside of the DB directory, so that the files of a session that is
+    // never finished do not outlive DestroyDB().
+    std::string db_dir = db->GetName();
+    while (db_dir.size() > 1 && db_dir.back() == '/') {
+      db_dir.pop_back();
+    }
+    working_dir = db_dir + ".bulk_load";
+  }
+  Env* env = db->GetEnv();
+  Status s = env->CreateDirIfMissing(working_dir);
+  if (!s.ok()) {
+    return s;
+  }
+  // The lock of the new session directory is taken before looking for stale
+  // ones, so that concurrent Open() calls leave it alone.
+  const std::string dir =
+      working_dir + "/" + kSessionDirPrefix + env->GenerateUniqueId();
+  s = env->CreateDir(dir);
+  FileLock* dir_lock = nullptr;
+  if (s.ok()) {
+    s = env->LockFile(dir + "/" + kSessionLockFileName, &dir_lock);
+    if (!s.ok()) {
+      env->DeleteDir(dir).PermitUncheckedError();
+    }
+  }
+  if (!s.ok()) {
+    return s;
+  }
+  DeleteStaleSessionDirs(env, working_dir);
+  session->reset(new BulkLoadSessionImpl(db, column_family, options,
+                                         db->GetOptions(column_family),
+                                         working_dir, dir, dir_lock));
+  return Status::OK();
+}
+
+}  // namespace ROCKSDB_NAMESPACE
+#endif  // !ROCKSDB_LITE
@@ -0,0 +1,259 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#ifndef ROCKSDB_LITE
+
+#include "rocksdb/utilities/bulk_load.h"
+
+#include "db/db_test_util.h"
+#include "port/stack_trace.h"
+#include "rocksdb/write_batch.h"
+#include "utilities/merge_operators.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+class BulkLoadSessionTest : public DBTestBase {
+ public:
+  BulkLoadSessionTest()
+      : DBTestBase("/bulk_load_session_test", /*env_do_fsync=*/false) {}
+
+  static std::string Key(int i) {
+    char buf[16];
+    snprintf(buf, sizeof(buf), "key%06d", i);
+    return buf;
+  }
+
+  int CountFiles(const std::string& dir) {
+    std::vector<std::string> children;
+    if (!env_->GetChildren(dir, &children).ok()) {
+      return 0;
+    }
+    int count = 0;
+    for (const auto& child : children) {
+      if (child.size() > 4 && child.substr(child.size() - 4) == ".sst") {
+        count++;
+      }
+    }
+    return count;
+  }
+};
+
+TEST_F(BulkLoadSessionTest, LoadSortedBatches) {
+  Options options = CurrentOptions();
+  options.disable_auto_compactions = true;
+  DestroyAndReopen(options);
+  // Existing data is overwritten by the loaded data.
+  const int kBottommost = options.num_levels - 1;
+  ASSERT_OK(Put(Key(5), "old"));
+  ASSERT_OK(Flush());
+  MoveFilesToLevel(kBottommost);
+
+  BulkLoadOptions bulk_load_options;
+  bulk_load_options.target_file_size = 16 << 10;
+  bulk_load_options.num_threads = 3;
+  std::unique_ptr<BulkLoadSession> session;
+  ASSERT_OK(
+      BulkLoadSession::Open(db_, nullptr, bulk_load_options, &session));
+
+  const int kNumKeys = 5000;
+  const int kKeysPerBatch = 100;
+  for (int i = 0; i < kNumKeys; i += kKeysPerBatch) {
+    WriteBatch batch;
+    for (int j = i; j < i + kKeysPerBatch; j++) {
+      ASSERT_OK(batch.Put(Key(j), "v" + ToString(j)));
+    }
+    ASSERT_OK(session->Add(batch));
+  }
+  ASSERT_EQ("old", Get(Key(5)));
+  ASSERT_EQ("NOT_FOUND", Get(Key(6)));
+  ASSERT_OK(session->Finish());
+  ASSERT_TRUE(session->Add(WriteBatch()).IsInvalidArgument());
+  session.reset();
+
+  for (int i = 0; i < kNumKeys; i++) {
+    ASSERT_EQ("v" + ToString(i), Get(Key(i)));
+  }
+  // Nothing went through the memtable.
+  uint64_t num_entries = 0;
+  ASSERT_TRUE(dbfull()->GetIntProperty(
+      DB::Properties::kNumEntriesActiveMemTable, &num_entries));
+  ASSERT_EQ(0U, num_entries);
+  // The file with the overwritten key is right above the old one, the others
+  // are in the bottommost level.
+  ASSERT_EQ(0, NumTableFilesAtLevel(0));
+  ASSERT_EQ(1, NumTableFilesAtLevel(kBottommost - 1));
+  ASSERT_GT(NumTableFilesAtLevel(kBottommost), 2);
+  // The default working directory is next to the DB directory and removed
+  // with the last session.
+  ASSERT_TRUE(env_->FileExists(dbname_ + ".bulk_load").IsNotFound());
+
+  Reopen(options);
+  for (int i = 0; i < kNumKeys; i += 99) {
+    ASSERT_EQ("v" + ToString(i), Get(Key(i)));
+  }
+}
+
+TEST_F(BulkLoadSessionTest, CutFilesWithinBatches) {
+  Options options = CurrentOptions();
+  options.disable_auto_compactions = true;
+  DestroyAndReopen(options);
+
+  BulkLoadOptions bulk_load_options;
+  bulk_load_options.target_file_size = 4 << 10;
+  std::unique_ptr<BulkLoadSession> session;
+  ASSERT_OK(
+      BulkLoadSession::Open(db_, nullptr, bulk_load_options, &session));
+  const int kNumKeys = 2000;
+  WriteBatch batch;
+  for (int i = 0; i < kNumKeys; i++) {
+    ASSERT_OK(batch.Put(Key(i), "v" + ToString(i)));
+  }
+  ASSERT_OK(session->Add(batch));
+  ASSERT_OK(session->Finish());
+
+  // The batch is cut into files of about target_file_size.
+  ASSERT_GE(NumTableFilesAtLevel(options.num_levels - 1),
+            static_cast<int>(batch.GetDataSize() /
+                             bulk_load_options.target_file_size));
+  for (int i = 0; i < kNumKeys; i++) {
+    ASSERT_EQ("v" + ToString(i), Get(Key(i)));
+  }
+}
+
+TEST_F(BulkLoadSessionTest, DeleteStaleSessionFiles) {
+  Options options = CurrentOptions();
+  DestroyAndReopen(options);
+  std::string working_dir = test::PerThreadDBPath(env_, "bulk_load_stale");
+  // Left behind by a process that exited with an open session.
+  const std::string stale_dir = working_dir + "/session-stale";
+  ASSERT_OK(env_->CreateDirIfMissing(working_dir));
+  ASSERT_OK(env_->CreateDirIfMissing(stale_dir));
+  std::unique_ptr<WritableFile> file;
+  ASSERT_OK(env_->NewWritableFile(stale_dir + "/0.sst", &file, EnvOptions()));
+  ASSERT_OK(file->Close());
+
+  BulkLoadOptions bulk_load_options;
+  bulk_load_options.working_dir = working_dir;
+  bulk_load_options.target_file_size = 1;
+  std::unique_ptr<BulkLoadSession> session1;
+  ASSERT_OK(
+      BulkLoadSession::Open(db_, nullptr, bulk_load_options, &session1));
+  ASSERT_TRUE(env_->FileExists(stale_dir).IsNotFound());
+  WriteBatch batch;
+  ASSERT_OK(batch.Put(Key(0), "v"));
+  ASSERT_OK(session1->Add(batch));
+
+  // The files of open sessions are kept.
+  std::unique_ptr<BulkLoadSession> session2;
+  ASSERT_OK(
+      BulkLoadSession::Open(db_, nullptr, bulk_load_options, &session2));
+  batch.Clear();
+  ASSERT_OK(batch.Put(Key(1), "v"));
+  ASSERT_OK(session2->Add(batch));
+  ASSERT_OK(session2->Finish());
+  ASSERT_OK(session1->Finish());
+  ASSERT_EQ("v", Get(Key(0)));
+  ASSERT_EQ("v", Get(Key(1)));
+  ASSERT_TRUE(env_->FileExists(working_dir).IsNotFound());
+}
+
+TEST_F(BulkLoadSessionTest, RejectInvalidBatches) {
+  Options options = CurrentOptions();
+  options.merge_operator = MergeOperators::CreateStringAppendOperator();
+  CreateAndReopenWithCF({"pikachu"}, options);
+
+  std::unique_ptr<BulkLoadSession> session;
+  ASSERT_OK(BulkLoadSession::Open(db_, handles_[1], BulkLoadOptions(),
+                                  &session));
+  WriteBatch batch;
+  ASSERT_OK(batch.Put(handles_[1], "b", "v1"));
+  ASSERT_OK(batch.Merge(handles_[1], "c", "v2"));
+  ASSERT_OK(batch.Delete(handles_[1], "d"));
+  ASSERT_OK(session->Add(batch));
+
+  // Not after the previous batch
+  batch.Clear();
+  ASSERT_OK(batch.Put(handles_[1], "e", "x"));
+  ASSERT_OK(batch.Put(handles_[1], "a", "x"));
+  ASSERT_TRUE(session->Add(batch).IsInvalidArgument());
+  batch.Clear();
+  ASSERT_OK(batch.Put(handles_[1], "d", "x"));
+  ASSERT_TRUE(session->Add(batch).IsInvalidArgument());
+  // Other column family
+  batch.Clear();
+  ASSERT_OK(batch.Put("f", "x"));
+  ASSERT_TRUE(session->Add(batch).IsInvalidArgument());
+  batch.Clear();
+  ASSERT_OK(batch.SingleDelete(handles_[1], "f"));
+  ASSERT_TRUE(session->Add(batch).IsNotSupported());
+  batch.Clear();
+  ASSERT_OK(batch.DeleteRange(handles_[1], "f", "g"));
+  ASSERT_TRUE(session->Add(batch).IsNotSupported());
+
+  // The rejected batches were not added.
+  batch.Clear();
+  ASSERT_OK(batch.Put(handles_[1], "e", "v3"));
+  ASSERT_OK(session->Add(batch));
+  ASSERT_OK(session->Finish());
+
+  ASSERT_EQ("v1", Get(1, "b"));
+  ASSERT_EQ("v2", Get(1, "c"));
+  ASSERT_EQ("NOT_FOUND", Get(1, "d"));
+  ASSERT_EQ("v3", Get(1, "e"));
+  ASSERT_EQ("NOT_FOUND", Get(1, "a"));
+  ASSERT_EQ("NOT_FOUND", Get(1, "f"));
+  ASSERT_EQ("NOT_FOUND", Get(0, "f"));
+}
+
+TEST_F(BulkLoadSessionTest, Abort) {
+  Options options = CurrentOptions();
+  DestroyAndReopen(options);
+  std::string working_dir = test::PerThreadDBPath(env_, "bulk_load_abort");
+
+  BulkLoadOptions bulk_load_options;
+  bulk_load_options.working_dir = working_dir;
+  bulk_load_options.target_file_size = 1;
+  std::unique_ptr<BulkLoadSession> session;
+  ASSERT_OK(
+      BulkLoadSession::Open(db_, nullptr, bulk_load_options, &session));
+  for (int i = 0; i < 10; i++) {
+    WriteBatch batch;
+    ASSERT_OK(batch.Put(Key(i), "v"));
+    ASSERT_OK(session->Add(batch));
+  }
+  // Destroying the session aborts it.
+  session.reset();
+  ASSERT_EQ(0, CountFiles(working_dir));
+  ASSERT_EQ("NOT_FOUND", Get(Key(0)));
+  ASSERT_EQ("NOT_FOUND", Get(Key(9)));
+
+  // Nothing to load
+  ASSERT_OK(
+      BulkLoadSession::Open(db_, nullptr, bulk_load_options, &session));
+  ASSERT_OK(session->Finish());
+
+  bulk_load_options.num_threads = 0;
+  ASSERT_TRUE(BulkLoadSession::Open(db_, nullptr, bulk_load_options, &session)
+                  .IsInvalidArgument());
+}
+
+}  // namespace ROCKSDB_NAMESPACE
+
+int main(int argc, char** argv) {
+  ROCKSDB_NAMESPACE::port::InstallStackTraceHandler();
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
+
+#else
+#include <stdio.h>
+
+int main(int /*argc*/, char** /*argv*/) {
+  fprintf(stderr,
+          "SKIPPED as BulkLoadSession is not supported in ROCKSDB_LITE\n");
+  return 0;
+}
+
+#endif  // !ROCKSDB_LITE